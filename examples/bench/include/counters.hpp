@@ -0,0 +1,52 @@
+/**
+ * @file counters.hpp
+ * @brief Syscall and allocation counters for the benchmark
+ * @details The benchmark binary interposes the libc syscall wrappers the
+ * library calls and the global allocation functions, so each measured
+ * operation can be charged with what it cost
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_BENCH_COUNTERS_HPP
+#define LIBFREEBSDNET_BENCH_COUNTERS_HPP
+
+#include <cstdint>
+
+namespace bench {
+
+  /**
+   * @brief Counter values at one point in time
+   */
+  struct Counters {
+    uint64_t ioctls = 0;
+    uint64_t sysctls = 0;   // sysctl(3) and sysctlbyname(3)
+    uint64_t sockets = 0;   // socket(2)
+    uint64_t transfers = 0; // read, write, send and recv family
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+
+    uint64_t getSyscalls() const {
+      return ioctls + sysctls + sockets + transfers;
+    }
+
+    Counters operator-(const Counters &other) const {
+      return {ioctls - other.ioctls,
+              sysctls - other.sysctls,
+              sockets - other.sockets,
+              transfers - other.transfers,
+              allocations - other.allocations,
+              allocatedBytes - other.allocatedBytes};
+    }
+  };
+
+  /**
+   * @brief Read all counters
+   * @return Current totals since process start
+   */
+  Counters snapshot();
+
+} // namespace bench
+
+#endif // LIBFREEBSDNET_BENCH_COUNTERS_HPP
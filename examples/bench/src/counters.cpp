@@ -0,0 +1,170 @@
+/**
+ * @file counters.cpp
+ * @brief Syscall and allocation counting shim
+ * @details Definitions here take precedence over the weak libc wrappers
+ * for every call made from the library linked into this binary; each one
+ * counts and forwards to the raw __sys_ entry point. Calls libc makes
+ * internally (getifaddrs, if_nameindex) are not seen.
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <counters.hpp>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace {
+
+  std::atomic<uint64_t> ioctls{0};
+  std::atomic<uint64_t> sysctls{0};
+  std::atomic<uint64_t> sockets{0};
+  std::atomic<uint64_t> transfers{0};
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> allocatedBytes{0};
+
+  void count(std::atomic<uint64_t> &counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void *allocate(std::size_t size) {
+    count(allocations);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+} // namespace
+
+namespace bench {
+
+  Counters snapshot() {
+    return {ioctls.load(std::memory_order_relaxed),
+            sysctls.load(std::memory_order_relaxed),
+            sockets.load(std::memory_order_relaxed),
+            transfers.load(std::memory_order_relaxed),
+            allocations.load(std::memory_order_relaxed),
+            allocatedBytes.load(std::memory_order_relaxed)};
+  }
+
+} // namespace bench
+
+extern "C" {
+
+int __sys_ioctl(int, unsigned long, ...);
+int __sysctl(const int *, unsigned int, void *, size_t *, const void *,
+             size_t);
+int __sysctlbyname(const char *, size_t, void *, size_t *, const void *,
+                   size_t);
+int __sys_socket(int, int, int);
+ssize_t __sys_read(int, void *, size_t);
+ssize_t __sys_write(int, const void *, size_t);
+ssize_t __sys_readv(int, const struct iovec *, int);
+ssize_t __sys_writev(int, const struct iovec *, int);
+ssize_t __sys_recvfrom(int, void *, size_t, int, struct sockaddr *,
+                       socklen_t *);
+ssize_t __sys_sendto(int, const void *, size_t, int, const struct sockaddr *,
+                     socklen_t);
+ssize_t __sys_recvmsg(int, struct msghdr *, int);
+ssize_t __sys_sendmsg(int, const struct msghdr *, int);
+
+int ioctl(int fd, unsigned long request, ...) {
+  va_list ap;
+  va_start(ap, request);
+  void *arg = va_arg(ap, void *);
+  va_end(ap);
+  count(ioctls);
+  return __sys_ioctl(fd, request, arg);
+}
+
+int sysctl(const int *name, unsigned int namelen, void *oldp, size_t *oldlenp,
+           const void *newp, size_t newlen) {
+  count(sysctls);
+  return __sysctl(name, namelen, oldp, oldlenp, newp, newlen);
+}
+
+int sysctlbyname(const char *name, void *oldp, size_t *oldlenp,
+                 const void *newp, size_t newlen) {
+  count(sysctls);
+  return __sysctlbyname(name, std::strlen(name), oldp, oldlenp, newp, newlen);
+}
+
+int socket(int domain, int type, int protocol) {
+  count(sockets);
+  return __sys_socket(domain, type, protocol);
+}
+
+ssize_t read(int fd, void *buf, size_t nbytes) {
+  count(transfers);
+  return __sys_read(fd, buf, nbytes);
+}
+
+ssize_t write(int fd, const void *buf, size_t nbytes) {
+  count(transfers);
+  return __sys_write(fd, buf, nbytes);
+}
+
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt) {
+  count(transfers);
+  return __sys_readv(fd, iov, iovcnt);
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt) {
+  count(transfers);
+  return __sys_writev(fd, iov, iovcnt);
+}
+
+ssize_t recv(int s, void *buf, size_t len, int flags) {
+  count(transfers);
+  return __sys_recvfrom(s, buf, len, flags, nullptr, nullptr);
+}
+
+ssize_t recvfrom(int s, void *buf, size_t len, int flags,
+                 struct sockaddr *from, socklen_t *fromlen) {
+  count(transfers);
+  return __sys_recvfrom(s, buf, len, flags, from, fromlen);
+}
+
+ssize_t send(int s, const void *msg, size_t len, int flags) {
+  count(transfers);
+  return __sys_sendto(s, msg, len, flags, nullptr, 0);
+}
+
+ssize_t sendto(int s, const void *msg, size_t len, int flags,
+               const struct sockaddr *to, socklen_t tolen) {
+  count(transfers);
+  return __sys_sendto(s, msg, len, flags, to, tolen);
+}
+
+ssize_t recvmsg(int s, struct msghdr *msg, int flags) {
+  count(transfers);
+  return __sys_recvmsg(s, msg, flags);
+}
+
+ssize_t sendmsg(int s, const struct msghdr *msg, int flags) {
+  count(transfers);
+  return __sys_sendmsg(s, msg, flags);
+}
+
+} // extern "C"
+
+void *operator new(std::size_t size) { return allocate(size); }
+
+void *operator new[](std::size_t size) { return allocate(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,426 @@
+/**
+ * @file main.cpp
+ * @brief Library benchmark main function
+ * @details Builds a fixture of epair, vlan and route entries in a scratch
+ * VNET jail and reports wall time, syscalls and allocations per call for
+ * the public query APIs, and optionally the start-up cost of one-shot net
+ * tool commands
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <counters.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <interface/epairpool.hpp>
+#include <interface/manager.hpp>
+#include <interface/statistics.hpp>
+#include <interface/vlanbatch.hpp>
+#include <iostream>
+#include <netlink/manager.hpp>
+#include <routing/batch.hpp>
+#include <routing/entry.hpp>
+#include <routing/table.hpp>
+#include <spawn.h>
+#include <string>
+#include <sys/jail.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+  using namespace libfreebsdnet;
+
+  struct Options {
+    size_t interfaces = 64;
+    size_t routes = 10000;
+    size_t iterations = 20;
+    bool jail = true;
+    bool csv = false;
+    std::string netTool; // net binary for the start-up benchmark
+  };
+
+  // Results land here so the calls cannot be optimised away
+  volatile size_t sink = 0;
+
+  struct Operation {
+    std::string name;
+    std::function<void()> run;
+  };
+
+  int usage() {
+    std::cerr << "usage: libfreebsdnet++_bench [-n epairs] [-m routes] "
+                 "[-i iterations] [-s net] [-c] [-J]\n"
+              << "  -s  also time one-shot commands of the given net binary\n"
+              << "  -c  print CSV\n"
+              << "  -J  measure the current VNET as is, without a jail or "
+                 "fixture\n";
+    return 2;
+  }
+
+  struct iovec param(const char *name) {
+    return {const_cast<char *>(name), std::strlen(name) + 1};
+  }
+
+  // A persistent VNET jail rooted at /, removed again by the parent
+  int createJail() {
+    std::string name = "libfreebsdnet-bench-" + std::to_string(getpid());
+    int vnet = JAIL_SYS_NEW;
+    const char *root = "/";
+    char errmsg[256] = {};
+    struct iovec iov[] = {param("name"),
+                          {name.data(), name.size() + 1},
+                          param("path"),
+                          {const_cast<char *>(root), 2},
+                          param("vnet"),
+                          {&vnet, sizeof(vnet)},
+                          param("persist"),
+                          {nullptr, 0},
+                          param("errmsg"),
+                          {errmsg, sizeof(errmsg)}};
+    int jid = jail_set(iov, sizeof(iov) / sizeof(iov[0]), JAIL_CREATE);
+    if (jid < 0) {
+      std::cerr << "Failed to create jail: "
+                << (errmsg[0] ? errmsg : std::strerror(errno)) << std::endl;
+    }
+    return jid;
+  }
+
+  bool buildFixture(const Options &options) {
+    interface::Manager manager;
+    auto loopback = manager.getInterface("lo0");
+    if (!loopback || !loopback->bringUp()) {
+      std::cerr << "Failed to bring up lo0" << std::endl;
+      return false;
+    }
+
+    interface::EpairPoolOptions poolOptions;
+    poolOptions.size = 0; // no refill thread, create on demand
+    interface::EpairPool pool(poolOptions);
+    std::vector<interface::VlanSpec> vlans;
+    for (size_t i = 0; i < options.interfaces; ++i) {
+      interface::EpairPair pair;
+      if (!pool.acquire(pair)) {
+        std::cerr << pool.getLastError() << std::endl;
+        return false;
+      }
+      interface::VlanSpec vlan;
+      vlan.name = "vlan";
+      vlan.parent = pair.host;
+      vlan.tag = static_cast<uint16_t>(100 + i % 4000);
+      vlans.push_back(vlan);
+    }
+    interface::VlanBatch vlanBatch;
+    for (const auto &result : vlanBatch.create(vlans)) {
+      if (!result.succeeded()) {
+        std::cerr << vlanBatch.getLastError() << std::endl;
+        return false;
+      }
+    }
+
+    std::vector<routing::RouteSpec> routes(options.routes);
+    for (size_t i = 0; i < routes.size(); ++i) {
+      routes[i].destination = types::Address(
+          "10." + std::to_string(i >> 8 & 0xff) + "." +
+          std::to_string(i & 0xff) + ".0/24");
+      routes[i].gateway = "127.0.0.1";
+      routes[i].flags = static_cast<uint32_t>(routing::RouteFlag::BLACKHOLE);
+    }
+    routing::RouteBatch routeBatch;
+    for (const auto &result : routeBatch.add(routes)) {
+      if (!result.succeeded()) {
+        std::cerr << routeBatch.getLastError() << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<Operation> operations() {
+    static interface::Manager manager;
+    static routing::RoutingTable table;
+    static interface::StatisticsCollector statistics;
+    return {
+        // Construction must stay free of syscalls: one-shot net commands
+        // build all of these and use one or two
+        {"Manager::Manager", [] { interface::Manager m; }},
+        {"RoutingTable::RoutingTable", [] { routing::RoutingTable t; }},
+        {"NetlinkManager::NetlinkManager", [] { netlink::NetlinkManager n; }},
+        {"StatisticsCollector::StatisticsCollector",
+         [] { interface::StatisticsCollector c; }},
+        {"Manager::getInterfaces",
+         [&] { sink = manager.getInterfaces().size(); }},
+        {"Manager::getInterfaceList",
+         [&] { sink = manager.getInterfaceList().size(); }},
+        {"Manager::getViews", [&] { sink = manager.getViews().size(); }},
+        {"Manager::getAllAddresses",
+         [&] { sink = manager.getAllAddresses().size(); }},
+        {"RoutingTable::getEntries",
+         [&] { sink = table.getEntries().size(); }},
+        {"RoutingTable::getRecords",
+         [&] { sink = table.getRecords().size(); }},
+        {"RoutingTable::forEachRoute",
+         [&] {
+           size_t n = 0;
+           table.forEachRoute(0, AF_UNSPEC, [&](const routing::RouteRecord &) {
+             ++n;
+             return true;
+           });
+           sink = n;
+         }},
+        {"StatisticsCollector::getAllStatistics",
+         [&] { sink = statistics.getAllStatistics().size(); }},
+        {"StatisticsCollector::forEachStatistics",
+         [&] {
+           size_t n = 0;
+           statistics.forEachStatistics(
+               [&](unsigned int, std::string_view,
+                   const interface::InterfaceStatistics &) {
+                 ++n;
+                 return true;
+               });
+           sink = n;
+         }},
+    };
+  }
+
+  void measure(const Options &options) {
+    if (options.csv) {
+      std::printf("operation,mean_us,min_us,syscalls,ioctls,sysctls,"
+                  "sockets,transfers,allocations,bytes\n");
+    } else if (options.jail) {
+      std::printf("libfreebsdnet++ %s: %zu epairs, %zu routes, %zu runs\n",
+                  LIBFREEBSDNET_VERSION, options.interfaces, options.routes,
+                  options.iterations);
+    } else {
+      std::printf("libfreebsdnet++ %s: current VNET, %zu runs\n",
+                  LIBFREEBSDNET_VERSION, options.iterations);
+    }
+    if (!options.csv) {
+      std::printf("%-38s %10s %10s %8s %8s %8s %10s\n", "operation",
+                  "mean us", "min us", "syscall", "ioctl", "alloc", "bytes");
+    }
+
+    for (const auto &operation : operations()) {
+      operation.run(); // warm caches and lazily created sockets
+      auto best = Clock::duration::max();
+      Clock::duration total{0};
+      bench::Counters before = bench::snapshot();
+      for (size_t i = 0; i < options.iterations; ++i) {
+        auto start = Clock::now();
+        operation.run();
+        auto elapsed = Clock::now() - start;
+        total += elapsed;
+        best = std::min(best, elapsed);
+      }
+      bench::Counters used = bench::snapshot() - before;
+
+      double runs = static_cast<double>(options.iterations);
+      double mean =
+          std::chrono::duration<double, std::micro>(total).count() / runs;
+      double min = std::chrono::duration<double, std::micro>(best).count();
+      if (options.csv) {
+        std::printf("%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f\n",
+                    operation.name.c_str(), mean, min,
+                    used.getSyscalls() / runs, used.ioctls / runs,
+                    used.sysctls / runs, used.sockets / runs,
+                    used.transfers / runs, used.allocations / runs,
+                    used.allocatedBytes / runs);
+      } else {
+        std::printf("%-38s %10.1f %10.1f %8.1f %8.1f %8.1f %10.0f\n",
+                    operation.name.c_str(), mean, min,
+                    used.getSyscalls() / runs, used.ioctls / runs,
+                    used.allocations / runs, used.allocatedBytes / runs);
+      }
+    }
+    std::fflush(stdout);
+  }
+
+  // Run the net binary once with its output discarded
+  bool spawnOnce(const std::string &tool,
+                 const std::vector<std::string> &words) {
+    std::vector<char *> argv{const_cast<char *>(tool.c_str())};
+    for (const auto &word : words) {
+      argv.push_back(const_cast<char *>(word.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                     O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+                                     O_WRONLY, 0);
+    pid_t pid;
+    int error = posix_spawn(&pid, tool.c_str(), &actions, nullptr,
+                            argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) {
+      std::cerr << "Failed to run " << tool << ": " << std::strerror(error)
+                << std::endl;
+      return false;
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+      if (errno != EINTR) {
+        std::cerr << "Failed to wait for " << tool << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+      }
+    }
+    // A command that fails exits early and would time as fast
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::string command = tool;
+      for (const auto &word : words) {
+        command += " " + word;
+      }
+      if (WIFEXITED(status)) {
+        std::cerr << command << " exited with status " << WEXITSTATUS(status)
+                  << std::endl;
+      } else {
+        std::cerr << command << " was killed by signal "
+                  << (WIFSIGNALED(status) ? WTERMSIG(status) : 0) << std::endl;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // Wall time of whole one-shot invocations, process start to exit, the
+  // way provisioning scripts pay for them
+  bool measureStartup(const Options &options) {
+    const std::vector<std::vector<std::string>> commands = {
+        {"help"},
+        {"show", "interface"},
+        {"show", "interface", "lo0"},
+        {"show", "route"},
+        {"show", "route", "stats"},
+    };
+    if (!options.csv) {
+      std::printf("\n%-38s %10s %10s\n", "one-shot command", "mean ms",
+                  "min ms");
+    }
+    for (const auto &words : commands) {
+      std::string name = "net";
+      for (const auto &word : words) {
+        name += " " + word;
+      }
+      if (!spawnOnce(options.netTool, words)) { // warm the page cache
+        return false;
+      }
+      auto best = Clock::duration::max();
+      Clock::duration total{0};
+      for (size_t i = 0; i < options.iterations; ++i) {
+        auto start = Clock::now();
+        if (!spawnOnce(options.netTool, words)) {
+          return false;
+        }
+        auto elapsed = Clock::now() - start;
+        total += elapsed;
+        best = std::min(best, elapsed);
+      }
+      double mean = std::chrono::duration<double, std::milli>(total).count() /
+                    static_cast<double>(options.iterations);
+      double min = std::chrono::duration<double, std::milli>(best).count();
+      if (options.csv) {
+        std::printf("%s,%.1f,%.1f,,,,,,,\n", name.c_str(), mean * 1000,
+                    min * 1000);
+      } else {
+        std::printf("%-38s %10.2f %10.2f\n", name.c_str(), mean, min);
+      }
+    }
+    std::fflush(stdout);
+    return true;
+  }
+
+  int run(const Options &options) {
+    if (options.jail && !buildFixture(options)) {
+      return 1;
+    }
+    measure(options);
+    if (!options.netTool.empty() && !measureStartup(options)) {
+      return 1;
+    }
+    return 0;
+  }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  int ch;
+  try {
+    while ((ch = getopt(argc, argv, "n:m:i:s:cJ")) != -1) {
+      switch (ch) {
+      case 'n':
+        options.interfaces = std::stoul(optarg);
+        break;
+      case 'm':
+        options.routes = std::stoul(optarg);
+        break;
+      case 'i':
+        options.iterations = std::max<size_t>(std::stoul(optarg), 1);
+        break;
+      case 's':
+        options.netTool = optarg;
+        break;
+      case 'c':
+        options.csv = true;
+        break;
+      case 'J':
+        options.jail = false;
+        break;
+      default:
+        return usage();
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid argument: " << e.what() << std::endl;
+    return 2;
+  }
+  if (options.routes > 65536) {
+    std::cerr << "At most 65536 routes (10.0.0.0/8 in /24s)" << std::endl;
+    return 2;
+  }
+
+  if (!options.jail) {
+    return run(options);
+  }
+
+  int jid = createJail();
+  if (jid < 0) {
+    return 1;
+  }
+  // Attach a child so the parent can still remove the jail, which takes
+  // the VNET and every interface created in it along
+  pid_t child = fork();
+  if (child == 0) {
+    if (jail_attach(jid) < 0) {
+      std::cerr << "Failed to attach to jail: " << std::strerror(errno)
+                << std::endl;
+      _exit(1);
+    }
+    _exit(run(options));
+  }
+  int status = 1;
+  if (child < 0) {
+    std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+  } else {
+    waitpid(child, &status, 0);
+    status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+  }
+  jail_remove(jid);
+  return status;
+}
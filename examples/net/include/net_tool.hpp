@@ -10,13 +10,15 @@
 #ifndef NET_TOOL_HPP
 #define NET_TOOL_HPP
 
-#include <functional>
 #include <interface/manager.hpp>
+#include <istream>
 #include <map>
 #include <memory>
 #include <netlink/manager.hpp>
 #include <routing/table.hpp>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace net {
@@ -25,10 +27,9 @@ namespace net {
    * @brief Command structure
    */
   struct Command {
-    std::string name;
-    std::string description;
-    std::function<bool(const std::vector<std::string> &)> handler;
-    std::string usage;
+    std::string_view name;
+    std::string_view description;
+    std::string_view usage;
   };
 
   /**
@@ -68,23 +69,60 @@ namespace net {
      */
     bool executeCommand(const std::string &command);
 
+    /**
+     * @brief Execute every command of a script
+     * @details Accepts text, one command per line with '#' comments, or
+     * the binary output of "save state binary"
+     * @param input Script stream
+     * @return true if every command succeeded
+     */
+    bool runScript(std::istream &input);
+
+    /**
+     * @brief Execute a script through the library's batch APIs
+     * @details The whole script is parsed first. Between commands the
+     * batch APIs cannot express, VLANs named parent.tag are created in one
+     * batch, state, MTU, FIB and address settings are applied as one
+     * desired-state diff and routes are installed in pipelined batches.
+     * Each other command flushes those groups and then runs on its own, so
+     * a later delete still undoes an earlier set. A per-phase summary with
+     * timings is printed.
+     * @param input Script stream, text or binary
+     * @return true if every command succeeded
+     */
+    bool runBatch(std::istream &input);
+
   private:
     // Interface management
     libfreebsdnet::interface::Manager interfaceManager;
     libfreebsdnet::routing::RoutingTable routingTable;
     libfreebsdnet::netlink::NetlinkManager netlinkManager;
 
-    // Command registry
-    std::map<std::string, Command> commands;
+    // Last "show route changes" snapshot per FIB
+    std::map<int, std::vector<libfreebsdnet::routing::RouteRecord>>
+        routeBaselines;
 
     // Internal state
     bool interactive{false};
     std::string prompt{"net> "};
 
+    // Handler selected by the dispatch table
+    using Handler = bool (NetTool::*)(const std::vector<std::string> &);
+
+    /**
+     * @brief Look up a command by name
+     * @param name Command name, any case
+     * @return Command or nullptr if unknown
+     */
+    static const Command *findCommand(std::string_view name);
+
     /**
-     * @brief Initialize commands
+     * @brief Select the handler for a command line
+     * @details Prints the usage or unknown-target error when nothing matches
+     * @param words Command words
+     * @return Handler or nullptr
      */
-    void initializeCommands();
+    Handler findHandler(std::span<const std::string_view> words);
 
     /**
      * @brief Parse command line arguments
@@ -124,6 +162,7 @@ namespace net {
     bool handleDeleteRoute(const std::vector<std::string> &args);
     bool handleFlushRoutes(const std::vector<std::string> &args);
     bool handleShowRouteStats(const std::vector<std::string> &args);
+    bool handleShowRouteChanges(const std::vector<std::string> &args);
     bool handleShowSystem(const std::vector<std::string> &args);
     bool handleSetSystem(const std::vector<std::string> &args);
     bool handleHelp(const std::vector<std::string> &args);
@@ -135,12 +174,18 @@ namespace net {
     bool handleSaveState(const std::vector<std::string> &args);
 
     // Utility functions
-    std::vector<std::string> splitCommand(const std::string &command);
+    bool dispatchCommand(const std::vector<std::string> &args);
+    static size_t tokenize(std::string_view line,
+                           std::span<std::string_view> words);
     void printError(const std::string &message);
     void printSuccess(const std::string &message);
     void printInfo(const std::string &message);
     void printTable(const std::vector<std::vector<std::string>> &data,
                     const std::vector<std::string> &headers);
+    static void formatTable(std::string &out,
+                            const std::vector<std::vector<std::string>> &data,
+                            const std::vector<std::string> &headers);
+    static void writeOutput(std::string_view text);
   };
 
 } // namespace net
@@ -0,0 +1,98 @@
+/**
+ * @file state_format.hpp
+ * @brief Net tool saved state format
+ * @details Compact binary encoding of saved configuration commands
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef NET_STATE_FORMAT_HPP
+#define NET_STATE_FORMAT_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace net::state {
+
+  /**
+   * @brief Stream header: magic followed by a version byte
+   */
+  inline constexpr std::string_view MAGIC{"NETS\x01", 5};
+
+  /**
+   * @brief Saved state writer
+   * @details Buffers commands as text lines or as binary records and writes
+   * them out in one go. A binary record is an argument count byte, then
+   * each argument as a 16-bit little-endian length and its bytes, so replay
+   * never has to tokenize.
+   */
+  class StateWriter {
+  public:
+    /**
+     * @brief Constructor
+     * @param binary Emit binary records instead of text
+     */
+    explicit StateWriter(bool binary);
+
+    /**
+     * @brief Add a comment line (text mode only)
+     * @param text Comment without the leading "# "
+     */
+    void comment(std::string_view text);
+
+    /**
+     * @brief Add a blank line (text mode only)
+     */
+    void blank();
+
+    /**
+     * @brief Add a command
+     * @param args Command words
+     */
+    void command(std::initializer_list<std::string_view> args);
+
+    /**
+     * @brief Get the encoded output
+     * @return Buffered text or binary stream
+     */
+    const std::string &data() const { return buffer; }
+
+  private:
+    std::string buffer;
+    bool binary;
+  };
+
+  /**
+   * @brief Check whether input is a binary state stream
+   * @param data Input bytes
+   * @return true if it starts with MAGIC
+   */
+  bool isBinary(std::string_view data);
+
+  /**
+   * @brief Decode the next binary record
+   * @param data Remaining input after MAGIC; advanced past the record
+   * @param args Output command words
+   * @return true if a record was decoded, false at the end or on a
+   * truncated record
+   */
+  bool nextRecord(std::string_view &data, std::vector<std::string> &args);
+
+  /**
+   * @brief Split a whole script into commands
+   * @details Text scripts hold one command per line, with blank lines and
+   * '#' comments skipped; binary scripts are decoded record by record
+   * @param data Script contents
+   * @param commands Output command words, in script order
+   * @return true on success, false on a truncated binary record
+   */
+  bool readScript(std::string_view data,
+                  std::vector<std::vector<std::string>> &commands);
+
+} // namespace net::state
+
+#endif // NET_STATE_FORMAT_HPP
@@ -0,0 +1,308 @@
+/**
+ * @file batch_commands.cpp
+ * @brief Net tool batch replay implementation
+ * @details Parses a whole script first, then replays interface creation,
+ * interface settings and routes through the library's batch APIs
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <interface/desired.hpp>
+#include <interface/vlanbatch.hpp>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <net_tool.hpp>
+#include <routing/batch.hpp>
+#include <sstream>
+#include <state_format.hpp>
+
+namespace net {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    bool parseInt(std::string_view text, int &value) {
+      auto [end, error] =
+          std::from_chars(text.data(), text.data() + text.size(), value);
+      return error == std::errc() && end == text.data() + text.size();
+    }
+
+    // "ix0.100" style names carry their parent and tag
+    bool parseVlanName(const std::string &name,
+                       libfreebsdnet::interface::VlanSpec &spec) {
+      size_t dot = name.rfind('.');
+      int tag = 0;
+      if (dot == std::string::npos || dot == 0 ||
+          !parseInt(std::string_view(name).substr(dot + 1), tag) || tag < 1 ||
+          tag > 4094) {
+        return false;
+      }
+      spec.name = name;
+      spec.parent = name.substr(0, dot);
+      spec.tag = static_cast<uint16_t>(tag);
+      spec.up = false;
+      return true;
+    }
+
+    // set|add route <destination> <gateway> [interface] [fib <number>]
+    bool parseRoute(const std::vector<std::string> &args,
+                    libfreebsdnet::routing::RouteSpec &spec) {
+      if (args.size() < 4 ||
+          !libfreebsdnet::types::Address::parse(args[2], spec.destination)) {
+        return false;
+      }
+      spec.gateway = args[3];
+      for (size_t i = 4; i < args.size(); ++i) {
+        if (args[i] == "fib" && i + 1 < args.size()) {
+          if (!parseInt(args[++i], spec.fib)) {
+            return false;
+          }
+        } else if (spec.interface.empty()) {
+          spec.interface = args[i];
+        }
+      }
+      return true;
+    }
+
+    std::string formatPhase(const char *name, size_t count, size_t failed,
+                            Clock::duration elapsed) {
+      std::ostringstream out;
+      out << name << ": " << count << " commands, " << failed << " failed, "
+          << std::chrono::duration<double, std::milli>(elapsed).count()
+          << " ms";
+      return out.str();
+    }
+
+  } // namespace
+
+  bool NetTool::runBatch(std::istream &input) {
+    using libfreebsdnet::interface::InterfaceConfig;
+    using libfreebsdnet::interface::VlanSpec;
+    using libfreebsdnet::routing::RouteSpec;
+
+    auto started = Clock::now();
+    std::string script((std::istreambuf_iterator<char>(input)),
+                       std::istreambuf_iterator<char>());
+    std::vector<std::vector<std::string>> commands;
+    if (!state::readScript(script, commands)) {
+      printError("Truncated state record");
+      return false;
+    }
+
+    auto snapshot = interfaceManager.getSnapshot();
+    if (!snapshot) {
+      printError("Failed to read interfaces");
+      return false;
+    }
+
+    // Consecutive batchable commands are grouped and flushed as one batch
+    // per kind; anything the batch APIs cannot express flushes the groups
+    // first and then runs through the normal handlers, so the script's
+    // order between the two is kept
+    std::vector<VlanSpec> vlans;
+    std::map<std::string, size_t> configIndex;
+    std::vector<InterfaceConfig> configs;
+    size_t settings = 0;
+    std::vector<RouteSpec> routes;
+    bool stale = false; // a handler may have changed the interfaces
+
+    struct Phase {
+      size_t count = 0;
+      size_t failed = 0;
+      size_t changes = 0;
+      Clock::duration elapsed{};
+    };
+    Phase create;
+    Phase other;
+    Phase configure;
+    Phase route;
+
+    auto configFor = [&](const std::string &name) -> InterfaceConfig & {
+      auto [it, inserted] = configIndex.emplace(name, configs.size());
+      if (inserted) {
+        configs.emplace_back();
+        configs.back().name = name;
+      }
+      return configs[it->second];
+    };
+
+    auto flush = [&]() {
+      // Interfaces first, so settings and routes can refer to them
+      auto phase = Clock::now();
+      if (!vlans.empty()) {
+        libfreebsdnet::interface::VlanBatch batch;
+        auto results = batch.create(vlans, false);
+        for (size_t i = 0; i < results.size(); ++i) {
+          if (!results[i].succeeded()) {
+            printError("Failed to create " + vlans[i].name + ": " +
+                       std::strerror(results[i].error));
+            ++create.failed;
+            // Its settings cannot be applied either
+            size_t slot = configIndex[vlans[i].name];
+            configs[slot] = InterfaceConfig{};
+          }
+        }
+        std::erase_if(configs, [](const InterfaceConfig &config) {
+          return config.name.empty();
+        });
+        create.count += vlans.size();
+        create.elapsed += Clock::now() - phase;
+        vlans.clear();
+      }
+
+      phase = Clock::now();
+      if (!configs.empty()) {
+        libfreebsdnet::interface::ConfigApplier applier;
+        auto changes = applier.apply(configs);
+        if (changes.empty() && !applier.getLastError().empty()) {
+          printError("Failed to apply interface settings: " +
+                     applier.getLastError());
+          configure.failed += settings;
+        }
+        for (const auto &change : changes) {
+          if (!change.succeeded()) {
+            printError("Failed to configure " + change.interface + ": " +
+                       std::strerror(change.error));
+            ++configure.failed;
+          }
+        }
+        configure.count += settings;
+        configure.changes += changes.size();
+        configure.elapsed += Clock::now() - phase;
+      }
+      configs.clear();
+      configIndex.clear();
+      settings = 0;
+
+      phase = Clock::now();
+      if (!routes.empty()) {
+        auto results = routingTable.addEntries(routes);
+        for (size_t i = 0; i < results.size(); ++i) {
+          if (!results[i].succeeded()) {
+            printError("Failed to add route " +
+                       routes[i].destination.getCidr() + ": " +
+                       std::strerror(results[i].error));
+            ++route.failed;
+          }
+        }
+        route.count += routes.size();
+        route.elapsed += Clock::now() - phase;
+        routes.clear();
+      }
+    };
+
+    for (const auto &args : commands) {
+      if (stale) {
+        // Address settings start from what is configured, which the
+        // handlers just run may have changed
+        auto fresh = interfaceManager.getSnapshot();
+        if (fresh) {
+          snapshot = std::move(fresh);
+        }
+        stale = false;
+      }
+
+      if (args.size() == 5 && args[0] == "set" && args[1] == "interface") {
+        const std::string &name = args[2];
+        const std::string &property = args[3];
+        const std::string &value = args[4];
+        bool known = snapshot->find(name) || configIndex.contains(name);
+        VlanSpec vlan;
+        if (!known && parseVlanName(name, vlan)) {
+          vlans.push_back(vlan);
+          configFor(name).lower.push_back(vlan.parent);
+          known = true;
+        }
+
+        int number = 0;
+        libfreebsdnet::types::Address address;
+        if (known) {
+          if (property == "state" && (value == "up" || value == "down")) {
+            configFor(name).up = value == "up";
+            ++settings;
+            continue;
+          }
+          if (property == "mtu" && parseInt(value, number)) {
+            configFor(name).mtu = number;
+            ++settings;
+            continue;
+          }
+          if (property == "fib" && parseInt(value, number)) {
+            configFor(name).fib = number;
+            ++settings;
+            continue;
+          }
+          if (property == "address" &&
+              libfreebsdnet::types::Address::parse(value, address)) {
+            auto &config = configFor(name);
+            if (!config.addresses) {
+              // Addresses are added, so start from what is configured now
+              config.addresses.emplace();
+              if (auto record = snapshot->find(name)) {
+                *config.addresses = record->addresses;
+              }
+            }
+            if (std::find(config.addresses->begin(), config.addresses->end(),
+                          address) == config.addresses->end()) {
+              config.addresses->push_back(address);
+            }
+            ++settings;
+            continue;
+          }
+        }
+      } else if (args.size() >= 4 && (args[0] == "set" || args[0] == "add") &&
+                 args[1] == "route") {
+        RouteSpec spec;
+        if (parseRoute(args, spec)) {
+          routes.push_back(std::move(spec));
+          continue;
+        }
+      }
+
+      flush();
+      auto phase = Clock::now();
+      other.failed += dispatchCommand(args) ? 0 : 1;
+      ++other.count;
+      other.elapsed += Clock::now() - phase;
+      stale = true;
+    }
+    flush();
+
+    size_t failedTotal =
+        create.failed + other.failed + configure.failed + route.failed;
+    std::vector<std::string> summary;
+    if (create.count > 0) {
+      summary.push_back(formatPhase("create", create.count, create.failed,
+                                    create.elapsed));
+    }
+    if (other.count > 0) {
+      summary.push_back(
+          formatPhase("other", other.count, other.failed, other.elapsed));
+    }
+    if (configure.count > 0) {
+      summary.push_back(formatPhase("interface", configure.count,
+                                    configure.failed, configure.elapsed) +
+                        " (" + std::to_string(configure.changes) +
+                        " changes)");
+    }
+    if (route.count > 0) {
+      summary.push_back(
+          formatPhase("route", route.count, route.failed, route.elapsed));
+    }
+
+    for (const auto &line : summary) {
+      printInfo(line);
+    }
+    printInfo(formatPhase("total", commands.size(), failedTotal,
+                          Clock::now() - started));
+    return failedTotal == 0;
+  }
+
+} // namespace net
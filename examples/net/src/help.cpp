@@ -7,7 +7,6 @@
  * @year 2024
  */
 
-#include <algorithm>
 #include <iostream>
 #include <net_tool.hpp>
 
@@ -23,18 +22,23 @@ namespace net {
     std::cout << "  -v, --version       Show version information" << std::endl;
     std::cout << "  -i, --interactive   Start interactive shell" << std::endl;
     std::cout << "  -c, --command CMD   Execute single command" << std::endl;
+    std::cout << "  -b, --batch FILE    Replay a script in batches (- for stdin)" << std::endl;
     std::cout << std::endl;
     std::cout << "Commands:" << std::endl;
     std::cout << std::endl;
     
     std::cout << "SHOW COMMANDS:" << std::endl;
     std::cout << "  show interface                     Show all network interfaces" << std::endl;
+    std::cout << "  show interfaces --json             Show all interfaces as JSON" << std::endl;
     std::cout << "  show interface <name>              Show interface details" << std::endl;
     std::cout << "  show interface <name> <property>   Show specific property" << std::endl;
     std::cout << "  show interface type <type>         Show interfaces by type" << std::endl;
     std::cout << "  show route [fib <number>]          Show routing table" << std::endl;
     std::cout << "  show route <dest> [fib <num>]      Show specific route details" << std::endl;
     std::cout << "  show route stats [fib <num>]       Show routing statistics" << std::endl;
+    std::cout << "  show route ... [limit <n>] [prefix <cidr>] [interface <name>] [flags <UGHS...>]" << std::endl;
+    std::cout << "                                     Filter routes while they are read" << std::endl;
+    std::cout << "  show route changes [fib <num>] [wait <sec>]  Show route changes" << std::endl;
     std::cout << "  show system                         Show system network configuration" << std::endl;
     std::cout << std::endl;
     
@@ -74,7 +78,7 @@ namespace net {
     std::cout << std::endl;
     
     std::cout << "SAVE COMMANDS:" << std::endl;
-    std::cout << "  save state                                     Save current network state" << std::endl;
+    std::cout << "  save state [binary]                            Save current network state" << std::endl;
     std::cout << std::endl;
     
     std::cout << "UTILITY COMMANDS:" << std::endl;
@@ -104,6 +108,8 @@ namespace net {
     std::cout << "  set route 0.0.0.0 192.168.1.1 re0            Add default route" << std::endl;
     std::cout << "  save state > config.txt                       Save configuration" << std::endl;
     std::cout << "  net -c - < config.txt                         Restore configuration" << std::endl;
+    std::cout << "  save state binary > config.bin                Save compact configuration" << std::endl;
+    std::cout << "  net -b config.bin                             Restore configuration in batches" << std::endl;
   }
 
   void NetTool::showVersion() {
@@ -113,16 +119,13 @@ namespace net {
 
   bool NetTool::handleHelp(const std::vector<std::string> &args) {
     if (args.size() > 1) {
-      std::string cmd = args[1];
-      std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
-
-      auto it = commands.find(cmd);
-      if (it != commands.end()) {
-        std::cout << it->second.name << " - " << it->second.description
+      const Command *command = findCommand(args[1]);
+      if (command) {
+        std::cout << command->name << " - " << command->description
                   << std::endl;
-        std::cout << "Usage: " << it->second.usage << std::endl;
+        std::cout << "Usage: " << command->usage << std::endl;
       } else {
-        printError("Unknown command: " + cmd);
+        printError("Unknown command: " + args[1]);
         return false;
       }
     } else {
@@ -132,9 +132,8 @@ namespace net {
       } else if (property == "port") {
         // Add interface as lagg port
         if (iface->getType() == libfreebsdnet::interface::InterfaceType::LAGG) {
-          auto lagIface =
-              dynamic_cast<libfreebsdnet::interface::LagInterface *>(
-                  iface.get());
+          auto lagIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::LagInterface>(iface.get());
           if (lagIface) {
             bool allSuccess = true;
             std::vector<std::string> addedPorts;
@@ -208,9 +207,8 @@ namespace net {
         // Set interface mode (lacp, etc.)
         if (name.substr(0, 4) == "lagg") {
           // For LAGG interfaces, set the protocol
-          auto laggIface =
-              dynamic_cast<libfreebsdnet::interface::LagInterface *>(
-                  iface.get());
+          auto laggIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::LagInterface>(iface.get());
           if (laggIface) {
             libfreebsdnet::interface::LagProtocol protocol;
 
@@ -255,9 +253,8 @@ namespace net {
       } else if (property == "local") {
         // Set GIF local address
         if (name.substr(0, 3) == "gif") {
-          auto gifIface =
-              dynamic_cast<libfreebsdnet::interface::GifInterface *>(
-                  iface.get());
+          auto gifIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::GifInterface>(iface.get());
           if (gifIface) {
             if (gifIface->setLocalAddress(value)) {
               printSuccess("Set local address " + value +
@@ -279,9 +276,8 @@ namespace net {
       } else if (property == "remote") {
         // Set GIF remote address
         if (name.substr(0, 3) == "gif") {
-          auto gifIface =
-              dynamic_cast<libfreebsdnet::interface::GifInterface *>(
-                  iface.get());
+          auto gifIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::GifInterface>(iface.get());
           if (gifIface) {
             if (gifIface->setRemoteAddress(value)) {
               printSuccess("Set remote address " + value +
@@ -304,9 +300,8 @@ namespace net {
       } else if (property == "tunfib") {
         // Set tunnel FIB
         if (name.substr(0, 3) == "gif") {
-          auto gifIface =
-              dynamic_cast<libfreebsdnet::interface::GifInterface *>(
-                  iface.get());
+          auto gifIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::GifInterface>(iface.get());
           if (gifIface) {
             int fib = std::stoi(value);
             if (gifIface->setTunnelFib(fib)) {
@@ -68,9 +68,8 @@ namespace net {
       std::string stpStatus = "Unknown";
 
       // Cast to BridgeInterface to access bridge-specific methods
-      auto bridgeIface =
-          dynamic_cast<libfreebsdnet::interface::BridgeInterface *>(
-              interface.get());
+      auto bridgeIface = libfreebsdnet::interface::interface_cast<
+          libfreebsdnet::interface::BridgeInterface>(interface.get());
       if (bridgeIface) {
         // Get actual STP status
         if (bridgeIface->isStpEnabled()) {
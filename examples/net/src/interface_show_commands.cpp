@@ -8,6 +8,8 @@
  * @year 2024
  */
 
+#include <algorithm>
+#include <atomic>
 #include <interface/bridge.hpp>
 #include <interface/gif.hpp>
 #include <interface/lagg.hpp>
@@ -19,6 +21,7 @@
 #include <net_tool.hpp>
 #include <sstream>
 #include <system/config.hpp>
+#include <thread>
 
 namespace net {
 
@@ -80,115 +83,238 @@ namespace net {
     return result.empty() ? "-" : result;
   }
 
-  bool NetTool::handleShowInterfaces(const std::vector<std::string> &args) {
-    (void)args; // Suppress unused parameter warning
-    try {
-      auto interfaces = interfaceManager.getInterfaces();
+  namespace {
+
+    using libfreebsdnet::interface::Interface;
+    using libfreebsdnet::interface::InterfaceType;
+
+    const char *typeName(InterfaceType type) {
+      switch (type) {
+      case InterfaceType::ETHERNET:
+        return "Ethernet";
+      case InterfaceType::LOOPBACK:
+        return "Loopback";
+      case InterfaceType::BRIDGE:
+        return "Bridge";
+      case InterfaceType::WIRELESS:
+        return "IEEE80211";
+      case InterfaceType::L2VLAN:
+        return "L2VLAN";
+      case InterfaceType::EPAIR:
+        return "EthernetPair";
+      case InterfaceType::LAGG:
+        return "LinkAggregate";
+      case InterfaceType::GIF:
+        return "GenericTunnel";
+      default:
+        return "Unknown";
+      }
+    }
 
-      if (interfaces.empty()) {
-        printInfo("No interfaces found.");
-        return true;
+    const char *lagProtocolName(libfreebsdnet::interface::LagProtocol proto) {
+      switch (proto) {
+      case libfreebsdnet::interface::LagProtocol::FAILOVER:
+        return "failover";
+      case libfreebsdnet::interface::LagProtocol::FEC:
+        return "fec";
+      case libfreebsdnet::interface::LagProtocol::LACP:
+        return "lacp";
+      case libfreebsdnet::interface::LagProtocol::LOADBALANCE:
+        return "loadbalance";
+      case libfreebsdnet::interface::LagProtocol::ROUNDROBIN:
+        return "roundrobin";
+      default:
+        return "unknown";
       }
+    }
 
-      // Print flags legend at the top
-      printInfo("Flags Legend:");
-      printInfo("  U = UP, R = RUNNING, B = BROADCAST, M = MULTICAST");
-      printInfo(
-          "  L = LOOPBACK, P = POINTOPOINT, S = SIMPLEX, D = DRV_RUNNING");
-      printInfo("  A = NOARP, p = PROMISC, a = ALLMULTI, o = OACTIVE");
-      printInfo("  0/1/2 = LINK0/LINK1/LINK2");
-      printInfo("");
+    std::string joinNames(const std::vector<std::string> &names) {
+      std::string joined;
+      for (const auto &name : names) {
+        if (!joined.empty()) {
+          joined += ',';
+        }
+        joined += name;
+      }
+      return joined.empty() ? "none" : joined;
+    }
 
-      std::vector<std::vector<std::string>> data;
-      std::vector<std::string> headers = {"Name",   "Type", "MTU",  "Address",
-                                          "Status", "FIB",  "Flags"};
+    // Values that need a kernel call per interface
+    struct LiveColumns {
+      int fib = 0;
+      std::string details;
+    };
+
+    LiveColumns gather(const Interface &interface) {
+      LiveColumns live;
+      live.fib = interface.tryGetFib().value_or(0);
+      if (auto bridge = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::BridgeInterface>(&interface)) {
+        std::vector<std::string> names;
+        for (const auto &member : bridge->getMembers()) {
+          names.push_back(member.name);
+        }
+        live.details = "members " + joinNames(names);
+      } else if (auto lagg = libfreebsdnet::interface::interface_cast<
+                     libfreebsdnet::interface::LagInterface>(&interface)) {
+        live.details = std::string(lagProtocolName(lagg->getProtocol())) +
+                       " ports " + joinNames(lagg->getPorts());
+      } else if (auto gif = libfreebsdnet::interface::interface_cast<
+                     libfreebsdnet::interface::GifInterface>(&interface)) {
+        std::string local = gif->getLocalAddress();
+        std::string remote = gif->getRemoteAddress();
+        if (!local.empty() || !remote.empty()) {
+          live.details = local + " -> " + remote;
+        }
+      }
+      return live;
+    }
 
-      for (const auto &interface : interfaces) {
-        // Get interface type from the interface object
-        libfreebsdnet::interface::InterfaceType interfaceType =
-            interface->getType();
-        std::string type_str;
-        switch (interfaceType) {
-        case libfreebsdnet::interface::InterfaceType::ETHERNET:
-          type_str = "Ethernet";
-          break;
-        case libfreebsdnet::interface::InterfaceType::LOOPBACK:
-          type_str = "Loopback";
-          break;
-        case libfreebsdnet::interface::InterfaceType::BRIDGE:
-          type_str = "Bridge";
-          break;
-        case libfreebsdnet::interface::InterfaceType::WIRELESS:
-          type_str = "IEEE80211";
+    void appendJsonString(std::string &out, std::string_view text) {
+      static constexpr char hex[] = "0123456789abcdef";
+      out.push_back('"');
+      for (char c : text) {
+        switch (c) {
+        case '"':
+          out.append("\\\"");
           break;
-        case libfreebsdnet::interface::InterfaceType::L2VLAN:
-          type_str = "L2VLAN";
-          break;
-        case libfreebsdnet::interface::InterfaceType::EPAIR:
-          type_str = "EthernetPair";
+        case '\\':
+          out.append("\\\\");
           break;
-        case libfreebsdnet::interface::InterfaceType::LAGG:
-          type_str = "LinkAggregate";
-          break;
-        case libfreebsdnet::interface::InterfaceType::GIF:
-          type_str = "GenericTunnel";
+        case '\n':
+          out.append("\\n");
           break;
         default:
-          type_str = "Unknown";
+          if (static_cast<unsigned char>(c) < 0x20) {
+            out.append("\\u00");
+            out.push_back(hex[(c >> 4) & 0xf]);
+            out.push_back(hex[c & 0xf]);
+          } else {
+            out.push_back(c);
+          }
           break;
         }
+      }
+      out.push_back('"');
+    }
 
-        std::string status = interface->isUp() ? "UP" : "DOWN";
-        std::string flags_str = formatFlags(interface->getFlags());
+  } // namespace
 
-        // Get addresses from the interface object
-        auto addresses = interface->getAddresses();
-        if (addresses.empty()) {
-          // No addresses - show one row with "None"
-          std::vector<std::string> row;
-          row.push_back(interface->getName());
-          row.push_back(type_str);
-          row.push_back(std::to_string(interface->getMtu()));
-          row.push_back("None");
-          row.push_back(status);
-          // Get FIB for this interface
-          try {
-            row.push_back(std::to_string(interface->getFib()));
-          } catch (...) {
-            row.push_back("0"); // Default FIB on error
-          }
-          row.push_back(flags_str);
-          data.push_back(row);
-        } else {
-          // Get FIB for this interface (only need to do this once)
-          std::string fib_str = "0"; // Default FIB
-          try {
-            fib_str = std::to_string(interface->getFib());
-          } catch (...) {
-            // Keep default FIB on error
-          }
+  bool NetTool::handleShowInterfaces(const std::vector<std::string> &args) {
+    bool json = false;
+    for (size_t i = 2; i < args.size(); i++) {
+      if (args[i] == "--json" || args[i] == "json") {
+        json = true;
+      } else {
+        printError("Usage: show interfaces [--json]");
+        return false;
+      }
+    }
+
+    try {
+      // Name, MTU, flags and addresses come from one snapshot
+      auto snapshot = interfaceManager.getSharedSnapshot();
+      if (!snapshot) {
+        printError("Failed to read interfaces");
+        return false;
+      }
+      auto interfaces = interfaceManager.getInterfaces(*snapshot);
 
-          // Show each address on a separate row
-          for (size_t i = 0; i < addresses.size(); i++) {
-            std::vector<std::string> row;
-            row.push_back(i == 0 ? interface->getName()
-                                 : ""); // Only show name on first row
-            row.push_back(i == 0 ? type_str
-                                 : ""); // Only show type on first row
-            row.push_back(i == 0 ? std::to_string(interface->getMtu())
-                                 : ""); // Only show MTU on first row
-            row.push_back(addresses[i].getCidr());
-            row.push_back(i == 0 ? status
-                                 : ""); // Only show status on first row
-            row.push_back(i == 0 ? fib_str : ""); // Only show FIB on first row
-            row.push_back(i == 0 ? flags_str
-                                 : ""); // Only show flags on first row
-            data.push_back(row);
+      if (interfaces.empty()) {
+        printInfo("No interfaces found.");
+        return true;
+      }
+
+      // FIBs and type details need ioctls; spread them over a few workers,
+      // each with its own control socket
+      std::vector<LiveColumns> live(interfaces.size());
+      std::atomic<size_t> next{0};
+      auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < interfaces.size();) {
+          live[i] = gather(*interfaces[i]);
+        }
+      };
+      size_t workers = std::min<size_t>(
+          std::clamp(std::thread::hardware_concurrency(), 1u, 4u),
+          interfaces.size());
+      std::vector<std::thread> threads;
+      for (size_t slot = 1; slot < workers; ++slot) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+
+      std::string out;
+      if (json) {
+        out.reserve(interfaces.size() * 256);
+        out.push_back('[');
+        for (size_t i = 0; i < interfaces.size(); i++) {
+          const auto &interface = interfaces[i];
+          out.append(i == 0 ? "\n  {\"name\": " : ",\n  {\"name\": ");
+          appendJsonString(out, interface->getName());
+          out.append(", \"type\": ");
+          appendJsonString(out, typeName(interface->getType()));
+          out.append(", \"mtu\": ").append(std::to_string(interface->getMtu()));
+          out.append(", \"up\": ").append(interface->isUp() ? "true" : "false");
+          out.append(", \"fib\": ").append(std::to_string(live[i].fib));
+          out.append(", \"flags\": ");
+          appendJsonString(out, formatFlags(interface->getFlags()));
+          out.append(", \"addresses\": [");
+          bool first = true;
+          for (const auto &address : interface->getAddresses()) {
+            if (!first) {
+              out.append(", ");
+            }
+            appendJsonString(out, address.getCidr());
+            first = false;
           }
+          out.append("], \"details\": ");
+          appendJsonString(out, live[i].details);
+          out.push_back('}');
+        }
+        out.append("\n]\n");
+        writeOutput(out);
+        return true;
+      }
+
+      std::vector<std::vector<std::string>> data;
+      data.reserve(interfaces.size());
+      std::vector<std::string> headers = {"Name", "Type",  "MTU",    "Address",
+                                          "Status", "FIB", "Flags", "Details"};
+
+      for (size_t i = 0; i < interfaces.size(); i++) {
+        const auto &interface = interfaces[i];
+        std::string typeStr = typeName(interface->getType());
+        std::string mtuStr = std::to_string(interface->getMtu());
+        std::string status = interface->isUp() ? "UP" : "DOWN";
+        std::string fibStr = std::to_string(live[i].fib);
+        std::string flagsStr = formatFlags(interface->getFlags());
+
+        // One row per address; only the first row carries the other columns
+        auto addresses = interface->getAddresses();
+        size_t rows = std::max<size_t>(addresses.size(), 1);
+        for (size_t row = 0; row < rows; row++) {
+          bool first = row == 0;
+          data.push_back(
+              {first ? interface->getName() : "", first ? typeStr : "",
+               first ? mtuStr : "",
+               addresses.empty() ? "None" : addresses[row].getCidr(),
+               first ? status : "", first ? fibStr : "",
+               first ? flagsStr : "", first ? live[i].details : ""});
         }
       }
 
-      printTable(data, headers);
+      // Legend and table go out in one write
+      out.append("\033[36mFlags Legend:\n"
+                 "  U = UP, R = RUNNING, B = BROADCAST, M = MULTICAST\n"
+                 "  L = LOOPBACK, P = POINTOPOINT, S = SIMPLEX, "
+                 "D = DRV_RUNNING\n"
+                 "  A = NOARP, p = PROMISC, a = ALLMULTI, o = OACTIVE\n"
+                 "  0/1/2 = LINK0/LINK1/LINK2\n\n\033[0m");
+      formatTable(out, data, headers);
+      writeOutput(out);
       return true;
     } catch (const std::exception &e) {
       printError("Failed to get interfaces: " + std::string(e.what()));
@@ -271,7 +397,8 @@ namespace net {
         auto interfaceType = iface->getType();
         if (interfaceType == libfreebsdnet::interface::InterfaceType::LAGG) {
           // Show LAGG-specific interface summary
-          auto laggIface = dynamic_cast<libfreebsdnet::interface::LagInterface *>(iface.get());
+          auto laggIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::LagInterface>(iface.get());
           
           std::string status = iface->isUp() ? "UP" : "DOWN";
           auto flags = iface->getFlags();
@@ -497,9 +624,8 @@ namespace net {
 
         // Show additional interface-specific information
         if (type_str == "Bridge") {
-          auto bridgeIface =
-              dynamic_cast<libfreebsdnet::interface::BridgeInterface *>(
-                  iface.get());
+          auto bridgeIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::BridgeInterface>(iface.get());
           if (bridgeIface) {
             printInfo("  Bridge Info:");
             printInfo("    STP:          " +
@@ -537,9 +663,8 @@ namespace net {
             }
           }
         } else if (type_str == "GenericTunnel") {
-          auto gifIface =
-              dynamic_cast<libfreebsdnet::interface::GifInterface *>(
-                  iface.get());
+          auto gifIface = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::GifInterface>(iface.get());
           if (gifIface) {
             printInfo("  GIF Info:");
             std::string localAddr = gifIface->getLocalAddress();
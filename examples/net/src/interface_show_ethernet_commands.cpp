@@ -8,6 +8,7 @@
  * @year 2024
  */
 
+#include <interface/capability.hpp>
 #include <interface/ethernet.hpp>
 #include <iostream>
 #include <net/if_types.h>
@@ -15,6 +16,7 @@
 #include <net_tool.hpp>
 #include <sstream>
 #include <system/config.hpp>
+#include <unordered_map>
 
 namespace net {
 
@@ -43,15 +45,21 @@ namespace net {
     printInfo("===================");
     printInfo("");
 
+    // Media for every port in one parallel pass
+    std::unordered_map<std::string, libfreebsdnet::interface::MediaSnapshot>
+        media;
+    for (auto &snapshot : interfaceManager.getEthernetMedia()) {
+      media.emplace(snapshot.name, std::move(snapshot));
+    }
+
     // Prepare table data
     std::vector<std::vector<std::string>> data;
     std::vector<std::string> headers = {
         "Interface", "Status", "MTU", "FIB", "MAC Address", "Media", "Options"};
 
     for (const auto &interface : ethernetInterfaces) {
-      auto ethernetIface =
-          dynamic_cast<libfreebsdnet::interface::EthernetInterface *>(
-              interface.get());
+      auto ethernetIface = libfreebsdnet::interface::interface_cast<
+          libfreebsdnet::interface::EthernetInterface>(interface.get());
       if (!ethernetIface) {
         continue;
       }
@@ -63,38 +71,8 @@ namespace net {
         capabilityList.push_back("None");
       } else {
         for (const auto &cap : capabilities) {
-          switch (cap) {
-          case libfreebsdnet::interface::Capability::RXCSUM:
-            capabilityList.push_back("RXCSUM");
-            break;
-          case libfreebsdnet::interface::Capability::TXCSUM:
-            capabilityList.push_back("TXCSUM");
-            break;
-          case libfreebsdnet::interface::Capability::VLAN_MTU:
-            capabilityList.push_back("VLAN_MTU");
-            break;
-          case libfreebsdnet::interface::Capability::VLAN_HWTAGGING:
-            capabilityList.push_back("VLAN_HWTAGGING");
-            break;
-          case libfreebsdnet::interface::Capability::VLAN_HWCSUM:
-            capabilityList.push_back("VLAN_HWCSUM");
-            break;
-          case libfreebsdnet::interface::Capability::WOL_MAGIC:
-            capabilityList.push_back("WOL_MAGIC");
-            break;
-          case libfreebsdnet::interface::Capability::LINKSTATE:
-            capabilityList.push_back("LINKSTATE");
-            break;
-          case libfreebsdnet::interface::Capability::TSO4:
-            capabilityList.push_back("TSO4");
-            break;
-          case libfreebsdnet::interface::Capability::TSO6:
-            capabilityList.push_back("TSO6");
-            break;
-          case libfreebsdnet::interface::Capability::LRO:
-            capabilityList.push_back("LRO");
-            break;
-          }
+          capabilityList.emplace_back(
+              libfreebsdnet::interface::capabilityName(cap));
         }
       }
 
@@ -104,8 +82,11 @@ namespace net {
         macAddress = "Unknown";
       }
 
-      // Get media information and format it
-      auto mediaInfo = ethernetIface->getMediaInfo();
+      // Format the media information; ports missed by the parallel pass
+      // are read directly
+      auto found = media.find(interface->getName());
+      auto mediaInfo = found != media.end() ? found->second.info
+                                            : ethernetIface->getMediaInfo();
       std::stringstream mediaStr;
 
       // Media type
@@ -131,51 +112,8 @@ namespace net {
       }
 
       // Media subtype
-      std::string subtypeStr;
-      switch (mediaInfo.subtype) {
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10_T:
-        subtypeStr = "10baseT";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10_2:
-        subtypeStr = "10base2";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10_5:
-        subtypeStr = "10base5";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_100_TX:
-        subtypeStr = "100baseTX";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_100_FX:
-        subtypeStr = "100baseFX";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_1000_T:
-        subtypeStr = "1000baseT";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_1000_SX:
-        subtypeStr = "1000baseSX";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_1000_LX:
-        subtypeStr = "1000baseLX";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10G_T:
-        subtypeStr = "10GbaseT";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10G_SR:
-        subtypeStr = "10GbaseSR";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_10G_LR:
-        subtypeStr = "10GbaseLR";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_2500_T:
-        subtypeStr = "2500baseT";
-        break;
-      case libfreebsdnet::interface::MediaSubtype::ETHERNET_5000_T:
-        subtypeStr = "5000baseT";
-        break;
-      default:
-        subtypeStr = "unknown";
-        break;
-      }
+      std::string subtypeStr =
+          libfreebsdnet::interface::mediaSubtypeName(mediaInfo.subtype);
 
       // Add subtype in parentheses
       mediaStr << " (" << subtypeStr;
@@ -48,8 +48,8 @@ namespace net {
                                         "Remote", "FIB"};
 
     for (const auto &interface : gifInterfaces) {
-      auto gifIface = dynamic_cast<libfreebsdnet::interface::GifInterface *>(
-          interface.get());
+      auto gifIface = libfreebsdnet::interface::interface_cast<
+          libfreebsdnet::interface::GifInterface>(interface.get());
       if (!gifIface) {
         continue;
       }
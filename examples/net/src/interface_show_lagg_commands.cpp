@@ -58,8 +58,8 @@ namespace net {
       std::string hash = "Unknown";
 
       // Cast to LagInterface to get lagg-specific information
-      auto laggIface = dynamic_cast<libfreebsdnet::interface::LagInterface *>(
-          interface.get());
+      auto laggIface = libfreebsdnet::interface::interface_cast<
+          libfreebsdnet::interface::LagInterface>(interface.get());
       if (laggIface) {
         // Get ports from LagInterface
         portList = laggIface->getPorts();
@@ -12,7 +12,7 @@
 
 namespace net {
 
-  NetTool::NetTool() { initializeCommands(); }
+  NetTool::NetTool() = default;
 
   NetTool::~NetTool() = default;
 
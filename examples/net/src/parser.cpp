@@ -9,6 +9,9 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <net_tool.hpp>
 
@@ -26,9 +29,28 @@ namespace net {
         return false;
       } else if (arg == "-i" || arg == "--interactive") {
         interactive = true;
+      } else if (arg == "-b" || arg == "--batch") {
+        if (i + 1 < argc) {
+          std::string path = argv[++i];
+          if (path == "-") {
+            return runBatch(std::cin);
+          }
+          std::ifstream file(path, std::ios::binary);
+          if (!file) {
+            printError("Cannot open " + path);
+            return false;
+          }
+          return runBatch(file);
+        } else {
+          printError("Missing file after -b/--batch");
+          return false;
+        }
       } else if (arg == "-c" || arg == "--command") {
         if (i + 1 < argc) {
           std::string command = argv[++i];
+          if (command == "-") {
+            return runScript(std::cin);
+          }
           return executeCommand(command);
         } else {
           printError("Missing command after -c/--command");
@@ -40,168 +62,143 @@ namespace net {
     return true;
   }
 
-  void NetTool::initializeCommands() {
-    commands["show"] = {
-        "show", "Show information (interfaces, routes, etc.)",
-        [this](const std::vector<std::string> &args) {
-          if (args.size() < 2) {
-            printError("Usage: show <interface|route> [options]");
-            return false;
-          }
+  namespace {
 
-          if (args[1] == "interfaces" ||
-              (args[1] == "interface" && args.size() == 2)) {
-            return handleShowInterfaces(args);
-          } else if (args[1] == "interface" && args.size() > 2) {
-            if (args[2] == "type" && args.size() > 3) {
-              return handleShowInterfaceType(args);
-            } else {
-              return handleShowInterfaceInfo(args);
-            }
-          } else if (args[1] == "route") {
-            if (args.size() > 2 && args[2] == "stats") {
-              return handleShowRouteStats(args);
-            } else {
-              return handleShowRoute(args);
-            }
-          } else if (args[1] == "system") {
-            return handleShowSystem(args);
-          } else {
-            printError("Unknown show target: " + args[1]);
-            return false;
-          }
-        },
-        "show <interface|route> [options]"};
-
-    commands["set"] = {
-        "set", "Set interface or route properties",
-        [this](const std::vector<std::string> &args) {
-          if (args.size() < 2) {
-            printError("Usage: set <interface|interfaces|route> <name> "
-                       "<property> <value>");
-            return false;
-          }
+    constexpr char lower(char c) {
+      return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
 
-          if (args[1] == "interface" || args[1] == "interfaces") {
-            return handleSetInterface(args);
-          } else if (args[1] == "route") {
-            return handleSetRoute(args);
-          } else if (args[1] == "system") {
-            return handleSetSystem(args);
-          } else {
-            printError("Unknown set target: " + args[1]);
-            return false;
-          }
-        },
-        "set <interface|interfaces|route> <name> <property> <value>"};
-
-    commands["delete"] = {
-        "delete", "Delete interface, interface properties, or routes",
-        [this](const std::vector<std::string> &args) {
-          if (args.size() < 2) {
-            printError(
-                "Usage: delete <interface|interfaces|route> <name> [property]");
-            return false;
-          }
+    constexpr bool equalsLower(std::string_view text, std::string_view word) {
+      return text.size() == word.size() &&
+             std::equal(text.begin(), text.end(), word.begin(),
+                        [](char a, char b) { return lower(a) == b; });
+    }
 
-          if (args[1] == "interface" || args[1] == "interfaces") {
-            return handleDeleteInterface(args);
-          } else if (args[1] == "bridge") {
-            return handleDeleteBridge(args);
-          } else if (args[1] == "lagg") {
-            return handleDeleteLagg(args);
-          } else if (args[1] == "system") {
-            return handleDeleteSystem(args);
-          } else if (args[1] == "route") {
-            return handleDeleteRoute(args);
-          } else {
-            printError("Unknown delete target: " + args[1]);
-            return false;
-          }
-        },
-        "delete <interface|interfaces|route> <name> [property]"};
-
-    commands["del"] = {
-        "del",
-        "Delete interface, interface properties, or routes (alias for delete)",
-        [this](const std::vector<std::string> &args) {
-          return commands["delete"].handler(args);
-        },
-        "del <interface|interfaces|route> <name> [property]"};
-
-    commands["add"] = {
-        "add", "Add routes",
-        [this](const std::vector<std::string> &args) {
-          if (args.size() < 2) {
-            printError("Usage: add <route> <destination> <gateway> [interface] "
-                       "[fib <number>]");
-            return false;
-          }
+    // Sorted by name for binary search
+    constexpr std::array COMMANDS = {
+        Command{"add", "Add routes",
+                "add route <destination> <gateway> [interface] [fib "
+                "<number>]"},
+        Command{"clear", "Clear the screen", "clear"},
+        Command{"del",
+                "Delete interface, interface properties, or routes (alias "
+                "for delete)",
+                "del <interface|interfaces|route> <name> [property]"},
+        Command{"delete", "Delete interface, interface properties, or routes",
+                "delete <interface|interfaces|route> <name> [property]"},
+        Command{"exit", "Exit the program", "exit"},
+        Command{"flush", "Flush routes", "flush route [fib <number>]"},
+        Command{"help", "Show help information", "help [command]"},
+        Command{"quit", "Exit the program", "quit"},
+        Command{"save", "Save current network state", "save state [binary]"},
+        Command{"set", "Set interface or route properties",
+                "set <interface|interfaces|route> <name> <property> <value>"},
+        Command{"show", "Show information (interfaces, routes, etc.)",
+                "show <interface|route> [options]"},
+    };
+
+    static_assert(std::ranges::is_sorted(COMMANDS, {}, &Command::name));
+
+    // Case-folded order; table names are lowercase, so it is also the
+    // table's order
+    constexpr bool lessLower(std::string_view a, std::string_view b) {
+      return std::lexicographical_compare(
+          a.begin(), a.end(), b.begin(), b.end(),
+          [](char x, char y) { return lower(x) < lower(y); });
+    }
 
-          if (args[1] == "route") {
-            return handleAddRoute(args);
-          } else {
-            printError("Unknown add target: " + args[1]);
-            return false;
-          }
-        },
-        "add route <destination> <gateway> [interface] [fib <number>]"};
-
-    commands["help"] = {"help", "Show help information",
-                        [this](const std::vector<std::string> &args) {
-                          return handleHelp(args);
-                        },
-                        "help [command]"};
-
-    commands["exit"] = {"exit", "Exit the program",
-                        [this](const std::vector<std::string> &args) {
-                          return handleExit(args);
-                        },
-                        "exit"};
-
-    commands["quit"] = {"quit", "Exit the program",
-                        [this](const std::vector<std::string> &args) {
-                          return handleQuit(args);
-                        },
-                        "quit"};
-
-    commands["clear"] = {"clear", "Clear the screen",
-                         [this](const std::vector<std::string> &args) {
-                           return handleClear(args);
-                         },
-                         "clear"};
-
-    commands["flush"] = {"flush", "Flush routes",
-                         [this](const std::vector<std::string> &args) {
-                           if (args.size() < 2) {
-                             printError("Usage: flush <route> [fib <number>]");
-                             return false;
-                           }
-
-                           if (args[1] == "route") {
-                             return handleFlushRoutes(args);
-                           } else {
-                             printError("Unknown flush target: " + args[1]);
-                             return false;
-                           }
-                         },
-                         "flush route [fib <number>]"};
-
-    commands["save"] = {"save", "Save current network state",
-                        [this](const std::vector<std::string> &args) {
-                          if (args.size() < 2) {
-                            printError("Usage: save <state>");
-                            return false;
-                          }
-
-                          if (args[1] == "state") {
-                            return handleSaveState(args);
-                          } else {
-                            printError("Unknown save target: " + args[1]);
-                            return false;
-                          }
-                        },
-                        "save <state>"};
+    const Command *lookup(std::string_view name) {
+      auto it = std::ranges::lower_bound(COMMANDS, name, lessLower,
+                                         &Command::name);
+      return it != COMMANDS.end() && equalsLower(name, it->name) ? &*it
+                                                                 : nullptr;
+    }
+
+  } // namespace
+
+  const Command *NetTool::findCommand(std::string_view name) {
+    return lookup(name);
+  }
+
+  NetTool::Handler
+  NetTool::findHandler(std::span<const std::string_view> words) {
+    // One row per grammar branch: command, second word (empty matches
+    // anything), third word, and the argument count range. Rows of a
+    // command are tried in order, so specific rows come first.
+    struct Route {
+      std::string_view command;
+      std::string_view target;
+      std::string_view sub;
+      size_t minArgs;
+      size_t maxArgs;
+      Handler handler;
+    };
+    constexpr size_t ANY = SIZE_MAX;
+    static constexpr std::array ROUTES = {
+        Route{"add", "route", "", 2, ANY, &NetTool::handleAddRoute},
+        Route{"clear", "", "", 1, ANY, &NetTool::handleClear},
+        Route{"del", "interface", "", 2, ANY, &NetTool::handleDeleteInterface},
+        Route{"del", "interfaces", "", 2, ANY, &NetTool::handleDeleteInterface},
+        Route{"del", "bridge", "", 2, ANY, &NetTool::handleDeleteBridge},
+        Route{"del", "lagg", "", 2, ANY, &NetTool::handleDeleteLagg},
+        Route{"del", "system", "", 2, ANY, &NetTool::handleDeleteSystem},
+        Route{"del", "route", "", 2, ANY, &NetTool::handleDeleteRoute},
+        Route{"delete", "interface", "", 2, ANY,
+              &NetTool::handleDeleteInterface},
+        Route{"delete", "interfaces", "", 2, ANY,
+              &NetTool::handleDeleteInterface},
+        Route{"delete", "bridge", "", 2, ANY, &NetTool::handleDeleteBridge},
+        Route{"delete", "lagg", "", 2, ANY, &NetTool::handleDeleteLagg},
+        Route{"delete", "system", "", 2, ANY, &NetTool::handleDeleteSystem},
+        Route{"delete", "route", "", 2, ANY, &NetTool::handleDeleteRoute},
+        Route{"exit", "", "", 1, ANY, &NetTool::handleExit},
+        Route{"flush", "route", "", 2, ANY, &NetTool::handleFlushRoutes},
+        Route{"help", "", "", 1, ANY, &NetTool::handleHelp},
+        Route{"quit", "", "", 1, ANY, &NetTool::handleQuit},
+        Route{"save", "state", "", 2, ANY, &NetTool::handleSaveState},
+        Route{"set", "interface", "", 2, ANY, &NetTool::handleSetInterface},
+        Route{"set", "interfaces", "", 2, ANY, &NetTool::handleSetInterface},
+        Route{"set", "route", "", 2, ANY, &NetTool::handleSetRoute},
+        Route{"set", "system", "", 2, ANY, &NetTool::handleSetSystem},
+        Route{"show", "interfaces", "", 2, ANY, &NetTool::handleShowInterfaces},
+        Route{"show", "interface", "", 2, 2, &NetTool::handleShowInterfaces},
+        Route{"show", "interface", "type", 4, ANY,
+              &NetTool::handleShowInterfaceType},
+        Route{"show", "interface", "", 3, ANY,
+              &NetTool::handleShowInterfaceInfo},
+        Route{"show", "route", "stats", 3, ANY,
+              &NetTool::handleShowRouteStats},
+        Route{"show", "route", "changes", 3, ANY,
+              &NetTool::handleShowRouteChanges},
+        Route{"show", "route", "", 2, ANY, &NetTool::handleShowRoute},
+        Route{"show", "system", "", 2, ANY, &NetTool::handleShowSystem},
+    };
+    static_assert(std::ranges::is_sorted(ROUTES, {}, &Route::command));
+
+    const Command *command = lookup(words[0]);
+    if (!command) {
+      printError("Unknown command: " + std::string(words[0]));
+      printInfo("Type 'help' for available commands.");
+      return nullptr;
+    }
+
+    auto [first, last] =
+        std::ranges::equal_range(ROUTES, command->name, {}, &Route::command);
+    for (auto it = first; it != last; ++it) {
+      if (words.size() >= it->minArgs && words.size() <= it->maxArgs &&
+          (it->target.empty() || words[1] == it->target) &&
+          (it->sub.empty() || words[2] == it->sub)) {
+        return it->handler;
+      }
+    }
+
+    if (words.size() < 2) {
+      printError("Usage: " + std::string(command->usage));
+    } else {
+      printError("Unknown " + std::string(command->name) +
+                 " target: " + std::string(words[1]));
+    }
+    return nullptr;
   }
 
 } // namespace net
@@ -7,116 +7,229 @@
  * @year 2024
  */
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
-#include <map>
+#include <net/if.h>
+#include <net/route.h>
 #include <net_tool.hpp>
+#include <routing/diff.hpp>
+#include <routing/lpm.hpp>
+#include <sys/socket.h>
+#include <thread>
 
 namespace net {
 
-  bool NetTool::handleShowRoute(const std::vector<std::string> &args) {
-    try {
-      int fib = 0; // Default FIB
+  namespace {
+
+    using libfreebsdnet::routing::RouteFilter;
+    using libfreebsdnet::routing::RouteRecord;
+    using libfreebsdnet::routing::RouteStats;
+
+    // Flag letters in display order
+    constexpr std::array<std::pair<char, uint32_t>, 16> FLAG_LETTERS = {{
+        {'U', RTF_UP},        {'G', RTF_GATEWAY},  {'H', RTF_HOST},
+        {'R', RTF_REJECT},    {'D', RTF_DYNAMIC},  {'M', RTF_MODIFIED},
+        {'N', RTF_DONE},      {'X', RTF_XRESOLVE}, {'L', RTF_LLINFO},
+        {'S', RTF_STATIC},    {'B', RTF_BLACKHOLE}, {'2', RTF_PROTO2},
+        {'1', RTF_PROTO1},    {'3', RTF_PROTO3},   {'F', RTF_FIXEDMTU},
+        {'P', RTF_PINNED},
+    }};
+
+    // Rows used to size the columns before the rest are streamed
+    constexpr size_t SAMPLE_ROWS = 64;
+
+    using RouteRow = std::array<std::string, 6>;
 
-      // Check for FIB specification
-      if (args.size() >= 4 && args[2] == "fib") {
-        fib = std::stoi(args[3]);
+    bool isRouteOption(const std::string &word) {
+      return word == "fib" || word == "limit" || word == "prefix" ||
+             word == "interface" || word == "flags";
+    }
+
+    // [fib N] [limit N] [prefix CIDR] [interface NAME] [flags LETTERS]
+    bool parseRouteOptions(const std::vector<std::string> &args,
+                           size_t start, int &fib, RouteFilter &filter,
+                           std::string &error) {
+      for (size_t i = start; i < args.size(); i += 2) {
+        const std::string &option = args[i];
+        if (!isRouteOption(option) || i + 1 >= args.size()) {
+          error = "Expected fib, limit, prefix, interface or flags with a "
+                  "value, got: " + option;
+          return false;
+        }
+        const std::string &value = args[i + 1];
+        if (option == "fib") {
+          fib = std::stoi(value);
+        } else if (option == "limit") {
+          filter.limit = std::stoul(value);
+        } else if (option == "prefix") {
+          if (!libfreebsdnet::types::Address::parse(value, filter.prefix)) {
+            error = "Invalid prefix: " + value;
+            return false;
+          }
+        } else if (option == "interface") {
+          filter.index = if_nametoindex(value.c_str());
+          if (filter.index == 0) {
+            error = "Unknown interface: " + value;
+            return false;
+          }
+        } else {
+          for (char letter : value) {
+            auto it = std::find_if(
+                FLAG_LETTERS.begin(), FLAG_LETTERS.end(),
+                [letter](const auto &entry) { return entry.first == letter; });
+            if (it == FLAG_LETTERS.end()) {
+              error = "Unknown route flag: " + std::string(1, letter);
+              return false;
+            }
+            filter.flags |= it->second;
+          }
+        }
       }
+      return true;
+    }
 
-      auto entries = routingTable.getEntries(fib);
+    RouteRow formatRoute(const RouteRecord &record) {
+      RouteRow row;
+      std::string destination = record.formatDestination();
+      size_t scope = destination.find('%');
+      if (scope != std::string::npos) {
+        row[2] = destination.substr(scope + 1);
+        destination.resize(scope);
+      }
+      row[1] = record.formatNetmask();
+      if (!row[1].empty()) {
+        destination += "/" + row[1];
+      }
+      row[0] = std::move(destination);
+      row[3] = record.formatGateway();
+      for (const auto &[letter, bit] : FLAG_LETTERS) {
+        if (record.flags & bit) {
+          row[4].push_back(letter);
+        }
+      }
+      row[5] = record.formatInterface();
+      return row;
+    }
 
-      if (entries.empty()) {
-        printInfo("No routes found for FIB " + std::to_string(fib));
-        return true;
+    // Table that fixes its column widths from the first rows and streams
+    // everything after them
+    class RouteTableWriter {
+    public:
+      void add(RouteRow row) {
+        if (!started) {
+          sample.push_back(std::move(row));
+          if (sample.size() == SAMPLE_ROWS) {
+            start();
+          }
+          return;
+        }
+        print(row);
       }
 
-      // Print route flags legend
-      std::cout << "Route Flags Legend:" << std::endl;
-      std::cout << "  U = UP, G = GATEWAY, H = HOST, R = REJECT, D = DYNAMIC" << std::endl;
-      std::cout << "  M = MODIFIED, N = DONE, X = XRESOLVE, L = LLINFO, S = STATIC" << std::endl;
-      std::cout << "  B = BLACKHOLE, 2 = PROTO2, 1 = PROTO1, 3 = PROTO3" << std::endl;
-      std::cout << "  F = FIXEDMTU, P = PINNED" << std::endl;
-      std::cout << std::endl;
+      // Returns the number of rows written
+      size_t finish() {
+        if (!started && !sample.empty()) {
+          start();
+        }
+        std::cout.flush();
+        return rows;
+      }
 
-      std::vector<std::vector<std::string>> data;
-      std::vector<std::string> headers = {
+    private:
+      static constexpr std::array<std::string_view, 6> HEADERS = {
           "Destination", "Netmask", "Scope", "Gateway", "Flags", "Interface"};
 
-      for (const auto &entry : entries) {
-        std::vector<std::string> row;
+      std::vector<RouteRow> sample;
+      std::array<size_t, 6> widths{};
+      bool started = false;
+      size_t rows = 0;
+
+      void start() {
+        started = true;
+        for (size_t i = 0; i < HEADERS.size(); ++i) {
+          widths[i] = HEADERS[i].size();
+          for (const auto &row : sample) {
+            widths[i] = std::max(widths[i], row[i].size());
+          }
+        }
 
-        // Use CIDR notation for network routes, no CIDR for host routes
-        std::string destination = entry->getDestination();
-        std::string scope_interface = "";
+        std::cout << "Route Flags Legend:\n"
+                  << "  U = UP, G = GATEWAY, H = HOST, R = REJECT, "
+                     "D = DYNAMIC\n"
+                  << "  M = MODIFIED, N = DONE, X = XRESOLVE, L = LLINFO, "
+                     "S = STATIC\n"
+                  << "  B = BLACKHOLE, 2 = PROTO2, 1 = PROTO1, 3 = PROTO3\n"
+                  << "  F = FIXEDMTU, P = PINNED\n\n";
+        for (size_t i = 0; i < HEADERS.size(); ++i) {
+          center(HEADERS[i], widths[i] + 1);
+        }
+        std::cout << '\n';
+        for (size_t width : widths) {
+          std::cout << std::string(width + 1, '-');
+        }
+        std::cout << '\n';
 
-        // Extract scope interface from IPv6 addresses
-        if (destination.find('%') != std::string::npos) {
-          size_t scope_pos = destination.find('%');
-          scope_interface = destination.substr(scope_pos + 1);
-          destination = destination.substr(0, scope_pos);
+        for (const auto &row : sample) {
+          print(row);
         }
+        sample.clear();
+      }
 
-        if (entry->isNetwork() && destination.find('/') == std::string::npos) {
-          // Add default CIDR based on address family
-          if (destination.find(':') != std::string::npos) {
-            // IPv6 - determine prefix length based on route type
-            if (destination == "::") {
-              destination = "::/0"; // Default route
-            } else if (destination.find("fe80::") == 0) {
-              destination += "/64"; // Link-local
-            } else if (destination.find("ff02::") == 0) {
-              destination += "/16"; // Multicast
-            } else {
-              destination += "/128"; // Host route
-            }
-          } else {
-            // IPv4 - determine prefix length based on route type
-            if (destination == "0.0.0.0") {
-              destination = "0.0.0.0/0"; // Default route
-            } else if (destination.find("127.") == 0) {
-              destination += "/32"; // Loopback
-            } else if (destination.find("10.") == 0 ||
-                       destination.find("192.168.") == 0) {
-              destination += "/24"; // Private networks
-            } else {
-              destination += "/32"; // Host route
-            }
-          }
+      void print(const RouteRow &row) {
+        for (size_t i = 0; i < row.size(); ++i) {
+          center(row[i], widths[i] + 1);
         }
+        std::cout << '\n';
+        ++rows;
+      }
 
-        // Convert flags to single-letter representation
-        std::string flags_str = "";
-        auto flags = entry->getFlagList();
-        for (const auto& flag : flags) {
-          switch (flag) {
-            case libfreebsdnet::routing::RouteFlag::UP: flags_str += "U"; break;
-            case libfreebsdnet::routing::RouteFlag::GATEWAY: flags_str += "G"; break;
-            case libfreebsdnet::routing::RouteFlag::HOST: flags_str += "H"; break;
-            case libfreebsdnet::routing::RouteFlag::REJECT: flags_str += "R"; break;
-            case libfreebsdnet::routing::RouteFlag::DYNAMIC: flags_str += "D"; break;
-            case libfreebsdnet::routing::RouteFlag::MODIFIED: flags_str += "M"; break;
-            case libfreebsdnet::routing::RouteFlag::DONE: flags_str += "N"; break;
-            case libfreebsdnet::routing::RouteFlag::XRESOLVE: flags_str += "X"; break;
-            case libfreebsdnet::routing::RouteFlag::LLINFO: flags_str += "L"; break;
-            case libfreebsdnet::routing::RouteFlag::STATIC: flags_str += "S"; break;
-            case libfreebsdnet::routing::RouteFlag::BLACKHOLE: flags_str += "B"; break;
-            case libfreebsdnet::routing::RouteFlag::PROTO2: flags_str += "2"; break;
-            case libfreebsdnet::routing::RouteFlag::PROTO1: flags_str += "1"; break;
-            case libfreebsdnet::routing::RouteFlag::PROTO3: flags_str += "3"; break;
-            case libfreebsdnet::routing::RouteFlag::FIXEDMTU: flags_str += "F"; break;
-            case libfreebsdnet::routing::RouteFlag::PINNED: flags_str += "P"; break;
-          }
+      static void center(std::string_view text, size_t width) {
+        if (text.size() >= width) {
+          std::cout << text;
+          return;
         }
+        size_t padding = width - text.size();
+        std::cout << std::string(padding / 2, ' ') << text
+                  << std::string(padding - padding / 2, ' ');
+      }
+    };
 
-        row.push_back(destination);
-        row.push_back(entry->getNetmask());
-        row.push_back(scope_interface);
-        row.push_back(entry->getGateway());
-        row.push_back(flags_str);
-        row.push_back(entry->getInterface());
-        data.push_back(row);
+  } // namespace
+
+  bool NetTool::handleShowRoute(const std::vector<std::string> &args) {
+    // "show route <destination> ..." looks up a single route
+    if (args.size() >= 3 && !isRouteOption(args[2])) {
+      return handleShowRouteInfo(args);
+    }
+
+    try {
+      int fib = 0; // Default FIB
+      RouteFilter filter;
+      std::string error;
+      if (!parseRouteOptions(args, 2, fib, filter, error)) {
+        printError(error);
+        printError("Usage: show route [fib <number>] [limit <count>] "
+                   "[prefix <cidr>] [interface <name>] [flags <letters>]");
+        return false;
       }
 
-      printTable(data, headers);
+      // Routes are decoded one at a time straight out of the dump buffer
+      RouteTableWriter table;
+      bool complete = routingTable.forEachRoute(
+          fib, AF_UNSPEC, filter, [&table](const RouteRecord &record) {
+            table.add(formatRoute(record));
+            return true;
+          });
+      size_t shown = table.finish();
+      if (!complete) {
+        printError("Failed to get routes: " + routingTable.getLastError());
+        return false;
+      }
+      if (shown == 0) {
+        printInfo("No routes found for FIB " + std::to_string(fib));
+      }
       return true;
     } catch (const std::exception &e) {
       printError("Failed to get routes: " + std::string(e.what()));
@@ -243,18 +356,68 @@ namespace net {
     }
 
     try {
-      auto entries = routingTable.getEntries(fib);
-
-      // Find matching route
-      for (const auto &entry : entries) {
-        if (entry->getDestination() == destination) {
-          printInfo("Route: " + destination);
-          printInfo("  Gateway: " + entry->getGateway());
-          printInfo("  Interface: " + entry->getInterface());
-          printInfo("  Flags: " + std::to_string(entry->getFlags()));
-          printInfo("  FIB: " + std::to_string(fib));
+      auto print = [&](const RouteRecord &record) {
+        auto row = formatRoute(record);
+        printInfo("Route: " + row[0]);
+        printInfo("  Gateway: " + row[3]);
+        printInfo("  Interface: " + row[5]);
+        printInfo("  Flags: " + row[4]);
+        printInfo("  FIB: " + std::to_string(fib));
+      };
+
+      // A bare address shows the route it would take, as route get does
+      if (destination != "default" &&
+          destination.find('/') == std::string::npos) {
+        std::string host =
+            destination +
+            (destination.find(':') != std::string::npos ? "/128" : "/32");
+        libfreebsdnet::types::Address address;
+        if (!libfreebsdnet::types::Address::parse(host, address)) {
+          printError("Invalid destination: " + destination);
+          return false;
+        }
+        libfreebsdnet::routing::LpmIndex index;
+        if (!index.build(fib)) {
+          printError("Failed to get routes: " + index.getLastError());
+          return false;
+        }
+        if (const RouteRecord *record = index.lookup(address, fib)) {
+          print(*record);
           return true;
         }
+        printError("No route to " + destination + " in FIB " +
+                   std::to_string(fib));
+        return false;
+      }
+
+      // A prefix, or the default route of either family, must match exactly
+      std::vector<std::string> prefixes = {destination};
+      if (destination == "default") {
+        prefixes = {"0.0.0.0/0", "::/0"};
+      }
+      bool found = false;
+      for (const std::string &cidr : prefixes) {
+        RouteFilter filter;
+        if (!libfreebsdnet::types::Address::parse(cidr, filter.prefix)) {
+          printError("Invalid destination: " + destination);
+          return false;
+        }
+        bool complete = routingTable.forEachRoute(
+            fib, AF_UNSPEC, filter, [&](const RouteRecord &record) {
+              if (record.prefixLength != filter.prefix.getPrefixLength()) {
+                return true;
+              }
+              print(record);
+              found = true;
+              return false;
+            });
+        if (!complete && !found) {
+          printError("Failed to get routes: " + routingTable.getLastError());
+          return false;
+        }
+      }
+      if (found) {
+        return true;
       }
 
       printError("Route not found: " + destination + " in FIB " +
@@ -288,35 +451,152 @@ namespace net {
   }
 
   bool NetTool::handleShowRouteStats(const std::vector<std::string> &args) {
+    try {
+      int fib = 0;
+      RouteFilter filter;
+      std::string error;
+      if (!parseRouteOptions(args, 3, fib, filter, error)) {
+        printError(error);
+        return false;
+      }
+
+      // Count straight from the dump; no entries or strings are built
+      RouteStats stats;
+      if (!routingTable.getStats(fib, stats, filter)) {
+        printError("Failed to read routes for FIB " + std::to_string(fib));
+        return false;
+      }
+
+      printInfo("Routing Statistics for FIB " + std::to_string(fib));
+      printInfo("  Total routes: " + std::to_string(stats.total));
+      printInfo("  IPv4: " + std::to_string(stats.inet) +
+                ", IPv6: " + std::to_string(stats.inet6));
+      printInfo("  Gateway: " + std::to_string(stats.countFlag(RTF_GATEWAY)) +
+                ", host: " + std::to_string(stats.countFlag(RTF_HOST)) +
+                ", static: " + std::to_string(stats.countFlag(RTF_STATIC)));
+
+      printInfo("  IPv4 prefix lengths:");
+      for (size_t length = 0; length < stats.inetPrefixLengths.size();
+           ++length) {
+        if (stats.inetPrefixLengths[length] != 0) {
+          printInfo("    /" + std::to_string(length) + ": " +
+                    std::to_string(stats.inetPrefixLengths[length]));
+        }
+      }
+      printInfo("  IPv6 prefix lengths:");
+      for (size_t length = 0; length < stats.inet6PrefixLengths.size();
+           ++length) {
+        if (stats.inet6PrefixLengths[length] != 0) {
+          printInfo("    /" + std::to_string(length) + ": " +
+                    std::to_string(stats.inet6PrefixLengths[length]));
+        }
+      }
+
+      printInfo("  Routes by interface:");
+      std::vector<std::pair<std::string, size_t>> interfaces;
+      for (size_t index = 0; index < stats.byInterface.size(); ++index) {
+        uint64_t count = stats.byInterface[index];
+        if (count == 0) {
+          continue;
+        }
+        char name[IF_NAMESIZE];
+        interfaces.emplace_back(
+            if_indextoname(static_cast<unsigned int>(index), name)
+                ? std::string(name)
+                : "link#" + std::to_string(index),
+            count);
+      }
+      std::sort(interfaces.begin(), interfaces.end());
+      for (const auto &[name, count] : interfaces) {
+        printInfo("    " + name + ": " + std::to_string(count));
+      }
+
+      return true;
+    } catch (const std::exception &e) {
+      printError("Error: " + std::string(e.what()));
+      return false;
+    }
+  }
+
+  bool NetTool::handleShowRouteChanges(const std::vector<std::string> &args) {
     int fib = 0;
+    int wait = -1;
 
-    // Parse optional FIB parameter
-    for (size_t i = 2; i < args.size(); i++) {
+    // Parse optional FIB and wait parameters
+    for (size_t i = 3; i < args.size(); i++) {
       if (args[i] == "fib" && i + 1 < args.size()) {
         fib = std::stoi(args[++i]);
+      } else if (args[i] == "wait" && i + 1 < args.size()) {
+        wait = std::stoi(args[++i]);
       }
     }
 
     try {
-      auto entries = routingTable.getEntries(fib);
-
-      printInfo("Routing Statistics for FIB " + std::to_string(fib));
-      printInfo("  Total routes: " + std::to_string(entries.size()));
+      using libfreebsdnet::routing::RouteDiff;
+      using libfreebsdnet::routing::RouteRecord;
+
+      // With "wait" compare two fresh dumps; otherwise compare against the
+      // snapshot taken by the previous invocation
+      std::vector<RouteRecord> before;
+      if (wait >= 0) {
+        before = routingTable.getRecords(fib);
+        std::this_thread::sleep_for(std::chrono::seconds(wait));
+      } else {
+        auto it = routeBaselines.find(fib);
+        if (it == routeBaselines.end()) {
+          routeBaselines[fib] = routingTable.getRecords(fib);
+          printInfo("Captured baseline of " +
+                    std::to_string(routeBaselines[fib].size()) +
+                    " routes for FIB " + std::to_string(fib) +
+                    "; run again to see changes");
+          return true;
+        }
+        before = std::move(it->second);
+      }
 
-      // Count routes by type/interface
-      std::map<std::string, int> interfaceCount;
-      std::map<std::string, int> destinationCount;
+      auto after = routingTable.getRecords(fib);
+      if (wait < 0) {
+        routeBaselines[fib] = after;
+      }
+      auto diff = RouteDiff::compare(std::move(before), std::move(after));
 
-      for (const auto &entry : entries) {
-        interfaceCount[entry->getInterface()]++;
-        destinationCount[entry->getDestination()]++;
+      if (diff.empty()) {
+        printInfo("No route changes in FIB " + std::to_string(fib));
+        return true;
       }
 
-      printInfo("  Routes by interface:");
-      for (const auto &pair : interfaceCount) {
-        printInfo("    " + pair.first + ": " + std::to_string(pair.second));
+      std::vector<std::vector<std::string>> data;
+      std::vector<std::string> headers = {"", "Destination", "Netmask",
+                                          "Gateway", "Interface"};
+      auto row = [](const std::string &mark, const RouteRecord &record) {
+        return std::vector<std::string>{
+            mark, record.formatDestination(), record.formatNetmask(),
+            record.formatGateway(), record.formatInterface()};
+      };
+
+      for (const auto &record : diff.added) {
+        data.push_back(row("+", record));
+      }
+      for (const auto &record : diff.removed) {
+        data.push_back(row("-", record));
+      }
+      for (const auto &change : diff.changed) {
+        auto line = row("~", change.after);
+        std::string gateway = change.before.formatGateway();
+        if (gateway != line[3]) {
+          line[3] = gateway + " -> " + line[3];
+        }
+        std::string iface = change.before.formatInterface();
+        if (iface != line[4]) {
+          line[4] = iface + " -> " + line[4];
+        }
+        data.push_back(line);
       }
 
+      printTable(data, headers);
+      printInfo(std::to_string(diff.added.size()) + " added, " +
+                std::to_string(diff.removed.size()) + " removed, " +
+                std::to_string(diff.changed.size()) + " changed");
       return true;
     } catch (const std::exception &e) {
       printError("Error: " + std::string(e.what()));
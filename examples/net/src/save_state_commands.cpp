@@ -10,17 +10,42 @@
 #include <interface/bridge.hpp>
 #include <interface/lagg.hpp>
 #include <iostream>
+#include <net/route.h>
 #include <net_tool.hpp>
 #include <routing/table.hpp>
-#include <system/config.hpp>
+#include <state_format.hpp>
 #include <string>
+#include <system/config.hpp>
 #include <vector>
 
 namespace net {
 
+  namespace {
+
+    std::string_view protocolName(libfreebsdnet::interface::LagProtocol proto) {
+      using libfreebsdnet::interface::LagProtocol;
+      switch (proto) {
+      case LagProtocol::FAILOVER:
+        return "failover";
+      case LagProtocol::FEC:
+        return "fec";
+      case LagProtocol::LACP:
+        return "lacp";
+      case LagProtocol::LOADBALANCE:
+        return "loadbalance";
+      case LagProtocol::ROUNDROBIN:
+        return "roundrobin";
+      default:
+        return "unknown";
+      }
+    }
+
+  } // namespace
+
   bool NetTool::handleSaveState(const std::vector<std::string> &args) {
-    if (args.size() < 2) {
-      printError("Usage: save <state>");
+    if (args.size() < 2 || args.size() > 3 ||
+        (args.size() == 3 && args[2] != "binary")) {
+      printError("Usage: save state [binary]");
       return false;
     }
 
@@ -30,174 +55,113 @@ namespace net {
     }
 
     try {
-      // Generate net tool configuration commands
-      std::cout << "# Generated network configuration commands" << std::endl;
-      std::cout << "# Generated by libfreebsdnet++ net tool" << std::endl;
-      std::cout << "# Pipe this output to: net -c -" << std::endl;
-      std::cout << std::endl;
-
-      // System configuration
-      std::cout << "# System configuration" << std::endl;
-      try {
-        libfreebsdnet::system::SystemConfig config;
-        
-        // Get IP forwarding settings
-        bool ipv4_forwarding = config.getIpForwarding();
-        std::cout << "set system net.inet.ip.forwarding " << (ipv4_forwarding ? "1" : "0") << std::endl;
-        
-        bool ipv6_forwarding = config.getIp6Forwarding();
-        std::cout << "set system net.inet6.ip6.forwarding " << (ipv6_forwarding ? "1" : "0") << std::endl;
-        
-        // Get FIB count
-        int fib_count = config.getFibs();
-        std::cout << "set system net.fibs " << fib_count << std::endl;
-        
-      } catch (const std::exception& e) {
-        std::cout << "# Error reading system config: " << e.what() << std::endl;
+      using libfreebsdnet::interface::InterfaceType;
+
+      // Read everything up front: one interface dump, one batched sysctl
+      // read and one concurrent dump of every FIB, so the saved state is
+      // not torn by changes made while it is written
+      auto snapshot = interfaceManager.getSnapshot();
+      if (!snapshot) {
+        printError("Failed to read interfaces");
+        return false;
       }
-      std::cout << std::endl;
-
-      // Get all interfaces
-      auto interfaces = interfaceManager.getInterfaces();
-      
-      for (const auto& iface : interfaces) {
-        std::cout << "# Interface: " << iface->getName() << std::endl;
-        
-        // Interface state
-        if (iface->isUp()) {
-          std::cout << "set interface " << iface->getName() << " state up" << std::endl;
-        } else {
-          std::cout << "set interface " << iface->getName() << " state down" << std::endl;
-        }
-        
-        // Interface MTU
-        std::cout << "set interface " << iface->getName() << " mtu " << iface->getMtu() << std::endl;
-        
-        // Interface FIB
-        try {
-          std::cout << "set interface " << iface->getName() << " fib " << iface->getFib() << std::endl;
-        } catch (...) {
-          std::cout << "set interface " << iface->getName() << " fib 0" << std::endl;
-        }
-        
-        // Add addresses
-        auto addresses = iface->getAddresses();
-        for (const auto& addr : addresses) {
-          std::cout << "set interface " << iface->getName() << " address " << addr.getCidr() << std::endl;
+      auto interfaces = interfaceManager.getInterfaceList(*snapshot);
+      libfreebsdnet::system::SystemConfig config;
+      std::vector<std::vector<libfreebsdnet::routing::RouteRecord>> tables;
+      if (!routingTable.dumpAllFibs(tables)) {
+        printError("Failed to read routing tables");
+        return false;
+      }
+
+      state::StateWriter out(args.size() == 3);
+      out.comment("Generated network configuration commands");
+      out.comment("Generated by libfreebsdnet++ net tool");
+      out.comment("Pipe this output to: net -c -");
+      out.blank();
+
+      out.comment("System configuration");
+      out.command({"set", "system", "net.inet.ip.forwarding",
+                   config.getIpForwarding() ? "1" : "0"});
+      out.command({"set", "system", "net.inet6.ip6.forwarding",
+                   config.getIp6Forwarding() ? "1" : "0"});
+      out.command({"set", "system", "net.fibs",
+                   std::to_string(config.getFibs())});
+      out.blank();
+
+      for (const auto *iface : interfaces) {
+        std::string name = iface->getName();
+        out.comment("Interface: " + name);
+        out.command({"set", "interface", name, "state",
+                     iface->isUp() ? "up" : "down"});
+        out.command(
+            {"set", "interface", name, "mtu", std::to_string(iface->getMtu())});
+        out.command(
+            {"set", "interface", name, "fib", std::to_string(iface->getFib())});
+        for (const auto &addr : iface->getAddresses()) {
+          out.command({"set", "interface", name, "address", addr.getCidr()});
         }
-        
-        // Interface-specific configurations
-        auto type = iface->getType();
-        
-        if (type == libfreebsdnet::interface::InterfaceType::BRIDGE) {
-          std::cout << "# Bridge configuration for " << iface->getName() << std::endl;
-          try {
-            auto bridgeIface = dynamic_cast<libfreebsdnet::interface::BridgeInterface *>(iface.get());
-            if (bridgeIface) {
-              std::cout << "set bridge " << iface->getName() << " stp " << (bridgeIface->isStpEnabled() ? "enable" : "disable") << std::endl;
-              
-              // Get bridge members from groups
-              auto groups = iface->getGroups();
-              for (const auto& group : groups) {
-                if (group != "all" && group != "bridge" && group != "member") {
-                  std::cout << "set bridge " << iface->getName() << " addm " << group << std::endl;
-                }
-              }
+
+        if (iface->getType() == InterfaceType::BRIDGE) {
+          auto *bridge = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::BridgeInterface>(iface);
+          if (bridge) {
+            out.comment("Bridge configuration for " + name);
+            out.command({"set", "bridge", name, "stp",
+                         bridge->isStpEnabled() ? "enable" : "disable"});
+            for (const auto &member : bridge->getInterfaces()) {
+              out.command({"set", "bridge", name, "addm", member});
             }
-          } catch (const std::exception& e) {
-            std::cout << "# Error reading bridge config: " << e.what() << std::endl;
           }
-        } else if (type == libfreebsdnet::interface::InterfaceType::LAGG) {
-          std::cout << "# LAGG configuration for " << iface->getName() << std::endl;
-          try {
-            auto laggIface = dynamic_cast<libfreebsdnet::interface::LagInterface *>(iface.get());
-            if (laggIface) {
-              // Get protocol
-              auto proto = laggIface->getProtocol();
-              std::string protocol = "unknown";
-              switch (proto) {
-              case libfreebsdnet::interface::LagProtocol::FAILOVER:
-                protocol = "failover";
-                break;
-              case libfreebsdnet::interface::LagProtocol::FEC:
-                protocol = "fec";
-                break;
-              case libfreebsdnet::interface::LagProtocol::LACP:
-                protocol = "lacp";
-                break;
-              case libfreebsdnet::interface::LagProtocol::LOADBALANCE:
-                protocol = "loadbalance";
-                break;
-              case libfreebsdnet::interface::LagProtocol::ROUNDROBIN:
-                protocol = "roundrobin";
-                break;
-              default:
-                protocol = "unknown";
-                break;
-              }
-              std::cout << "set lagg " << iface->getName() << " protocol " << protocol << std::endl;
-              
-              // Get LAGG ports
-              auto ports = laggIface->getPorts();
-              for (const auto& port : ports) {
-                std::cout << "set lagg " << iface->getName() << " addm " << port << std::endl;
-              }
+        } else if (iface->getType() == InterfaceType::LAGG) {
+          auto *lagg = libfreebsdnet::interface::interface_cast<
+              libfreebsdnet::interface::LagInterface>(iface);
+          if (lagg) {
+            out.comment("LAGG configuration for " + name);
+            out.command({"set", "lagg", name, "protocol",
+                         protocolName(lagg->getProtocol())});
+            for (const auto &port : lagg->getPorts()) {
+              out.command({"set", "lagg", name, "addm", port});
             }
-          } catch (const std::exception& e) {
-            std::cout << "# Error reading LAGG config: " << e.what() << std::endl;
           }
         }
-        
-        std::cout << std::endl;
+        out.blank();
       }
 
-      // Get routing table for all FIBs
-      std::cout << "# Routing table" << std::endl;
-      
-      // Default FIB (0)
-      auto routes = routingTable.getEntries();
-      for (const auto& route : routes) {
-        std::cout << "set route " << route->getDestination();
-        
-        if (!route->getGateway().empty()) {
-          std::cout << " " << route->getGateway();
+      // Only gateway routes can be replayed; connected and link routes come
+      // back with the addresses
+      out.comment("Routing table");
+      for (size_t fib = 0; fib < tables.size(); ++fib) {
+        if (fib == 1) {
+          out.comment("Additional FIBs");
         }
-        
-        if (!route->getInterface().empty()) {
-          std::cout << " " << route->getInterface();
+        if (fib > 0) {
+          out.comment("FIB " + std::to_string(fib) + " routes:");
         }
-        
-        std::cout << std::endl;
-      }
-      
-      // Other FIBs - get actual routes for each FIB
-      std::cout << "# Additional FIBs" << std::endl;
-      try {
-        libfreebsdnet::system::SystemConfig config;
-        int fib_count = config.getFibs();
-        
-        for (int fib = 1; fib < fib_count; fib++) {
-          std::cout << "# FIB " << fib << " routes:" << std::endl;
-          auto fib_routes = routingTable.getEntries(fib);
-          for (const auto& route : fib_routes) {
-            std::cout << "set route " << route->getDestination();
-            
-            if (!route->getGateway().empty()) {
-              std::cout << " " << route->getGateway();
-            }
-            
-            if (!route->getInterface().empty()) {
-              std::cout << " " << route->getInterface();
-            }
-            
-            std::cout << " fib " << fib << std::endl;
+        std::string fibText = std::to_string(fib);
+        for (const auto &route : tables[fib]) {
+          if (!(route.flags & RTF_GATEWAY)) {
+            continue;
+          }
+          std::string destination = route.formatDestination();
+          std::string netmask = route.formatNetmask();
+          if (!netmask.empty()) {
+            destination += "/" + netmask;
+          }
+          std::string gateway = route.formatGateway();
+          std::string interface = route.formatInterface();
+          if (fib == 0) {
+            out.command({"set", "route", destination, gateway, interface});
+          } else {
+            out.command({"set", "route", destination, gateway, interface,
+                         "fib", fibText});
           }
         }
-      } catch (const std::exception& e) {
-        std::cout << "# Error reading FIB routes: " << e.what() << std::endl;
       }
-      std::cout << std::endl;
+      out.blank();
 
+      std::cout.write(out.data().data(),
+                      static_cast<std::streamsize>(out.data().size()));
+      std::cout.flush();
       return true;
     } catch (const std::exception &e) {
       printError("Error: " + std::string(e.what()));
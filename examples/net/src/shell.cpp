@@ -7,10 +7,14 @@
  * @year 2024
  */
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <iterator>
 #include <net_tool.hpp>
 #include <readline/history.h>
 #include <readline/readline.h>
+#include <state_format.hpp>
 
 namespace net {
 
@@ -51,23 +55,61 @@ namespace net {
     return 0;
   }
 
+  namespace {
+
+    // Commands longer than this are rejected rather than allocated for
+    constexpr size_t MAX_WORDS = 64;
+
+  } // namespace
+
   bool NetTool::executeCommand(const std::string &command) {
-    auto args = splitCommand(command);
-    if (args.empty()) {
+    std::array<std::string_view, MAX_WORDS> buffer;
+    size_t count = tokenize(command, buffer);
+    if (count == 0) {
       return true;
     }
+    if (count > buffer.size()) {
+      printError("Too many arguments");
+      return false;
+    }
+    std::span<const std::string_view> words(buffer.data(), count);
+    Handler handler = findHandler(words);
+    if (!handler) {
+      return false;
+    }
+    return (this->*handler)(std::vector<std::string>(words.begin(),
+                                                     words.end()));
+  }
 
-    std::string cmd = args[0];
-    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+  bool NetTool::runScript(std::istream &input) {
+    std::string script((std::istreambuf_iterator<char>(input)),
+                       std::istreambuf_iterator<char>());
+    std::vector<std::vector<std::string>> commands;
+    bool complete = state::readScript(script, commands);
 
-    auto it = commands.find(cmd);
-    if (it == commands.end()) {
-      printError("Unknown command: " + args[0]);
-      printInfo("Type 'help' for available commands.");
+    size_t failed = 0;
+    for (const auto &args : commands) {
+      failed += dispatchCommand(args) ? 0 : 1;
+    }
+    if (!complete) {
+      printError("Truncated state record");
       return false;
     }
+    return failed == 0;
+  }
 
-    return it->second.handler(args);
+  bool NetTool::dispatchCommand(const std::vector<std::string> &args) {
+    if (args.empty()) {
+      return true;
+    }
+    if (args.size() > MAX_WORDS) {
+      printError("Too many arguments");
+      return false;
+    }
+    std::array<std::string_view, MAX_WORDS> buffer;
+    std::copy(args.begin(), args.end(), buffer.begin());
+    Handler handler = findHandler({buffer.data(), args.size()});
+    return handler && (this->*handler)(args);
   }
 
 } // namespace net
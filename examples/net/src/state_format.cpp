@@ -0,0 +1,122 @@
+/**
+ * @file state_format.cpp
+ * @brief Net tool saved state format implementation
+ * @details Text and binary encoding of saved configuration commands
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <state_format.hpp>
+
+namespace net::state {
+
+  StateWriter::StateWriter(bool binary) : binary(binary) {
+    buffer.reserve(64 * 1024);
+    if (binary) {
+      buffer.append(MAGIC);
+    }
+  }
+
+  void StateWriter::comment(std::string_view text) {
+    if (!binary) {
+      buffer.append("# ").append(text).push_back('\n');
+    }
+  }
+
+  void StateWriter::blank() {
+    if (!binary) {
+      buffer.push_back('\n');
+    }
+  }
+
+  void StateWriter::command(std::initializer_list<std::string_view> args) {
+    if (!binary) {
+      bool first = true;
+      for (std::string_view arg : args) {
+        if (!first) {
+          buffer.push_back(' ');
+        }
+        buffer.append(arg);
+        first = false;
+      }
+      buffer.push_back('\n');
+      return;
+    }
+
+    buffer.push_back(static_cast<char>(std::min<size_t>(args.size(), 255)));
+    size_t count = 0;
+    for (std::string_view arg : args) {
+      if (count++ == 255) {
+        break;
+      }
+      size_t length = std::min<size_t>(arg.size(), UINT16_MAX);
+      buffer.push_back(static_cast<char>(length & 0xff));
+      buffer.push_back(static_cast<char>(length >> 8));
+      buffer.append(arg.substr(0, length));
+    }
+  }
+
+  bool isBinary(std::string_view data) { return data.starts_with(MAGIC); }
+
+  bool nextRecord(std::string_view &data, std::vector<std::string> &args) {
+    args.clear();
+    if (data.empty()) {
+      return false;
+    }
+    size_t count = static_cast<uint8_t>(data[0]);
+    size_t offset = 1;
+    for (size_t i = 0; i < count; ++i) {
+      if (data.size() - offset < 2) {
+        return false;
+      }
+      size_t length = static_cast<uint8_t>(data[offset]) |
+                      (static_cast<size_t>(static_cast<uint8_t>(
+                           data[offset + 1]))
+                       << 8);
+      offset += 2;
+      if (data.size() - offset < length) {
+        return false;
+      }
+      args.emplace_back(data.substr(offset, length));
+      offset += length;
+    }
+    data.remove_prefix(offset);
+    return true;
+  }
+
+  bool readScript(std::string_view data,
+                  std::vector<std::vector<std::string>> &commands) {
+    commands.clear();
+    if (isBinary(data)) {
+      data.remove_prefix(MAGIC.size());
+      std::vector<std::string> args;
+      while (nextRecord(data, args)) {
+        commands.push_back(std::move(args));
+      }
+      return data.empty();
+    }
+
+    constexpr std::string_view blanks = " \t\r";
+    while (!data.empty()) {
+      size_t end = data.find('\n');
+      std::string_view line = data.substr(0, end);
+      data.remove_prefix(end == std::string_view::npos ? data.size()
+                                                       : end + 1);
+      std::vector<std::string> args;
+      for (size_t start = line.find_first_not_of(blanks);
+           start != std::string_view::npos;
+           start = line.find_first_not_of(blanks, start)) {
+        size_t stop = std::min(line.find_first_of(blanks, start), line.size());
+        args.emplace_back(line.substr(start, stop - start));
+        start = stop;
+      }
+      if (!args.empty() && args[0][0] != '#') {
+        commands.push_back(std::move(args));
+      }
+    }
+    return true;
+  }
+
+} // namespace net::state
@@ -8,23 +8,29 @@
  */
 
 #include <algorithm>
+#include <cerrno>
 #include <iomanip>
 #include <iostream>
 #include <net_tool.hpp>
-#include <sstream>
+#include <unistd.h>
 
 namespace net {
 
-  std::vector<std::string> NetTool::splitCommand(const std::string &command) {
-    std::vector<std::string> args;
-    std::istringstream iss(command);
-    std::string arg;
-
-    while (iss >> arg) {
-      args.push_back(arg);
+  size_t NetTool::tokenize(std::string_view line,
+                           std::span<std::string_view> words) {
+    constexpr std::string_view blanks = " \t\r\n\v\f";
+    size_t count = 0;
+    for (size_t start = line.find_first_not_of(blanks);
+         start != std::string_view::npos;
+         start = line.find_first_not_of(blanks, start)) {
+      size_t end = std::min(line.find_first_of(blanks, start), line.size());
+      if (count < words.size()) {
+        words[count] = line.substr(start, end - start);
+      }
+      ++count;
+      start = end;
     }
-
-    return args;
+    return count;
   }
 
   void NetTool::printError(const std::string &message) {
@@ -39,8 +45,9 @@ namespace net {
     std::cout << "\033[36m" << message << "\033[0m" << std::endl;
   }
 
-  void NetTool::printTable(const std::vector<std::vector<std::string>> &data,
-                           const std::vector<std::string> &headers) {
+  void NetTool::formatTable(std::string &out,
+                            const std::vector<std::vector<std::string>> &data,
+                            const std::vector<std::string> &headers) {
     if (data.empty()) {
       return;
     }
@@ -57,36 +64,66 @@ namespace net {
       }
     }
 
-    // Helper function to center text in a field
-    auto centerText = [](const std::string &text, size_t width) {
+    // Every line is at most the padded widths plus a newline
+    size_t line = 1;
+    for (size_t width : widths) {
+      line += width + 1;
+    }
+    out.reserve(out.size() + line * (data.size() + 2));
+
+    // Center text in a field
+    auto appendCentered = [&out](const std::string &text, size_t width) {
       if (text.length() >= width) {
-        return text;
+        out.append(text);
+        return;
       }
       size_t padding = width - text.length();
       size_t leftPadding = padding / 2;
-      size_t rightPadding = padding - leftPadding;
-      return std::string(leftPadding, ' ') + text +
-             std::string(rightPadding, ' ');
+      out.append(leftPadding, ' ');
+      out.append(text);
+      out.append(padding - leftPadding, ' ');
     };
 
-    // Print header
+    // Header
     for (size_t i = 0; i < headers.size(); i++) {
-      std::cout << centerText(headers[i], widths[i] + 1);
+      appendCentered(headers[i], widths[i] + 1);
     }
-    std::cout << std::endl;
+    out.push_back('\n');
 
-    // Print separator
+    // Separator
     for (size_t i = 0; i < headers.size(); i++) {
-      std::cout << std::string(widths[i] + 1, '-');
+      out.append(widths[i] + 1, '-');
     }
-    std::cout << std::endl;
+    out.push_back('\n');
 
-    // Print data
+    // Data
     for (const auto &row : data) {
       for (size_t i = 0; i < row.size() && i < widths.size(); i++) {
-        std::cout << centerText(row[i], widths[i] + 1);
+        appendCentered(row[i], widths[i] + 1);
+      }
+      out.push_back('\n');
+    }
+  }
+
+  void NetTool::printTable(const std::vector<std::vector<std::string>> &data,
+                           const std::vector<std::string> &headers) {
+    std::string out;
+    formatTable(out, data, headers);
+    std::cout << out << std::flush;
+  }
+
+  void NetTool::writeOutput(std::string_view text) {
+    // Anything still buffered in std::cout goes first
+    std::cout.flush();
+    while (!text.empty()) {
+      ssize_t written = write(STDOUT_FILENO, text.data(), text.size());
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
       }
-      std::cout << std::endl;
+      text.remove_prefix(static_cast<size_t>(written));
     }
   }
 
@@ -0,0 +1,163 @@
+/**
+ * @file main.cpp
+ * @brief Netmap benchmark main function
+ * @details Packet generator, sink and forwarder reporting Mpps
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <interface/netmap.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using libfreebsdnet::interface::NetmapPort;
+using libfreebsdnet::interface::NetmapStats;
+
+namespace {
+
+  constexpr std::chrono::milliseconds TICK{100};
+
+  int usage() {
+    std::cerr << "usage: netmap-bench gen <port> [seconds] [size]\n"
+              << "       netmap-bench rx <port> [seconds]\n"
+              << "       netmap-bench fwd <from> <to> [seconds]\n";
+    return 2;
+  }
+
+  // Broadcast Ethernet, IPv4 10.0.0.1 -> 10.0.0.2, UDP to the discard port
+  std::array<uint8_t, 1514> buildFrame(size_t size) {
+    std::array<uint8_t, 1514> frame{};
+    std::memset(frame.data(), 0xff, 6);
+    const uint8_t source[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    std::memcpy(frame.data() + 6, source, 6);
+    frame[12] = 0x08;
+
+    uint8_t *ip = frame.data() + 14;
+    size_t ipLength = size - 14;
+    ip[0] = 0x45;
+    ip[2] = static_cast<uint8_t>(ipLength >> 8);
+    ip[3] = static_cast<uint8_t>(ipLength);
+    ip[8] = 64;
+    ip[9] = 17;
+    const uint8_t addresses[8] = {10, 0, 0, 1, 10, 0, 0, 2};
+    std::memcpy(ip + 12, addresses, 8);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < 20; i += 2) {
+      sum += static_cast<uint32_t>(ip[i] << 8 | ip[i + 1]);
+    }
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = ~((sum & 0xffff) + (sum >> 16)) & 0xffff;
+    ip[10] = static_cast<uint8_t>(sum >> 8);
+    ip[11] = static_cast<uint8_t>(sum);
+
+    uint8_t *udp = ip + 20;
+    size_t udpLength = ipLength - 20;
+    udp[0] = 0x04;
+    udp[1] = 0x00;
+    udp[3] = 9;
+    udp[4] = static_cast<uint8_t>(udpLength >> 8);
+    udp[5] = static_cast<uint8_t>(udpLength);
+    return frame;
+  }
+
+  void report(const NetmapPort &port, int seconds) {
+    NetmapStats previous = port.getStats();
+    for (int i = 0; i < seconds; ++i) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      NetmapStats current = port.getStats();
+      std::cout << port.getPort() << ": rx "
+                << (current.rxPackets - previous.rxPackets) / 1e6
+                << " Mpps, tx "
+                << (current.txPackets - previous.txPackets) / 1e6
+                << " Mpps" << std::endl;
+      previous = current;
+    }
+  }
+
+  void summary(const NetmapPort &port) {
+    NetmapStats stats = port.getStats();
+    std::cout << port.getPort() << " total: rx " << stats.rxPackets
+              << " packets (" << stats.getRxMpps() << " Mpps), tx "
+              << stats.txPackets << " packets (" << stats.getTxMpps()
+              << " Mpps), " << stats.forwarded << " swapped" << std::endl;
+  }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    return usage();
+  }
+  std::string mode = argv[1];
+
+  try {
+    if (mode == "gen" || mode == "rx") {
+      int seconds = argc > 3 ? std::stoi(argv[3]) : 10;
+      size_t size = argc > 4 ? std::stoul(argv[4]) : 60;
+      if (size < 42 || size > 1514) {
+        std::cerr << "Frame size must be 42 to 1514 bytes" << std::endl;
+        return 2;
+      }
+      auto frame = buildFrame(size);
+
+      NetmapPort port(argv[2]);
+      bool started = mode == "gen"
+          ? port.startWorkers([&](NetmapPort &ring, unsigned int) {
+              if (ring.wait(TICK, true)) {
+                ring.fill([&](std::span<uint8_t> buffer) -> size_t {
+                  size_t length = std::min(size, buffer.size());
+                  std::memcpy(buffer.data(), frame.data(), length);
+                  return length;
+                });
+              }
+              return true;
+            })
+          : port.startWorkers([](NetmapPort &ring, unsigned int) {
+              if (ring.wait(TICK)) {
+                ring.receive(nullptr);
+              }
+              return true;
+            });
+      if (!started) {
+        std::cerr << port.getLastError() << std::endl;
+        return 1;
+      }
+      std::cout << port.getPort() << ": " << port.getRingCount()
+                << " rings" << std::endl;
+      report(port, seconds);
+      port.stopWorkers();
+      summary(port);
+      return 0;
+    }
+
+    if (mode == "fwd" && argc >= 4) {
+      int seconds = argc > 4 ? std::stoi(argv[4]) : 10;
+      NetmapPort from(argv[2]);
+      NetmapPort to(argv[3]);
+      if (!from.open() || !to.open()) {
+        std::cerr << from.getLastError() << to.getLastError() << std::endl;
+        return 1;
+      }
+      auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+      while (std::chrono::steady_clock::now() < deadline) {
+        if (from.wait(TICK) && NetmapPort::forward(from, to) > 0) {
+          to.sync();
+        }
+      }
+      summary(from);
+      summary(to);
+      return 0;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid argument: " << e.what() << std::endl;
+    return 2;
+  }
+  return usage();
+}
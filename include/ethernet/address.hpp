@@ -11,8 +11,12 @@
 #define LIBFREEBSDNET_ETHERNET_ADDRESS_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace libfreebsdnet::ethernet {
 
@@ -23,6 +27,7 @@ namespace libfreebsdnet::ethernet {
   class MacAddress {
   public:
     static constexpr size_t ADDRESS_SIZE = 6;
+    static constexpr size_t TEXT_LENGTH = 17; // "aa:bb:cc:dd:ee:ff"
 
     MacAddress();
     explicit MacAddress(const std::array<uint8_t, ADDRESS_SIZE> &bytes);
@@ -55,6 +60,45 @@ namespace libfreebsdnet::ethernet {
      */
     bool fromString(const std::string &address);
 
+    /**
+     * @brief Format address into a caller buffer
+     * @param buffer Output buffer of at least TEXT_LENGTH + 1 bytes
+     * @param separator Character to separate bytes
+     * @return Length written without the terminator, 0 if the buffer is too
+     * small
+     */
+    size_t format(std::span<char> buffer, char separator = ':') const;
+
+    /**
+     * @brief Check address text without building an address
+     * @param address MAC address string
+     * @return true if fromString() would accept the text
+     */
+    static bool validate(std::string_view address);
+
+    /**
+     * @brief Parse many MAC address strings
+     * @param texts Input strings
+     * @param out Output addresses, at least texts.size() long; entries that
+     * fail to parse are left invalid
+     * @return Number of valid addresses parsed
+     */
+    static size_t parseMacs(std::span<const std::string_view> texts,
+                            std::span<MacAddress> out);
+
+    /**
+     * @brief Format many MAC addresses
+     * @details Entry i is written NUL-terminated at out + i * (TEXT_LENGTH +
+     * 1)
+     * @param macs Input addresses
+     * @param out Output buffer of macs.size() * (TEXT_LENGTH + 1) bytes
+     * @param separator Character to separate bytes
+     * @return Number of entries written, less than macs.size() if the
+     * buffer is too small
+     */
+    static size_t formatMacs(std::span<const MacAddress> macs,
+                             std::span<char> out, char separator = ':');
+
     /**
      * @brief Set address from byte array
      * @param bytes Array of 6 bytes
@@ -109,6 +153,42 @@ namespace libfreebsdnet::ethernet {
      */
     std::array<uint8_t, 3> getOUI() const;
 
+    /**
+     * @brief Get address packed into an integer
+     * @details Bytes are stored big-endian in the low 48 bits, so packed
+     * values order the same way as addresses
+     * @return Packed address
+     */
+    uint64_t toUint64() const;
+
+    /**
+     * @brief Create address from its packed form
+     * @param packed Address in the low 48 bits
+     * @return Valid MAC address
+     */
+    static MacAddress fromUint64(uint64_t packed);
+
+    /**
+     * @brief Get hash of the address
+     * @return Hash of the packed form
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Hash a packed address
+     * @param packed Address in the low 48 bits
+     * @return Mixed hash value
+     */
+    static constexpr uint64_t hashPacked(uint64_t packed) {
+      // murmur3 finalizer; OUI-heavy inputs differ only in the low bits
+      packed ^= packed >> 33;
+      packed *= 0xff51afd7ed558ccdull;
+      packed ^= packed >> 33;
+      packed *= 0xc4ceb9fe1a85ec53ull;
+      packed ^= packed >> 33;
+      return packed;
+    }
+
     /**
      * @brief Generate random MAC address
      * @return Random MAC address
@@ -139,8 +219,32 @@ namespace libfreebsdnet::ethernet {
   private:
     std::array<uint8_t, ADDRESS_SIZE> bytes_;
     bool valid_;
+
+    /**
+     * @brief Parse the canonical 17-character forms
+     * @param address MAC address string
+     * @param bytes Output bytes
+     * @return 1 if parsed, 0 if invalid, -1 if not in canonical form
+     */
+    static int parseCanonical(std::string_view address,
+                              std::array<uint8_t, ADDRESS_SIZE> &bytes);
+
+    /**
+     * @brief Parse any form fromString() accepts
+     * @param address MAC address string
+     * @param bytes Output bytes
+     * @return true on success, false on error
+     */
+    static bool parseText(std::string_view address,
+                          std::array<uint8_t, ADDRESS_SIZE> &bytes);
   };
 
 } // namespace libfreebsdnet::ethernet
 
+template <> struct std::hash<libfreebsdnet::ethernet::MacAddress> {
+  size_t operator()(const libfreebsdnet::ethernet::MacAddress &mac) const {
+    return mac.hash();
+  }
+};
+
 #endif // LIBFREEBSDNET_ETHERNET_ADDRESS_HPP
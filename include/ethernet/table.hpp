@@ -0,0 +1,232 @@
+/**
+ * @file ethernet/table.hpp
+ * @brief Open-addressing MAC address table
+ * @details Hash table keyed by packed MAC addresses for forwarding database
+ * caches and deduplication
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ETHERNET_TABLE_HPP
+#define LIBFREEBSDNET_ETHERNET_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ethernet/address.hpp>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace libfreebsdnet::ethernet {
+
+  /**
+   * @brief MAC table class
+   * @details Linear probing over a power-of-two array of packed 8-byte
+   * keys, with values in a parallel array so probes only touch keys.
+   * Deletion shifts later entries back instead of leaving tombstones, so
+   * tables with heavy learn/age churn, like a bridge FDB, do not degrade.
+   * The table grows at 75% load.
+   * @tparam T Value type, default constructible
+   */
+  template <typename T> class MacTable {
+  public:
+    using Visitor = std::function<bool(const MacAddress &, const T &)>;
+
+    MacTable() = default;
+
+    /**
+     * @brief Constructor
+     * @param expected Number of entries to size for
+     */
+    explicit MacTable(size_t expected) { reserve(expected); }
+
+    /**
+     * @brief Insert or replace an entry
+     * @param mac MAC address
+     * @param value Value to store
+     * @return true if the address was new
+     */
+    bool insert(const MacAddress &mac, T value) {
+      return insertPacked(mac.toUint64(), std::move(value));
+    }
+
+    /**
+     * @brief Insert or replace an entry by packed address
+     * @param packed Address from MacAddress::toUint64()
+     * @param value Value to store
+     * @return true if the address was new
+     */
+    bool insertPacked(uint64_t packed, T value) {
+      if ((size_ + 1) * 4 > keys_.size() * 3) {
+        rehash(keys_.empty() ? MIN_CAPACITY : keys_.size() * 2);
+      }
+      size_t slot = probe(packed);
+      values_[slot] = std::move(value);
+      if (keys_[slot] == packed) {
+        return false;
+      }
+      keys_[slot] = packed;
+      ++size_;
+      return true;
+    }
+
+    /**
+     * @brief Find an entry
+     * @param mac MAC address
+     * @return Value or nullptr if not present
+     */
+    T *find(const MacAddress &mac) { return findPacked(mac.toUint64()); }
+
+    const T *find(const MacAddress &mac) const {
+      return findPacked(mac.toUint64());
+    }
+
+    /**
+     * @brief Find an entry by packed address
+     * @param packed Address from MacAddress::toUint64()
+     * @return Value or nullptr if not present
+     */
+    T *findPacked(uint64_t packed) {
+      size_t slot = locate(packed);
+      return slot != NPOS ? &values_[slot] : nullptr;
+    }
+
+    const T *findPacked(uint64_t packed) const {
+      size_t slot = locate(packed);
+      return slot != NPOS ? &values_[slot] : nullptr;
+    }
+
+    /**
+     * @brief Check for an address
+     * @param mac MAC address
+     * @return true if present
+     */
+    bool contains(const MacAddress &mac) const { return find(mac) != nullptr; }
+
+    /**
+     * @brief Remove an entry
+     * @param mac MAC address
+     * @return true if it was present
+     */
+    bool erase(const MacAddress &mac) { return erasePacked(mac.toUint64()); }
+
+    /**
+     * @brief Remove an entry by packed address
+     * @param packed Address from MacAddress::toUint64()
+     * @return true if it was present
+     */
+    bool erasePacked(uint64_t packed) {
+      size_t hole = locate(packed);
+      if (hole == NPOS) {
+        return false;
+      }
+      // Backward shift: pull up entries whose home slot is at or before
+      // the hole so every probe chain stays unbroken
+      size_t mask = keys_.size() - 1;
+      for (size_t next = (hole + 1) & mask; keys_[next] != EMPTY;
+           next = (next + 1) & mask) {
+        size_t home = homeOf(keys_[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+          keys_[hole] = keys_[next];
+          values_[hole] = std::move(values_[next]);
+          hole = next;
+        }
+      }
+      keys_[hole] = EMPTY;
+      values_[hole] = T{};
+      --size_;
+      return true;
+    }
+
+    /**
+     * @brief Visit every entry in table order
+     * @param visitor Called per entry; return false to stop
+     */
+    void forEach(const Visitor &visitor) const {
+      for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] != EMPTY &&
+            !visitor(MacAddress::fromUint64(keys_[i]), values_[i])) {
+          return;
+        }
+      }
+    }
+
+    /**
+     * @brief Size the table for a number of entries
+     * @param expected Number of entries
+     */
+    void reserve(size_t expected) {
+      size_t needed =
+          std::bit_ceil(std::max(expected * 4 / 3 + 1, MIN_CAPACITY));
+      if (needed > keys_.size()) {
+        rehash(needed);
+      }
+    }
+
+    /**
+     * @brief Remove every entry, keeping the capacity
+     */
+    void clear() {
+      std::fill(keys_.begin(), keys_.end(), EMPTY);
+      std::fill(values_.begin(), values_.end(), T{});
+      size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return keys_.size(); }
+
+  private:
+    // Packed addresses use 48 bits, so all ones never collides
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    std::vector<uint64_t> keys_;
+    std::vector<T> values_;
+    size_t size_ = 0;
+
+    size_t homeOf(uint64_t packed) const {
+      return static_cast<size_t>(MacAddress::hashPacked(packed)) &
+             (keys_.size() - 1);
+    }
+
+    // Slot holding packed, or the empty slot where it would go
+    size_t probe(uint64_t packed) const {
+      size_t mask = keys_.size() - 1;
+      size_t slot = homeOf(packed);
+      while (keys_[slot] != packed && keys_[slot] != EMPTY) {
+        slot = (slot + 1) & mask;
+      }
+      return slot;
+    }
+
+    size_t locate(uint64_t packed) const {
+      if (keys_.empty()) {
+        return NPOS;
+      }
+      size_t slot = probe(packed);
+      return keys_[slot] == packed ? slot : NPOS;
+    }
+
+    void rehash(size_t capacity) {
+      std::vector<uint64_t> keys(capacity, EMPTY);
+      std::vector<T> values(capacity);
+      keys.swap(keys_);
+      values.swap(values_);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] != EMPTY) {
+          size_t slot = probe(keys[i]);
+          keys_[slot] = keys[i];
+          values_[slot] = std::move(values[i]);
+        }
+      }
+    }
+  };
+
+} // namespace libfreebsdnet::ethernet
+
+#endif // LIBFREEBSDNET_ETHERNET_TABLE_HPP
@@ -0,0 +1,83 @@
+/**
+ * @file interface/addresses.hpp
+ * @brief Bulk interface address table
+ * @details Addresses of every interface from one sysctl dump, grouped by
+ * interface index in a single contiguous array
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_ADDRESSES_HPP
+#define LIBFREEBSDNET_INTERFACE_ADDRESSES_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <types/address.hpp>
+
+namespace libfreebsdnet::interface {
+
+  class Manager;
+
+  /**
+   * @brief Address table class
+   * @details Each interface owns one contiguous slice of the table, in
+   * kernel order. Prefix lengths come from the kernel's netmasks.
+   */
+  class AddressTable {
+  public:
+    AddressTable();
+    ~AddressTable();
+    AddressTable(AddressTable &&) noexcept;
+    AddressTable &operator=(AddressTable &&) noexcept;
+    AddressTable(const AddressTable &) = delete;
+    AddressTable &operator=(const AddressTable &) = delete;
+
+    /**
+     * @brief Get addresses of one interface
+     * @details Constant time, so looping over every interface stays linear
+     * @param index Interface index
+     * @return Addresses, empty if the interface has none or is not present
+     */
+    std::span<const libfreebsdnet::types::Address>
+    getAddresses(unsigned int index) const;
+
+    /**
+     * @brief Get every address in the table
+     * @return Addresses grouped by interface
+     */
+    std::span<const libfreebsdnet::types::Address> getAll() const;
+
+    /**
+     * @brief Get indexes of the interfaces in the table
+     * @return Interface indexes in kernel order
+     */
+    std::span<const unsigned int> getIndexes() const;
+
+    /**
+     * @brief Get total number of addresses
+     * @return Address count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Check if the table is empty
+     * @return true if there are no addresses
+     */
+    bool empty() const;
+
+  private:
+    friend class Manager;
+
+    void reserve(size_t interfaces, size_t addresses);
+    void append(unsigned int index,
+                std::span<const libfreebsdnet::types::Address> addresses);
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_ADDRESSES_HPP
@@ -0,0 +1,123 @@
+/**
+ * @file interface/affinity.hpp
+ * @brief RSS-aware CPU placement for packet I/O workers
+ * @details Reads which CPU services each receive queue of a NIC and the
+ * NUMA domain of the device, and turns that into a worker to CPU plan so
+ * a worker runs where its queue's interrupt and RSS bucket already put
+ * the packets
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_AFFINITY_HPP
+#define LIBFREEBSDNET_INTERFACE_AFFINITY_HPP
+
+#include <pthread.h>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Interrupt of one receive queue
+   */
+  struct QueueInterrupt {
+    std::string queue;     // driver's queue label, e.g. "rxq0" or "que 0"
+    int irq = -1;
+    std::vector<int> cpus; // interrupt affinity, as cpuset -g -x shows
+  };
+
+  /**
+   * @brief Where one worker should run
+   */
+  struct WorkerPlacement {
+    unsigned int worker = 0;
+    int cpu = -1;      // -1 if nothing is known
+    int domain = -1;   // NUMA domain of the CPU, -1 if unknown
+    std::string queue; // queue served on the CPU, empty for extra workers
+  };
+
+  /**
+   * @brief Worker placement plan for one NIC
+   */
+  struct AffinityPlan {
+    std::string interface;
+    std::string device; // sysctl node, e.g. "dev.ix.0"
+    int domain = -1;    // NUMA domain of the device, -1 if unknown
+    int coreOffset = -1; // iflib core_offset, -1 for non-iflib drivers
+    std::vector<QueueInterrupt> queues; // receive queues in driver order
+    std::vector<int> rssBuckets; // bucket -> CPU, empty without options RSS
+    std::vector<WorkerPlacement> workers;
+
+    /**
+     * @brief Get the CPU of every worker
+     * @return CPUs in worker order, -1 where unknown
+     */
+    std::vector<int> getCpus() const;
+  };
+
+  /**
+   * @brief Queue affinity class
+   * @details Queue interrupts are found in hw.intrnames by the driver's
+   * "ix0:" prefix and their CPUs read with cpuset_getaffinity(2); the
+   * device domain comes from its %domain sysctl. Worker n takes the CPU
+   * of receive queue n; without interrupt affinity it falls back to the
+   * RSS bucket map, then to iflib's core_offset spread over the device's
+   * domain. Workers beyond the queue count take the remaining CPUs of
+   * that domain before leaving it. CPUs outside the process cpuset are
+   * never planned.
+   */
+  class QueueAffinity {
+  public:
+    /**
+     * @brief Plan workers for a NIC
+     * @param name Interface name (e.g., "ix0")
+     * @param workers Worker count, 0 for one per receive queue, or one per
+     * CPU of the device's domain if its queues are unknown
+     * @return Plan; workers carry cpu -1 if the interface is unknown
+     */
+    static AffinityPlan plan(const std::string &name,
+                             unsigned int workers = 0);
+
+    /**
+     * @brief Get the CPUs this process may run on
+     * @return CPU ids in ascending order
+     */
+    static std::vector<int> getAvailableCpus();
+
+    /**
+     * @brief Get the CPUs of a NUMA domain
+     * @param domain Domain id
+     * @return CPU ids in ascending order, empty if the domain is unknown
+     */
+    static std::vector<int> getDomainCpus(int domain);
+
+    /**
+     * @brief Get the NUMA domain of a CPU
+     * @param cpu CPU id
+     * @return Domain id, -1 if unknown
+     */
+    static int getDomain(int cpu);
+
+    /**
+     * @brief Get available CPUs that service no NIC queue interrupt
+     * @details For threads that should stay off the packet path, such as
+     * samplers; all available CPUs if every one services a queue
+     * @return CPU ids in ascending order
+     */
+    static std::vector<int> getHousekeepingCpus();
+
+    /**
+     * @brief Restrict a thread to a set of CPUs
+     * @param thread Thread to pin
+     * @param cpus Allowed CPUs; negative ids are ignored
+     * @return 0 on success, an errno value otherwise
+     */
+    static int pin(pthread_t thread, std::span<const int> cpus);
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_AFFINITY_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file interface/arena.hpp
+ * @brief Arena placement for interface objects
+ * @details Lets bulk enumeration construct interface objects and their
+ * private state in a caller-owned memory resource instead of the global
+ * heap
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_ARENA_HPP
+#define LIBFREEBSDNET_INTERFACE_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Base for classes that can be placed in an arena
+   * @details While an ArenaScope is active on the calling thread, new
+   * allocates from its resource; otherwise from the global heap. Every
+   * block is tagged with its origin, so delete is always safe: heap blocks
+   * are freed and arena blocks are left for the arena to release.
+   */
+  class ArenaAllocated {
+  public:
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr) noexcept;
+  };
+
+  /**
+   * @brief Routes ArenaAllocated allocations on this thread to a resource
+   * @details Scopes nest; the innermost one wins. The resource must outlive
+   * every object allocated from it.
+   */
+  class ArenaScope {
+  public:
+    /**
+     * @brief Constructor
+     * @param arena Resource to allocate from
+     */
+    explicit ArenaScope(std::pmr::memory_resource *arena);
+
+    /**
+     * @brief Destructor
+     * @details Restores the previous scope
+     */
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    /**
+     * @brief Get the active resource of the calling thread
+     * @return Resource or nullptr if no scope is active
+     */
+    static std::pmr::memory_resource *current();
+
+  private:
+    std::pmr::memory_resource *previous_;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_ARENA_HPP
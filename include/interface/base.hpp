@@ -11,14 +11,19 @@
 #define LIBFREEBSDNET_INTERFACE_BASE_HPP
 
 #include <cstdint>
+#include <interface/arena.hpp>
+#include <interface/identity.hpp>
 #include <memory>
 #include <net/if.h>
 #include <string>
 #include <types/address.hpp>
+#include <types/error.hpp>
 #include <vector>
 
 namespace libfreebsdnet::interface {
 
+  struct InterfaceRecord;
+
   /**
    * @brief IPv6 option enumeration
    */
@@ -58,7 +63,8 @@ namespace libfreebsdnet::interface {
     L2VLAN,         // Layer 2 Virtual LAN using 802.1Q
     EPAIR,          // Ethernet pair interface
     INFINIBAND_LAG, // InfiniBand Link Aggregation
-    IEEE8023AD_LAG  // IEEE 802.3ad Link Aggregation
+    IEEE8023AD_LAG, // IEEE 802.3ad Link Aggregation
+    VXLAN           // VXLAN tunnel (class tag; getType() reports TUNNEL)
   };
 
   /**
@@ -83,7 +89,30 @@ namespace libfreebsdnet::interface {
     ETHERNET_10G_SR,
     ETHERNET_10G_LR,
     ETHERNET_2500_T,
-    ETHERNET_5000_T
+    ETHERNET_5000_T,
+    ETHERNET_25G_CR,
+    ETHERNET_25G_KR,
+    ETHERNET_25G_SR,
+    ETHERNET_25G_LR,
+    ETHERNET_40G_CR4,
+    ETHERNET_40G_SR4,
+    ETHERNET_40G_LR4,
+    ETHERNET_40G_KR4,
+    ETHERNET_50G_CR2,
+    ETHERNET_50G_KR2,
+    ETHERNET_50G_SR2,
+    ETHERNET_50G_LR2,
+    ETHERNET_100G_CR4,
+    ETHERNET_100G_SR4,
+    ETHERNET_100G_KR4,
+    ETHERNET_100G_LR4,
+    ETHERNET_200G_SR4,
+    ETHERNET_200G_LR4,
+    ETHERNET_200G_DR4,
+    ETHERNET_200G_FR4,
+    ETHERNET_400G_FR8,
+    ETHERNET_400G_LR8,
+    ETHERNET_400G_DR4
   };
 
   /**
@@ -93,6 +122,8 @@ namespace libfreebsdnet::interface {
 
   /**
    * @brief Capability enumeration
+   * @details One value per IFCAP_* bit; see interface/capability.hpp for
+   * bit and name conversions
    */
   enum class Capability {
     RXCSUM,
@@ -104,7 +135,29 @@ namespace libfreebsdnet::interface {
     LINKSTATE,
     TSO4,
     TSO6,
-    LRO
+    LRO,
+    NETCONS,
+    JUMBO_MTU,
+    POLLING,
+    WOL_UCAST,
+    WOL_MCAST,
+    TOE4,
+    TOE6,
+    VLAN_HWFILTER,
+    NV,
+    VLAN_HWTSO,
+    NETMAP,
+    RXCSUM_IPV6,
+    TXCSUM_IPV6,
+    HWSTATS,
+    TXRTLMT,
+    HWRXTSTMP,
+    MEXTPG, // unmapped mbufs, formerly NOMAP
+    TXTLS4,
+    TXTLS6,
+    VXLAN_HWCSUM,
+    VXLAN_HWTSO,
+    TXTLS_RTLMT
   };
 
   /**
@@ -139,11 +192,24 @@ namespace libfreebsdnet::interface {
     bool isActive;
   };
 
+  /**
+   * @brief Every media field of an interface from one SIOCGIFXMEDIA call
+   */
+  struct MediaSnapshot {
+    std::string name;
+    int current = 0; // configured media word
+    int active = 0;  // media word in use, differs from current on autoselect
+    int status = 0;  // IFM_AVALID and IFM_ACTIVE bits
+    std::vector<int> supported; // media words the driver accepts
+    MediaInfo info{MediaType::UNKNOWN, MediaSubtype::UNKNOWN, {}, false};
+    MediaSubtype activeSubtype = MediaSubtype::UNKNOWN;
+  };
+
   /**
    * @brief Base interface class
    * @details Abstract base class for all network interface types
    */
-  class Interface {
+  class Interface : public ArenaAllocated {
   public:
     virtual ~Interface() = default;
 
@@ -236,6 +302,56 @@ namespace libfreebsdnet::interface {
      */
     virtual bool setFib(int fib);
 
+    /**
+     * @brief Get interface MTU, reporting why it failed
+     * @details The std::expected tier below reports a types::NetError
+     * instead of a bool or a fallback value and never allocates. The
+     * virtual getters and setters of the same name use it.
+     * @return MTU or error
+     */
+    types::NetResult<int> tryGetMtu() const;
+
+    /**
+     * @brief Set interface MTU, reporting why it failed
+     * @param mtu New MTU value
+     * @return Nothing or error
+     */
+    types::NetResult<> trySetMtu(int mtu);
+
+    /**
+     * @brief Set interface flags, reporting why it failed
+     * @param flags New flags
+     * @return Nothing or error
+     */
+    types::NetResult<> trySetFlags(int flags);
+
+    /**
+     * @brief Get FIB of this interface, reporting why it failed
+     * @return FIB number or error
+     */
+    types::NetResult<int> tryGetFib() const;
+
+    /**
+     * @brief Set FIB of this interface, reporting why it failed
+     * @param fib FIB number to assign
+     * @return Nothing or error
+     */
+    types::NetResult<> trySetFib(int fib);
+
+    /**
+     * @brief Add interface to a group, reporting why it failed
+     * @param groupName Group name
+     * @return Nothing or error
+     */
+    types::NetResult<> tryAddToGroup(const std::string &groupName);
+
+    /**
+     * @brief Remove interface from a group, reporting why it failed
+     * @param groupName Group name
+     * @return Nothing or error
+     */
+    types::NetResult<> tryRemoveFromGroup(const std::string &groupName);
+
     /**
      * @brief Get current media options for this interface
      * @return Current media options or -1 on error
@@ -292,6 +408,14 @@ namespace libfreebsdnet::interface {
      */
     virtual MediaInfo getMediaInfo() const;
 
+    /**
+     * @brief Get every media field at once
+     * @details Extended media words are understood, so 25G and faster
+     * subtypes decode instead of reading as unknown
+     * @return Media snapshot or error
+     */
+    types::NetResult<MediaSnapshot> getMediaSnapshot() const;
+
     /**
      * @brief Get interface capabilities as enum list
      * @return List of capability enums
@@ -432,18 +556,95 @@ namespace libfreebsdnet::interface {
      */
     virtual bool destroy() = 0;
 
+    /**
+     * @brief Back read-only getters with a snapshot record
+     * @details While attached, getMtu(), getAddresses() and getMacAddress()
+     * answer from the record instead of querying the kernel. Setters drop the
+     * record so later reads go live again.
+     * @param record Snapshot record for this interface
+     */
+    void attachRecord(std::shared_ptr<const InterfaceRecord> record);
+
+    /**
+     * @brief Check whether getters are answered from a snapshot record
+     * @return true if a record is attached, false otherwise
+     */
+    bool isSnapshotBacked() const;
+
+    /**
+     * @brief Get the class tag
+     * @details Unlike getType() this is not virtual and names the concrete
+     * class, so it can drive interface_cast in hot loops
+     * @return InterfaceTraits<T>::kind of the object's class, UNKNOWN for a
+     * class not built on InterfaceBase
+     */
+    InterfaceType getKind() const { return kind; }
+
+    /**
+     * @brief Get the identity of the interface this handle refers to
+     * @return Index, attach epoch and generation captured by the handle
+     */
+    InterfaceIdentity getIdentity() const;
+
+    /**
+     * @brief Check that the handle still refers to a live interface
+     * @details Follows a rename by updating the handle's name. With
+     * IdentityTracker running this needs no kernel call; otherwise one
+     * single-interface dump compares the attach epoch. A handle whose epoch
+     * is not yet known cannot tell a rename from a recreate and treats a
+     * changed name as a recreate.
+     * @return true if the handle was renamed, false if unchanged; NOT_FOUND
+     * if the interface was destroyed or its index now names another one
+     */
+    types::NetResult<bool> revalidate();
+
   protected:
-    struct Impl {
+    /**
+     * @brief Get attached snapshot record
+     * @return Record pointer or nullptr when not snapshot-backed
+     */
+    const InterfaceRecord *getRecord() const;
+
+    /**
+     * @brief Drop the snapshot record after a state change
+     */
+    void invalidateRecord();
+
+    /**
+     * @brief Get a control socket and an ifreq naming this interface
+     * @param ifr Request to clear and fill in
+     * @param family Socket address family
+     * @param operation Static name reported on error
+     * @return Socket descriptor or error
+     */
+    types::NetResult<int> prepare(struct ifreq &ifr, int family,
+                                  const char *operation) const;
+
+    /**
+     * @brief Issue SIOCAIFGROUP or SIOCDIFGROUP
+     * @param groupName Group name
+     * @param request Request code
+     * @param operation Static name reported on error
+     * @return Nothing or error
+     */
+    types::NetResult<> changeGroup(const std::string &groupName,
+                                   unsigned long request,
+                                   const char *operation);
+
+    struct Impl : ArenaAllocated {
       std::string name;
       unsigned int index;
       int flags;
       std::string lastError;
+      std::shared_ptr<const InterfaceRecord> record;
+      uint64_t epoch = 0;      // ifi_epoch, 0 until a record is seen
+      uint64_t generation = 0; // IdentityTracker generation at construction
 
-      Impl(const std::string &name, unsigned int index, int flags)
-          : name(name), index(index), flags(flags) {}
+      Impl(const std::string &name, unsigned int index, int flags);
     };
 
     std::unique_ptr<Impl> pImpl;
+    InterfaceType kind = InterfaceType::UNKNOWN; // set by InterfaceBase
     Interface() = default;
     Interface(const std::string &name, unsigned int index, int flags)
         : pImpl(std::make_unique<Impl>(name, index, flags)) {}
@@ -471,6 +672,23 @@ namespace libfreebsdnet::interface {
    */
   InterfaceType getInterfaceType(const std::string &name, int flags);
 
+  /**
+   * @brief Read the media of an interface by name
+   * @details One SIOCGIFXMEDIA into a stack buffer, or SIOCGIFMEDIA for
+   * drivers that only support the legacy request; only a media list longer
+   * than the buffer needs more calls
+   * @param name Interface name
+   * @return Media snapshot or error
+   */
+  types::NetResult<MediaSnapshot> readMediaSnapshot(const std::string &name);
+
+  /**
+   * @brief Get the ifconfig-style name of a media subtype
+   * @param subtype Media subtype
+   * @return Name such as "1000baseT" or "100GBase-SR4", "unknown" if unknown
+   */
+  const char *mediaSubtypeName(MediaSubtype subtype);
+
 } // namespace libfreebsdnet::interface
 
 #endif // LIBFREEBSDNET_INTERFACE_BASE_HPP
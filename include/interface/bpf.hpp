@@ -0,0 +1,164 @@
+/**
+ * @file interface/bpf.hpp
+ * @brief BPF capture class
+ * @details Packet capture on a BPF descriptor using zero-copy buffers,
+ * with batched record iteration and compiled filter programs
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_BPF_HPP
+#define LIBFREEBSDNET_INTERFACE_BPF_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <net/bpf.h>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief BPF capture options
+   */
+  struct BpfOptions {
+    size_t bufferSize = 2 * 1024 * 1024; // per buffer, clamped by the kernel
+    bool zeroCopy = true;  // BIOCSETZBUF, falls back to buffered reads
+    bool immediate = false; // deliver partial buffers without waiting
+  };
+
+  /**
+   * @brief Captured record
+   * @details Points into the capture buffer; valid until the visitor
+   * returns
+   */
+  struct BpfRecord {
+    std::chrono::system_clock::time_point timestamp;
+    uint32_t wireLength = 0;
+    std::span<const uint8_t> data; // captured bytes, at most wireLength
+  };
+
+  /**
+   * @brief BPF capture counters
+   */
+  struct BpfCaptureStats {
+    uint64_t received = 0; // kernel count, BIOCGSTATS
+    uint64_t dropped = 0;  // kernel count, BIOCGSTATS
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t buffers = 0;
+  };
+
+  using RecordVisitor = std::function<void(const BpfRecord &record)>;
+
+  /**
+   * @brief BPF capture class
+   * @details Prefers zero-copy mode, where the kernel fills two shared
+   * buffers in turn and records are read in place without a copy; needs
+   * net.bpf.zerocopy_enable=1. Otherwise uses the regular double buffer
+   * at the requested size with one read per buffer.
+   */
+  class BpfCapture {
+  public:
+    explicit BpfCapture(const BpfOptions &options = {});
+    ~BpfCapture();
+
+    BpfCapture(const BpfCapture &) = delete;
+    BpfCapture &operator=(const BpfCapture &) = delete;
+
+    /**
+     * @brief Open a BPF descriptor on an interface
+     * @param interface Interface name, e.g. "pflog0"
+     * @return true on success, false on error
+     */
+    bool open(const std::string &interface);
+
+    /**
+     * @brief Close the descriptor and release buffers
+     */
+    void close();
+
+    /**
+     * @brief Check if open
+     * @return true if attached to an interface
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Check buffer mode
+     * @return true if zero-copy buffers are in use
+     */
+    bool isZeroCopy() const;
+
+    /**
+     * @brief Get buffer size
+     * @return Bytes per buffer as accepted by the kernel
+     */
+    size_t getBufferSize() const;
+
+    /**
+     * @brief Get data link type
+     * @return DLT_* value of the attached interface, -1 if closed
+     */
+    int getDataLinkType() const;
+
+    /**
+     * @brief Get file descriptor
+     * @return Descriptor for poll or kqueue, -1 if closed
+     */
+    int getFd() const;
+
+    /**
+     * @brief Attach a compiled filter program
+     * @param program Instructions, e.g. from pcap_compile or parseProgram;
+     * empty to accept everything
+     * @return true on success, false on error
+     */
+    bool setFilter(std::span<const struct bpf_insn> program);
+
+    /**
+     * @brief Parse a compiled program in "tcpdump -ddd" form
+     * @param text Instruction count line, then one "code jt jf k" line
+     * per instruction
+     * @param program Output instructions
+     * @return true on success, false on malformed input
+     */
+    static bool parseProgram(const std::string &text,
+                             std::vector<struct bpf_insn> &program);
+
+    /**
+     * @brief Read completed buffers and visit their records
+     * @details In zero-copy mode a partially filled buffer is rotated out
+     * when the timeout expires
+     * @param visitor Called per record
+     * @param timeout Time to wait for a buffer
+     * @return Records visited
+     */
+    size_t read(const RecordVisitor &visitor,
+                std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Get counters
+     * @return Kernel and reader counters
+     */
+    BpfCaptureStats getStats() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_BPF_HPP
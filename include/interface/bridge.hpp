@@ -10,18 +10,78 @@
 #ifndef LIBFREEBSDNET_INTERFACE_BRIDGE_HPP
 #define LIBFREEBSDNET_INTERFACE_BRIDGE_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
 #include "vnet.hpp"
+#include <cstdint>
+#include <ethernet/address.hpp>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief Bridge member structure
+   * @details One entry of the BRDGGIFS member list
+   */
+  struct BridgeMember {
+    std::string name;
+    unsigned int index = 0;
+    uint32_t flags = 0; // IFBIF_* flags
+    uint32_t pathCost = 0;
+    uint8_t portNumber = 0;
+    uint8_t priority = 0;
+    uint8_t state = 0; // BSTP_IFSTATE_* value
+    uint8_t role = 0;  // BSTP_ROLE_* value
+    uint32_t addressCount = 0;
+    uint32_t addressMax = 0;
+  };
+
+  /**
+   * @brief Bridge address cache entry structure
+   * @details One learned or static forwarding entry from BRDGRTS
+   */
+  struct BridgeAddress {
+    libfreebsdnet::ethernet::MacAddress mac;
+    uint16_t vlan = 0;
+    uint8_t flags = 0;       // IFBAF_* flags
+    unsigned int member = 0; // Member interface index, 0 if unresolved
+    unsigned long expire = 0; // Seconds until the entry ages out
+  };
+
+  /**
+   * @brief Per-member outcome of a batch bridge operation
+   */
+  struct BridgeMemberResult {
+    std::string name;
+    int error = 0; // errno value, 0 on success
+
+    /**
+     * @brief Check whether the operation succeeded
+     * @return true if error is 0
+     */
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief Member settings for BridgeInterface::configureMembers()
+   * @details Unset fields are left as they are
+   */
+  struct BridgeMemberSettings {
+    std::string name;
+    uint32_t setFlags = 0;   // IFBIF_* flags to set
+    uint32_t clearFlags = 0; // IFBIF_* flags to clear
+    std::optional<uint32_t> pathCost;
+    std::optional<uint8_t> priority;
+  };
+
   /**
    * @brief Bridge interface class
    * @details Provides bridge-specific interface operations
    */
-  class BridgeInterface : public Interface, public VnetInterface {
+  class BridgeInterface : public InterfaceBase<BridgeInterface>,
+                          public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -36,21 +96,6 @@ namespace libfreebsdnet::interface {
      */
     ~BridgeInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Add interface to bridge
      * @param interfaceName Interface name to add
@@ -65,12 +110,61 @@ namespace libfreebsdnet::interface {
      */
     bool removeInterface(const std::string &interfaceName);
 
+    /**
+     * @brief Add several interfaces to bridge
+     * @details Continues past failures
+     * @param interfaceNames Interface names to add
+     * @return One result per name, in order
+     */
+    std::vector<BridgeMemberResult>
+    addInterfaces(std::span<const std::string> interfaceNames);
+
+    /**
+     * @brief Remove several interfaces from bridge
+     * @details Continues past failures
+     * @param interfaceNames Interface names to remove
+     * @return One result per name, in order
+     */
+    std::vector<BridgeMemberResult>
+    removeInterfaces(std::span<const std::string> interfaceNames);
+
+    /**
+     * @brief Apply flag, path cost and priority changes to members
+     * @details Current flags are read for all members with one request;
+     * only changed values are written
+     * @param settings Settings per member
+     * @return One result per entry, in order; ENOENT for non-members
+     */
+    std::vector<BridgeMemberResult>
+    configureMembers(std::span<const BridgeMemberSettings> settings);
+
     /**
      * @brief Get interfaces in bridge
      * @return Vector of interface names
      */
     std::vector<std::string> getInterfaces() const;
 
+    /**
+     * @brief Get bridge members with their port state
+     * @return Vector of members, empty on error
+     */
+    std::vector<BridgeMember> getMembers() const;
+
+    /**
+     * @brief Dump the bridge address cache
+     * @details Reads the whole forwarding database with one BRDGRTS request,
+     * growing the buffer and retrying if the cache grew in between
+     * @param addresses Output entries; existing capacity is reused
+     * @return true on success, false on error
+     */
+    bool getAddressCache(std::vector<BridgeAddress> &addresses) const;
+
+    /**
+     * @brief Dump the bridge address cache
+     * @return Vector of entries, empty on error
+     */
+    std::vector<BridgeAddress> getAddressCache() const;
+
     /**
      * @brief Check if interface is in bridge
      * @param interfaceName Interface name to check
@@ -80,19 +174,32 @@ namespace libfreebsdnet::interface {
 
     /**
      * @brief Enable spanning tree protocol
-     * @return true on success, false on error
+     * @details STP is a per-port setting; this enables it on every member
+     * except span ports
+     * @return true on success, false if any member failed
      */
     bool enableStp();
 
     /**
      * @brief Disable spanning tree protocol
-     * @return true on success, false on error
+     * @details Disables it on every member except span ports
+     * @return true on success, false if any member failed
      */
     bool disableStp();
 
+    /**
+     * @brief Enable or disable spanning tree protocol on some members
+     * @details Span ports are left unchanged and reported as succeeded
+     * @param interfaceNames Member names
+     * @param enable true to enable, false to disable
+     * @return One result per name, in order
+     */
+    std::vector<BridgeMemberResult>
+    setStp(std::span<const std::string> interfaceNames, bool enable);
+
     /**
      * @brief Check if STP is enabled
-     * @return true if STP is enabled, false otherwise
+     * @return true if STP is enabled on any member, false otherwise
      */
     bool isStpEnabled() const;
 
@@ -122,19 +229,9 @@ namespace libfreebsdnet::interface {
      */
     int getAgingTime() const;
 
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
     uint32_t getEnabledCapabilities() const override;
     bool enableCapabilities(uint32_t capabilities) override;
     bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
@@ -142,7 +239,6 @@ namespace libfreebsdnet::interface {
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
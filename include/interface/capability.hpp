@@ -0,0 +1,113 @@
+/**
+ * @file interface/capability.hpp
+ * @brief Interface capability names and offload profiles
+ * @details Conversions between Capability values, IFCAP_* bits and
+ * ifconfig(8) names, and consistent application of an offload set across
+ * an interface and the lagg and vlan interfaces stacked on it
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_CAPABILITY_HPP
+#define LIBFREEBSDNET_INTERFACE_CAPABILITY_HPP
+
+#include <cstdint>
+#include <interface/base.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Get the IFCAP_* bit of a capability
+   * @param capability Capability
+   * @return Bit mask with one bit set
+   */
+  uint32_t capabilityBit(Capability capability);
+
+  /**
+   * @brief Get the ifconfig(8) name of a capability
+   * @param capability Capability
+   * @return Upper-case name, e.g. "TXCSUM_IPV6"
+   */
+  std::string_view capabilityName(Capability capability);
+
+  /**
+   * @brief Parse a capability name
+   * @details Case-insensitive; "NOMAP" is accepted for MEXTPG
+   * @param name Capability name
+   * @param capability Output capability
+   * @return true if the name is known
+   */
+  bool parseCapability(std::string_view name, Capability &capability);
+
+  /**
+   * @brief Expand a capability mask
+   * @param bits IFCAP_* mask
+   * @return Capabilities in bit order
+   */
+  std::vector<Capability> capabilitiesFromBits(uint32_t bits);
+
+  /**
+   * @brief Offload profile structure
+   * @details Bits to turn on and off. Bits the interface does not support
+   * are skipped rather than requested.
+   */
+  struct OffloadProfile {
+    uint32_t enable = 0;
+    uint32_t disable = 0;
+
+    /**
+     * @brief Profile for hosts terminating traffic
+     * @details Every checksum, segmentation, receive aggregation and VLAN
+     * offload, including IPv6 and VXLAN variants and unmapped mbufs
+     * @return Profile
+     */
+    static OffloadProfile throughput();
+
+    /**
+     * @brief Profile for forwarding hosts
+     * @details As throughput() but with LRO and TOE off, since coalesced
+     * or stack-bypassing receive breaks forwarding
+     * @return Profile
+     */
+    static OffloadProfile forwarding();
+  };
+
+  /**
+   * @brief Outcome of applying a profile to one interface
+   */
+  struct OffloadResult {
+    std::string name;
+    uint32_t before = 0;      // enabled bits before the sweep
+    uint32_t after = 0;       // enabled bits after the sweep
+    uint32_t unsupported = 0; // requested bits the interface lacks
+    uint32_t refused = 0;     // supported bits the driver would not change
+    int error = 0;            // errno value of the first failure, 0 if none
+
+    /**
+     * @brief Check if every supported bit was applied
+     * @return true if nothing was refused
+     */
+    bool succeeded() const { return error == 0 && refused == 0; }
+  };
+
+  /**
+   * @brief Apply an offload profile to an interface stack
+   * @details Targets the interface, its lagg ports if it is a lagg, and
+   * every vlan whose parent is one of those, in that order: ports first so
+   * the lagg sees their final state, and vlans last since they inherit
+   * from their parent. When the driver rejects a whole request, the bits
+   * are retried one at a time to find the refused ones.
+   * @param name Interface name (e.g., "lagg0" or "ix0")
+   * @param profile Bits to enable and disable
+   * @return One result per interface touched
+   */
+  std::vector<OffloadResult> applyOffloadProfile(const std::string &name,
+                                                 const OffloadProfile &profile);
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_CAPABILITY_HPP
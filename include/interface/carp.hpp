@@ -10,7 +10,7 @@
 
 #pragma once
 
-#include <interface/base.hpp>
+#include <interface/traits.hpp>
 #include <memory>
 #include <netinet/ip_carp.h>
 #include <string>
@@ -23,11 +23,22 @@ namespace libfreebsdnet::interface {
    */
   enum class CarpState { INIT, BACKUP, MASTER };
 
+  /**
+   * @brief CARP status of one VHID
+   */
+  struct CarpInfo {
+    int vhid = 0;
+    CarpState state = CarpState::INIT;
+    int advbase = 0;
+    int advskew = 0;
+    std::string key; // empty unless the caller is privileged
+  };
+
   /**
    * @brief CARP interface class
    * @details Implementation of CARP interface functionality
    */
-  class CarpInterface : public Interface {
+  class CarpInterface : public InterfaceBase<CarpInterface> {
   public:
     /**
      * @brief Constructor
@@ -42,21 +53,6 @@ namespace libfreebsdnet::interface {
      */
     ~CarpInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     int getMedia() const override;
     bool setMedia(int media) override;
     int getMediaStatus() const override;
@@ -67,19 +63,22 @@ namespace libfreebsdnet::interface {
     uint32_t getEnabledCapabilities() const override;
     bool enableCapabilities(uint32_t capabilities) override;
     bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
     bool destroy() override;
 
     // CARP-specific methods
+    /**
+     * @brief Get status of every VHID on the interface
+     * @details All VHIDs come back from a single SIOCGVH request
+     * @return Status per VHID, empty if none or on error
+     */
+    std::vector<CarpInfo> getCarpInfo() const;
+
     /**
      * @brief Get CARP VHID (Virtual Host ID)
      * @return VHID or -1 if not set
@@ -0,0 +1,97 @@
+/**
+ * @file interface/carpwatch.hpp
+ * @brief CARP state transition watcher
+ * @details Reports MASTER/BACKUP changes as they happen by re-reading CARP
+ * status when the netlink monitor sees activity on a watched interface
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_CARPWATCH_HPP
+#define LIBFREEBSDNET_INTERFACE_CARPWATCH_HPP
+
+#include <chrono>
+#include <functional>
+#include <interface/carp.hpp>
+#include <memory>
+#include <string>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief CARP state change of one VHID
+   */
+  struct CarpTransition {
+    std::string interface;
+    int vhid = 0;
+    CarpState from = CarpState::INIT;
+    CarpState to = CarpState::INIT;
+    std::chrono::steady_clock::time_point observedAt;
+  };
+
+  using CarpCallback = std::function<void(const CarpTransition &)>;
+
+  /**
+   * @brief CARP watcher class
+   * @details The kernel announces a transition by adding or removing the
+   * routes of the VHID's addresses, and by a link event on the carrier, but
+   * says nothing about the VHID itself. The watcher subscribes to those
+   * netlink groups and, when an event names a watched interface, re-reads
+   * all its VHIDs with one SIOCGVH and reports what changed. Callbacks run
+   * on the monitor thread.
+   */
+  class CarpWatcher {
+  public:
+    CarpWatcher();
+    ~CarpWatcher();
+
+    /**
+     * @brief Watch the VHIDs of an interface
+     * @details Records the current states as the baseline
+     * @param name Interface carrying the VHIDs (e.g., "em0")
+     * @return true on success, false on error
+     */
+    bool watch(const std::string &name);
+
+    /**
+     * @brief Stop watching an interface
+     * @param name Interface name
+     * @return true if it was watched
+     */
+    bool unwatch(const std::string &name);
+
+    /**
+     * @brief Start delivering transitions
+     * @param callback Called once per changed VHID
+     * @return true on success, false on error
+     */
+    bool start(const CarpCallback &callback);
+
+    /**
+     * @brief Stop delivering transitions
+     * @return true on success, false on error
+     */
+    bool stop();
+
+    /**
+     * @brief Re-read every watched interface now
+     * @details Also usable without start() as a cheap poll
+     * @return Number of transitions reported
+     */
+    size_t poll();
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_CARPWATCH_HPP
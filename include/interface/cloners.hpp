@@ -0,0 +1,97 @@
+/**
+ * @file interface/cloners.hpp
+ * @brief Process-wide interface cloner cache and unit allocator
+ * @details Caches the SIOCIFGCLONERS list and hands out free unit numbers
+ * per cloner from a bitmap seeded by one interface snapshot
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_CLONERS_HPP
+#define LIBFREEBSDNET_INTERFACE_CLONERS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Cloner cache
+   * @details The cloner list is read once and kept until invalidate();
+   * loading a kernel module that registers a new cloner is the only thing
+   * that changes it. Unit allocation seeds a per-cloner bitmap from an
+   * InterfaceSnapshot the first time a cloner is used, then tracks
+   * allocations and releases itself, so creating many interfaces costs no
+   * further scans. Interfaces created by other processes are not seen
+   * until resync(); a create that fails with EEXIST should reserve() the
+   * name and allocate again. Thread-safe.
+   */
+  class ClonerCache {
+  public:
+    /**
+     * @brief Get the interface cloners known to the kernel
+     * @return Cloner names such as "vlan" and "lagg", in kernel order
+     */
+    static std::vector<std::string> getCloners();
+
+    /**
+     * @brief Check if a cloner exists
+     * @param cloner Cloner name
+     * @return true if the kernel can clone this interface type
+     */
+    static bool hasCloner(const std::string &cloner);
+
+    /**
+     * @brief Allocate the lowest free unit of a cloner
+     * @details The unit stays allocated until release() or resync()
+     * @param cloner Cloner name
+     * @return Unit number, -1 if the cloner is unknown or the snapshot failed
+     */
+    static int allocateUnit(const std::string &cloner);
+
+    /**
+     * @brief Allocate the lowest free interface name of a cloner
+     * @param cloner Cloner name
+     * @return Name such as "vlan17", empty on error
+     */
+    static std::string allocateName(const std::string &cloner);
+
+    /**
+     * @brief Mark an interface name as taken
+     * @details For interfaces created outside the allocator
+     * @param name Interface name
+     * @return true if the name belongs to a known cloner
+     */
+    static bool reserve(const std::string &name);
+
+    /**
+     * @brief Return an interface name to the allocator
+     * @details Call after destroying the interface or when its creation
+     * failed
+     * @param name Interface name
+     */
+    static void release(const std::string &name);
+
+    /**
+     * @brief Drop the unit bitmaps
+     * @details The next allocation re-seeds from a fresh snapshot
+     */
+    static void resync();
+
+    /**
+     * @brief Drop the cloner list and the unit bitmaps
+     */
+    static void invalidate();
+
+    /**
+     * @brief Get number of SIOCIFGCLONERS reads performed
+     * @return Kernel query count
+     */
+    static uint64_t getQueryCount();
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_CLONERS_HPP
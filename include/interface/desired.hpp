@@ -0,0 +1,115 @@
+/**
+ * @file interface/desired.hpp
+ * @brief Declarative interface configuration
+ * @details Desired-state description of interfaces and an engine that diffs
+ * it against the live state and issues only the ioctls needed to converge
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_DESIRED_HPP
+#define LIBFREEBSDNET_INTERFACE_DESIRED_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Desired state of one interface
+   * @details Unset fields are left alone. The interface must already exist;
+   * creating and destroying interfaces is up to the caller.
+   */
+  struct InterfaceConfig {
+    std::string name;
+    std::vector<std::string> lower; // stacked on: vlan parent, lagg ports
+    std::optional<int> mtu;
+    std::optional<int> fib;
+    std::optional<bool> up;
+    uint32_t enableCapabilities = 0;  // IFCAP_* bits to turn on
+    uint32_t disableCapabilities = 0; // IFCAP_* bits to turn off
+    // Exact set of addresses; IPv6 link-local addresses are never removed
+    std::optional<std::vector<libfreebsdnet::types::Address>> addresses;
+  };
+
+  /**
+   * @brief Kind of change issued by the engine
+   */
+  enum class ChangeKind {
+    MTU,
+    FIB,
+    CAPABILITIES,
+    ADDRESS_REMOVE,
+    ADDRESS_ADD,
+    FLAGS
+  };
+
+  /**
+   * @brief One ioctl the engine decided to issue
+   */
+  struct ConfigChange {
+    std::string interface;
+    ChangeKind kind;
+    int value = 0;                           // MTU, FIB, flags or caps
+    libfreebsdnet::types::Address address{}; // address changes only
+    int level = 0;                           // stacking depth, 0 = bottom
+    int error = 0;                           // errno value, 0 on success
+
+    /**
+     * @brief Check if the change was applied
+     * @return true if the ioctl succeeded
+     */
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief Configuration engine class
+   * @details Current state comes from one InterfaceSnapshot, plus a
+   * SIOCGIFFIB or SIOCGIFCAP only for interfaces whose config sets a FIB or
+   * capabilities. Changes run bottom-up by stacking level, so a lagg is
+   * configured before its ports' vlans, except that MTU decreases run
+   * top-down so children never exceed their parent. Interfaces on the same
+   * level are configured in parallel.
+   */
+  class ConfigApplier {
+  public:
+    ConfigApplier();
+    ~ConfigApplier();
+
+    /**
+     * @brief Compute the changes needed without applying them
+     * @param configs Desired state
+     * @return Changes in the order apply() would issue them
+     */
+    std::vector<ConfigChange> plan(std::span<const InterfaceConfig> configs);
+
+    /**
+     * @brief Converge interfaces on the desired state
+     * @details Failures do not stop the other changes; check each entry
+     * @param configs Desired state
+     * @param workers Worker threads, 0 to pick automatically
+     * @return Changes issued, in plan order, with their outcome
+     */
+    std::vector<ConfigChange> apply(std::span<const InterfaceConfig> configs,
+                                    unsigned int workers = 0);
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_DESIRED_HPP
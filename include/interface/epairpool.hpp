@@ -0,0 +1,110 @@
+/**
+ * @file interface/epairpool.hpp
+ * @brief Pre-created epair pool
+ * @details Keeps epair pairs ready in the background and hands them to
+ * VNET jails with a rename and a move
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_EPAIRPOOL_HPP
+#define LIBFREEBSDNET_INTERFACE_EPAIRPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Epair pool options
+   */
+  struct EpairPoolOptions {
+    size_t size = 16; // pairs kept ready
+    int mtu = 0;      // set on both ends while pre-creating, 0 to keep
+    bool up = true;   // bring the host end up while pre-creating
+  };
+
+  /**
+   * @brief Names of both ends of an epair
+   */
+  struct EpairPair {
+    std::string host; // "a" end, stays in the host
+    std::string jail; // "b" end, moved into the jail
+  };
+
+  /**
+   * @brief Epair pool class
+   * @details A background thread keeps the pool topped up, so handing a
+   * pair to a jail costs only the renames and one SIOCSIFVNET on the
+   * caller's path. An empty pool falls back to creating a pair inline.
+   */
+  class EpairPool {
+  public:
+    explicit EpairPool(const EpairPoolOptions &options = {});
+
+    /**
+     * @brief Destructor
+     * @details Stops the refill thread and destroys pairs not handed out
+     */
+    ~EpairPool();
+
+    /**
+     * @brief Start the refill thread
+     * @return true on success
+     */
+    bool start();
+
+    /**
+     * @brief Stop the refill thread
+     */
+    void stop();
+
+    /**
+     * @brief Get number of ready pairs
+     * @return Pairs in the pool
+     */
+    size_t getAvailable() const;
+
+    /**
+     * @brief Take a pair out of the pool
+     * @param pair Output names as created
+     * @return true on success, false if none could be created
+     */
+    bool acquire(EpairPair &pair);
+
+    /**
+     * @brief Hand a pair to a jail
+     * @details Renames both ends, then moves the jail end into the jail's
+     * VNET; the pair is destroyed again if any step fails
+     * @param jid Jail ID
+     * @param hostName New name of the host end, empty to keep
+     * @param jailName New name of the jail end, empty to keep
+     * @param pair Output final names
+     * @return true on success, false on error
+     */
+    bool attach(int jid, const std::string &hostName,
+                const std::string &jailName, EpairPair &pair);
+
+    /**
+     * @brief Destroy a pair
+     * @param host Name of the host end; destroying it removes both ends
+     * @return true on success, false on error
+     */
+    bool release(const std::string &host);
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_EPAIRPOOL_HPP
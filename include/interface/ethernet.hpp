@@ -10,9 +10,10 @@
 #ifndef LIBFREEBSDNET_INTERFACE_ETHERNET_HPP
 #define LIBFREEBSDNET_INTERFACE_ETHERNET_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
 #include "vnet.hpp"
 #include <ethernet/address.hpp>
+#include <interface/queues.hpp>
 #include <vector>
 
 namespace libfreebsdnet::interface {
@@ -21,7 +22,8 @@ namespace libfreebsdnet::interface {
    * @brief Ethernet interface class
    * @details Provides Ethernet-specific interface operations
    */
-  class EthernetInterface : public Interface, public VnetInterface {
+  class EthernetInterface : public InterfaceBase<EthernetInterface>,
+                            public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -36,20 +38,6 @@ namespace libfreebsdnet::interface {
      */
     ~EthernetInterface() override;
 
-    // Interface base class methods
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Get MAC address
      * @return MAC address or empty address on error
@@ -93,34 +81,18 @@ namespace libfreebsdnet::interface {
      */
     bool isPromiscuousModeEnabled() const;
 
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
+    /**
+     * @brief Get normalized per-queue driver counters
+     * @details Use QueueSampler to turn repeated reads into rates
+     * @return Counters per hardware queue, empty if the driver has none
+     */
+    std::vector<QueueCounters> getQueueCounters() const;
+
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
     bool reclaimFromVnet() override;
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
-
-    // Override base class methods to provide Ethernet-specific implementations
-    MediaInfo getMediaInfo() const override;
-    std::vector<Capability> getCapabilityList() const override;
-    std::vector<Flag> getFlags() const override;
 
     bool destroy() override;
 
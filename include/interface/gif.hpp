@@ -19,7 +19,8 @@ namespace libfreebsdnet::interface {
    * @brief GIF tunnel interface class
    * @details Provides GIF-specific tunnel operations
    */
-  class GifInterface : public TunnelInterface, public VnetInterface {
+  class GifInterface : public InterfaceBase<GifInterface, TunnelInterface>,
+                       public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -34,12 +35,6 @@ namespace libfreebsdnet::interface {
      */
     ~GifInterface() override;
 
-    /**
-     * @brief Get interface type
-     * @return Interface type
-     */
-    InterfaceType getType() const override;
-
     /**
      * @brief Get GIF protocol
      * @return Protocol number or -1 if not set
@@ -105,47 +100,11 @@ namespace libfreebsdnet::interface {
      */
     bool setPmtuDiscovery(bool enabled);
 
-    /**
-     * @brief Get tunnel FIB
-     * @return Tunnel FIB or -1 on error
-     */
-    int getTunnelFib() const;
-
-    /**
-     * @brief Set tunnel FIB
-     * @param fib FIB number
-     * @return true on success, false on error
-     */
-    bool setTunnelFib(int fib);
-
-    // Base class method overrides
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
-    std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
-
     // VNET interface methods
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
     bool reclaimFromVnet() override;
-
-    // Group management methods (call base class)
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
   };
 
 } // namespace libfreebsdnet::interface
@@ -0,0 +1,134 @@
+/**
+ * @file interface/groups.hpp
+ * @brief Interface group membership index
+ * @details Two-way index between interface groups and their members, built
+ * in one sweep and kept current from the netlink monitor, with batched
+ * membership changes
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_GROUPS_HPP
+#define LIBFREEBSDNET_INTERFACE_GROUPS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <types/error.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Interface group index class
+   * @details refresh() reads every interface's groups with one SIOCGIFGROUP
+   * each and fills hash maps in both directions, so "who is in tenant42"
+   * and "which groups is em0 in" are single lookups. While started, link
+   * events re-read the groups of the interfaces they name and departed
+   * interfaces are dropped. The kernel announces no event for a group
+   * change on its own; changes made through this index are applied to it
+   * directly, and changes made elsewhere are picked up by refreshGroup(),
+   * refresh() or the next link event on the member. Thread-safe.
+   */
+  class InterfaceGroupIndex {
+  public:
+    InterfaceGroupIndex();
+    ~InterfaceGroupIndex();
+
+    /**
+     * @brief Rebuild the index from the kernel
+     * @return true on success, false on error
+     */
+    bool refresh();
+
+    /**
+     * @brief Re-read one group's members with SIOCGIFGMEMB
+     * @param group Group name
+     * @return true on success, false if the group does not exist
+     */
+    bool refreshGroup(const std::string &group);
+
+    /**
+     * @brief Follow link events from the netlink monitor
+     * @details Calls refresh() first if the index is empty
+     * @return true on success, false on error
+     */
+    bool start();
+
+    /**
+     * @brief Stop following link events
+     * @return true on success, false on error
+     */
+    bool stop();
+
+    /**
+     * @brief Get the members of a group
+     * @param group Group name
+     * @return Member interface names, sorted; empty if the group is unknown
+     */
+    std::vector<std::string> getMembers(const std::string &group) const;
+
+    /**
+     * @brief Get the groups of an interface
+     * @param name Interface name
+     * @return Group names, sorted; empty if the interface is unknown
+     */
+    std::vector<std::string> getGroups(const std::string &name) const;
+
+    /**
+     * @brief Check membership
+     * @param group Group name
+     * @param name Interface name
+     * @return true if the interface is in the group
+     */
+    bool isMember(const std::string &group, const std::string &name) const;
+
+    /**
+     * @brief Get every known group
+     * @return Group names, sorted
+     */
+    std::vector<std::string> getGroupNames() const;
+
+    /**
+     * @brief Add interfaces to a group
+     * @details One SIOCAIFGROUP per interface through a single request
+     * structure; the index is updated for each success
+     * @param group Group name
+     * @param names Interfaces to add
+     * @return One result per interface, in input order
+     */
+    std::vector<types::NetResult<>>
+    addMembers(const std::string &group, std::span<const std::string> names);
+
+    /**
+     * @brief Remove interfaces from a group
+     * @param group Group name
+     * @param names Interfaces to remove
+     * @return One result per interface, in input order
+     */
+    std::vector<types::NetResult<>>
+    removeMembers(const std::string &group,
+                  std::span<const std::string> names);
+
+    /**
+     * @brief Get number of times the index has been rebuilt
+     * @return refresh() count
+     */
+    uint64_t getRefreshCount() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_GROUPS_HPP
@@ -0,0 +1,89 @@
+/**
+ * @file interface/identity.hpp
+ * @brief Stable interface identity
+ * @details An interface index alone does not identify an interface: names
+ * change with SIOCSIFNAME and indices are reused after destroy/recreate.
+ * Identity pairs the index with the kernel attach epoch and a per-index
+ * generation bumped by link deletions, so cached handles can tell a rename
+ * (same interface, follow it) from a recreate (different interface)
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_IDENTITY_HPP
+#define LIBFREEBSDNET_INTERFACE_IDENTITY_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Identity of one interface instance
+   */
+  struct InterfaceIdentity {
+    unsigned int index = 0;
+    uint64_t epoch = 0;      // if_data ifi_epoch at attach, 0 if unknown
+    uint64_t generation = 0; // IdentityTracker generation of the index
+
+    bool operator==(const InterfaceIdentity &) const = default;
+  };
+
+  /**
+   * @brief Process-wide interface identity tracker
+   * @details Follows netlink link events: a deletion bumps the generation
+   * of its index, a NEWLINK with a new name records a rename. A deletion
+   * and arrival of one index with the same attach epoch in one batch, as
+   * if_rename() sends, is a rename, not a new interface. While it
+   * runs, Interface::revalidate() answers without touching the kernel.
+   * Thread-safe.
+   */
+  class IdentityTracker {
+  public:
+    /**
+     * @brief Seed current names and follow link events
+     * @details Indexes that vanished or changed name since tracking last
+     * stopped get a new generation
+     * @return true on success, false on error
+     */
+    static bool start();
+
+    /**
+     * @brief Stop following link events
+     * @details Generations are kept, so handles taken meanwhile stay
+     * comparable if tracking is started again
+     */
+    static void stop();
+
+    /**
+     * @brief Check if link events are being followed
+     * @return true if running, false otherwise
+     */
+    static bool isRunning();
+
+    /**
+     * @brief Get the generation of an interface index
+     * @param index Interface index
+     * @return Number of deletions seen for the index
+     */
+    static uint64_t getGeneration(unsigned int index);
+
+    /**
+     * @brief Get the current name of an interface index
+     * @param index Interface index
+     * @param name Output name
+     * @return true if the index is present
+     */
+    static bool getName(unsigned int index, std::string &name);
+
+    /**
+     * @brief Get number of renames seen
+     * @return Rename count
+     */
+    static uint64_t getRenameCount();
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_IDENTITY_HPP
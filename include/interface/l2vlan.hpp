@@ -11,7 +11,7 @@
 #define LIBFREEBSDNET_INTERFACE_L2VLAN_HPP
 
 #include <cstdint>
-#include <interface/base.hpp>
+#include <interface/traits.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -22,7 +22,7 @@ namespace libfreebsdnet::interface {
    * @brief L2VLAN interface class
    * @details Provides L2VLAN (Layer 2 Virtual LAN) interface functionality
    */
-  class L2VlanInterface : public Interface {
+  class L2VlanInterface : public InterfaceBase<L2VlanInterface> {
   public:
     /**
      * @brief Constructor
@@ -37,21 +37,6 @@ namespace libfreebsdnet::interface {
      */
     ~L2VlanInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Check if interface is valid
      * @return true if valid, false otherwise
@@ -89,20 +74,12 @@ namespace libfreebsdnet::interface {
     bool enableCapabilities(uint32_t capabilities) override;
     bool disableCapabilities(uint32_t capabilities) override;
 
-    // Group support
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
-
-    // VNET support
-
     // Physical address support
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
 
     // Interface cloning support
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
 
     // MAC address support
     std::string getMacAddress() const override;
@@ -10,8 +10,12 @@
 #ifndef LIBFREEBSDNET_INTERFACE_LAGG_HPP
 #define LIBFREEBSDNET_INTERFACE_LAGG_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
 #include "vnet.hpp"
+#include <cstdint>
+#include <ethernet/address.hpp>
+#include <interface/lagghash.hpp>
+#include <interface/sampler.hpp>
 #include <string>
 #include <vector>
 
@@ -29,11 +33,60 @@ namespace libfreebsdnet::interface {
     ROUNDROBIN   // Round robin
   };
 
+  /**
+   * @brief LACP actor or partner parameters of a port
+   */
+  struct LacpPeer {
+    uint16_t systemPriority = 0;
+    libfreebsdnet::ethernet::MacAddress system;
+    uint16_t key = 0;
+    uint16_t portPriority = 0;
+    uint16_t port = 0;
+    uint8_t state = 0; // LACP_STATE_* bits
+  };
+
+  /**
+   * @brief LAGG port structure
+   */
+  struct LagPort {
+    std::string name;
+    unsigned int index = 0;
+    uint32_t priority = 0;
+    uint32_t flags = 0; // LAGG_PORT_* bits
+    LacpPeer actor;     // LACP only
+    LacpPeer partner;   // LACP only
+
+    bool isActive() const;
+    bool isCollecting() const;
+    bool isDistributing() const;
+  };
+
+  /**
+   * @brief Traffic carried by one LAGG port
+   */
+  struct LagPortLoad {
+    LagPort port;
+    RateSet rates;        // sampler moving averages
+    double shareIn = 0;   // fraction of the bundle's received bits
+    double shareOut = 0;  // fraction of the bundle's transmitted bits
+  };
+
+  /**
+   * @brief Traffic distribution across a LAGG bundle
+   */
+  struct LagLoad {
+    std::vector<LagPortLoad> ports;
+    // Busiest distributing port over the mean, 1.0 when perfectly even
+    double imbalanceIn = 0;
+    double imbalanceOut = 0;
+  };
+
   /**
    * @brief LAGG interface class
    * @details Provides LAGG-specific interface operations
    */
-  class LagInterface : public Interface, public VnetInterface {
+  class LagInterface : public InterfaceBase<LagInterface>,
+                       public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -48,21 +101,6 @@ namespace libfreebsdnet::interface {
      */
     ~LagInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Get LAGG protocol
      * @return LAGG protocol type
@@ -96,12 +134,36 @@ namespace libfreebsdnet::interface {
      */
     std::vector<std::string> getPorts() const;
 
+    /**
+     * @brief Get LAGG ports with flags and LACP state
+     * @details All ports come back from a single SIOCGLAGG request
+     * @return Vector of ports, empty on error
+     */
+    std::vector<LagPort> getMembers() const;
+
+    /**
+     * @brief Get per-port traffic rates and their balance
+     * @details Ports the sampler has not seen yet report zero rates
+     * @param sampler Running statistics sampler
+     * @return Per-port load, empty on error
+     */
+    LagLoad getLoad(const StatisticsSampler &sampler) const;
+
     /**
      * @brief Get LAGG hash type
      * @return Hash type string (e.g., "l2,l3,l4")
      */
     std::string getHashType() const;
 
+    /**
+     * @brief Get hash configuration for LagHashSimulator
+     * @details Reads lagg_reqflags and lagg_reqopts; the hash key is not
+     * exported by the kernel and is left at 0
+     * @param config Output configuration
+     * @return true on success, false on error
+     */
+    bool getHashConfig(LagHashConfig &config) const;
+
     /**
      * @brief Check if interface is in LAGG
      * @param interfaceName Interface name to check
@@ -116,19 +178,6 @@ namespace libfreebsdnet::interface {
     int getActiveInterfaceCount() const;
 
     // Interface base class methods
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
@@ -136,7 +185,6 @@ namespace libfreebsdnet::interface {
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
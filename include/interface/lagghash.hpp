@@ -0,0 +1,119 @@
+/**
+ * @file interface/lagghash.hpp
+ * @brief Offline LAGG hash simulator
+ * @details Reproduces the kernel's per-flow port selection for lagg(4)
+ * loadbalance and LACP bundles so flow sets can be checked for imbalance
+ * before a hash or membership change
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_LAGGHASH_HPP
+#define LIBFREEBSDNET_INTERFACE_LAGGHASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief LAGG hash configuration
+   * @details Mirrors lagg_reqflags and the flowid fields of lagg_reqopts.
+   * The kernel seeds each lagg with a random key that is not exported, so
+   * simulated selections match the kernel only for a known key; the shape
+   * of the distribution does not depend on it.
+   */
+  struct LagHashConfig {
+    uint32_t flags = 0x7;   // LAGG_F_HASHL2 | LAGG_F_HASHL3 | LAGG_F_HASHL4
+    bool useFlowId = false; // LAGG_OPT_USE_FLOWID
+    int flowIdShift = 0;
+    uint32_t key = 0;
+  };
+
+  /**
+   * @brief Flow record structure
+   * @details One entry per flow; addresses in network byte order as they
+   * appear on the wire, ports and VLAN in host byte order
+   */
+  struct LagFlow {
+    std::array<uint8_t, 6> srcMac{};
+    std::array<uint8_t, 6> dstMac{};
+    uint16_t vlan = 0;      // 802.1Q tag, 0 if untagged
+    types::Address srcIp;   // Unset for non-IP traffic
+    types::Address dstIp;
+    uint8_t protocol = 0;   // IPPROTO_* value
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    uint32_t flowLabel = 0; // IPv6 only
+    uint32_t flowId = 0;    // NIC flowid, used with useFlowId
+  };
+
+  /**
+   * @brief LAGG hash simulator class
+   * @details Implements m_ether_tcpip_hash() over flow records and the
+   * modulo port pick shared by the loadbalance and LACP protocols. Ports
+   * are numbered in bundle order, counting only ports that carry traffic.
+   * Like the kernel, IPv6 L4 hashing uses the flow label, not the ports.
+   */
+  class LagHashSimulator {
+  public:
+    /**
+     * @brief Constructor
+     * @param config Hash configuration
+     * @param ports Number of distributing ports
+     */
+    LagHashSimulator(const LagHashConfig &config, unsigned int ports);
+
+    /**
+     * @brief Compute the kernel hash of a flow
+     * @param flow Flow record
+     * @return Hash value before port reduction
+     */
+    uint32_t hash(const LagFlow &flow) const;
+
+    /**
+     * @brief Select the port for a flow
+     * @param flow Flow record
+     * @return Port number, 0 when the bundle has no ports
+     */
+    unsigned int select(const LagFlow &flow) const;
+
+    /**
+     * @brief Select ports for a batch of flows
+     * @param flows Flow records
+     * @param ports Output, one port per flow
+     * @return Number of flows processed
+     */
+    size_t select(std::span<const LagFlow> flows,
+                  std::span<uint16_t> ports) const;
+
+    /**
+     * @brief Count flows per port
+     * @param flows Flow records
+     * @return Flow count per port
+     */
+    std::vector<uint64_t> distribute(std::span<const LagFlow> flows) const;
+
+    /**
+     * @brief Measure imbalance of a distribution
+     * @param counts Count per port
+     * @return Busiest port over the mean, 1.0 when perfectly even
+     */
+    static double imbalance(std::span<const uint64_t> counts);
+
+    const LagHashConfig &getConfig() const { return config_; }
+    unsigned int getPortCount() const { return ports_; }
+
+  private:
+    LagHashConfig config_;
+    unsigned int ports_;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_LAGGHASH_HPP
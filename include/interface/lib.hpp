@@ -10,15 +10,43 @@
 #ifndef LIBFREEBSDNET_INTERFACE_LIB_HPP
 #define LIBFREEBSDNET_INTERFACE_LIB_HPP
 
+#include <interface/addresses.hpp>
+#include <interface/affinity.hpp>
+#include <interface/arena.hpp>
 #include <interface/base.hpp>
+#include <interface/bpf.hpp>
 #include <interface/bridge.hpp>
+#include <interface/capability.hpp>
+#include <interface/carpwatch.hpp>
+#include <interface/cloners.hpp>
+#include <interface/desired.hpp>
+#include <interface/epairpool.hpp>
 #include <interface/ethernet.hpp>
+#include <interface/groups.hpp>
+#include <interface/identity.hpp>
 #include <interface/lagg.hpp>
+#include <interface/lagghash.hpp>
+#include <interface/linkstate.hpp>
+#include <interface/list.hpp>
 #include <interface/manager.hpp>
+#include <interface/netmap.hpp>
+#include <interface/openmetrics.hpp>
 #include <interface/pflog.hpp>
 #include <interface/pfsync.hpp>
+#include <interface/queues.hpp>
+#include <interface/registry.hpp>
+#include <interface/sampler.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
 #include <interface/statistics.hpp>
+#include <interface/topology.hpp>
+#include <interface/traits.hpp>
+#include <interface/tunio.hpp>
 #include <interface/tunnel.hpp>
+#include <interface/tunnelbatch.hpp>
+#include <interface/view.hpp>
 #include <interface/vlan.hpp>
+#include <interface/vlanbatch.hpp>
+#include <interface/vnetmanager.hpp>
 
 #endif // LIBFREEBSDNET_INTERFACE_LIB_HPP
@@ -0,0 +1,160 @@
+/**
+ * @file interface/linkstate.hpp
+ * @brief Link-state transition tracker
+ * @details Timestamps link and operstate transitions from the netlink
+ * monitor into fixed-size rings and reports flaps, downtime percentiles and
+ * time-to-carrier after bringUp()
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_LINKSTATE_HPP
+#define LIBFREEBSDNET_INTERFACE_LINKSTATE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  class Interface;
+
+  /**
+   * @brief RFC 2863 operational state, as reported by netlink
+   */
+  enum class OperState : uint8_t {
+    UNKNOWN,
+    NOTPRESENT,
+    DOWN,
+    LOWERLAYERDOWN,
+    TESTING,
+    DORMANT,
+    UP
+  };
+
+  /**
+   * @brief One observed transition
+   */
+  struct LinkTransition {
+    std::chrono::steady_clock::time_point at;
+    unsigned int index = 0;
+    OperState from = OperState::UNKNOWN;
+    OperState to = OperState::UNKNOWN;
+    bool adminUp = false; // IFF_UP after the transition
+  };
+
+  /**
+   * @brief Tracker sizing
+   */
+  struct LinkStateTrackerOptions {
+    size_t historySize = 1024;      // transitions kept across all interfaces
+    size_t samplesPerInterface = 128; // downtimes and carrier delays kept
+  };
+
+  /**
+   * @brief Per-interface link-state summary
+   * @details Percentiles cover the retained samples; counters and the total
+   * cover everything observed since tracking began
+   */
+  struct LinkStateReport {
+    std::string name;
+    unsigned int index = 0;
+    OperState state = OperState::UNKNOWN;
+    uint64_t transitions = 0;
+    uint64_t flaps = 0; // UP -> not UP
+    std::chrono::nanoseconds totalDowntime{0}; // including an ongoing outage
+    std::chrono::nanoseconds downtimeP50{0};
+    std::chrono::nanoseconds downtimeP90{0};
+    std::chrono::nanoseconds downtimeP99{0};
+    std::chrono::nanoseconds downtimeMax{0};
+    size_t downtimeSamples = 0;
+    std::chrono::nanoseconds carrierP50{0}; // bringUp() to operstate UP
+    std::chrono::nanoseconds carrierMax{0};
+    size_t carrierSamples = 0;
+  };
+
+  /**
+   * @brief Link-state tracker class
+   * @details start() seeds the current state of every interface from one
+   * statistics dump, then follows netlink link events, which are delivered
+   * one at a time so each is stamped with steady_clock on arrival. An
+   * outage runs from leaving UP to returning to it. All memory is allocated
+   * when an interface is first seen; afterwards the rings overwrite their
+   * oldest entries. Thread-safe.
+   */
+  class LinkStateTracker {
+  public:
+    explicit LinkStateTracker(const LinkStateTrackerOptions &options = {});
+    ~LinkStateTracker();
+
+    /**
+     * @brief Seed interface states and follow link events
+     * @return true on success, false on error
+     */
+    bool start();
+
+    /**
+     * @brief Stop following link events
+     * @return true on success, false on error
+     */
+    bool stop();
+
+    /**
+     * @brief Bring an interface up and time its carrier
+     * @details The delay until the interface next reports operstate UP is
+     * recorded as a time-to-carrier sample
+     * @param interface Interface to bring up
+     * @return Result of interface.bringUp()
+     */
+    bool bringUp(Interface &interface);
+
+    /**
+     * @brief Start a time-to-carrier measurement without bringing up
+     * @details For interfaces brought up by other means
+     * @param index Interface index
+     */
+    void markBringUp(unsigned int index);
+
+    /**
+     * @brief Get the summary of one interface
+     * @param name Interface name
+     * @param report Output summary
+     * @return true if the interface is tracked
+     */
+    bool getReport(const std::string &name, LinkStateReport &report) const;
+
+    /**
+     * @brief Get the summaries of all tracked interfaces
+     * @return Reports sorted by interface index
+     */
+    std::vector<LinkStateReport> getReports() const;
+
+    /**
+     * @brief Get retained transitions
+     * @return Transitions oldest first
+     */
+    std::vector<LinkTransition> getHistory() const;
+
+    /**
+     * @brief Forget all samples and counters
+     * @details Current states are kept, so ongoing outages restart now
+     */
+    void reset();
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_LINKSTATE_HPP
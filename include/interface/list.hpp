@@ -0,0 +1,95 @@
+/**
+ * @file interface/list.hpp
+ * @brief Arena-backed interface enumeration result
+ * @details Owns a set of interface objects and the monotonic arena they and
+ * their private state were built in, releasing everything in one shot
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_LIST_HPP
+#define LIBFREEBSDNET_INTERFACE_LIST_HPP
+
+#include <cstddef>
+#include <interface/base.hpp>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+
+namespace libfreebsdnet::interface {
+
+  class Manager;
+
+  /**
+   * @brief Interface list class
+   * @details Interfaces stay owned by the list; pointers and references to
+   * them are valid until it is destroyed. Names are kept in a flat
+   * IFNAMSIZ table next to the objects for lookups.
+   */
+  class InterfaceList {
+  public:
+    InterfaceList();
+    ~InterfaceList();
+    InterfaceList(InterfaceList &&) noexcept;
+    InterfaceList &operator=(InterfaceList &&) noexcept;
+    InterfaceList(const InterfaceList &) = delete;
+    InterfaceList &operator=(const InterfaceList &) = delete;
+
+    /**
+     * @brief Get all interfaces
+     * @return Interfaces in kernel order
+     */
+    std::span<Interface *const> getInterfaces() const;
+
+    /**
+     * @brief Find interface by name
+     * @param name Interface name
+     * @return Interface or nullptr if not present
+     */
+    Interface *find(std::string_view name) const;
+
+    /**
+     * @brief Find interface by index
+     * @param index Interface index
+     * @return Interface or nullptr if not present
+     */
+    Interface *find(unsigned int index) const;
+
+    /**
+     * @brief Get number of interfaces
+     * @return Interface count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Check if the list is empty
+     * @return true if there are no interfaces
+     */
+    bool empty() const;
+
+    /**
+     * @brief Get arena usage
+     * @return Bytes reserved by the arena
+     */
+    size_t getArenaSize() const;
+
+    Interface *const *begin() const { return getInterfaces().data(); }
+    Interface *const *end() const { return begin() + size(); }
+
+  private:
+    friend class Manager;
+
+    // Size the arena for about expected interfaces
+    explicit InterfaceList(size_t expected);
+    std::pmr::memory_resource *getArena() const;
+    void append(std::unique_ptr<Interface> interface);
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_LIST_HPP
@@ -10,7 +10,13 @@
 #ifndef LIBFREEBSDNET_INTERFACE_MANAGER_HPP
 #define LIBFREEBSDNET_INTERFACE_MANAGER_HPP
 
+#include <chrono>
+#include <interface/addresses.hpp>
 #include <interface/base.hpp>
+#include <interface/list.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/traits.hpp>
+#include <interface/view.hpp>
 #include <memory>
 #include <net/if.h>
 #include <string>
@@ -20,7 +26,12 @@ namespace libfreebsdnet::interface {
 
   /**
    * @brief Network interface manager class
-   * @details Provides high-level interface for managing network interfaces
+   * @details Provides high-level interface for managing network interfaces.
+   * One manager may be shared by any number of threads: kernel requests go
+   * through the calling thread's ControlSocket and SysctlBuffer, and the
+   * shared snapshot is swapped under a lock while readers keep the one
+   * they hold. Interface objects returned are owned by the caller and are
+   * not themselves safe for concurrent use.
    */
   class Manager {
   public:
@@ -33,6 +44,105 @@ namespace libfreebsdnet::interface {
      */
     std::vector<std::unique_ptr<Interface>> getInterfaces() const;
 
+    /**
+     * @brief Get all interfaces backed by an existing snapshot
+     * @param snapshot Snapshot to build interface objects from
+     * @return Vector of interface objects whose getters read the snapshot
+     */
+    std::vector<std::unique_ptr<Interface>>
+    getInterfaces(const InterfaceSnapshot &snapshot) const;
+
+    /**
+     * @brief Get all interfaces in a single arena-backed list
+     * @details Interface objects and their private state are placed in an
+     * arena owned by the list and freed together with it
+     * @return Interface list, empty on error
+     */
+    InterfaceList getInterfaceList() const;
+
+    /**
+     * @brief Get all interfaces of a snapshot in an arena-backed list
+     * @param snapshot Snapshot to build interface objects from
+     * @return Interface list whose getters read the snapshot
+     */
+    InterfaceList getInterfaceList(const InterfaceSnapshot &snapshot) const;
+
+    /**
+     * @brief Take a snapshot of all interfaces with one sysctl dump
+     * @return Populated snapshot or nullptr on error
+     */
+    std::shared_ptr<InterfaceSnapshot> getSnapshot() const;
+
+    /**
+     * @brief Get the snapshot shared by all users of this manager
+     * @details Returns the cached snapshot while it is younger than maxAge.
+     * Otherwise one caller refreshes it; callers arriving meanwhile get the
+     * previous snapshot instead of waiting, unless there is none yet.
+     * @param maxAge Oldest snapshot to return
+     * @return Shared snapshot, nullptr if none could be taken
+     */
+    std::shared_ptr<const InterfaceSnapshot> getSharedSnapshot(
+        std::chrono::milliseconds maxAge = std::chrono::seconds(1)) const;
+
+    /**
+     * @brief Force the next getSharedSnapshot() call to refresh
+     */
+    void invalidateSharedSnapshot() const;
+
+    /**
+     * @brief Get flat views of all interfaces
+     * @return Views in kernel order, empty on error
+     */
+    std::vector<InterfaceView> getViews() const;
+
+    /**
+     * @brief Get flat views of all interfaces of a snapshot
+     * @param snapshot Snapshot to copy the views from
+     * @return Views in kernel order
+     */
+    std::vector<InterfaceView>
+    getViews(const InterfaceSnapshot &snapshot) const;
+
+    /**
+     * @brief Get the full interface object for a view
+     * @details Re-reads the interface; fails if its index now belongs to an
+     * interface with another name
+     * @param view Interface view
+     * @return Interface object or nullptr if the interface is gone
+     */
+    std::unique_ptr<Interface> upgrade(const InterfaceView &view) const;
+
+    /**
+     * @brief Get the full interface object for a view from a snapshot
+     * @param view Interface view
+     * @param snapshot Snapshot the view was taken from
+     * @return Interface object backed by the snapshot or nullptr if absent
+     */
+    std::unique_ptr<Interface> upgrade(const InterfaceView &view,
+                                       const InterfaceSnapshot &snapshot) const;
+
+    /**
+     * @brief Get the addresses of all interfaces with one sysctl dump
+     * @return Address table grouped by interface index, empty on error
+     */
+    AddressTable getAllAddresses() const;
+
+    /**
+     * @brief Get the addresses of all interfaces of a snapshot
+     * @param snapshot Snapshot to copy the addresses from
+     * @return Address table grouped by interface index
+     */
+    AddressTable getAllAddresses(const InterfaceSnapshot &snapshot) const;
+
+    /**
+     * @brief Get the media of every Ethernet port
+     * @details One SIOCGIFXMEDIA per port, spread over worker threads, so a
+     * host with many ports is read in a fraction of the serial time
+     * @param workers Worker threads, 0 picks from the hardware concurrency
+     * @return Snapshots in kernel order; ports whose query failed are omitted
+     */
+    std::vector<MediaSnapshot> getEthernetMedia(unsigned int workers = 0) const;
+
     /**
      * @brief Get interface by name
      * @param name Interface name (e.g., "eth0", "lo0")
@@ -47,6 +157,17 @@ namespace libfreebsdnet::interface {
      */
     std::unique_ptr<Interface> getInterface(unsigned int index) const;
 
+    /**
+     * @brief Get the interface an identity refers to
+     * @details Fails rather than returning whatever now holds the index
+     * when the interface was destroyed and the index reused; a renamed
+     * interface is returned under its new name
+     * @param identity Identity from Interface::getIdentity()
+     * @return Interface object or nullptr if that interface is gone
+     */
+    std::unique_ptr<Interface>
+    getInterface(const InterfaceIdentity &identity) const;
+
     /**
      * @brief Get interface addresses using getifaddrs
      * @return Vector of ifaddrs structures for all interfaces
@@ -63,19 +184,7 @@ namespace libfreebsdnet::interface {
     template <typename T>
     std::unique_ptr<T> getInterface(const std::string &name) const {
       auto interface = getInterface(name);
-      if (!interface) {
-        return nullptr;
-      }
-
-      // Try to cast to the specific type
-      T *specific = dynamic_cast<T *>(interface.get());
-      if (!specific) {
-        return nullptr;
-      }
-
-      // Release from the generic pointer and return the specific type
-      interface.release();
-      return std::unique_ptr<T>(static_cast<T *>(specific));
+      return interface_cast<T>(interface);
     }
 
     /**
@@ -88,19 +197,7 @@ namespace libfreebsdnet::interface {
     template <typename T>
     std::unique_ptr<T> getInterface(unsigned int index) const {
       auto interface = getInterface(index);
-      if (!interface) {
-        return nullptr;
-      }
-
-      // Try to cast to the specific type
-      T *specific = dynamic_cast<T *>(interface.get());
-      if (!specific) {
-        return nullptr;
-      }
-
-      // Release from the generic pointer and return the specific type
-      interface.release();
-      return std::unique_ptr<T>(static_cast<T *>(specific));
+      return interface_cast<T>(interface);
     }
 
     /**
@@ -182,7 +279,16 @@ namespace libfreebsdnet::interface {
      */
     InterfaceType getTypeFromFlags(int flags);
 
-    int socket_fd;
+    /**
+     * @brief Create snapshot-backed interface object from a record
+     * @param record Snapshot record
+     * @return Interface object with the record attached
+     */
+    std::unique_ptr<Interface>
+    createFromRecord(std::shared_ptr<const InterfaceRecord> record) const;
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
   };
 
 } // namespace libfreebsdnet::interface
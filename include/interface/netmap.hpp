@@ -0,0 +1,238 @@
+/**
+ * @file interface/netmap.hpp
+ * @brief Netmap port class
+ * @details Ring management for netmap, VALE and pipe ports with batched
+ * bursts, zero-copy forwarding and pinned ring workers
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_NETMAP_HPP
+#define LIBFREEBSDNET_INTERFACE_NETMAP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <interface/base.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Netmap port counters
+   */
+  struct NetmapStats {
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t txBytes = 0;
+    uint64_t forwarded = 0; // of which moved by buffer swap
+    std::chrono::nanoseconds elapsed{0}; // since the port was opened
+
+    /**
+     * @brief Get received packet rate
+     * @return Millions of packets per second since the port was opened
+     */
+    double getRxMpps() const {
+      return elapsed.count() > 0 ? rxPackets * 1e3 / elapsed.count() : 0.0;
+    }
+
+    /**
+     * @brief Get transmitted packet rate
+     * @return Millions of packets per second since the port was opened
+     */
+    double getTxMpps() const {
+      return elapsed.count() > 0 ? txPackets * 1e3 / elapsed.count() : 0.0;
+    }
+  };
+
+  /**
+   * @brief Receive burst callback
+   * @details Frames point into ring buffers and are released when the
+   * callback returns
+   */
+  using FrameHandler =
+      std::function<void(std::span<const std::span<uint8_t>> frames)>;
+
+  /**
+   * @brief Transmit fill callback
+   * @details Writes one frame in place into a slot buffer
+   * @return Frame length, or 0 to stop filling
+   */
+  using FrameFiller = std::function<size_t(std::span<uint8_t> buffer)>;
+
+  class NetmapPort;
+
+  /**
+   * @brief Ring worker body
+   * @details Called in a loop on a pinned thread with a port bound to one
+   * hardware ring pair; should wait with a bounded timeout so stopWorkers()
+   * returns promptly
+   * @return false to end this worker
+   */
+  using RingWorker = std::function<bool(NetmapPort &ring, unsigned int index)>;
+
+  /**
+   * @brief Netmap port class
+   * @details Registers a port with NIOCCTRL and maps its rings. Port names
+   * follow netmap(4): "netmap:ix0" for all hardware rings, "netmap:ix0-2"
+   * for one ring pair, "netmap:ix0^" for the host rings, "vale0:a" for a
+   * VALE switch port and "netmap:ix0{1" / "netmap:ix0}1" for pipes. Rings
+   * are not synchronised implicitly: wait() or sync() refreshes them.
+   */
+  class NetmapPort {
+  public:
+    /**
+     * @brief Constructor
+     * @param port Port name
+     */
+    explicit NetmapPort(const std::string &port);
+
+    /**
+     * @brief Constructor
+     * @param interface Interface to attach to
+     * @param ring Hardware ring pair, or -1 for all rings
+     */
+    explicit NetmapPort(const Interface &interface, int ring = -1);
+
+    ~NetmapPort();
+
+    NetmapPort(const NetmapPort &) = delete;
+    NetmapPort &operator=(const NetmapPort &) = delete;
+
+    /**
+     * @brief Register the port and map its rings
+     * @return true on success, false on error
+     */
+    bool open();
+
+    /**
+     * @brief Stop workers, unmap and close the port
+     */
+    void close();
+
+    /**
+     * @brief Check if the port is open
+     * @return true if registered
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get port name
+     * @return Name as given to the constructor
+     */
+    std::string getPort() const;
+
+    /**
+     * @brief Get file descriptor
+     * @return Descriptor for poll or kqueue, -1 if closed
+     */
+    int getFd() const;
+
+    /**
+     * @brief Get number of hardware ring pairs
+     * @return Ring pairs of the underlying port, regardless of binding
+     */
+    unsigned int getRingCount() const;
+
+    /**
+     * @brief Get slot buffer size
+     * @return Bytes per slot buffer
+     */
+    size_t getBufferSize() const;
+
+    /**
+     * @brief Wait for receive frames or transmit space
+     * @param timeout Maximum wait
+     * @param transmit Wait for transmit space instead of frames
+     * @return true if ready, false on timeout or error
+     */
+    bool wait(std::chrono::milliseconds timeout, bool transmit = false);
+
+    /**
+     * @brief Synchronise rings with the kernel without waiting
+     * @return true on success, false on error
+     */
+    bool sync();
+
+    /**
+     * @brief Receive a burst from the bound receive rings
+     * @param handler Called once per ring with its available frames
+     * @param limit Maximum frames to take
+     * @return Frames received
+     */
+    size_t receive(const FrameHandler &handler,
+                   size_t limit = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief Copy frames into the bound transmit rings
+     * @param frames Frame payloads; longer ones are truncated to the
+     * buffer size
+     * @return Frames queued; the rest found no free slot
+     */
+    size_t transmit(std::span<const std::span<const uint8_t>> frames);
+
+    /**
+     * @brief Build frames in place in the bound transmit rings
+     * @param filler Called per free slot
+     * @param limit Maximum frames to queue
+     * @return Frames queued
+     */
+    size_t fill(const FrameFiller &filler,
+                size_t limit = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief Move frames from one port's receive rings to another's
+     * transmit rings
+     * @details Swaps slot buffers when both ports share a memory region and
+     * copies otherwise
+     * @param from Receiving port
+     * @param to Transmitting port
+     * @param limit Maximum frames to move
+     * @return Frames moved
+     */
+    static size_t forward(NetmapPort &from, NetmapPort &to,
+                          size_t limit = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief Start one worker per hardware ring pair
+     * @details Each worker opens its own port bound to its ring and pins
+     * itself to a CPU. This port only registers to count the rings and is
+     * closed once the workers have their ports
+     * @param worker Worker body
+     * @param cpus CPU per ring; empty to follow the NIC's receive queue
+     * CPUs (QueueAffinity), or ring number modulo CPU count where unknown
+     * @return true if every ring port opened, false on error
+     */
+    bool startWorkers(RingWorker worker, std::span<const int> cpus = {});
+
+    /**
+     * @brief Stop and join ring workers
+     */
+    void stopWorkers();
+
+    /**
+     * @brief Get counters
+     * @return Counters of this port and its ring workers
+     */
+    NetmapStats getStats() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_NETMAP_HPP
@@ -0,0 +1,46 @@
+/**
+ * @file interface/openmetrics.hpp
+ * @brief OpenMetrics text exposition of sampler snapshots
+ * @details Serializes interface counters and rates into a caller-supplied
+ * buffer without allocating
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_OPENMETRICS_HPP
+#define LIBFREEBSDNET_INTERFACE_OPENMETRICS_HPP
+
+#include <cstddef>
+#include <interface/sampler.hpp>
+#include <span>
+#include <string_view>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief OpenMetrics serializer class
+   * @details Emits one metric family per counter or rate, each with an
+   * interface label, followed by the terminating "# EOF" line
+   */
+  class OpenMetricsSerializer {
+  public:
+    /**
+     * @brief Serialize a snapshot
+     * @details Like snprintf, the full length is returned even when the
+     * buffer is too small; the caller can grow the buffer and retry. Output
+     * is not NUL-terminated.
+     * @param snapshot Snapshot to serialize
+     * @param buffer Output buffer
+     * @param prefix Metric name prefix
+     * @return Bytes needed for the complete exposition; the buffer holds it
+     * only if this is not larger than the buffer
+     */
+    static size_t serialize(const SamplerSnapshot &snapshot,
+                            std::span<char> buffer,
+                            std::string_view prefix = "ifnet");
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_OPENMETRICS_HPP
@@ -10,16 +10,49 @@
 #ifndef LIBFREEBSDNET_INTERFACE_PFLOG_HPP
 #define LIBFREEBSDNET_INTERFACE_PFLOG_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
+#include "bpf.hpp"
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief Decoded pf log record
+   * @details Strings and packet point into the capture buffer
+   */
+  struct PflogRecord {
+    int family = 0;
+    uint8_t action = 0;    // PF_PASS, PF_DROP, ...
+    uint8_t reason = 0;    // PFRES_*
+    uint8_t direction = 0; // PF_IN or PF_OUT
+    std::string_view interface;
+    std::string_view ruleset;
+    uint32_t rule = 0; // UINT32_MAX when no rule matched
+    uint32_t subrule = 0;
+    uint32_t uid = 0;
+    int32_t pid = 0;
+    uint32_t ridentifier = 0;
+    std::span<const uint8_t> packet; // IPv4 or IPv6 header onwards
+  };
+
+  /**
+   * @brief Decode a pflog record in place
+   * @details Fields beyond the header length the kernel wrote are left
+   * zero
+   * @param data Captured bytes of a DLT_PFLOG record
+   * @param record Output record
+   * @return true on success, false if the header is truncated
+   */
+  bool decodePflog(std::span<const uint8_t> data, PflogRecord &record);
+
   /**
    * @brief PFLOG interface class
    * @details Provides PFLOG-specific interface operations
    */
-  class PflogInterface : public Interface {
+  class PflogInterface : public InterfaceBase<PflogInterface> {
   public:
     /**
      * @brief Constructor
@@ -34,21 +67,6 @@ namespace libfreebsdnet::interface {
      */
     ~PflogInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Get log interface
      * @return Log interface name or empty string on error
@@ -75,23 +93,17 @@ namespace libfreebsdnet::interface {
      */
     bool setLogRule(int ruleNumber);
 
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
+    /**
+     * @brief Attach a capture to this interface
+     * @details Records read from it can be passed to decodePflog()
+     * @param capture Capture to open
+     * @return true on success, false on error
+     */
+    bool openCapture(BpfCapture &capture);
+
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
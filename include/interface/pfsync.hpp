@@ -10,16 +10,28 @@
 #ifndef LIBFREEBSDNET_INTERFACE_PFSYNC_HPP
 #define LIBFREEBSDNET_INTERFACE_PFSYNC_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
+#include <optional>
 #include <string>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief pfsync settings to change
+   * @details Unset fields keep their current kernel value
+   */
+  struct PfsyncSettings {
+    std::optional<std::string> syncInterface; // empty to detach
+    std::optional<std::string> syncPeer;      // empty for the multicast group
+    std::optional<int> maxUpdates;            // 0 to 255 updates per state
+    std::optional<bool> defer; // hold packets until the peer acks the state
+  };
+
   /**
    * @brief PFSYNC interface class
    * @details Provides PFSYNC-specific interface operations
    */
-  class PfsyncInterface : public Interface {
+  class PfsyncInterface : public InterfaceBase<PfsyncInterface> {
   public:
     /**
      * @brief Constructor
@@ -34,21 +46,6 @@ namespace libfreebsdnet::interface {
      */
     ~PfsyncInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Get sync interface
      * @return Sync interface name or empty string on error
@@ -88,23 +85,31 @@ namespace libfreebsdnet::interface {
      */
     bool setMaxUpdates(int maxUpdates);
 
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
+    /**
+     * @brief Check if packet deferral is enabled
+     * @return true if the first packet of a state waits for the peer
+     */
+    bool getDefer() const;
+
+    /**
+     * @brief Enable or disable packet deferral
+     * @param defer true to defer
+     * @return true on success, false on error
+     */
+    bool setDefer(bool defer);
+
+    /**
+     * @brief Apply several settings with one SIOCSETPFSYNC
+     * @details Reads the current configuration first, so fields left unset
+     * are not reset
+     * @param settings Settings to change
+     * @return true on success, false on error
+     */
+    bool applySettings(const PfsyncSettings &settings);
+
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
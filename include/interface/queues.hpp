@@ -0,0 +1,121 @@
+/**
+ * @file interface/queues.hpp
+ * @brief Per-queue NIC traffic rates
+ * @details Normalizes driver queue counters to packets, bytes and drops per
+ * direction and derives per-queue rates and an RSS imbalance metric
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_QUEUES_HPP
+#define LIBFREEBSDNET_INTERFACE_QUEUES_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <interface/statistics.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Normalized counters of one hardware queue
+   * @details Drivers name their counters differently; packets and bytes
+   * come from the "packets"/"bytes" leaves or their rx_/tx_ forms, drops
+   * sum every leaf mentioning a drop or discard. A combined queue node
+   * ("queue0") fills both directions.
+   */
+  struct QueueCounters {
+    std::string name;
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t rxDrops = 0;
+    uint64_t txPackets = 0;
+    uint64_t txBytes = 0;
+    uint64_t txDrops = 0;
+
+    /**
+     * @brief Normalize raw driver counters
+     * @param queue Counters from StatisticsCollector::readQueues()
+     * @return Normalized counters
+     */
+    static QueueCounters fromStatistics(const QueueStatistics &queue);
+  };
+
+  /**
+   * @brief Rates of one hardware queue between two samples
+   */
+  struct QueueRates {
+    std::string name;
+    double rxPackets = 0; // per second
+    double rxBits = 0;
+    double rxDrops = 0;
+    double txPackets = 0;
+    double txBits = 0;
+    double txDrops = 0;
+    double rxShare = 0; // fraction of the port's received packets
+    double txShare = 0;
+  };
+
+  /**
+   * @brief Traffic distribution across the queues of a port
+   */
+  struct QueueLoad {
+    std::vector<QueueRates> queues;
+    // Busiest queue over the mean of the queues in that direction; 1.0 is
+    // perfectly even, the queue count means one queue takes everything
+    double rxImbalance = 0;
+    double txImbalance = 0;
+    std::chrono::duration<double> interval{0};
+  };
+
+  /**
+   * @brief Queue sampler class
+   * @details Each sample() re-reads the queue leaves resolved on the first
+   * call, one sysctl(2) per counter and no name lookups. Rates compare the
+   * last two samples.
+   */
+  class QueueSampler {
+  public:
+    /**
+     * @brief Constructor
+     * @param name Interface name (e.g., "ixl0")
+     */
+    explicit QueueSampler(const std::string &name);
+    ~QueueSampler();
+
+    /**
+     * @brief Take a sample
+     * @return true on success, false if the driver exposes no queues
+     */
+    bool sample();
+
+    /**
+     * @brief Get counters of the last sample
+     * @return Counters in driver order
+     */
+    std::span<const QueueCounters> getCounters() const;
+
+    /**
+     * @brief Get rates between the last two samples
+     * @return Per-queue rates, empty before the second sample
+     */
+    QueueLoad getLoad() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_QUEUES_HPP
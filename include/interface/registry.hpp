@@ -0,0 +1,106 @@
+/**
+ * @file interface/registry.hpp
+ * @brief Interface class registry
+ * @details Maps kernel driver names and IFT_* link types to factories for the
+ * concrete Interface classes
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_REGISTRY_HPP
+#define LIBFREEBSDNET_INTERFACE_REGISTRY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <interface/base.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Factory creating an interface object
+   * @details Arguments are the interface name, index and flags
+   */
+  using InterfaceFactory = std::function<std::unique_ptr<Interface>(
+      const std::string &, unsigned int, int)>;
+
+  /**
+   * @brief Interface registry class
+   * @details Process-wide and thread-safe. An interface is classified by its
+   * driver name first, i.e. its name without the unit ("lagg" for
+   * "lagg0", "epair" for "epair3a"), which tells apart the cloners that
+   * share a link type. Interfaces whose driver is not registered, including
+   * renamed ones, fall back to the ifi_type reported in their if_data, and
+   * then to EthernetInterface.
+   */
+  class InterfaceRegistry {
+  public:
+    /**
+     * @brief Register a factory for a driver name
+     * @details Replaces any factory already registered for the name
+     * @param driver Driver name without unit, e.g. "bridge"
+     * @param factory Factory to use
+     * @param kind Type reported by classify(), UNKNOWN to defer to the link
+     * type
+     */
+    static void registerDriver(const std::string &driver,
+                               InterfaceFactory factory,
+                               InterfaceType kind = InterfaceType::UNKNOWN);
+
+    /**
+     * @brief Register a factory for an IFT_* link type
+     * @details Replaces any factory already registered for the type
+     * @param type IFT_* value
+     * @param factory Factory to use
+     * @param kind Type reported by classify()
+     */
+    static void registerType(uint8_t type, InterfaceFactory factory,
+                             InterfaceType kind = InterfaceType::UNKNOWN);
+
+    /**
+     * @brief Make a factory for an interface class
+     * @tparam T Interface class constructible from name, index and flags
+     * @return Factory creating T
+     */
+    template <typename T> static InterfaceFactory factory() {
+      return [](const std::string &name, unsigned int index, int flags) {
+        return std::make_unique<T>(name, index, flags);
+      };
+    }
+
+    /**
+     * @brief Create the interface object for an interface
+     * @param name Interface name
+     * @param index Interface index
+     * @param flags Interface flags
+     * @param type IFT_* value from if_data, 0 if unknown
+     * @return Interface object
+     */
+    static std::unique_ptr<Interface> create(const std::string &name,
+                                             unsigned int index, int flags,
+                                             uint8_t type);
+
+    /**
+     * @brief Classify an interface without creating its object
+     * @details Same precedence as create(): driver name, then link type
+     * @param name Interface name
+     * @param type IFT_* value from if_data, 0 if unknown
+     * @return Interface type, UNKNOWN if neither is registered with a kind
+     */
+    static InterfaceType classify(std::string_view name, uint8_t type);
+
+    /**
+     * @brief Derive the driver name from an interface name
+     * @param name Interface name
+     * @return Name up to its last run of digits, e.g. "l2vlan" for
+     * "l2vlan0"; the whole name if it has no digits
+     */
+    static std::string_view getDriverName(std::string_view name);
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_REGISTRY_HPP
@@ -0,0 +1,218 @@
+/**
+ * @file interface/sampler.hpp
+ * @brief High-frequency interface counter sampler
+ * @details Polls the bulk statistics dump on a dedicated thread and derives
+ * per-interface packet and bit rates, smoothed averages and windowed
+ * extremes, published per interface and as whole-sample snapshots
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_SAMPLER_HPP
+#define LIBFREEBSDNET_INTERFACE_SAMPLER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <net/if.h>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Per-second rates in both directions
+   */
+  struct RateSet {
+    double packetsIn = 0;
+    double packetsOut = 0;
+    double bitsIn = 0;
+    double bitsOut = 0;
+  };
+
+  /**
+   * @brief Rates published for one interface
+   */
+  struct InterfaceRates {
+    unsigned int index = 0;
+    char name[IFNAMSIZ] = {};
+    RateSet current; // over the most recent interval
+    RateSet average; // exponentially weighted moving average
+    RateSet minimum; // per-field minimum over the sample window
+    RateSet maximum; // per-field maximum over the sample window
+    uint32_t samples = 0; // samples held in the window
+    std::chrono::steady_clock::time_point sampledAt;
+  };
+
+  static_assert(std::is_trivially_copyable_v<InterfaceRates>);
+
+  /**
+   * @brief Rates and raw totals of one interface at one sample
+   */
+  struct InterfaceSample {
+    InterfaceRates rates;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint64_t packetsIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t errorsIn = 0;
+    uint64_t errorsOut = 0;
+    uint64_t dropsIn = 0;
+    uint64_t dropsOut = 0;
+    uint64_t multicastIn = 0;
+    uint64_t multicastOut = 0;
+    uint64_t baudrate = 0;
+    uint8_t linkState = 0;
+  };
+
+  /**
+   * @brief Consistent view of one complete sample
+   * @details Holds one of the sampler's published buffers; the sampling
+   * thread does not reuse it until the view is destroyed. Views are cheap to
+   * take and should be released promptly; while every spare buffer is held
+   * the sampler keeps sampling but stops publishing. A view must not outlive
+   * its sampler.
+   */
+  class SamplerSnapshot {
+  public:
+    SamplerSnapshot() = default;
+    SamplerSnapshot(SamplerSnapshot &&other) noexcept;
+    SamplerSnapshot &operator=(SamplerSnapshot &&other) noexcept;
+    SamplerSnapshot(const SamplerSnapshot &) = delete;
+    SamplerSnapshot &operator=(const SamplerSnapshot &) = delete;
+    ~SamplerSnapshot();
+
+    /**
+     * @brief Get the sampled interfaces
+     * @return Samples ordered by interface index, empty before the first
+     * sample
+     */
+    std::span<const InterfaceSample> getInterfaces() const;
+
+    /**
+     * @brief Get sample generation
+     * @return Generation of this sample, 0 for an empty view
+     */
+    uint64_t getGeneration() const;
+
+    /**
+     * @brief Get sample time
+     * @return Time the sample was taken
+     */
+    std::chrono::steady_clock::time_point getTimestamp() const;
+
+    /**
+     * @brief Check if the view holds a sample
+     * @return true if a sample is held
+     */
+    bool isValid() const { return buffer_ != nullptr; }
+
+    struct Buffer;
+
+  private:
+    friend class StatisticsSampler;
+    explicit SamplerSnapshot(Buffer *buffer) : buffer_(buffer) {}
+    Buffer *buffer_ = nullptr;
+  };
+
+  /**
+   * @brief Sampler tuning options
+   */
+  struct SamplerOptions {
+    std::chrono::milliseconds interval{100}; // time between samples
+    size_t window = 64;    // samples kept per interface for min/max
+    double smoothing = 0.2; // EWMA weight of the newest rate, 0 < w <= 1
+    bool housekeeping = true; // keep the thread off NIC queue CPUs
+  };
+
+  /**
+   * @brief Statistics sampler class
+   * @details One sysctl per interval feeds a ring buffer per interface.
+   * Rates are computed on the sampling thread and published per interface,
+   * so readers copy a consistent result without taking a lock. A counter
+   * that goes backwards restarts that interface's window.
+   */
+  class StatisticsSampler {
+  public:
+    /**
+     * @brief Constructor
+     * @param options Sampler options
+     */
+    explicit StatisticsSampler(const SamplerOptions &options = {});
+
+    /**
+     * @brief Destructor
+     * @details Stops the sampling thread
+     */
+    ~StatisticsSampler();
+
+    /**
+     * @brief Start the sampling thread
+     * @return true on success, false if the first sample failed
+     */
+    bool start();
+
+    /**
+     * @brief Stop the sampling thread
+     */
+    void stop();
+
+    /**
+     * @brief Check if the sampling thread is running
+     * @return true if running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get rates for an interface
+     * @param index Interface index
+     * @param rates Output rates
+     * @return true if the interface has been sampled
+     */
+    bool getRates(unsigned int index, InterfaceRates &rates) const;
+
+    /**
+     * @brief Get rates for an interface
+     * @param name Interface name
+     * @param rates Output rates
+     * @return true if the interface has been sampled
+     */
+    bool getRates(const std::string &name, InterfaceRates &rates) const;
+
+    /**
+     * @brief Get rates for every sampled interface
+     * @return Rates ordered by interface index
+     */
+    std::vector<InterfaceRates> getAllRates() const;
+
+    /**
+     * @brief Get the latest complete sample
+     * @details Lock-free and allocation-free; any number of threads may hold
+     * views at once
+     * @return View of the most recently published sample
+     */
+    SamplerSnapshot getSnapshot() const;
+
+    /**
+     * @brief Get sample generation
+     * @return Number of samples taken since start
+     */
+    uint64_t getGeneration() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_SAMPLER_HPP
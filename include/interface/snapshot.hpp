@@ -0,0 +1,117 @@
+/**
+ * @file interface/snapshot.hpp
+ * @brief Single-pass interface snapshot
+ * @details Captures every interface, its link address, addresses and if_data
+ * counters from one NET_RT_IFLISTL sysctl dump and indexes them by name and
+ * by interface index
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_SNAPSHOT_HPP
+#define LIBFREEBSDNET_INTERFACE_SNAPSHOT_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <net/if.h>
+#include <string>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Immutable per-interface record captured by a snapshot
+   */
+  struct InterfaceRecord {
+    std::string name;
+    unsigned int index = 0;
+    int flags = 0;
+    uint8_t type = 0; // IFT_* value from if_data
+    std::string linkAddress; // "aa:bb:cc:dd:ee:ff" or empty
+    std::array<uint8_t, 8> linkBytes{}; // Raw link address, if it fits
+    uint8_t linkLength = 0;
+    std::vector<libfreebsdnet::types::Address> addresses;
+    struct if_data data{};
+
+    /**
+     * @brief Get MTU from the captured if_data
+     * @return Interface MTU
+     */
+    int getMtu() const { return static_cast<int>(data.ifi_mtu); }
+  };
+
+  /**
+   * @brief Interface snapshot class
+   * @details Built from a single routing sysctl dump; lookups by name or index
+   * never touch the kernel
+   */
+  class InterfaceSnapshot {
+  public:
+    InterfaceSnapshot();
+    ~InterfaceSnapshot();
+
+    /**
+     * @brief Re-read the interface list from the kernel
+     * @param index Restrict the dump to one interface (0 for all)
+     * @return true on success, false on error
+     */
+    bool refresh(unsigned int index = 0);
+
+    /**
+     * @brief Find interface record by name
+     * @param name Interface name
+     * @return Shared record or nullptr if not present
+     */
+    std::shared_ptr<const InterfaceRecord>
+    find(const std::string &name) const;
+
+    /**
+     * @brief Find interface record by index
+     * @param index Interface index
+     * @return Shared record or nullptr if not present
+     */
+    std::shared_ptr<const InterfaceRecord> find(unsigned int index) const;
+
+    /**
+     * @brief Get all interface records in kernel order
+     * @return Vector of shared records
+     */
+    const std::vector<std::shared_ptr<const InterfaceRecord>> &
+    getRecords() const;
+
+    /**
+     * @brief Get number of interfaces in the snapshot
+     * @return Interface count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Estimate the memory held by the snapshot
+     * @return Approximate size in bytes
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * @brief Get time at which the snapshot was taken
+     * @return Steady clock time point of the last refresh
+     */
+    std::chrono::steady_clock::time_point getTimestamp() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_SNAPSHOT_HPP
@@ -0,0 +1,59 @@
+/**
+ * @file interface/socket.hpp
+ * @brief Shared control sockets for interface ioctls
+ * @details Per-thread cache of the datagram sockets used to issue SIOC*
+ * ioctls so that interface getters and setters do not pay a socket()/close()
+ * pair per attribute
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_SOCKET_HPP
+#define LIBFREEBSDNET_INTERFACE_SOCKET_HPP
+
+#include <cstdint>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Control socket cache
+   * @details Each thread lazily opens one AF_INET, AF_INET6 and AF_LOCAL
+   * datagram socket and keeps it until the thread exits or release() is
+   * called. Callers must not close the returned descriptor.
+   */
+  class ControlSocket {
+  public:
+    /**
+     * @brief Get this thread's control socket for an address family
+     * @param family AF_INET, AF_INET6 or AF_LOCAL
+     * @return Socket descriptor or -1 on error (errno is preserved)
+     */
+    static int get(int family);
+
+    /**
+     * @brief Close all control sockets cached by the calling thread
+     */
+    static void release();
+
+    /**
+     * @brief Get number of sockets actually opened, across all threads
+     * @return socket() call count
+     */
+    static uint64_t getOpenCount();
+
+    /**
+     * @brief Get number of requests served, across all threads
+     * @return get() call count
+     */
+    static uint64_t getRequestCount();
+
+    /**
+     * @brief Reset the open and request counters
+     */
+    static void resetCounters();
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_SOCKET_HPP
@@ -11,14 +11,32 @@
 #define LIBFREEBSDNET_INTERFACE_STATISTICS_HPP
 
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief Driver counters for one hardware queue
+   * @details Counter names are the driver's sysctl leaf names below the
+   * queue node, e.g. "rx_packets" or "tx_bytes"
+   */
+  struct QueueStatistics {
+    std::string name; // queue node, e.g. "queue0", "rxq3" or "txq3"
+    std::vector<std::pair<std::string, uint64_t>> counters;
+  };
+
   /**
    * @brief Network interface statistics structure
-   * @details Contains packet and byte counters for network interfaces
+   * @details Contains packet and byte counters for network interfaces. The
+   * generic if_data counters carry no frame, overrun or carrier breakdown,
+   * so those fields stay 0.
    */
   struct InterfaceStatistics {
     uint64_t bytesReceived;
@@ -27,21 +45,96 @@ namespace libfreebsdnet::interface {
     uint64_t receiveDropped;
     uint64_t receiveFrameErrors;
     uint64_t receiveOverruns;
+    uint64_t multicastReceived;
+    uint64_t unknownProtocol; // received for a protocol not configured
 
     uint64_t bytesSent;
     uint64_t packetsSent;
     uint64_t sendErrors;
     uint64_t sendDropped;
     uint64_t sendOverruns;
+    uint64_t multicastSent;
 
     uint64_t collisions;
     uint64_t carrierErrors;
 
+    uint64_t baudrate;  // link speed in bits per second
+    uint8_t linkState;  // LINK_STATE_* value
+    std::chrono::system_clock::time_point lastChange; // last state change
+
+    std::vector<QueueStatistics> queues; // filled when queue collection is on
+
     std::chrono::system_clock::time_point lastUpdated;
 
     InterfaceStatistics();
   };
 
+  /**
+   * @brief pfsync protocol counters
+   * @details Read from net.pfsync.stats; the action arrays are indexed by
+   * PFSYNC_ACT_* message type
+   */
+  struct PfsyncStatistics {
+    uint64_t packetsIn = 0;
+    uint64_t packetsIn6 = 0;
+    uint64_t badInterface = 0;
+    uint64_t badTtl = 0;
+    uint64_t shortHeader = 0;
+    uint64_t badVersion = 0;
+    uint64_t badAction = 0;
+    uint64_t badLength = 0;
+    uint64_t badAuth = 0;
+    uint64_t stale = 0; // updates older than the local state
+    uint64_t badValue = 0;
+    uint64_t badState = 0;
+    uint64_t packetsOut = 0;
+    uint64_t packetsOut6 = 0;
+    uint64_t noMemory = 0;
+    uint64_t outputErrors = 0;
+    std::vector<uint64_t> actionsIn;
+    std::vector<uint64_t> actionsOut;
+    std::chrono::steady_clock::time_point sampledAt;
+
+    /**
+     * @brief Get input error total
+     * @return Sum of the bad* and short header counters
+     */
+    uint64_t getInputErrors() const {
+      return badInterface + badTtl + shortHeader + badVersion + badAction +
+             badLength + badAuth + badValue + badState;
+    }
+  };
+
+  /**
+   * @brief pfsync rates between two samples, per second
+   */
+  struct PfsyncRates {
+    double packetsIn = 0;  // IPv4 and IPv6
+    double packetsOut = 0; // IPv4 and IPv6
+    double errorsIn = 0;
+    double errorsOut = 0; // no memory and output errors
+    double stale = 0;
+    std::vector<double> actionsIn;
+    std::vector<double> actionsOut;
+  };
+
+  /**
+   * @brief Compute pfsync rates
+   * @param previous Earlier sample
+   * @param current Later sample
+   * @return Rates, zero if the samples are not in order
+   */
+  PfsyncRates getPfsyncRates(const PfsyncStatistics &previous,
+                             const PfsyncStatistics &current);
+
+  /**
+   * @brief Callback receiving one interface's statistics
+   * @details Arguments are the interface index, its name (valid only during
+   * the call) and its counters. Return false to stop the walk.
+   */
+  using StatisticsVisitor = std::function<bool(
+      unsigned int, std::string_view, const InterfaceStatistics &)>;
+
   /**
    * @brief Interface statistics collector
    * @details Provides methods to collect and manage interface statistics
@@ -61,11 +154,40 @@ namespace libfreebsdnet::interface {
 
     /**
      * @brief Get statistics for all interfaces
+     * @details Read from a single interface list dump
      * @return Map of interface names to their statistics
      */
     std::unordered_map<std::string, InterfaceStatistics>
     getAllStatistics() const;
 
+    /**
+     * @brief Get statistics for all interfaces keyed by index
+     * @details Read from a single interface list dump
+     * @return Map of interface indexes to their statistics
+     */
+    std::unordered_map<unsigned int, InterfaceStatistics>
+    getStatisticsByIndex() const;
+
+    /**
+     * @brief Visit the statistics of every interface
+     * @details Decodes a single interface list dump in place without
+     * building a container
+     * @param visitor Callback invoked once per interface
+     * @return true on success, false if the dump failed
+     */
+    bool forEachStatistics(const StatisticsVisitor &visitor) const;
+
+    /**
+     * @brief Read the per-queue driver counters of one interface
+     * @details Works whether or not queue collection is enabled, and reuses
+     * the resolved leaves and the strings already in queues
+     * @param index Interface index
+     * @param queues Output queues in driver order
+     * @return true on success, false if the interface has no driver node
+     */
+    bool readQueues(unsigned int index,
+                    std::vector<QueueStatistics> &queues) const;
+
     /**
      * @brief Reset statistics for an interface
      * @param interfaceName Name of the interface
@@ -73,6 +195,34 @@ namespace libfreebsdnet::interface {
      */
     bool resetStatistics(const std::string &interfaceName);
 
+    /**
+     * @brief Read pfsync protocol counters
+     * @param stats Output counters
+     * @return true on success, false if pfsync is not loaded
+     */
+    bool getPfsyncStatistics(PfsyncStatistics &stats) const;
+
+    /**
+     * @brief Zero pfsync protocol counters
+     * @return true on success, false on error
+     */
+    bool resetPfsyncStatistics();
+
+    /**
+     * @brief Enable or disable per-queue driver counters
+     * @details When enabled, every statistics read also walks the driver's
+     * dev.<driver>.<unit> queue sysctls. Leaf names are resolved once per
+     * interface and only the values are re-read.
+     * @param enabled true to collect queue counters
+     */
+    void setQueueStatistics(bool enabled);
+
+    /**
+     * @brief Check if per-queue driver counters are collected
+     * @return true if enabled
+     */
+    bool getQueueStatistics() const;
+
     /**
      * @brief Check if statistics collection is available
      * @return true if statistics can be collected, false otherwise
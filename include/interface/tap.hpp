@@ -18,7 +18,7 @@ namespace libfreebsdnet::interface {
    * @brief TAP tunnel interface class
    * @details Provides TAP-specific tunnel operations
    */
-  class TapInterface : public TunnelInterface {
+  class TapInterface : public InterfaceBase<TapInterface, TunnelInterface> {
   public:
     /**
      * @brief Constructor
@@ -33,12 +33,6 @@ namespace libfreebsdnet::interface {
      */
     ~TapInterface() override;
 
-    /**
-     * @brief Get interface type
-     * @return Interface type
-     */
-    InterfaceType getType() const override;
-
     /**
      * @brief Get TAP unit number
      * @return Unit number or -1 if not set
@@ -104,29 +98,6 @@ namespace libfreebsdnet::interface {
      */
     bool setTunnelFib(int fib);
 
-    // Base class method overrides
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
-    std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
-
-    // Group management methods (call base class)
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
-
   private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
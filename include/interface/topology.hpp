@@ -0,0 +1,149 @@
+/**
+ * @file interface/topology.hpp
+ * @brief Interface dependency graph
+ * @details Which vlans sit on which lagg on which ports, read in one pass
+ * and kept current from the netlink monitor, so downstream impact ("what
+ * breaks if ix3 goes down") is a graph walk instead of an ioctl per
+ * virtual interface
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_TOPOLOGY_HPP
+#define LIBFREEBSDNET_INTERFACE_TOPOLOGY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Why a child depends on its parent
+   */
+  enum class DependencyKind : uint8_t {
+    VLAN,   // vlan or QinQ vlan on its parent (SIOCGETVLAN)
+    LAGG,   // lagg on one of its ports (SIOCGLAGG)
+    BRIDGE, // bridge on one of its members (BRDGGIFS)
+    CARP,   // CARP VHID carried by the parent (SIOCGVH)
+    TUNNEL  // gif/gre on the interface owning its outer source address
+  };
+
+  /**
+   * @brief One dependency
+   * @details The parent is the lower layer: if it goes down, the child is
+   * affected. A CARP VHID is not an interface, so CARP edges have an empty
+   * child and carry the VHID instead.
+   */
+  struct TopologyEdge {
+    std::string parent;
+    std::string child; // empty for CARP
+    DependencyKind kind = DependencyKind::VLAN;
+    int vhid = 0; // CARP only
+  };
+
+  /**
+   * @brief Interface dependency graph class
+   * @details build() takes one snapshot dump and issues one ioctl per
+   * interface that can have dependencies: vlans, bridges and tunnels by
+   * type, and Ethernet and multicast-capable interfaces for lagg ports and
+   * CARP VHIDs. While started, a link event re-reads the interface it
+   * names, and the aggregates when an interface appears or changes flags,
+   * since a port joining a lagg or bridge is announced on the port; a
+   * departed interface is dropped with all its edges, and address events
+   * re-resolve tunnel underlays. Edges are keyed by index, so renames
+   * need no re-read. Thread-safe.
+   */
+  class TopologyGraph {
+  public:
+    TopologyGraph();
+    ~TopologyGraph();
+
+    /**
+     * @brief Rebuild the graph from the kernel
+     * @param workers Threads issuing the ioctls (0 to pick from the
+     * hardware concurrency)
+     * @return true on success, false on error
+     */
+    bool build(unsigned workers = 0);
+
+    /**
+     * @brief Re-read the dependencies of one interface
+     * @param name Interface name
+     * @return true on success, false if the interface does not exist
+     */
+    bool refresh(const std::string &name);
+
+    /**
+     * @brief Follow link and address events from the netlink monitor
+     * @details Calls build() first if the graph is empty
+     * @return true on success, false on error
+     */
+    bool start();
+
+    /**
+     * @brief Stop following events
+     * @return true on success, false on error
+     */
+    bool stop();
+
+    /**
+     * @brief Get every dependency
+     * @return Edges sorted by parent, then child
+     */
+    std::vector<TopologyEdge> getEdges() const;
+
+    /**
+     * @brief Get what an interface depends on directly
+     * @param name Interface name
+     * @return Edges whose child is the interface
+     */
+    std::vector<TopologyEdge> getParents(const std::string &name) const;
+
+    /**
+     * @brief Get what depends on an interface directly
+     * @param name Interface name
+     * @return Edges whose parent is the interface
+     */
+    std::vector<TopologyEdge> getChildren(const std::string &name) const;
+
+    /**
+     * @brief Get everything downstream of an interface
+     * @details Breadth-first, so nearer dependents come first; each edge
+     * appears once even where bridges or laggs share members
+     * @param name Interface name
+     * @return Edges reachable from the interface
+     */
+    std::vector<TopologyEdge> getImpact(const std::string &name) const;
+
+    /**
+     * @brief Get the interfaces downstream of an interface
+     * @param name Interface name
+     * @return Dependent interface names in breadth-first order
+     */
+    std::vector<std::string> getDependents(const std::string &name) const;
+
+    /**
+     * @brief Get number of changes applied
+     * @details Bumped by every build and every update that changed an
+     * edge, so callers can cache impact answers against it
+     * @return Change count
+     */
+    uint64_t getGeneration() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_TOPOLOGY_HPP
@@ -0,0 +1,257 @@
+/**
+ * @file interface/traits.hpp
+ * @brief Compile-time interface type traits
+ * @details Maps each interface class to its InterfaceType tag, provides a
+ * checked interface_cast that compares tags instead of using RTTI, and the
+ * InterfaceBase mixin that supplies the forwarding every class used to
+ * repeat
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_TRAITS_HPP
+#define LIBFREEBSDNET_INTERFACE_TRAITS_HPP
+
+#include <interface/base.hpp>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  class BridgeInterface;
+  class CarpInterface;
+  class EpairInterface;
+  class EthernetInterface;
+  class GifInterface;
+  class L2VlanInterface;
+  class LagInterface;
+  class LoopbackInterface;
+  class PflogInterface;
+  class PfsyncInterface;
+  class TapInterface;
+  class TunInterface;
+  class TunnelInterface;
+  class VlanInterface;
+  class VxlanInterface;
+  class WirelessInterface;
+
+  /**
+   * @brief Interface type traits
+   * @details Specialized for every interface class with:
+   * - type: the value getType() reports
+   * - kind: the class tag stored in the object, unique per class
+   * - matches(tag): whether an object tagged tag is a T
+   */
+  template <typename T> struct InterfaceTraits;
+
+  /**
+   * @brief Traits of a class with no subclasses
+   * @tparam Type Value reported by getType()
+   * @tparam Kind Class tag, when Type is shared with another class
+   */
+  template <InterfaceType Type, InterfaceType Kind = Type>
+  struct LeafInterfaceTraits {
+    static constexpr InterfaceType type = Type;
+    static constexpr InterfaceType kind = Kind;
+
+    static constexpr bool matches(InterfaceType tag) { return tag == Kind; }
+  };
+
+  template <> struct InterfaceTraits<Interface> {
+    static constexpr bool matches(InterfaceType) { return true; }
+  };
+
+  template <>
+  struct InterfaceTraits<BridgeInterface>
+      : LeafInterfaceTraits<InterfaceType::BRIDGE> {};
+
+  template <>
+  struct InterfaceTraits<CarpInterface>
+      : LeafInterfaceTraits<InterfaceType::CARP> {};
+
+  template <>
+  struct InterfaceTraits<EpairInterface>
+      : LeafInterfaceTraits<InterfaceType::EPAIR> {};
+
+  template <>
+  struct InterfaceTraits<EthernetInterface>
+      : LeafInterfaceTraits<InterfaceType::ETHERNET> {};
+
+  template <>
+  struct InterfaceTraits<GifInterface>
+      : LeafInterfaceTraits<InterfaceType::GIF> {};
+
+  template <>
+  struct InterfaceTraits<L2VlanInterface>
+      : LeafInterfaceTraits<InterfaceType::VLAN, InterfaceType::L2VLAN> {};
+
+  template <>
+  struct InterfaceTraits<LagInterface>
+      : LeafInterfaceTraits<InterfaceType::LAGG> {};
+
+  template <>
+  struct InterfaceTraits<LoopbackInterface>
+      : LeafInterfaceTraits<InterfaceType::LOOPBACK> {};
+
+  template <>
+  struct InterfaceTraits<PflogInterface>
+      : LeafInterfaceTraits<InterfaceType::PFLOG> {};
+
+  template <>
+  struct InterfaceTraits<PfsyncInterface>
+      : LeafInterfaceTraits<InterfaceType::PFSYNC> {};
+
+  template <>
+  struct InterfaceTraits<TapInterface>
+      : LeafInterfaceTraits<InterfaceType::TUNNEL, InterfaceType::TAP> {};
+
+  template <>
+  struct InterfaceTraits<TunInterface>
+      : LeafInterfaceTraits<InterfaceType::TUNNEL, InterfaceType::TUN> {};
+
+  template <>
+  struct InterfaceTraits<VlanInterface>
+      : LeafInterfaceTraits<InterfaceType::VLAN> {};
+
+  template <>
+  struct InterfaceTraits<VxlanInterface>
+      : LeafInterfaceTraits<InterfaceType::TUNNEL, InterfaceType::VXLAN> {};
+
+  template <>
+  struct InterfaceTraits<WirelessInterface>
+      : LeafInterfaceTraits<InterfaceType::WIRELESS> {};
+
+  template <> struct InterfaceTraits<TunnelInterface> {
+    static constexpr InterfaceType type = InterfaceType::TUNNEL;
+    static constexpr InterfaceType kind = InterfaceType::TUNNEL;
+
+    static constexpr bool matches(InterfaceType tag) {
+      return tag == InterfaceType::TUNNEL || tag == InterfaceType::GIF ||
+             tag == InterfaceType::TAP || tag == InterfaceType::TUN ||
+             tag == InterfaceType::VXLAN;
+    }
+  };
+
+  /**
+   * @brief Downcast by class tag
+   * @tparam T Interface class to cast to
+   * @param interface Interface object, may be nullptr
+   * @return interface as a T, nullptr if it is not one
+   */
+  template <typename T> T *interface_cast(Interface *interface) {
+    static_assert(std::is_base_of_v<Interface, T>,
+                  "interface_cast target must derive from Interface");
+    return interface && InterfaceTraits<T>::matches(interface->getKind())
+               ? static_cast<T *>(interface)
+               : nullptr;
+  }
+
+  /**
+   * @brief Downcast by class tag
+   * @tparam T Interface class to cast to
+   * @param interface Interface object, may be nullptr
+   * @return interface as a T, nullptr if it is not one
+   */
+  template <typename T> const T *interface_cast(const Interface *interface) {
+    static_assert(std::is_base_of_v<Interface, T>,
+                  "interface_cast target must derive from Interface");
+    return interface && InterfaceTraits<T>::matches(interface->getKind())
+               ? static_cast<const T *>(interface)
+               : nullptr;
+  }
+
+  /**
+   * @brief Transfer ownership to a more specific pointer
+   * @tparam T Interface class to cast to
+   * @param interface Owning pointer; left untouched if it is not a T
+   * @return Owning T pointer, nullptr if it is not one
+   */
+  template <typename T>
+  std::unique_ptr<T> interface_cast(std::unique_ptr<Interface> &interface) {
+    T *specific = interface_cast<T>(interface.get());
+    if (!specific) {
+      return nullptr;
+    }
+    interface.release();
+    return std::unique_ptr<T>(specific);
+  }
+
+  /**
+   * @brief Interface class mixin
+   * @details Sets the class tag at construction, reports getType() from
+   * the traits and forwards the pure virtual operations to Base, so a class
+   * only declares what it actually does differently.
+   * @tparam Derived Class being defined
+   * @tparam Base Interface or another interface class
+   */
+  template <typename Derived, typename Base = Interface>
+  class InterfaceBase : public Base {
+  public:
+    InterfaceType getType() const override {
+      return InterfaceTraits<Derived>::type;
+    }
+
+    int getMedia() const override { return Base::getMedia(); }
+    bool setMedia(int media) override { return Base::setMedia(media); }
+    int getMediaStatus() const override { return Base::getMediaStatus(); }
+    int getActiveMedia() const override { return Base::getActiveMedia(); }
+    std::vector<int> getSupportedMedia() const override {
+      return Base::getSupportedMedia();
+    }
+    uint32_t getCapabilities() const override {
+      return Base::getCapabilities();
+    }
+    bool setCapabilities(uint32_t capabilities) override {
+      return Base::setCapabilities(capabilities);
+    }
+    uint32_t getEnabledCapabilities() const override {
+      return Base::getEnabledCapabilities();
+    }
+    bool enableCapabilities(uint32_t capabilities) override {
+      return Base::enableCapabilities(capabilities);
+    }
+    bool disableCapabilities(uint32_t capabilities) override {
+      return Base::disableCapabilities(capabilities);
+    }
+    std::vector<std::string> getGroups() const override {
+      return Base::getGroups();
+    }
+    bool addToGroup(const std::string &groupName) override {
+      return Base::addToGroup(groupName);
+    }
+    bool removeFromGroup(const std::string &groupName) override {
+      return Base::removeFromGroup(groupName);
+    }
+    bool setPhysicalAddress(const std::string &address) override {
+      return Base::setPhysicalAddress(address);
+    }
+    bool deletePhysicalAddress() override {
+      return Base::deletePhysicalAddress();
+    }
+    bool createClone(const std::string &cloneName) override {
+      return Base::createClone(cloneName);
+    }
+    std::vector<std::string> getCloners() const override {
+      return Base::getCloners();
+    }
+    std::string getMacAddress() const override {
+      return Base::getMacAddress();
+    }
+    bool setMacAddress(const std::string &macAddress) override {
+      return Base::setMacAddress(macAddress);
+    }
+    bool destroy() override { return Base::destroy(); }
+
+  protected:
+    InterfaceBase(const std::string &name, unsigned int index, int flags)
+        : Base(name, index, flags) {
+      this->kind = InterfaceTraits<Derived>::kind;
+    }
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_TRAITS_HPP
@@ -0,0 +1,196 @@
+/**
+ * @file interface/tunio.hpp
+ * @brief TUN/TAP packet I/O engine
+ * @details Batched packet reads and writes on /dev/tunN and /dev/tapN with
+ * preallocated buffers and kqueue-driven worker threads
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_TUNIO_HPP
+#define LIBFREEBSDNET_INTERFACE_TUNIO_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Packet I/O engine options
+   */
+  struct TunIoOptions {
+    size_t batchSize = 32;     // packets drained per wakeup
+    size_t bufferSize = 2048;  // bytes per packet slot
+    bool addressFamily = true; // TUNSIFHEAD on tun devices
+    // NIC carrying the tunnelled traffic; workers are pinned to its receive
+    // queue CPUs. Empty leaves them to the scheduler.
+    std::string affinity;
+  };
+
+  /**
+   * @brief Packet in a receive batch
+   * @details Points into the queue's buffer pool; valid until the handler
+   * returns
+   */
+  struct Packet {
+    std::span<uint8_t> data;
+    int family = 0; // AF_INET or AF_INET6 with TUNSIFHEAD, 0 otherwise
+  };
+
+  /**
+   * @brief Per-queue counters
+   */
+  struct TunIoStats {
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t txBytes = 0;
+    uint64_t rxErrors = 0;
+    uint64_t txErrors = 0;  // includes writes refused with ENOBUFS
+    uint64_t batches = 0;
+    std::chrono::nanoseconds batchTime{0};    // read and handler time
+    std::chrono::nanoseconds maxBatchTime{0};
+    std::chrono::nanoseconds elapsed{0};      // since the queue was opened
+
+    /**
+     * @brief Get received packet rate
+     * @return Packets per second since the queue was opened
+     */
+    double getRxPacketsPerSecond() const {
+      return elapsed.count() > 0 ? rxPackets * 1e9 / elapsed.count() : 0.0;
+    }
+
+    /**
+     * @brief Get transmitted packet rate
+     * @return Packets per second since the queue was opened
+     */
+    double getTxPacketsPerSecond() const {
+      return elapsed.count() > 0 ? txPackets * 1e9 / elapsed.count() : 0.0;
+    }
+
+    /**
+     * @brief Get mean batch latency
+     * @return Average time per batch
+     */
+    std::chrono::nanoseconds getMeanBatchTime() const {
+      return batches > 0 ? batchTime / static_cast<int64_t>(batches)
+                         : std::chrono::nanoseconds{0};
+    }
+  };
+
+  /**
+   * @brief Receive callback
+   * @details Runs on a worker thread with one queue's batch; send() may be
+   * called from inside it
+   */
+  using PacketHandler =
+      std::function<void(size_t queue, std::span<const Packet> packets)>;
+
+  /**
+   * @brief TUN/TAP packet I/O class
+   * @details A tun or tap device transfers one packet per read or write
+   * and has a single queue, so each opened device is one queue. Reads use
+   * readv to split the TUNSIFHEAD family word from the payload, straight
+   * into a per-queue pool of batchSize slots. Workers each own a kqueue
+   * and a share of the queues, draining up to batchSize packets per
+   * wakeup before calling the handler.
+   */
+  class TunIo {
+  public:
+    explicit TunIo(const TunIoOptions &options = {});
+    ~TunIo();
+
+    /**
+     * @brief Open a device as a new queue
+     * @details Must be called before start()
+     * @param device "tun0", "tap3" or a /dev path
+     * @return true on success, false on error
+     */
+    bool open(const std::string &device);
+
+    /**
+     * @brief Get number of queues
+     * @return Opened device count
+     */
+    size_t getQueueCount() const;
+
+    /**
+     * @brief Get device name of a queue
+     * @param queue Queue number
+     * @return Device name, empty if out of range
+     */
+    std::string getDevice(size_t queue) const;
+
+    /**
+     * @brief Start worker threads
+     * @param handler Receive callback
+     * @param workers Worker count, 0 for one per queue up to the core count
+     * @return true on success, false on error
+     */
+    bool start(PacketHandler handler, unsigned int workers = 0);
+
+    /**
+     * @brief Stop worker threads
+     */
+    void stop();
+
+    /**
+     * @brief Check if workers are running
+     * @return true if started
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Read one batch without workers
+     * @param queue Queue number
+     * @param handler Called with the batch if any packet was read
+     * @param timeout Time to wait for the first packet
+     * @return Packets read, or 0 on timeout or error
+     */
+    size_t receive(size_t queue, const PacketHandler &handler,
+                   std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Write packets
+     * @details Safe to call from any thread
+     * @param queue Queue number
+     * @param packets Packet payloads
+     * @param family Address family for the TUNSIFHEAD word
+     * @return Packets written
+     */
+    size_t send(size_t queue, std::span<const std::span<const uint8_t>> packets,
+                int family);
+
+    /**
+     * @brief Get counters of a queue
+     * @param queue Queue number
+     * @return Counters, zero if out of range
+     */
+    TunIoStats getStats(size_t queue) const;
+
+    /**
+     * @brief Get counters summed over all queues
+     * @return Aggregate counters; maxBatchTime is the largest of any queue
+     */
+    TunIoStats getStats() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_TUNIO_HPP
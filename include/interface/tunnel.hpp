@@ -10,7 +10,7 @@
 #ifndef LIBFREEBSDNET_INTERFACE_TUNNEL_HPP
 #define LIBFREEBSDNET_INTERFACE_TUNNEL_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
 #include <string>
 #include <vector>
 
@@ -35,7 +35,7 @@ namespace libfreebsdnet::interface {
    * @brief Tunnel interface class
    * @details Provides tunnel-specific interface operations
    */
-  class TunnelInterface : public Interface {
+  class TunnelInterface : public InterfaceBase<TunnelInterface> {
   public:
     /**
      * @brief Constructor
@@ -98,24 +98,6 @@ namespace libfreebsdnet::interface {
     int getTunnelFib() const;
     bool setTunnelFib(int fib);
 
-    // Base class method overrides
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
-    std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
-
     bool destroy() override;
   };
 
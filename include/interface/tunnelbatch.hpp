@@ -0,0 +1,111 @@
+/**
+ * @file interface/tunnelbatch.hpp
+ * @brief Batched tunnel provisioning
+ * @details Creates and configures many gif, gre and vxlan tunnels in one
+ * parallel pass, with rollback on failure
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_TUNNELBATCH_HPP
+#define LIBFREEBSDNET_INTERFACE_TUNNELBATCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <interface/tunnel.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief One tunnel to create
+   */
+  struct TunnelSpec {
+    TunnelType type = TunnelType::GIF; // GIF, GRE or VXLAN
+    std::string name; // e.g. "gre12"; empty picks a unit of the type
+    libfreebsdnet::types::Address local;  // outer source
+    libfreebsdnet::types::Address remote; // outer destination or group
+    uint32_t key = 0; // VNI for VXLAN, GRE key (0 for none), unused for GIF
+    int fib = -1;     // FIB of the outer packets, -1 keeps the default
+    int mtu = 0;      // 0 keeps the default MTU
+    bool up = true;
+  };
+
+  /**
+   * @brief Outcome of one tunnel
+   */
+  struct TunnelResult {
+    std::string name; // name the kernel assigned, empty if not created
+    int error = 0;    // errno value, ECANCELED if rolled back
+
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief Wall time of each batch step
+   */
+  struct TunnelBatchTimings {
+    std::chrono::nanoseconds create{0}; // creation and configuration
+    std::chrono::nanoseconds rollback{0};
+    std::chrono::nanoseconds destroy{0};
+  };
+
+  /**
+   * @brief Batched tunnel provisioning class
+   * @details Each tunnel is created and configured start to finish by one
+   * worker, on that worker's cached control socket, so tunnels proceed in
+   * parallel without per-call socket setup. VXLAN tunnels pass VNI and
+   * endpoints in the SIOCIFCREATE2 parameters and need no further ioctls;
+   * gif and gre set endpoints with SIOCSIFPHYADDR(_IN6) and gre its key
+   * with GRESKEY.
+   */
+  class TunnelBatch {
+  public:
+    TunnelBatch();
+    ~TunnelBatch();
+
+    /**
+     * @brief Create and configure tunnels
+     * @param tunnels Tunnels to create
+     * @param rollback Destroy every created tunnel if any one fails
+     * @param workers Worker threads, 0 to pick from the core count
+     * @return One result per spec, in order
+     */
+    std::vector<TunnelResult> create(std::span<const TunnelSpec> tunnels,
+                                     bool rollback = true,
+                                     unsigned int workers = 0);
+
+    /**
+     * @brief Destroy tunnels
+     * @param names Interface names
+     * @param workers Worker threads, 0 to pick from the core count
+     * @return One result per name, in order
+     */
+    std::vector<TunnelResult> destroy(std::span<const std::string> names,
+                                      unsigned int workers = 0);
+
+    /**
+     * @brief Get timings of the last call
+     * @return Wall time per step
+     */
+    const TunnelBatchTimings &getTimings() const;
+
+    /**
+     * @brief Get last error message
+     * @return First failure of the last call, empty if none
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_TUNNELBATCH_HPP
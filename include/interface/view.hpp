@@ -0,0 +1,69 @@
+/**
+ * @file interface/view.hpp
+ * @brief Flat interface view
+ * @details Trivially copyable summary of an interface for callers that only
+ * need its name, index, flags, MTU and link address
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_VIEW_HPP
+#define LIBFREEBSDNET_INTERFACE_VIEW_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <interface/base.hpp>
+#include <net/if.h>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief Interface view structure
+   * @details Plain data copied out of a snapshot record, so arrays of views
+   * can be sorted and scanned without touching the heap or the kernel. Use
+   * Manager::upgrade() to get the full Interface object when type-specific
+   * operations are needed.
+   */
+  struct InterfaceView {
+    unsigned int index;
+    int flags;
+    int mtu;
+    InterfaceType type;
+    uint8_t linkType;      // IFT_* value from if_data
+    uint8_t linkLength;    // Link address length, 0 if none
+    uint8_t linkAddress[8];
+    char name[IFNAMSIZ];   // NUL-terminated
+
+    /**
+     * @brief Get interface name
+     * @return View of the name buffer
+     */
+    std::string_view getName() const {
+      return {name, ::strnlen(name, sizeof(name))};
+    }
+
+    /**
+     * @brief Get link address
+     * @return Raw link address bytes, empty if none
+     */
+    std::span<const uint8_t> getLinkAddress() const {
+      return {linkAddress, linkLength};
+    }
+
+    /**
+     * @brief Check for an interface flag
+     * @param flag IFF_* value
+     * @return true if the flag is set
+     */
+    bool hasFlag(int flag) const { return (flags & flag) != 0; }
+  };
+
+  static_assert(std::is_trivially_copyable_v<InterfaceView>);
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_VIEW_HPP
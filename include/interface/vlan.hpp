@@ -10,7 +10,7 @@
 #ifndef LIBFREEBSDNET_INTERFACE_VLAN_HPP
 #define LIBFREEBSDNET_INTERFACE_VLAN_HPP
 
-#include "base.hpp"
+#include "traits.hpp"
 #include "vnet.hpp"
 #include <string>
 
@@ -20,7 +20,8 @@ namespace libfreebsdnet::interface {
    * @brief VLAN interface class
    * @details Provides VLAN-specific interface operations
    */
-  class VlanInterface : public Interface, public VnetInterface {
+  class VlanInterface : public InterfaceBase<VlanInterface>,
+                        public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -35,21 +36,6 @@ namespace libfreebsdnet::interface {
      */
     ~VlanInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     /**
      * @brief Get VLAN ID
      * @return VLAN ID or -1 on error
@@ -82,19 +68,6 @@ namespace libfreebsdnet::interface {
      */
     bool isValid() const;
 
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
@@ -102,7 +75,6 @@ namespace libfreebsdnet::interface {
     bool setPhysicalAddress(const std::string &address) override;
     bool deletePhysicalAddress() override;
     bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
     std::string getMacAddress() const override;
     bool setMacAddress(const std::string &macAddress) override;
 
@@ -0,0 +1,111 @@
+/**
+ * @file interface/vlanbatch.hpp
+ * @brief Batched VLAN creation
+ * @details Creates and configures many vlan(4) interfaces in phased sweeps
+ * over the shared control socket, rolling back on failure
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_VLANBATCH_HPP
+#define LIBFREEBSDNET_INTERFACE_VLANBATCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief VLAN to create
+   */
+  struct VlanSpec {
+    std::string name;   // e.g. "vlan100" or "ix0.100"; "vlan" picks a unit
+    std::string parent; // trunk interface
+    uint16_t tag = 0;   // 1-4094
+    uint16_t proto = 0; // ETHERTYPE_VLAN or ETHERTYPE_QINQ, 0 for default
+    int mtu = 0;        // 0 keeps the parent-derived MTU
+    int fib = -1;       // -1 keeps the default FIB
+    bool up = true;
+  };
+
+  /**
+   * @brief Per-VLAN outcome of a batch
+   */
+  struct VlanResult {
+    std::string name; // name the kernel assigned, empty if not created
+    int error = 0;    // errno value, ECANCELED if rolled back
+
+    /**
+     * @brief Check if the VLAN was created and configured
+     * @return true if every requested step succeeded
+     */
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief Wall time spent in each batch phase
+   */
+  struct VlanBatchTimings {
+    std::chrono::nanoseconds create{0};
+    std::chrono::nanoseconds mtu{0};
+    std::chrono::nanoseconds fib{0};
+    std::chrono::nanoseconds up{0};
+    std::chrono::nanoseconds rollback{0};
+    std::chrono::nanoseconds destroy{0};
+  };
+
+  /**
+   * @brief VLAN batch class
+   * @details Each VLAN is cloned with its parent and tag passed to
+   * SIOCIFCREATE2, so no separate SIOCSETVLAN is needed. MTU, FIB and
+   * interface flags are then applied one phase at a time across the whole
+   * batch. Specs that fail validation are reported without being sent.
+   */
+  class VlanBatch {
+  public:
+    VlanBatch();
+    ~VlanBatch();
+
+    /**
+     * @brief Create VLANs
+     * @details With rollback set, any failure destroys every VLAN the call
+     * created and marks the others ECANCELED
+     * @param vlans VLANs to create
+     * @param rollback Undo the whole batch on the first failure
+     * @return One result per VLAN, in input order
+     */
+    std::vector<VlanResult> create(std::span<const VlanSpec> vlans,
+                                   bool rollback = true);
+
+    /**
+     * @brief Destroy VLANs
+     * @param names Interfaces to destroy
+     * @return One result per name, in input order
+     */
+    std::vector<VlanResult> destroy(std::span<const std::string> names);
+
+    /**
+     * @brief Get timings of the last create() or destroy()
+     * @return Per-phase timings
+     */
+    const VlanBatchTimings &getTimings() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_VLANBATCH_HPP
@@ -0,0 +1,142 @@
+/**
+ * @file interface/vnetmanager.hpp
+ * @brief VNET jail manager
+ * @details Cached jail ID to name lookups and batched moves of interfaces
+ * into and out of VNET jails
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_INTERFACE_VNETMANAGER_HPP
+#define LIBFREEBSDNET_INTERFACE_VNETMANAGER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  /**
+   * @brief One running jail
+   */
+  struct JailEntry {
+    int jid = 0;
+    std::string name;
+  };
+
+  /**
+   * @brief Outcome of moving one interface
+   */
+  struct VnetMoveResult {
+    std::string name; // interface name
+    int error = 0;    // errno value
+
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief VNET jail manager class
+   * @details The jail table is process-wide and thread-safe. It is built
+   * from one jail_get(2) iteration and rebuilt lazily on the first lookup
+   * after invalidate(), after a lookup misses (at most once a second), or
+   * once it is older than a few seconds, since the kernel does not announce
+   * jail creation or removal. A move that fails because the jail is gone
+   * invalidates it too.
+   */
+  class VnetManager {
+  public:
+    VnetManager();
+    ~VnetManager();
+
+    /**
+     * @brief Get jail name by ID
+     * @param jid Jail ID
+     * @return Jail name or empty string if not found
+     */
+    static std::string getJailName(int jid);
+
+    /**
+     * @brief Get jail ID by name
+     * @param name Jail name, or a numeric jail ID
+     * @return Jail ID or -1 if not found
+     */
+    static int getJailId(const std::string &name);
+
+    /**
+     * @brief Get all running jails
+     * @return Jails ordered by ID
+     */
+    static std::vector<JailEntry> getJails();
+
+    /**
+     * @brief Rebuild the jail table from the kernel now
+     * @return true on success, false on error
+     */
+    static bool refresh();
+
+    /**
+     * @brief Mark the jail table stale so the next lookup rebuilds it
+     */
+    static void invalidate();
+
+    /**
+     * @brief Get number of times the jail table has been rebuilt
+     * @return Rebuild count
+     */
+    static uint64_t getRefreshCount();
+
+    /**
+     * @brief Move interfaces into a jail's VNET
+     * @param jid Jail ID
+     * @param interfaces Host interface names
+     * @return One result per interface, in order
+     */
+    std::vector<VnetMoveResult>
+    moveToJail(int jid, std::span<const std::string> interfaces);
+
+    /**
+     * @brief Move interfaces into a jail's VNET
+     * @param jail Jail name or numeric ID
+     * @param interfaces Host interface names
+     * @return One result per interface, ESRCH for all if the jail is unknown
+     */
+    std::vector<VnetMoveResult>
+    moveToJail(const std::string &jail,
+               std::span<const std::string> interfaces);
+
+    /**
+     * @brief Reclaim interfaces from a jail's VNET
+     * @param jid Jail ID
+     * @param interfaces Interface names as seen inside the jail
+     * @return One result per interface, in order
+     */
+    std::vector<VnetMoveResult>
+    reclaimFromJail(int jid, std::span<const std::string> interfaces);
+
+    /**
+     * @brief Reclaim interfaces from a jail's VNET
+     * @param jail Jail name or numeric ID
+     * @param interfaces Interface names as seen inside the jail
+     * @return One result per interface, ESRCH for all if the jail is unknown
+     */
+    std::vector<VnetMoveResult>
+    reclaimFromJail(const std::string &jail,
+                    std::span<const std::string> interfaces);
+
+    /**
+     * @brief Get last error message
+     * @return First failure of the last call, empty if none
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::interface
+
+#endif // LIBFREEBSDNET_INTERFACE_VNETMANAGER_HPP
@@ -12,14 +12,31 @@
 
 #include "tunnel.hpp"
 #include "vnet.hpp"
+#include <cstdint>
+#include <ethernet/address.hpp>
+#include <span>
+#include <types/address.hpp>
+#include <vector>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief VXLAN forwarding table entry
+   */
+  struct VxlanFtEntry {
+    libfreebsdnet::ethernet::MacAddress mac;
+    libfreebsdnet::types::Address remote; // VTEP, same family as the tunnel
+    uint16_t port = 0;    // 0 uses the interface's destination port
+    bool dynamic = false; // learned rather than added (dump only)
+    int64_t expire = 0;   // expiry time of a learned entry (dump only)
+  };
+
   /**
    * @brief VXLAN tunnel interface class
    * @details Provides VXLAN-specific tunnel operations
    */
-  class VxlanInterface : public TunnelInterface, public VnetInterface {
+  class VxlanInterface : public InterfaceBase<VxlanInterface, TunnelInterface>,
+                         public VnetInterface {
   public:
     /**
      * @brief Constructor
@@ -34,12 +51,6 @@ namespace libfreebsdnet::interface {
      */
     ~VxlanInterface() override;
 
-    /**
-     * @brief Get interface type
-     * @return Interface type
-     */
-    InterfaceType getType() const override;
-
     /**
      * @brief Get VXLAN VNI (Virtual Network Identifier)
      * @return VNI or -1 if not set
@@ -105,23 +116,42 @@ namespace libfreebsdnet::interface {
      */
     bool setLearning(bool enabled);
 
-    // Base class method overrides
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
-    std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
+    /**
+     * @brief Add static forwarding table entries
+     * @details Issues one VXLAN_CMD_FTABLE_ENTRY_ADD per entry on a single
+     * control socket with the request reused between entries
+     * @param entries Entries to add
+     * @param errors Optional per-entry errno, 0 on success
+     * @return Number of entries added
+     */
+    size_t addForwardingEntries(std::span<const VxlanFtEntry> entries,
+                                std::vector<int> *errors = nullptr);
+
+    /**
+     * @brief Remove forwarding table entries
+     * @param macs Addresses to remove
+     * @param errors Optional per-address errno, 0 on success
+     * @return Number of entries removed
+     */
+    size_t removeForwardingEntries(
+        std::span<const libfreebsdnet::ethernet::MacAddress> macs,
+        std::vector<int> *errors = nullptr);
+
+    /**
+     * @brief Flush the forwarding table
+     * @param all Also remove static entries, not only learned ones
+     * @return true on success, false on error
+     */
+    bool flushForwardingTable(bool all = false);
+
+    /**
+     * @brief Read the forwarding table
+     * @details Parses the net.link.vxlan.<unit>.ftable.dump sysctl, since
+     * the driver has no ioctl to list entries
+     * @param entries Output entries
+     * @return true on success, false on error
+     */
+    bool getForwardingTable(std::vector<VxlanFtEntry> &entries) const;
 
     // VNET interface methods
     int getVnet() const override;
@@ -129,11 +159,6 @@ namespace libfreebsdnet::interface {
     bool setVnet(int vnetId) override;
     bool reclaimFromVnet() override;
 
-    // Group management methods (call base class)
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
-
   private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
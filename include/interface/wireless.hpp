@@ -10,78 +10,76 @@
 #ifndef LIBFREEBSDNET_INTERFACE_WIRELESS_HPP
 #define LIBFREEBSDNET_INTERFACE_WIRELESS_HPP
 
+#include <array>
 #include <cstdint>
-#include <interface/base.hpp>
+#include <interface/traits.hpp>
 #include <interface/vnet.hpp>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace libfreebsdnet::interface {
 
+  /**
+   * @brief One BSS from the last scan
+   * @details Fixed-size so a scan decodes without allocating per entry
+   */
+  struct WirelessScanEntry {
+    std::array<uint8_t, 6> bssid{};
+    std::array<char, 32> ssid{};
+    uint8_t ssidLength = 0;
+    uint16_t frequency = 0;      // MHz
+    int8_t rssi = 0;             // 0.5 dB units above the noise floor
+    int8_t noise = 0;            // dBm
+    uint16_t beaconInterval = 0; // TU
+    uint16_t capabilities = 0;   // capability information field
+    uint8_t maxRate = 0;         // highest basic or supported rate, 500 kb/s
+
+    std::string_view getSsid() const { return {ssid.data(), ssidLength}; }
+    int getSignal() const { return rssi / 2 + noise; } // dBm
+  };
+
+  /**
+   * @brief One associated station, or the BSS in station mode
+   * @details The traffic counters are filled only when requested
+   */
+  struct WirelessStation {
+    std::array<uint8_t, 6> mac{};
+    uint16_t frequency = 0; // MHz
+    uint16_t associationId = 0;
+    int8_t rssi = 0;        // 0.5 dB units above the noise floor
+    int8_t noise = 0;       // dBm
+    uint16_t txRate = 0;    // 500 kb/s units
+    uint32_t inactive = 0;  // seconds since last seen
+    uint32_t state = 0;     // IEEE80211_NODE_* flags
+    uint64_t rxPackets = 0;
+    uint64_t txPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txBytes = 0;
+    uint32_t rxDropped = 0;
+
+    int getSignal() const { return rssi / 2 + noise; } // dBm
+  };
+
   /**
    * @brief IEEE 802.11 wireless interface class
    * @details Provides management for IEEE 802.11 wireless network interfaces
    */
-  class WirelessInterface : public Interface, public VnetInterface {
+  class WirelessInterface : public InterfaceBase<WirelessInterface>,
+                            public VnetInterface {
   public:
     WirelessInterface(const std::string &name, unsigned int index, int flags);
     ~WirelessInterface() override;
 
-    // Base class method overrides
-    std::string getName() const override;
-    unsigned int getIndex() const override;
-    InterfaceType getType() const override;
-    std::vector<Flag> getFlags() const override;
-    bool setFlags(int flags) override;
-    bool bringUp() override;
-    bool bringDown() override;
-    bool isUp() const override;
-    int getMtu() const override;
-    bool setMtu(int mtu) override;
-    std::string getLastError() const override;
-    int getFib() const override;
-    bool setFib(int fib) override;
-
     bool isValid() const;
 
-    // Media support
-    int getMedia() const override;
-    bool setMedia(int media) override;
-    int getMediaStatus() const override;
-    int getActiveMedia() const override;
-    std::vector<int> getSupportedMedia() const override;
-
-    // Capability support
-    uint32_t getCapabilities() const override;
-    bool setCapabilities(uint32_t capabilities) override;
-    uint32_t getEnabledCapabilities() const override;
-    bool enableCapabilities(uint32_t capabilities) override;
-    bool disableCapabilities(uint32_t capabilities) override;
-
-    // Group support
-    std::vector<std::string> getGroups() const override;
-    bool addToGroup(const std::string &groupName) override;
-    bool removeFromGroup(const std::string &groupName) override;
-
     // VNET support
     int getVnet() const override;
     std::string getVnetJailName() const override;
     bool setVnet(int vnetId) override;
     bool reclaimFromVnet() override;
 
-    // Physical address support
-    bool setPhysicalAddress(const std::string &address) override;
-    bool deletePhysicalAddress() override;
-
-    // Interface cloning support
-    bool createClone(const std::string &cloneName) override;
-    std::vector<std::string> getCloners() const override;
-
-    // MAC address support
-    std::string getMacAddress() const override;
-    bool setMacAddress(const std::string &macAddress) override;
-
     bool destroy() override;
 
     // IEEE 802.11-specific methods
@@ -160,6 +158,28 @@ namespace libfreebsdnet::interface {
      */
     std::vector<std::string> getAvailableNetworks() const;
 
+    /**
+     * @brief Get results of the last scan
+     * @details Decodes IEEE80211_IOC_SCAN_RESULTS from a buffer kept by the
+     * interface object; entries reuses its capacity across calls
+     * @param entries Output entries, replaced
+     * @return true on success, false on error
+     */
+    bool getScanResults(std::vector<WirelessScanEntry> &entries) const;
+
+    /**
+     * @brief Get associated stations
+     * @details One IEEE80211_IOC_STA_INFO call for all stations, plus one
+     * IEEE80211_IOC_STA_STATS call per station when stats is set. Like
+     * getScanResults() no allocation happens once the buffers have grown
+     * to fit the station count.
+     * @param stations Output stations, replaced
+     * @param stats Also fetch per-station traffic counters
+     * @return true on success, false on error
+     */
+    bool getStations(std::vector<WirelessStation> &stations,
+                     bool stats = false) const;
+
   private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -0,0 +1,183 @@
+/**
+ * @file metrics/metrics.hpp
+ * @brief Library call instrumentation
+ * @details Per-operation syscall counts and latency histograms, recorded
+ * into per-thread slots without locks. The instrumentation macros expand to
+ * nothing unless the library is built with ENABLE_METRICS.
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_METRICS_METRICS_HPP
+#define LIBFREEBSDNET_METRICS_METRICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::metrics {
+
+  /**
+   * @brief Kind of kernel call being counted
+   */
+  enum class Syscall : uint8_t { IOCTL, SYSCTL, SOCKET, GETIFADDRS };
+
+  constexpr size_t SYSCALL_KINDS = 4;
+
+  // Operations beyond this many distinct names share the unattributed slot
+  constexpr size_t MAX_OPERATIONS = 256;
+
+  // Log-linear buckets: 8 per power of two, about 12.5% resolution, for
+  // latencies up to 2^40 ns (18 minutes)
+  constexpr unsigned int SUB_BUCKET_BITS = 3;
+  constexpr unsigned int MAX_EXPONENT = 39;
+  constexpr size_t BUCKET_COUNT =
+      (MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+  /**
+   * @brief Get histogram bucket of a latency
+   * @param nanoseconds Latency
+   * @return Bucket index, saturating at the last bucket
+   */
+  constexpr size_t bucketIndex(uint64_t nanoseconds) {
+    constexpr uint64_t subBuckets = 1u << SUB_BUCKET_BITS;
+    if (nanoseconds < subBuckets) {
+      return static_cast<size_t>(nanoseconds);
+    }
+    unsigned int exponent = 63 - static_cast<unsigned int>(
+                                     __builtin_clzll(nanoseconds));
+    if (exponent > MAX_EXPONENT) {
+      return BUCKET_COUNT - 1;
+    }
+    uint64_t sub = (nanoseconds >> (exponent - SUB_BUCKET_BITS)) &
+                   (subBuckets - 1);
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) +
+           static_cast<size_t>(sub);
+  }
+
+  /**
+   * @brief Get smallest latency falling into a bucket
+   * @param index Bucket index
+   * @return Lower bound in nanoseconds
+   */
+  constexpr uint64_t bucketLowerBound(size_t index) {
+    constexpr uint64_t subBuckets = 1u << SUB_BUCKET_BITS;
+    if (index < subBuckets) {
+      return index;
+    }
+    unsigned int exponent =
+        static_cast<unsigned int>(index >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS -
+        1;
+    uint64_t sub = index & (subBuckets - 1);
+    return (subBuckets + sub) << (exponent - SUB_BUCKET_BITS);
+  }
+
+  /**
+   * @brief Aggregated metrics of one operation over all threads
+   */
+  struct OperationMetrics {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t totalNanoseconds = 0;
+    uint64_t maxNanoseconds = 0;
+    std::array<uint64_t, SYSCALL_KINDS> syscalls{};
+    std::vector<uint64_t> buckets; // BUCKET_COUNT latency counts
+
+    uint64_t getSyscalls(Syscall kind) const {
+      return syscalls[static_cast<size_t>(kind)];
+    }
+
+    double getMeanNanoseconds() const {
+      return calls ? static_cast<double>(totalNanoseconds) / calls : 0.0;
+    }
+
+    /**
+     * @brief Get a latency percentile
+     * @param percentile 0 to 100
+     * @return Upper bound of the bucket holding the percentile, capped at
+     * the largest latency seen
+     */
+    uint64_t getPercentileNanoseconds(double percentile) const;
+  };
+
+  /**
+   * @brief Check if the library was built with instrumentation
+   * @return true if the macros record anything
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Register an operation name
+   * @details Called once per call site through the macros; repeated names
+   * share one ID
+   * @param name Operation name, e.g. "Manager::getInterfaces"
+   * @return Operation ID, 0 (unattributed) once the table is full
+   */
+  uint16_t registerOperation(const char *name);
+
+  /**
+   * @brief Count one kernel call against the innermost running operation
+   * @param kind Kind of call
+   */
+  void countSyscall(Syscall kind);
+
+  /**
+   * @brief Collect metrics of every operation that has run
+   * @return Operations with at least one call or syscall, by ID
+   */
+  std::vector<OperationMetrics> snapshot();
+
+  /**
+   * @brief Zero all metrics
+   * @details Increments racing with the reset on other threads may survive
+   * it; quiesce callers first for exact figures
+   */
+  void reset();
+
+  /**
+   * @brief Timed operation scope
+   * @details Makes its operation the innermost one on this thread, so
+   * syscalls counted until destruction are attributed to it, and records
+   * its latency on destruction
+   */
+  class Scope {
+  public:
+    explicit Scope(uint16_t operation);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    uint16_t operation;
+    uint16_t previous;
+    std::chrono::steady_clock::time_point start;
+  };
+
+} // namespace libfreebsdnet::metrics
+
+#ifdef LIBFREEBSDNET_METRICS
+#define LIBFREEBSDNET_METRICS_CONCAT_(a, b) a##b
+#define LIBFREEBSDNET_METRICS_CONCAT(a, b) LIBFREEBSDNET_METRICS_CONCAT_(a, b)
+/// Time the enclosing block as the named operation
+#define LIBFREEBSDNET_METRICS_OPERATION(name)                                 \
+  static const uint16_t LIBFREEBSDNET_METRICS_CONCAT(metricsOperation,        \
+                                                     __LINE__) =              \
+      ::libfreebsdnet::metrics::registerOperation(name);                      \
+  ::libfreebsdnet::metrics::Scope LIBFREEBSDNET_METRICS_CONCAT(metricsScope,  \
+                                                               __LINE__)(     \
+      LIBFREEBSDNET_METRICS_CONCAT(metricsOperation, __LINE__))
+/// Count one kernel call, e.g. LIBFREEBSDNET_METRICS_SYSCALL(IOCTL)
+#define LIBFREEBSDNET_METRICS_SYSCALL(kind)                                   \
+  ::libfreebsdnet::metrics::countSyscall(                                     \
+      ::libfreebsdnet::metrics::Syscall::kind)
+#else
+#define LIBFREEBSDNET_METRICS_OPERATION(name) static_cast<void>(0)
+#define LIBFREEBSDNET_METRICS_SYSCALL(kind) static_cast<void>(0)
+#endif
+
+#endif // LIBFREEBSDNET_METRICS_METRICS_HPP
@@ -0,0 +1,124 @@
+/**
+ * @file metrics/probes.hpp
+ * @brief DTrace USDT probes
+ * @details Probe macros for the libfreebsdnet provider declared in
+ * src/metrics/probes.d, and an ioctl wrapper that fires them. Without
+ * ENABLE_DTRACE the macros compile to nothing; with it a disabled probe
+ * costs one is-enabled check and no timing.
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_METRICS_PROBES_HPP
+#define LIBFREEBSDNET_METRICS_PROBES_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <metrics/metrics.hpp>
+#include <sys/ioctl.h>
+
+#ifdef LIBFREEBSDNET_DTRACE
+#include <libfreebsdnet_probes.h> // generated by dtrace -h
+/// Check whether a probe, e.g. IOCTL_RETURN, has a consumer
+#define LIBFREEBSDNET_PROBE_ENABLED(probe) (LIBFREEBSDNET_##probe##_ENABLED())
+/// Fire a probe, e.g. LIBFREEBSDNET_PROBE(IOCTL_ENTRY, name, request)
+#define LIBFREEBSDNET_PROBE(probe, ...) LIBFREEBSDNET_##probe(__VA_ARGS__)
+#else
+#define LIBFREEBSDNET_PROBE_ENABLED(probe) false
+#define LIBFREEBSDNET_PROBE(probe, ...)                                       \
+  ::libfreebsdnet::metrics::discardProbe(__VA_ARGS__)
+#endif
+
+namespace libfreebsdnet::metrics {
+
+  /**
+   * @brief Stand-in for a probe when built without DTrace
+   * @details Keeps probe arguments used so call sites need no #ifdef; the
+   * guarding is-enabled check is constant false and removes the call
+   */
+  template <typename... Args> constexpr void discardProbe(const Args &...) {}
+
+  /**
+   * @brief Nanoseconds elapsed since a time point
+   * @param start Start of the measured call
+   * @return Elapsed nanoseconds
+   */
+  inline uint64_t
+  elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  }
+
+  /**
+   * @brief Get the interface named by an ioctl argument
+   * @details Interface requests (ifreq, ifmediareq, ifaliasreq, ...) lead
+   * with the interface name; anything else has none
+   * @param arg ioctl argument
+   * @return Interface name or empty string
+   */
+  template <typename T> const char *interfaceName(const T *arg) {
+    if constexpr (requires { arg->ifr_name; }) {
+      return arg->ifr_name;
+    } else if constexpr (requires { arg->ifm_name; }) {
+      return arg->ifm_name;
+    } else if constexpr (requires { arg->ifra_name; }) {
+      return arg->ifra_name;
+    } else if constexpr (requires { arg->ifgr_name; }) {
+      return arg->ifgr_name;
+    } else if constexpr (requires { arg->ifd_name; }) {
+      return arg->ifd_name;
+    } else if constexpr (requires { arg->i_name; }) {
+      return arg->i_name; // ieee80211req
+    } else if constexpr (requires { arg->ifname; }) {
+      return arg->ifname; // in6_ndireq
+    } else if constexpr (requires { arg->ra_ifname; }) {
+      return arg->ra_ifname; // lagg_reqall
+    } else if constexpr (requires { arg->rp_ifname; }) {
+      return arg->rp_ifname; // lagg_reqport
+    } else {
+      return "";
+    }
+  }
+
+  /**
+   * @brief ioctl(2) with metrics and ioctl-entry/ioctl-return probes
+   * @param fd Descriptor
+   * @param request Request code
+   * @param arg Request argument
+   * @return ioctl(2) result; errno is preserved
+   */
+  template <typename T>
+  int tracedIoctl(int fd, unsigned long request, T *arg) {
+    LIBFREEBSDNET_METRICS_SYSCALL(IOCTL);
+    if (!LIBFREEBSDNET_PROBE_ENABLED(IOCTL_ENTRY) &&
+        !LIBFREEBSDNET_PROBE_ENABLED(IOCTL_RETURN)) {
+      return ::ioctl(fd, request, arg);
+    }
+    char *name = const_cast<char *>(interfaceName(arg));
+    LIBFREEBSDNET_PROBE(IOCTL_ENTRY, name, request);
+    auto start = std::chrono::steady_clock::now();
+    int result = ::ioctl(fd, request, arg);
+    int error = result < 0 ? errno : 0;
+    LIBFREEBSDNET_PROBE(IOCTL_RETURN, name, request, error,
+                        elapsedNanoseconds(start));
+    if (result < 0) {
+      errno = error;
+    }
+    return result;
+  }
+
+  /**
+   * @brief ioctl(2) without an argument, with metrics and probes
+   */
+  inline int tracedIoctl(int fd, unsigned long request, std::nullptr_t) {
+    return tracedIoctl(fd, request, static_cast<void *>(nullptr));
+  }
+
+} // namespace libfreebsdnet::metrics
+
+#endif // LIBFREEBSDNET_METRICS_PROBES_HPP
@@ -1,7 +1,9 @@
 /**
  * @file netlink/manager.hpp
  * @brief Netlink manager header
- * @details Header for netlink interface management functionality
+ * @details Header for netlink interface management functionality, with
+ * blocking calls and a kqueue-driven asynchronous variant of the link
+ * requests and the monitor
  *
  * @author paigeadelethompson
  * @year 2024
@@ -10,12 +12,16 @@
 #ifndef LIBFREEBSDNET_NETLINK_MANAGER_HPP
 #define LIBFREEBSDNET_NETLINK_MANAGER_HPP
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+struct kevent;
+
 namespace libfreebsdnet::netlink {
 
   /**
@@ -53,6 +59,105 @@ namespace libfreebsdnet::netlink {
    */
   using NetlinkCallback = std::function<void(const NetlinkInterfaceInfo &)>;
 
+  /**
+   * @brief Binary network address carried by monitor events
+   */
+  struct NetlinkAddress {
+    uint8_t family = 0; // AF_INET, AF_INET6 or 0 when absent
+    std::array<uint8_t, 16> bytes{};
+
+    /**
+     * @brief Format address for display
+     * @return Presentation string or empty string when absent
+     */
+    std::string toString() const;
+  };
+
+  /**
+   * @brief Link change event (RTM_NEWLINK / RTM_DELLINK)
+   */
+  struct NetlinkLinkEvent {
+    NetlinkMessageType type;
+    NetlinkInterfaceInfo info;
+  };
+
+  /**
+   * @brief Address change event (RTM_NEWADDR / RTM_DELADDR)
+   */
+  struct NetlinkAddressEvent {
+    NetlinkMessageType type;
+    int index;
+    uint8_t prefixLength;
+    NetlinkAddress address;
+  };
+
+  /**
+   * @brief Route change event (RTM_NEWROUTE / RTM_DELROUTE)
+   */
+  struct NetlinkRouteEvent {
+    NetlinkMessageType type;
+    uint32_t table;
+    int index; // outgoing interface index
+    uint8_t prefixLength;
+    NetlinkAddress destination;
+    NetlinkAddress gateway;
+  };
+
+  /**
+   * @brief Batch of coalesced monitor events
+   * @details The vectors are reused between deliveries; copy anything needed
+   * after the callback returns
+   */
+  struct NetlinkEventBatch {
+    std::vector<NetlinkLinkEvent> links;
+    std::vector<NetlinkAddressEvent> addresses;
+    std::vector<NetlinkRouteEvent> routes;
+
+    size_t size() const {
+      return links.size() + addresses.size() + routes.size();
+    }
+    bool empty() const { return size() == 0; }
+    void clear() {
+      links.clear();
+      addresses.clear();
+      routes.clear();
+    }
+  };
+
+  /**
+   * @brief Batched monitor callback function type
+   */
+  using NetlinkBatchCallback = std::function<void(const NetlinkEventBatch &)>;
+
+  /**
+   * @brief Completion of an asynchronous link request
+   * @details error is an errno value, 0 on success; links holds the dump
+   * or the single requested link
+   */
+  using NetlinkLinksCallback = std::function<void(
+      int error, const std::vector<NetlinkInterfaceInfo> &links)>;
+
+  /**
+   * @brief Multicast groups a monitor can subscribe to
+   */
+  enum NetlinkGroup : uint32_t {
+    GROUP_LINK = 1u << 0,
+    GROUP_IPV4_ADDRESS = 1u << 1,
+    GROUP_IPV6_ADDRESS = 1u << 2,
+    GROUP_IPV4_ROUTE = 1u << 3,
+    GROUP_IPV6_ROUTE = 1u << 4,
+    GROUP_ALL = 0x1f
+  };
+
+  /**
+   * @brief Monitor tuning options
+   */
+  struct NetlinkMonitorOptions {
+    uint32_t groups = GROUP_ALL;
+    size_t maxBatchSize = 512;                 // flush after this many events
+    std::chrono::microseconds maxLatency{2000}; // or after this long
+  };
+
   /**
    * @brief Netlink manager class
    * @details Provides netlink interface management functionality
@@ -61,6 +166,8 @@ namespace libfreebsdnet::netlink {
   public:
     /**
      * @brief Constructor
+     * @details Does not touch the kernel; the netlink module is loaded and
+     * the request socket opened by the first call that needs them
      */
     NetlinkManager();
 
@@ -118,12 +225,78 @@ namespace libfreebsdnet::netlink {
      */
     bool startMonitoring(const NetlinkCallback &callback);
 
+    /**
+     * @brief Start monitoring link, address and route changes
+     * @details A background thread subscribes to the selected groups and
+     * delivers coalesced batches once maxBatchSize events are pending or
+     * maxLatency has elapsed since the first pending event
+     * @param callback Batch callback, invoked on the monitor thread
+     * @param options Group selection and batching limits
+     * @return true on success, false on error
+     */
+    bool startMonitoring(const NetlinkBatchCallback &callback,
+                         const NetlinkMonitorOptions &options = {});
+
+    /**
+     * @brief Start monitoring from a caller's kqueue
+     * @details Same batching as the threaded monitor, but no thread is
+     * started: the monitor socket and a one-shot latency timer are added to
+     * kq and batches are delivered from handleEvent
+     * @param kq Caller's kqueue
+     * @param callback Batch callback, invoked from handleEvent
+     * @param options Group selection and batching limits
+     * @return true on success, false on error
+     */
+    bool startMonitoring(int kq, const NetlinkBatchCallback &callback,
+                         const NetlinkMonitorOptions &options = {});
+
     /**
      * @brief Stop monitoring interface changes
      * @return true on success, false on error
      */
     bool stopMonitoring();
 
+    /**
+     * @brief Register asynchronous requests with a kqueue
+     * @details Opens a second, non-blocking request socket whose read
+     * filter is added to kq with this manager as udata
+     * @param kq Caller's kqueue
+     * @return true on success, false on error
+     */
+    bool attach(int kq);
+
+    /**
+     * @brief Dump all interfaces asynchronously
+     * @param callback Called from handleEvent once the dump is complete
+     * @return true if the request was sent, false on error
+     */
+    bool requestInterfaces(NetlinkLinksCallback callback);
+
+    /**
+     * @brief Look up one interface asynchronously
+     * @param name Interface name
+     * @param callback Called from handleEvent with the link or an error
+     * @return true if the request was sent, false on error
+     */
+    bool requestInterface(const std::string &name,
+                          NetlinkLinksCallback callback);
+
+    /**
+     * @brief Process a kqueue event
+     * @details Completes answered requests and feeds the kqueue-driven
+     * monitor. Callbacks may issue further requests. Asynchronous calls are
+     * not thread-safe; make them from the thread running the kqueue.
+     * @param event Event returned by kevent(2)
+     * @return true if the event belonged to this manager
+     */
+    bool handleEvent(const struct kevent &event);
+
+    /**
+     * @brief Get number of asynchronous requests awaiting their answer
+     * @return Outstanding requests
+     */
+    size_t getPendingRequests() const;
+
     /**
      * @brief Get last error message
      * @return Last error message
@@ -0,0 +1,227 @@
+/**
+ * @file routing/batch.hpp
+ * @brief Batched route installation and removal
+ * @details Pipelines many RTM_NEWROUTE/RTM_DELROUTE requests over one
+ * netlink socket and reports a result for every route, either for a whole
+ * batch at once or per route through a caller's kqueue
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_BATCH_HPP
+#define LIBFREEBSDNET_ROUTING_BATCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <types/address.hpp>
+#include <vector>
+
+struct kevent;
+
+namespace libfreebsdnet::routing {
+
+  struct NeighborSpec;
+
+  /**
+   * @brief Route to install or remove
+   */
+  struct RouteSpec {
+    types::Address destination; // network in CIDR notation, IPv4 or IPv6
+    std::string gateway;        // next hop, empty for interface routes
+    std::string interface;      // outgoing interface, optional
+    uint32_t flags = 0;         // RouteFlag bits; BLACKHOLE and REJECT used
+    int fib = 0;
+  };
+
+  /**
+   * @brief Per-route outcome of a batch
+   */
+  struct RouteResult {
+    int error = 0; // errno value, 0 on success
+
+    /**
+     * @brief Check if the route was applied
+     * @return true if the kernel accepted the request
+     */
+    bool succeeded() const { return error == 0; }
+  };
+
+  /**
+   * @brief Completion of one asynchronous route request
+   */
+  using RouteCompletion = std::function<void(const RouteResult &)>;
+
+  /**
+   * @brief Batch tuning options
+   */
+  struct RouteBatchOptions {
+    size_t window = 256; // requests written before waiting for their acks
+    std::chrono::milliseconds timeout{5000}; // per-window ack timeout
+  };
+
+  /**
+   * @brief Route batch class
+   * @details Requests are written a window at a time in a single send and
+   * matched to their acknowledgements by sequence number. Routes that fail
+   * validation are reported without being sent.
+   */
+  class RouteBatch {
+  public:
+    RouteBatch();
+    ~RouteBatch();
+
+    /**
+     * @brief Install routes
+     * @param routes Routes to add
+     * @param options Batch options
+     * @return One result per route, in input order
+     */
+    std::vector<RouteResult> add(std::span<const RouteSpec> routes,
+                                 const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Remove routes
+     * @details The gateway is only used to pick a path of a multipath route
+     * @param routes Routes to delete
+     * @param options Batch options
+     * @return One result per route, in input order
+     */
+    std::vector<RouteResult> remove(std::span<const RouteSpec> routes,
+                                    const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Replace existing routes in place
+     * @details Sent as RTM_NEWROUTE with NLM_F_REPLACE, so the kernel swaps
+     * the nexthop atomically and the prefix never goes unrouted
+     * @param routes Routes to change
+     * @param options Batch options
+     * @return One result per route, in input order
+     */
+    std::vector<RouteResult> change(std::span<const RouteSpec> routes,
+                                    const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Install static neighbor entries
+     * @details Sent as RTM_NEWNEIGH with NUD_PERMANENT, replacing any
+     * existing entry for the address
+     * @param neighbors Entries to add
+     * @param options Batch options
+     * @return One result per entry, in input order
+     */
+    std::vector<RouteResult>
+    addNeighbors(std::span<const NeighborSpec> neighbors,
+                 const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Remove neighbor entries
+     * @param neighbors Entries to delete
+     * @param options Batch options
+     * @return One result per entry, in input order
+     */
+    std::vector<RouteResult>
+    removeNeighbors(std::span<const NeighborSpec> neighbors,
+                    const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+  /**
+   * @brief Asynchronous route batch class
+   * @details Route requests complete through a kqueue owned by the caller,
+   * so any number can be outstanding without blocking or threads. Requests
+   * submitted during one turn of the event loop are coalesced and written
+   * with one send once the socket reports writable; acknowledgements are
+   * read when it reports readable and each completes its request. Not
+   * thread-safe: submit and dispatch events from the thread running the
+   * kqueue.
+   */
+  class AsyncRouteBatch {
+  public:
+    AsyncRouteBatch();
+
+    /**
+     * @brief Destructor
+     * @details Outstanding requests are dropped without completing
+     */
+    ~AsyncRouteBatch();
+
+    /**
+     * @brief Register with a kqueue
+     * @details Adds read and write filters on the netlink socket whose
+     * udata is this object; pass their events to handleEvent
+     * @param kq Caller's kqueue
+     * @return true on success, false on error
+     */
+    bool attach(int kq);
+
+    /**
+     * @brief Get netlink socket descriptor
+     * @return Descriptor, -1 if not attached
+     */
+    int getFd() const;
+
+    /**
+     * @brief Queue a route installation
+     * @param route Route to add
+     * @param completion Called from handleEvent with the kernel's answer
+     * @return true if queued, false if the route is invalid or not attached
+     */
+    bool add(const RouteSpec &route, RouteCompletion completion);
+
+    /**
+     * @brief Queue a route removal
+     * @param route Route to delete
+     * @param completion Called from handleEvent with the kernel's answer
+     * @return true if queued, false if the route is invalid or not attached
+     */
+    bool remove(const RouteSpec &route, RouteCompletion completion);
+
+    /**
+     * @brief Process a kqueue event
+     * @details Writes queued requests on write and completes acknowledged
+     * ones on read. Completions may submit further requests.
+     * @param event Event returned by kevent(2)
+     * @return true if the event belonged to this batch
+     */
+    bool handleEvent(const struct kevent &event);
+
+    /**
+     * @brief Get number of requests awaiting their acknowledgement
+     * @return Outstanding requests, written or not
+     */
+    size_t getPending() const;
+
+    /**
+     * @brief Complete every outstanding request with ECANCELED
+     * @details Acknowledgements that arrive later are ignored; routes the
+     * kernel already received may still be applied
+     */
+    void cancel();
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_BATCH_HPP
@@ -0,0 +1,121 @@
+/**
+ * @file routing/cache.hpp
+ * @brief Incrementally maintained routing table cache
+ * @details Dumps the routing tables once and then keeps the copy current
+ * from RTM_ADD, RTM_DELETE and RTM_CHANGE messages read from the routing
+ * socket, so lookups never touch the kernel
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_CACHE_HPP
+#define LIBFREEBSDNET_ROUTING_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <routing/entry.hpp>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Routing table cache class
+   * @details One PF_ROUTE socket is bound to each cached FIB with SO_SETFIB.
+   * A background thread applies route changes as they arrive and bumps the
+   * generation counter; a socket overflow triggers a full resynchronisation.
+   */
+  class RoutingTableCache {
+  public:
+    /**
+     * @brief Construct a cache for a set of FIBs
+     * @param fibs FIB numbers to cache (default FIB 0 only)
+     */
+    explicit RoutingTableCache(const std::vector<int> &fibs = {0});
+    ~RoutingTableCache();
+
+    /**
+     * @brief Dump the cached FIBs and start following route changes
+     * @return true on success, false on error
+     */
+    bool start();
+
+    /**
+     * @brief Stop following route changes
+     * @details The cached contents remain readable but are no longer updated
+     */
+    void stop();
+
+    /**
+     * @brief Check if the cache is following route changes
+     * @return true if the update thread is running, false otherwise
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Discard the cached contents and dump every FIB again
+     * @details While running, the update thread does the dump between
+     * messages and the caller waits for it
+     * @return true on success, false on error
+     */
+    bool refresh();
+
+    /**
+     * @brief Get the cache generation
+     * @details Incremented whenever the cached contents change; callers
+     * holding results can compare generations to detect staleness
+     * @return Generation counter
+     */
+    uint64_t getGeneration() const;
+
+    /**
+     * @brief Get all cached routing entries for a FIB
+     * @param fib FIB number (0 = default FIB)
+     * @return Vector of routing entries
+     */
+    std::vector<std::unique_ptr<RoutingEntry>> getEntries(int fib = 0) const;
+
+    /**
+     * @brief Get cached routing entries for a destination
+     * @param destination Destination address, optionally with "/prefix"
+     * @param fib FIB number (0 = default FIB)
+     * @return Vector of matching routing entries
+     */
+    std::vector<std::unique_ptr<RoutingEntry>>
+    getEntries(const std::string &destination, int fib = 0) const;
+
+    /**
+     * @brief Get cached default route
+     * @param fib FIB number (0 = default FIB)
+     * @return Default route entry or nullptr if not found
+     */
+    std::unique_ptr<RoutingEntry> getDefaultGateway(int fib = 0) const;
+
+    /**
+     * @brief Get number of cached routes
+     * @param fib FIB number, or -1 for all cached FIBs
+     * @return Route count
+     */
+    size_t size(int fib = -1) const;
+
+    /**
+     * @brief Get the FIBs held by this cache
+     * @return Vector of FIB numbers
+     */
+    std::vector<int> getFibs() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_CACHE_HPP
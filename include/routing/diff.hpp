@@ -0,0 +1,101 @@
+/**
+ * @file routing/diff.hpp
+ * @brief Routing snapshot delta engine
+ * @details Compares two sets of compact route records and reports which
+ * routes were added, removed or changed
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_DIFF_HPP
+#define LIBFREEBSDNET_ROUTING_DIFF_HPP
+
+#include <routing/batch.hpp>
+#include <routing/entry.hpp>
+#include <routing/record.hpp>
+#include <routing/snapshot.hpp>
+#include <span>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Route present in both snapshots with different attributes
+   */
+  struct RouteChange {
+    RouteRecord before;
+    RouteRecord after;
+  };
+
+  /**
+   * @brief Difference between two routing snapshots
+   * @details Routes are matched by (fib, family, destination, prefix length);
+   * multipath routes sharing that key are paired in gateway order. A matched
+   * pair counts as changed when its gateway, interface, flags, metric or MTU
+   * differ.
+   */
+  struct RouteDiff {
+    std::vector<RouteRecord> added;
+    std::vector<RouteRecord> removed;
+    std::vector<RouteChange> changed;
+
+    /**
+     * @brief Check if the snapshots were identical
+     * @return true if nothing was added, removed or changed
+     */
+    bool empty() const {
+      return added.empty() && removed.empty() && changed.empty();
+    }
+
+    /**
+     * @brief Get total number of differences
+     * @return Added plus removed plus changed count
+     */
+    size_t size() const {
+      return added.size() + removed.size() + changed.size();
+    }
+
+    /**
+     * @brief Compare two snapshots
+     * @details Both inputs are sorted by key and walked in a single linear
+     * merge; pass them by move to avoid copies
+     * @param before Earlier snapshot
+     * @param after Later snapshot
+     * @return Differences, each set in key order
+     */
+    static RouteDiff compare(std::vector<RouteRecord> before,
+                             std::vector<RouteRecord> after);
+  };
+
+  /**
+   * @brief Options for applying a desired route set
+   */
+  struct RouteApplyOptions {
+    bool dryRun = false; // compute the plan without sending it
+    bool includeInterfaceRoutes = false; // also manage AF_LINK gateway routes
+    // Routes with any of these RTF_* bits, live or desired, are left alone
+    uint32_t ignoreFlags = static_cast<uint32_t>(RouteFlag::PINNED);
+    // Interfaces the desired indexes refer to, such as a snapshot's; empty
+    // if they are live indexes
+    std::span<const SnapshotInterface> interfaces;
+    RouteBatchOptions batch;
+  };
+
+  /**
+   * @brief Outcome of applying a desired route set
+   * @details In a dry run the counts are what would have been sent, and
+   * failed only counts desired routes whose interface no longer exists
+   */
+  struct RouteApplyResult {
+    size_t added = 0;
+    size_t changed = 0;
+    size_t removed = 0;
+    size_t unchanged = 0;
+    size_t failed = 0; // requests the kernel rejected, unknown interfaces
+    bool aborted = false; // the live FIB could not be read; nothing was sent
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_DIFF_HPP
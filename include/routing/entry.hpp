@@ -12,6 +12,7 @@
 
 #include <chrono>
 #include <memory>
+#include <routing/record.hpp>
 #include <string>
 #include <vector>
 
@@ -67,6 +68,13 @@ namespace libfreebsdnet::routing {
   public:
     RoutingEntry();
     explicit RoutingEntry(const RoutingEntryInfo &info);
+
+    /**
+     * @brief Construct from a compact route record
+     * @details String fields are formatted on first access only
+     * @param record Route record
+     */
+    explicit RoutingEntry(const RouteRecord &record);
     ~RoutingEntry();
 
     /**
@@ -153,6 +161,12 @@ namespace libfreebsdnet::routing {
      */
     void updateInfo(const RoutingEntryInfo &info);
 
+    /**
+     * @brief Get the compact record this entry was built from
+     * @return Route record or nullptr if the entry was built from strings
+     */
+    const RouteRecord *getRecord() const;
+
   private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -0,0 +1,202 @@
+/**
+ * @file routing/fibsocket.hpp
+ * @brief FIB-bound probe socket pool
+ * @details Keeps warm UDP and ICMP sockets per FIB so high-fanout probes
+ * skip socket() and SO_SETFIB on every use, and pre-resolves each probe
+ * target's egress route from a longest-prefix-match index
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_FIBSOCKET_HPP
+#define LIBFREEBSDNET_ROUTING_FIBSOCKET_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <types/address.hpp>
+#include <types/error.hpp>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  class LpmIndex;
+
+  /**
+   * @brief Probe socket protocol
+   */
+  enum class ProbeProtocol : uint8_t {
+    UDP,  // SOCK_DGRAM, AF_INET
+    ICMP, // SOCK_RAW IPPROTO_ICMP, AF_INET; needs privilege
+    UDP6, // SOCK_DGRAM, AF_INET6
+    ICMP6 // SOCK_RAW IPPROTO_ICMPV6, AF_INET6; needs privilege
+  };
+
+  /**
+   * @brief Pool sizing
+   */
+  struct FibSocketPoolOptions {
+    size_t warmPerFib = 8;     // sockets opened per FIB and protocol by warm()
+    size_t maxIdlePerFib = 64; // idle sockets kept; extra returns are closed
+    bool nonBlocking = true;   // open sockets with SOCK_NONBLOCK
+  };
+
+  class FibSocketPool;
+
+  /**
+   * @brief Leased probe socket
+   * @details Move-only; the socket goes back to its pool when the lease is
+   * destroyed. A socket whose state was changed beyond sending and
+   * receiving (connect(), bind(), socket options) must be discard()ed so
+   * the next user gets a clean one.
+   */
+  class FibSocket {
+  public:
+    FibSocket() = default;
+    FibSocket(FibSocket &&other) noexcept;
+    FibSocket &operator=(FibSocket &&other) noexcept;
+    FibSocket(const FibSocket &) = delete;
+    FibSocket &operator=(const FibSocket &) = delete;
+    ~FibSocket();
+
+    /**
+     * @brief Get the socket descriptor
+     * @return Descriptor, -1 for an empty lease
+     */
+    int get() const { return fd; }
+
+    /**
+     * @brief Get the FIB the socket is bound to
+     * @return FIB number
+     */
+    int getFib() const { return fib; }
+
+    /**
+     * @brief Get the socket protocol
+     * @return Probe protocol
+     */
+    ProbeProtocol getProtocol() const { return protocol; }
+
+    /**
+     * @brief Close the socket instead of returning it to the pool
+     */
+    void discard();
+
+    explicit operator bool() const { return fd >= 0; }
+
+  private:
+    friend class FibSocketPool;
+    class Pool;
+
+    FibSocket(std::shared_ptr<Pool> pool, int fd, int fib,
+              ProbeProtocol protocol)
+        : pool(std::move(pool)), fd(fd), fib(fib), protocol(protocol) {}
+
+    void reset();
+
+    std::shared_ptr<Pool> pool;
+    int fd = -1;
+    int fib = 0;
+    ProbeProtocol protocol = ProbeProtocol::UDP;
+  };
+
+  /**
+   * @brief Pre-resolved egress of a probe target
+   */
+  struct ProbeRoute {
+    types::Address target;
+    int fib = 0;
+    ProbeProtocol protocol = ProbeProtocol::UDP; // matches target's family
+    std::string destination; // matching route
+    std::string gateway;     // next hop, empty if directly connected
+    std::string interface;   // outgoing interface name
+    unsigned int interfaceIndex = 0;
+  };
+
+  /**
+   * @brief FIB-bound probe socket pool class
+   * @details Sockets are opened with SO_SETFIB once and then reused, so a
+   * lease costs a mutex and a vector pop. FIBs are added on first use;
+   * warm() opens sockets ahead of time for the FIBs given at construction.
+   * Leases keep the pool state alive, so they may outlive the pool object.
+   * Thread-safe.
+   */
+  class FibSocketPool {
+  public:
+    /**
+     * @brief Construct a pool
+     * @param fibs FIBs warm() prepares (default FIB 0 only)
+     * @param options Pool sizing
+     */
+    explicit FibSocketPool(const std::vector<int> &fibs = {0},
+                           const FibSocketPoolOptions &options = {});
+    ~FibSocketPool();
+
+    /**
+     * @brief Open warmPerFib sockets per FIB for each protocol
+     * @details Protocols the process may not open (raw ICMP without
+     * privilege) are skipped rather than failing the whole warm-up
+     * @param protocols Protocols to prepare
+     * @return true if at least one socket per FIB was opened
+     */
+    bool warm(const std::vector<ProbeProtocol> &protocols = {
+                  ProbeProtocol::UDP, ProbeProtocol::ICMP});
+
+    /**
+     * @brief Lease a socket bound to a FIB
+     * @details Opens a new socket only when no idle one is left. Packets
+     * queued on an idle socket, such as the ICMP a raw socket sees while
+     * pooled, are discarded before it is handed out
+     * @param fib FIB number
+     * @param protocol Probe protocol
+     * @return Socket lease or error
+     */
+    types::NetResult<FibSocket> acquire(int fib, ProbeProtocol protocol);
+
+    /**
+     * @brief Resolve the egress route of probe targets
+     * @details The index must hold the FIB; build it from a
+     * RoutingTableCache to keep resolutions current without kernel dumps
+     * @param index Longest-prefix-match index
+     * @param targets Probe target addresses
+     * @param fib FIB number
+     * @return One route per target, in input order; interfaceIndex is 0 and
+     * interface empty for unroutable targets
+     */
+    static std::vector<ProbeRoute>
+    resolve(const LpmIndex &index, const std::vector<types::Address> &targets,
+            int fib = 0);
+
+    /**
+     * @brief Get number of idle sockets
+     * @param fib FIB number, or -1 for all FIBs
+     * @return Idle socket count
+     */
+    size_t getIdleCount(int fib = -1) const;
+
+    /**
+     * @brief Get number of sockets opened since construction
+     * @return Open count
+     */
+    uint64_t getOpenCount() const;
+
+    /**
+     * @brief Get number of leases served from idle sockets
+     * @return Reuse count
+     */
+    uint64_t getReuseCount() const;
+
+    /**
+     * @brief Close all idle sockets
+     * @details Leased sockets are closed when their leases end
+     */
+    void drain();
+
+  private:
+    std::shared_ptr<FibSocket::Pool> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_FIBSOCKET_HPP
@@ -10,7 +10,18 @@
 #ifndef LIBFREEBSDNET_ROUTING_LIB_HPP
 #define LIBFREEBSDNET_ROUTING_LIB_HPP
 
+#include <routing/batch.hpp>
+#include <routing/cache.hpp>
+#include <routing/diff.hpp>
 #include <routing/entry.hpp>
+#include <routing/fibsocket.hpp>
+#include <routing/lpm.hpp>
+#include <routing/names.hpp>
+#include <routing/neighbor.hpp>
+#include <routing/nexthop.hpp>
+#include <routing/record.hpp>
+#include <routing/snapshot.hpp>
+#include <routing/stats.hpp>
 #include <routing/table.hpp>
 
 #endif // LIBFREEBSDNET_ROUTING_LIB_HPP
@@ -0,0 +1,106 @@
+/**
+ * @file routing/lpm.hpp
+ * @brief Longest-prefix-match route lookup
+ * @details Answers "which route would this packet use" from an index built
+ * out of a routing dump: a DIR-16-8-8 multibit table for IPv4 and a
+ * path-compressed binary trie for IPv6, one pair per FIB
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_LPM_HPP
+#define LIBFREEBSDNET_ROUTING_LPM_HPP
+
+#include <memory>
+#include <routing/entry.hpp>
+#include <routing/record.hpp>
+#include <span>
+#include <string>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Longest-prefix-match index class
+   * @details The index is a point-in-time copy; rebuild it to pick up route
+   * changes. Lookups are lock-free and may run concurrently with each other
+   * but not with build() or clear(). They return the indexed compact
+   * record, so resolving many addresses allocates nothing per result;
+   * wrap a record in a RoutingEntry to format it.
+   */
+  class LpmIndex {
+  public:
+    LpmIndex();
+    ~LpmIndex();
+
+    /**
+     * @brief Build the index for a FIB from the kernel routing table
+     * @details If the dump fails the FIB's previous index is kept
+     * @param fib FIB number (0 = default FIB)
+     * @return true on success, false on error
+     */
+    bool build(int fib = 0);
+
+    /**
+     * @brief Build the index for a FIB from compact route records
+     * @param fib FIB number the records belong to
+     * @param records Route records, e.g. from RoutingTable::getRecords()
+     */
+    void build(int fib, std::span<const RouteRecord> records);
+
+    /**
+     * @brief Build the index for a FIB from existing routing entries
+     * @details Entries whose destination cannot be parsed are skipped
+     * @param fib FIB number the entries belong to
+     * @param entries Routing entries, e.g. from RoutingTableCache
+     */
+    void build(int fib,
+               const std::vector<std::unique_ptr<RoutingEntry>> &entries);
+
+    /**
+     * @brief Find the route an address would use
+     * @param address Address to resolve (prefix length is ignored)
+     * @param fib FIB number (0 = default FIB)
+     * @return Most specific matching route, or nullptr if none matches;
+     * valid until the next build() or clear()
+     */
+    const RouteRecord *lookup(const types::Address &address,
+                              int fib = 0) const;
+
+    /**
+     * @brief Find the routes a set of addresses would use
+     * @param addresses Addresses to resolve
+     * @param fib FIB number (0 = default FIB)
+     * @return One result per address, in input order; nullptr for no match
+     */
+    std::vector<const RouteRecord *>
+    lookup(std::span<const types::Address> addresses, int fib = 0) const;
+
+    /**
+     * @brief Get number of indexed routes
+     * @param fib FIB number, or -1 for all indexed FIBs
+     * @return Route count
+     */
+    size_t size(int fib = -1) const;
+
+    /**
+     * @brief Drop all indexed FIBs
+     */
+    void clear();
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_LPM_HPP
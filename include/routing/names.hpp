@@ -0,0 +1,55 @@
+/**
+ * @file routing/names.hpp
+ * @brief Interface index to name cache for route formatting
+ * @details Flat ifindex-indexed name table shared by everything that turns
+ * route records into text, so formatting a full table costs one interface
+ * list walk instead of one per route
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_NAMES_HPP
+#define LIBFREEBSDNET_ROUTING_NAMES_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Interface name cache
+   * @details Process-wide and thread-safe. The table is rebuilt lazily on the
+   * first lookup after invalidate(); RoutingTable invalidates it once per
+   * dump and RoutingTableCache on every RTM_IFANNOUNCE.
+   */
+  class InterfaceNameCache {
+  public:
+    /**
+     * @brief Get interface name by index
+     * @param index Interface index
+     * @return Interface name or empty string if not found
+     */
+    static std::string getName(unsigned int index);
+
+    /**
+     * @brief Rebuild the table from the kernel now
+     * @return true on success, false on error
+     */
+    static bool refresh();
+
+    /**
+     * @brief Mark the table stale so the next lookup rebuilds it
+     */
+    static void invalidate();
+
+    /**
+     * @brief Get number of times the table has been rebuilt
+     * @return Rebuild count
+     */
+    static uint64_t getRefreshCount();
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_NAMES_HPP
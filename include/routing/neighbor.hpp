@@ -0,0 +1,183 @@
+/**
+ * @file routing/neighbor.hpp
+ * @brief ARP and NDP neighbor table access
+ * @details Dumps the kernel's link-layer neighbor entries in one sysctl pass
+ * into compact records and programs static entries in batches, replacing
+ * calls out to arp(8) and ndp(8)
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_NEIGHBOR_HPP
+#define LIBFREEBSDNET_ROUTING_NEIGHBOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <ethernet/address.hpp>
+#include <functional>
+#include <memory>
+#include <routing/batch.hpp>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <types/address.hpp>
+#include <vector>
+
+struct rt_msghdr;
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Neighbor entry state
+   * @details IPv6 entries carry their neighbor discovery state; IPv4 entries
+   * are INCOMPLETE until resolved and REACHABLE afterwards
+   */
+  enum class NeighborState : uint8_t {
+    UNKNOWN = 0,
+    INCOMPLETE,
+    REACHABLE,
+    STALE,
+    DELAY,
+    PROBE,
+    PERMANENT
+  };
+
+  /**
+   * @brief Packed neighbor record
+   * @details The address is kept in network byte order
+   */
+  struct NeighborRecord {
+    std::array<uint8_t, 16> address;
+    ethernet::MacAddress mac; // invalid while the entry is unresolved
+    uint32_t expire;          // kernel expiry time in seconds, 0 if static
+    uint32_t flags;           // RTF_* flags; RTF_STATIC, RTF_GATEWAY (router)
+    uint16_t index;           // interface index
+    uint16_t scope;           // IPv6 scope index
+    uint8_t family;           // AF_INET or AF_INET6
+    NeighborState state;
+
+    /**
+     * @brief Decode a neighbor dump message
+     * @param rtm Routing message header followed by its sockaddrs
+     * @param record Output record
+     * @return true on success, false if the message is not an IPv4 or IPv6
+     * neighbor entry
+     */
+    static bool fromMessage(const struct rt_msghdr *rtm,
+                            NeighborRecord &record);
+
+    /**
+     * @brief Check if the entry was added statically
+     * @return true for permanent entries
+     */
+    bool isStatic() const;
+
+    /**
+     * @brief Format neighbor address
+     * @return Address, with "%ifname" appended for scoped IPv6 link-local
+     */
+    std::string formatAddress() const;
+
+    /**
+     * @brief Format interface name
+     * @return Interface name or "unknown"
+     */
+    std::string formatInterface() const;
+
+    /**
+     * @brief Format state
+     * @return State name as printed by ndp(8), e.g. "R" for REACHABLE
+     */
+    std::string formatState() const;
+  };
+
+  static_assert(std::is_trivially_copyable_v<NeighborRecord>);
+
+  /**
+   * @brief Static neighbor entry to install or remove
+   */
+  struct NeighborSpec {
+    types::Address address;   // IPv4 or IPv6 host address
+    ethernet::MacAddress mac; // link-layer address; unused for removal
+    std::string interface;    // interface the neighbor is reached through
+  };
+
+  /**
+   * @brief Neighbor visitor callback type
+   * @details Return false to stop the walk. The record is only valid for
+   * the duration of the call.
+   */
+  using NeighborVisitor = std::function<bool(const NeighborRecord &)>;
+
+  /**
+   * @brief Neighbor table interface
+   * @details Dumps read NET_RT_FLAGS/RTF_LLINFO into the calling thread's
+   * SysctlBuffer and decode each entry in place. Static entries are
+   * programmed as pipelined RTM_NEWNEIGH/RTM_DELNEIGH netlink requests
+   * through RouteBatch. One table may be shared by any number of threads.
+   */
+  class NeighborTable {
+  public:
+    NeighborTable();
+    ~NeighborTable();
+
+    /**
+     * @brief Stream the neighbor table without materialising it
+     * @param family AF_INET, AF_INET6 or AF_UNSPEC for both
+     * @param visitor Callback invoked for every neighbor
+     * @return true if the walk completed, false if the visitor stopped it
+     * or the dump failed
+     */
+    bool forEachNeighbor(int family, const NeighborVisitor &visitor) const;
+
+    /**
+     * @brief Get compact neighbor records
+     * @param family AF_INET, AF_INET6 or AF_UNSPEC for both
+     * @return Contiguous vector of neighbor records, IPv4 first
+     */
+    std::vector<NeighborRecord> getRecords(int family = 0) const;
+
+    /**
+     * @brief Get compact neighbor records into a caller's vector
+     * @details Reusing the same vector keeps its capacity across dumps
+     * @param records Output, cleared first
+     * @param family AF_INET, AF_INET6 or AF_UNSPEC for both
+     * @return true on success, false on error
+     */
+    bool getRecords(std::vector<NeighborRecord> &records,
+                    int family = 0) const;
+
+    /**
+     * @brief Add static neighbor entries in pipelined batches
+     * @details An existing entry for the same address is replaced
+     * @param neighbors Entries to add
+     * @param options Batch options
+     * @return One result per entry, in input order
+     */
+    std::vector<RouteResult> add(std::span<const NeighborSpec> neighbors,
+                                 const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Delete neighbor entries in pipelined batches
+     * @param neighbors Entries to delete
+     * @param options Batch options
+     * @return One result per entry, in input order
+     */
+    std::vector<RouteResult> remove(std::span<const NeighborSpec> neighbors,
+                                    const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Get last error message
+     * @return Error message from the calling thread's last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_NEIGHBOR_HPP
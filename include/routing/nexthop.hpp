@@ -0,0 +1,174 @@
+/**
+ * @file routing/nexthop.hpp
+ * @brief Kernel nexthop and nexthop group tables
+ * @details Dumps the shared nexthop and multipath (ECMP) group objects that
+ * routes point at, so routes can be held as references to deduplicated
+ * nexthops instead of carrying a gateway each
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_NEXTHOP_HPP
+#define LIBFREEBSDNET_ROUTING_NEXTHOP_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Packed nexthop record
+   * @details Gateway bytes are kept as RouteRecord keeps them
+   */
+  struct NexthopRecord {
+    std::array<uint8_t, 16> gateway;
+    uint32_t id;           // kernel nexthop index, unique per FIB and family
+    uint32_t fib;          // FIB the nexthop belongs to
+    uint16_t index;        // transmit interface index
+    uint16_t mtu;          // nexthop MTU
+    uint16_t flags;        // NHF_* flags
+    uint16_t type;         // NH_TYPE_* value
+    uint8_t family;        // AF_INET or AF_INET6
+    uint8_t gatewayFamily; // AF_INET, AF_INET6, AF_LINK or AF_UNSPEC
+    uint8_t gatewayLength; // link-level address length for AF_LINK
+
+    /**
+     * @brief Format gateway
+     * @return Gateway address, link-level address or "link#N"
+     */
+    std::string formatGateway() const;
+  };
+
+  static_assert(std::is_trivially_copyable_v<NexthopRecord>);
+
+  /**
+   * @brief Weighted member of a nexthop group
+   */
+  struct NexthopMember {
+    uint32_t id;     // nexthop index
+    uint32_t weight; // relative weight within the group
+  };
+
+  /**
+   * @brief Multipath nexthop group
+   * @details Members are stored once in the owning table, sorted by
+   * nexthop index; first and count select them
+   */
+  struct NexthopGroup {
+    uint32_t id;    // kernel group index, unique per FIB and family
+    uint32_t first; // offset of the first member in the table
+    uint32_t count; // number of members
+    uint8_t family; // AF_INET or AF_INET6
+  };
+
+  /**
+   * @brief Route that references its nexthop by index
+   * @details A multipath route appears once, pointing at its group. A
+   * million prefixes over a handful of nexthops costs 32 bytes per prefix
+   * plus the nexthops themselves.
+   */
+  struct NexthopRoute {
+    std::array<uint8_t, 16> destination;
+    uint32_t nexthop; // nexthop index, or group index when multipath
+    uint32_t flags;   // RTF_* flags
+    uint16_t scope;   // IPv6 destination scope index
+    uint8_t family;   // AF_INET or AF_INET6
+    uint8_t prefixLength;
+    bool multipath; // nexthop names a NexthopGroup
+  };
+
+  static_assert(std::is_trivially_copyable_v<NexthopRoute>);
+
+  /**
+   * @brief Nexthop table class
+   * @details Holds the nexthops and nexthop groups of one FIB, read with
+   * NET_RT_NHOP and NET_RT_NHGRP into the calling thread's SysctlBuffer.
+   * Lookups are by index into flat vectors. Not thread-safe; give each
+   * thread its own table.
+   */
+  class NexthopTable {
+  public:
+    NexthopTable();
+    ~NexthopTable();
+
+    NexthopTable(NexthopTable &&) noexcept;
+    NexthopTable &operator=(NexthopTable &&) noexcept;
+
+    /**
+     * @brief Dump the nexthops and groups of a FIB
+     * @details Replaces the current contents, keeping allocated capacity
+     * @param fib FIB number (0 = default FIB)
+     * @return true on success, false on error
+     */
+    bool refresh(int fib = 0);
+
+    /**
+     * @brief Get the FIB the table was last read from
+     * @return FIB number
+     */
+    int getFib() const;
+
+    /**
+     * @brief Find a nexthop
+     * @param family AF_INET or AF_INET6
+     * @param id Nexthop index
+     * @return Nexthop or nullptr if not found
+     */
+    const NexthopRecord *find(int family, uint32_t id) const;
+
+    /**
+     * @brief Find a nexthop group
+     * @param family AF_INET or AF_INET6
+     * @param id Group index
+     * @return Group or nullptr if not found
+     */
+    const NexthopGroup *findGroup(int family, uint32_t id) const;
+
+    /**
+     * @brief Find the group with exactly the given members and weights
+     * @param family AF_INET or AF_INET6
+     * @param members Weighted nexthop indexes, sorted by index
+     * @return Group or nullptr if no group matches
+     */
+    const NexthopGroup *findGroup(int family,
+                                  std::span<const NexthopMember> members) const;
+
+    /**
+     * @brief Get the members of a group
+     * @param group Group from this table
+     * @return Members sorted by nexthop index
+     */
+    std::span<const NexthopMember> getMembers(const NexthopGroup &group) const;
+
+    /**
+     * @brief Get all nexthops
+     * @return Nexthops, IPv4 then IPv6, each sorted by index
+     */
+    std::span<const NexthopRecord> getNexthops() const;
+
+    /**
+     * @brief Get all nexthop groups
+     * @return Groups, IPv4 then IPv6, each sorted by index
+     */
+    std::span<const NexthopGroup> getGroups() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_NEXTHOP_HPP
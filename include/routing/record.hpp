@@ -0,0 +1,86 @@
+/**
+ * @file routing/record.hpp
+ * @brief Compact binary route record
+ * @details Fixed-size, trivially copyable route representation decoded from
+ * routing messages without any string formatting; text is produced only when
+ * asked for
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_RECORD_HPP
+#define LIBFREEBSDNET_ROUTING_RECORD_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+struct rt_msghdr;
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Packed route record
+   * @details Addresses are kept in network byte order. For AF_LINK gateways
+   * the gateway bytes hold the link-level address, or nothing when the route
+   * points at an interface rather than a neighbour.
+   */
+  struct RouteRecord {
+    std::array<uint8_t, 16> destination;
+    std::array<uint8_t, 16> gateway;
+    uint32_t flags;        // RTF_* flags
+    uint32_t fib;          // FIB the route was read from
+    uint32_t metric;       // route weight
+    uint32_t mtu;          // path MTU, 0 if unset
+    uint32_t nexthop;      // kernel nexthop index, 0 if unknown
+    uint16_t index;        // outgoing interface index
+    uint16_t gatewayIndex; // AF_LINK gateway or IPv6 gateway scope index
+    uint16_t scope;        // IPv6 destination scope index
+    uint8_t family;        // AF_INET or AF_INET6
+    uint8_t gatewayFamily; // AF_INET, AF_INET6, AF_LINK or AF_UNSPEC
+    uint8_t prefixLength;
+    uint8_t gatewayLength; // link-level address length for AF_LINK
+
+    /**
+     * @brief Decode a routing message
+     * @param rtm Routing message header followed by its sockaddrs
+     * @param fib FIB number to record
+     * @param record Output record
+     * @return true on success, false if the message is not an IPv4 or IPv6
+     * route
+     */
+    static bool fromMessage(const struct rt_msghdr *rtm, uint32_t fib,
+                            RouteRecord &record);
+
+    /**
+     * @brief Format destination address
+     * @return Address, with "%ifname" appended for scoped IPv6 link-local
+     */
+    std::string formatDestination() const;
+
+    /**
+     * @brief Format gateway
+     * @return Gateway address, link-level address, "ifname (#N)" or "link#N"
+     */
+    std::string formatGateway() const;
+
+    /**
+     * @brief Format outgoing interface name
+     * @return Interface name or "unknown"
+     */
+    std::string formatInterface() const;
+
+    /**
+     * @brief Format netmask
+     * @return Prefix length as a string, empty for host routes
+     */
+    std::string formatNetmask() const;
+  };
+
+  static_assert(std::is_trivially_copyable_v<RouteRecord>);
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_RECORD_HPP
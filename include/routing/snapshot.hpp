@@ -0,0 +1,199 @@
+/**
+ * @file routing/snapshot.hpp
+ * @brief Memory-mapped route snapshot files
+ * @details Versioned binary file holding compact route, interface and
+ * neighbor records in sorted order, so an archived table can be mapped and
+ * queried (longest-prefix match, prefix range scans) without parsing
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_SNAPSHOT_HPP
+#define LIBFREEBSDNET_ROUTING_SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <routing/neighbor.hpp>
+#include <routing/record.hpp>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <types/address.hpp>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Interface record stored in a snapshot
+   * @details Enough to resolve the interface indexes of the archived routes
+   * and neighbors
+   */
+  struct SnapshotInterface {
+    std::array<char, 16> name; // NUL-terminated interface name
+    uint32_t flags;            // IFF_* flags
+    uint32_t mtu;
+    std::array<uint8_t, 8> link; // link-level address
+    uint16_t index;              // interface index
+    uint8_t type;                // IFT_* value
+    uint8_t linkLength;          // link-level address length
+  };
+
+  static_assert(std::is_trivially_copyable_v<SnapshotInterface>);
+
+  /**
+   * @brief Route snapshot class
+   * @details The file starts with a header naming the format version, the
+   * size of each record type and the offset of each section. Routes are
+   * sorted by (fib, family, destination, prefix length) and indexed per FIB
+   * and family with the set of prefix lengths present, interfaces by index
+   * and neighbors by (family, address). Records are stored in host byte
+   * order, so a file is only readable on the architecture that wrote it.
+   * An open snapshot is read-only and may be queried from any thread.
+   */
+  class RouteSnapshot {
+  public:
+    static constexpr uint32_t VERSION = 1;
+
+    RouteSnapshot();
+    ~RouteSnapshot();
+
+    RouteSnapshot(const RouteSnapshot &) = delete;
+    RouteSnapshot &operator=(const RouteSnapshot &) = delete;
+
+    /**
+     * @brief Write a snapshot file
+     * @details The inputs are copied and sorted. The file is written
+     * under a temporary name and renamed into place, so readers never see
+     * a partial snapshot.
+     * @param path Output file
+     * @param routes Route records of any FIBs
+     * @param interfaces Interface records
+     * @param neighbors Neighbor records
+     * @param error Output error message on failure
+     * @return true on success, false on error
+     */
+    static bool write(const std::string &path,
+                      std::span<const RouteRecord> routes,
+                      std::span<const SnapshotInterface> interfaces,
+                      std::span<const NeighborRecord> neighbors,
+                      std::string &error);
+
+    /**
+     * @brief Capture the current interface list
+     * @return One record per interface, sorted by index
+     */
+    static std::vector<SnapshotInterface> captureInterfaces();
+
+    /**
+     * @brief Map a snapshot file
+     * @details Checks the header, record sizes and section bounds; the
+     * records themselves are used in place
+     * @param path Snapshot file
+     * @return true on success, false if the file is missing or malformed
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmap the file
+     * @details Spans and pointers obtained from this snapshot become invalid
+     */
+    void close();
+
+    /**
+     * @brief Check if a file is mapped
+     * @return true if open() succeeded
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the capture time
+     * @return Seconds since the epoch when the snapshot was written
+     */
+    int64_t getTimestamp() const;
+
+    /**
+     * @brief Get all routes
+     * @return Routes sorted by (fib, family, destination, prefix length)
+     */
+    std::span<const RouteRecord> getRoutes() const;
+
+    /**
+     * @brief Get the routes of one FIB
+     * @details Suitable as the desired set for RoutingTable::apply
+     * @param fib FIB number
+     * @return IPv4 then IPv6 routes of the FIB
+     */
+    std::span<const RouteRecord> getRoutes(uint32_t fib) const;
+
+    /**
+     * @brief Get the routes of one FIB and family
+     * @param fib FIB number
+     * @param family AF_INET or AF_INET6
+     * @return Routes sorted by (destination, prefix length)
+     */
+    std::span<const RouteRecord> getRoutes(uint32_t fib, int family) const;
+
+    /**
+     * @brief Get all interfaces
+     * @return Interfaces sorted by index
+     */
+    std::span<const SnapshotInterface> getInterfaces() const;
+
+    /**
+     * @brief Get all neighbors
+     * @return Neighbors sorted by (family, address)
+     */
+    std::span<const NeighborRecord> getNeighbors() const;
+
+    /**
+     * @brief Find the route an address would have used
+     * @details Probes only the prefix lengths present in the FIB, most
+     * specific first, with a binary search each; multipath routes return
+     * their first path
+     * @param address Address to resolve (prefix length is ignored)
+     * @param fib FIB number
+     * @return Most specific matching route or nullptr if none matches
+     */
+    const RouteRecord *lookup(const types::Address &address,
+                              uint32_t fib = 0) const;
+
+    /**
+     * @brief Get the routes inside a prefix
+     * @param prefix Covering prefix; routes at least as specific are
+     * returned
+     * @param fib FIB number
+     * @return Contiguous range of matching routes
+     */
+    std::span<const RouteRecord> range(const types::Address &prefix,
+                                       uint32_t fib = 0) const;
+
+    /**
+     * @brief Find an interface by index
+     * @param index Interface index
+     * @return Interface or nullptr if not found
+     */
+    const SnapshotInterface *findInterface(unsigned int index) const;
+
+    /**
+     * @brief Find a neighbor by address
+     * @param address Neighbor address (prefix length is ignored)
+     * @return First neighbor entry for the address or nullptr if not found
+     */
+    const NeighborRecord *findNeighbor(const types::Address &address) const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_SNAPSHOT_HPP
@@ -0,0 +1,64 @@
+/**
+ * @file routing/stats.hpp
+ * @brief Routing table composition counters
+ * @details Fixed-size histograms filled one route at a time from the
+ * routing dump, so table composition is charted without building entries
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_ROUTING_STATS_HPP
+#define LIBFREEBSDNET_ROUTING_STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <routing/record.hpp>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  /**
+   * @brief Routing table composition summary
+   * @details The per-interface and per-FIB vectors are indexed directly and
+   * grow only to the highest index seen, so repeated collection into the
+   * same object settles into no allocation.
+   */
+  struct RouteStats {
+    uint64_t total = 0;
+    uint64_t inet = 0;
+    uint64_t inet6 = 0;
+    std::array<uint64_t, 33> inetPrefixLengths{};   // by IPv4 prefix length
+    std::array<uint64_t, 129> inet6PrefixLengths{}; // by IPv6 prefix length
+    std::array<uint64_t, 32> flags{}; // flags[b] counts routes with bit b set
+    std::vector<uint64_t> byInterface; // by outgoing interface index
+    std::vector<uint64_t> byFib;       // by FIB number
+
+    /**
+     * @brief Count one route
+     * @param record Route record
+     */
+    void add(const RouteRecord &record);
+
+    /**
+     * @brief Add the counts of another summary
+     * @param other Summary to add
+     */
+    void merge(const RouteStats &other);
+
+    /**
+     * @brief Get the number of routes with a flag set
+     * @param flag Single RTF_* bit
+     * @return Route count, 0 if flag is not a single bit
+     */
+    uint64_t countFlag(uint32_t flag) const;
+
+    /**
+     * @brief Zero every counter, keeping vector capacity
+     */
+    void clear();
+  };
+
+} // namespace libfreebsdnet::routing
+
+#endif // LIBFREEBSDNET_ROUTING_STATS_HPP
@@ -10,16 +10,60 @@
 #ifndef LIBFREEBSDNET_ROUTING_TABLE_HPP
 #define LIBFREEBSDNET_ROUTING_TABLE_HPP
 
+#include <functional>
 #include <memory>
+#include <routing/batch.hpp>
+#include <routing/diff.hpp>
 #include <routing/entry.hpp>
+#include <routing/nexthop.hpp>
+#include <routing/record.hpp>
+#include <routing/stats.hpp>
+#include <span>
 #include <string>
+#include <types/address.hpp>
 #include <vector>
 
+struct rt_msghdr;
+
 namespace libfreebsdnet::routing {
 
+  class RouteSnapshot;
+
+  /**
+   * @brief Route visitor callback type
+   * @details Return false to stop the walk. The record is only valid for
+   * the duration of the call.
+   */
+  using RouteVisitor = std::function<bool(const RouteRecord &)>;
+
+  /**
+   * @brief Route dump filter
+   * @details Interface and flag criteria are checked on the routing message
+   * header, so non-matching routes are skipped without being decoded
+   */
+  struct RouteFilter {
+    types::Address prefix{}; // routes inside this prefix; invalid for any
+    unsigned int index = 0;  // outgoing interface index, 0 for any
+    uint32_t flags = 0;      // RTF_* bits that must all be set
+    uint32_t excludeFlags = 0; // RTF_* bits that must all be clear
+    size_t limit = 0;          // stop after this many routes, 0 for all
+
+    /**
+     * @brief Check a decoded route against the filter
+     * @param record Route record
+     * @return true if the route matches every criterion but the limit
+     */
+    bool matches(const RouteRecord &record) const;
+  };
+
   /**
    * @brief Routing table interface
-   * @details Provides access to system routing tables
+   * @details Provides access to system routing tables. One table may be
+   * shared by any number of threads: dumps read into the calling thread's
+   * SysctlBuffer, route socket writes are atomic, batched changes draw a
+   * netlink batch from a pool, and the error message is kept per thread.
+   * The routing socket is opened by the first write, so construction
+   * cannot fail and read-only use never opens it.
    */
   class RoutingTable {
   public:
@@ -39,6 +83,88 @@ namespace libfreebsdnet::routing {
      */
     std::vector<std::unique_ptr<RoutingEntry>> getEntries(int fib) const;
 
+    /**
+     * @brief Get compact route records for a specific FIB
+     * @details Decodes the dump without formatting any strings
+     * @param fib FIB number (0 = default FIB)
+     * @return Contiguous vector of IPv4 and IPv6 route records
+     */
+    std::vector<RouteRecord> getRecords(int fib = 0) const;
+
+    /**
+     * @brief Stream the routing table for a FIB without materialising it
+     * @details Routes are decoded from the sysctl buffer one at a time into
+     * a record on the stack; nothing is allocated per route
+     * @param fib FIB number (0 = default FIB)
+     * @param family AF_INET, AF_INET6 or AF_UNSPEC for both
+     * @param visitor Callback invoked for every route
+     * @return true if the walk completed; false if the visitor stopped it
+     * or a dump failed (see getLastError). A family the kernel lacks is
+     * skipped, not a failure
+     */
+    bool forEachRoute(int fib, int family, const RouteVisitor &visitor) const;
+
+    /**
+     * @brief Stream the routes of a FIB that match a filter
+     * @details A prefix filter also restricts the walk to its address
+     * family. The walk stops once the filter's limit is reached.
+     * @param fib FIB number (0 = default FIB)
+     * @param family AF_INET, AF_INET6 or AF_UNSPEC for both
+     * @param filter Criteria routes must meet
+     * @param visitor Callback invoked for every matching route
+     * @return true if the walk completed or hit the limit; false if the
+     * visitor stopped it or a dump failed (see getLastError)
+     */
+    bool forEachRoute(int fib, int family, const RouteFilter &filter,
+                      const RouteVisitor &visitor) const;
+
+    /**
+     * @brief Dump every FIB concurrently
+     * @details Each FIB/address family pair is fetched and decoded on a
+     * small worker pool. Sysctl buffers are kept between calls, and passing
+     * the same tables vector again reuses its capacity.
+     * @param tables Output, resized to net.fibs; tables[fib] holds the IPv4
+     * then IPv6 routes of that FIB
+     * @param workers Worker threads (0 = up to 4, by hardware concurrency)
+     * @return true on success, false on error
+     */
+    bool dumpAllFibs(std::vector<std::vector<RouteRecord>> &tables,
+                     unsigned int workers = 0) const;
+
+    /**
+     * @brief Count the composition of a FIB in one streaming pass
+     * @param fib FIB number (0 = default FIB)
+     * @param stats Output, cleared first; its capacity is reused
+     * @param filter Routes to count (default all)
+     * @return true on success, false on error
+     */
+    bool getStats(int fib, RouteStats &stats,
+                  const RouteFilter &filter = {}) const;
+
+    /**
+     * @brief Count the composition of every FIB concurrently
+     * @details Each FIB/address family pair is counted by a worker into its
+     * own summary; the summaries are merged at the end
+     * @param stats Output, cleared first; byFib holds the per-FIB totals
+     * @param workers Worker threads (0 = up to 4, by hardware concurrency)
+     * @return true on success, false on error
+     */
+    bool getAllStats(RouteStats &stats, unsigned int workers = 0) const;
+
+    /**
+     * @brief Get a FIB's routes as references to shared nexthops
+     * @details Refreshes nexthops from the same FIB, then walks the route
+     * dump. The paths of a multipath route collapse into one route that
+     * names their nexthop group; paths the group table does not know yet
+     * are kept as separate single-nexthop routes.
+     * @param fib FIB number (0 = default FIB)
+     * @param routes Output, cleared first; its capacity is reused
+     * @param nexthops Output nexthop and group table the routes refer to
+     * @return true on success, false on error
+     */
+    bool getNexthopRoutes(int fib, std::vector<NexthopRoute> &routes,
+                          NexthopTable &nexthops) const;
+
     /**
      * @brief Get the number of FIBs available
      * @return Number of FIBs or -1 if not available
@@ -82,6 +208,47 @@ namespace libfreebsdnet::routing {
     bool addEntry(const std::string &destination, const std::string &gateway,
                   const std::string &interface, uint16_t flags, int fib);
 
+    /**
+     * @brief Add many routing entries in pipelined batches
+     * @details IPv4 and IPv6 routes with any prefix length and FIB may be
+     * mixed; see RouteBatch
+     * @param routes Routes to add
+     * @param options Batch options
+     * @return One result per route, in input order
+     */
+    std::vector<RouteResult>
+    addEntries(std::span<const RouteSpec> routes,
+               const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Delete many routing entries in pipelined batches
+     * @param routes Routes to delete
+     * @param options Batch options
+     * @return One result per route, in input order
+     */
+    std::vector<RouteResult>
+    deleteEntries(std::span<const RouteSpec> routes,
+                  const RouteBatchOptions &options = {});
+
+    /**
+     * @brief Converge a FIB on a desired route set
+     * @details Diffs the desired routes against a fresh dump of the FIB and
+     * sends only the differences through the batched route API: adds first,
+     * least specific first, then in-place replaces, then deletes, most
+     * specific first. Traffic therefore moves to new paths before old ones
+     * are withdrawn, and no prefix is flushed and re-added. Only the
+     * gateway, interface and blackhole/reject flags are compared, as those
+     * are all a request can set; routes archived elsewhere are bound to
+     * interfaces by the names in options.interfaces.
+     * @param desired Routes the FIB should hold; their fib field is ignored
+     * @param fib FIB number (0 = default FIB)
+     * @param options Apply options, including dry run
+     * @return Counts of planned or applied changes; aborted is set, with
+     * the last error, if the FIB could not be dumped
+     */
+    RouteApplyResult apply(std::span<const RouteRecord> desired, int fib = 0,
+                           const RouteApplyOptions &options = {});
+
     /**
      * @brief Delete a routing entry
      * @param destination Destination network (CIDR notation)
@@ -103,6 +270,33 @@ namespace libfreebsdnet::routing {
      */
     std::unique_ptr<RoutingEntry> getDefaultGateway() const;
 
+    /**
+     * @brief Parse one routing message into an entry
+     * @details Accepts the rt_msghdr layout used by both NET_RT_DUMP records
+     * and RTM_ADD/RTM_DELETE/RTM_CHANGE messages read from a routing socket
+     * @param rtm Routing message header followed by its sockaddrs
+     * @return Routing entry or nullptr if the message cannot be parsed
+     */
+    std::unique_ptr<RoutingEntry>
+    parseMessage(const struct rt_msghdr *rtm) const;
+
+    /**
+     * @brief Archive every FIB, the interfaces and the neighbors to a file
+     * @details Writes a RouteSnapshot file; see RouteSnapshot::write
+     * @param path Output file
+     * @return true on success, false on error
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Map a snapshot file written by save()
+     * @param path Snapshot file
+     * @param error Output error message on failure
+     * @return Open snapshot or nullptr on error
+     */
+    static std::unique_ptr<RouteSnapshot> open(const std::string &path,
+                                               std::string &error);
+
     /**
      * @brief Check if routing table is accessible
      * @return true if accessible, false otherwise
@@ -111,7 +305,7 @@ namespace libfreebsdnet::routing {
 
     /**
      * @brief Get last error message
-     * @return Error message from last operation
+     * @return Error message from the calling thread's last operation
      */
     std::string getLastError() const;
 
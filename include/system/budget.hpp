@@ -0,0 +1,145 @@
+/**
+ * @file system/budget.hpp
+ * @brief Shared memory budget for library caches
+ * @details Caches register an account reporting their resident size; when
+ * the total exceeds the configured limit, optional data is evicted from the
+ * least recently used caches first
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_BUDGET_HPP
+#define LIBFREEBSDNET_SYSTEM_BUDGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief What eviction may do to a cache
+   */
+  enum class CachePriority : uint8_t {
+    OPTIONAL, // derived data such as history rings; evicted first
+    CACHED,   // kernel state that is re-read on demand once dropped
+    REQUIRED  // counted, never evicted
+  };
+
+  /**
+   * @brief Memory used by one cache
+   */
+  struct CacheUsage {
+    std::string name;
+    CachePriority priority = CachePriority::REQUIRED;
+    size_t bytes = 0;
+    uint64_t evictions = 0;  // eviction calls that freed memory
+    size_t evictedBytes = 0; // freed by eviction since registration
+  };
+
+  /**
+   * @brief Memory used by all registered caches
+   */
+  struct MemoryReport {
+    size_t limit = 0; // 0 for unlimited
+    size_t total = 0;
+    std::vector<CacheUsage> caches; // in registration order
+  };
+
+  /**
+   * @brief Process-wide cache budget
+   * @details Thread-safe. The limit is soft: REQUIRED caches are never
+   * trimmed, so a table larger than the budget still fits, and only what
+   * the other caches can give back is freed.
+   */
+  class CacheBudget {
+  public:
+    /**
+     * @brief Set the budget
+     * @details Lowering the limit enforces it immediately
+     * @param bytes Limit in bytes, 0 for unlimited (the default)
+     */
+    static void setLimit(size_t bytes);
+
+    /**
+     * @brief Get the budget
+     * @return Limit in bytes, 0 for unlimited
+     */
+    static size_t getLimit();
+
+    /**
+     * @brief Get the memory used by every registered cache
+     * @return Usage report
+     */
+    static MemoryReport memoryUsage();
+
+    /**
+     * @brief Evict until the total is within the limit
+     * @details OPTIONAL caches go before CACHED ones and, within a
+     * priority, the least recently touched first
+     * @return Bytes freed
+     */
+    static size_t enforce();
+  };
+
+  struct CacheAccountState;
+
+  /**
+   * @brief A cache's registration with the budget
+   * @details Owned by the cache and declared after the state its callbacks
+   * use, so it unregisters before that state is destroyed. setUsage() can
+   * run any cache's eviction, so it must not be called while holding a lock
+   * an evict callback takes.
+   */
+  class CacheAccount {
+  public:
+    /**
+     * @brief Evict callback
+     * @details Frees optional data; wanted is a hint. Must not call back
+     * into the account.
+     * @return Bytes freed
+     */
+    using EvictFunction = std::function<size_t(size_t wanted)>;
+
+    /**
+     * @brief Register a cache
+     * @param name Name shown in reports
+     * @param priority Eviction priority
+     * @param evict Evict callback, empty for REQUIRED caches
+     */
+    CacheAccount(const std::string &name, CachePriority priority,
+                 EvictFunction evict = {});
+    ~CacheAccount();
+
+    CacheAccount(const CacheAccount &) = delete;
+    CacheAccount &operator=(const CacheAccount &) = delete;
+
+    /**
+     * @brief Report the cache's resident size
+     * @details Enforces the budget when the total exceeds it
+     * @param bytes Current size in bytes
+     */
+    void setUsage(size_t bytes);
+
+    /**
+     * @brief Get the last reported size
+     * @return Size in bytes
+     */
+    size_t getUsage() const;
+
+    /**
+     * @brief Mark the cache as recently used
+     */
+    void touch();
+
+  private:
+    std::unique_ptr<CacheAccountState> state;
+  };
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_BUDGET_HPP
@@ -10,14 +10,21 @@
 #ifndef LIBFREEBSDNET_SYSTEM_CONFIG_HPP
 #define LIBFREEBSDNET_SYSTEM_CONFIG_HPP
 
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace libfreebsdnet::system {
 
   /**
    * @brief System network configuration class
-   * @details Provides access to system network configuration via sysctl
+   * @details Provides access to system network configuration via sysctl.
+   * MIBs are resolved once at construction and every tracked key is read
+   * in a single refresh pass. Getters serve the cached values until they
+   * are older than the maximum age, so hot loops don't hit the kernel.
+   * Thread-safe: getters share the cache and one of them refreshes it.
    */
   class SystemConfig {
   public:
@@ -103,6 +110,37 @@ namespace libfreebsdnet::system {
      */
     std::map<std::string, std::string> getAllConfig() const;
 
+    /**
+     * @brief Re-read every tracked key now
+     * @return true if every key that exists could be read
+     */
+    bool refresh();
+
+    /**
+     * @brief Force the next getter to refresh
+     */
+    void invalidate();
+
+    /**
+     * @brief Set how long cached values are served
+     * @param maxAge Maximum age, 0 to read the kernel on every call
+     */
+    void setMaxAge(std::chrono::milliseconds maxAge);
+
+    /**
+     * @brief Get how long cached values are served
+     * @return Maximum age, 1 second by default
+     */
+    std::chrono::milliseconds getMaxAge() const;
+
+    /**
+     * @brief Get configuration generation
+     * @details Bumped by every refresh that saw a value change, so callers
+     * can skip reconciling when it matches what they last acted on
+     * @return Generation number, starting at 1
+     */
+    uint64_t getGeneration() const;
+
     /**
      * @brief Get last error message
      * @return Last error message
@@ -0,0 +1,64 @@
+/**
+ * @file system/error.hpp
+ * @brief Per-thread last error message
+ * @details Error state for objects shared between threads, so that the
+ * message one thread reads is the one its own last call left
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_ERROR_HPP
+#define LIBFREEBSDNET_SYSTEM_ERROR_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief Per-thread error message class
+   * @details Each thread sees only the messages it set itself. Messages are
+   * kept in a thread-local table keyed by a process-unique ID rather than
+   * the object address, so a new object never inherits a destroyed one's
+   * message. A thread's entries are released when it exits.
+   */
+  class ThreadError {
+  public:
+    ThreadError();
+
+    /**
+     * @brief Destructor
+     * @details Drops the calling thread's message; other threads' entries
+     * are reclaimed when those threads exit
+     */
+    ~ThreadError();
+
+    ThreadError(const ThreadError &) = delete;
+    ThreadError &operator=(const ThreadError &) = delete;
+
+    /**
+     * @brief Set the calling thread's message
+     * @param message Error message
+     */
+    ThreadError &operator=(std::string message);
+
+    /**
+     * @brief Append to the calling thread's message
+     * @param suffix Text to append
+     */
+    ThreadError &operator+=(const std::string &suffix);
+
+    /**
+     * @brief Get the calling thread's message
+     * @return Last message set on this thread, empty if none
+     */
+    std::string get() const;
+
+  private:
+    uint64_t id;
+  };
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_ERROR_HPP
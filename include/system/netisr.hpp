@@ -0,0 +1,133 @@
+/**
+ * @file system/netisr.hpp
+ * @brief Netisr dispatch configuration and per-queue statistics
+ * @details Reads the net.isr sysctl tree, including the binary per
+ * protocol, workstream and work queue tables, and derives rates between
+ * samples
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_NETISR_HPP
+#define LIBFREEBSDNET_SYSTEM_NETISR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief Global netisr settings
+   */
+  struct NetisrConfig {
+    std::string dispatch; // "direct", "hybrid" or "deferred"
+    int maxThreads = 0;
+    int numThreads = 0;
+    bool bindThreads = false;
+    int maxQueueLimit = 0;
+    int defaultQueueLimit = 0;
+  };
+
+  /**
+   * @brief Registered netisr protocol
+   */
+  struct NetisrProtocol {
+    std::string name;
+    unsigned int proto = 0;
+    unsigned int queueLimit = 0;
+    unsigned int policy = 0;   // NETISR_POLICY_* value
+    unsigned int dispatch = 0; // NETISR_DISPATCH_* value, 0 for default
+    unsigned int flags = 0;    // NETISR_SNP_FLAGS_* bits
+  };
+
+  /**
+   * @brief Netisr work queue counters
+   * @details One queue per workstream (CPU) and protocol
+   */
+  struct NetisrQueue {
+    unsigned int workstream = 0;
+    unsigned int cpu = 0;
+    unsigned int proto = 0;
+    std::string protocol;
+    unsigned int length = 0;    // packets queued now
+    unsigned int watermark = 0; // deepest the queue has been
+    uint64_t dispatched = 0;    // handled directly in the caller's context
+    uint64_t hybridDispatched = 0;
+    uint64_t drops = 0;         // dropped because the queue was full
+    uint64_t queued = 0;
+    uint64_t handled = 0;
+  };
+
+  /**
+   * @brief Netisr work queue rates between two samples
+   */
+  struct NetisrQueueRates {
+    NetisrQueue queue;              // latest counters
+    double dispatchedPerSecond = 0; // direct and hybrid dispatches
+    double queuedPerSecond = 0;
+    double handledPerSecond = 0;
+    double dropsPerSecond = 0;
+    double backlogPerSecond = 0; // queue depth growth, negative when draining
+    double dropRatio = 0;        // drops over packets offered to the queue
+  };
+
+  /**
+   * @brief Netisr statistics class
+   * @details Each sample() reads the protocol, workstream and work tables
+   * with one sysctl(2) each. Rates compare the last two samples; queues
+   * that appear between samples report zero rates until sampled twice.
+   */
+  class NetisrStats {
+  public:
+    NetisrStats();
+    ~NetisrStats();
+
+    /**
+     * @brief Read global netisr settings
+     * @param config Output settings
+     * @return true on success, false if netisr is not available
+     */
+    static bool getConfig(NetisrConfig &config);
+
+    /**
+     * @brief Take a sample of every work queue
+     * @return true on success, false on error
+     */
+    bool sample();
+
+    /**
+     * @brief Get registered protocols from the last sample
+     * @return Protocols in kernel order
+     */
+    const std::vector<NetisrProtocol> &getProtocols() const;
+
+    /**
+     * @brief Get work queue counters from the last sample
+     * @return Queues ordered by workstream, then protocol
+     */
+    const std::vector<NetisrQueue> &getQueues() const;
+
+    /**
+     * @brief Get per-queue rates between the last two samples
+     * @return Rates per queue, empty before the second sample
+     */
+    std::vector<NetisrQueueRates> getRates() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_NETISR_HPP
@@ -0,0 +1,45 @@
+/**
+ * @file system/sockaddr.hpp
+ * @brief Routing message sockaddr helpers
+ * @details Shared by every decoder of routing socket and routing sysctl
+ * messages: splitting the packed sockaddrs after a message header and
+ * turning a netmask sockaddr into a prefix length
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_SOCKADDR_HPP
+#define LIBFREEBSDNET_SYSTEM_SOCKADDR_HPP
+
+#include <net/route.h>
+#include <sys/socket.h>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief Split the sockaddrs that follow a routing message header
+   * @details Present sockaddrs are packed in RTAX_* order, each padded to
+   * SA_SIZE
+   * @param cp First sockaddr
+   * @param end End of the message
+   * @param addrs RTA_* bits of the message
+   * @param sa Output, one pointer per RTAX_* slot, nullptr where absent
+   */
+  void splitAddresses(const char *cp, const char *end, int addrs,
+                      const struct sockaddr *sa[RTAX_MAX]);
+
+  /**
+   * @brief Count the leading one bits of a netmask sockaddr
+   * @details The kernel truncates masks after their last nonzero byte and
+   * may leave their family unset, so the family of the address the mask
+   * belongs to is passed instead
+   * @param mask Netmask sockaddr, or nullptr
+   * @param family AF_INET or AF_INET6
+   * @return Prefix length, 0 if the mask is missing or the family unknown
+   */
+  int maskToPrefix(const struct sockaddr *mask, int family);
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_SOCKADDR_HPP
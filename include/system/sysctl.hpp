@@ -0,0 +1,192 @@
+/**
+ * @file system/sysctl.hpp
+ * @brief Reusable sysctl dump buffer and subtree walker
+ * @details Grow-only, page-aligned buffer for variable-length sysctl reads
+ * such as routing and interface list dumps, and enumeration of the leaves
+ * below a sysctl node
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_SYSCTL_HPP
+#define LIBFREEBSDNET_SYSTEM_SYSCTL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief Sysctl buffer class
+   * @details Keeps one allocation across fetches and only ever grows it. When
+   * the previous result plus headroom fits, the size probe is skipped and the
+   * data is read in a single call; a table that grew past the buffer is
+   * retried with headroom on ENOMEM.
+   */
+  class SysctlBuffer {
+  public:
+    /**
+     * @brief Constructor
+     */
+    SysctlBuffer();
+
+    /**
+     * @brief Destructor
+     */
+    ~SysctlBuffer();
+
+    SysctlBuffer(const SysctlBuffer &) = delete;
+    SysctlBuffer &operator=(const SysctlBuffer &) = delete;
+
+    /**
+     * @brief Exclusive use of a sysctl buffer
+     * @details Holds the calling thread's buffer until destroyed. Data
+     * fetched through it stays valid for the lease's lifetime.
+     */
+    class Lease {
+    public:
+      ~Lease();
+      Lease(Lease &&other) noexcept;
+      Lease(const Lease &) = delete;
+      Lease &operator=(const Lease &) = delete;
+      Lease &operator=(Lease &&) = delete;
+
+      SysctlBuffer &operator*() const { return *buffer; }
+      SysctlBuffer *operator->() const { return buffer; }
+
+    private:
+      friend class SysctlBuffer;
+      Lease(SysctlBuffer *buffer, std::unique_ptr<SysctlBuffer> owned);
+
+      SysctlBuffer *buffer;
+      std::unique_ptr<SysctlBuffer> owned; // set if the thread's was held
+    };
+
+    /**
+     * @brief Lease a buffer for one dump
+     * @details Returns the calling thread's buffer, or a fresh one if it is
+     * already leased further up the stack, so a visitor that starts another
+     * dump never overwrites the one still being decoded
+     * @return Lease on the buffer
+     */
+    static Lease acquire();
+
+    /**
+     * @brief Read a sysctl into the buffer
+     * @param mib MIB name
+     * @return true on success, false on error; an empty result is a success
+     */
+    bool fetch(std::span<const int> mib);
+
+    /**
+     * @brief Get the data read by the last fetch
+     * @return Pointer to the start of the buffer
+     */
+    const char *data() const;
+
+    /**
+     * @brief Get the length of the last fetch
+     * @return Bytes of valid data
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the allocated size
+     * @return Buffer capacity in bytes, a multiple of the page size
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Get errno of the last failed fetch
+     * @return errno value, 0 if the last fetch succeeded
+     */
+    int getError() const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    static SysctlBuffer &local();
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+  /**
+   * @brief Leaf of a sysctl subtree
+   */
+  struct SysctlLeaf {
+    std::string name;      // full dotted name
+    std::vector<int> mib;  // resolved MIB
+    unsigned int kind = 0; // CTLTYPE_* value
+
+    /**
+     * @brief Check if the leaf holds an integer
+     * @return true for signed and unsigned integer types of any width
+     */
+    bool isInteger() const;
+
+    /**
+     * @brief Check if the leaf holds a string
+     * @return true for CTLTYPE_STRING
+     */
+    bool isString() const;
+  };
+
+  /**
+   * @brief Sysctl subtree walker
+   * @details Resolves names once so that callers sampling the same leaves
+   * repeatedly only pay for the value reads
+   */
+  class SysctlTree {
+  public:
+    /**
+     * @brief List the leaves below a node
+     * @param prefix Dotted node name, e.g. "dev.ix.0"
+     * @param leaves Output leaves in kernel order
+     * @return true on success, false if the node does not exist
+     */
+    static bool list(const std::string &prefix,
+                     std::vector<SysctlLeaf> &leaves);
+
+    /**
+     * @brief Resolve a single leaf by name
+     * @param name Dotted name, e.g. "net.inet.ip.forwarding"
+     * @param leaf Output leaf with its MIB and kind
+     * @return true on success, false if the name does not exist
+     */
+    static bool resolve(const std::string &name, SysctlLeaf &leaf);
+
+    /**
+     * @brief Read an integer leaf
+     * @details Signed values are sign-extended
+     * @param leaf Leaf returned by list()
+     * @param value Output value
+     * @return true on success, false if the leaf is not an integer or the
+     * read failed
+     */
+    static bool readInteger(const SysctlLeaf &leaf, uint64_t &value);
+
+    /**
+     * @brief Read a string leaf
+     * @details Short values are read through a stack buffer, so reusing
+     * value avoids allocating once its capacity fits
+     * @param leaf Leaf returned by list() or resolve()
+     * @param value Output value without the terminator
+     * @return true on success, false if the leaf is not a string or the read
+     * failed
+     */
+    static bool readString(const SysctlLeaf &leaf, std::string &value);
+  };
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_SYSCTL_HPP
@@ -0,0 +1,197 @@
+/**
+ * @file system/tunable.hpp
+ * @brief Typed sysctl descriptors and batch reader
+ * @details Compile-time named sysctl descriptors with cached MIBs, and a
+ * reader for arbitrary key lists resolved once and sampled repeatedly
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_SYSTEM_TUNABLE_HPP
+#define LIBFREEBSDNET_SYSTEM_TUNABLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system/sysctl.hpp>
+#include <type_traits>
+
+namespace libfreebsdnet::system {
+
+  /**
+   * @brief Sysctl name usable as a template argument
+   * @tparam N Length of the literal including the terminator
+   */
+  template <size_t N> struct SysctlName {
+    char value[N]{};
+
+    constexpr SysctlName(const char (&name)[N]) {
+      std::copy_n(name, N, value);
+    }
+
+    constexpr std::string_view view() const { return {value, N - 1}; }
+  };
+
+  /**
+   * @brief Typed sysctl descriptor
+   * @details The MIB is resolved on first use and shared by every read, so
+   * an integral read is a single sysctl(2) with no allocation. A name that
+   * does not resolve stays unavailable for the life of the process.
+   * @code
+   * using IpForwarding = Sysctl<"net.inet.ip.forwarding", bool>;
+   * bool on = IpForwarding::get();
+   * @endcode
+   * @tparam Name Dotted sysctl name
+   * @tparam T Integral type, bool, or std::string
+   */
+  template <SysctlName Name, typename T> class Sysctl {
+    static_assert(std::is_integral_v<T> || std::is_same_v<T, std::string>,
+                  "Sysctl values are integral or std::string");
+
+  public:
+    using value_type = T;
+
+    static constexpr std::string_view name = Name.view();
+
+    /**
+     * @brief Check if the kernel has the sysctl
+     * @return true if the name resolved
+     */
+    static bool isAvailable() { return !leaf().mib.empty(); }
+
+    /**
+     * @brief Read the value
+     * @param value Output value, converted from the kernel's width
+     * @return true on success, false if unavailable, mistyped or on error
+     */
+    static bool read(T &value) {
+      const SysctlLeaf &resolved = leaf();
+      if (resolved.mib.empty()) {
+        return false;
+      }
+      if constexpr (std::is_same_v<T, std::string>) {
+        return SysctlTree::readString(resolved, value);
+      } else {
+        uint64_t raw = 0;
+        if (!SysctlTree::readInteger(resolved, raw)) {
+          return false;
+        }
+        value = static_cast<T>(raw);
+        return true;
+      }
+    }
+
+    /**
+     * @brief Read the value with a fallback
+     * @param fallback Returned when the read fails
+     * @return Current value or fallback
+     */
+    static T get(T fallback = T{}) {
+      T value{};
+      return read(value) ? value : fallback;
+    }
+
+  private:
+    static const SysctlLeaf &leaf() {
+      static const SysctlLeaf resolved = [] {
+        SysctlLeaf result;
+        if (!SysctlTree::resolve(std::string(name), result)) {
+          result.mib.clear();
+        }
+        return result;
+      }();
+      return resolved;
+    }
+  };
+
+  /**
+   * @brief Sysctl batch reader class
+   * @details Keys are resolved when added; read() then samples every key
+   * with one sysctl(2) each into typed slots, without allocating for
+   * integers. Keys that are missing or neither integer nor string stay
+   * invalid and are skipped.
+   */
+  class SysctlBatch {
+  public:
+    SysctlBatch();
+    ~SysctlBatch();
+    SysctlBatch(SysctlBatch &&) noexcept;
+    SysctlBatch &operator=(SysctlBatch &&) noexcept;
+    SysctlBatch(const SysctlBatch &) = delete;
+    SysctlBatch &operator=(const SysctlBatch &) = delete;
+
+    /**
+     * @brief Track a key
+     * @param name Dotted sysctl name
+     * @return Slot of the key, also returned for names that fail to resolve
+     */
+    size_t add(const std::string &name);
+
+    /**
+     * @brief Read every valid key
+     * @param changed Optional output, number of values that differ from the
+     * previous read
+     * @return true if every valid key was read
+     */
+    bool read(size_t *changed = nullptr);
+
+    /**
+     * @brief Get number of tracked keys
+     * @return Slot count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Check if a slot resolved to a readable key
+     * @param slot Slot from add()
+     * @return true if the key exists and has a supported type
+     */
+    bool isValid(size_t slot) const;
+
+    /**
+     * @brief Check if a slot holds an integer
+     * @param slot Slot from add()
+     * @return true for integer keys
+     */
+    bool isInteger(size_t slot) const;
+
+    /**
+     * @brief Get the name of a slot
+     * @param slot Slot from add()
+     * @return Dotted name
+     */
+    const std::string &getName(size_t slot) const;
+
+    /**
+     * @brief Get an integer value
+     * @details Signed values are sign-extended
+     * @param slot Slot from add()
+     * @return Value from the last read, 0 if never read
+     */
+    uint64_t getInteger(size_t slot) const;
+
+    /**
+     * @brief Get a string value
+     * @param slot Slot from add()
+     * @return Value from the last read, empty if never read
+     */
+    const std::string &getString(size_t slot) const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message from last operation
+     */
+    std::string getLastError() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+  };
+
+} // namespace libfreebsdnet::system
+
+#endif // LIBFREEBSDNET_SYSTEM_TUNABLE_HPP
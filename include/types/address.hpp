@@ -11,8 +11,16 @@
 #define LIBFREEBSDNET_TYPES_ADDRESS_HPP
 
 #include <arpa/inet.h>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <netinet/in.h>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace libfreebsdnet::types {
@@ -20,14 +28,21 @@ namespace libfreebsdnet::types {
   /**
    * @brief Network address class
    * @details Represents a network address with utilities for parsing and
-   * manipulation
+   * manipulation. The address is held in binary, network byte order, so the
+   * class is trivially copyable and comparisons and hashing are integer
+   * operations; text is only produced on request.
    */
   class Address {
   public:
     /**
      * @brief Address family enumeration
      */
-    enum class Family { IPv4, IPv6, UNKNOWN };
+    enum class Family : uint8_t { IPv4, IPv6, UNKNOWN };
+
+    /**
+     * @brief Buffer size for formatCidr(), including the terminator
+     */
+    static constexpr size_t MAX_CIDR_LENGTH = INET6_ADDRSTRLEN + 4;
 
     /**
      * @brief Default constructor
@@ -47,6 +62,38 @@ namespace libfreebsdnet::types {
      */
     Address(const std::string &ip, int prefixLen);
 
+    /**
+     * @brief Constructor from a binary IPv4 address
+     * @param addr Address in network byte order
+     * @param prefixLen Prefix length
+     */
+    Address(const struct in_addr &addr, int prefixLen);
+
+    /**
+     * @brief Constructor from a binary IPv6 address
+     * @param addr Address in network byte order
+     * @param prefixLen Prefix length
+     */
+    Address(const struct in6_addr &addr, int prefixLen);
+
+    /**
+     * @brief Constructor from raw bytes
+     * @param family IPv4 or IPv6
+     * @param bytes Address in network byte order; IPv4 uses the first 4
+     * and the rest are cleared
+     * @param prefixLen Prefix length
+     */
+    constexpr Address(Family family, const std::array<uint8_t, 16> &bytes,
+                      int prefixLen)
+        : family_(family), bytes_(bytes) {
+      for (size_t i = byteLength(family); i < bytes_.size(); ++i) {
+        bytes_[i] = 0;
+      }
+      int maxLen = static_cast<int>(byteLength(family)) * 8;
+      valid_ = maxLen > 0 && prefixLen >= 0 && prefixLen <= maxLen;
+      prefixLen_ = valid_ ? static_cast<uint8_t>(prefixLen) : 0;
+    }
+
     /**
      * @brief Destructor
      */
@@ -62,13 +109,76 @@ namespace libfreebsdnet::types {
      * @brief Get prefix length
      * @return Prefix length (0-32 for IPv4, 0-128 for IPv6)
      */
-    int getPrefixLength() const;
+    constexpr int getPrefixLength() const { return prefixLen_; }
 
     /**
      * @brief Get address family
      * @return Address family
      */
-    Family getFamily() const;
+    constexpr Family getFamily() const { return family_; }
+
+    /**
+     * @brief Get address bytes
+     * @return 4 bytes for IPv4, 16 for IPv6, empty otherwise, in network
+     * byte order
+     */
+    constexpr std::span<const uint8_t> getBytes() const {
+      return {bytes_.data(), byteLength(family_)};
+    }
+
+    /**
+     * @brief Get the network address (host bits cleared)
+     * @return Address with the same prefix length
+     */
+    constexpr Address getNetworkAddress() const {
+      Address result = *this;
+      for (size_t i = 0; i < result.bytes_.size(); ++i) {
+        result.bytes_[i] &= maskByte(prefixLen_, i);
+      }
+      return result;
+    }
+
+    /**
+     * @brief Get the netmask as an address
+     * @return Netmask with the same family and prefix length
+     */
+    constexpr Address getNetmaskAddress() const {
+      Address result = *this;
+      for (size_t i = 0; i < byteLength(family_); ++i) {
+        result.bytes_[i] = maskByte(prefixLen_, i);
+      }
+      return result;
+    }
+
+    /**
+     * @brief Get the last address of the prefix (host bits set)
+     * @return Address with the same prefix length
+     */
+    constexpr Address getBroadcastAddress() const {
+      Address result = *this;
+      for (size_t i = 0; i < byteLength(family_); ++i) {
+        result.bytes_[i] |= static_cast<uint8_t>(~maskByte(prefixLen_, i));
+      }
+      return result;
+    }
+
+    /**
+     * @brief Check whether an address falls inside this prefix
+     * @param other Address to test
+     * @return true if families match and the leading prefix bits are equal
+     */
+    constexpr bool contains(const Address &other) const {
+      if (!valid_ || !other.valid_ || family_ != other.family_) {
+        return false;
+      }
+      for (size_t i = 0; i < byteLength(family_); ++i) {
+        uint8_t mask = maskByte(prefixLen_, i);
+        if ((bytes_[i] & mask) != (other.bytes_[i] & mask)) {
+          return false;
+        }
+      }
+      return true;
+    }
 
     /**
      * @brief Get netmask as string
@@ -88,23 +198,53 @@ namespace libfreebsdnet::types {
      */
     std::string getCidr() const;
 
+    /**
+     * @brief Format the IP address into a caller buffer
+     * @param buffer Output buffer, NUL-terminated on success
+     * @return Length written without the terminator, 0 if the address is
+     * invalid or the buffer is too small
+     */
+    size_t formatIp(std::span<char> buffer) const;
+
+    /**
+     * @brief Format the address in CIDR notation into a caller buffer
+     * @param buffer Output buffer of at least MAX_CIDR_LENGTH bytes
+     * @return Length written without the terminator, 0 if the address is
+     * invalid or the buffer is too small
+     */
+    size_t formatCidr(std::span<char> buffer) const;
+
+    /**
+     * @brief Get hash of the address
+     * @return Hash over family, bytes and prefix length
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Order by family, then address bytes, then prefix length
+     */
+    constexpr std::strong_ordering
+    operator<=>(const Address &other) const = default;
+
+    constexpr bool operator==(const Address &other) const = default;
+
     /**
      * @brief Check if address is valid
      * @return true if address is valid, false otherwise
      */
-    bool isValid() const;
+    constexpr bool isValid() const { return valid_; }
 
     /**
      * @brief Check if address is IPv4
      * @return true if IPv4, false otherwise
      */
-    bool isIPv4() const;
+    constexpr bool isIPv4() const { return family_ == Family::IPv4; }
 
     /**
      * @brief Check if address is IPv6
      * @return true if IPv6, false otherwise
      */
-    bool isIPv6() const;
+    constexpr bool isIPv6() const { return family_ == Family::IPv6; }
 
     /**
      * @brief Get sockaddr_in for IPv4 addresses
@@ -125,6 +265,43 @@ namespace libfreebsdnet::types {
      */
     static Address fromString(const std::string &addressString);
 
+    /**
+     * @brief Parse CIDR text without allocating
+     * @param text Address in CIDR notation (e.g., "192.168.1.1/24")
+     * @param out Parsed address, left invalid on failure
+     * @return true if parsing successful, false otherwise
+     */
+    static bool parse(std::string_view text, Address &out);
+
+    /**
+     * @brief Check CIDR text without building an address
+     * @param text Address in CIDR notation
+     * @return true if the text would parse to a valid address
+     */
+    static bool validate(std::string_view text);
+
+    /**
+     * @brief Parse many CIDR strings
+     * @param texts Input strings
+     * @param out Output addresses, at least texts.size() long; entries that
+     * fail to parse are left invalid
+     * @return Number of valid addresses parsed
+     */
+    static size_t parseAddresses(std::span<const std::string_view> texts,
+                                 std::span<Address> out);
+
+    /**
+     * @brief Format many addresses in CIDR notation
+     * @details Entry i is written NUL-terminated at out + i *
+     * MAX_CIDR_LENGTH; invalid addresses become empty strings
+     * @param addresses Input addresses
+     * @param out Output buffer of addresses.size() * MAX_CIDR_LENGTH bytes
+     * @return Number of entries written, less than addresses.size() if the
+     * buffer is too small
+     */
+    static size_t formatAddresses(std::span<const Address> addresses,
+                                  std::span<char> out);
+
     /**
      * @brief Parse address string into components
      * @param addressString Address string to parse
@@ -154,25 +331,46 @@ namespace libfreebsdnet::types {
                                           Family family);
 
   private:
-    std::string ip_;
-    int prefixLen_;
-    Family family_;
-    bool valid_;
+    // Declaration order is the comparison order
+    Family family_ = Family::UNKNOWN;
+    std::array<uint8_t, 16> bytes_{};
+    uint8_t prefixLen_ = 0;
+    bool valid_ = false;
+
+    static constexpr size_t byteLength(Family family) {
+      return family == Family::IPv4 ? 4 : family == Family::IPv6 ? 16 : 0;
+    }
+
+    // Netmask byte i for a prefix length
+    static constexpr uint8_t maskByte(int prefixLen, size_t i) {
+      int keep = prefixLen - static_cast<int>(i) * 8;
+      keep = keep < 0 ? 0 : keep > 8 ? 8 : keep;
+      return static_cast<uint8_t>(0xff00 >> keep);
+    }
 
     /**
-     * @brief Parse the address string
-     * @param addressString Address string to parse
+     * @brief Set family, bytes and validity from an IP string
+     * @param ip IP address string
+     * @param prefixLen Prefix length
      */
-    void parseString(const std::string &addressString);
+    void assign(const std::string &ip, int prefixLen);
 
     /**
-     * @brief Determine address family from IP string
-     * @param ip IP address string
-     * @return Address family
+     * @brief Parse the address string
+     * @param addressString Address string to parse
      */
-    static Family determineFamily(const std::string &ip);
+    void parseString(const std::string &addressString);
   };
 
+  static_assert(std::is_trivially_copyable_v<Address>);
+  static_assert(sizeof(Address) <= 24);
+
 } // namespace libfreebsdnet::types
 
+template <> struct std::hash<libfreebsdnet::types::Address> {
+  size_t operator()(const libfreebsdnet::types::Address &address) const {
+    return address.hash();
+  }
+};
+
 #endif // LIBFREEBSDNET_TYPES_ADDRESS_HPP
@@ -0,0 +1,68 @@
+/**
+ * @file types/error.hpp
+ * @brief Structured error type
+ * @details Compact, allocation-free error value for the std::expected API
+ * tier; the message is only formatted when asked for
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_TYPES_ERROR_HPP
+#define LIBFREEBSDNET_TYPES_ERROR_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <expected>
+#include <string>
+
+namespace libfreebsdnet::types {
+
+  /**
+   * @brief Error category
+   */
+  enum class NetErrorCode : uint8_t {
+    SYSTEM,           // a kernel call failed; see error and request
+    INVALID_ARGUMENT, // rejected before reaching the kernel
+    NOT_FOUND,        // no such interface, route or object
+    NOT_SUPPORTED     // not available on this interface or kernel
+  };
+
+  /**
+   * @brief Structured error
+   * @details Trivially copyable and 24 bytes, so failing calls in a loop
+   * over thousands of objects cost no allocation
+   */
+  struct NetError {
+    NetErrorCode code = NetErrorCode::SYSTEM;
+    int error = 0;              // errno value, 0 if none
+    unsigned long request = 0;  // ioctl request code, 0 if none
+    const char *operation = ""; // static name of the failing call
+
+    /**
+     * @brief Capture errno after a failed kernel call
+     * @param operation Static name of the failing call
+     * @param request ioctl request code, 0 if none
+     * @return Error of category SYSTEM
+     */
+    static NetError fromErrno(const char *operation,
+                              unsigned long request = 0) {
+      return {NetErrorCode::SYSTEM, errno, request, operation};
+    }
+
+    /**
+     * @brief Format the error for display
+     * @return Message such as "Interface::setMtu: ioctl 0x80206934 failed:
+     * Invalid argument"
+     */
+    std::string toString() const;
+  };
+
+  /**
+   * @brief Result of the structured-error API tier
+   */
+  template <typename T = void> using NetResult = std::expected<T, NetError>;
+
+} // namespace libfreebsdnet::types
+
+#endif // LIBFREEBSDNET_TYPES_ERROR_HPP
@@ -0,0 +1,507 @@
+/**
+ * @file types/prefix.hpp
+ * @brief Prefix sets and maps
+ * @details Path-compressed binary tries over the binary form of
+ * types::Address for containment, longest-match and aggregation queries
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#ifndef LIBFREEBSDNET_TYPES_PREFIX_HPP
+#define LIBFREEBSDNET_TYPES_PREFIX_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <types/address.hpp>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace libfreebsdnet::types {
+
+  /**
+   * @brief Prefix map class
+   * @details Maps IPv4 and IPv6 prefixes to values. Prefixes are stored by
+   * their network address, so "10.1.2.3/8" and "10.0.0.0/8" are the same
+   * key. Nodes live in one vector and link by index, so a trie of n prefixes
+   * is at most 2n nodes with no per-node allocation. Iteration is in address
+   * order, shorter prefixes first.
+   * @tparam T Value type
+   */
+  template <typename T> class PrefixMap {
+  public:
+    using Entry = std::pair<Address, T>;
+    using Visitor = std::function<bool(const Address &, const T &)>;
+
+    PrefixMap() = default;
+
+    /**
+     * @brief Build from entries sorted by prefix
+     * @details Sorted input keeps each insert on the path the previous one
+     * just walked; unsorted input is accepted but slower. Later duplicates
+     * replace earlier ones.
+     * @param entries Prefix and value pairs
+     * @return Populated map
+     */
+    static PrefixMap fromSorted(std::span<const Entry> entries) {
+      PrefixMap map;
+      map.nodes_.reserve(entries.size() * 2);
+      for (const auto &[prefix, value] : entries) {
+        map.insert(prefix, value);
+      }
+      return map;
+    }
+
+    /**
+     * @brief Insert or replace a prefix
+     * @param prefix Prefix to insert
+     * @param value Value to store
+     * @return true if the prefix was new, false if replaced or invalid
+     */
+    bool insert(const Address &prefix, T value) {
+      int root = rootOf(prefix);
+      if (root < 0) {
+        return false;
+      }
+      Key key = keyOf(prefix);
+      int length = prefix.getPrefixLength();
+
+      uint32_t parent = NIL;
+      int side = root;
+      uint32_t current = roots_[root];
+      while (current != NIL) {
+        const Node &node = nodes_[current];
+        int common = commonBits(key, node.key, std::min(length, node.length));
+        if (common < node.length) {
+          // The new prefix diverges inside this node's compressed path
+          uint32_t fresh;
+          if (common == length) {
+            fresh = allocate(key, length);
+            nodes_[fresh].child[bitAt(nodes_[current].key, length)] = current;
+          } else {
+            fresh = allocate(mask(key, common), common);
+            uint32_t leaf = allocate(key, length);
+            nodes_[fresh].child[bitAt(key, common)] = leaf;
+            nodes_[fresh].child[bitAt(nodes_[current].key, common)] = current;
+            link(parent, side) = fresh;
+            nodes_[leaf].value.emplace(std::move(value));
+            ++size_;
+            return true;
+          }
+          link(parent, side) = fresh;
+          nodes_[fresh].value.emplace(std::move(value));
+          ++size_;
+          return true;
+        }
+        if (node.length == length) {
+          bool fresh = !node.value;
+          nodes_[current].value = std::move(value);
+          size_ += fresh;
+          return fresh;
+        }
+        parent = current;
+        side = bitAt(key, node.length);
+        current = node.child[side];
+      }
+      uint32_t leaf = allocate(key, length);
+      link(parent, side) = leaf;
+      nodes_[leaf].value.emplace(std::move(value));
+      ++size_;
+      return true;
+    }
+
+    /**
+     * @brief Remove a prefix
+     * @param prefix Prefix to remove
+     * @return true if it was present
+     */
+    bool remove(const Address &prefix) {
+      int root = rootOf(prefix);
+      if (root < 0) {
+        return false;
+      }
+      Key key = keyOf(prefix);
+      int length = prefix.getPrefixLength();
+
+      // Parent link of the current node and of its parent
+      uint32_t grand = NIL, parent = NIL;
+      int grandSide = root, side = root;
+      uint32_t current = roots_[root];
+      while (current != NIL) {
+        const Node &node = nodes_[current];
+        if (node.length > length ||
+            commonBits(key, node.key, node.length) < node.length) {
+          return false;
+        }
+        if (node.length == length) {
+          break;
+        }
+        grand = parent;
+        grandSide = side;
+        parent = current;
+        side = bitAt(key, node.length);
+        current = node.child[side];
+      }
+      if (current == NIL || !nodes_[current].value) {
+        return false;
+      }
+
+      Node &node = nodes_[current];
+      node.value.reset();
+      --size_;
+      int children = (node.child[0] != NIL) + (node.child[1] != NIL);
+      if (children == 2) {
+        return true;
+      }
+      uint32_t only = node.child[0] != NIL ? node.child[0] : node.child[1];
+      link(parent, side) = only;
+      release(current);
+
+      // A valueless parent left with one child is no longer needed
+      if (only == NIL && parent != NIL && !nodes_[parent].value) {
+        Node &up = nodes_[parent];
+        uint32_t sibling = up.child[side ^ 1];
+        link(grand, grandSide) = sibling;
+        release(parent);
+      }
+      return true;
+    }
+
+    /**
+     * @brief Check for an exact prefix
+     * @param prefix Prefix to look up
+     * @return true if the prefix is stored
+     */
+    bool contains(const Address &prefix) const {
+      return find(prefix) != nullptr;
+    }
+
+    /**
+     * @brief Get the value of an exact prefix
+     * @param prefix Prefix to look up
+     * @return Value or nullptr if not stored
+     */
+    const T *find(const Address &prefix) const {
+      const T *result = nullptr;
+      int length = prefix.getPrefixLength();
+      walk(prefix, [&](uint32_t index) {
+        if (nodes_[index].length == length) {
+          result = &*nodes_[index].value;
+        }
+      });
+      return result;
+    }
+
+    /**
+     * @brief Find the most specific stored prefix covering an address
+     * @param address Address or prefix to look up
+     * @param matched Optional output for the matching prefix
+     * @return Value or nullptr if nothing covers the address
+     */
+    const T *longestMatch(const Address &address,
+                          Address *matched = nullptr) const {
+      uint32_t best = NIL;
+      walk(address, [&](uint32_t index) { best = index; });
+      if (best == NIL) {
+        return nullptr;
+      }
+      if (matched) {
+        *matched = toAddress(address.getFamily(), nodes_[best]);
+      }
+      return &*nodes_[best].value;
+    }
+
+    /**
+     * @brief Check whether any stored prefix covers an address
+     * @param address Address or prefix to look up
+     * @return true if at least one prefix covers it
+     */
+    bool matches(const Address &address) const {
+      return longestMatch(address) != nullptr;
+    }
+
+    /**
+     * @brief Get every stored prefix covering an address
+     * @param address Address or prefix to look up
+     * @return Covering prefixes and values, least specific first
+     */
+    std::vector<std::pair<Address, const T *>>
+    covering(const Address &address) const {
+      std::vector<std::pair<Address, const T *>> result;
+      walk(address, [&](uint32_t index) {
+        result.emplace_back(toAddress(address.getFamily(), nodes_[index]),
+                            &*nodes_[index].value);
+      });
+      return result;
+    }
+
+    /**
+     * @brief Visit every prefix in address order
+     * @param visitor Called per prefix; return false to stop
+     */
+    void forEach(const Visitor &visitor) const {
+      if (visit(roots_[0], Address::Family::IPv4, visitor)) {
+        visit(roots_[1], Address::Family::IPv6, visitor);
+      }
+    }
+
+    /**
+     * @brief Get all prefixes in address order
+     * @return Prefix and value pairs
+     */
+    std::vector<Entry> getEntries() const {
+      std::vector<Entry> entries;
+      entries.reserve(size_);
+      forEach([&](const Address &prefix, const T &value) {
+        entries.emplace_back(prefix, value);
+        return true;
+      });
+      return entries;
+    }
+
+    /**
+     * @brief Get number of prefixes
+     * @return Prefix count
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Check if the map is empty
+     * @return true if there are no prefixes
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Remove every prefix
+     */
+    void clear() {
+      nodes_.clear();
+      free_ = NIL;
+      roots_ = {NIL, NIL};
+      size_ = 0;
+    }
+
+  private:
+    using Key = std::array<uint8_t, 16>;
+
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+      Key key{};
+      int length = 0;
+      uint32_t child[2] = {NIL, NIL};
+      std::optional<T> value;
+    };
+
+    std::vector<Node> nodes_;
+    uint32_t free_ = NIL; // Released nodes chained through child[0]
+    std::array<uint32_t, 2> roots_ = {NIL, NIL};
+    size_t size_ = 0;
+
+    static int rootOf(const Address &prefix) {
+      if (!prefix.isValid()) {
+        return -1;
+      }
+      return prefix.isIPv4() ? 0 : 1;
+    }
+
+    static Key keyOf(const Address &prefix) {
+      Key key{};
+      Address network = prefix.getNetworkAddress();
+      auto bytes = network.getBytes();
+      std::copy(bytes.begin(), bytes.end(), key.begin());
+      return key;
+    }
+
+    static Address toAddress(Address::Family family, const Node &node) {
+      return Address(family, node.key, node.length);
+    }
+
+    static int bitAt(const Key &key, int bit) {
+      return (key[bit / 8] >> (7 - bit % 8)) & 1;
+    }
+
+    // Number of leading bits a and b share, up to limit
+    static int commonBits(const Key &a, const Key &b, int limit) {
+      int bits = 0;
+      for (size_t i = 0; i < a.size() && bits < limit; ++i) {
+        uint8_t diff = a[i] ^ b[i];
+        if (diff == 0) {
+          bits += 8;
+          continue;
+        }
+        while ((diff & 0x80) == 0) {
+          ++bits;
+          diff <<= 1;
+        }
+        break;
+      }
+      return std::min(bits, limit);
+    }
+
+    static Key mask(Key key, int length) {
+      for (size_t i = 0; i < key.size(); ++i) {
+        int keep = std::clamp(length - static_cast<int>(i) * 8, 0, 8);
+        key[i] &= static_cast<uint8_t>(0xff00 >> keep);
+      }
+      return key;
+    }
+
+    uint32_t &link(uint32_t parent, int side) {
+      return parent == NIL ? roots_[side] : nodes_[parent].child[side];
+    }
+
+    uint32_t allocate(const Key &key, int length) {
+      uint32_t index;
+      if (free_ != NIL) {
+        index = free_;
+        free_ = nodes_[index].child[0];
+        nodes_[index] = Node{};
+      } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+      }
+      nodes_[index].key = key;
+      nodes_[index].length = length;
+      return index;
+    }
+
+    void release(uint32_t index) {
+      nodes_[index].value.reset();
+      nodes_[index].child[0] = free_;
+      nodes_[index].child[1] = NIL;
+      free_ = index;
+    }
+
+    // Call fn for each valued node covering the query, shortest first
+    template <typename Fn> void walk(const Address &query, Fn &&fn) const {
+      int root = rootOf(query);
+      if (root < 0) {
+        return;
+      }
+      Key key = keyOf(query);
+      int length = query.getPrefixLength();
+      uint32_t current = roots_[root];
+      while (current != NIL) {
+        const Node &node = nodes_[current];
+        if (node.length > length ||
+            commonBits(key, node.key, node.length) < node.length) {
+          return;
+        }
+        if (node.value) {
+          fn(current);
+        }
+        if (node.length == length) {
+          return;
+        }
+        current = node.child[bitAt(key, node.length)];
+      }
+    }
+
+    bool visit(uint32_t index, Address::Family family,
+               const Visitor &visitor) const {
+      if (index == NIL) {
+        return true;
+      }
+      const Node &node = nodes_[index];
+      if (node.value && !visitor(toAddress(family, node), *node.value)) {
+        return false;
+      }
+      return visit(node.child[0], family, visitor) &&
+             visit(node.child[1], family, visitor);
+    }
+  };
+
+  /**
+   * @brief Prefix set class
+   * @details Value-less PrefixMap with CIDR aggregation
+   */
+  class PrefixSet {
+  public:
+    PrefixSet() = default;
+
+    /**
+     * @brief Build from prefixes sorted by address
+     * @param prefixes Prefixes to insert
+     * @return Populated set
+     */
+    static PrefixSet fromSorted(std::span<const Address> prefixes);
+
+    /**
+     * @brief Insert a prefix
+     * @param prefix Prefix to insert
+     * @return true if the prefix was new
+     */
+    bool insert(const Address &prefix) { return map_.insert(prefix, {}); }
+
+    /**
+     * @brief Remove a prefix
+     * @param prefix Prefix to remove
+     * @return true if it was present
+     */
+    bool remove(const Address &prefix) { return map_.remove(prefix); }
+
+    /**
+     * @brief Check for an exact prefix
+     * @param prefix Prefix to look up
+     * @return true if the prefix is stored
+     */
+    bool contains(const Address &prefix) const {
+      return map_.contains(prefix);
+    }
+
+    /**
+     * @brief Find the most specific stored prefix covering an address
+     * @param address Address or prefix to look up
+     * @return Matching prefix or std::nullopt
+     */
+    std::optional<Address> longestMatch(const Address &address) const;
+
+    /**
+     * @brief Check whether any stored prefix covers an address
+     * @param address Address or prefix to look up
+     * @return true if at least one prefix covers it
+     */
+    bool matches(const Address &address) const {
+      return map_.matches(address);
+    }
+
+    /**
+     * @brief Get every stored prefix covering an address
+     * @param address Address or prefix to look up
+     * @return Covering prefixes, least specific first
+     */
+    std::vector<Address> covering(const Address &address) const;
+
+    /**
+     * @brief Get all prefixes in address order
+     * @return Prefixes
+     */
+    std::vector<Address> getPrefixes() const;
+
+    /**
+     * @brief Build the smallest set covering the same addresses
+     * @details Drops prefixes covered by another and merges sibling pairs
+     * (10.0.0.0/25 and 10.0.0.128/25 become 10.0.0.0/24) until nothing
+     * merges
+     * @return Aggregated set
+     */
+    PrefixSet aggregate() const;
+
+    size_t size() const { return map_.size(); }
+    bool empty() const { return map_.empty(); }
+    void clear() { map_.clear(); }
+
+  private:
+    PrefixMap<std::monostate> map_;
+  };
+
+} // namespace libfreebsdnet::types
+
+#endif // LIBFREEBSDNET_TYPES_PREFIX_HPP
@@ -9,12 +9,34 @@
 
 #include <algorithm>
 #include <ethernet/address.hpp>
-#include <iomanip>
 #include <random>
-#include <sstream>
 
 namespace libfreebsdnet::ethernet {
 
+  namespace {
+
+    constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    // Nibble value per character, 0xff for non-hex
+    constexpr std::array<uint8_t, 256> makeNibbleTable() {
+      std::array<uint8_t, 256> table{};
+      table.fill(0xff);
+      for (int c = '0'; c <= '9'; ++c) {
+        table[c] = static_cast<uint8_t>(c - '0');
+      }
+      for (int c = 'a'; c <= 'f'; ++c) {
+        table[c] = static_cast<uint8_t>(c - 'a' + 10);
+        table[c - 'a' + 'A'] = static_cast<uint8_t>(c - 'a' + 10);
+      }
+      return table;
+    }
+
+    constexpr std::array<uint8_t, 256> NIBBLES = makeNibbleTable();
+
+    bool isSeparator(char c) { return c == ':' || c == '-' || c == ' '; }
+
+  } // namespace
+
   MacAddress::MacAddress() : valid_(false) { bytes_.fill(0); }
 
   MacAddress::MacAddress(const std::array<uint8_t, ADDRESS_SIZE> &bytes)
@@ -37,46 +59,115 @@ namespace libfreebsdnet::ethernet {
   std::string MacAddress::toString() const { return toString(':'); }
 
   std::string MacAddress::toString(char separator) const {
-    std::ostringstream oss;
+    char buf[TEXT_LENGTH + 1];
+    size_t len = format(buf, separator);
+    return std::string(buf, len);
+  }
+
+  size_t MacAddress::format(std::span<char> buffer, char separator) const {
+    if (buffer.size() < TEXT_LENGTH + 1) {
+      return 0;
+    }
+    char *p = buffer.data();
     for (size_t i = 0; i < ADDRESS_SIZE; ++i) {
       if (i > 0) {
-        oss << separator;
+        *p++ = separator;
       }
-      oss << std::hex << std::setw(2) << std::setfill('0')
-          << static_cast<int>(bytes_[i]);
+      *p++ = HEX_DIGITS[bytes_[i] >> 4];
+      *p++ = HEX_DIGITS[bytes_[i] & 0x0f];
     }
-    return oss.str();
+    *p = '\0';
+    return TEXT_LENGTH;
   }
 
   bool MacAddress::fromString(const std::string &address) {
-    std::string cleanAddress = address;
+    valid_ = parseText(address, bytes_);
+    return valid_;
+  }
+
+  int MacAddress::parseCanonical(std::string_view address,
+                                 std::array<uint8_t, ADDRESS_SIZE> &bytes) {
+    if (address.size() != TEXT_LENGTH) {
+      return -1;
+    }
+    for (size_t i = 2; i < TEXT_LENGTH; i += 3) {
+      if (!isSeparator(address[i])) {
+        return -1;
+      }
+    }
+    // OR the nibbles together so one test catches any non-hex digit
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < ADDRESS_SIZE; ++i) {
+      uint8_t hi = NIBBLES[static_cast<unsigned char>(address[i * 3])];
+      uint8_t lo = NIBBLES[static_cast<unsigned char>(address[i * 3 + 1])];
+      invalid |= hi | lo;
+      bytes[i] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+    return (invalid & 0xf0) == 0 ? 1 : 0;
+  }
 
-    // Remove common separators
-    std::replace(cleanAddress.begin(), cleanAddress.end(), ':', ' ');
-    std::replace(cleanAddress.begin(), cleanAddress.end(), '-', ' ');
+  bool MacAddress::parseText(std::string_view address,
+                             std::array<uint8_t, ADDRESS_SIZE> &bytes) {
+    int canonical = parseCanonical(address, bytes);
+    if (canonical >= 0) {
+      return canonical == 1;
+    }
 
-    std::istringstream iss(cleanAddress);
-    std::string byteStr;
+    // Separator runs and surrounding whitespace; every group is two digits
     size_t index = 0;
-
-    while (iss >> byteStr && index < ADDRESS_SIZE) {
-      if (byteStr.length() == 2) {
-        try {
-          bytes_[index] =
-              static_cast<uint8_t>(std::stoul(byteStr, nullptr, 16));
-          ++index;
-        } catch (const std::exception &) {
-          valid_ = false;
-          return false;
-        }
-      } else {
-        valid_ = false;
+    size_t pos = 0;
+    while (pos < address.size()) {
+      if (isSeparator(address[pos]) || address[pos] == '\t' ||
+          address[pos] == '\n') {
+        ++pos;
+        continue;
+      }
+      if (index == ADDRESS_SIZE) {
+        // Trailing input after six groups is ignored, as before
+        break;
+      }
+      size_t start = pos;
+      while (pos < address.size() && !isSeparator(address[pos]) &&
+             address[pos] != '\t' && address[pos] != '\n') {
+        ++pos;
+      }
+      if (pos - start != 2) {
+        return false;
+      }
+      uint8_t hi = NIBBLES[static_cast<unsigned char>(address[start])];
+      uint8_t lo = NIBBLES[static_cast<unsigned char>(address[start + 1])];
+      if ((hi | lo) & 0xf0) {
         return false;
       }
+      bytes[index++] = static_cast<uint8_t>(hi << 4 | lo);
     }
+    return index == ADDRESS_SIZE;
+  }
 
-    valid_ = (index == ADDRESS_SIZE);
-    return valid_;
+  bool MacAddress::validate(std::string_view address) {
+    std::array<uint8_t, ADDRESS_SIZE> bytes;
+    return parseText(address, bytes);
+  }
+
+  size_t MacAddress::parseMacs(std::span<const std::string_view> texts,
+                               std::span<MacAddress> out) {
+    size_t count = std::min(texts.size(), out.size());
+    size_t valid = 0;
+    for (size_t i = 0; i < count; ++i) {
+      out[i].valid_ = parseText(texts[i], out[i].bytes_);
+      valid += out[i].valid_;
+    }
+    return valid;
+  }
+
+  size_t MacAddress::formatMacs(std::span<const MacAddress> macs,
+                                std::span<char> out, char separator) {
+    constexpr size_t stride = TEXT_LENGTH + 1;
+    size_t count = std::min(macs.size(), out.size() / stride);
+    for (size_t i = 0; i < count; ++i) {
+      macs[i].format(out.subspan(i * stride, stride), separator);
+    }
+    return count;
   }
 
   void MacAddress::setBytes(const std::array<uint8_t, ADDRESS_SIZE> &bytes) {
@@ -116,6 +207,28 @@ namespace libfreebsdnet::ethernet {
     return oui;
   }
 
+  uint64_t MacAddress::toUint64() const {
+    uint64_t packed = 0;
+    for (uint8_t byte : bytes_) {
+      packed = packed << 8 | byte;
+    }
+    return packed;
+  }
+
+  MacAddress MacAddress::fromUint64(uint64_t packed) {
+    MacAddress addr;
+    for (size_t i = ADDRESS_SIZE; i-- > 0;) {
+      addr.bytes_[i] = static_cast<uint8_t>(packed);
+      packed >>= 8;
+    }
+    addr.valid_ = true;
+    return addr;
+  }
+
+  size_t MacAddress::hash() const {
+    return static_cast<size_t>(hashPacked(toUint64()));
+  }
+
   MacAddress MacAddress::random() {
     static std::random_device rd;
     static std::mt19937 gen(rd());
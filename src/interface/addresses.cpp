@@ -0,0 +1,92 @@
+/**
+ * @file interface/addresses.cpp
+ * @brief Bulk interface address table implementation
+ * @details Flat address array with per-interface offsets
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <cstdint>
+#include <interface/addresses.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  class AddressTable::Impl {
+  public:
+    // Slice of addresses belonging to one interface
+    struct Group {
+      size_t offset;
+      size_t count;
+    };
+
+    std::vector<libfreebsdnet::types::Address> addresses;
+    std::vector<unsigned int> indexes;
+    std::vector<Group> groups;
+    // Interface index -> group number + 1, 0 for none; interface indexes
+    // are small and dense, so this stays short
+    std::vector<uint32_t> slots;
+  };
+
+  AddressTable::AddressTable() : pImpl(std::make_unique<Impl>()) {}
+
+  AddressTable::~AddressTable() = default;
+
+  AddressTable::AddressTable(AddressTable &&) noexcept = default;
+
+  AddressTable &AddressTable::operator=(AddressTable &&) noexcept = default;
+
+  void AddressTable::reserve(size_t interfaces, size_t addresses) {
+    pImpl->indexes.reserve(interfaces);
+    pImpl->groups.reserve(interfaces);
+    pImpl->addresses.reserve(addresses);
+  }
+
+  void AddressTable::append(
+      unsigned int index,
+      std::span<const libfreebsdnet::types::Address> addresses) {
+    if (index >= pImpl->slots.size()) {
+      pImpl->slots.resize(index + 1, 0);
+    }
+    pImpl->slots[index] = static_cast<uint32_t>(pImpl->groups.size() + 1);
+    pImpl->indexes.push_back(index);
+    pImpl->groups.push_back({pImpl->addresses.size(), addresses.size()});
+    pImpl->addresses.insert(pImpl->addresses.end(), addresses.begin(),
+                            addresses.end());
+  }
+
+  std::span<const libfreebsdnet::types::Address>
+  AddressTable::getAddresses(unsigned int index) const {
+    if (!pImpl) {
+      return {};
+    }
+    if (index >= pImpl->slots.size() || pImpl->slots[index] == 0) {
+      return {};
+    }
+    const Impl::Group &group = pImpl->groups[pImpl->slots[index] - 1];
+    return std::span<const libfreebsdnet::types::Address>(pImpl->addresses)
+        .subspan(group.offset, group.count);
+  }
+
+  std::span<const libfreebsdnet::types::Address> AddressTable::getAll() const {
+    if (!pImpl) {
+      return {};
+    }
+    return pImpl->addresses;
+  }
+
+  std::span<const unsigned int> AddressTable::getIndexes() const {
+    if (!pImpl) {
+      return {};
+    }
+    return pImpl->indexes;
+  }
+
+  size_t AddressTable::size() const {
+    return pImpl ? pImpl->addresses.size() : 0;
+  }
+
+  bool AddressTable::empty() const { return size() == 0; }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,356 @@
+/**
+ * @file interface/affinity.cpp
+ * @brief RSS-aware CPU placement implementation
+ * @details Interrupt names come from hw.intrnames as "irq264: ix0:rxq0";
+ * CPU sets are read per IRQ and per domain with cpuset_getaffinity(2)
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <interface/affinity.hpp>
+#include <iterator>
+#include <net/if.h>
+#include <net/if_mib.h>
+#include <pthread_np.h>
+#include <sys/cpuset.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <string_view>
+#include <system/sysctl.hpp>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    struct Interrupt {
+      int irq = -1;
+      std::string device; // "ix0"
+      std::string label;  // "rxq0"
+    };
+
+    std::string driverName(unsigned int index) {
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(index), IFDATA_DRIVERNAME};
+      char name[IFNAMSIZ * 2] = {0};
+      size_t len = sizeof(name) - 1;
+      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), name, &len, nullptr, 0) !=
+          0) {
+        return "";
+      }
+      return std::string(name, strnlen(name, len));
+    }
+
+    bool readInteger(const std::string &name, int &value) {
+      system::SysctlLeaf leaf;
+      uint64_t raw;
+      if (!system::SysctlTree::resolve(name, leaf) ||
+          !system::SysctlTree::readInteger(leaf, raw)) {
+        return false;
+      }
+      value = static_cast<int>(raw);
+      return true;
+    }
+
+    std::vector<int> readCpus(cpuwhich_t which, id_t id) {
+      cpuset_t set;
+      CPU_ZERO(&set);
+      std::vector<int> cpus;
+      if (cpuset_getaffinity(CPU_LEVEL_WHICH, which, id, sizeof(set), &set) !=
+          0) {
+        return cpus;
+      }
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+          cpus.push_back(cpu);
+        }
+      }
+      return cpus;
+    }
+
+    // Each entry is a fixed-width slot written with "%-*s" by
+    // intrcnt_setname(), so names are space padded and the slots are NUL
+    // terminated; split on NUL and trim the padding
+    std::vector<Interrupt> readInterrupts() {
+      std::vector<Interrupt> interrupts;
+      size_t length = 0;
+      if (sysctlbyname("hw.intrnames", nullptr, &length, nullptr, 0) != 0 ||
+          length == 0) {
+        return interrupts;
+      }
+      std::vector<char> names(length);
+      if (sysctlbyname("hw.intrnames", names.data(), &length, nullptr, 0) !=
+          0) {
+        return interrupts;
+      }
+
+      for (size_t i = 0; i < length;) {
+        size_t size = strnlen(names.data() + i, length - i);
+        std::string_view entry(names.data() + i, size);
+        i += size + 1;
+        entry.remove_suffix(entry.size() -
+                            std::min(entry.find_last_not_of(' ') + 1,
+                                     entry.size()));
+        // "irq264: ix0:rxq0"
+        if (!entry.starts_with("irq")) {
+          continue;
+        }
+        size_t colon = entry.find(':');
+        if (colon == std::string_view::npos) {
+          continue;
+        }
+        std::string_view rest = entry.substr(colon + 1);
+        rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+        size_t split = rest.find(':');
+        if (split == std::string_view::npos) {
+          continue;
+        }
+        Interrupt interrupt;
+        interrupt.irq =
+            std::atoi(std::string(entry.substr(3, colon - 3)).c_str());
+        interrupt.device = std::string(rest.substr(0, split));
+        interrupt.label = std::string(rest.substr(split + 1));
+        interrupts.push_back(std::move(interrupt));
+      }
+      return interrupts;
+    }
+
+    // iflib names receive queues "rxqN"; older drivers use combined "queN"
+    bool isReceiveQueue(const std::string &label) {
+      return label.find("rxq") != std::string::npos ||
+             label.starts_with("que");
+    }
+
+    bool isQueue(const std::string &label) {
+      return isReceiveQueue(label) || label.find("txq") != std::string::npos;
+    }
+
+    // "0:0 1:1 2:2 3:3", set only on kernels built with options RSS
+    std::vector<int> readRssBuckets() {
+      std::vector<int> buckets;
+      system::SysctlLeaf leaf;
+      std::string mapping;
+      if (!system::SysctlTree::resolve("net.inet.rss.bucket_mapping", leaf) ||
+          !system::SysctlTree::readString(leaf, mapping)) {
+        return buckets;
+      }
+      const char *cp = mapping.c_str();
+      while (*cp != '\0') {
+        char *end;
+        long bucket = std::strtol(cp, &end, 10);
+        if (end == cp || *end != ':') {
+          break;
+        }
+        cp = end + 1;
+        long cpu = std::strtol(cp, &end, 10);
+        if (end == cp) {
+          break;
+        }
+        cp = end;
+        while (*cp == ' ') {
+          ++cp;
+        }
+        if (bucket >= 0 && bucket < CPU_SETSIZE) {
+          if (static_cast<size_t>(bucket) >= buckets.size()) {
+            buckets.resize(bucket + 1, -1);
+          }
+          buckets[bucket] = static_cast<int>(cpu);
+        }
+      }
+      return buckets;
+    }
+
+    // CPU id -> domain for every CPU in a domain
+    std::vector<int> readDomainMap() {
+      std::vector<int> map;
+      int domains = 1;
+      readInteger("vm.ndomains", domains);
+      for (int domain = 0; domain < domains; ++domain) {
+        for (int cpu : QueueAffinity::getDomainCpus(domain)) {
+          if (static_cast<size_t>(cpu) >= map.size()) {
+            map.resize(cpu + 1, -1);
+          }
+          map[cpu] = domain;
+        }
+      }
+      return map;
+    }
+
+    bool contains(const std::vector<int> &cpus, int cpu) {
+      return std::binary_search(cpus.begin(), cpus.end(), cpu);
+    }
+
+  } // namespace
+
+  std::vector<int> AffinityPlan::getCpus() const {
+    std::vector<int> cpus;
+    cpus.reserve(workers.size());
+    for (const auto &placement : workers) {
+      cpus.push_back(placement.cpu);
+    }
+    return cpus;
+  }
+
+  AffinityPlan QueueAffinity::plan(const std::string &name,
+                                   unsigned int workers) {
+    AffinityPlan plan;
+    plan.interface = name;
+    std::vector<int> available = getAvailableCpus();
+
+    unsigned int index = if_nametoindex(name.c_str());
+    std::string driver = index != 0 ? driverName(index) : "";
+    size_t unit = driver.find_last_not_of("0123456789");
+    if (unit != std::string::npos && unit + 1 < driver.size()) {
+      // "ix0" lives under dev.ix.0
+      plan.device = "dev." + driver.substr(0, unit + 1) + "." +
+                    driver.substr(unit + 1);
+      readInteger(plan.device + ".%domain", plan.domain);
+      readInteger(plan.device + ".iflib.core_offset", plan.coreOffset);
+    }
+    for (auto &interrupt : readInterrupts()) {
+      if (interrupt.device == driver && isReceiveQueue(interrupt.label)) {
+        plan.queues.push_back({std::move(interrupt.label), interrupt.irq,
+                               readCpus(CPU_WHICH_IRQ, interrupt.irq)});
+      }
+    }
+    plan.rssBuckets = readRssBuckets();
+
+    std::vector<int> local;
+    if (plan.domain >= 0) {
+      for (int cpu : getDomainCpus(plan.domain)) {
+        if (contains(available, cpu)) {
+          local.push_back(cpu);
+        }
+      }
+    }
+    if (local.empty()) {
+      local = available;
+    }
+
+    // One CPU per receive queue: its interrupt's, else its RSS bucket's,
+    // else where iflib would have put it
+    size_t queueCount = plan.queues.empty() ? plan.rssBuckets.size()
+                                            : plan.queues.size();
+    std::vector<int> queueCpus(queueCount, -1);
+    for (size_t q = 0; q < queueCount; ++q) {
+      if (q < plan.queues.size()) {
+        for (int cpu : plan.queues[q].cpus) {
+          if (contains(available, cpu)) {
+            queueCpus[q] = cpu;
+            break;
+          }
+        }
+      }
+      if (queueCpus[q] < 0 && q < plan.rssBuckets.size() &&
+          contains(available, plan.rssBuckets[q])) {
+        queueCpus[q] = plan.rssBuckets[q];
+      }
+      if (queueCpus[q] < 0 && plan.coreOffset >= 0 && !local.empty()) {
+        queueCpus[q] = local[(plan.coreOffset + q) % local.size()];
+      }
+    }
+
+    // Extra workers take the device's other CPUs, then other domains'
+    std::vector<int> spare;
+    for (int cpu : local) {
+      if (std::find(queueCpus.begin(), queueCpus.end(), cpu) ==
+          queueCpus.end()) {
+        spare.push_back(cpu);
+      }
+    }
+    for (int cpu : available) {
+      if (!contains(local, cpu)) {
+        spare.push_back(cpu);
+      }
+    }
+    if (spare.empty()) {
+      spare = local;
+    }
+
+    if (workers == 0) {
+      workers = static_cast<unsigned int>(
+          queueCount > 0 ? queueCount : std::max<size_t>(local.size(), 1));
+    }
+    std::vector<int> domains = readDomainMap();
+    plan.workers.resize(workers);
+    for (unsigned int w = 0; w < workers; ++w) {
+      WorkerPlacement &placement = plan.workers[w];
+      placement.worker = w;
+      if (index == 0) {
+        continue;
+      }
+      if (w < queueCount && queueCpus[w] >= 0) {
+        placement.cpu = queueCpus[w];
+        if (w < plan.queues.size()) {
+          placement.queue = plan.queues[w].queue;
+        }
+      } else if (!spare.empty()) {
+        size_t extra = w >= queueCount ? w - queueCount : w;
+        placement.cpu = spare[extra % spare.size()];
+      }
+      if (placement.cpu >= 0 &&
+          static_cast<size_t>(placement.cpu) < domains.size()) {
+        placement.domain = domains[placement.cpu];
+      }
+    }
+    return plan;
+  }
+
+  std::vector<int> QueueAffinity::getAvailableCpus() {
+    return readCpus(CPU_WHICH_PID, -1);
+  }
+
+  std::vector<int> QueueAffinity::getDomainCpus(int domain) {
+    if (domain < 0) {
+      return {};
+    }
+    return readCpus(CPU_WHICH_DOMAIN, domain);
+  }
+
+  int QueueAffinity::getDomain(int cpu) {
+    std::vector<int> domains = readDomainMap();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= domains.size()) {
+      return -1;
+    }
+    return domains[cpu];
+  }
+
+  std::vector<int> QueueAffinity::getHousekeepingCpus() {
+    std::vector<int> available = getAvailableCpus();
+    std::vector<int> busy;
+    for (const auto &interrupt : readInterrupts()) {
+      if (isQueue(interrupt.label)) {
+        for (int cpu : readCpus(CPU_WHICH_IRQ, interrupt.irq)) {
+          busy.push_back(cpu);
+        }
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    std::vector<int> idle;
+    std::set_difference(available.begin(), available.end(), busy.begin(),
+                        busy.end(), std::back_inserter(idle));
+    return idle.empty() ? available : idle;
+  }
+
+  int QueueAffinity::pin(pthread_t thread, std::span<const int> cpus) {
+    cpuset_t set;
+    CPU_ZERO(&set);
+    bool any = false;
+    for (int cpu : cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+        any = true;
+      }
+    }
+    if (!any) {
+      return EINVAL;
+    }
+    return pthread_setaffinity_np(thread, sizeof(set), &set);
+  }
+
+} // namespace libfreebsdnet::interface
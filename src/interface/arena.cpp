@@ -0,0 +1,59 @@
+/**
+ * @file interface/arena.cpp
+ * @brief Arena placement implementation
+ * @details Origin-tagged class allocation functions
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <cstdint>
+#include <interface/arena.hpp>
+#include <new>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    thread_local std::pmr::memory_resource *activeArena = nullptr;
+
+    // Prefix keeping the payload aligned for any type
+    struct alignas(std::max_align_t) Header {
+      bool arena;
+    };
+
+  } // namespace
+
+  void *ArenaAllocated::operator new(std::size_t size) {
+    size_t total = sizeof(Header) + size;
+    void *block;
+    bool arena = activeArena != nullptr;
+    if (arena) {
+      block = activeArena->allocate(total, alignof(Header));
+    } else {
+      block = ::operator new(total);
+    }
+    auto *header = new (block) Header{arena};
+    return header + 1;
+  }
+
+  void ArenaAllocated::operator delete(void *ptr) noexcept {
+    if (!ptr) {
+      return;
+    }
+    Header *header = static_cast<Header *>(ptr) - 1;
+    if (!header->arena) {
+      ::operator delete(header);
+    }
+  }
+
+  ArenaScope::ArenaScope(std::pmr::memory_resource *arena)
+      : previous_(activeArena) {
+    activeArena = arena;
+  }
+
+  ArenaScope::~ArenaScope() { activeArena = previous_; }
+
+  std::pmr::memory_resource *ArenaScope::current() { return activeArena; }
+
+} // namespace libfreebsdnet::interface
@@ -7,14 +7,21 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <array>
 #include <cstring>
 #include <errno.h>
-#include <ifaddrs.h>
+#include <interface/capability.hpp>
+#include <interface/cloners.hpp>
+#include <interface/socket.hpp>
 #include <iostream>
 #include <interface/base.hpp>
 #include <interface/manager.hpp>
+#include <interface/snapshot.hpp>
 #include <memory>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <net/if_media.h>
 #include <net80211/ieee80211_ioctl.h>
@@ -43,53 +50,107 @@ namespace libfreebsdnet::interface {
     return manager.createInterface(name, index, flags);
   }
 
+  Interface::Impl::Impl(const std::string &name, unsigned int index,
+                        int flags)
+      : name(name), index(index), flags(flags),
+        generation(IdentityTracker::getGeneration(index)) {}
+
+  void Interface::attachRecord(std::shared_ptr<const InterfaceRecord> record) {
+    if (pImpl) {
+      if (record && record->index == pImpl->index && pImpl->epoch == 0) {
+        pImpl->epoch = static_cast<uint64_t>(record->data.ifi_epoch);
+      }
+      pImpl->record = std::move(record);
+    }
+  }
+
+  InterfaceIdentity Interface::getIdentity() const {
+    if (!pImpl) {
+      return {};
+    }
+    return {pImpl->index, pImpl->epoch, pImpl->generation};
+  }
+
+  types::NetResult<bool> Interface::revalidate() {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::revalidate");
+    const types::NetError gone{types::NetErrorCode::NOT_FOUND, ENXIO, 0,
+                               "Interface::revalidate"};
+    if (!pImpl) {
+      return std::unexpected(gone);
+    }
+
+    std::string current;
+    if (IdentityTracker::isRunning()) {
+      if (IdentityTracker::getGeneration(pImpl->index) != pImpl->generation ||
+          !IdentityTracker::getName(pImpl->index, current)) {
+        return std::unexpected(gone);
+      }
+    } else {
+      InterfaceSnapshot snapshot;
+      if (!snapshot.refresh(pImpl->index)) {
+        return std::unexpected(
+            types::NetError::fromErrno("Interface::revalidate"));
+      }
+      auto record = snapshot.find(pImpl->index);
+      if (!record) {
+        return std::unexpected(gone);
+      }
+      uint64_t epoch = static_cast<uint64_t>(record->data.ifi_epoch);
+      if (pImpl->epoch == 0 ? record->name != pImpl->name
+                            : epoch != pImpl->epoch) {
+        return std::unexpected(gone);
+      }
+      pImpl->epoch = epoch;
+      current = record->name;
+    }
+
+    if (current == pImpl->name) {
+      return false;
+    }
+    pImpl->name = std::move(current);
+    invalidateRecord();
+    return true;
+  }
+
+  bool Interface::isSnapshotBacked() const { return getRecord() != nullptr; }
+
+  const InterfaceRecord *Interface::getRecord() const {
+    return pImpl ? pImpl->record.get() : nullptr;
+  }
+
+  void Interface::invalidateRecord() {
+    if (pImpl) {
+      pImpl->record.reset();
+    }
+  }
+
   // Default implementation for getAddresses that can be used by all interfaces
   std::vector<libfreebsdnet::types::Address> Interface::getAddresses() const {
-    std::vector<libfreebsdnet::types::Address> addresses;
-    struct ifaddrs *ifaddrs_ptr;
-
-    if (getifaddrs(&ifaddrs_ptr) == -1) {
-      return addresses;
-    }
-
-    for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
-         ifa = ifa->ifa_next) {
-      if (ifa->ifa_name && ifa->ifa_addr &&
-          std::string(ifa->ifa_name) == getName()) {
-        if (ifa->ifa_addr->sa_family == AF_INET) {
-          struct sockaddr_in *addr_in = (struct sockaddr_in *)ifa->ifa_addr;
-          char ip_str[INET_ADDRSTRLEN];
-          if (inet_ntop(AF_INET, &addr_in->sin_addr, ip_str, INET_ADDRSTRLEN)) {
-            // For now, we'll use a default prefix length of 24 for IPv4
-            // In a real implementation, you'd want to get the actual prefix
-            // length
-            std::string addressStr = std::string(ip_str) + "/24";
-            addresses.emplace_back(addressStr);
-          }
-        } else if (ifa->ifa_addr->sa_family == AF_INET6) {
-          struct sockaddr_in6 *addr_in6 = (struct sockaddr_in6 *)ifa->ifa_addr;
-          char ip_str[INET6_ADDRSTRLEN];
-          if (inet_ntop(AF_INET6, &addr_in6->sin6_addr, ip_str,
-                        INET6_ADDRSTRLEN)) {
-            // For IPv6, use a default prefix length of 64
-            std::string addressStr = std::string(ip_str) + "/64";
-            addresses.emplace_back(addressStr);
-          }
-        }
-      }
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getAddresses");
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->addresses;
     }
 
-    freeifaddrs(ifaddrs_ptr);
-    return addresses;
+    // One-interface dump; prefixes come from the kernel's netmasks
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh(getIndex())) {
+      return {};
+    }
+    auto record = snapshot.find(getIndex());
+    if (!record) {
+      return {};
+    }
+    return record->addresses;
   }
 
   // Default implementation for setAddress that can be used by all interfaces
   bool Interface::setAddress(const libfreebsdnet::types::Address &address) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setAddress");
     if (!address.isValid()) {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -97,7 +158,6 @@ namespace libfreebsdnet::interface {
     // Get sockaddr from Address object
     struct sockaddr_in addr = address.getSockaddrIn();
     if (addr.sin_family != AF_INET) {
-      close(sock);
       return false;
     }
 
@@ -121,48 +181,60 @@ namespace libfreebsdnet::interface {
     std::memcpy(&ifra.ifra_broadaddr, &broadcast, sizeof(broadcast));
 
     // Add the address
-    bool result = (ioctl(sock, SIOCAIFADDR, &ifra) == 0);
-    close(sock);
+    bool result = (metrics::tracedIoctl(sock, SIOCAIFADDR, &ifra) == 0);
+    if (result) {
+      invalidateRecord();
+    }
     return result;
   }
 
   // String overload for setAddress
   bool Interface::setAddress(const std::string &addressString) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setAddress(string)");
     libfreebsdnet::types::Address address(addressString);
     return setAddress(address);
   }
 
   // Common implementations for all interfaces
   bool Interface::setFlags(int flags) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return false;
-    }
+    return trySetFlags(flags).has_value();
+  }
 
+  types::NetResult<> Interface::trySetFlags(int flags) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setFlags");
     struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
+    auto sock = prepare(ifr, AF_INET, "Interface::setFlags");
+    if (!sock) {
+      return std::unexpected(sock.error());
+    }
     ifr.ifr_flags = flags;
 
-    bool result = (ioctl(sock, SIOCSIFFLAGS, &ifr) == 0);
-    close(sock);
-    return result;
+    if (metrics::tracedIoctl(*sock, SIOCSIFFLAGS, &ifr) < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("Interface::setFlags", SIOCSIFFLAGS));
+    }
+    pImpl->flags = flags;
+    invalidateRecord();
+    return {};
   }
 
   bool Interface::bringUp() {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::bringUp");
     int currentFlags = pImpl ? pImpl->flags : 0;
     int newFlags = currentFlags | IFF_UP;
     return setFlags(newFlags);
   }
 
   bool Interface::bringDown() {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::bringDown");
     int currentFlags = pImpl ? pImpl->flags : 0;
     int newFlags = currentFlags & ~IFF_UP;
     return setFlags(newFlags);
   }
 
   bool Interface::setIpv6Option(Ipv6Option option, bool enable) {
-    int sock = socket(AF_INET6, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setIpv6Option");
+    int sock = ControlSocket::get(AF_INET6);
     if (sock < 0) {
       std::cerr << "Failed to create IPv6 socket: " << strerror(errno) << std::endl;
       return false;
@@ -172,9 +244,8 @@ namespace libfreebsdnet::interface {
     std::memset(&nd, 0, sizeof(nd));
     std::strncpy(nd.ifname, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFINFO_IN6, &nd) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCGIFINFO_IN6, &nd) < 0) {
       std::cerr << "SIOCGIFINFO_IN6 failed for " << getName() << ": " << strerror(errno) << std::endl;
-      close(sock);
       return false;
     }
 
@@ -224,69 +295,78 @@ namespace libfreebsdnet::interface {
       break;
     }
 
-    bool result = (ioctl(sock, SIOCSIFINFO_IN6, &nd) == 0);
+    bool result = (metrics::tracedIoctl(sock, SIOCSIFINFO_IN6, &nd) == 0);
     if (!result) {
       std::cerr << "SIOCSIFINFO_IN6 failed for " << getName() << ": " << strerror(errno) << std::endl;
     }
-    close(sock);
     return result;
   }
 
-  bool Interface::setMtu(int mtu) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return false;
-    }
+  bool Interface::setMtu(int mtu) { return trySetMtu(mtu).has_value(); }
 
+  types::NetResult<> Interface::trySetMtu(int mtu) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setMtu");
+    if (mtu <= 0) {
+      return std::unexpected(types::NetError{
+          types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0,
+          "Interface::setMtu"});
+    }
     struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
+    auto sock = prepare(ifr, AF_INET, "Interface::setMtu");
+    if (!sock) {
+      return std::unexpected(sock.error());
+    }
     ifr.ifr_mtu = mtu;
 
-    bool result = (ioctl(sock, SIOCSIFMTU, &ifr) == 0);
-    close(sock);
-    return result;
+    if (metrics::tracedIoctl(*sock, SIOCSIFMTU, &ifr) < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("Interface::setMtu", SIOCSIFMTU));
+    }
+    invalidateRecord();
+    return {};
   }
 
   int Interface::getFib() const {
-    // Get FIB assignment using the correct FreeBSD ioctl (like ifconfig does)
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return 0; // Default FIB
-    }
+    return tryGetFib().value_or(0); // Default FIB on error
+  }
 
+  types::NetResult<int> Interface::tryGetFib() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getFib");
+    // Get FIB assignment using the correct FreeBSD ioctl (like ifconfig does)
     struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
-
-    if (ioctl(sock, SIOCGIFFIB, &ifr) < 0) {
-      close(sock);
-      return 0; // Default FIB on error
+    auto sock = prepare(ifr, AF_INET, "Interface::getFib");
+    if (!sock) {
+      return std::unexpected(sock.error());
     }
 
-    close(sock);
+    if (metrics::tracedIoctl(*sock, SIOCGIFFIB, &ifr) < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("Interface::getFib", SIOCGIFFIB));
+    }
     return ifr.ifr_fib;
   }
 
-  bool Interface::setFib(int fib) {
+  bool Interface::setFib(int fib) { return trySetFib(fib).has_value(); }
+
+  types::NetResult<> Interface::trySetFib(int fib) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setFib");
     // XXX Set FIB assignment using the correct FreeBSD ioctl (like ifconfig
     // does) Try AF_INET first, fall back to AF_LOCAL if that fails
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0 && errno == EAFNOSUPPORT) {
-      sock = socket(AF_LOCAL, SOCK_DGRAM, 0);
+    struct ifreq ifr;
+    auto sock = prepare(ifr, AF_INET, "Interface::setFib");
+    if (!sock && sock.error().error == EAFNOSUPPORT) {
+      sock = prepare(ifr, AF_LOCAL, "Interface::setFib");
     }
-    if (sock < 0) {
-      return false;
+    if (!sock) {
+      return std::unexpected(sock.error());
     }
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
     ifr.ifr_fib = fib;
 
-    bool result = (ioctl(sock, SIOCSIFFIB, &ifr) == 0);
-    close(sock);
-    return result;
+    if (metrics::tracedIoctl(*sock, SIOCSIFFIB, &ifr) < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("Interface::setFib", SIOCSIFFIB));
+    }
+    return {};
   }
 
   std::string Interface::getName() const { return pImpl ? pImpl->name : ""; }
@@ -294,28 +374,29 @@ namespace libfreebsdnet::interface {
   unsigned int Interface::getIndex() const { return pImpl ? pImpl->index : 0; }
 
   bool Interface::isUp() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::isUp");
     return pImpl ? (pImpl->flags & IFF_UP) != 0 : false;
   }
 
-  int Interface::getMtu() const {
-    if (!pImpl)
-      return 1500;
+  int Interface::getMtu() const { return tryGetMtu().value_or(1500); }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0)
-      return 1500;
+  types::NetResult<int> Interface::tryGetMtu() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getMtu");
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->getMtu();
+    }
 
     struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-
-    int mtu = 1500;
-    if (ioctl(sock, SIOCGIFMTU, &ifr) == 0) {
-      mtu = ifr.ifr_mtu;
+    auto sock = prepare(ifr, AF_INET, "Interface::getMtu");
+    if (!sock) {
+      return std::unexpected(sock.error());
     }
 
-    close(sock);
-    return mtu;
+    if (metrics::tracedIoctl(*sock, SIOCGIFMTU, &ifr) < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("Interface::getMtu", SIOCGIFMTU));
+    }
+    return ifr.ifr_mtu;
   }
 
   InterfaceType Interface::getType() const {
@@ -328,11 +409,12 @@ namespace libfreebsdnet::interface {
 
   bool
   Interface::setAliasAddress(const libfreebsdnet::types::Address &address) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setAliasAddress");
     if (!address.isValid()) {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -340,7 +422,6 @@ namespace libfreebsdnet::interface {
     // Get sockaddr from Address object
     struct sockaddr_in addr = address.getSockaddrIn();
     if (addr.sin_family != AF_INET) {
-      close(sock);
       return false;
     }
 
@@ -364,14 +445,17 @@ namespace libfreebsdnet::interface {
     std::memcpy(&ifra.ifra_broadaddr, &broadcast, sizeof(broadcast));
 
     // Add the alias address
-    bool result = (ioctl(sock, SIOCAIFADDR, &ifra) == 0);
-    close(sock);
+    bool result = (metrics::tracedIoctl(sock, SIOCAIFADDR, &ifra) == 0);
+    if (result) {
+      invalidateRecord();
+    }
     return result;
   }
 
   // Default implementation for removeAddress that can be used by all interfaces
   bool Interface::removeAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::removeAddress");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -381,22 +465,22 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
     // Remove the primary address
-    if (ioctl(sock, SIOCDIFADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCDIFADDR, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
+    invalidateRecord();
     return true;
   }
 
   bool
   Interface::removeAliasAddress(const libfreebsdnet::types::Address &address) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::removeAliasAddress");
     if (!address.isValid()) {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -404,7 +488,6 @@ namespace libfreebsdnet::interface {
     // Get sockaddr from Address object
     struct sockaddr_in addr = address.getSockaddrIn();
     if (addr.sin_family != AF_INET) {
-      close(sock);
       return false;
     }
 
@@ -414,24 +497,29 @@ namespace libfreebsdnet::interface {
     std::memcpy(&ifra.ifra_addr, &addr, sizeof(addr));
 
     // Remove the alias address
-    bool result = (ioctl(sock, SIOCDIFADDR, &ifra) == 0);
-    close(sock);
+    bool result = (metrics::tracedIoctl(sock, SIOCDIFADDR, &ifra) == 0);
+    if (result) {
+      invalidateRecord();
+    }
     return result;
   }
 
   bool Interface::setAliasAddress(const std::string &addressString) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setAliasAddress(string)");
     libfreebsdnet::types::Address address(addressString);
     return setAliasAddress(address);
   }
 
   bool Interface::removeAliasAddress(const std::string &addressString) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::removeAliasAddress(string)");
     libfreebsdnet::types::Address address(addressString);
     return removeAliasAddress(address);
   }
 
   std::vector<std::string> Interface::getGroups() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getGroups");
     std::vector<std::string> groups;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return groups;
     }
@@ -441,8 +529,7 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifgr.ifgr_name, getName().c_str(), IFNAMSIZ - 1);
 
     // First get the size
-    if (ioctl(sock, SIOCGIFGROUP, &ifgr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFGROUP, &ifgr) < 0) {
       return groups;
     }
 
@@ -452,7 +539,7 @@ namespace libfreebsdnet::interface {
       ifgr.ifgr_groups = reinterpret_cast<struct ifg_req *>(buffer.data());
 
       // Get the groups
-      if (ioctl(sock, SIOCGIFGROUP, &ifgr) == 0) {
+      if (metrics::tracedIoctl(sock, SIOCGIFGROUP, &ifgr) == 0) {
         int numGroups = ifgr.ifgr_len / sizeof(struct ifg_req);
         for (int i = 0; i < numGroups; i++) {
           groups.push_back(std::string(ifgr.ifgr_groups[i].ifgrq_group));
@@ -460,53 +547,74 @@ namespace libfreebsdnet::interface {
       }
     }
 
-    close(sock);
     return groups;
   }
 
   bool Interface::addToGroup(const std::string &groupName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return false;
-    }
+    return tryAddToGroup(groupName).has_value();
+  }
 
-    struct ifgroupreq ifgr;
-    std::memset(&ifgr, 0, sizeof(ifgr));
-    std::strncpy(ifgr.ifgr_name, getName().c_str(), IFNAMSIZ - 1);
-    std::strncpy(ifgr.ifgr_group, groupName.c_str(), IFNAMSIZ - 1);
+  types::NetResult<> Interface::tryAddToGroup(const std::string &groupName) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::addToGroup");
+    return changeGroup(groupName, SIOCAIFGROUP, "Interface::addToGroup");
+  }
 
-    if (ioctl(sock, SIOCAIFGROUP, &ifgr) < 0) {
-      close(sock);
-      return false;
-    }
+  bool Interface::removeFromGroup(const std::string &groupName) {
+    return tryRemoveFromGroup(groupName).has_value();
+  }
 
-    close(sock);
-    return true;
+  types::NetResult<>
+  Interface::tryRemoveFromGroup(const std::string &groupName) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::removeFromGroup");
+    return changeGroup(groupName, SIOCDIFGROUP, "Interface::removeFromGroup");
   }
 
-  bool Interface::removeFromGroup(const std::string &groupName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  types::NetResult<> Interface::changeGroup(const std::string &groupName,
+                                            unsigned long request,
+                                            const char *operation) {
+    if (groupName.empty() || groupName.size() >= IFNAMSIZ) {
+      return std::unexpected(types::NetError{
+          types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0, operation});
+    }
+    if (!pImpl) {
+      return std::unexpected(types::NetError{types::NetErrorCode::NOT_FOUND,
+                                             ENXIO, 0, operation});
+    }
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
-      return false;
+      return std::unexpected(types::NetError::fromErrno(operation));
     }
 
     struct ifgroupreq ifgr;
     std::memset(&ifgr, 0, sizeof(ifgr));
-    std::strncpy(ifgr.ifgr_name, getName().c_str(), IFNAMSIZ - 1);
+    std::strncpy(ifgr.ifgr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     std::strncpy(ifgr.ifgr_group, groupName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFGROUP, &ifgr) < 0) {
-      close(sock);
-      return false;
+    if (metrics::tracedIoctl(sock, request, &ifgr) < 0) {
+      return std::unexpected(types::NetError::fromErrno(operation, request));
     }
+    return {};
+  }
 
-    close(sock);
-    return true;
+  types::NetResult<int> Interface::prepare(struct ifreq &ifr, int family,
+                                           const char *operation) const {
+    if (!pImpl) {
+      return std::unexpected(types::NetError{types::NetErrorCode::NOT_FOUND,
+                                             ENXIO, 0, operation});
+    }
+    int sock = ControlSocket::get(family);
+    if (sock < 0) {
+      return std::unexpected(types::NetError::fromErrno(operation));
+    }
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
+    return sock;
   }
 
   // Media methods
   int Interface::getMedia() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getMedia");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -515,17 +623,16 @@ namespace libfreebsdnet::interface {
     std::memset(&ifmr, 0, sizeof(ifmr));
     std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifmr.ifm_current;
   }
 
   bool Interface::setMedia(int media) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setMedia");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -535,17 +642,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
     ifmr.ifm_current = media;
 
-    if (ioctl(sock, SIOCSIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFMEDIA, &ifmr) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   int Interface::getMediaStatus() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getMediaStatus");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -554,17 +660,16 @@ namespace libfreebsdnet::interface {
     std::memset(&ifmr, 0, sizeof(ifmr));
     std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifmr.ifm_status;
   }
 
   int Interface::getActiveMedia() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getActiveMedia");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -573,18 +678,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifmr, 0, sizeof(ifmr));
     std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifmr.ifm_active;
   }
 
   std::vector<int> Interface::getSupportedMedia() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getSupportedMedia");
     std::vector<int> media;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return media;
     }
@@ -593,8 +697,7 @@ namespace libfreebsdnet::interface {
     std::memset(&ifmr, 0, sizeof(ifmr));
     std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       return media;
     }
 
@@ -604,20 +707,20 @@ namespace libfreebsdnet::interface {
       ifmr.ifm_ulist = reinterpret_cast<int *>(buffer.data());
 
       // Get the media types
-      if (ioctl(sock, SIOCGIFMEDIA, &ifmr) == 0) {
+      if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) == 0) {
         for (int i = 0; i < ifmr.ifm_count; i++) {
           media.push_back(ifmr.ifm_ulist[i]);
         }
       }
     }
 
-    close(sock);
     return media;
   }
 
   // Capabilities methods
   uint32_t Interface::getCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getCapabilities");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -626,17 +729,16 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_reqcap;
   }
 
   bool Interface::setCapabilities(uint32_t capabilities) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setCapabilities");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -646,17 +748,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
     ifr.ifr_reqcap = capabilities;
 
-    if (ioctl(sock, SIOCSIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFCAP, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   uint32_t Interface::getEnabledCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getEnabledCapabilities");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -665,28 +766,29 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_curcap;
   }
 
   bool Interface::enableCapabilities(uint32_t capabilities) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::enableCapabilities");
     uint32_t current = getEnabledCapabilities();
     return setCapabilities(current | capabilities);
   }
 
   bool Interface::disableCapabilities(uint32_t capabilities) {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::disableCapabilities");
     uint32_t current = getEnabledCapabilities();
     return setCapabilities(current & ~capabilities);
   }
 
   // Physical address methods
   bool Interface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setPhysicalAddress");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -700,21 +802,19 @@ namespace libfreebsdnet::interface {
         reinterpret_cast<struct sockaddr_in *>(&ifra.ifra_addr);
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool Interface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::deletePhysicalAddress");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -723,18 +823,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   // Clone methods
   bool Interface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::createClone");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -743,55 +842,26 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::vector<std::string> Interface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getCloners");
+    return ClonerCache::getCloners();
   }
 
   // MAC address methods
   std::string Interface::getMacAddress() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getMacAddress");
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->linkAddress;
+    }
+
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "";
     }
@@ -800,17 +870,16 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFADDR, &ifr) < 0) {
       return "";
     }
 
-    close(sock);
     return "";
   }
 
   bool Interface::setMacAddress(const std::string &macAddress) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::setMacAddress");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -824,23 +893,22 @@ namespace libfreebsdnet::interface {
                &ifr.ifr_addr.sa_data[0], &ifr.ifr_addr.sa_data[1],
                &ifr.ifr_addr.sa_data[2], &ifr.ifr_addr.sa_data[3],
                &ifr.ifr_addr.sa_data[4], &ifr.ifr_addr.sa_data[5]) != 6) {
-      close(sock);
       return false;
     }
 
     ifr.ifr_addr.sa_family = AF_LINK;
 
-    if (ioctl(sock, SIOCSIFADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFADDR, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
+    invalidateRecord();
     return true;
   }
 
   bool Interface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::destroy");
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       if (pImpl) {
         pImpl->lastError = "Failed to create socket";
@@ -855,94 +923,162 @@ namespace libfreebsdnet::interface {
     }
     ifr.ifr_name[IFNAMSIZ - 1] = '\0';
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       if (pImpl) {
         pImpl->lastError =
             "Failed to destroy interface: " + std::string(strerror(errno));
       }
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  MediaInfo Interface::getMediaInfo() const {
-    MediaInfo info;
-    info.type = MediaType::UNKNOWN;
-    info.subtype = MediaSubtype::UNKNOWN;
-    info.isActive = false;
+  namespace {
+
+    struct SubtypeEntry {
+      int ifm;
+      MediaSubtype subtype;
+      const char *name;
+    };
+
+    // Ethernet subtypes; names follow ifconfig
+    constexpr SubtypeEntry ethernetSubtypes[] = {
+        {IFM_10_T, MediaSubtype::ETHERNET_10_T, "10baseT"},
+        {IFM_10_2, MediaSubtype::ETHERNET_10_2, "10base2"},
+        {IFM_10_5, MediaSubtype::ETHERNET_10_5, "10base5"},
+        {IFM_100_TX, MediaSubtype::ETHERNET_100_TX, "100baseTX"},
+        {IFM_100_FX, MediaSubtype::ETHERNET_100_FX, "100baseFX"},
+        {IFM_1000_T, MediaSubtype::ETHERNET_1000_T, "1000baseT"},
+        {IFM_1000_SX, MediaSubtype::ETHERNET_1000_SX, "1000baseSX"},
+        {IFM_1000_LX, MediaSubtype::ETHERNET_1000_LX, "1000baseLX"},
+        {IFM_10G_T, MediaSubtype::ETHERNET_10G_T, "10GbaseT"},
+        {IFM_10G_SR, MediaSubtype::ETHERNET_10G_SR, "10GbaseSR"},
+        {IFM_10G_LR, MediaSubtype::ETHERNET_10G_LR, "10GbaseLR"},
+        {IFM_2500_T, MediaSubtype::ETHERNET_2500_T, "2500baseT"},
+        {IFM_5000_T, MediaSubtype::ETHERNET_5000_T, "5000baseT"},
+        {IFM_25G_CR, MediaSubtype::ETHERNET_25G_CR, "25GBase-CR"},
+        {IFM_25G_KR, MediaSubtype::ETHERNET_25G_KR, "25GBase-KR"},
+        {IFM_25G_SR, MediaSubtype::ETHERNET_25G_SR, "25GBase-SR"},
+        {IFM_25G_LR, MediaSubtype::ETHERNET_25G_LR, "25GBase-LR"},
+        {IFM_40G_CR4, MediaSubtype::ETHERNET_40G_CR4, "40GBase-CR4"},
+        {IFM_40G_SR4, MediaSubtype::ETHERNET_40G_SR4, "40GBase-SR4"},
+        {IFM_40G_LR4, MediaSubtype::ETHERNET_40G_LR4, "40GBase-LR4"},
+        {IFM_40G_KR4, MediaSubtype::ETHERNET_40G_KR4, "40GBase-KR4"},
+        {IFM_50G_CR2, MediaSubtype::ETHERNET_50G_CR2, "50GBase-CR2"},
+        {IFM_50G_KR2, MediaSubtype::ETHERNET_50G_KR2, "50GBase-KR2"},
+        {IFM_50G_SR2, MediaSubtype::ETHERNET_50G_SR2, "50GBase-SR2"},
+        {IFM_50G_LR2, MediaSubtype::ETHERNET_50G_LR2, "50GBase-LR2"},
+        {IFM_100G_CR4, MediaSubtype::ETHERNET_100G_CR4, "100GBase-CR4"},
+        {IFM_100G_SR4, MediaSubtype::ETHERNET_100G_SR4, "100GBase-SR4"},
+        {IFM_100G_KR4, MediaSubtype::ETHERNET_100G_KR4, "100GBase-KR4"},
+        {IFM_100G_LR4, MediaSubtype::ETHERNET_100G_LR4, "100GBase-LR4"},
+        {IFM_200G_SR4, MediaSubtype::ETHERNET_200G_SR4, "200GBase-SR4"},
+        {IFM_200G_LR4, MediaSubtype::ETHERNET_200G_LR4, "200GBase-LR4"},
+        {IFM_200G_DR4, MediaSubtype::ETHERNET_200G_DR4, "200GBase-DR4"},
+        {IFM_200G_FR4, MediaSubtype::ETHERNET_200G_FR4, "200GBase-FR4"},
+        {IFM_400G_FR8, MediaSubtype::ETHERNET_400G_FR8, "400GBase-FR8"},
+        {IFM_400G_LR8, MediaSubtype::ETHERNET_400G_LR8, "400GBase-LR8"},
+        {IFM_400G_DR4, MediaSubtype::ETHERNET_400G_DR4, "400GBase-DR4"},
+    };
+
+    MediaSubtype toMediaSubtype(int word) {
+      if (IFM_TYPE(word) != IFM_ETHER) {
+        return MediaSubtype::UNKNOWN;
+      }
+      int subtype = IFM_SUBTYPE(word);
+      for (const auto &entry : ethernetSubtypes) {
+        if (entry.ifm == subtype) {
+          return entry.subtype;
+        }
+      }
+      return MediaSubtype::UNKNOWN;
+    }
+
+    // Media lists rarely exceed this, so one call usually suffices
+    constexpr int INLINE_MEDIA_WORDS = 64;
+
+  } // namespace
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  const char *mediaSubtypeName(MediaSubtype subtype) {
+    for (const auto &entry : ethernetSubtypes) {
+      if (entry.subtype == subtype) {
+        return entry.name;
+      }
+    }
+    return "unknown";
+  }
+
+  types::NetResult<MediaSnapshot> readMediaSnapshot(const std::string &name) {
+    LIBFREEBSDNET_METRICS_OPERATION("readMediaSnapshot");
+    if (name.empty() || name.size() >= IFNAMSIZ) {
+      return std::unexpected(types::NetError{
+          types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0,
+          "readMediaSnapshot"});
+    }
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
-      return info;
+      return std::unexpected(types::NetError::fromErrno("readMediaSnapshot"));
     }
 
     struct ifmediareq ifmr;
     std::memset(&ifmr, 0, sizeof(ifmr));
-    std::strncpy(ifmr.ifm_name, getName().c_str(), IFNAMSIZ - 1);
-
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
-      return info;
+    std::strncpy(ifmr.ifm_name, name.c_str(), IFNAMSIZ - 1);
+
+    // The extended request reports 25G and faster media, which do not fit
+    // the legacy word layout
+    std::array<int, INLINE_MEDIA_WORDS> buffer{};
+    std::vector<int> heap;
+    ifmr.ifm_ulist = buffer.data();
+    ifmr.ifm_count = INLINE_MEDIA_WORDS;
+    int *list = buffer.data();
+
+    unsigned long request = SIOCGIFXMEDIA;
+    int result = metrics::tracedIoctl(sock, request, &ifmr);
+    if (result < 0 &&
+        (errno == EINVAL || errno == ENOTTY || errno == EOPNOTSUPP)) {
+      // vlan, lagg, epair, vtnet and many mii drivers answer only the
+      // legacy request; fall back as ifconfig does
+      request = SIOCGIFMEDIA;
+      ifmr.ifm_ulist = buffer.data();
+      ifmr.ifm_count = INLINE_MEDIA_WORDS;
+      result = metrics::tracedIoctl(sock, request, &ifmr);
+    }
+    if (result < 0) {
+      if (errno != E2BIG) {
+        return std::unexpected(
+            types::NetError::fromErrno("readMediaSnapshot", request));
+      }
+      // Too long for the stack buffer: the kernel copies nothing out on
+      // E2BIG, so ask for the count alone, then fetch
+      ifmr.ifm_ulist = nullptr;
+      ifmr.ifm_count = 0;
+      if (metrics::tracedIoctl(sock, request, &ifmr) < 0) {
+        return std::unexpected(
+            types::NetError::fromErrno("readMediaSnapshot", request));
+      }
+      heap.resize(ifmr.ifm_count);
+      ifmr.ifm_ulist = heap.data();
+      if (metrics::tracedIoctl(sock, request, &ifmr) < 0) {
+        return std::unexpected(
+            types::NetError::fromErrno("readMediaSnapshot", request));
+      }
+      list = heap.data();
     }
 
-    close(sock);
+    MediaSnapshot snapshot;
+    snapshot.name = name;
+    snapshot.current = ifmr.ifm_current;
+    snapshot.active = ifmr.ifm_active;
+    snapshot.status = ifmr.ifm_status;
+    snapshot.supported.assign(list, list + std::max(ifmr.ifm_count, 0));
+    snapshot.activeSubtype = toMediaSubtype(ifmr.ifm_active);
 
-    // Media type
+    MediaInfo &info = snapshot.info;
     if (IFM_TYPE(ifmr.ifm_current) == IFM_ETHER) {
       info.type = MediaType::ETHERNET;
     }
-
-    // Media subtype
-    int subtype = IFM_SUBTYPE(ifmr.ifm_current);
-    switch (subtype) {
-    case IFM_10_T:
-      info.subtype = MediaSubtype::ETHERNET_10_T;
-      break;
-    case IFM_10_2:
-      info.subtype = MediaSubtype::ETHERNET_10_2;
-      break;
-    case IFM_10_5:
-      info.subtype = MediaSubtype::ETHERNET_10_5;
-      break;
-    case IFM_100_TX:
-      info.subtype = MediaSubtype::ETHERNET_100_TX;
-      break;
-    case IFM_100_FX:
-      info.subtype = MediaSubtype::ETHERNET_100_FX;
-      break;
-    case IFM_1000_T:
-      info.subtype = MediaSubtype::ETHERNET_1000_T;
-      break;
-    case IFM_1000_SX:
-      info.subtype = MediaSubtype::ETHERNET_1000_SX;
-      break;
-    case IFM_1000_LX:
-      info.subtype = MediaSubtype::ETHERNET_1000_LX;
-      break;
-    case IFM_10G_T:
-      info.subtype = MediaSubtype::ETHERNET_10G_T;
-      break;
-    case IFM_10G_SR:
-      info.subtype = MediaSubtype::ETHERNET_10G_SR;
-      break;
-    case IFM_10G_LR:
-      info.subtype = MediaSubtype::ETHERNET_10G_LR;
-      break;
-    case IFM_2500_T:
-      info.subtype = MediaSubtype::ETHERNET_2500_T;
-      break;
-    case IFM_5000_T:
-      info.subtype = MediaSubtype::ETHERNET_5000_T;
-      break;
-    default:
-      info.subtype = MediaSubtype::UNKNOWN;
-      break;
-    }
-
-    // Media options
+    info.subtype = toMediaSubtype(ifmr.ifm_current);
     if (ifmr.ifm_current & IFM_AUTO) {
       info.options.push_back(MediaOption::AUTO_SELECT);
     }
@@ -951,44 +1087,37 @@ namespace libfreebsdnet::interface {
     } else if (ifmr.ifm_current & IFM_HDX) {
       info.options.push_back(MediaOption::HALF_DUPLEX);
     }
-
-    // Status
     if (ifmr.ifm_status & IFM_AVALID) {
       info.isActive = (ifmr.ifm_status & IFM_ACTIVE) != 0;
     }
+    return snapshot;
+  }
 
-    return info;
+  types::NetResult<MediaSnapshot> Interface::getMediaSnapshot() const {
+    if (!pImpl) {
+      return std::unexpected(types::NetError{types::NetErrorCode::NOT_FOUND,
+                                             ENXIO, 0,
+                                             "Interface::getMediaSnapshot"});
+    }
+    return readMediaSnapshot(pImpl->name);
+  }
+
+  MediaInfo Interface::getMediaInfo() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getMediaInfo");
+    auto snapshot = getMediaSnapshot();
+    if (!snapshot) {
+      return MediaInfo{MediaType::UNKNOWN, MediaSubtype::UNKNOWN, {}, false};
+    }
+    return std::move(snapshot->info);
   }
 
   std::vector<Capability> Interface::getCapabilityList() const {
-    std::vector<Capability> caps;
-    uint32_t capFlags = getCapabilities();
-
-    if (capFlags & IFCAP_RXCSUM)
-      caps.push_back(Capability::RXCSUM);
-    if (capFlags & IFCAP_TXCSUM)
-      caps.push_back(Capability::TXCSUM);
-    if (capFlags & IFCAP_VLAN_MTU)
-      caps.push_back(Capability::VLAN_MTU);
-    if (capFlags & IFCAP_VLAN_HWTAGGING)
-      caps.push_back(Capability::VLAN_HWTAGGING);
-    if (capFlags & IFCAP_VLAN_HWCSUM)
-      caps.push_back(Capability::VLAN_HWCSUM);
-    if (capFlags & IFCAP_WOL_MAGIC)
-      caps.push_back(Capability::WOL_MAGIC);
-    if (capFlags & IFCAP_LINKSTATE)
-      caps.push_back(Capability::LINKSTATE);
-    if (capFlags & IFCAP_TSO4)
-      caps.push_back(Capability::TSO4);
-    if (capFlags & IFCAP_TSO6)
-      caps.push_back(Capability::TSO6);
-    if (capFlags & IFCAP_LRO)
-      caps.push_back(Capability::LRO);
-
-    return caps;
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getCapabilityList");
+    return capabilitiesFromBits(getCapabilities());
   }
 
   std::vector<Flag> Interface::getFlags() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Interface::getFlags");
     std::vector<Flag> flags;
     int flagBits = pImpl ? pImpl->flags : 0;
 
@@ -0,0 +1,346 @@
+/**
+ * @file interface/bpf.cpp
+ * @brief BPF capture class implementation
+ * @details Zero-copy and buffered BPF reads with in-place record iteration
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <interface/bpf.hpp>
+#include <metrics/probes.hpp>
+#include <net/if.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace libfreebsdnet::interface {
+
+  class BpfCapture::Impl {
+  public:
+    BpfOptions options;
+    int fd = -1;
+    bool zeroCopy = false;
+    size_t bufferSize = 0;
+    int dataLinkType = -1;
+
+    // Zero-copy: two shared buffers handed back and forth by generation
+    std::array<void *, 2> zbuf = {MAP_FAILED, MAP_FAILED};
+    size_t next = 0;
+
+    // Buffered: one read() per kernel hold buffer
+    std::vector<uint8_t> buffer;
+
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t buffers = 0;
+    std::string lastError;
+
+    explicit Impl(const BpfOptions &opts) : options(opts) {}
+
+    ~Impl() { close(); }
+
+    bool open(const std::string &interface) {
+      close();
+      fd = ::open("/dev/bpf", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+      if (fd < 0) {
+        lastError = "Failed to open /dev/bpf: " + std::string(strerror(errno));
+        return false;
+      }
+
+      // Buffer mode must be chosen before the interface is attached
+      if (!(options.zeroCopy && setupZeroCopy()) && !setupBuffered()) {
+        close();
+        return false;
+      }
+
+      struct ifreq ifr;
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+      if (metrics::tracedIoctl(fd, BIOCSETIF, &ifr) < 0) {
+        lastError = "Failed to attach to " + interface + ": " +
+                    strerror(errno);
+        close();
+        return false;
+      }
+      u_int immediate = options.immediate ? 1 : 0;
+      if (metrics::tracedIoctl(fd, BIOCIMMEDIATE, &immediate) < 0) {
+        lastError = "Failed to set immediate mode: " +
+                    std::string(strerror(errno));
+        close();
+        return false;
+      }
+      u_int dlt = 0;
+      dataLinkType = metrics::tracedIoctl(fd, BIOCGDLT, &dlt) == 0
+                         ? static_cast<int>(dlt)
+                         : -1;
+      return true;
+    }
+
+    void close() {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+      for (void *&zb : zbuf) {
+        if (zb != MAP_FAILED) {
+          munmap(zb, bufferSize);
+          zb = MAP_FAILED;
+        }
+      }
+      buffer.clear();
+      buffer.shrink_to_fit();
+      zeroCopy = false;
+      next = 0;
+      dataLinkType = -1;
+    }
+
+    size_t read(const RecordVisitor &visitor,
+                std::chrono::milliseconds timeout) {
+      if (fd < 0) {
+        lastError = "Capture not open";
+        return 0;
+      }
+      return zeroCopy ? readZeroCopy(visitor, timeout)
+                      : readBuffered(visitor, timeout);
+    }
+
+  private:
+    bool setupZeroCopy() {
+      u_int mode = BPF_BUFMODE_ZBUF;
+      if (metrics::tracedIoctl(fd, BIOCSETBUFMODE, &mode) < 0) {
+        return false; // net.bpf.zerocopy_enable=0
+      }
+      size_t zmax = 0;
+      size_t page = static_cast<size_t>(getpagesize());
+      size_t size = 0;
+      if (metrics::tracedIoctl(fd, BIOCGETZMAX, &zmax) == 0) {
+        size = std::min(options.bufferSize, zmax) / page * page;
+      }
+      bool mapped = size > 0;
+      for (void *&zb : zbuf) {
+        if (mapped) {
+          zb = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_ANON | MAP_PRIVATE, -1, 0);
+          mapped = zb != MAP_FAILED;
+        }
+      }
+      struct bpf_zbuf zb = {zbuf[0], zbuf[1], size};
+      if (mapped && metrics::tracedIoctl(fd, BIOCSETZBUF, &zb) == 0) {
+        bufferSize = size;
+        zeroCopy = true;
+        return true;
+      }
+
+      for (void *&buf : zbuf) {
+        if (buf != MAP_FAILED) {
+          munmap(buf, size);
+          buf = MAP_FAILED;
+        }
+      }
+      mode = BPF_BUFMODE_BUFFER;
+      metrics::tracedIoctl(fd, BIOCSETBUFMODE, &mode);
+      return false;
+    }
+
+    bool setupBuffered() {
+      u_int length = static_cast<u_int>(options.bufferSize);
+      if (metrics::tracedIoctl(fd, BIOCSBLEN, &length) < 0) {
+        lastError = "Failed to set buffer size: " +
+                    std::string(strerror(errno));
+        return false;
+      }
+      bufferSize = length;
+      buffer.resize(length);
+      return true;
+    }
+
+    size_t visit(const uint8_t *data, size_t length,
+                 const RecordVisitor &visitor) {
+      size_t count = 0;
+      size_t offset = 0;
+      while (length - offset >= sizeof(struct bpf_hdr)) {
+        const auto *header =
+            reinterpret_cast<const struct bpf_hdr *>(data + offset);
+        size_t end = static_cast<size_t>(header->bh_hdrlen) +
+                     header->bh_caplen;
+        if (end > length - offset) {
+          break;
+        }
+        if (visitor) {
+          BpfRecord record;
+          record.timestamp =
+              std::chrono::system_clock::time_point(
+                  std::chrono::seconds(header->bh_tstamp.tv_sec) +
+                  std::chrono::microseconds(header->bh_tstamp.tv_usec));
+          record.wireLength = header->bh_datalen;
+          record.data = {data + offset + header->bh_hdrlen,
+                         header->bh_caplen};
+          visitor(record);
+        }
+        bytes += header->bh_caplen;
+        ++count;
+        offset += BPF_WORDALIGN(end);
+      }
+      records += count;
+      ++buffers;
+      return count;
+    }
+
+    // Visit every buffer the kernel has handed over, oldest first
+    size_t drainZeroCopy(const RecordVisitor &visitor, bool &any) {
+      size_t count = 0;
+      for (int i = 0; i < 2; ++i) {
+        auto *header = static_cast<struct bpf_zbuf_header *>(zbuf[next]);
+        if (header->bzh_kernel_gen == header->bzh_user_gen) {
+          break;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto *data = reinterpret_cast<const uint8_t *>(header + 1);
+        size_t length = std::min<size_t>(
+            header->bzh_kernel_len, bufferSize - sizeof(*header));
+        count += visit(data, length, visitor);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->bzh_user_gen = header->bzh_kernel_gen;
+        next ^= 1;
+        any = true;
+      }
+      return count;
+    }
+
+    size_t readZeroCopy(const RecordVisitor &visitor,
+                        std::chrono::milliseconds timeout) {
+      bool any = false;
+      size_t count = drainZeroCopy(visitor, any);
+      if (any) {
+        return count;
+      }
+      struct pollfd pfd = {fd, POLLIN, 0};
+      int ready = poll(&pfd, 1, static_cast<int>(timeout.count()));
+      if (ready < 0) {
+        lastError = "poll failed: " + std::string(strerror(errno));
+        return 0;
+      }
+      if (ready == 0) {
+        // Hand over the partially filled store buffer
+        struct bpf_zbuf rotated;
+        if (metrics::tracedIoctl(fd, BIOCROTZBUF, &rotated) < 0) {
+          lastError = "Failed to rotate buffers: " +
+                      std::string(strerror(errno));
+          return 0;
+        }
+      }
+      return drainZeroCopy(visitor, any);
+    }
+
+    size_t readBuffered(const RecordVisitor &visitor,
+                        std::chrono::milliseconds timeout) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, static_cast<int>(timeout.count())) < 0) {
+        lastError = "poll failed: " + std::string(strerror(errno));
+        return 0;
+      }
+      // Non-blocking reads also return a partially filled store buffer
+      ssize_t n = ::read(fd, buffer.data(), buffer.size());
+      if (n < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+          lastError = "read failed: " + std::string(strerror(errno));
+        }
+        return 0;
+      }
+      return n > 0 ? visit(buffer.data(), static_cast<size_t>(n), visitor)
+                   : 0;
+    }
+  };
+
+  BpfCapture::BpfCapture(const BpfOptions &options)
+      : pImpl(std::make_unique<Impl>(options)) {}
+
+  BpfCapture::~BpfCapture() = default;
+
+  bool BpfCapture::open(const std::string &interface) {
+    return pImpl->open(interface);
+  }
+
+  void BpfCapture::close() { pImpl->close(); }
+
+  bool BpfCapture::isOpen() const { return pImpl->fd >= 0; }
+
+  bool BpfCapture::isZeroCopy() const { return pImpl->zeroCopy; }
+
+  size_t BpfCapture::getBufferSize() const { return pImpl->bufferSize; }
+
+  int BpfCapture::getDataLinkType() const { return pImpl->dataLinkType; }
+
+  int BpfCapture::getFd() const { return pImpl->fd; }
+
+  bool BpfCapture::setFilter(std::span<const struct bpf_insn> program) {
+    if (pImpl->fd < 0) {
+      pImpl->lastError = "Capture not open";
+      return false;
+    }
+    std::vector<struct bpf_insn> copy(program.begin(), program.end());
+    struct bpf_program filter;
+    filter.bf_len = static_cast<u_int>(copy.size());
+    filter.bf_insns = copy.empty() ? nullptr : copy.data();
+    if (metrics::tracedIoctl(pImpl->fd, BIOCSETF, &filter) < 0) {
+      pImpl->lastError = "Failed to set filter: " +
+                         std::string(strerror(errno));
+      return false;
+    }
+    return true;
+  }
+
+  bool BpfCapture::parseProgram(const std::string &text,
+                                std::vector<struct bpf_insn> &program) {
+    program.clear();
+    std::istringstream input(text);
+    size_t count = 0;
+    if (!(input >> count) || count == 0) {
+      return false;
+    }
+    program.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      unsigned int code = 0, jt = 0, jf = 0;
+      uint32_t k = 0;
+      if (!(input >> code >> jt >> jf >> k) || code > 0xffff || jt > 0xff ||
+          jf > 0xff) {
+        program.clear();
+        return false;
+      }
+      program.push_back({static_cast<u_short>(code), static_cast<u_char>(jt),
+                         static_cast<u_char>(jf), k});
+    }
+    return true;
+  }
+
+  size_t BpfCapture::read(const RecordVisitor &visitor,
+                          std::chrono::milliseconds timeout) {
+    return pImpl->read(visitor, timeout);
+  }
+
+  BpfCaptureStats BpfCapture::getStats() const {
+    BpfCaptureStats stats;
+    stats.records = pImpl->records;
+    stats.bytes = pImpl->bytes;
+    stats.buffers = pImpl->buffers;
+    struct bpf_stat kernel;
+    if (pImpl->fd >= 0 &&
+        metrics::tracedIoctl(pImpl->fd, BIOCGSTATS, &kernel) == 0) {
+      stats.received = kernel.bs_recv;
+      stats.dropped = kernel.bs_drop;
+    }
+    return stats;
+  }
+
+  std::string BpfCapture::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
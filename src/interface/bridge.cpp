@@ -14,7 +14,10 @@
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/bridge.hpp>
-#include <jail.h>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <interface/vnetmanager.hpp>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_bridgevar.h>
@@ -30,50 +33,129 @@
 
 namespace libfreebsdnet::interface {
 
-  BridgeInterface::BridgeInterface(const std::string &name, unsigned int index,
-                                   int flags)
-      : Interface(name, index, flags) {}
+  namespace {
 
-  BridgeInterface::~BridgeInterface() = default;
+    uint32_t &confLength(struct ifbifconf &conf) { return conf.ifbic_len; }
+    uint32_t &confLength(struct ifbaconf &conf) { return conf.ifbac_len; }
 
-  std::string BridgeInterface::getName() const { return Interface::getName(); }
-
-  unsigned int BridgeInterface::getIndex() const {
-    return Interface::getIndex();
-  }
+    void setConfBuffer(struct ifbifconf &conf, void *buf) {
+      conf.ifbic_buf = static_cast<caddr_t>(buf);
+    }
 
-  InterfaceType BridgeInterface::getType() const {
-    return InterfaceType::BRIDGE;
-  }
+    void setConfBuffer(struct ifbaconf &conf, void *buf) {
+      conf.ifbac_buf = static_cast<caddr_t>(buf);
+    }
 
-  std::vector<Flag> BridgeInterface::getFlags() const {
-    return Interface::getFlags();
-  }
+    // Far above any real member list or address cache, which the kernel
+    // bounds with net.link.bridge's ifbrp_csize
+    constexpr size_t MAX_LIST_ENTRIES = size_t{1} << 22;
 
-  bool BridgeInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-
-  bool BridgeInterface::bringUp() { return Interface::bringUp(); }
+    // Run a BRDG* list request. A zero-length request reports the size
+    // needed where the kernel supports it (BRDGGIFS, not BRDGRTS); a full
+    // reply may be truncated, so the buffer is doubled until one comes
+    // back with room to spare, as ifconfig does.
+    template <typename Conf, typename Entry>
+    bool fetchList(const std::string &bridge, unsigned long cmd,
+                   std::vector<Entry> &entries, std::string &error) {
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        error = "Failed to get control socket";
+        return false;
+      }
 
-  bool BridgeInterface::bringDown() { return Interface::bringDown(); }
+      struct ifdrv ifd;
+      std::memset(&ifd, 0, sizeof(ifd));
+      std::strncpy(ifd.ifd_name, bridge.c_str(), IFNAMSIZ - 1);
+      ifd.ifd_cmd = cmd;
+
+      Conf conf;
+      std::memset(&conf, 0, sizeof(conf));
+      ifd.ifd_len = sizeof(conf);
+      ifd.ifd_data = &conf;
+      if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) < 0) {
+        error = "Failed to query bridge list size: " +
+                std::string(strerror(errno));
+        return false;
+      }
 
-  bool BridgeInterface::isUp() const { return Interface::isUp(); }
+      size_t count = confLength(conf) / sizeof(Entry);
+      size_t capacity = std::max<size_t>(count + count / 8, 64);
+      for (; capacity <= MAX_LIST_ENTRIES; capacity *= 2) {
+        entries.resize(capacity);
+        confLength(conf) = static_cast<uint32_t>(capacity * sizeof(Entry));
+        setConfBuffer(conf, entries.data());
+        if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) < 0) {
+          error = "Failed to read bridge list: " + std::string(strerror(errno));
+          entries.clear();
+          return false;
+        }
+        count = confLength(conf) / sizeof(Entry);
+        if (count < capacity) {
+          entries.resize(count);
+          return true;
+        }
+      }
+      error = "Bridge list too large: more than " +
+              std::to_string(MAX_LIST_ENTRIES) + " entries";
+      entries.clear();
+      return false;
+    }
 
-  int BridgeInterface::getMtu() const { return Interface::getMtu(); }
+    // Issue one per-member BRDG* request; returns an errno value
+    int memberRequest(int sock, const std::string &bridge, unsigned long cmd,
+                      struct ifbreq &req) {
+      struct ifdrv ifd;
+      std::memset(&ifd, 0, sizeof(ifd));
+      std::strncpy(ifd.ifd_name, bridge.c_str(), IFNAMSIZ - 1);
+      ifd.ifd_cmd = cmd;
+      ifd.ifd_len = sizeof(req);
+      ifd.ifd_data = &req;
+      return metrics::tracedIoctl(sock, SIOCSDRVSPEC, &ifd) < 0 ? errno : 0;
+    }
+
+    std::vector<BridgeMemberResult>
+    memberBatch(const std::string &bridge, unsigned long cmd,
+                std::span<const std::string> names) {
+      std::vector<BridgeMemberResult> results;
+      results.reserve(names.size());
+      int sock = ControlSocket::get(AF_INET);
+      for (const auto &name : names) {
+        BridgeMemberResult result{name, EBADF};
+        if (sock >= 0 && name.size() < IFNAMSIZ) {
+          struct ifbreq req;
+          std::memset(&req, 0, sizeof(req));
+          std::strncpy(req.ifbr_ifsname, name.c_str(), IFNAMSIZ - 1);
+          result.error = memberRequest(sock, bridge, cmd, req);
+        } else if (sock >= 0) {
+          result.error = ENAMETOOLONG;
+        }
+        results.push_back(std::move(result));
+      }
+      return results;
+    }
 
-  bool BridgeInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
+    bool allSucceeded(const std::vector<BridgeMemberResult> &results,
+                      std::string &error) {
+      for (const auto &result : results) {
+        if (!result.succeeded()) {
+          error = "Failed on bridge member " + result.name + ": " +
+                  std::string(strerror(result.error));
+          return false;
+        }
+      }
+      return true;
+    }
 
-  std::string BridgeInterface::getLastError() const {
-    return Interface::getLastError();
-  }
+  } // namespace
 
-  int BridgeInterface::getFib() const { return Interface::getFib(); }
+  BridgeInterface::BridgeInterface(const std::string &name, unsigned int index,
+                                   int flags)
+      : InterfaceBase(name, index, flags) {}
 
-  bool BridgeInterface::setFib(int fib) { return Interface::setFib(fib); }
+  BridgeInterface::~BridgeInterface() = default;
 
   bool BridgeInterface::addInterface(const std::string &interfaceName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -90,19 +172,17 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifbr.ifbr_ifsname, interfaceName.c_str(), IFNAMSIZ - 1);
     ifd.ifd_data = &ifbr;
 
-    if (ioctl(sock, SIOCSDRVSPEC, &ifd) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSDRVSPEC, &ifd) < 0) {
       pImpl->lastError =
           "Failed to add interface to bridge: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::removeInterface(const std::string &interfaceName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -119,21 +199,102 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifbr.ifbr_ifsname, interfaceName.c_str(), IFNAMSIZ - 1);
     ifd.ifd_data = &ifbr;
 
-    if (ioctl(sock, SIOCSDRVSPEC, &ifd) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSDRVSPEC, &ifd) < 0) {
       pImpl->lastError = "Failed to remove interface from bridge: " +
                          std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::vector<std::string> BridgeInterface::getInterfaces() const {
-    // Bridge interface enumeration requires complex FreeBSD ioctls
-    // For now, return empty list
-    return {};
+    std::vector<std::string> names;
+    for (auto &member : getMembers()) {
+      names.push_back(std::move(member.name));
+    }
+    return names;
+  }
+
+  std::vector<BridgeMember> BridgeInterface::getMembers() const {
+    std::vector<struct ifbreq> requests;
+    if (!fetchList<struct ifbifconf>(getName(), BRDGGIFS, requests,
+                                     pImpl->lastError)) {
+      return {};
+    }
+
+    // One name table for all members; if_nametoindex() walks every
+    // interface on each call
+    std::vector<std::pair<std::string, unsigned int>> indexes;
+    if (struct if_nameindex *list = if_nameindex()) {
+      for (struct if_nameindex *it = list; it->if_index != 0; ++it) {
+        indexes.emplace_back(it->if_name, it->if_index);
+      }
+      if_freenameindex(list);
+    }
+
+    std::vector<BridgeMember> members;
+    members.reserve(requests.size());
+    for (const auto &req : requests) {
+      BridgeMember member;
+      member.name.assign(req.ifbr_ifsname,
+                         strnlen(req.ifbr_ifsname, IFNAMSIZ));
+      for (const auto &[name, index] : indexes) {
+        if (name == member.name) {
+          member.index = index;
+          break;
+        }
+      }
+      member.flags = req.ifbr_ifsflags;
+      member.pathCost = req.ifbr_path_cost;
+      member.portNumber = req.ifbr_portno;
+      member.priority = req.ifbr_priority;
+      member.state = req.ifbr_state;
+      member.role = req.ifbr_role;
+      member.addressCount = req.ifbr_addrcnt;
+      member.addressMax = req.ifbr_addrmax;
+      members.push_back(std::move(member));
+    }
+    return members;
+  }
+
+  bool BridgeInterface::getAddressCache(
+      std::vector<BridgeAddress> &addresses) const {
+    addresses.clear();
+
+    // Members are few; resolve each name once rather than per entry
+    std::vector<BridgeMember> members = getMembers();
+
+    std::vector<struct ifbareq> requests;
+    if (!fetchList<struct ifbaconf>(getName(), BRDGRTS, requests,
+                                    pImpl->lastError)) {
+      return false;
+    }
+
+    addresses.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      const struct ifbareq &req = requests[i];
+      BridgeAddress &entry = addresses[i];
+      entry.mac.setBytes(req.ifba_dst);
+      entry.vlan = req.ifba_vlan;
+      entry.flags = req.ifba_flags;
+      entry.expire = req.ifba_expire;
+      entry.member = 0;
+      for (const auto &member : members) {
+        if (std::strncmp(member.name.c_str(), req.ifba_ifsname, IFNAMSIZ) ==
+            0) {
+          entry.member = member.index;
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  std::vector<BridgeAddress> BridgeInterface::getAddressCache() const {
+    std::vector<BridgeAddress> addresses;
+    getAddressCache(addresses);
+    return addresses;
   }
 
   bool BridgeInterface::hasInterface(const std::string &interfaceName) const {
@@ -142,41 +303,118 @@ namespace libfreebsdnet::interface {
            interfaces.end();
   }
 
+  std::vector<BridgeMemberResult> BridgeInterface::addInterfaces(
+      std::span<const std::string> interfaceNames) {
+    auto results = memberBatch(getName(), BRDGADD, interfaceNames);
+    allSucceeded(results, pImpl->lastError);
+    return results;
+  }
+
+  std::vector<BridgeMemberResult> BridgeInterface::removeInterfaces(
+      std::span<const std::string> interfaceNames) {
+    auto results = memberBatch(getName(), BRDGDEL, interfaceNames);
+    allSucceeded(results, pImpl->lastError);
+    return results;
+  }
+
+  std::vector<BridgeMemberResult> BridgeInterface::configureMembers(
+      std::span<const BridgeMemberSettings> settings) {
+    std::vector<BridgeMemberResult> results;
+    results.reserve(settings.size());
+    std::vector<BridgeMember> members = getMembers();
+    int sock = ControlSocket::get(AF_INET);
+
+    for (const auto &setting : settings) {
+      BridgeMemberResult result{setting.name, 0};
+      auto member = std::find_if(
+          members.begin(), members.end(),
+          [&](const BridgeMember &m) { return m.name == setting.name; });
+      if (sock < 0) {
+        result.error = EBADF;
+      } else if (member == members.end()) {
+        result.error = ENOENT;
+      }
+
+      struct ifbreq req;
+      std::memset(&req, 0, sizeof(req));
+      if (result.succeeded()) {
+        std::strncpy(req.ifbr_ifsname, setting.name.c_str(), IFNAMSIZ - 1);
+        uint32_t flags =
+            (member->flags | setting.setFlags) & ~setting.clearFlags;
+        if (flags != member->flags) {
+          req.ifbr_ifsflags = flags;
+          result.error = memberRequest(sock, getName(), BRDGSIFFLGS, req);
+          if (result.succeeded()) {
+            member->flags = flags;
+          }
+        }
+      }
+      if (result.succeeded() && setting.pathCost &&
+          *setting.pathCost != member->pathCost) {
+        req.ifbr_path_cost = *setting.pathCost;
+        result.error = memberRequest(sock, getName(), BRDGSIFCOST, req);
+      }
+      if (result.succeeded() && setting.priority &&
+          *setting.priority != member->priority) {
+        req.ifbr_priority = *setting.priority;
+        result.error = memberRequest(sock, getName(), BRDGSIFPRIO, req);
+      }
+      results.push_back(std::move(result));
+    }
+
+    allSucceeded(results, pImpl->lastError);
+    return results;
+  }
+
+  std::vector<BridgeMemberResult>
+  BridgeInterface::setStp(std::span<const std::string> interfaceNames,
+                          bool enable) {
+    // Span ports take no part in spanning tree and the kernel rejects
+    // flag changes on them, so like ifconfig they are left as they are
+    std::vector<BridgeMember> members = getMembers();
+    std::vector<BridgeMemberSettings> settings;
+    settings.reserve(interfaceNames.size());
+    for (const auto &name : interfaceNames) {
+      BridgeMemberSettings setting;
+      setting.name = name;
+      auto member = std::find_if(
+          members.begin(), members.end(),
+          [&](const BridgeMember &m) { return m.name == name; });
+      if (member == members.end() || !(member->flags & IFBIF_SPAN)) {
+        (enable ? setting.setFlags : setting.clearFlags) = IFBIF_STP;
+      }
+      settings.push_back(std::move(setting));
+    }
+    return configureMembers(settings);
+  }
+
   bool BridgeInterface::enableStp() {
-    pImpl->lastError = "STP operations not implemented - requires specific "
-                       "FreeBSD bridge ioctls";
-    return false;
+    std::vector<std::string> names;
+    for (const auto &member : getMembers()) {
+      if (!(member.flags & IFBIF_SPAN)) {
+        names.push_back(member.name);
+      }
+    }
+    return allSucceeded(setStp(names, true), pImpl->lastError);
   }
 
   bool BridgeInterface::disableStp() {
-    pImpl->lastError = "STP operations not implemented - requires specific "
-                       "FreeBSD bridge ioctls";
-    return false;
+    std::vector<std::string> names;
+    for (const auto &member : getMembers()) {
+      if (!(member.flags & IFBIF_SPAN)) {
+        names.push_back(member.name);
+      }
+    }
+    return allSucceeded(setStp(names, false), pImpl->lastError);
   }
 
   bool BridgeInterface::isStpEnabled() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return false;
-    }
-
-    struct ifdrv ifd;
-    std::memset(&ifd, 0, sizeof(ifd));
-    std::strncpy(ifd.ifd_name, getName().c_str(), IFNAMSIZ - 1);
-    ifd.ifd_cmd = BRDGGIFFLGS;
-    ifd.ifd_len = sizeof(struct ifbreq);
-
-    struct ifbreq ifbr;
-    std::memset(&ifbr, 0, sizeof(ifbr));
-    ifd.ifd_data = &ifbr;
-
-    bool stpEnabled = false;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
-      stpEnabled = (ifbr.ifbr_ifsflags & IFBIF_STP) != 0;
+    for (const auto &member : getMembers()) {
+      if (member.flags & IFBIF_STP) {
+        return true;
+      }
     }
-
-    close(sock);
-    return stpEnabled;
+    return false;
   }
 
   bool BridgeInterface::setPriority(uint16_t priority) {
@@ -187,7 +425,7 @@ namespace libfreebsdnet::interface {
   }
 
   int BridgeInterface::getPriority() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -200,13 +438,12 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbropreq *ifbrop = static_cast<struct ifbropreq *>(ifd.ifd_data);
       result = ifbrop->ifbop_priority;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
@@ -218,7 +455,7 @@ namespace libfreebsdnet::interface {
   }
 
   int BridgeInterface::getAgingTime() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -234,42 +471,15 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = &param;
 
     int agingTime = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       agingTime = param.ifbrp_ctime;
     }
 
-    close(sock);
     return agingTime;
   }
 
-  int BridgeInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool BridgeInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int BridgeInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int BridgeInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> BridgeInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t BridgeInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool BridgeInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
   uint32_t BridgeInterface::getEnabledCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -278,12 +488,10 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_curcap;
   }
 
@@ -297,20 +505,8 @@ namespace libfreebsdnet::interface {
     return setCapabilities(current & ~capabilities);
   }
 
-  std::vector<std::string> BridgeInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool BridgeInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool BridgeInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
   int BridgeInterface::getVnet() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -319,33 +515,19 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifr.ifr_jid;
   }
 
   std::string BridgeInterface::getVnetJailName() const {
-    int vnetId = getVnet();
-    if (vnetId < 0) {
-      return "";
-    }
-
-    char *jailName = jail_getname(vnetId);
-    if (jailName != nullptr) {
-      std::string result(jailName);
-      free(jailName);
-      return result;
-    }
-
-    return "";
+    return VnetManager::getJailName(getVnet());
   }
 
   bool BridgeInterface::setVnet(int vnetId) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -355,17 +537,15 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
     ifr.ifr_jid = vnetId;
 
-    if (ioctl(sock, SIOCSIFVNET, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0) {
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::reclaimFromVnet() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -375,19 +555,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSIFRVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFRVNET, &ifr) < 0) {
       pImpl->lastError =
           "Failed to reclaim from VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -403,23 +581,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -429,19 +604,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -451,55 +624,20 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> BridgeInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
+  std::string BridgeInterface::getMacAddress() const {
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->linkAddress;
     }
 
-    close(sock);
-    return cloners;
-  }
-
-  std::string BridgeInterface::getMacAddress() const {
     struct ifaddrs *ifaddrs, *ifa;
     std::string macAddress = "";
 
@@ -531,7 +669,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool BridgeInterface::setMacAddress(const std::string &macAddress) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -547,7 +685,6 @@ namespace libfreebsdnet::interface {
                     "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &mac[0],
                     &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
       pImpl->lastError = "Invalid MAC address format";
-      close(sock);
       return false;
     }
 
@@ -556,19 +693,17 @@ namespace libfreebsdnet::interface {
     ifr.ifr_addr.sa_family = AF_LINK;
     ifr.ifr_addr.sa_len = 6;
 
-    if (ioctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set MAC address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool BridgeInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -579,19 +714,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   int BridgeInterface::getHelloTime() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -604,18 +737,17 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbropreq *ifbrop = static_cast<struct ifbropreq *>(ifd.ifd_data);
       result = ifbrop->ifbop_hellotime;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
   int BridgeInterface::getForwardDelay() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -628,18 +760,17 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbropreq *ifbrop = static_cast<struct ifbropreq *>(ifd.ifd_data);
       result = ifbrop->ifbop_fwddelay;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
   int BridgeInterface::getProtocol() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -652,18 +783,17 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbropreq *ifbrop = static_cast<struct ifbropreq *>(ifd.ifd_data);
       result = ifbrop->ifbop_protocol;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
   int BridgeInterface::getMaxAddresses() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -676,70 +806,27 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbrparam *ifbrp = static_cast<struct ifbrparam *>(ifd.ifd_data);
       result = ifbrp->ifbrp_csize;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
   int BridgeInterface::getInterfaceCost(
       const std::string &interfaceName) const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return -1;
-    }
-
-    // Get all bridge members using BRDGGIFS
-    struct ifbifconf members;
-    char *buf = nullptr;
-    int result = -1;
-
-    for (size_t len = 8192;
-         (buf = static_cast<char *>(realloc(buf, len))) != nullptr; len *= 2) {
-      members.ifbic_buf = buf;
-      members.ifbic_len = len;
-
-      struct ifdrv ifd;
-      std::memset(&ifd, 0, sizeof(ifd));
-      std::strncpy(ifd.ifd_name, getName().c_str(), IFNAMSIZ - 1);
-      ifd.ifd_cmd = BRDGGIFS;
-      ifd.ifd_len = sizeof(members);
-      ifd.ifd_data = &members;
-
-      if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
-        if ((members.ifbic_len + sizeof(*members.ifbic_req)) < len) {
-          break;
-        }
-      } else {
-        free(buf);
-        close(sock);
-        return -1;
+    for (const auto &member : getMembers()) {
+      if (member.name == interfaceName) {
+        return static_cast<int>(member.pathCost);
       }
     }
-
-    if (buf != nullptr) {
-      // Search for the specific interface in the member list
-      size_t member_count = members.ifbic_len / sizeof(*members.ifbic_req);
-      for (size_t i = 0; i < member_count; i++) {
-        struct ifbreq *member = &members.ifbic_req[i];
-        if (std::strcmp(member->ifbr_ifsname, interfaceName.c_str()) == 0) {
-          result = member->ifbr_path_cost;
-          break;
-        }
-      }
-      free(buf);
-    }
-
-    close(sock);
-    return result;
+    return -1;
   }
 
   int BridgeInterface::getRootPathCost() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -752,13 +839,12 @@ namespace libfreebsdnet::interface {
     ifd.ifd_data = malloc(ifd.ifd_len);
 
     int result = -1;
-    if (ioctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGDRVSPEC, &ifd) == 0) {
       struct ifbropreq *ifbrop = static_cast<struct ifbropreq *>(ifd.ifd_data);
       result = ifbrop->ifbop_root_path_cost;
     }
 
     free(ifd.ifd_data);
-    close(sock);
     return result;
   }
 
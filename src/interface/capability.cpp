@@ -0,0 +1,276 @@
+/**
+ * @file interface/capability.cpp
+ * @brief Interface capability names and offload profiles implementation
+ * @details Capability table and the SIOCSIFCAP sweep over an interface
+ * stack
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <interface/capability.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
+#include <net/if.h>
+#include <net/if_lagg.h>
+#include <net/if_vlan_var.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    struct CapabilityEntry {
+      Capability capability;
+      uint32_t bit;
+      std::string_view name;
+    };
+
+    // In Capability declaration order
+    constexpr std::array<CapabilityEntry, 32> CAPABILITIES = {{
+        {Capability::RXCSUM, IFCAP_RXCSUM, "RXCSUM"},
+        {Capability::TXCSUM, IFCAP_TXCSUM, "TXCSUM"},
+        {Capability::VLAN_MTU, IFCAP_VLAN_MTU, "VLAN_MTU"},
+        {Capability::VLAN_HWTAGGING, IFCAP_VLAN_HWTAGGING, "VLAN_HWTAGGING"},
+        {Capability::VLAN_HWCSUM, IFCAP_VLAN_HWCSUM, "VLAN_HWCSUM"},
+        {Capability::WOL_MAGIC, IFCAP_WOL_MAGIC, "WOL_MAGIC"},
+        {Capability::LINKSTATE, IFCAP_LINKSTATE, "LINKSTATE"},
+        {Capability::TSO4, IFCAP_TSO4, "TSO4"},
+        {Capability::TSO6, IFCAP_TSO6, "TSO6"},
+        {Capability::LRO, IFCAP_LRO, "LRO"},
+        {Capability::NETCONS, IFCAP_NETCONS, "NETCONS"},
+        {Capability::JUMBO_MTU, IFCAP_JUMBO_MTU, "JUMBO_MTU"},
+        {Capability::POLLING, IFCAP_POLLING, "POLLING"},
+        {Capability::WOL_UCAST, IFCAP_WOL_UCAST, "WOL_UCAST"},
+        {Capability::WOL_MCAST, IFCAP_WOL_MCAST, "WOL_MCAST"},
+        {Capability::TOE4, IFCAP_TOE4, "TOE4"},
+        {Capability::TOE6, IFCAP_TOE6, "TOE6"},
+        {Capability::VLAN_HWFILTER, IFCAP_VLAN_HWFILTER, "VLAN_HWFILTER"},
+        {Capability::NV, IFCAP_NV, "NV"},
+        {Capability::VLAN_HWTSO, IFCAP_VLAN_HWTSO, "VLAN_HWTSO"},
+        {Capability::NETMAP, IFCAP_NETMAP, "NETMAP"},
+        {Capability::RXCSUM_IPV6, IFCAP_RXCSUM_IPV6, "RXCSUM_IPV6"},
+        {Capability::TXCSUM_IPV6, IFCAP_TXCSUM_IPV6, "TXCSUM_IPV6"},
+        {Capability::HWSTATS, IFCAP_HWSTATS, "HWSTATS"},
+        {Capability::TXRTLMT, IFCAP_TXRTLMT, "TXRTLMT"},
+        {Capability::HWRXTSTMP, IFCAP_HWRXTSTMP, "HWRXTSTMP"},
+        {Capability::MEXTPG, IFCAP_MEXTPG, "MEXTPG"},
+        {Capability::TXTLS4, IFCAP_TXTLS4, "TXTLS4"},
+        {Capability::TXTLS6, IFCAP_TXTLS6, "TXTLS6"},
+        {Capability::VXLAN_HWCSUM, IFCAP_VXLAN_HWCSUM, "VXLAN_HWCSUM"},
+        {Capability::VXLAN_HWTSO, IFCAP_VXLAN_HWTSO, "VXLAN_HWTSO"},
+        {Capability::TXTLS_RTLMT, IFCAP_TXTLS_RTLMT, "TXTLS_RTLMT"},
+    }};
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+      return a.size() == b.size() &&
+             std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::toupper(static_cast<unsigned char>(x)) ==
+                      std::toupper(static_cast<unsigned char>(y));
+             });
+    }
+
+    bool readCapabilities(int sock, const std::string &name,
+                          uint32_t &supported, uint32_t &enabled) {
+      struct ifreq ifr;
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+      if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
+        return false;
+      }
+      supported = static_cast<uint32_t>(ifr.ifr_reqcap);
+      enabled = static_cast<uint32_t>(ifr.ifr_curcap);
+      return true;
+    }
+
+    int writeCapabilities(int sock, const std::string &name, uint32_t bits) {
+      struct ifreq ifr;
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+      ifr.ifr_reqcap = static_cast<int>(bits);
+      return metrics::tracedIoctl(sock, SIOCSIFCAP, &ifr) < 0 ? errno : 0;
+    }
+
+    std::vector<std::string> laggPorts(int sock, const std::string &name) {
+      std::array<struct lagg_reqport, LAGG_MAX_PORTS> ports;
+      std::memset(ports.data(), 0, sizeof(ports));
+      struct lagg_reqall ra;
+      std::memset(&ra, 0, sizeof(ra));
+      std::strncpy(ra.ra_ifname, name.c_str(), IFNAMSIZ - 1);
+      ra.ra_port = ports.data();
+      ra.ra_size = sizeof(ports);
+
+      std::vector<std::string> result;
+      if (metrics::tracedIoctl(sock, SIOCGLAGG, &ra) == 0) {
+        size_t count = std::min<size_t>(ra.ra_ports, ports.size());
+        for (size_t i = 0; i < count; ++i) {
+          result.emplace_back(ports[i].rp_portname,
+                              strnlen(ports[i].rp_portname, IFNAMSIZ));
+        }
+      }
+      return result;
+    }
+
+    std::string vlanParent(int sock, const char *name) {
+      struct vlanreq vlr;
+      std::memset(&vlr, 0, sizeof(vlr));
+      struct ifreq ifr;
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+      ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
+      if (metrics::tracedIoctl(sock, SIOCGETVLAN, &ifr) < 0) {
+        return "";
+      }
+      return std::string(vlr.vlr_parent, strnlen(vlr.vlr_parent, IFNAMSIZ));
+    }
+
+    OffloadResult applyOne(int sock, const std::string &name,
+                           const OffloadProfile &profile) {
+      OffloadResult result;
+      result.name = name;
+      uint32_t supported = 0;
+      if (!readCapabilities(sock, name, supported, result.before)) {
+        result.error = errno;
+        return result;
+      }
+
+      uint32_t requested = profile.enable | profile.disable;
+      result.unsupported = requested & ~supported;
+      uint32_t enable = profile.enable & supported;
+      uint32_t disable = profile.disable & supported & ~enable;
+      uint32_t wanted = (result.before | enable) & ~disable;
+      result.after = result.before;
+      if (wanted == result.before) {
+        return result;
+      }
+
+      int error = writeCapabilities(sock, name, wanted);
+      if (error != 0) {
+        // Find the bits the driver objects to by flipping them one by one
+        result.error = error;
+        uint32_t current = result.before;
+        for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+          if (((wanted ^ current) & bit) != 0 &&
+              writeCapabilities(sock, name, current ^ bit) == 0) {
+            current ^= bit;
+          }
+        }
+      }
+
+      // Drivers may silently adjust dependent bits, so trust the readback
+      uint32_t ignored = 0;
+      if (!readCapabilities(sock, name, ignored, result.after)) {
+        result.error = errno;
+        return result;
+      }
+      result.refused = (wanted ^ result.after) & (enable | disable);
+      if (result.refused == 0) {
+        result.error = 0;
+      }
+      return result;
+    }
+
+  } // namespace
+
+  uint32_t capabilityBit(Capability capability) {
+    return CAPABILITIES[static_cast<size_t>(capability)].bit;
+  }
+
+  std::string_view capabilityName(Capability capability) {
+    return CAPABILITIES[static_cast<size_t>(capability)].name;
+  }
+
+  bool parseCapability(std::string_view name, Capability &capability) {
+    if (equalsIgnoreCase(name, "NOMAP")) {
+      capability = Capability::MEXTPG;
+      return true;
+    }
+    for (const auto &entry : CAPABILITIES) {
+      if (equalsIgnoreCase(name, entry.name)) {
+        capability = entry.capability;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<Capability> capabilitiesFromBits(uint32_t bits) {
+    std::vector<Capability> result;
+    for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+      if (bits & bit) {
+        for (const auto &entry : CAPABILITIES) {
+          if (entry.bit == bit) {
+            result.push_back(entry.capability);
+            break;
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  OffloadProfile OffloadProfile::throughput() {
+    OffloadProfile profile;
+    profile.enable = IFCAP_RXCSUM | IFCAP_TXCSUM | IFCAP_RXCSUM_IPV6 |
+                     IFCAP_TXCSUM_IPV6 | IFCAP_TSO4 | IFCAP_TSO6 | IFCAP_LRO |
+                     IFCAP_VLAN_MTU | IFCAP_VLAN_HWTAGGING |
+                     IFCAP_VLAN_HWCSUM | IFCAP_VLAN_HWTSO |
+                     IFCAP_VLAN_HWFILTER | IFCAP_VXLAN_HWCSUM |
+                     IFCAP_VXLAN_HWTSO | IFCAP_MEXTPG | IFCAP_JUMBO_MTU;
+    return profile;
+  }
+
+  OffloadProfile OffloadProfile::forwarding() {
+    OffloadProfile profile = throughput();
+    profile.enable &= ~IFCAP_LRO;
+    profile.disable = IFCAP_LRO | IFCAP_TOE4 | IFCAP_TOE6;
+    return profile;
+  }
+
+  std::vector<OffloadResult>
+  applyOffloadProfile(const std::string &name, const OffloadProfile &profile) {
+    std::vector<OffloadResult> results;
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      OffloadResult result;
+      result.name = name;
+      result.error = errno ? errno : EBADF;
+      results.push_back(std::move(result));
+      return results;
+    }
+
+    // Lower layers first: lagg ports, then the interface itself
+    std::vector<std::string> lower = laggPorts(sock, name);
+    lower.push_back(name);
+
+    std::vector<std::string> vlans;
+    struct if_nameindex *table = if_nameindex();
+    if (table) {
+      for (struct if_nameindex *entry = table; entry->if_index != 0;
+           ++entry) {
+        std::string parent = vlanParent(sock, entry->if_name);
+        if (!parent.empty() &&
+            std::find(lower.begin(), lower.end(), parent) != lower.end()) {
+          vlans.emplace_back(entry->if_name);
+        }
+      }
+      if_freenameindex(table);
+    }
+
+    for (const auto &target : lower) {
+      results.push_back(applyOne(sock, target, profile));
+    }
+    for (const auto &target : vlans) {
+      results.push_back(applyOne(sock, target, profile));
+    }
+    return results;
+  }
+
+} // namespace libfreebsdnet::interface
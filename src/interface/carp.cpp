@@ -7,11 +7,14 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/carp.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netinet/ip_carp.h>
@@ -22,7 +25,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class CarpInterface::Impl {
+  class CarpInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -43,52 +46,66 @@ namespace libfreebsdnet::interface {
 
   CarpInterface::CarpInterface(const std::string &name, unsigned int index,
                                int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   CarpInterface::~CarpInterface() = default;
 
-  // Base class method implementations
-  std::string CarpInterface::getName() const { return Interface::getName(); }
-  unsigned int CarpInterface::getIndex() const { return Interface::getIndex(); }
-  InterfaceType CarpInterface::getType() const { return InterfaceType::CARP; }
-  std::vector<Flag> CarpInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool CarpInterface::setFlags(int flags) { return Interface::setFlags(flags); }
-  bool CarpInterface::bringUp() { return Interface::bringUp(); }
-  bool CarpInterface::bringDown() { return Interface::bringDown(); }
-  bool CarpInterface::isUp() const { return Interface::isUp(); }
-
-  int CarpInterface::getMtu() const { return Interface::getMtu(); }
-  bool CarpInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-  std::string CarpInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-
-  int CarpInterface::getFib() const { return Interface::getFib(); }
-  bool CarpInterface::setFib(int fib) { return Interface::setFib(fib); }
-
-  int CarpInterface::getVhid() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  std::vector<CarpInfo> CarpInterface::getCarpInfo() const {
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
-      return -1;
+      pImpl->lastError = "Failed to create socket";
+      return {};
     }
 
+    // A zero VHID asks for every VHID on the interface; the kernel rejects
+    // the request unless carpr_count covers them all
+    std::vector<struct carpreq> buffer(CARP_MAXVHID);
+    std::memset(buffer.data(), 0, buffer.size() * sizeof(struct carpreq));
+    buffer[0].carpr_count = CARP_MAXVHID;
+
     struct ifreq ifr;
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
+    ifr.ifr_data = reinterpret_cast<caddr_t>(buffer.data());
 
-    struct carpreq carpr;
-    std::memset(&carpr, 0, sizeof(carpr));
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
-
-    if (ioctl(sock, SIOCGVH, &ifr) < 0) {
-      close(sock);
-      return -1;
+    if (metrics::tracedIoctl(sock, SIOCGVH, &ifr) < 0) {
+      pImpl->lastError =
+          "Failed to get CARP status: " + std::string(strerror(errno));
+      return {};
+    }
+
+    size_t count = std::min<size_t>(buffer[0].carpr_count, buffer.size());
+    std::vector<CarpInfo> info;
+    info.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      const struct carpreq &carpr = buffer[i];
+      CarpInfo entry;
+      entry.vhid = carpr.carpr_vhid;
+      switch (carpr.carpr_state) {
+      case 1:
+        entry.state = CarpState::BACKUP;
+        break;
+      case 2:
+        entry.state = CarpState::MASTER;
+        break;
+      default:
+        entry.state = CarpState::INIT;
+        break;
+      }
+      entry.advbase = carpr.carpr_advbase;
+      entry.advskew = carpr.carpr_advskew;
+      // Only privileged callers get the key back
+      const char *key = reinterpret_cast<const char *>(carpr.carpr_key);
+      entry.key.assign(key, strnlen(key, CARP_KEY_LEN));
+      info.push_back(std::move(entry));
     }
+    return info;
+  }
 
-    close(sock);
-    return carpr.carpr_vhid;
+  int CarpInterface::getVhid() const {
+    auto info = getCarpInfo();
+    return info.empty() ? -1 : info[0].vhid;
   }
 
   bool CarpInterface::setVhid(int vhid) {
@@ -97,7 +114,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -112,71 +129,23 @@ namespace libfreebsdnet::interface {
     carpr.carpr_vhid = vhid;
     ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
 
-    if (ioctl(sock, SIOCSVH, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSVH, &ifr) < 0) {
       pImpl->lastError = "Failed to set VHID: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
     pImpl->vhid = vhid;
-    close(sock);
     return true;
   }
 
   CarpState CarpInterface::getState() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return CarpState::INIT;
-    }
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-
-    struct carpreq carpr;
-    std::memset(&carpr, 0, sizeof(carpr));
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
-
-    if (ioctl(sock, SIOCGVH, &ifr) < 0) {
-      close(sock);
-      return CarpState::INIT;
-    }
-
-    close(sock);
-
-    switch (carpr.carpr_state) {
-    case 0: // INIT
-      return CarpState::INIT;
-    case 1: // BACKUP
-      return CarpState::BACKUP;
-    case 2: // MASTER
-      return CarpState::MASTER;
-    default:
-      return CarpState::INIT;
-    }
+    auto info = getCarpInfo();
+    return info.empty() ? CarpState::INIT : info[0].state;
   }
 
   int CarpInterface::getAdvBase() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return -1;
-    }
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-
-    struct carpreq carpr;
-    std::memset(&carpr, 0, sizeof(carpr));
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
-
-    if (ioctl(sock, SIOCGVH, &ifr) < 0) {
-      close(sock);
-      return -1;
-    }
-
-    close(sock);
-    return carpr.carpr_advbase;
+    auto info = getCarpInfo();
+    return info.empty() ? -1 : info[0].advbase;
   }
 
   bool CarpInterface::setAdvBase(int advbase) {
@@ -186,7 +155,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -201,39 +170,19 @@ namespace libfreebsdnet::interface {
     carpr.carpr_advbase = advbase;
     ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
 
-    if (ioctl(sock, SIOCSVH, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSVH, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set advertisement base: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
     pImpl->advbase = advbase;
-    close(sock);
     return true;
   }
 
   int CarpInterface::getAdvSkew() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return -1;
-    }
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-
-    struct carpreq carpr;
-    std::memset(&carpr, 0, sizeof(carpr));
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
-
-    if (ioctl(sock, SIOCGVH, &ifr) < 0) {
-      close(sock);
-      return -1;
-    }
-
-    close(sock);
-    return carpr.carpr_advskew;
+    auto info = getCarpInfo();
+    return info.empty() ? -1 : info[0].advskew;
   }
 
   bool CarpInterface::setAdvSkew(int advskew) {
@@ -243,7 +192,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -258,15 +207,13 @@ namespace libfreebsdnet::interface {
     carpr.carpr_advskew = advskew;
     ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
 
-    if (ioctl(sock, SIOCSVH, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSVH, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set advertisement skew: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
     pImpl->advskew = advskew;
-    close(sock);
     return true;
   }
 
@@ -297,26 +244,8 @@ namespace libfreebsdnet::interface {
   }
 
   std::string CarpInterface::getKey() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return "";
-    }
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-
-    struct carpreq carpr;
-    std::memset(&carpr, 0, sizeof(carpr));
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
-
-    if (ioctl(sock, SIOCGVH, &ifr) < 0) {
-      close(sock);
-      return "";
-    }
-
-    close(sock);
-    return std::string(reinterpret_cast<const char *>(carpr.carpr_key));
+    auto info = getCarpInfo();
+    return info.empty() ? "" : info[0].key;
   }
 
   bool CarpInterface::setKey(const std::string &key) {
@@ -325,7 +254,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -341,14 +270,12 @@ namespace libfreebsdnet::interface {
                  CARP_KEY_LEN - 1);
     ifr.ifr_data = reinterpret_cast<caddr_t>(&carpr);
 
-    if (ioctl(sock, SIOCSVH, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSVH, &ifr) < 0) {
       pImpl->lastError = "Failed to set key: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
     pImpl->key = key;
-    close(sock);
     return true;
   }
 
@@ -381,7 +308,7 @@ namespace libfreebsdnet::interface {
   }
 
   uint32_t CarpInterface::getCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -390,17 +317,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_reqcap;
   }
 
   bool CarpInterface::setCapabilities(uint32_t capabilities) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -411,19 +336,17 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_reqcap = capabilities;
 
-    if (ioctl(sock, SIOCSIFCAP, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFCAP, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set capabilities: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   uint32_t CarpInterface::getEnabledCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -432,12 +355,10 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_curcap;
   }
 
@@ -451,20 +372,8 @@ namespace libfreebsdnet::interface {
     return setCapabilities(current & ~capabilities);
   }
 
-  std::vector<std::string> CarpInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool CarpInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool CarpInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
   bool CarpInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -480,23 +389,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool CarpInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -506,19 +412,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool CarpInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -528,54 +432,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> CarpInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
-  }
-
   std::string CarpInterface::getMacAddress() const {
     // CARP interfaces typically don't have MAC addresses
     return "";
@@ -589,7 +454,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool CarpInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -600,14 +465,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
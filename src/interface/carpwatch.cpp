@@ -0,0 +1,190 @@
+/**
+ * @file interface/carpwatch.cpp
+ * @brief CARP state transition watcher implementation
+ * @details Netlink-triggered SIOCGVH rescans with per-VHID state diffing
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <interface/carpwatch.hpp>
+#include <map>
+#include <mutex>
+#include <net/if.h>
+#include <netlink/manager.hpp>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    struct Watched {
+      std::unique_ptr<CarpInterface> carp;
+      std::map<int, CarpState> states; // by VHID
+    };
+
+  } // namespace
+
+  class CarpWatcher::Impl {
+  public:
+    std::mutex mutex;
+    std::map<unsigned int, Watched> watched; // by interface index
+    CarpCallback callback;
+    netlink::NetlinkManager netlink;
+    bool running = false;
+    std::string lastError;
+
+    // Diff one interface against its baseline; caller holds the mutex
+    void rescan(Watched &entry, std::vector<CarpTransition> &out) {
+      auto now = std::chrono::steady_clock::now();
+      std::map<int, CarpState> states;
+      for (const CarpInfo &info : entry.carp->getCarpInfo()) {
+        states[info.vhid] = info.state;
+        auto it = entry.states.find(info.vhid);
+        CarpState from =
+            it != entry.states.end() ? it->second : CarpState::INIT;
+        if (from != info.state) {
+          out.push_back({entry.carp->getName(), info.vhid, from, info.state,
+                         now});
+        }
+      }
+      // VHIDs that were removed drop back to INIT
+      for (const auto &[vhid, state] : entry.states) {
+        if (!states.contains(vhid) && state != CarpState::INIT) {
+          out.push_back({entry.carp->getName(), vhid, state, CarpState::INIT,
+                         now});
+        }
+      }
+      entry.states = std::move(states);
+    }
+
+    template <typename Match> size_t rescanMatching(Match match) {
+      std::vector<CarpTransition> transitions;
+      CarpCallback deliver;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &[index, entry] : watched) {
+          if (match(index)) {
+            rescan(entry, transitions);
+          }
+        }
+        deliver = callback;
+      }
+      // Deliver unlocked so callbacks may call back into the watcher
+      if (deliver) {
+        for (const auto &transition : transitions) {
+          deliver(transition);
+        }
+      }
+      return transitions.size();
+    }
+
+    void onEvents(const netlink::NetlinkEventBatch &batch) {
+      std::vector<unsigned int> touched;
+      for (const auto &event : batch.links) {
+        touched.push_back(static_cast<unsigned int>(event.info.index));
+      }
+      for (const auto &event : batch.addresses) {
+        touched.push_back(static_cast<unsigned int>(event.index));
+      }
+      for (const auto &event : batch.routes) {
+        touched.push_back(static_cast<unsigned int>(event.index));
+      }
+      std::sort(touched.begin(), touched.end());
+      rescanMatching([&touched](unsigned int index) {
+        return std::binary_search(touched.begin(), touched.end(), index);
+      });
+    }
+  };
+
+  CarpWatcher::CarpWatcher() : pImpl(std::make_unique<Impl>()) {}
+
+  CarpWatcher::~CarpWatcher() { stop(); }
+
+  bool CarpWatcher::watch(const std::string &name) {
+    unsigned int index = if_nametoindex(name.c_str());
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    if (index == 0) {
+      pImpl->lastError = "Interface not found: " + name;
+      return false;
+    }
+
+    Watched entry;
+    entry.carp = std::make_unique<CarpInterface>(name, index, 0);
+    std::vector<CarpTransition> ignored;
+    pImpl->rescan(entry, ignored);
+    pImpl->watched[index] = std::move(entry);
+    return true;
+  }
+
+  bool CarpWatcher::unwatch(const std::string &name) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    for (auto it = pImpl->watched.begin(); it != pImpl->watched.end(); ++it) {
+      if (it->second.carp->getName() == name) {
+        pImpl->watched.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool CarpWatcher::start(const CarpCallback &callback) {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (pImpl->running) {
+        pImpl->lastError = "Already watching";
+        return false;
+      }
+      if (!callback) {
+        pImpl->lastError = "No transition callback supplied";
+        return false;
+      }
+      pImpl->callback = callback;
+    }
+
+    // Short latency: a transition is usually a handful of route events
+    netlink::NetlinkMonitorOptions options;
+    options.maxLatency = std::chrono::microseconds(500);
+    Impl *impl = pImpl.get();
+    if (!pImpl->netlink.startMonitoring(
+            [impl](const netlink::NetlinkEventBatch &batch) {
+              impl->onEvents(batch);
+            },
+            options)) {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      pImpl->lastError = pImpl->netlink.getLastError();
+      pImpl->callback = nullptr;
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->running = true;
+    return true;
+  }
+
+  bool CarpWatcher::stop() {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (!pImpl->running) {
+        return true;
+      }
+    }
+    // Joins the monitor thread, so no callback is in flight afterwards
+    bool result = pImpl->netlink.stopMonitoring();
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->running = false;
+    pImpl->callback = nullptr;
+    return result;
+  }
+
+  size_t CarpWatcher::poll() {
+    return pImpl->rescanMatching([](unsigned int) { return true; });
+  }
+
+  std::string CarpWatcher::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
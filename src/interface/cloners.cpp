@@ -0,0 +1,246 @@
+/**
+ * @file interface/cloners.cpp
+ * @brief Cloner cache implementation
+ * @details One SIOCIFGCLONERS read per process and per-cloner unit bitmaps
+ * seeded from a single interface snapshot
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <interface/cloners.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <unordered_map>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // Units in use for one cloner; hint is the first word that may have a
+    // clear bit
+    struct UnitMap {
+      std::vector<uint64_t> words;
+      size_t hint = 0;
+
+      void set(uint32_t unit) {
+        size_t word = unit / 64;
+        if (word >= words.size()) {
+          words.resize(word + 1, 0);
+        }
+        words[word] |= uint64_t{1} << (unit % 64);
+      }
+
+      void clear(uint32_t unit) {
+        size_t word = unit / 64;
+        if (word < words.size()) {
+          words[word] &= ~(uint64_t{1} << (unit % 64));
+          hint = std::min(hint, word);
+        }
+      }
+
+      uint32_t take() {
+        while (hint < words.size() && words[hint] == ~uint64_t{0}) {
+          ++hint;
+        }
+        if (hint == words.size()) {
+          words.push_back(0);
+        }
+        uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(~words[hint]));
+        uint32_t unit = static_cast<uint32_t>(hint * 64) + bit;
+        words[hint] |= uint64_t{1} << bit;
+        return unit;
+      }
+    };
+
+    struct State {
+      std::mutex mutex;
+      std::vector<std::string> cloners;
+      bool loaded = false;
+      std::unordered_map<std::string, UnitMap> units;
+      bool seeded = false;
+    };
+
+    State &state() {
+      static State instance;
+      return instance;
+    }
+
+    std::atomic<uint64_t> queryCount{0};
+
+    // Caller holds the mutex
+    void load(State &s) {
+      if (s.loaded) {
+        return;
+      }
+      s.cloners.clear();
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return;
+      }
+      queryCount.fetch_add(1, std::memory_order_relaxed);
+
+      struct if_clonereq ifcr;
+      std::memset(&ifcr, 0, sizeof(ifcr));
+
+      // First get the total number of cloners
+      if (metrics::tracedIoctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
+        return;
+      }
+
+      if (ifcr.ifcr_total > 0) {
+        std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
+        ifcr.ifcr_buffer = buffer.data();
+        ifcr.ifcr_count = ifcr.ifcr_total;
+
+        if (metrics::tracedIoctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
+          return;
+        }
+        int count = std::min(ifcr.ifcr_count, ifcr.ifcr_total);
+        for (int i = 0; i < count; i++) {
+          std::string cloner(buffer.data() + (i * IFNAMSIZ),
+                             strnlen(buffer.data() + (i * IFNAMSIZ), IFNAMSIZ));
+          if (!cloner.empty()) {
+            s.cloners.push_back(std::move(cloner));
+          }
+        }
+      }
+      s.loaded = true;
+    }
+
+    bool known(const State &s, const std::string &cloner) {
+      return std::find(s.cloners.begin(), s.cloners.end(), cloner) !=
+             s.cloners.end();
+    }
+
+    // "vlan17" -> ("vlan", 17); suffixes such as epair's "a" are ignored
+    bool split(const std::string &name, std::string &cloner, uint32_t &unit) {
+      size_t digits = name.find_first_of("0123456789");
+      if (digits == 0 || digits == std::string::npos) {
+        return false;
+      }
+      size_t end = name.find_first_not_of("0123456789", digits);
+      std::string number = name.substr(digits, end - digits);
+      if (number.size() > 9) {
+        return false;
+      }
+      cloner = name.substr(0, digits);
+      unit = static_cast<uint32_t>(std::stoul(number));
+      return true;
+    }
+
+    // Caller holds the mutex; one snapshot seeds every cloner
+    bool seed(State &s) {
+      if (s.seeded) {
+        return true;
+      }
+      InterfaceSnapshot snapshot;
+      if (!snapshot.refresh()) {
+        return false;
+      }
+      std::string cloner;
+      uint32_t unit = 0;
+      for (const auto &record : snapshot.getRecords()) {
+        if (split(record->name, cloner, unit) && known(s, cloner)) {
+          s.units[cloner].set(unit);
+        }
+      }
+      s.seeded = true;
+      return true;
+    }
+
+  } // namespace
+
+  std::vector<std::string> ClonerCache::getCloners() {
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    load(s);
+    return s.cloners;
+  }
+
+  bool ClonerCache::hasCloner(const std::string &cloner) {
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    load(s);
+    return known(s, cloner);
+  }
+
+  int ClonerCache::allocateUnit(const std::string &cloner) {
+    LIBFREEBSDNET_METRICS_OPERATION("ClonerCache::allocateUnit");
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    load(s);
+    if (!known(s, cloner) || !seed(s)) {
+      return -1;
+    }
+    return static_cast<int>(s.units[cloner].take());
+  }
+
+  std::string ClonerCache::allocateName(const std::string &cloner) {
+    int unit = allocateUnit(cloner);
+    return unit < 0 ? std::string() : cloner + std::to_string(unit);
+  }
+
+  bool ClonerCache::reserve(const std::string &name) {
+    std::string cloner;
+    uint32_t unit = 0;
+    if (!split(name, cloner, unit)) {
+      return false;
+    }
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    load(s);
+    if (!known(s, cloner)) {
+      return false;
+    }
+    // Reservations made before seeding survive it: seeding only sets bits
+    s.units[cloner].set(unit);
+    return true;
+  }
+
+  void ClonerCache::release(const std::string &name) {
+    std::string cloner;
+    uint32_t unit = 0;
+    if (!split(name, cloner, unit)) {
+      return;
+    }
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.units.find(cloner);
+    if (it != s.units.end()) {
+      it->second.clear(unit);
+    }
+  }
+
+  void ClonerCache::resync() {
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.units.clear();
+    s.seeded = false;
+  }
+
+  void ClonerCache::invalidate() {
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.cloners.clear();
+    s.loaded = false;
+    s.units.clear();
+    s.seeded = false;
+  }
+
+  uint64_t ClonerCache::getQueryCount() {
+    return queryCount.load(std::memory_order_relaxed);
+  }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,420 @@
+/**
+ * @file interface/desired.cpp
+ * @brief Declarative interface configuration implementation
+ * @details Snapshot diff, stacking-order planning and the parallel ioctl
+ * sweep
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <interface/desired.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet6/in6_var.h>
+#include <netinet6/nd6.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <thread>
+#include <unordered_map>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using libfreebsdnet::types::Address;
+
+    void setName(struct ifreq &ifr, const std::string &name) {
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    }
+
+    bool isLinkLocal(const Address &address) {
+      auto bytes = address.getBytes();
+      return address.isIPv6() && bytes[0] == 0xfe &&
+             (bytes[1] & 0xc0) == 0x80;
+    }
+
+    int readFib(int sock, const std::string &name, int &fib) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      if (metrics::tracedIoctl(sock, SIOCGIFFIB, &ifr) < 0) {
+        return errno;
+      }
+      fib = ifr.ifr_fib;
+      return 0;
+    }
+
+    int readCapabilities(int sock, const std::string &name,
+                         uint32_t &supported, uint32_t &enabled) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
+        return errno;
+      }
+      supported = static_cast<uint32_t>(ifr.ifr_reqcap);
+      enabled = static_cast<uint32_t>(ifr.ifr_curcap);
+      return 0;
+    }
+
+    int changeAddress(const std::string &name, const Address &address,
+                      bool add) {
+      if (address.isIPv4()) {
+        int sock = ControlSocket::get(AF_INET);
+        if (sock < 0) {
+          return errno;
+        }
+        struct ifaliasreq ifra;
+        std::memset(&ifra, 0, sizeof(ifra));
+        std::strncpy(ifra.ifra_name, name.c_str(), IFNAMSIZ - 1);
+        struct sockaddr_in addr = address.getSockaddrIn();
+        std::memcpy(&ifra.ifra_addr, &addr, sizeof(addr));
+        if (add) {
+          struct sockaddr_in mask = address.getNetmaskAddress().getSockaddrIn();
+          struct sockaddr_in broadcast =
+              address.getBroadcastAddress().getSockaddrIn();
+          std::memcpy(&ifra.ifra_mask, &mask, sizeof(mask));
+          std::memcpy(&ifra.ifra_broadaddr, &broadcast, sizeof(broadcast));
+        }
+        return metrics::tracedIoctl(sock, add ? SIOCAIFADDR : SIOCDIFADDR,
+                                    &ifra) < 0
+                   ? errno
+                   : 0;
+      }
+
+      int sock = ControlSocket::get(AF_INET6);
+      if (sock < 0) {
+        return errno;
+      }
+      if (!add) {
+        struct in6_ifreq ifr6;
+        std::memset(&ifr6, 0, sizeof(ifr6));
+        std::strncpy(ifr6.ifr_name, name.c_str(), IFNAMSIZ - 1);
+        ifr6.ifr_addr = address.getSockaddrIn6();
+        return metrics::tracedIoctl(sock, SIOCDIFADDR_IN6, &ifr6) < 0 ? errno
+                                                                       : 0;
+      }
+      struct in6_aliasreq ifra6;
+      std::memset(&ifra6, 0, sizeof(ifra6));
+      std::strncpy(ifra6.ifra_name, name.c_str(), IFNAMSIZ - 1);
+      ifra6.ifra_addr = address.getSockaddrIn6();
+      ifra6.ifra_prefixmask = address.getNetmaskAddress().getSockaddrIn6();
+      ifra6.ifra_lifetime.ia6t_vltime = ND6_INFINITE_LIFETIME;
+      ifra6.ifra_lifetime.ia6t_pltime = ND6_INFINITE_LIFETIME;
+      return metrics::tracedIoctl(sock, SIOCAIFADDR_IN6, &ifra6) < 0 ? errno
+                                                                     : 0;
+    }
+
+    int execute(const ConfigChange &change) {
+      if (change.kind == ChangeKind::ADDRESS_ADD ||
+          change.kind == ChangeKind::ADDRESS_REMOVE) {
+        return changeAddress(change.interface, change.address,
+                             change.kind == ChangeKind::ADDRESS_ADD);
+      }
+
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return errno;
+      }
+      struct ifreq ifr;
+      setName(ifr, change.interface);
+      unsigned long request = 0;
+      switch (change.kind) {
+      case ChangeKind::MTU:
+        ifr.ifr_mtu = change.value;
+        request = SIOCSIFMTU;
+        break;
+      case ChangeKind::FIB:
+        ifr.ifr_fib = change.value;
+        request = SIOCSIFFIB;
+        break;
+      case ChangeKind::CAPABILITIES:
+        ifr.ifr_reqcap = change.value;
+        request = SIOCSIFCAP;
+        break;
+      case ChangeKind::FLAGS:
+        ifr.ifr_flags = change.value & 0xffff;
+        ifr.ifr_flagshigh = (change.value >> 16) & 0xffff;
+        request = SIOCSIFFLAGS;
+        break;
+      default:
+        return EINVAL;
+      }
+      return metrics::tracedIoctl(sock, request, &ifr) < 0 ? errno : 0;
+    }
+
+  } // namespace
+
+  class ConfigApplier::Impl {
+  public:
+    InterfaceSnapshot snapshot;
+    std::string lastError;
+
+    // Changes in issue order; group[i] numbers the barrier change i waits
+    // behind, and changes sharing a group and interface run in sequence
+    bool build(std::span<const InterfaceConfig> configs,
+               std::vector<ConfigChange> &changes, std::vector<int> &groups) {
+      changes.clear();
+      groups.clear();
+      std::vector<int> levels;
+      if (!computeLevels(configs, levels)) {
+        return false;
+      }
+      if (!snapshot.refresh()) {
+        lastError = snapshot.getLastError();
+        return false;
+      }
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        lastError = "Failed to open control socket: " +
+                    std::string(strerror(errno));
+        return false;
+      }
+
+      // Bucket per-interface changes by phase: MTU decreases top-down
+      // first, then everything else bottom-up
+      int top = levels.empty() ? 0
+                               : *std::max_element(levels.begin(),
+                                                   levels.end());
+      std::vector<std::vector<ConfigChange>> shrink(top + 1);
+      std::vector<std::vector<ConfigChange>> grow(top + 1);
+      for (size_t i = 0; i < configs.size(); ++i) {
+        const InterfaceConfig &config = configs[i];
+        auto record = snapshot.find(config.name);
+        if (!record) {
+          lastError = "Interface not found: " + config.name;
+          return false;
+        }
+        if (!diff(sock, config, *record, levels[i], shrink[levels[i]],
+                  grow[levels[i]])) {
+          return false;
+        }
+      }
+
+      int group = 0;
+      auto emit = [&](std::vector<ConfigChange> &bucket) {
+        if (bucket.empty()) {
+          return;
+        }
+        for (auto &change : bucket) {
+          changes.push_back(std::move(change));
+          groups.push_back(group);
+        }
+        ++group;
+      };
+      for (int level = top; level >= 0; --level) {
+        emit(shrink[level]);
+      }
+      for (int level = 0; level <= top; ++level) {
+        emit(grow[level]);
+      }
+      lastError.clear();
+      return true;
+    }
+
+  private:
+    bool computeLevels(std::span<const InterfaceConfig> configs,
+                       std::vector<int> &levels) {
+      std::unordered_map<std::string, size_t> byName;
+      for (size_t i = 0; i < configs.size(); ++i) {
+        if (!byName.emplace(configs[i].name, i).second) {
+          lastError = "Duplicate interface config: " + configs[i].name;
+          return false;
+        }
+      }
+
+      // -1 unvisited, -2 on the current path
+      levels.assign(configs.size(), -1);
+      std::vector<std::pair<size_t, size_t>> stack;
+      for (size_t root = 0; root < configs.size(); ++root) {
+        if (levels[root] >= 0) {
+          continue;
+        }
+        levels[root] = -2;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+          auto &[node, next] = stack.back();
+          const auto &lower = configs[node].lower;
+          if (next < lower.size()) {
+            auto it = byName.find(lower[next++]);
+            if (it == byName.end() || levels[it->second] >= 0) {
+              continue;
+            }
+            if (levels[it->second] == -2) {
+              lastError = "Interface stacking loop at " + configs[node].name;
+              return false;
+            }
+            levels[it->second] = -2;
+            stack.emplace_back(it->second, 0);
+            continue;
+          }
+          int level = 0;
+          for (const auto &name : lower) {
+            auto it = byName.find(name);
+            if (it != byName.end()) {
+              level = std::max(level, levels[it->second] + 1);
+            }
+          }
+          levels[node] = level;
+          stack.pop_back();
+        }
+      }
+      return true;
+    }
+
+    bool diff(int sock, const InterfaceConfig &config,
+              const InterfaceRecord &record, int level,
+              std::vector<ConfigChange> &shrink,
+              std::vector<ConfigChange> &grow) {
+      auto change = [&](ChangeKind kind, int value) {
+        ConfigChange result;
+        result.interface = config.name;
+        result.kind = kind;
+        result.value = value;
+        result.level = level;
+        return result;
+      };
+
+      if (config.addresses) {
+        for (const auto &address : record.addresses) {
+          if (!isLinkLocal(address) &&
+              std::find(config.addresses->begin(), config.addresses->end(),
+                        address) == config.addresses->end()) {
+            grow.push_back(change(ChangeKind::ADDRESS_REMOVE, 0));
+            grow.back().address = address;
+          }
+        }
+      }
+
+      if (config.mtu && *config.mtu != record.getMtu()) {
+        auto &bucket = *config.mtu < record.getMtu() ? shrink : grow;
+        bucket.push_back(change(ChangeKind::MTU, *config.mtu));
+      }
+
+      if (config.fib) {
+        int fib = 0;
+        if (int error = readFib(sock, config.name, fib); error != 0) {
+          lastError = "Failed to read FIB of " + config.name + ": " +
+                      std::string(strerror(error));
+          return false;
+        }
+        if (fib != *config.fib) {
+          grow.push_back(change(ChangeKind::FIB, *config.fib));
+        }
+      }
+
+      if (config.enableCapabilities | config.disableCapabilities) {
+        uint32_t supported = 0;
+        uint32_t enabled = 0;
+        if (int error =
+                readCapabilities(sock, config.name, supported, enabled);
+            error != 0) {
+          lastError = "Failed to read capabilities of " + config.name +
+                      ": " + std::string(strerror(error));
+          return false;
+        }
+        uint32_t wanted = (enabled | (config.enableCapabilities & supported)) &
+                          ~config.disableCapabilities;
+        if (wanted != enabled) {
+          grow.push_back(
+              change(ChangeKind::CAPABILITIES, static_cast<int>(wanted)));
+        }
+      }
+
+      if (config.addresses) {
+        for (const auto &address : *config.addresses) {
+          if (std::find(record.addresses.begin(), record.addresses.end(),
+                        address) == record.addresses.end()) {
+            grow.push_back(change(ChangeKind::ADDRESS_ADD, 0));
+            grow.back().address = address;
+          }
+        }
+      }
+
+      if (config.up && ((record.flags & IFF_UP) != 0) != *config.up) {
+        grow.push_back(change(ChangeKind::FLAGS, record.flags ^ IFF_UP));
+      }
+      return true;
+    }
+  };
+
+  ConfigApplier::ConfigApplier() : pImpl(std::make_unique<Impl>()) {}
+
+  ConfigApplier::~ConfigApplier() = default;
+
+  std::vector<ConfigChange>
+  ConfigApplier::plan(std::span<const InterfaceConfig> configs) {
+    std::vector<ConfigChange> changes;
+    std::vector<int> groups;
+    pImpl->build(configs, changes, groups);
+    return changes;
+  }
+
+  std::vector<ConfigChange>
+  ConfigApplier::apply(std::span<const InterfaceConfig> configs,
+                       unsigned int workers) {
+    std::vector<ConfigChange> changes;
+    std::vector<int> groups;
+    if (!pImpl->build(configs, changes, groups)) {
+      return changes;
+    }
+    if (workers == 0) {
+      workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    }
+
+    // A job is one interface's run of changes within a group
+    size_t begin = 0;
+    while (begin < changes.size()) {
+      size_t end = begin;
+      std::vector<std::pair<size_t, size_t>> jobs;
+      while (end < changes.size() && groups[end] == groups[begin]) {
+        size_t run = end;
+        while (end < changes.size() && groups[end] == groups[begin] &&
+               changes[end].interface == changes[run].interface) {
+          ++end;
+        }
+        jobs.emplace_back(run, end);
+      }
+
+      std::atomic<size_t> next{0};
+      auto worker = [&]() {
+        for (size_t job; (job = next.fetch_add(1)) < jobs.size();) {
+          for (size_t i = jobs[job].first; i < jobs[job].second; ++i) {
+            changes[i].error = execute(changes[i]);
+          }
+        }
+      };
+
+      std::vector<std::thread> threads;
+      size_t count = std::min<size_t>(workers, jobs.size());
+      for (size_t slot = 1; slot < count; ++slot) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      begin = end;
+    }
+
+    size_t failed = std::count_if(
+        changes.begin(), changes.end(),
+        [](const ConfigChange &change) { return !change.succeeded(); });
+    if (failed > 0) {
+      pImpl->lastError = std::to_string(failed) + " of " +
+                         std::to_string(changes.size()) + " changes failed";
+    }
+    return changes;
+  }
+
+  std::string ConfigApplier::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,240 @@
+/**
+ * @file interface/epairpool.cpp
+ * @brief Pre-created epair pool implementation
+ * @details Background SIOCIFCREATE2 refill and SIOCSIFNAME/SIOCSIFVNET
+ * hand-out
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <interface/epairpool.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <thread>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    void setName(struct ifreq &ifr, const std::string &name) {
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    }
+
+    int destroyOne(int sock, const std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      return metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0 ? errno : 0;
+    }
+
+    int rename(int sock, std::string &name, const std::string &newName) {
+      if (newName.empty() || newName == name) {
+        return 0;
+      }
+      if (newName.size() >= IFNAMSIZ) {
+        return ENAMETOOLONG;
+      }
+      char buffer[IFNAMSIZ] = {};
+      std::strncpy(buffer, newName.c_str(), IFNAMSIZ - 1);
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_data = buffer;
+      if (metrics::tracedIoctl(sock, SIOCSIFNAME, &ifr) < 0) {
+        return errno;
+      }
+      name = newName;
+      return 0;
+    }
+
+  } // namespace
+
+  class EpairPool::Impl {
+  public:
+    EpairPoolOptions options;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<EpairPair> ready;
+    std::atomic<bool> running{false};
+    std::thread thread;
+    std::string lastError;
+
+    explicit Impl(const EpairPoolOptions &opts) : options(opts) {}
+
+    // Create one pair and apply the pool settings; 0 or errno
+    int create(int sock, EpairPair &pair) {
+      struct ifreq ifr;
+      setName(ifr, "epair");
+      if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+        return errno;
+      }
+      // The kernel returns the "a" end; the "b" end shares its unit
+      pair.host.assign(ifr.ifr_name, strnlen(ifr.ifr_name, IFNAMSIZ));
+      pair.jail = pair.host;
+      pair.jail.back() = 'b';
+
+      int error = 0;
+      for (const std::string *name : {&pair.host, &pair.jail}) {
+        if (error == 0 && options.mtu > 0) {
+          setName(ifr, *name);
+          ifr.ifr_mtu = options.mtu;
+          error = metrics::tracedIoctl(sock, SIOCSIFMTU, &ifr) < 0 ? errno : 0;
+        }
+      }
+      if (error == 0 && options.up) {
+        setName(ifr, pair.host);
+        if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
+          error = errno;
+        } else {
+          ifr.ifr_flags |= IFF_UP;
+          error =
+              metrics::tracedIoctl(sock, SIOCSIFFLAGS, &ifr) < 0 ? errno : 0;
+        }
+      }
+      if (error != 0) {
+        destroyOne(sock, pair.host);
+      }
+      return error;
+    }
+
+    void run() {
+      int sock = ControlSocket::get(AF_INET);
+      std::unique_lock<std::mutex> lock(mutex);
+      while (running.load()) {
+        wake.wait(lock, [this] {
+          return !running.load() || ready.size() < options.size;
+        });
+        if (!running.load()) {
+          break;
+        }
+        lock.unlock();
+        EpairPair pair;
+        int error = sock < 0 ? EBADF : create(sock, pair);
+        lock.lock();
+        if (error != 0) {
+          lastError = "Failed to pre-create epair: " +
+                      std::string(strerror(error));
+          // Back off rather than spin on a persistent failure
+          wake.wait_for(lock, std::chrono::seconds(1),
+                        [this] { return !running.load(); });
+          continue;
+        }
+        ready.push_back(std::move(pair));
+      }
+    }
+  };
+
+  EpairPool::EpairPool(const EpairPoolOptions &options)
+      : pImpl(std::make_unique<Impl>(options)) {}
+
+  EpairPool::~EpairPool() {
+    stop();
+    int sock = ControlSocket::get(AF_INET);
+    if (sock >= 0) {
+      for (const auto &pair : pImpl->ready) {
+        destroyOne(sock, pair.host);
+      }
+    }
+  }
+
+  bool EpairPool::start() {
+    if (pImpl->running.exchange(true)) {
+      return true;
+    }
+    pImpl->thread = std::thread([this] { pImpl->run(); });
+    return true;
+  }
+
+  void EpairPool::stop() {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (!pImpl->running.exchange(false)) {
+        return;
+      }
+    }
+    pImpl->wake.notify_all();
+    pImpl->thread.join();
+  }
+
+  size_t EpairPool::getAvailable() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->ready.size();
+  }
+
+  bool EpairPool::acquire(EpairPair &pair) {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (!pImpl->ready.empty()) {
+        pair = std::move(pImpl->ready.front());
+        pImpl->ready.pop_front();
+        pImpl->wake.notify_all();
+        return true;
+      }
+    }
+
+    int sock = ControlSocket::get(AF_INET);
+    int error = sock < 0 ? EBADF : pImpl->create(sock, pair);
+    if (error != 0) {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      pImpl->lastError = "Failed to create epair: " +
+                         std::string(strerror(error));
+      return false;
+    }
+    return true;
+  }
+
+  bool EpairPool::attach(int jid, const std::string &hostName,
+                         const std::string &jailName, EpairPair &pair) {
+    if (!acquire(pair)) {
+      return false;
+    }
+    int sock = ControlSocket::get(AF_INET);
+    int error = sock < 0 ? EBADF : rename(sock, pair.host, hostName);
+    if (error == 0) {
+      error = rename(sock, pair.jail, jailName);
+    }
+    if (error == 0) {
+      struct ifreq ifr;
+      setName(ifr, pair.jail);
+      ifr.ifr_jid = jid;
+      error = metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0 ? errno : 0;
+    }
+    if (error != 0) {
+      if (sock >= 0) {
+        destroyOne(sock, pair.host);
+      }
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      pImpl->lastError = "Failed to attach " + pair.jail + " to jail " +
+                         std::to_string(jid) + ": " + strerror(error);
+      return false;
+    }
+    return true;
+  }
+
+  bool EpairPool::release(const std::string &host) {
+    int sock = ControlSocket::get(AF_INET);
+    int error = sock < 0 ? EBADF : destroyOne(sock, host);
+    if (error != 0) {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      pImpl->lastError = "Failed to destroy " + host + ": " + strerror(error);
+      return false;
+    }
+    return true;
+  }
+
+  std::string EpairPool::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
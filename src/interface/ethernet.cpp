@@ -13,8 +13,11 @@
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/ethernet.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <interface/vnetmanager.hpp>
 #include <iomanip>
-#include <jail.h>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -32,7 +35,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class EthernetInterface::Impl {
+  class EthernetInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -45,36 +48,16 @@ namespace libfreebsdnet::interface {
 
   EthernetInterface::EthernetInterface(const std::string &name,
                                        unsigned int index, int flags)
-      : Interface(name, index, flags),
+      : InterfaceBase(name, index, flags),
         pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   EthernetInterface::~EthernetInterface() = default;
 
-  // Base class method implementations
-  std::string EthernetInterface::getName() const {
-    return Interface::getName();
-  }
-  unsigned int EthernetInterface::getIndex() const {
-    return Interface::getIndex();
-  }
-  InterfaceType EthernetInterface::getType() const {
-    return InterfaceType::ETHERNET;
-  }
-  bool EthernetInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-  bool EthernetInterface::bringUp() { return Interface::bringUp(); }
-  bool EthernetInterface::bringDown() { return Interface::bringDown(); }
-  bool EthernetInterface::isUp() const { return Interface::isUp(); }
-  int EthernetInterface::getMtu() const { return Interface::getMtu(); }
-  bool EthernetInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-  std::string EthernetInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-  int EthernetInterface::getFib() const { return Interface::getFib(); }
-  bool EthernetInterface::setFib(int fib) { return Interface::setFib(fib); }
-
   std::string EthernetInterface::getMacAddress() const {
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->linkAddress;
+    }
+
     struct ifaddrs *ifaddrs, *ifa;
     std::string macAddress = "";
 
@@ -130,58 +113,8 @@ namespace libfreebsdnet::interface {
     return (pImpl->flags & IFF_PROMISC) != 0;
   }
 
-  int EthernetInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool EthernetInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int EthernetInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int EthernetInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> EthernetInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t EthernetInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool EthernetInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t EthernetInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool EthernetInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool EthernetInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  std::vector<std::string> EthernetInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool EthernetInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool EthernetInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
   int EthernetInterface::getVnet() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -190,33 +123,19 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifr.ifr_jid;
   }
 
   std::string EthernetInterface::getVnetJailName() const {
-    int vnetId = getVnet();
-    if (vnetId < 0) {
-      return "";
-    }
-
-    char *jailName = jail_getname(vnetId);
-    if (jailName != nullptr) {
-      std::string result(jailName);
-      free(jailName);
-      return result;
-    }
-
-    return "";
+    return VnetManager::getJailName(getVnet());
   }
 
   bool EthernetInterface::setVnet(int vnetId) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -227,18 +146,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_jid = vnetId;
 
-    if (ioctl(sock, SIOCSIFVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0) {
       pImpl->lastError = "Failed to set VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool EthernetInterface::reclaimFromVnet() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -248,39 +165,34 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSIFRVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFRVNET, &ifr) < 0) {
       pImpl->lastError =
           "Failed to reclaim from VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  bool EthernetInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool EthernetInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool EthernetInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> EthernetInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  bool EthernetInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
+  std::vector<QueueCounters> EthernetInterface::getQueueCounters() const {
+    // The collector caches each driver's resolved queue OIDs; sharing one
+    // keeps repeated reads from walking the sysctl tree again. readQueues()
+    // is thread-safe
+    static StatisticsCollector collector;
+    std::vector<QueueStatistics> raw;
+    if (!collector.readQueues(getIndex(), raw)) {
+      return {};
+    }
+    std::vector<QueueCounters> counters;
+    counters.reserve(raw.size());
+    for (const auto &queue : raw) {
+      counters.push_back(QueueCounters::fromStatistics(queue));
+    }
+    return counters;
   }
 
   bool EthernetInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -291,27 +203,13 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  MediaInfo EthernetInterface::getMediaInfo() const {
-    return Interface::getMediaInfo();
-  }
-
-  std::vector<Capability> EthernetInterface::getCapabilityList() const {
-    return Interface::getCapabilityList();
-  }
-
-  std::vector<Flag> EthernetInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-
 } // namespace libfreebsdnet::interface
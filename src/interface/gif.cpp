@@ -12,7 +12,9 @@
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/gif.hpp>
+#include <interface/socket.hpp>
 #include <jail.h>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <net/if_gif.h>
 #include <net/if_mib.h>
@@ -29,12 +31,10 @@ namespace libfreebsdnet::interface {
 
   GifInterface::GifInterface(const std::string &name, unsigned int index,
                              int flags)
-      : TunnelInterface(name, index, flags) {}
+      : InterfaceBase(name, index, flags) {}
 
   GifInterface::~GifInterface() = default;
 
-  InterfaceType GifInterface::getType() const { return InterfaceType::GIF; }
-
   int GifInterface::getProtocol() const {
     // Default to IPv4 for now
     return 4;
@@ -50,7 +50,7 @@ namespace libfreebsdnet::interface {
   }
 
   std::string GifInterface::getLocalAddress() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "";
     }
@@ -59,26 +59,22 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFPSRCADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFPSRCADDR, &ifr) < 0) {
       return "";
     }
 
     const struct sockaddr_in *sin =
         reinterpret_cast<const struct sockaddr_in *>(&ifr.ifr_addr);
     if (sin->sin_family != AF_INET) {
-      close(sock);
       return "";
     }
 
     char addr_str[INET_ADDRSTRLEN];
     if (inet_ntop(AF_INET, &sin->sin_addr, addr_str, INET_ADDRSTRLEN) ==
         nullptr) {
-      close(sock);
       return "";
     }
 
-    close(sock);
     return std::string(addr_str);
   }
 
@@ -90,7 +86,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -106,18 +102,16 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     sin->sin_addr = addr;
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &addreq) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &addreq) < 0) {
       // Use base class error handling
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::string GifInterface::getRemoteAddress() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "";
     }
@@ -126,26 +120,22 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFPDSTADDR, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFPDSTADDR, &ifr) < 0) {
       return "";
     }
 
     const struct sockaddr_in *sin =
         reinterpret_cast<const struct sockaddr_in *>(&ifr.ifr_addr);
     if (sin->sin_family != AF_INET) {
-      close(sock);
       return "";
     }
 
     char addr_str[INET_ADDRSTRLEN];
     if (inet_ntop(AF_INET, &sin->sin_addr, addr_str, INET_ADDRSTRLEN) ==
         nullptr) {
-      close(sock);
       return "";
     }
 
-    close(sock);
     return std::string(addr_str);
   }
 
@@ -157,7 +147,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -173,13 +163,11 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     sin->sin_addr = addr;
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &addreq) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &addreq) < 0) {
       // Use base class error handling
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -208,88 +196,6 @@ namespace libfreebsdnet::interface {
     return true;
   }
 
-  int GifInterface::getTunnelFib() const {
-    return TunnelInterface::getTunnelFib();
-  }
-
-  bool GifInterface::setTunnelFib(int fib) {
-    return TunnelInterface::setTunnelFib(fib);
-  }
-
-  // Group management methods (call base class)
-  std::vector<std::string> GifInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool GifInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool GifInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
-  // Base class method implementations (call base class)
-  int GifInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool GifInterface::setMedia(int media) { return Interface::setMedia(media); }
-
-  int GifInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int GifInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> GifInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t GifInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool GifInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t GifInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool GifInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool GifInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  bool GifInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool GifInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool GifInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> GifInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  std::string GifInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
-
-  bool GifInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
-  }
-
   // VNET interface methods
   int GifInterface::getVnet() const {
     // VNET functionality not implemented yet
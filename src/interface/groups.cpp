@@ -0,0 +1,390 @@
+/**
+ * @file interface/groups.cpp
+ * @brief Interface group membership index implementation
+ * @details SIOCGIFGROUP sweep into two hash maps of sorted name vectors,
+ * maintained from netlink link events
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <interface/groups.hpp>
+#include <interface/socket.hpp>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <netlink/manager.hpp>
+#include <shared_mutex>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <unordered_map>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using NameList = std::vector<std::string>;
+
+    void insertSorted(NameList &list, const std::string &name) {
+      auto it = std::lower_bound(list.begin(), list.end(), name);
+      if (it == list.end() || *it != name) {
+        list.insert(it, name);
+      }
+    }
+
+    void eraseSorted(NameList &list, const std::string &name) {
+      auto it = std::lower_bound(list.begin(), list.end(), name);
+      if (it != list.end() && *it == name) {
+        list.erase(it);
+      }
+    }
+
+    // Two-step SIOCGIFGROUP/SIOCGIFGMEMB read into a reused buffer; the
+    // same request returns an interface's groups or a group's members
+    bool readList(unsigned long request, const std::string &name,
+                  std::vector<struct ifg_req> &buffer, NameList &out) {
+      out.clear();
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return false;
+      }
+      struct ifgroupreq ifgr;
+      std::memset(&ifgr, 0, sizeof(ifgr));
+      std::strncpy(ifgr.ifgr_name, name.c_str(), IFNAMSIZ - 1);
+      if (metrics::tracedIoctl(sock, request, &ifgr) < 0) {
+        return false;
+      }
+      size_t count = ifgr.ifgr_len / sizeof(struct ifg_req);
+      if (count == 0) {
+        return true;
+      }
+      buffer.resize(count);
+      ifgr.ifgr_len = static_cast<u_int>(count * sizeof(struct ifg_req));
+      ifgr.ifgr_groups = buffer.data();
+      if (metrics::tracedIoctl(sock, request, &ifgr) < 0) {
+        return false;
+      }
+      count = std::min<size_t>(count, ifgr.ifgr_len / sizeof(struct ifg_req));
+      for (size_t i = 0; i < count; ++i) {
+        out.emplace_back(request == SIOCGIFGMEMB ? buffer[i].ifgrq_member
+                                                 : buffer[i].ifgrq_group);
+      }
+      std::sort(out.begin(), out.end());
+      return true;
+    }
+
+  } // namespace
+
+  class InterfaceGroupIndex::Impl {
+  public:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, NameList> members; // group -> names
+    std::unordered_map<std::string, NameList> groups;  // name -> groups
+    std::unordered_map<unsigned int, std::string> names; // index -> name
+    netlink::NetlinkManager netlink;
+    bool running = false;
+    uint64_t refreshCount = 0;
+    std::string lastError;
+
+    // Caller holds the lock exclusively
+    void forget(const std::string &name) {
+      auto it = groups.find(name);
+      if (it == groups.end()) {
+        return;
+      }
+      for (const auto &group : it->second) {
+        auto m = members.find(group);
+        if (m != members.end()) {
+          eraseSorted(m->second, name);
+          if (m->second.empty()) {
+            members.erase(m);
+          }
+        }
+      }
+      groups.erase(it);
+    }
+
+    // Caller holds the lock exclusively
+    void assign(const std::string &name, NameList list) {
+      forget(name);
+      for (const auto &group : list) {
+        insertSorted(members[group], name);
+      }
+      groups[name] = std::move(list);
+    }
+
+    bool refresh() {
+      struct if_nameindex *list = if_nameindex();
+      if (!list) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        lastError = "Failed to list interfaces: " +
+                    std::string(strerror(errno));
+        return false;
+      }
+
+      std::unordered_map<std::string, NameList> byGroup;
+      std::unordered_map<std::string, NameList> byName;
+      std::unordered_map<unsigned int, std::string> byIndex;
+      std::vector<struct ifg_req> buffer;
+      NameList found;
+      for (struct if_nameindex *it = list; it->if_index != 0; ++it) {
+        std::string name = it->if_name;
+        byIndex[it->if_index] = name;
+        if (!readList(SIOCGIFGROUP, name, buffer, found)) {
+          continue; // departed during the sweep
+        }
+        for (const auto &group : found) {
+          byGroup[group].push_back(name);
+        }
+        byName[name] = found;
+      }
+      if_freenameindex(list);
+      for (auto &[group, list] : byGroup) {
+        std::sort(list.begin(), list.end());
+      }
+
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      members.swap(byGroup);
+      groups.swap(byName);
+      names.swap(byIndex);
+      ++refreshCount;
+      return true;
+    }
+
+    void onEvents(const netlink::NetlinkEventBatch &batch) {
+      std::vector<struct ifg_req> buffer;
+      NameList found;
+      for (const auto &event : batch.links) {
+        unsigned int index = static_cast<unsigned int>(event.info.index);
+        const std::string &name = event.info.name;
+        bool departed =
+            event.type == netlink::NetlinkMessageType::DELLINK;
+        bool known = !departed && readList(SIOCGIFGROUP, name, buffer, found);
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        // A rename keeps the index; drop the entry under the old name
+        auto previous = names.find(index);
+        if (previous != names.end() && previous->second != name) {
+          forget(previous->second);
+        }
+        if (known) {
+          names[index] = name;
+          assign(name, found);
+        } else {
+          forget(name);
+          names.erase(index);
+        }
+      }
+    }
+
+    std::vector<types::NetResult<>>
+    change(unsigned long request, const std::string &group,
+           std::span<const std::string> list, const char *operation) {
+      std::vector<types::NetResult<>> results;
+      results.reserve(list.size());
+      if (group.empty() || group.size() >= IFNAMSIZ) {
+        results.assign(list.size(),
+                       std::unexpected(types::NetError{
+                           types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0,
+                           operation}));
+        return results;
+      }
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        results.assign(list.size(),
+                       std::unexpected(types::NetError::fromErrno(operation)));
+        return results;
+      }
+
+      struct ifgroupreq ifgr;
+      std::memset(&ifgr, 0, sizeof(ifgr));
+      std::strncpy(ifgr.ifgr_group, group.c_str(), IFNAMSIZ - 1);
+      bool adding = request == SIOCAIFGROUP;
+      for (const auto &name : list) {
+        if (name.empty() || name.size() >= IFNAMSIZ) {
+          results.push_back(std::unexpected(types::NetError{
+              types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0, operation}));
+          continue;
+        }
+        std::memset(ifgr.ifgr_name, 0, sizeof(ifgr.ifgr_name));
+        std::memcpy(ifgr.ifgr_name, name.data(), name.size());
+        if (metrics::tracedIoctl(sock, request, &ifgr) < 0) {
+          results.push_back(
+              std::unexpected(types::NetError::fromErrno(operation, request)));
+          continue;
+        }
+        results.emplace_back();
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (adding) {
+          insertSorted(members[group], name);
+          insertSorted(groups[name], group);
+        } else {
+          auto m = members.find(group);
+          if (m != members.end()) {
+            eraseSorted(m->second, name);
+            if (m->second.empty()) {
+              members.erase(m);
+            }
+          }
+          auto g = groups.find(name);
+          if (g != groups.end()) {
+            eraseSorted(g->second, group);
+          }
+        }
+      }
+      return results;
+    }
+  };
+
+  InterfaceGroupIndex::InterfaceGroupIndex()
+      : pImpl(std::make_unique<Impl>()) {}
+
+  InterfaceGroupIndex::~InterfaceGroupIndex() { stop(); }
+
+  bool InterfaceGroupIndex::refresh() {
+    LIBFREEBSDNET_METRICS_OPERATION("InterfaceGroupIndex::refresh");
+    return pImpl->refresh();
+  }
+
+  bool InterfaceGroupIndex::refreshGroup(const std::string &group) {
+    LIBFREEBSDNET_METRICS_OPERATION("InterfaceGroupIndex::refreshGroup");
+    std::vector<struct ifg_req> buffer;
+    NameList found;
+    if (!readList(SIOCGIFGMEMB, group, buffer, found)) {
+      std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+      pImpl->lastError = "Failed to read members of group " + group + ": " +
+                         std::string(strerror(errno));
+      return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    auto it = pImpl->members.find(group);
+    if (it != pImpl->members.end()) {
+      for (const auto &name : it->second) {
+        if (!std::binary_search(found.begin(), found.end(), name)) {
+          auto g = pImpl->groups.find(name);
+          if (g != pImpl->groups.end()) {
+            eraseSorted(g->second, group);
+          }
+        }
+      }
+    }
+    for (const auto &name : found) {
+      insertSorted(pImpl->groups[name], group);
+    }
+    if (found.empty()) {
+      pImpl->members.erase(group);
+    } else {
+      pImpl->members[group] = std::move(found);
+    }
+    return true;
+  }
+
+  bool InterfaceGroupIndex::start() {
+    {
+      std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+      if (pImpl->running) {
+        return true;
+      }
+    }
+    if (getRefreshCount() == 0 && !refresh()) {
+      return false;
+    }
+
+    netlink::NetlinkMonitorOptions options;
+    options.groups = netlink::GROUP_LINK;
+    Impl *impl = pImpl.get();
+    if (!pImpl->netlink.startMonitoring(
+            [impl](const netlink::NetlinkEventBatch &batch) {
+              impl->onEvents(batch);
+            },
+            options)) {
+      std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+      pImpl->lastError = pImpl->netlink.getLastError();
+      return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->running = true;
+    return true;
+  }
+
+  bool InterfaceGroupIndex::stop() {
+    {
+      std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+      if (!pImpl->running) {
+        return true;
+      }
+    }
+    // Joins the monitor thread, so no event is applied afterwards
+    bool result = pImpl->netlink.stopMonitoring();
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->running = false;
+    return result;
+  }
+
+  std::vector<std::string>
+  InterfaceGroupIndex::getMembers(const std::string &group) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    auto it = pImpl->members.find(group);
+    return it != pImpl->members.end() ? it->second : NameList{};
+  }
+
+  std::vector<std::string>
+  InterfaceGroupIndex::getGroups(const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    auto it = pImpl->groups.find(name);
+    return it != pImpl->groups.end() ? it->second : NameList{};
+  }
+
+  bool InterfaceGroupIndex::isMember(const std::string &group,
+                                     const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    auto it = pImpl->groups.find(name);
+    return it != pImpl->groups.end() &&
+           std::binary_search(it->second.begin(), it->second.end(), group);
+  }
+
+  std::vector<std::string> InterfaceGroupIndex::getGroupNames() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    NameList result;
+    result.reserve(pImpl->members.size());
+    for (const auto &[group, list] : pImpl->members) {
+      result.push_back(group);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  std::vector<types::NetResult<>>
+  InterfaceGroupIndex::addMembers(const std::string &group,
+                                  std::span<const std::string> names) {
+    LIBFREEBSDNET_METRICS_OPERATION("InterfaceGroupIndex::addMembers");
+    return pImpl->change(SIOCAIFGROUP, group, names,
+                         "InterfaceGroupIndex::addMembers");
+  }
+
+  std::vector<types::NetResult<>>
+  InterfaceGroupIndex::removeMembers(const std::string &group,
+                                     std::span<const std::string> names) {
+    LIBFREEBSDNET_METRICS_OPERATION("InterfaceGroupIndex::removeMembers");
+    return pImpl->change(SIOCDIFGROUP, group, names,
+                         "InterfaceGroupIndex::removeMembers");
+  }
+
+  uint64_t InterfaceGroupIndex::getRefreshCount() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->refreshCount;
+  }
+
+  std::string InterfaceGroupIndex::getLastError() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,221 @@
+/**
+ * @file interface/identity.cpp
+ * @brief Stable interface identity implementation
+ * @details Per-index name and generation table maintained from netlink
+ * link events
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <interface/identity.hpp>
+#include <interface/snapshot.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <net/if_mib.h>
+#include <netlink/manager.hpp>
+#include <shared_mutex>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    struct Entry {
+      std::string name;
+      uint64_t generation = 0;
+      uint64_t epoch = 0; // ifi_epoch at attach, 0 if unknown
+      bool present = false;
+    };
+
+    // Attach epoch of a live index, 0 if it cannot be read
+    uint64_t readEpoch(unsigned int index) {
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(index), IFDATA_GENERAL};
+      struct ifmibdata data {};
+      size_t len = sizeof(data);
+      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), &data, &len, nullptr, 0) !=
+          0) {
+        return 0;
+      }
+      return static_cast<uint64_t>(data.ifmd_data.ifi_epoch);
+    }
+
+    struct State {
+      std::mutex control; // serialises start() and stop()
+      mutable std::shared_mutex mutex;
+      std::unordered_map<unsigned int, Entry> entries;
+      std::atomic<bool> running{false};
+      std::atomic<uint64_t> renames{0};
+      netlink::NetlinkManager netlink;
+      // Events that arrive while start() dumps are held and replayed
+      // after it, so the dump cannot overwrite them; guarded by mutex
+      bool loading = false;
+      std::vector<netlink::NetlinkEventBatch> queued;
+
+      void onEvents(const netlink::NetlinkEventBatch &batch) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (loading) {
+          queued.push_back(batch);
+          return;
+        }
+        apply(batch);
+      }
+
+      // Caller holds the mutex exclusively
+      void apply(const netlink::NetlinkEventBatch &batch) {
+        // if_rename() announces a departure and an arrival of the same
+        // ifnet, so a deletion only bumps the generation once the batch
+        // shows no arrival of that index with the same attach epoch
+        std::vector<unsigned int> departed;
+        for (const auto &event : batch.links) {
+          auto index = static_cast<unsigned int>(event.info.index);
+          Entry &e = entries[index];
+          if (event.type == netlink::NetlinkMessageType::DELLINK) {
+            if (e.present) {
+              e.present = false;
+              departed.push_back(index);
+            }
+            continue;
+          }
+          bool renamed = e.present;
+          if (!e.present) {
+            uint64_t epoch = readEpoch(index);
+            auto it = std::find(departed.begin(), departed.end(), index);
+            if (it != departed.end()) {
+              departed.erase(it);
+              renamed = epoch != 0 && epoch == e.epoch;
+              if (!renamed) {
+                ++e.generation;
+              }
+            }
+            e.epoch = epoch;
+          }
+          if (renamed && !event.info.name.empty() &&
+              event.info.name != e.name) {
+            renames.fetch_add(1, std::memory_order_relaxed);
+          }
+          if (!event.info.name.empty()) {
+            e.name = event.info.name;
+          }
+          e.present = true;
+        }
+        for (unsigned int index : departed) {
+          ++entries[index].generation;
+        }
+      }
+    };
+
+    State &state() {
+      static State instance;
+      return instance;
+    }
+
+  } // namespace
+
+  bool IdentityTracker::start() {
+    State &s = state();
+    std::lock_guard<std::mutex> control(s.control);
+    if (s.running.load()) {
+      return true;
+    }
+
+    // Subscribe before dumping so a destroy and recreate between the two
+    // is still seen
+    {
+      std::unique_lock<std::shared_mutex> lock(s.mutex);
+      s.loading = true;
+    }
+    auto abandon = [&s] {
+      std::unique_lock<std::shared_mutex> lock(s.mutex);
+      s.loading = false;
+      s.queued.clear();
+    };
+    netlink::NetlinkMonitorOptions options;
+    options.groups = netlink::GROUP_LINK;
+    State *target = &s;
+    if (!s.netlink.startMonitoring(
+            [target](const netlink::NetlinkEventBatch &batch) {
+              target->onEvents(batch);
+            },
+            options)) {
+      abandon();
+      return false;
+    }
+
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh()) {
+      s.netlink.stopMonitoring();
+      abandon();
+      return false;
+    }
+    {
+      // Indices missing from the dump were deleted while nobody watched,
+      // and one now under another name was deleted and reused
+      std::unique_lock<std::shared_mutex> lock(s.mutex);
+      for (auto &[index, e] : s.entries) {
+        if (e.present && !snapshot.find(index)) {
+          e.present = false;
+          ++e.generation;
+        }
+      }
+      for (const auto &record : snapshot.getRecords()) {
+        Entry &e = s.entries[record->index];
+        if (e.present && e.name != record->name) {
+          ++e.generation;
+        }
+        e.name = record->name;
+        e.epoch = static_cast<uint64_t>(record->data.ifi_epoch);
+        e.present = true;
+      }
+      for (const auto &batch : s.queued) {
+        s.apply(batch);
+      }
+      s.queued.clear();
+      s.loading = false;
+    }
+    s.running.store(true);
+    return true;
+  }
+
+  void IdentityTracker::stop() {
+    State &s = state();
+    std::lock_guard<std::mutex> control(s.control);
+    if (!s.running.load()) {
+      return;
+    }
+    s.netlink.stopMonitoring();
+    s.running.store(false);
+  }
+
+  bool IdentityTracker::isRunning() { return state().running.load(); }
+
+  uint64_t IdentityTracker::getGeneration(unsigned int index) {
+    State &s = state();
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    auto it = s.entries.find(index);
+    return it == s.entries.end() ? 0 : it->second.generation;
+  }
+
+  bool IdentityTracker::getName(unsigned int index, std::string &name) {
+    State &s = state();
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    auto it = s.entries.find(index);
+    if (it == s.entries.end() || !it->second.present) {
+      return false;
+    }
+    name = it->second.name;
+    return true;
+  }
+
+  uint64_t IdentityTracker::getRenameCount() {
+    return state().renames.load(std::memory_order_relaxed);
+  }
+
+} // namespace libfreebsdnet::interface
@@ -13,6 +13,9 @@
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/l2vlan.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -27,7 +30,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class L2VlanInterface::Impl {
+  class L2VlanInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -40,43 +43,15 @@ namespace libfreebsdnet::interface {
 
   L2VlanInterface::L2VlanInterface(const std::string &name, unsigned int index,
                                    int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   L2VlanInterface::~L2VlanInterface() = default;
 
-  InterfaceType L2VlanInterface::getType() const {
-    return InterfaceType::VLAN; // L2VLAN is a type of VLAN
-  }
-
   bool L2VlanInterface::isValid() const {
     return !pImpl->name.empty() && pImpl->index > 0;
   }
 
-  // Base class method implementations
-  std::string L2VlanInterface::getName() const { return Interface::getName(); }
-  unsigned int L2VlanInterface::getIndex() const {
-    return Interface::getIndex();
-  }
-  std::vector<Flag> L2VlanInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool L2VlanInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-  std::string L2VlanInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-
-  bool L2VlanInterface::bringUp() { return Interface::bringUp(); }
-  bool L2VlanInterface::bringDown() { return Interface::bringDown(); }
-  bool L2VlanInterface::isUp() const { return Interface::isUp(); }
-
-  int L2VlanInterface::getMtu() const { return Interface::getMtu(); }
-  bool L2VlanInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-
-  int L2VlanInterface::getFib() const { return Interface::getFib(); }
-  bool L2VlanInterface::setFib(int fib) { return Interface::setFib(fib); }
-
   int L2VlanInterface::getMedia() const {
     // L2VLAN interfaces typically don't have physical media
     return 0;
@@ -101,7 +76,7 @@ namespace libfreebsdnet::interface {
   }
 
   uint32_t L2VlanInterface::getCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -110,17 +85,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_reqcap;
   }
 
   bool L2VlanInterface::setCapabilities(uint32_t capabilities) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -131,19 +104,17 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_reqcap = capabilities;
 
-    if (ioctl(sock, SIOCSIFCAP, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFCAP, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set capabilities: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   uint32_t L2VlanInterface::getEnabledCapabilities() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return 0;
     }
@@ -152,12 +123,10 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFCAP, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFCAP, &ifr) < 0) {
       return 0;
     }
 
-    close(sock);
     return ifr.ifr_curcap;
   }
 
@@ -171,20 +140,8 @@ namespace libfreebsdnet::interface {
     return setCapabilities(current & ~capabilities);
   }
 
-  std::vector<std::string> L2VlanInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool L2VlanInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool L2VlanInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
   bool L2VlanInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -199,26 +156,23 @@ namespace libfreebsdnet::interface {
         reinterpret_cast<struct sockaddr_in *>(&ifra.ifra_addr);
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
     sin->sin_family = AF_INET;
     sin->sin_len = sizeof(*sin);
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool L2VlanInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -228,19 +182,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool L2VlanInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -250,55 +202,20 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> L2VlanInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
+  std::string L2VlanInterface::getMacAddress() const {
+    if (const InterfaceRecord *record = getRecord()) {
+      return record->linkAddress;
     }
 
-    close(sock);
-    return cloners;
-  }
-
-  std::string L2VlanInterface::getMacAddress() const {
     struct ifaddrs *ifaddrs, *ifa;
     std::string macAddress = "";
 
@@ -330,7 +247,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool L2VlanInterface::setMacAddress(const std::string &macAddress) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -346,7 +263,6 @@ namespace libfreebsdnet::interface {
                     "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &mac[0],
                     &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
       pImpl->lastError = "Invalid MAC address format";
-      close(sock);
       return false;
     }
 
@@ -355,14 +271,12 @@ namespace libfreebsdnet::interface {
     ifr.ifr_addr.sa_family = AF_LINK;
     ifr.ifr_addr.sa_len = 6;
 
-    if (ioctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set MAC address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -430,7 +344,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool L2VlanInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -441,14 +355,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
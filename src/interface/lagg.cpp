@@ -9,12 +9,15 @@
 
 #include <algorithm>
 #include <arpa/inet.h>
+#include <array>
 #include <cstdio>
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/lagg.hpp>
-#include <jail.h>
+#include <interface/socket.hpp>
+#include <interface/vnetmanager.hpp>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -30,35 +33,55 @@
 
 namespace libfreebsdnet::interface {
 
-  LagInterface::LagInterface(const std::string &name, unsigned int index,
-                             int flags)
-      : Interface(name, index, flags) {}
-
-  LagInterface::~LagInterface() = default;
+  namespace {
+
+    // lacp_fill_portinfo() converts the PDU fields to host order before
+    // copying them out, so they are used as they are
+    LacpPeer decodePeer(uint16_t prio, const uint8_t *mac, uint16_t key,
+                        uint16_t portPrio, uint16_t portNo, uint8_t state) {
+      LacpPeer peer;
+      peer.systemPriority = prio;
+      peer.system.setBytes(mac);
+      peer.key = key;
+      peer.portPriority = portPrio;
+      peer.port = portNo;
+      peer.state = state;
+      return peer;
+    }
+
+    // Busiest share over the mean share of the distributing ports
+    double imbalance(const std::vector<LagPortLoad> &ports,
+                     double LagPortLoad::*share) {
+      double peak = 0, total = 0;
+      int active = 0;
+      for (const auto &load : ports) {
+        if (load.port.isDistributing()) {
+          peak = std::max(peak, load.*share);
+          total += load.*share;
+          ++active;
+        }
+      }
+      return total > 0 ? peak / (total / active) : 0;
+    }
 
-  std::string LagInterface::getName() const { return Interface::getName(); }
+  } // namespace
 
-  unsigned int LagInterface::getIndex() const { return Interface::getIndex(); }
+  bool LagPort::isActive() const { return flags & LAGG_PORT_ACTIVE; }
 
-  InterfaceType LagInterface::getType() const { return InterfaceType::LAGG; }
+  bool LagPort::isCollecting() const { return flags & LAGG_PORT_COLLECTING; }
 
-  std::vector<Flag> LagInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool LagInterface::setFlags(int flags) { return Interface::setFlags(flags); }
-  bool LagInterface::bringUp() { return Interface::bringUp(); }
-  bool LagInterface::bringDown() { return Interface::bringDown(); }
-  bool LagInterface::isUp() const { return Interface::isUp(); }
-  int LagInterface::getMtu() const { return Interface::getMtu(); }
-  bool LagInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-  std::string LagInterface::getLastError() const {
-    return Interface::getLastError();
+  bool LagPort::isDistributing() const {
+    return flags & LAGG_PORT_DISTRIBUTING;
   }
-  int LagInterface::getFib() const { return Interface::getFib(); }
-  bool LagInterface::setFib(int fib) { return Interface::setFib(fib); }
+
+  LagInterface::LagInterface(const std::string &name, unsigned int index,
+                             int flags)
+      : InterfaceBase(name, index, flags) {}
+
+  LagInterface::~LagInterface() = default;
 
   LagProtocol LagInterface::getProtocol() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return LagProtocol::UNKNOWN;
     }
@@ -67,8 +90,7 @@ namespace libfreebsdnet::interface {
     std::memset(&ra, 0, sizeof(ra));
     std::strncpy(ra.ra_ifname, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGLAGG, &ra) == 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGLAGG, &ra) == 0) {
       switch (ra.ra_proto) {
       case LAGG_PROTO_FAILOVER:
         return LagProtocol::FAILOVER;
@@ -83,12 +105,11 @@ namespace libfreebsdnet::interface {
       }
     }
 
-    close(sock);
     return LagProtocol::UNKNOWN;
   }
 
   bool LagInterface::setProtocol(LagProtocol protocol) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -119,23 +140,20 @@ namespace libfreebsdnet::interface {
     // BROADCAST not supported in enum
     default:
       // Use base class error handling
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSLAGG, &req) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGG, &req) < 0) {
       // Use base class error handling
       "Failed to set LAGG protocol: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::addInterface(const std::string &interfaceName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -146,11 +164,10 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE, &ifr) < 0) {
       if (errno != EEXIST) {
         // Use base class error handling "Failed to create lagg interface: " +
         // std::string(strerror(errno));
-        close(sock);
         return false;
       }
       // Interface already exists, that's fine
@@ -162,10 +179,9 @@ namespace libfreebsdnet::interface {
     std::strncpy(ra.ra_ifname, getName().c_str(), IFNAMSIZ - 1);
     ra.ra_proto = LAGG_PROTO_DEFAULT;
 
-    if (ioctl(sock, SIOCSLAGG, &ra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGG, &ra) < 0) {
       // Use base class error handling "Failed to set lagg protocol: " +
       // std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
@@ -175,21 +191,19 @@ namespace libfreebsdnet::interface {
     std::strncpy(req.rp_ifname, getName().c_str(), IFNAMSIZ - 1);
     std::strncpy(req.rp_portname, interfaceName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSLAGGPORT, &req) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGGPORT, &req) < 0) {
       // Use base class error handling
       "Failed to add interface to LAGG: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
     // Add to our local list
     // Ports will be retrieved by getPorts() method
-    close(sock);
     return true;
   }
 
   bool LagInterface::removeInterface(const std::string &interfaceName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -200,11 +214,10 @@ namespace libfreebsdnet::interface {
     std::strncpy(req.rp_ifname, getName().c_str(), IFNAMSIZ - 1);
     std::strncpy(req.rp_portname, interfaceName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSLAGGDELPORT, &req) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGGDELPORT, &req) < 0) {
       // Use base class error handling "Failed to remove interface from LAGG: "
       // +
       std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
@@ -212,71 +225,23 @@ namespace libfreebsdnet::interface {
     // Ports will be retrieved by getPorts() method
     // Ports will be retrieved by getPorts() method
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::hasInterface(const std::string &interfaceName) const {
-    (void)interfaceName; // Suppress unused parameter warning
-    // Ports will be retrieved by getPorts() method
-    return false;
+    auto ports = getPorts();
+    return std::find(ports.begin(), ports.end(), interfaceName) != ports.end();
   }
 
   int LagInterface::getActiveInterfaceCount() const {
-    // Ports will be retrieved by getPorts() method
-    return 0;
-  }
-
-  int LagInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool LagInterface::setMedia(int media) { return Interface::setMedia(media); }
-
-  int LagInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int LagInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> LagInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t LagInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool LagInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t LagInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool LagInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool LagInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  std::vector<std::string> LagInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool LagInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool LagInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
+    auto members = getMembers();
+    return static_cast<int>(
+        std::count_if(members.begin(), members.end(),
+                      [](const LagPort &port) { return port.isActive(); }));
   }
 
   int LagInterface::getVnet() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -285,33 +250,19 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifr.ifr_jid;
   }
 
   std::string LagInterface::getVnetJailName() const {
-    int vnetId = getVnet();
-    if (vnetId < 0) {
-      return "";
-    }
-
-    char *jailName = jail_getname(vnetId);
-    if (jailName != nullptr) {
-      std::string result(jailName);
-      free(jailName);
-      return result;
-    }
-
-    return "";
+    return VnetManager::getJailName(getVnet());
   }
 
   bool LagInterface::setVnet(int vnetId) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -322,19 +273,17 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
     ifr.ifr_jid = vnetId;
 
-    if (ioctl(sock, SIOCSIFVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0) {
       // Use base class error handling "Failed to set VNET: " +
       // std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::reclaimFromVnet() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -344,19 +293,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSIFRVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFRVNET, &ifr) < 0) {
       // Use base class error handling
       "Failed to reclaim from VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -372,23 +319,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       // Use base class error handling "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       // Use base class error handling
       "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -398,19 +342,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       // Use base class error handling
       "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool LagInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -420,54 +362,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       // Use base class error handling
       "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> LagInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
-  }
-
   std::string LagInterface::getMacAddress() const {
     struct ifaddrs *ifaddrs, *ifa;
     std::string macAddress = "";
@@ -500,7 +403,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool LagInterface::setMacAddress(const std::string &macAddress) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -516,7 +419,6 @@ namespace libfreebsdnet::interface {
                     "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &mac[0],
                     &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
       // Use base class error handling "Invalid MAC address format";
-      close(sock);
       return false;
     }
 
@@ -525,14 +427,12 @@ namespace libfreebsdnet::interface {
     ifr.ifr_addr.sa_family = AF_LINK;
     ifr.ifr_addr.sa_len = 6;
 
-    if (ioctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
       // Use base class error handling
       "Failed to set MAC address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -589,7 +489,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -604,7 +504,6 @@ namespace libfreebsdnet::interface {
     for (int i = 0; i < INFINIBAND_ADDR_LEN; i++) {
       if (std::sscanf(address.c_str() + (i * 2), "%02hhx", &addr[i]) != 1) {
         // Use base class error handling "Invalid InfiniBand address format";
-        close(sock);
         return false;
       }
     }
@@ -614,7 +513,6 @@ namespace libfreebsdnet::interface {
     // This is a limitation of the standard sockaddr structure
     // InfiniBand address setting not supported - address too long for standard
     // sockaddr
-    close(sock);
     return false;
   }
 
@@ -669,7 +567,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -685,14 +583,12 @@ namespace libfreebsdnet::interface {
       lrp.rp_flags &= ~LAGG_OPT_LACP_STRICT;
     }
 
-    if (ioctl(sock, SIOCSLAGGPORT, &lrp) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGGPORT, &lrp) < 0) {
       // Use base class error handling
       "Failed to set LACP strict mode: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -701,7 +597,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -710,12 +606,10 @@ namespace libfreebsdnet::interface {
     std::memset(&lrp, 0, sizeof(lrp));
     std::strncpy(lrp.rp_ifname, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGLAGGPORT, &lrp) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGLAGGPORT, &lrp) < 0) {
       return false;
     }
 
-    close(sock);
     return (lrp.rp_flags & LAGG_OPT_LACP_STRICT) != 0;
   }
 
@@ -725,7 +619,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -741,14 +635,12 @@ namespace libfreebsdnet::interface {
       lrp.rp_flags &= ~LAGG_OPT_LACP_FAST_TIMO;
     }
 
-    if (ioctl(sock, SIOCSLAGGPORT, &lrp) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSLAGGPORT, &lrp) < 0) {
       // Use base class error handling
       "Failed to set LACP fast timeout: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -757,7 +649,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return false;
     }
@@ -766,12 +658,10 @@ namespace libfreebsdnet::interface {
     std::memset(&lrp, 0, sizeof(lrp));
     std::strncpy(lrp.rp_ifname, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGLAGGPORT, &lrp) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGLAGGPORT, &lrp) < 0) {
       return false;
     }
 
-    close(sock);
     return (lrp.rp_flags & LAGG_OPT_LACP_FAST_TIMO) != 0;
   }
 
@@ -814,7 +704,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool LagInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling "Failed to create socket: " +
       // std::string(strerror(errno));
@@ -825,78 +715,150 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       // Use base class error handling "Failed to destroy interface: " +
       // std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::vector<std::string> LagInterface::getPorts() const {
     std::vector<std::string> ports;
+    for (auto &port : getMembers()) {
+      ports.push_back(std::move(port.name));
+    }
+    return ports;
+  }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  std::vector<LagPort> LagInterface::getMembers() const {
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
-      return ports; // Fallback to internal list
+      return {};
     }
 
-    // Use SIOCGLAGG to get lagg information
+    // The kernel caps a lagg at LAGG_MAX_PORTS, so one buffer always fits
+    std::array<struct lagg_reqport, LAGG_MAX_PORTS> buffer;
+    std::memset(buffer.data(), 0, sizeof(buffer));
+
     struct lagg_reqall ra;
     std::memset(&ra, 0, sizeof(ra));
     std::strncpy(ra.ra_ifname, getName().c_str(), IFNAMSIZ - 1);
-
-    // Allocate buffer for ports
-    struct lagg_reqport *portbuf =
-        (struct lagg_reqport *)malloc(sizeof(struct lagg_reqport) * 32);
-    if (!portbuf) {
-      close(sock);
-      return ports;
+    ra.ra_port = buffer.data();
+    ra.ra_size = sizeof(buffer);
+
+    if (metrics::tracedIoctl(sock, SIOCGLAGG, &ra) < 0) {
+      pImpl->lastError =
+          "Failed to get LAGG ports: " + std::string(strerror(errno));
+      return {};
+    }
+
+    size_t count = std::min<size_t>(ra.ra_ports, buffer.size());
+    std::vector<LagPort> ports;
+    ports.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      const struct lagg_reqport &rp = buffer[i];
+      LagPort port;
+      port.name.assign(rp.rp_portname, strnlen(rp.rp_portname, IFNAMSIZ));
+      port.index = if_nametoindex(port.name.c_str());
+      port.priority = rp.rp_prio;
+      port.flags = rp.rp_flags;
+      if (ra.ra_proto == LAGG_PROTO_LACP) {
+        const struct lacp_opreq &op = rp.rp_lacpreq;
+        port.actor =
+            decodePeer(op.actor_prio, op.actor_mac, op.actor_key,
+                       op.actor_portprio, op.actor_portno, op.actor_state);
+        port.partner = decodePeer(op.partner_prio, op.partner_mac,
+                                  op.partner_key, op.partner_portprio,
+                                  op.partner_portno, op.partner_state);
+      }
+      ports.push_back(std::move(port));
     }
+    return ports;
+  }
 
-    ra.ra_port = portbuf;
-    ra.ra_size = sizeof(struct lagg_reqport) * 32;
-
-    if (ioctl(sock, SIOCGLAGG, &ra) == 0) {
-      // Successfully got lagg info, extract ports
-      for (int i = 0; i < ra.ra_ports; i++) {
-        ports.push_back(std::string(portbuf[i].rp_portname));
+  LagLoad LagInterface::getLoad(const StatisticsSampler &sampler) const {
+    LagLoad load;
+    double totalIn = 0, totalOut = 0;
+    for (auto &port : getMembers()) {
+      LagPortLoad entry;
+      InterfaceRates rates;
+      if (port.index != 0 && sampler.getRates(port.index, rates)) {
+        entry.rates = rates.average;
       }
-      free(portbuf);
-      close(sock);
-      return ports;
+      totalIn += entry.rates.bitsIn;
+      totalOut += entry.rates.bitsOut;
+      entry.port = std::move(port);
+      load.ports.push_back(std::move(entry));
     }
 
-    free(portbuf);
-    close(sock);
-    return ports; // Fallback to internal list
+    for (auto &entry : load.ports) {
+      entry.shareIn = totalIn > 0 ? entry.rates.bitsIn / totalIn : 0;
+      entry.shareOut = totalOut > 0 ? entry.rates.bitsOut / totalOut : 0;
+    }
+    load.imbalanceIn = imbalance(load.ports, &LagPortLoad::shareIn);
+    load.imbalanceOut = imbalance(load.ports, &LagPortLoad::shareOut);
+    return load;
   }
 
   std::string LagInterface::getHashType() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
+    LagHashConfig config;
+    if (!getHashConfig(config)) {
       return "Unknown";
     }
 
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
+    std::vector<std::string> layers;
+    if (config.flags & LAGG_F_HASHL2) {
+      layers.push_back("l2");
+    }
+    if (config.flags & LAGG_F_HASHL3) {
+      layers.push_back("l3");
+    }
+    if (config.flags & LAGG_F_HASHL4) {
+      layers.push_back("l4");
+    }
+    if (layers.empty()) {
+      return "none";
+    }
 
-    // Get interface flags to determine hash type
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
-      return "Unknown";
+    std::string type = layers[0];
+    for (size_t i = 1; i < layers.size(); ++i) {
+      type += "," + layers[i];
     }
+    return type;
+  }
 
-    close(sock);
+  bool LagInterface::getHashConfig(LagHashConfig &config) const {
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      return false;
+    }
+
+    struct lagg_reqflags rf;
+    std::memset(&rf, 0, sizeof(rf));
+    std::strncpy(rf.rf_ifname, getName().c_str(), IFNAMSIZ - 1);
+    if (metrics::tracedIoctl(sock, SIOCGLAGGFLAGS, &rf) < 0) {
+      pImpl->lastError =
+          "Failed to get LAGG hash flags: " + std::string(strerror(errno));
+      return false;
+    }
 
-    // For now, return a default hash type since FreeBSD doesn't expose this
-    // directly In a real implementation, this would query the kernel for the
-    // actual hash configuration
-    return "l2,l3,l4";
+    struct lagg_reqopts ro;
+    std::memset(&ro, 0, sizeof(ro));
+    std::strncpy(ro.ro_ifname, getName().c_str(), IFNAMSIZ - 1);
+    if (metrics::tracedIoctl(sock, SIOCGLAGGOPTS, &ro) < 0) {
+      pImpl->lastError =
+          "Failed to get LAGG options: " + std::string(strerror(errno));
+      return false;
+    }
+
+    config = LagHashConfig{};
+    config.flags = rf.rf_flags & LAGG_F_HASHMASK;
+    config.useFlowId = ro.ro_opts & LAGG_OPT_USE_FLOWID;
+    config.flowIdShift = ro.ro_flowid_shift;
+    return true;
   }
 
 } // namespace libfreebsdnet::interface
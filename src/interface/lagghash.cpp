@@ -0,0 +1,116 @@
+/**
+ * @file interface/lagghash.cpp
+ * @brief Offline LAGG hash simulator implementation
+ * @details Port of the kernel's m_ether_tcpip_hash() over flow records
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <interface/lagghash.hpp>
+#include <net/if_lagg.h>
+#include <netinet/in.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // fnv_32_buf() from sys/fnv_hash.h
+    inline uint32_t hashBytes(const void *buf, size_t len, uint32_t hash) {
+      const uint8_t *p = static_cast<const uint8_t *>(buf);
+      while (len--) {
+        hash *= 0x01000193;
+        hash ^= *p++;
+      }
+      return hash;
+    }
+
+    inline bool hasPorts(uint8_t protocol) {
+      return protocol == IPPROTO_TCP || protocol == IPPROTO_UDP ||
+             protocol == IPPROTO_SCTP;
+    }
+
+  } // namespace
+
+  LagHashSimulator::LagHashSimulator(const LagHashConfig &config,
+                                     unsigned int ports)
+      : config_(config), ports_(ports) {}
+
+  uint32_t LagHashSimulator::hash(const LagFlow &flow) const {
+    if (config_.useFlowId) {
+      return flow.flowId >> config_.flowIdShift;
+    }
+
+    uint32_t p = config_.key;
+    if (config_.flags & LAGG_F_HASHL2) {
+      p = hashBytes(flow.srcMac.data(), flow.srcMac.size(), p);
+      p = hashBytes(flow.dstMac.data(), flow.dstMac.size(), p);
+      if (flow.vlan != 0) {
+        // Hardware-tagged frames hash ether_vtag in host order
+        p = hashBytes(&flow.vlan, sizeof(flow.vlan), p);
+      }
+    }
+
+    if (flow.srcIp.isIPv4()) {
+      if (config_.flags & LAGG_F_HASHL3) {
+        p = hashBytes(flow.srcIp.getBytes().data(), 4, p);
+        p = hashBytes(flow.dstIp.getBytes().data(), 4, p);
+      }
+      if ((config_.flags & LAGG_F_HASHL4) && hasPorts(flow.protocol)) {
+        // Both ports as one 32-bit word straight from the header
+        const uint8_t ports[4] = {
+            static_cast<uint8_t>(flow.srcPort >> 8),
+            static_cast<uint8_t>(flow.srcPort),
+            static_cast<uint8_t>(flow.dstPort >> 8),
+            static_cast<uint8_t>(flow.dstPort)};
+        p = hashBytes(ports, sizeof(ports), p);
+      }
+    } else if (flow.srcIp.isIPv6()) {
+      if (config_.flags & LAGG_F_HASHL3) {
+        p = hashBytes(flow.srcIp.getBytes().data(), 16, p);
+        p = hashBytes(flow.dstIp.getBytes().data(), 16, p);
+      }
+      if (config_.flags & LAGG_F_HASHL4) {
+        uint32_t label = htonl(flow.flowLabel & 0x000fffff);
+        p = hashBytes(&label, sizeof(label), p);
+      }
+    }
+    return p;
+  }
+
+  unsigned int LagHashSimulator::select(const LagFlow &flow) const {
+    return ports_ == 0 ? 0 : hash(flow) % ports_;
+  }
+
+  size_t LagHashSimulator::select(std::span<const LagFlow> flows,
+                                  std::span<uint16_t> ports) const {
+    size_t count = std::min(flows.size(), ports.size());
+    for (size_t i = 0; i < count; ++i) {
+      ports[i] = static_cast<uint16_t>(select(flows[i]));
+    }
+    return count;
+  }
+
+  std::vector<uint64_t>
+  LagHashSimulator::distribute(std::span<const LagFlow> flows) const {
+    std::vector<uint64_t> counts(std::max(ports_, 1u), 0);
+    for (const LagFlow &flow : flows) {
+      ++counts[select(flow)];
+    }
+    return counts;
+  }
+
+  double LagHashSimulator::imbalance(std::span<const uint64_t> counts) {
+    if (counts.empty()) {
+      return 0;
+    }
+    uint64_t peak = 0, total = 0;
+    for (uint64_t count : counts) {
+      peak = std::max(peak, count);
+      total += count;
+    }
+    return total > 0 ? static_cast<double>(peak) * counts.size() / total : 0;
+  }
+
+} // namespace libfreebsdnet::interface
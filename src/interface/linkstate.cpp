@@ -0,0 +1,414 @@
+/**
+ * @file interface/linkstate.cpp
+ * @brief Link-state transition tracker implementation
+ * @details Per-interface state machine fed by netlink link events, with
+ * preallocated rings for history, downtimes and carrier delays
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <interface/base.hpp>
+#include <interface/linkstate.hpp>
+#include <interface/statistics.hpp>
+#include <map>
+#include <mutex>
+#include <net/if.h>
+#include <netlink/manager.hpp>
+#include <system/budget.hpp>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using Duration = std::chrono::nanoseconds;
+
+    // Fixed-capacity ring; the oldest entry is overwritten once full
+    template <typename T> class Ring {
+    public:
+      explicit Ring(size_t capacity) : items(capacity) {}
+
+      void push(const T &value) {
+        if (items.empty()) {
+          return;
+        }
+        items[next] = value;
+        next = (next + 1) % items.size();
+        count = std::min(count + 1, items.size());
+      }
+
+      void clear() {
+        next = 0;
+        count = 0;
+      }
+
+      // Frees the storage; later pushes are dropped
+      size_t release() {
+        size_t bytes = capacityBytes();
+        std::vector<T>().swap(items);
+        clear();
+        return bytes;
+      }
+
+      size_t capacityBytes() const { return items.capacity() * sizeof(T); }
+
+      size_t size() const { return count; }
+
+      // Oldest first
+      std::vector<T> ordered() const {
+        std::vector<T> out;
+        if (count == 0) {
+          return out;
+        }
+        out.reserve(count);
+        size_t first = (next + items.size() - count) % items.size();
+        for (size_t i = 0; i < count; ++i) {
+          out.push_back(items[(first + i) % items.size()]);
+        }
+        return out;
+      }
+
+    private:
+      std::vector<T> items;
+      size_t next = 0;
+      size_t count = 0;
+    };
+
+    OperState parseOperState(const std::string &value) {
+      if (value == "UP") {
+        return OperState::UP;
+      } else if (value == "DOWN") {
+        return OperState::DOWN;
+      } else if (value == "LOWERLAYERDOWN") {
+        return OperState::LOWERLAYERDOWN;
+      } else if (value == "DORMANT") {
+        return OperState::DORMANT;
+      } else if (value == "TESTING") {
+        return OperState::TESTING;
+      } else if (value == "NOTPRESENT") {
+        return OperState::NOTPRESENT;
+      }
+      return OperState::UNKNOWN;
+    }
+
+    // Nearest-rank percentile of sorted samples
+    Duration percentile(const std::vector<Duration> &sorted, int p) {
+      if (sorted.empty()) {
+        return Duration{0};
+      }
+      size_t rank = (sorted.size() * p + 99) / 100;
+      return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    struct Entry {
+      std::string name;
+      OperState state = OperState::UNKNOWN;
+      bool adminUp = false;
+      bool down = false; // an outage is open
+      Clock::time_point downSince;
+      bool pendingCarrier = false;
+      Clock::time_point bringUpAt;
+      uint64_t transitions = 0;
+      uint64_t flaps = 0;
+      Duration totalDowntime{0};
+      Ring<Duration> downtimes;
+      Ring<Duration> carrier;
+
+      explicit Entry(size_t samples) : downtimes(samples), carrier(samples) {}
+    };
+
+  } // namespace
+
+  class LinkStateTracker::Impl {
+  public:
+    mutable std::mutex mutex;
+    LinkStateTrackerOptions options;
+    std::map<unsigned int, Entry> entries; // by interface index
+    Ring<LinkTransition> history;
+    netlink::NetlinkManager netlink;
+    bool running = false;
+    std::string lastError;
+    // History and samples are optional; evicting them leaves state and
+    // counters tracked. Declared last so it unregisters first.
+    system::CacheAccount account;
+
+    explicit Impl(const LinkStateTrackerOptions &options)
+        : options(options), history(options.historySize),
+          account("interface.linkstate", system::CachePriority::OPTIONAL,
+                  [this](size_t) { return evict(); }) {}
+
+    // Caller holds the mutex
+    size_t usage() const {
+      size_t bytes = history.capacityBytes();
+      for (const auto &[index, e] : entries) {
+        bytes += sizeof(Entry) + e.name.capacity() +
+                 e.downtimes.capacityBytes() + e.carrier.capacityBytes();
+      }
+      return bytes;
+    }
+
+    size_t evict() {
+      std::lock_guard<std::mutex> lock(mutex);
+      // New interfaces get no rings either
+      options.historySize = 0;
+      options.samplesPerInterface = 0;
+      size_t bytes = history.release();
+      for (auto &[index, e] : entries) {
+        bytes += e.downtimes.release() + e.carrier.release();
+      }
+      return bytes;
+    }
+
+    // Caller holds the mutex
+    Entry &entry(unsigned int index) {
+      auto it = entries.find(index);
+      if (it == entries.end()) {
+        it = entries.try_emplace(index, options.samplesPerInterface).first;
+      }
+      return it->second;
+    }
+
+    // Caller holds the mutex
+    void apply(Entry &e, unsigned int index, OperState to, bool adminUp,
+               Clock::time_point now) {
+      if (to == e.state && adminUp == e.adminUp) {
+        return;
+      }
+      history.push({now, index, e.state, to, adminUp});
+      ++e.transitions;
+
+      if (e.state == OperState::UP && to != OperState::UP) {
+        ++e.flaps;
+        e.down = true;
+        e.downSince = now;
+      } else if (e.state != OperState::UP && to == OperState::UP) {
+        if (e.down) {
+          Duration outage =
+              std::chrono::duration_cast<Duration>(now - e.downSince);
+          e.totalDowntime += outage;
+          e.downtimes.push(outage);
+          e.down = false;
+        }
+        if (e.pendingCarrier) {
+          e.carrier.push(
+              std::chrono::duration_cast<Duration>(now - e.bringUpAt));
+          e.pendingCarrier = false;
+        }
+      }
+      e.state = to;
+      e.adminUp = adminUp;
+    }
+
+    void onEvents(const netlink::NetlinkEventBatch &batch) {
+      auto now = Clock::now();
+      std::unique_lock<std::mutex> lock(mutex);
+      size_t known = entries.size();
+      for (const auto &event : batch.links) {
+        unsigned int index = static_cast<unsigned int>(event.info.index);
+        Entry &e = entry(index);
+        if (!event.info.name.empty()) {
+          e.name = event.info.name;
+        }
+        if (event.type == netlink::NetlinkMessageType::DELLINK) {
+          apply(e, index, OperState::NOTPRESENT, false, now);
+        } else {
+          apply(e, index, parseOperState(event.info.operstate),
+                (event.info.flags & IFF_UP) != 0, now);
+        }
+      }
+      if (entries.size() != known) {
+        size_t bytes = usage();
+        lock.unlock();
+        account.setUsage(bytes);
+      }
+    }
+
+    void fill(unsigned int index, const Entry &e, LinkStateReport &report,
+              Clock::time_point now) const {
+      report.name = e.name;
+      report.index = index;
+      report.state = e.state;
+      report.transitions = e.transitions;
+      report.flaps = e.flaps;
+      report.totalDowntime = e.totalDowntime;
+      if (e.down) {
+        report.totalDowntime +=
+            std::chrono::duration_cast<Duration>(now - e.downSince);
+      }
+
+      std::vector<Duration> samples = e.downtimes.ordered();
+      std::sort(samples.begin(), samples.end());
+      report.downtimeSamples = samples.size();
+      report.downtimeP50 = percentile(samples, 50);
+      report.downtimeP90 = percentile(samples, 90);
+      report.downtimeP99 = percentile(samples, 99);
+      report.downtimeMax = samples.empty() ? Duration{0} : samples.back();
+
+      samples = e.carrier.ordered();
+      std::sort(samples.begin(), samples.end());
+      report.carrierSamples = samples.size();
+      report.carrierP50 = percentile(samples, 50);
+      report.carrierMax = samples.empty() ? Duration{0} : samples.back();
+    }
+  };
+
+  LinkStateTracker::LinkStateTracker(const LinkStateTrackerOptions &options)
+      : pImpl(std::make_unique<Impl>(options)) {}
+
+  LinkStateTracker::~LinkStateTracker() { stop(); }
+
+  bool LinkStateTracker::start() {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (pImpl->running) {
+        return true;
+      }
+    }
+
+    // Baseline from one dump; an interface already down is charged from
+    // its last change
+    StatisticsCollector collector;
+    auto steadyNow = Clock::now();
+    auto systemNow = std::chrono::system_clock::now();
+    std::unique_lock<std::mutex> lock(pImpl->mutex);
+    bool seeded = collector.forEachStatistics(
+        [&](unsigned int index, std::string_view name,
+            const InterfaceStatistics &stats) {
+          Entry &e = pImpl->entry(index);
+          e.name = std::string(name);
+          if (stats.linkState == LINK_STATE_UP) {
+            e.state = OperState::UP;
+          } else if (stats.linkState == LINK_STATE_DOWN) {
+            e.state = OperState::DOWN;
+            e.down = true;
+            auto age = std::max(systemNow - stats.lastChange,
+                                std::chrono::system_clock::duration::zero());
+            e.downSince = steadyNow -
+                          std::chrono::duration_cast<Clock::duration>(age);
+          }
+          return true;
+        });
+    if (!seeded) {
+      pImpl->lastError = "Failed to read interface link states";
+      return false;
+    }
+    size_t bytes = pImpl->usage();
+    lock.unlock();
+    pImpl->account.setUsage(bytes);
+
+    // One event per batch, so each is timestamped as it arrives
+    netlink::NetlinkMonitorOptions options;
+    options.groups = netlink::GROUP_LINK;
+    options.maxBatchSize = 1;
+    Impl *impl = pImpl.get();
+    if (!pImpl->netlink.startMonitoring(
+            [impl](const netlink::NetlinkEventBatch &batch) {
+              impl->onEvents(batch);
+            },
+            options)) {
+      lock.lock();
+      pImpl->lastError = pImpl->netlink.getLastError();
+      return false;
+    }
+
+    lock.lock();
+    pImpl->running = true;
+    return true;
+  }
+
+  bool LinkStateTracker::stop() {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      if (!pImpl->running) {
+        return true;
+      }
+    }
+    bool result = pImpl->netlink.stopMonitoring();
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->running = false;
+    return result;
+  }
+
+  bool LinkStateTracker::bringUp(Interface &interface) {
+    unsigned int index = interface.getIndex();
+    // Armed first: the carrier event may arrive before bringUp() returns
+    markBringUp(index);
+    if (interface.bringUp()) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->entry(index).pendingCarrier = false;
+    pImpl->lastError = interface.getLastError();
+    return false;
+  }
+
+  void LinkStateTracker::markBringUp(unsigned int index) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    Entry &e = pImpl->entry(index);
+    if (e.state == OperState::UP) {
+      return; // no carrier transition will follow
+    }
+    e.pendingCarrier = true;
+    e.bringUpAt = Clock::now();
+  }
+
+  bool LinkStateTracker::getReport(const std::string &name,
+                                   LinkStateReport &report) const {
+    unsigned int index = if_nametoindex(name.c_str());
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->entries.find(index);
+    if (index == 0 || it == pImpl->entries.end()) {
+      // Departed interfaces are still found by their last name
+      it = std::find_if(pImpl->entries.begin(), pImpl->entries.end(),
+                        [&](const auto &pair) {
+                          return pair.second.name == name;
+                        });
+      if (it == pImpl->entries.end()) {
+        return false;
+      }
+    }
+    pImpl->fill(it->first, it->second, report, now);
+    return true;
+  }
+
+  std::vector<LinkStateReport> LinkStateTracker::getReports() const {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    std::vector<LinkStateReport> reports(pImpl->entries.size());
+    size_t i = 0;
+    for (const auto &[index, e] : pImpl->entries) {
+      pImpl->fill(index, e, reports[i++], now);
+    }
+    return reports;
+  }
+
+  std::vector<LinkTransition> LinkStateTracker::getHistory() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->history.ordered();
+  }
+
+  void LinkStateTracker::reset() {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->history.clear();
+    for (auto &[index, e] : pImpl->entries) {
+      e.transitions = 0;
+      e.flaps = 0;
+      e.totalDowntime = Duration{0};
+      e.downtimes.clear();
+      e.carrier.clear();
+      if (e.down) {
+        e.downSince = now;
+      }
+    }
+  }
+
+  std::string LinkStateTracker::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,145 @@
+/**
+ * @file interface/list.cpp
+ * @brief Arena-backed interface enumeration result implementation
+ * @details Monotonic arena holding the interface objects, their pImpl state
+ * and the lookup tables
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <interface/list.hpp>
+#include <net/if.h>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // Rough footprint of one interface object with its private state
+    constexpr size_t BYTES_PER_INTERFACE = 512;
+
+    // Tracks what the arena draws from the heap
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+      size_t reserved = 0;
+
+    private:
+      void *do_allocate(size_t bytes, size_t alignment) override {
+        void *p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        reserved += bytes;
+        return p;
+      }
+
+      void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        reserved -= bytes;
+      }
+
+      bool do_is_equal(
+          const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+      }
+    };
+
+  } // namespace
+
+  class InterfaceList::Impl {
+  public:
+    CountingResource upstream;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Interface *> objects;
+    std::pmr::vector<std::array<char, IFNAMSIZ>> names;
+    std::pmr::vector<unsigned int> indexes;
+
+    explicit Impl(size_t expected)
+        : arena(std::max<size_t>(expected, 1) * BYTES_PER_INTERFACE,
+                &upstream),
+          objects(&arena), names(&arena), indexes(&arena) {
+      objects.reserve(expected);
+      names.reserve(expected);
+      indexes.reserve(expected);
+    }
+
+    ~Impl() {
+      // Destructors run normally; their arena blocks go with the arena
+      for (Interface *interface : objects) {
+        delete interface;
+      }
+    }
+  };
+
+  InterfaceList::InterfaceList() : pImpl(std::make_unique<Impl>(0)) {}
+
+  InterfaceList::InterfaceList(size_t expected)
+      : pImpl(std::make_unique<Impl>(expected)) {}
+
+  InterfaceList::~InterfaceList() = default;
+
+  InterfaceList::InterfaceList(InterfaceList &&) noexcept = default;
+
+  InterfaceList &InterfaceList::operator=(InterfaceList &&) noexcept = default;
+
+  std::pmr::memory_resource *InterfaceList::getArena() const {
+    return &pImpl->arena;
+  }
+
+  void InterfaceList::append(std::unique_ptr<Interface> interface) {
+    if (!interface) {
+      return;
+    }
+    std::array<char, IFNAMSIZ> name{};
+    std::string text = interface->getName();
+    std::memcpy(name.data(), text.data(),
+                std::min(text.size(), name.size() - 1));
+    pImpl->names.push_back(name);
+    pImpl->indexes.push_back(interface->getIndex());
+    pImpl->objects.push_back(interface.release());
+  }
+
+  std::span<Interface *const> InterfaceList::getInterfaces() const {
+    if (!pImpl) {
+      return {};
+    }
+    return pImpl->objects;
+  }
+
+  Interface *InterfaceList::find(std::string_view name) const {
+    if (!pImpl || name.size() >= IFNAMSIZ) {
+      return nullptr;
+    }
+    for (size_t i = 0; i < pImpl->names.size(); ++i) {
+      const auto &entry = pImpl->names[i];
+      if (std::memcmp(entry.data(), name.data(), name.size()) == 0 &&
+          entry[name.size()] == '\0') {
+        return pImpl->objects[i];
+      }
+    }
+    return nullptr;
+  }
+
+  Interface *InterfaceList::find(unsigned int index) const {
+    if (!pImpl) {
+      return nullptr;
+    }
+    auto it = std::find(pImpl->indexes.begin(), pImpl->indexes.end(), index);
+    if (it == pImpl->indexes.end()) {
+      return nullptr;
+    }
+    return pImpl->objects[it - pImpl->indexes.begin()];
+  }
+
+  size_t InterfaceList::size() const {
+    return pImpl ? pImpl->objects.size() : 0;
+  }
+
+  bool InterfaceList::empty() const { return size() == 0; }
+
+  size_t InterfaceList::getArenaSize() const {
+    return pImpl ? pImpl->upstream.reserved : 0;
+  }
+
+} // namespace libfreebsdnet::interface
@@ -7,6 +7,10 @@
  * @year 2024
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <ifaddrs.h>
 #include <interface/bridge.hpp>
 #include <interface/carp.hpp>
@@ -19,8 +23,14 @@
 #include <interface/manager.hpp>
 #include <interface/pflog.hpp>
 #include <interface/pfsync.hpp>
+#include <interface/registry.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
 #include <interface/vlan.hpp>
 #include <interface/wireless.hpp>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -30,231 +40,359 @@
 #include <net80211/ieee80211_ioctl.h>
 #include <netinet/in.h>
 #include <set>
+#include <shared_mutex>
 #include <stdexcept>
 #include <sys/ioctl.h>
 #include <sys/sockio.h>
+#include <system/budget.hpp>
+#include <thread>
 #include <unistd.h>
 
 namespace libfreebsdnet::interface {
 
-  Manager::Manager() {
-    socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (socket_fd < 0) {
-      throw std::runtime_error(
-          "Failed to create socket for interface operations");
+  class Manager::Impl {
+  public:
+    mutable std::shared_mutex snapshotMutex;
+    std::mutex refreshMutex; // held by the one caller refreshing
+    std::shared_ptr<const InterfaceSnapshot> snapshot;
+    std::atomic<bool> stale{false};
+    // Created with the first shared snapshot; declared last so it
+    // unregisters before the snapshot goes
+    std::unique_ptr<system::CacheAccount> account;
+
+    size_t evict() {
+      std::unique_lock<std::shared_mutex> lock(snapshotMutex);
+      size_t bytes = snapshot ? snapshot->getMemoryUsage() : 0;
+      snapshot.reset();
+      return bytes;
     }
+
+    std::shared_ptr<const InterfaceSnapshot>
+    current(std::chrono::milliseconds maxAge, bool &fresh) const {
+      std::shared_lock<std::shared_mutex> lock(snapshotMutex);
+      fresh = snapshot && !stale.load(std::memory_order_acquire) &&
+              std::chrono::steady_clock::now() - snapshot->getTimestamp() <
+                  maxAge;
+      return snapshot;
+    }
+  };
+
+  // The control socket is opened per thread by the first ioctl, so a
+  // manager that only reads sysctl dumps never creates one
+  Manager::Manager() : pImpl(std::make_unique<Impl>()) {}
+
+  Manager::~Manager() = default;
+
+  std::shared_ptr<InterfaceSnapshot> Manager::getSnapshot() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getSnapshot");
+    auto snapshot = std::make_shared<InterfaceSnapshot>();
+    if (!snapshot->refresh()) {
+      return nullptr;
+    }
+    return snapshot;
   }
 
-  Manager::~Manager() {
-    if (socket_fd >= 0) {
-      close(socket_fd);
+  std::shared_ptr<const InterfaceSnapshot>
+  Manager::getSharedSnapshot(std::chrono::milliseconds maxAge) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getSharedSnapshot");
+    bool fresh = false;
+    auto snapshot = pImpl->current(maxAge, fresh);
+    if (fresh) {
+      return snapshot;
+    }
+
+    std::unique_lock<std::mutex> refresh(pImpl->refreshMutex,
+                                         std::try_to_lock);
+    if (!refresh.owns_lock()) {
+      if (snapshot) {
+        return snapshot;
+      }
+      refresh.lock();
+    }
+    // Another caller may have refreshed while this one waited
+    snapshot = pImpl->current(maxAge, fresh);
+    if (fresh) {
+      return snapshot;
+    }
+
+    pImpl->stale.store(false, std::memory_order_release);
+    std::shared_ptr<const InterfaceSnapshot> taken = getSnapshot();
+    if (!taken) {
+      return snapshot;
+    }
+    {
+      std::unique_lock<std::shared_mutex> lock(pImpl->snapshotMutex);
+      pImpl->snapshot = taken;
     }
+    if (!pImpl->account) {
+      Impl *impl = pImpl.get();
+      pImpl->account = std::make_unique<system::CacheAccount>(
+          "interface.snapshot", system::CachePriority::CACHED,
+          [impl](size_t) { return impl->evict(); });
+    }
+    pImpl->account->touch();
+    pImpl->account->setUsage(taken->getMemoryUsage());
+    return taken;
   }
 
-  std::vector<std::unique_ptr<Interface>> Manager::getInterfaces() const {
-    std::vector<std::unique_ptr<Interface>> interfaces;
-    struct ifaddrs *ifaddrs_ptr;
+  void Manager::invalidateSharedSnapshot() const {
+    pImpl->stale.store(true, std::memory_order_release);
+  }
 
-    if (getifaddrs(&ifaddrs_ptr) == -1) {
-      return interfaces;
-    }
-
-    for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
-         ifa = ifa->ifa_next) {
-      // Only process link-level addresses (AF_LINK) to avoid duplicates
-      if (ifa->ifa_name && ifa->ifa_addr &&
-          ifa->ifa_addr->sa_family == AF_LINK) {
-        std::string if_name(ifa->ifa_name);
-        unsigned int index = if_nametoindex(ifa->ifa_name);
-
-        struct ifreq ifr;
-        std::strncpy(ifr.ifr_name, ifa->ifa_name, IFNAMSIZ - 1);
-        ifr.ifr_name[IFNAMSIZ - 1] = '\0';
-
-        if (ioctl(socket_fd, SIOCGIFFLAGS, &ifr) == 0) {
-          // Create the correct interface class based on name pattern matching
-          std::unique_ptr<Interface> interface = nullptr;
-          std::string name(ifa->ifa_name);
-
-          if (name.substr(0, 6) == "bridge") {
-            interface = std::make_unique<BridgeInterface>(ifa->ifa_name, index,
-                                                          ifr.ifr_flags);
-          } else if (name.substr(0, 4) == "lagg") {
-            interface = std::make_unique<LagInterface>(ifa->ifa_name, index,
-                                                       ifr.ifr_flags);
-          } else if (name.substr(0, 3) == "gif") {
-            interface = std::make_unique<GifInterface>(ifa->ifa_name, index,
-                                                       ifr.ifr_flags);
-          } else if (name.substr(0, 2) == "lo") {
-            interface = std::make_unique<LoopbackInterface>(
-                ifa->ifa_name, index, ifr.ifr_flags);
-          } else if (name.substr(0, 5) == "epair") {
-            interface = std::make_unique<EpairInterface>(ifa->ifa_name, index,
-                                                         ifr.ifr_flags);
-          } else if (name.substr(0, 4) == "vlan") {
-            interface = std::make_unique<VlanInterface>(ifa->ifa_name, index,
-                                                        ifr.ifr_flags);
-          } else if (name.substr(0, 6) == "l2vlan") {
-            interface = std::make_unique<L2VlanInterface>(ifa->ifa_name, index,
-                                                          ifr.ifr_flags);
-          } else if (name.substr(0, 5) == "pfsync") {
-            interface = std::make_unique<PfsyncInterface>(ifa->ifa_name, index,
-                                                          ifr.ifr_flags);
-          } else if (name.substr(0, 5) == "pflog") {
-            interface = std::make_unique<PflogInterface>(ifa->ifa_name, index,
-                                                         ifr.ifr_flags);
-          } else if (name.substr(0, 4) == "carp") {
-            interface = std::make_unique<CarpInterface>(ifa->ifa_name, index,
-                                                        ifr.ifr_flags);
-          } else {
-            // Default to Ethernet for everything else
-            interface = std::make_unique<EthernetInterface>(
-                ifa->ifa_name, index, ifr.ifr_flags);
-          }
+  std::vector<InterfaceView> Manager::getViews() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getViews");
+    auto snapshot = getSnapshot();
+    if (!snapshot) {
+      return {};
+    }
+    return getViews(*snapshot);
+  }
 
-          if (interface) {
-            interfaces.push_back(std::move(interface));
-          }
-        }
-      }
+  std::vector<InterfaceView>
+  Manager::getViews(const InterfaceSnapshot &snapshot) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getViews(snapshot)");
+    std::vector<InterfaceView> views(snapshot.size());
+    size_t i = 0;
+    for (const auto &record : snapshot.getRecords()) {
+      InterfaceView &view = views[i++];
+      view.index = record->index;
+      view.flags = record->flags;
+      view.mtu = record->getMtu();
+      view.type = InterfaceRegistry::classify(record->name, record->type);
+      view.linkType = record->type;
+      view.linkLength = record->linkLength;
+      std::memcpy(view.linkAddress, record->linkBytes.data(),
+                  sizeof(view.linkAddress));
+      std::memcpy(view.name, record->name.data(),
+                  std::min(record->name.size(), sizeof(view.name) - 1));
     }
+    return views;
+  }
 
-    freeifaddrs(ifaddrs_ptr);
-    return interfaces;
+  std::unique_ptr<Interface>
+  Manager::upgrade(const InterfaceView &view) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::upgrade");
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh(view.index)) {
+      return nullptr;
+    }
+    return upgrade(view, snapshot);
   }
 
   std::unique_ptr<Interface>
-  Manager::getInterface(const std::string &name) const {
-    struct ifaddrs *ifaddrs_ptr;
-    if (getifaddrs(&ifaddrs_ptr) == -1) {
+  Manager::upgrade(const InterfaceView &view,
+                   const InterfaceSnapshot &snapshot) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::upgrade(snapshot)");
+    auto record = snapshot.find(view.index);
+    if (!record || record->name != view.getName()) {
       return nullptr;
     }
+    return createFromRecord(std::move(record));
+  }
 
-    for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
-         ifa = ifa->ifa_next) {
-      if (ifa->ifa_name && std::string(ifa->ifa_name) == name &&
-          ifa->ifa_addr) {
-        unsigned int index = if_nametoindex(ifa->ifa_name);
+  std::vector<std::unique_ptr<Interface>> Manager::getInterfaces() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterfaces");
+    auto snapshot = getSnapshot();
+    if (!snapshot) {
+      return {};
+    }
+    return getInterfaces(*snapshot);
+  }
 
-        struct ifreq ifr;
-        std::strncpy(ifr.ifr_name, ifa->ifa_name, IFNAMSIZ - 1);
-        ifr.ifr_name[IFNAMSIZ - 1] = '\0';
+  std::vector<std::unique_ptr<Interface>>
+  Manager::getInterfaces(const InterfaceSnapshot &snapshot) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterfaces(snapshot)");
+    std::vector<std::unique_ptr<Interface>> interfaces;
+    interfaces.reserve(snapshot.size());
 
-        if (ioctl(socket_fd, SIOCGIFFLAGS, &ifr) == 0) {
-          // Get the actual interface type from the system using sockaddr_dl
-          std::unique_ptr<Interface> interface = nullptr;
+    for (const auto &record : snapshot.getRecords()) {
+      interfaces.push_back(createFromRecord(record));
+    }
 
-          // Check if this is a link-level address (sockaddr_dl)
-          if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_LINK) {
-            // Create the correct interface class based on name pattern matching
-            std::string if_name(ifa->ifa_name);
+    return interfaces;
+  }
 
-            // First check if this is a bridge or lagg by name pattern
-            if (if_name.substr(0, 6) == "bridge") {
-              interface = std::make_unique<BridgeInterface>(
-                  ifa->ifa_name, index, ifr.ifr_flags);
-            } else if (if_name.substr(0, 4) == "lagg") {
-              interface = std::make_unique<LagInterface>(ifa->ifa_name, index,
-                                                         ifr.ifr_flags);
-            } else if (if_name.substr(0, 3) == "gif") {
-              interface = std::make_unique<GifInterface>(ifa->ifa_name, index,
-                                                         ifr.ifr_flags);
-            } else if (if_name.substr(0, 2) == "lo") {
-              interface = std::make_unique<LoopbackInterface>(
-                  ifa->ifa_name, index, ifr.ifr_flags);
-            } else if (if_name.substr(0, 5) == "epair") {
-              interface = std::make_unique<EpairInterface>(ifa->ifa_name, index,
-                                                           ifr.ifr_flags);
-            } else if (if_name.substr(0, 4) == "vlan") {
-              interface = std::make_unique<VlanInterface>(ifa->ifa_name, index,
-                                                          ifr.ifr_flags);
-            } else if (if_name.substr(0, 6) == "l2vlan") {
-              interface = std::make_unique<L2VlanInterface>(
-                  ifa->ifa_name, index, ifr.ifr_flags);
-            } else if (if_name.substr(0, 5) == "pfsync") {
-              interface = std::make_unique<PfsyncInterface>(
-                  ifa->ifa_name, index, ifr.ifr_flags);
-            } else if (if_name.substr(0, 5) == "pflog") {
-              interface = std::make_unique<PflogInterface>(ifa->ifa_name, index,
-                                                           ifr.ifr_flags);
-            } else if (if_name.substr(0, 4) == "carp") {
-              interface = std::make_unique<CarpInterface>(ifa->ifa_name, index,
-                                                          ifr.ifr_flags);
-            } else {
-              // Default to Ethernet for everything else
-              interface = std::make_unique<EthernetInterface>(
-                  ifa->ifa_name, index, ifr.ifr_flags);
-            }
-          }
+  InterfaceList Manager::getInterfaceList() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterfaceList");
+    auto snapshot = getSnapshot();
+    if (!snapshot) {
+      return {};
+    }
+    return getInterfaceList(*snapshot);
+  }
 
-          // Fallback to EthernetInterface if type detection failed
-          if (!interface) {
-            interface = std::make_unique<EthernetInterface>(
-                ifa->ifa_name, index, ifr.ifr_flags);
-          }
+  InterfaceList
+  Manager::getInterfaceList(const InterfaceSnapshot &snapshot) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterfaceList(snapshot)");
+    InterfaceList list(snapshot.size());
+    ArenaScope scope(list.getArena());
+    for (const auto &record : snapshot.getRecords()) {
+      list.append(createFromRecord(record));
+    }
+    return list;
+  }
 
-          freeifaddrs(ifaddrs_ptr);
-          return interface;
-        }
+  AddressTable Manager::getAllAddresses() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getAllAddresses");
+    auto snapshot = getSnapshot();
+    if (!snapshot) {
+      return {};
+    }
+    return getAllAddresses(*snapshot);
+  }
+
+  AddressTable
+  Manager::getAllAddresses(const InterfaceSnapshot &snapshot) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getAllAddresses(snapshot)");
+    size_t total = 0;
+    for (const auto &record : snapshot.getRecords()) {
+      total += record->addresses.size();
+    }
+    AddressTable table;
+    table.reserve(snapshot.size(), total);
+    for (const auto &record : snapshot.getRecords()) {
+      table.append(record->index, record->addresses);
+    }
+    return table;
+  }
+
+  std::vector<MediaSnapshot>
+  Manager::getEthernetMedia(unsigned int workers) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getEthernetMedia");
+    auto snapshot = getSharedSnapshot();
+    if (!snapshot) {
+      return {};
+    }
+    std::vector<std::string> names;
+    for (const auto &record : snapshot->getRecords()) {
+      if (record->type == IFT_ETHER) {
+        names.push_back(record->name);
+      }
+    }
+    if (workers == 0) {
+      workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    }
+
+    // Each worker has its own control socket, so the ioctls run in parallel
+    std::vector<types::NetResult<MediaSnapshot>> results(
+        names.size(), std::unexpected(types::NetError{}));
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for (size_t i; (i = next.fetch_add(1)) < names.size();) {
+        results[i] = readMediaSnapshot(names[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    size_t count = std::min<size_t>(workers, names.size());
+    for (size_t slot = 1; slot < count; ++slot) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<MediaSnapshot> media;
+    media.reserve(results.size());
+    for (auto &result : results) {
+      if (result) {
+        media.push_back(std::move(*result));
       }
     }
+    return media;
+  }
 
-    freeifaddrs(ifaddrs_ptr);
-    return nullptr;
+  std::unique_ptr<Interface>
+  Manager::getInterface(const std::string &name) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterface");
+    unsigned int index = if_nametoindex(name.c_str());
+    if (index == 0) {
+      return nullptr;
+    }
+    return getInterface(index);
   }
 
   std::unique_ptr<Interface> Manager::getInterface(unsigned int index) const {
-    struct ifaddrs *ifaddrs_ptr;
-    if (getifaddrs(&ifaddrs_ptr) == -1) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterface(index)");
+    // Restrict the dump to this one interface
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh(index)) {
       return nullptr;
     }
 
-    for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
-         ifa = ifa->ifa_next) {
-      if (ifa->ifa_name && ifa->ifa_addr) {
-        unsigned int if_index = if_nametoindex(ifa->ifa_name);
-        if (if_index == index) {
-          auto interface = getInterface(ifa->ifa_name);
-          freeifaddrs(ifaddrs_ptr);
-          return interface;
-        }
-      }
+    auto record = snapshot.find(index);
+    if (!record) {
+      return nullptr;
     }
+    return createFromRecord(record);
+  }
 
-    freeifaddrs(ifaddrs_ptr);
-    return nullptr;
+  std::unique_ptr<Interface>
+  Manager::getInterface(const InterfaceIdentity &identity) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterface(identity)");
+    if (IdentityTracker::isRunning() &&
+        IdentityTracker::getGeneration(identity.index) !=
+            identity.generation) {
+      return nullptr;
+    }
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh(identity.index)) {
+      return nullptr;
+    }
+    auto record = snapshot.find(identity.index);
+    if (!record || (identity.epoch != 0 &&
+                    static_cast<uint64_t>(record->data.ifi_epoch) !=
+                        identity.epoch)) {
+      return nullptr;
+    }
+    return createFromRecord(record);
+  }
+
+  std::unique_ptr<Interface> Manager::createFromRecord(
+      std::shared_ptr<const InterfaceRecord> record) const {
+    auto interface = InterfaceRegistry::create(record->name, record->index,
+                                               record->flags, record->type);
+    interface->attachRecord(std::move(record));
+    return interface;
   }
 
   bool Manager::interfaceExists(const std::string &name) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::interfaceExists");
     return getInterface(name) != nullptr;
   }
 
   int Manager::getInterfaceFlags(const std::string &name) const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getInterfaceFlags");
     struct ifreq ifr;
     std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_name[IFNAMSIZ - 1] = '\0';
 
-    if (ioctl(socket_fd, SIOCGIFFLAGS, &ifr) == 0) {
+    if (metrics::tracedIoctl(ControlSocket::get(AF_INET), SIOCGIFFLAGS,
+                             &ifr) == 0) {
       return ifr.ifr_flags;
     }
     return 0;
   }
 
   bool Manager::setInterfaceFlags(const std::string &name, int flags) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::setInterfaceFlags");
     struct ifreq ifr;
     std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_name[IFNAMSIZ - 1] = '\0';
     ifr.ifr_flags = flags;
 
-    return ioctl(socket_fd, SIOCSIFFLAGS, &ifr) == 0;
+    return metrics::tracedIoctl(ControlSocket::get(AF_INET), SIOCSIFFLAGS,
+                                &ifr) == 0;
   }
 
   bool Manager::bringUp(const std::string &name) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::bringUp");
     int flags = getInterfaceFlags(name);
     return setInterfaceFlags(name, flags | IFF_UP);
   }
 
   bool Manager::bringDown(const std::string &name) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::bringDown");
     int flags = getInterfaceFlags(name);
     return setInterfaceFlags(name, flags & ~IFF_UP);
   }
@@ -262,10 +400,12 @@ namespace libfreebsdnet::interface {
   std::unique_ptr<Interface> Manager::createInterface(const std::string &name,
                                                       unsigned int index,
                                                       int flags) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::createInterface");
     // Get the actual interface type from the system using sockaddr_dl
     struct ifaddrs *ifaddrs_ptr;
     std::unique_ptr<Interface> interface = nullptr;
 
+    LIBFREEBSDNET_METRICS_SYSCALL(GETIFADDRS);
     if (getifaddrs(&ifaddrs_ptr) == 0) {
       for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
            ifa = ifa->ifa_next) {
@@ -287,7 +427,8 @@ namespace libfreebsdnet::interface {
             std::strncpy(lagg_req.ra_ifname, ifa->ifa_name, IFNAMSIZ - 1);
             lagg_req.ra_ifname[IFNAMSIZ - 1] = '\0';
 
-            if (ioctl(socket_fd, SIOCSLAGG, &lagg_req) == 0 ||
+            if (metrics::tracedIoctl(ControlSocket::get(AF_INET), SIOCSLAGG,
+                                     &lagg_req) == 0 ||
                 errno == EINVAL) {
               // Interface supports LAGG ioctl
               interface = std::make_unique<LagInterface>(name, index, flags);
@@ -299,7 +440,8 @@ namespace libfreebsdnet::interface {
               ifd.ifd_name[IFNAMSIZ - 1] = '\0';
               ifd.ifd_cmd = 0; // Test command
 
-              if (ioctl(socket_fd, SIOCGDRVSPEC, &ifd) == 0 ||
+              if (metrics::tracedIoctl(ControlSocket::get(AF_INET),
+                                       SIOCGDRVSPEC, &ifd) == 0 ||
                   errno == EINVAL) {
                 // Interface supports bridge ioctl
                 interface =
@@ -361,6 +503,7 @@ namespace libfreebsdnet::interface {
                                                       unsigned int index,
                                                       int flags,
                                                       InterfaceType type) {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::createInterface(type)");
     switch (type) {
     case InterfaceType::ETHERNET:
       return std::make_unique<EthernetInterface>(name, index, flags);
@@ -428,9 +571,11 @@ namespace libfreebsdnet::interface {
   }
 
   std::vector<struct ifaddrs> Manager::getIfAddrs() const {
+    LIBFREEBSDNET_METRICS_OPERATION("Manager::getIfAddrs");
     struct ifaddrs *ifap, *ifa;
     std::vector<struct ifaddrs> result;
 
+    LIBFREEBSDNET_METRICS_SYSCALL(GETIFADDRS);
     if (getifaddrs(&ifap) != 0) {
       throw std::runtime_error("Failed to get interface addresses: " + std::string(strerror(errno)));
     }
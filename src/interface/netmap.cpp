@@ -0,0 +1,506 @@
+/**
+ * @file interface/netmap.cpp
+ * @brief Netmap port class implementation
+ * @details NIOCCTRL registration, ring mapping, bursts and ring workers
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <interface/affinity.hpp>
+#include <interface/netmap.hpp>
+#include <metrics/probes.hpp>
+#include <net/netmap.h>
+#include <net/netmap_user.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::string_view NETMAP_PREFIX = "netmap:";
+
+    uint32_t nextSlot(const netmap_ring *ring, uint32_t index) {
+      return index + 1 == ring->num_slots ? 0 : index + 1;
+    }
+
+    uint32_t ringSpace(const netmap_ring *ring) {
+      int64_t space = static_cast<int64_t>(ring->tail) - ring->cur;
+      return static_cast<uint32_t>(space < 0 ? space + ring->num_slots
+                                             : space);
+    }
+
+  } // namespace
+
+  class NetmapPort::Impl {
+  public:
+    std::string port;
+    std::string prefix; // "netmap:" or empty for VALE ports
+    std::string name;   // registered name without the ring suffix
+    uint32_t mode = NR_REG_ALL_NIC;
+    uint16_t ringId = 0;
+
+    int fd = -1;
+    void *memory = MAP_FAILED;
+    size_t memorySize = 0;
+    uint16_t memoryId = 0;
+    netmap_if *nifp = nullptr;
+    unsigned int rxFirst = 0, rxLast = 0; // bound rings, half-open
+    unsigned int txFirst = 0, txLast = 0;
+    unsigned int rings = 0;
+    size_t bufferSize = 0;
+    Clock::time_point opened;
+
+    std::atomic<uint64_t> rxPackets{0};
+    std::atomic<uint64_t> rxBytes{0};
+    std::atomic<uint64_t> txPackets{0};
+    std::atomic<uint64_t> txBytes{0};
+    std::atomic<uint64_t> forwarded{0};
+
+    std::vector<std::span<uint8_t>> frames;
+    std::vector<std::unique_ptr<NetmapPort>> workerPorts;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{false};
+    std::string lastError;
+
+    explicit Impl(const std::string &portName) : port(portName) { parse(); }
+
+    ~Impl() { close(); }
+
+    void parse() {
+      std::string_view spec = port;
+      if (spec.starts_with(NETMAP_PREFIX)) {
+        prefix = NETMAP_PREFIX;
+        spec.remove_prefix(NETMAP_PREFIX.size());
+      }
+      // Only hardware ports take a "-N" ring suffix; VALE and pipe names
+      // may themselves end in "-" and digits
+      if (spec.ends_with('^')) {
+        mode = NR_REG_SW;
+        spec.remove_suffix(1);
+      } else if (spec.ends_with('*')) {
+        mode = NR_REG_NIC_SW;
+        spec.remove_suffix(1);
+      } else if (size_t dash = spec.rfind('-');
+                 !prefix.empty() && dash != std::string_view::npos &&
+                 dash > 0 &&
+                 dash + 1 < spec.size() &&
+                 std::all_of(spec.begin() + dash + 1, spec.end(),
+                             [](char c) { return c >= '0' && c <= '9'; })) {
+        mode = NR_REG_ONE_NIC;
+        ringId = static_cast<uint16_t>(std::stoul(
+            std::string(spec.substr(dash + 1))));
+        spec = spec.substr(0, dash);
+      }
+      name = spec;
+    }
+
+    bool open() {
+      if (fd >= 0) {
+        return true;
+      }
+      if (name.empty() || name.size() >= NETMAP_REQ_IFNAMSIZ) {
+        lastError = "Invalid netmap port: " + port;
+        return false;
+      }
+      fd = ::open("/dev/netmap", O_RDWR | O_CLOEXEC);
+      if (fd < 0) {
+        lastError = "Failed to open /dev/netmap: " +
+                    std::string(strerror(errno));
+        return false;
+      }
+
+      struct nmreq_header header;
+      struct nmreq_register request;
+      std::memset(&header, 0, sizeof(header));
+      std::memset(&request, 0, sizeof(request));
+      header.nr_version = NETMAP_API;
+      header.nr_reqtype = NETMAP_REQ_REGISTER;
+      std::memcpy(header.nr_name, name.data(), name.size());
+      header.nr_body = reinterpret_cast<uintptr_t>(&request);
+      request.nr_mode = mode;
+      request.nr_ringid = ringId;
+      if (metrics::tracedIoctl(fd, NIOCCTRL, &header) < 0) {
+        lastError = "Failed to register " + port + ": " + strerror(errno);
+        closeFd();
+        return false;
+      }
+
+      memorySize = request.nr_memsize;
+      memoryId = request.nr_mem_id;
+      memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+      if (memory == MAP_FAILED) {
+        lastError = "Failed to map " + port + ": " + strerror(errno);
+        closeFd();
+        return false;
+      }
+      nifp = NETMAP_IF(memory, request.nr_offset);
+
+      rings = std::min(nifp->ni_rx_rings, nifp->ni_tx_rings);
+      unsigned int rxHost = nifp->ni_rx_rings + nifp->ni_host_rx_rings;
+      unsigned int txHost = nifp->ni_tx_rings + nifp->ni_host_tx_rings;
+      switch (mode) {
+      case NR_REG_ONE_NIC:
+        rxFirst = txFirst = ringId;
+        rxLast = txLast = ringId + 1u;
+        break;
+      case NR_REG_SW:
+        rxFirst = nifp->ni_rx_rings;
+        txFirst = nifp->ni_tx_rings;
+        rxLast = rxHost;
+        txLast = txHost;
+        break;
+      case NR_REG_NIC_SW:
+        rxFirst = txFirst = 0;
+        rxLast = rxHost;
+        txLast = txHost;
+        break;
+      default:
+        rxFirst = txFirst = 0;
+        rxLast = nifp->ni_rx_rings;
+        txLast = nifp->ni_tx_rings;
+        break;
+      }
+      bufferSize = NETMAP_RXRING(nifp, rxFirst)->nr_buf_size;
+      frames.reserve(NETMAP_RXRING(nifp, rxFirst)->num_slots);
+      opened = Clock::now();
+      return true;
+    }
+
+    void close() {
+      stopWorkers();
+      workerPorts.clear();
+      unmap();
+    }
+
+    // Drop the registration and mapping; ring counts stay readable
+    void unmap() {
+      if (memory != MAP_FAILED) {
+        munmap(memory, memorySize);
+        memory = MAP_FAILED;
+      }
+      nifp = nullptr;
+      closeFd();
+    }
+
+    netmap_ring *rxRing(unsigned int index) const {
+      return NETMAP_RXRING(nifp, index);
+    }
+
+    netmap_ring *txRing(unsigned int index) const {
+      return NETMAP_TXRING(nifp, index);
+    }
+
+    uint8_t *buffer(netmap_ring *ring, const netmap_slot &slot) const {
+      return reinterpret_cast<uint8_t *>(NETMAP_BUF(ring, slot.buf_idx));
+    }
+
+    void stopWorkers() {
+      running = false;
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      threads.clear();
+    }
+
+  private:
+    void closeFd() {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  };
+
+  NetmapPort::NetmapPort(const std::string &port)
+      : pImpl(std::make_unique<Impl>(port)) {}
+
+  NetmapPort::NetmapPort(const Interface &interface, int ring)
+      : pImpl(std::make_unique<Impl>(
+            std::string(NETMAP_PREFIX) + interface.getName() +
+            (ring >= 0 ? "-" + std::to_string(ring) : ""))) {}
+
+  NetmapPort::~NetmapPort() = default;
+
+  bool NetmapPort::open() { return pImpl->open(); }
+
+  void NetmapPort::close() { pImpl->close(); }
+
+  bool NetmapPort::isOpen() const { return pImpl->fd >= 0; }
+
+  std::string NetmapPort::getPort() const { return pImpl->port; }
+
+  int NetmapPort::getFd() const { return pImpl->fd; }
+
+  unsigned int NetmapPort::getRingCount() const { return pImpl->rings; }
+
+  size_t NetmapPort::getBufferSize() const { return pImpl->bufferSize; }
+
+  bool NetmapPort::wait(std::chrono::milliseconds timeout, bool transmit) {
+    if (pImpl->fd < 0) {
+      pImpl->lastError = "Port not open";
+      return false;
+    }
+    struct pollfd pfd = {pImpl->fd,
+                         static_cast<short>(transmit ? POLLOUT : POLLIN), 0};
+    int ready = poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (ready < 0) {
+      pImpl->lastError = "poll failed: " + std::string(strerror(errno));
+      return false;
+    }
+    return ready > 0;
+  }
+
+  bool NetmapPort::sync() {
+    if (pImpl->fd < 0) {
+      pImpl->lastError = "Port not open";
+      return false;
+    }
+    if (metrics::tracedIoctl(pImpl->fd, NIOCTXSYNC, nullptr) < 0 ||
+        metrics::tracedIoctl(pImpl->fd, NIOCRXSYNC, nullptr) < 0) {
+      pImpl->lastError = "Failed to sync rings: " +
+                         std::string(strerror(errno));
+      return false;
+    }
+    return true;
+  }
+
+  size_t NetmapPort::receive(const FrameHandler &handler, size_t limit) {
+    if (!pImpl->nifp) {
+      return 0;
+    }
+    size_t total = 0;
+    uint64_t bytes = 0;
+    for (unsigned int r = pImpl->rxFirst; r < pImpl->rxLast && total < limit;
+         ++r) {
+      netmap_ring *ring = pImpl->rxRing(r);
+      size_t count = std::min<size_t>(ringSpace(ring), limit - total);
+      if (count == 0) {
+        continue;
+      }
+      pImpl->frames.clear();
+      uint32_t index = ring->cur;
+      for (size_t i = 0; i < count; ++i) {
+        const netmap_slot &slot = ring->slot[index];
+        pImpl->frames.emplace_back(pImpl->buffer(ring, slot), slot.len);
+        bytes += slot.len;
+        index = nextSlot(ring, index);
+      }
+      if (handler) {
+        handler(pImpl->frames);
+      }
+      ring->head = ring->cur = index;
+      total += count;
+    }
+    pImpl->rxPackets.fetch_add(total, std::memory_order_relaxed);
+    pImpl->rxBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return total;
+  }
+
+  size_t
+  NetmapPort::transmit(std::span<const std::span<const uint8_t>> frames) {
+    size_t next = 0;
+    return fill(
+        [&](std::span<uint8_t> buffer) -> size_t {
+          if (next == frames.size()) {
+            return 0;
+          }
+          const auto &frame = frames[next++];
+          size_t length = std::min(frame.size(), buffer.size());
+          std::memcpy(buffer.data(), frame.data(), length);
+          return length;
+        },
+        frames.size());
+  }
+
+  size_t NetmapPort::fill(const FrameFiller &filler, size_t limit) {
+    if (!pImpl->nifp) {
+      return 0;
+    }
+    size_t total = 0;
+    uint64_t bytes = 0;
+    bool done = false;
+    for (unsigned int r = pImpl->txFirst;
+         r < pImpl->txLast && total < limit && !done; ++r) {
+      netmap_ring *ring = pImpl->txRing(r);
+      size_t space = ringSpace(ring);
+      uint32_t index = ring->cur;
+      for (size_t i = 0; i < space && total < limit; ++i) {
+        netmap_slot &slot = ring->slot[index];
+        size_t length =
+            filler(std::span<uint8_t>(pImpl->buffer(ring, slot),
+                                      pImpl->bufferSize));
+        if (length == 0) {
+          done = true;
+          break;
+        }
+        slot.len = static_cast<uint16_t>(
+            std::min(length, pImpl->bufferSize));
+        bytes += slot.len;
+        index = nextSlot(ring, index);
+        ++total;
+      }
+      ring->head = ring->cur = index;
+    }
+    pImpl->txPackets.fetch_add(total, std::memory_order_relaxed);
+    pImpl->txBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return total;
+  }
+
+  size_t NetmapPort::forward(NetmapPort &from, NetmapPort &to, size_t limit) {
+    Impl &src = *from.pImpl;
+    Impl &dst = *to.pImpl;
+    if (!src.nifp || !dst.nifp) {
+      return 0;
+    }
+    bool swap = src.memoryId == dst.memoryId;
+    size_t total = 0;
+    uint64_t bytes = 0;
+    unsigned int si = src.rxFirst;
+    unsigned int di = dst.txFirst;
+    while (si < src.rxLast && di < dst.txLast && total < limit) {
+      netmap_ring *rx = src.rxRing(si);
+      netmap_ring *tx = dst.txRing(di);
+      size_t count = std::min<size_t>(ringSpace(rx), ringSpace(tx));
+      if (ringSpace(rx) == 0) {
+        ++si;
+        continue;
+      }
+      if (count == 0) {
+        ++di;
+        continue;
+      }
+      count = std::min(count, limit - total);
+
+      uint32_t rxIndex = rx->cur;
+      uint32_t txIndex = tx->cur;
+      for (size_t i = 0; i < count; ++i) {
+        netmap_slot &in = rx->slot[rxIndex];
+        netmap_slot &out = tx->slot[txIndex];
+        if (swap) {
+          std::swap(in.buf_idx, out.buf_idx);
+          out.len = in.len;
+          in.flags |= NS_BUF_CHANGED;
+          out.flags |= NS_BUF_CHANGED;
+        } else {
+          out.len = static_cast<uint16_t>(
+              std::min<size_t>(in.len, dst.bufferSize));
+          std::memcpy(dst.buffer(tx, out), src.buffer(rx, in), out.len);
+        }
+        bytes += out.len;
+        rxIndex = nextSlot(rx, rxIndex);
+        txIndex = nextSlot(tx, txIndex);
+      }
+      rx->head = rx->cur = rxIndex;
+      tx->head = tx->cur = txIndex;
+      total += count;
+    }
+
+    src.rxPackets.fetch_add(total, std::memory_order_relaxed);
+    src.rxBytes.fetch_add(bytes, std::memory_order_relaxed);
+    dst.txPackets.fetch_add(total, std::memory_order_relaxed);
+    dst.txBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (swap) {
+      src.forwarded.fetch_add(total, std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  bool NetmapPort::startWorkers(RingWorker worker, std::span<const int> cpus) {
+    if (pImpl->running) {
+      return true;
+    }
+    if (!open()) {
+      return false;
+    }
+
+    // One descriptor per ring pair so each worker syncs only its own rings.
+    // The ring is set on the request rather than spelled into the name,
+    // which VALE ports would not parse
+    pImpl->workerPorts.clear();
+    for (unsigned int r = 0; r < pImpl->rings; ++r) {
+      auto port = std::make_unique<NetmapPort>(pImpl->prefix + pImpl->name);
+      port->pImpl->port += "-" + std::to_string(r);
+      port->pImpl->mode = NR_REG_ONE_NIC;
+      port->pImpl->ringId = static_cast<uint16_t>(r);
+      if (!port->open()) {
+        pImpl->lastError = port->getLastError();
+        pImpl->workerPorts.clear();
+        return false;
+      }
+      pImpl->workerPorts.push_back(std::move(port));
+    }
+    // The workers own every ring now; the all-rings registration would
+    // otherwise stay bound to the same rings alongside them
+    pImpl->unmap();
+
+    // Hardware ring r is fed by receive queue r, so its worker follows that
+    // queue's interrupt; VALE ports have no queues to follow
+    std::vector<int> planned;
+    if (cpus.empty() && !pImpl->prefix.empty()) {
+      planned = QueueAffinity::plan(pImpl->name, pImpl->rings).getCpus();
+    }
+    unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+    pImpl->running = true;
+    for (unsigned int r = 0; r < pImpl->rings; ++r) {
+      NetmapPort *port = pImpl->workerPorts[r].get();
+      pImpl->threads.emplace_back([this, port, worker, r] {
+        while (pImpl->running && worker(*port, r)) {
+        }
+      });
+
+      int cpu = r < cpus.size() ? cpus[r] : -1;
+      if (cpu < 0 && r < planned.size()) {
+        cpu = planned[r];
+      }
+      if (cpu < 0) {
+        cpu = static_cast<int>(r % cores);
+      }
+      int error = QueueAffinity::pin(pImpl->threads.back().native_handle(),
+                                     std::span<const int>(&cpu, 1));
+      if (error != 0) {
+        pImpl->lastError = "Failed to pin ring " + std::to_string(r) +
+                           " to CPU " + std::to_string(cpu) + ": " +
+                           strerror(error);
+      }
+    }
+    return true;
+  }
+
+  void NetmapPort::stopWorkers() { pImpl->stopWorkers(); }
+
+  NetmapStats NetmapPort::getStats() const {
+    NetmapStats stats;
+    auto add = [&stats](const Impl &impl) {
+      stats.rxPackets += impl.rxPackets.load(std::memory_order_relaxed);
+      stats.rxBytes += impl.rxBytes.load(std::memory_order_relaxed);
+      stats.txPackets += impl.txPackets.load(std::memory_order_relaxed);
+      stats.txBytes += impl.txBytes.load(std::memory_order_relaxed);
+      stats.forwarded += impl.forwarded.load(std::memory_order_relaxed);
+    };
+    add(*pImpl);
+    for (const auto &port : pImpl->workerPorts) {
+      add(*port->pImpl);
+    }
+    if (pImpl->fd >= 0) {
+      stats.elapsed = Clock::now() - pImpl->opened;
+    }
+    return stats;
+  }
+
+  std::string NetmapPort::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,176 @@
+/**
+ * @file interface/openmetrics.cpp
+ * @brief OpenMetrics text exposition implementation
+ * @details Table-driven metric families formatted with std::to_chars
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <charconv>
+#include <cstring>
+#include <interface/openmetrics.hpp>
+#include <net/if.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // Appends while the output fits and keeps counting once it does not
+    class Writer {
+    public:
+      explicit Writer(std::span<char> buffer) : buffer_(buffer) {}
+
+      void put(std::string_view text) {
+        if (!overflow_ && used_ + text.size() <= buffer_.size()) {
+          std::memcpy(buffer_.data() + used_, text.data(), text.size());
+        } else {
+          overflow_ = true;
+        }
+        used_ += text.size();
+      }
+
+      template <typename T> void number(T value) {
+        char text[32];
+        auto [end, ec] = std::to_chars(text, text + sizeof(text), value);
+        put(std::string_view(text, ec == std::errc() ? end - text : 0));
+      }
+
+      // Label values escape backslash, quote and newline
+      void label(std::string_view value) {
+        for (char c : value) {
+          switch (c) {
+          case '\\':
+            put("\\\\");
+            break;
+          case '"':
+            put("\\\"");
+            break;
+          case '\n':
+            put("\\n");
+            break;
+          default:
+            put(std::string_view(&c, 1));
+            break;
+          }
+        }
+      }
+
+      size_t size() const { return used_; }
+
+    private:
+      std::span<char> buffer_;
+      size_t used_ = 0;
+      bool overflow_ = false;
+    };
+
+    struct Counter {
+      const char *name;
+      const char *help;
+      uint64_t InterfaceSample::*value;
+    };
+
+    constexpr Counter COUNTERS[] = {
+        {"receive_bytes", "Bytes received", &InterfaceSample::bytesIn},
+        {"transmit_bytes", "Bytes sent", &InterfaceSample::bytesOut},
+        {"receive_packets", "Packets received", &InterfaceSample::packetsIn},
+        {"transmit_packets", "Packets sent", &InterfaceSample::packetsOut},
+        {"receive_errors", "Input errors", &InterfaceSample::errorsIn},
+        {"transmit_errors", "Output errors", &InterfaceSample::errorsOut},
+        {"receive_drops", "Input queue drops", &InterfaceSample::dropsIn},
+        {"transmit_drops", "Output queue drops", &InterfaceSample::dropsOut},
+        {"receive_multicast_packets", "Multicast packets received",
+         &InterfaceSample::multicastIn},
+        {"transmit_multicast_packets", "Multicast packets sent",
+         &InterfaceSample::multicastOut},
+    };
+
+    struct Gauge {
+      const char *name;
+      const char *help;
+      double (*value)(const InterfaceSample &);
+    };
+
+    constexpr Gauge GAUGES[] = {
+        {"receive_bits_per_second", "Receive rate over the last interval",
+         [](const InterfaceSample &s) { return s.rates.current.bitsIn; }},
+        {"transmit_bits_per_second", "Transmit rate over the last interval",
+         [](const InterfaceSample &s) { return s.rates.current.bitsOut; }},
+        {"receive_packets_per_second",
+         "Receive packet rate over the last interval",
+         [](const InterfaceSample &s) { return s.rates.current.packetsIn; }},
+        {"transmit_packets_per_second",
+         "Transmit packet rate over the last interval",
+         [](const InterfaceSample &s) { return s.rates.current.packetsOut; }},
+        {"receive_bits_per_second_average", "Smoothed receive rate",
+         [](const InterfaceSample &s) { return s.rates.average.bitsIn; }},
+        {"transmit_bits_per_second_average", "Smoothed transmit rate",
+         [](const InterfaceSample &s) { return s.rates.average.bitsOut; }},
+        {"speed_bits_per_second", "Link speed",
+         [](const InterfaceSample &s) {
+           return static_cast<double>(s.baudrate);
+         }},
+        {"link_up", "1 if the link is up",
+         [](const InterfaceSample &s) {
+           return s.linkState == LINK_STATE_UP ? 1.0 : 0.0;
+         }},
+    };
+
+    void header(Writer &out, std::string_view prefix, const char *name,
+                const char *type, const char *help) {
+      out.put("# TYPE ");
+      out.put(prefix);
+      out.put("_");
+      out.put(name);
+      out.put(" ");
+      out.put(type);
+      out.put("\n# HELP ");
+      out.put(prefix);
+      out.put("_");
+      out.put(name);
+      out.put(" ");
+      out.put(help);
+      out.put("\n");
+    }
+
+    void sampleName(Writer &out, std::string_view prefix, const char *name,
+                    std::string_view suffix, const InterfaceSample &sample) {
+      out.put(prefix);
+      out.put("_");
+      out.put(name);
+      out.put(suffix);
+      out.put("{interface=\"");
+      out.label(std::string_view(sample.rates.name,
+                                 strnlen(sample.rates.name, IFNAMSIZ)));
+      out.put("\"} ");
+    }
+
+  } // namespace
+
+  size_t OpenMetricsSerializer::serialize(const SamplerSnapshot &snapshot,
+                                          std::span<char> buffer,
+                                          std::string_view prefix) {
+    Writer out(buffer);
+    auto samples = snapshot.getInterfaces();
+
+    for (const auto &counter : COUNTERS) {
+      header(out, prefix, counter.name, "counter", counter.help);
+      for (const auto &sample : samples) {
+        sampleName(out, prefix, counter.name, "_total", sample);
+        out.number(sample.*counter.value);
+        out.put("\n");
+      }
+    }
+    for (const auto &gauge : GAUGES) {
+      header(out, prefix, gauge.name, "gauge", gauge.help);
+      for (const auto &sample : samples) {
+        sampleName(out, prefix, gauge.name, "", sample);
+        out.number(gauge.value(sample));
+        out.put("\n");
+      }
+    }
+    out.put("# EOF\n");
+    return out.size();
+  }
+
+} // namespace libfreebsdnet::interface
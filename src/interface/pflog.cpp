@@ -7,11 +7,16 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cstddef>
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/pflog.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
+#include <net/bpf.h>
 #include <net/if.h>
 #include <net/if_mib.h>
 #include <net/if_pflog.h>
@@ -24,7 +29,45 @@
 
 namespace libfreebsdnet::interface {
 
-  class PflogInterface::Impl {
+  bool decodePflog(std::span<const uint8_t> data, PflogRecord &record) {
+    // Older kernels write a shorter header; rulenr/subrulenr are the last
+    // fields every version has
+    constexpr size_t minimum = offsetof(struct pfloghdr, subrulenr) +
+                               sizeof(uint32_t);
+    if (data.size() < minimum || data[0] < minimum) {
+      return false;
+    }
+    size_t hdrlen = BPF_WORDALIGN(static_cast<size_t>(data[0]));
+    if (data.size() < hdrlen) {
+      return false;
+    }
+
+    struct pfloghdr header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(&header, data.data(), std::min(hdrlen, sizeof(header)));
+    const char *base = reinterpret_cast<const char *>(data.data());
+
+    record = PflogRecord{};
+    record.family = header.af;
+    record.action = header.action;
+    record.reason = header.reason;
+    record.interface = std::string_view(
+        base + offsetof(struct pfloghdr, ifname),
+        strnlen(header.ifname, sizeof(header.ifname)));
+    record.ruleset = std::string_view(
+        base + offsetof(struct pfloghdr, ruleset),
+        strnlen(header.ruleset, sizeof(header.ruleset)));
+    record.rule = ntohl(header.rulenr);
+    record.subrule = ntohl(header.subrulenr);
+    record.uid = static_cast<uint32_t>(header.uid);
+    record.pid = static_cast<int32_t>(header.pid);
+    record.direction = header.dir;
+    record.ridentifier = ntohl(header.ridentifier);
+    record.packet = data.subspan(hdrlen);
+    return true;
+  }
+
+  class PflogInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -41,34 +84,11 @@ namespace libfreebsdnet::interface {
 
   PflogInterface::PflogInterface(const std::string &name, unsigned int index,
                                  int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   PflogInterface::~PflogInterface() = default;
 
-  // Base class method implementations
-  std::string PflogInterface::getName() const { return Interface::getName(); }
-  unsigned int PflogInterface::getIndex() const {
-    return Interface::getIndex();
-  }
-  InterfaceType PflogInterface::getType() const { return InterfaceType::PFLOG; }
-  std::vector<Flag> PflogInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool PflogInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-  bool PflogInterface::bringUp() { return Interface::bringUp(); }
-  bool PflogInterface::bringDown() { return Interface::bringDown(); }
-  bool PflogInterface::isUp() const { return Interface::isUp(); }
-
-  int PflogInterface::getMtu() const { return Interface::getMtu(); }
-  bool PflogInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-  std::string PflogInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-  int PflogInterface::getFib() const { return Interface::getFib(); }
-  bool PflogInterface::setFib(int fib) { return Interface::setFib(fib); }
-
   std::string PflogInterface::getLogInterface() const { return pImpl->ruleset; }
 
   bool PflogInterface::setLogInterface(const std::string &interfaceName) {
@@ -83,58 +103,21 @@ namespace libfreebsdnet::interface {
     return true; // Rule number setting would require specific PFLOG ioctls
   }
 
-  int PflogInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool PflogInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int PflogInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int PflogInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> PflogInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t PflogInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool PflogInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t PflogInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool PflogInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool PflogInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  std::vector<std::string> PflogInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool PflogInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool PflogInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
+  bool PflogInterface::openCapture(BpfCapture &capture) {
+    if (!capture.open(pImpl->name)) {
+      pImpl->lastError = capture.getLastError();
+      return false;
+    }
+    if (capture.getDataLinkType() != DLT_PFLOG) {
+      pImpl->lastError = pImpl->name + " is not a pflog interface";
+      capture.close();
+      return false;
+    }
+    return true;
   }
 
   bool PflogInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -150,23 +133,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool PflogInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -176,19 +156,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool PflogInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -198,54 +176,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> PflogInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
-  }
-
   std::string PflogInterface::getMacAddress() const {
     // PFLOG interfaces typically don't have MAC addresses
     return "";
@@ -259,7 +198,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool PflogInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -270,14 +209,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -12,6 +12,8 @@
 #include <errno.h>
 #include <ifaddrs.h>
 #include <interface/pfsync.hpp>
+#include <interface/socket.hpp>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <net/if_mib.h>
 #include <net/if_pfsync.h>
@@ -24,7 +26,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class PfsyncInterface::Impl {
+  class PfsyncInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -42,81 +44,47 @@ namespace libfreebsdnet::interface {
 
   PfsyncInterface::PfsyncInterface(const std::string &name, unsigned int index,
                                    int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   PfsyncInterface::~PfsyncInterface() = default;
 
-  // Base class method implementations
-  std::string PfsyncInterface::getName() const { return Interface::getName(); }
-  unsigned int PfsyncInterface::getIndex() const {
-    return Interface::getIndex();
-  }
-  InterfaceType PfsyncInterface::getType() const {
-    return InterfaceType::PFSYNC;
-  }
-  std::vector<Flag> PfsyncInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool PfsyncInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-  bool PfsyncInterface::bringUp() { return Interface::bringUp(); }
-  bool PfsyncInterface::bringDown() { return Interface::bringDown(); }
-  bool PfsyncInterface::isUp() const { return Interface::isUp(); }
-
-  int PfsyncInterface::getMtu() const { return Interface::getMtu(); }
-  bool PfsyncInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-  std::string PfsyncInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-  int PfsyncInterface::getFib() const { return Interface::getFib(); }
-  bool PfsyncInterface::setFib(int fib) { return Interface::setFib(fib); }
-
   std::string PfsyncInterface::getSyncInterface() const {
     return pImpl->syncDevice;
   }
 
   bool PfsyncInterface::setSyncInterface(const std::string &interfaceName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      pImpl->lastError = "Failed to create socket";
-      return false;
-    }
-
-    struct pfsyncreq req;
-    std::memset(&req, 0, sizeof(req));
-    std::strncpy(req.pfsyncr_syncdev, interfaceName.c_str(), IFNAMSIZ - 1);
-    req.pfsyncr_maxupdates = pImpl->maxUpdates;
-    req.pfsyncr_defer = pImpl->defer ? PFSYNCF_DEFER : 0;
-
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
-    ifr.ifr_data = reinterpret_cast<caddr_t>(&req);
-
-    if (ioctl(sock, SIOCSETPFSYNC, &ifr) < 0) {
-      pImpl->lastError =
-          "Failed to set PFSYNC interface: " + std::string(strerror(errno));
-      close(sock);
-      return false;
-    }
-
-    pImpl->syncDevice = interfaceName;
-    close(sock);
-    return true;
+    PfsyncSettings settings;
+    settings.syncInterface = interfaceName;
+    return applySettings(settings);
   }
 
   std::string PfsyncInterface::getSyncPeer() const { return pImpl->syncPeer; }
 
   bool PfsyncInterface::setSyncPeer(const std::string &peerAddress) {
-    pImpl->syncPeer = peerAddress;
-    return true; // Peer setting would require specific PFSYNC ioctls
+    PfsyncSettings settings;
+    settings.syncPeer = peerAddress;
+    return applySettings(settings);
   }
 
   int PfsyncInterface::getMaxUpdates() const { return pImpl->maxUpdates; }
 
   bool PfsyncInterface::setMaxUpdates(int maxUpdates) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    PfsyncSettings settings;
+    settings.maxUpdates = maxUpdates;
+    return applySettings(settings);
+  }
+
+  bool PfsyncInterface::getDefer() const { return pImpl->defer; }
+
+  bool PfsyncInterface::setDefer(bool defer) {
+    PfsyncSettings settings;
+    settings.defer = defer;
+    return applySettings(settings);
+  }
+
+  bool PfsyncInterface::applySettings(const PfsyncSettings &settings) {
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -124,79 +92,67 @@ namespace libfreebsdnet::interface {
 
     struct pfsyncreq req;
     std::memset(&req, 0, sizeof(req));
-    std::strncpy(req.pfsyncr_syncdev, pImpl->syncDevice.c_str(), IFNAMSIZ - 1);
-    req.pfsyncr_maxupdates = maxUpdates;
-    req.pfsyncr_defer = pImpl->defer ? PFSYNCF_DEFER : 0;
-
     struct ifreq ifr;
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_data = reinterpret_cast<caddr_t>(&req);
 
-    if (ioctl(sock, SIOCSETPFSYNC, &ifr) < 0) {
+    // SIOCSETPFSYNC replaces the whole configuration
+    if (metrics::tracedIoctl(sock, SIOCGETPFSYNC, &ifr) < 0) {
       pImpl->lastError =
-          "Failed to set PFSYNC max updates: " + std::string(strerror(errno));
-      close(sock);
+          "Failed to get PFSYNC settings: " + std::string(strerror(errno));
       return false;
     }
 
-    pImpl->maxUpdates = maxUpdates;
-    close(sock);
-    return true;
-  }
-
-  int PfsyncInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool PfsyncInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int PfsyncInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int PfsyncInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> PfsyncInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t PfsyncInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool PfsyncInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t PfsyncInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool PfsyncInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool PfsyncInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  std::vector<std::string> PfsyncInterface::getGroups() const {
-    return Interface::getGroups();
-  }
+    if (settings.syncInterface) {
+      if (settings.syncInterface->size() >= IFNAMSIZ) {
+        pImpl->lastError = "Sync interface name too long";
+        return false;
+      }
+      std::memset(req.pfsyncr_syncdev, 0, sizeof(req.pfsyncr_syncdev));
+      std::strncpy(req.pfsyncr_syncdev, settings.syncInterface->c_str(),
+                   IFNAMSIZ - 1);
+    }
+    if (settings.syncPeer) {
+      req.pfsyncr_syncpeer.s_addr = htonl(INADDR_ANY);
+      if (!settings.syncPeer->empty() &&
+          inet_pton(AF_INET, settings.syncPeer->c_str(),
+                    &req.pfsyncr_syncpeer) != 1) {
+        pImpl->lastError = "Invalid sync peer: " + *settings.syncPeer;
+        return false;
+      }
+    }
+    if (settings.maxUpdates) {
+      if (*settings.maxUpdates < 0 || *settings.maxUpdates > 255) {
+        pImpl->lastError = "Max updates must be 0 to 255";
+        return false;
+      }
+      req.pfsyncr_maxupdates = *settings.maxUpdates;
+    }
+    if (settings.defer) {
+      req.pfsyncr_defer = *settings.defer ? PFSYNCF_DEFER : 0;
+    }
 
-  bool PfsyncInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
+    if (metrics::tracedIoctl(sock, SIOCSETPFSYNC, &ifr) < 0) {
+      pImpl->lastError =
+          "Failed to set PFSYNC settings: " + std::string(strerror(errno));
+      return false;
+    }
 
-  bool PfsyncInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
+    char peer[INET_ADDRSTRLEN] = {};
+    if (req.pfsyncr_syncpeer.s_addr != htonl(INADDR_ANY)) {
+      inet_ntop(AF_INET, &req.pfsyncr_syncpeer, peer, sizeof(peer));
+    }
+    pImpl->syncDevice = std::string(
+        req.pfsyncr_syncdev, strnlen(req.pfsyncr_syncdev, IFNAMSIZ));
+    pImpl->syncPeer = peer;
+    pImpl->maxUpdates = req.pfsyncr_maxupdates;
+    pImpl->defer = (req.pfsyncr_defer & PFSYNCF_DEFER) != 0;
+    return true;
   }
 
   bool PfsyncInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -212,23 +168,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool PfsyncInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -238,19 +191,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool PfsyncInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -260,54 +211,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> PfsyncInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
-  }
-
   std::string PfsyncInterface::getMacAddress() const {
     // PFSYNC interfaces typically don't have MAC addresses
     return "";
@@ -321,7 +233,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool PfsyncInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -332,14 +244,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -0,0 +1,173 @@
+/**
+ * @file interface/queues.cpp
+ * @brief Per-queue NIC traffic rates implementation
+ * @details Counter name normalization and rate math over driver queue
+ * sysctls
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <interface/queues.hpp>
+#include <net/if.h>
+#include <string_view>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    enum class Direction { RX, TX, BOTH };
+
+    Direction directionOf(std::string_view node) {
+      if (node.starts_with("rx")) {
+        return Direction::RX;
+      }
+      if (node.starts_with("tx")) {
+        return Direction::TX;
+      }
+      return Direction::BOTH;
+    }
+
+    double rate(uint64_t now, uint64_t before, double seconds) {
+      // A driver reset zeroes its counters
+      return now >= before ? static_cast<double>(now - before) / seconds : 0;
+    }
+
+    // Only queues that carry the direction count toward its mean
+    double imbalance(const std::vector<QueueRates> &queues,
+                     double QueueRates::*packets, Direction excluded) {
+      double peak = 0, total = 0;
+      int active = 0;
+      for (const auto &queue : queues) {
+        if (directionOf(queue.name) == excluded) {
+          continue;
+        }
+        peak = std::max(peak, queue.*packets);
+        total += queue.*packets;
+        ++active;
+      }
+      return total > 0 ? peak / (total / active) : 0;
+    }
+
+  } // namespace
+
+  QueueCounters QueueCounters::fromStatistics(const QueueStatistics &queue) {
+    QueueCounters result;
+    result.name = queue.name;
+    Direction node = directionOf(queue.name);
+
+    for (const auto &[counter, value] : queue.counters) {
+      std::string_view name(counter);
+      Direction direction = node;
+      if (direction == Direction::BOTH) {
+        direction = directionOf(name);
+        if (direction == Direction::BOTH) {
+          continue;
+        }
+      }
+      if (name.starts_with("rx_") || name.starts_with("tx_")) {
+        name.remove_prefix(3);
+      }
+
+      bool rx = direction == Direction::RX;
+      if (name == "packets" || name == "pkts") {
+        (rx ? result.rxPackets : result.txPackets) = value;
+      } else if (name == "bytes") {
+        (rx ? result.rxBytes : result.txBytes) = value;
+      } else if (name.find("drop") != std::string_view::npos ||
+                 name.find("discard") != std::string_view::npos) {
+        (rx ? result.rxDrops : result.txDrops) += value;
+      }
+    }
+    return result;
+  }
+
+  class QueueSampler::Impl {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    std::string name;
+    StatisticsCollector collector;
+    std::vector<QueueStatistics> raw;
+    std::vector<QueueCounters> current;
+    std::vector<QueueCounters> previous;
+    Clock::time_point sampledAt{};
+    Clock::time_point previousAt{};
+    std::string lastError;
+
+    explicit Impl(const std::string &name) : name(name) {}
+  };
+
+  QueueSampler::QueueSampler(const std::string &name)
+      : pImpl(std::make_unique<Impl>(name)) {}
+
+  QueueSampler::~QueueSampler() = default;
+
+  bool QueueSampler::sample() {
+    // The index is looked up each time so a re-created port is followed
+    unsigned int index = if_nametoindex(pImpl->name.c_str());
+    if (index == 0) {
+      pImpl->lastError = "Interface not found: " + pImpl->name;
+      return false;
+    }
+    if (!pImpl->collector.readQueues(index, pImpl->raw) ||
+        pImpl->raw.empty()) {
+      pImpl->lastError = "No queue counters for " + pImpl->name;
+      return false;
+    }
+
+    pImpl->previous.swap(pImpl->current);
+    pImpl->previousAt = pImpl->sampledAt;
+    pImpl->current.clear();
+    for (const auto &queue : pImpl->raw) {
+      pImpl->current.push_back(QueueCounters::fromStatistics(queue));
+    }
+    pImpl->sampledAt = Impl::Clock::now();
+    return true;
+  }
+
+  std::span<const QueueCounters> QueueSampler::getCounters() const {
+    return pImpl->current;
+  }
+
+  QueueLoad QueueSampler::getLoad() const {
+    QueueLoad load;
+    load.interval = pImpl->sampledAt - pImpl->previousAt;
+    double seconds = load.interval.count();
+    // A layout change between samples makes the queues incomparable
+    if (pImpl->previous.size() != pImpl->current.size() || seconds <= 0) {
+      return load;
+    }
+
+    double rxTotal = 0, txTotal = 0;
+    for (size_t i = 0; i < pImpl->current.size(); ++i) {
+      const QueueCounters &now = pImpl->current[i];
+      const QueueCounters &before = pImpl->previous[i];
+      QueueRates rates;
+      rates.name = now.name;
+      rates.rxPackets = rate(now.rxPackets, before.rxPackets, seconds);
+      rates.rxBits = rate(now.rxBytes, before.rxBytes, seconds) * 8;
+      rates.rxDrops = rate(now.rxDrops, before.rxDrops, seconds);
+      rates.txPackets = rate(now.txPackets, before.txPackets, seconds);
+      rates.txBits = rate(now.txBytes, before.txBytes, seconds) * 8;
+      rates.txDrops = rate(now.txDrops, before.txDrops, seconds);
+      rxTotal += rates.rxPackets;
+      txTotal += rates.txPackets;
+      load.queues.push_back(std::move(rates));
+    }
+
+    for (auto &rates : load.queues) {
+      rates.rxShare = rxTotal > 0 ? rates.rxPackets / rxTotal : 0;
+      rates.txShare = txTotal > 0 ? rates.txPackets / txTotal : 0;
+    }
+    load.rxImbalance =
+        imbalance(load.queues, &QueueRates::rxPackets, Direction::TX);
+    load.txImbalance =
+        imbalance(load.queues, &QueueRates::txPackets, Direction::RX);
+    return load;
+  }
+
+  std::string QueueSampler::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,151 @@
+/**
+ * @file interface/registry.cpp
+ * @brief Interface class registry implementation
+ * @details Driver and link type tables seeded with the library's interface
+ * classes
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <array>
+#include <interface/bridge.hpp>
+#include <interface/carp.hpp>
+#include <interface/epair.hpp>
+#include <interface/ethernet.hpp>
+#include <interface/gif.hpp>
+#include <interface/l2vlan.hpp>
+#include <interface/lagg.hpp>
+#include <interface/loopback.hpp>
+#include <interface/pflog.hpp>
+#include <interface/pfsync.hpp>
+#include <interface/registry.hpp>
+#include <interface/vlan.hpp>
+#include <interface/wireless.hpp>
+#include <mutex>
+#include <net/if_types.h>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // Heterogeneous lookup so classification never builds a std::string
+    struct DriverHash {
+      using is_transparent = void;
+      size_t operator()(std::string_view name) const {
+        return std::hash<std::string_view>{}(name);
+      }
+    };
+
+    // A class may be registered without a kind, or a kind without a class
+    struct Entry {
+      InterfaceFactory factory;
+      InterfaceType kind = InterfaceType::UNKNOWN;
+    };
+
+    template <typename T> Entry entry(InterfaceType kind) {
+      return {InterfaceRegistry::factory<T>(), kind};
+    }
+
+    struct Tables {
+      std::shared_mutex mutex;
+      std::unordered_map<std::string, Entry, DriverHash, std::equal_to<>>
+          drivers;
+      std::array<Entry, 256> types;
+      InterfaceFactory fallback;
+
+      Tables() {
+        drivers = {
+            {"bridge", entry<BridgeInterface>(InterfaceType::BRIDGE)},
+            {"carp", entry<CarpInterface>(InterfaceType::CARP)},
+            {"epair", entry<EpairInterface>(InterfaceType::EPAIR)},
+            {"gif", entry<GifInterface>(InterfaceType::GIF)},
+            {"l2vlan", entry<L2VlanInterface>(InterfaceType::L2VLAN)},
+            {"lagg", entry<LagInterface>(InterfaceType::LAGG)},
+            {"lo", entry<LoopbackInterface>(InterfaceType::LOOPBACK)},
+            {"pflog", entry<PflogInterface>(InterfaceType::PFLOG)},
+            {"pfsync", entry<PfsyncInterface>(InterfaceType::PFSYNC)},
+            {"tap", {nullptr, InterfaceType::TAP}},
+            {"tun", {nullptr, InterfaceType::TUN}},
+            {"vlan", entry<VlanInterface>(InterfaceType::VLAN)},
+            {"wlan", entry<WirelessInterface>(InterfaceType::WIRELESS)},
+        };
+        types[IFT_BRIDGE] = entry<BridgeInterface>(InterfaceType::BRIDGE);
+        types[IFT_CARP] = entry<CarpInterface>(InterfaceType::CARP);
+        types[IFT_ETHER].kind = InterfaceType::ETHERNET;
+        types[IFT_GIF] = entry<GifInterface>(InterfaceType::GIF);
+        types[IFT_IEEE80211] =
+            entry<WirelessInterface>(InterfaceType::WIRELESS);
+        types[IFT_IEEE8023ADLAG] = entry<LagInterface>(InterfaceType::LAGG);
+        types[IFT_INFINIBAND].kind = InterfaceType::INFINIBAND;
+        types[IFT_L2VLAN] = entry<VlanInterface>(InterfaceType::VLAN);
+        types[IFT_LOOP] = entry<LoopbackInterface>(InterfaceType::LOOPBACK);
+        types[IFT_PFLOG] = entry<PflogInterface>(InterfaceType::PFLOG);
+        types[IFT_PFSYNC] = entry<PfsyncInterface>(InterfaceType::PFSYNC);
+        types[IFT_PPP].kind = InterfaceType::PPP;
+        types[IFT_STF].kind = InterfaceType::STF;
+        fallback = InterfaceRegistry::factory<EthernetInterface>();
+      }
+    };
+
+    Tables &tables() {
+      static Tables instance;
+      return instance;
+    }
+
+  } // namespace
+
+  void InterfaceRegistry::registerDriver(const std::string &driver,
+                                         InterfaceFactory factory,
+                                         InterfaceType kind) {
+    auto &t = tables();
+    std::unique_lock<std::shared_mutex> lock(t.mutex);
+    t.drivers.insert_or_assign(driver, Entry{std::move(factory), kind});
+  }
+
+  void InterfaceRegistry::registerType(uint8_t type, InterfaceFactory factory,
+                                       InterfaceType kind) {
+    auto &t = tables();
+    std::unique_lock<std::shared_mutex> lock(t.mutex);
+    t.types[type] = Entry{std::move(factory), kind};
+  }
+
+  std::unique_ptr<Interface> InterfaceRegistry::create(const std::string &name,
+                                                       unsigned int index,
+                                                       int flags,
+                                                       uint8_t type) {
+    auto &t = tables();
+    std::shared_lock<std::shared_mutex> lock(t.mutex);
+    auto it = t.drivers.find(getDriverName(name));
+    if (it != t.drivers.end() && it->second.factory) {
+      return it->second.factory(name, index, flags);
+    }
+    if (t.types[type].factory) {
+      return t.types[type].factory(name, index, flags);
+    }
+    return t.fallback(name, index, flags);
+  }
+
+  InterfaceType InterfaceRegistry::classify(std::string_view name,
+                                            uint8_t type) {
+    auto &t = tables();
+    std::shared_lock<std::shared_mutex> lock(t.mutex);
+    auto it = t.drivers.find(getDriverName(name));
+    if (it != t.drivers.end() && it->second.kind != InterfaceType::UNKNOWN) {
+      return it->second.kind;
+    }
+    return t.types[type].kind;
+  }
+
+  std::string_view InterfaceRegistry::getDriverName(std::string_view name) {
+    size_t end = name.find_last_of("0123456789");
+    if (end == std::string_view::npos) {
+      return name;
+    }
+    size_t start = name.find_last_not_of("0123456789", end);
+    return name.substr(0, start == std::string_view::npos ? 0 : start + 1);
+  }
+
+} // namespace libfreebsdnet::interface
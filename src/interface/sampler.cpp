@@ -0,0 +1,498 @@
+/**
+ * @file interface/sampler.cpp
+ * @brief High-frequency interface counter sampler implementation
+ * @details Keeps struct-of-arrays counter rings per interface on the sampling
+ * thread and publishes computed rates through per-interface seqlocks
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <interface/affinity.hpp>
+#include <interface/sampler.hpp>
+#include <interface/statistics.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    // Single-writer sequence lock. The payload is held in relaxed atomic
+    // words so that a reader racing the writer is well defined; the
+    // sequence check discards torn copies.
+    template <typename T> class SeqSlot {
+      static_assert(std::is_trivially_copyable_v<T>);
+      static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+
+    public:
+      void store(const T &value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+          words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+      }
+
+      T load() const {
+        uint64_t words[WORDS];
+        for (;;) {
+          uint32_t seq = seq_.load(std::memory_order_acquire);
+          if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+          }
+          for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+          }
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (seq_.load(std::memory_order_relaxed) == seq) {
+            break;
+          }
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+      }
+
+    private:
+      std::atomic<uint32_t> seq_{0};
+      std::atomic<uint64_t> words_[WORDS] = {};
+    };
+
+    // Interface indexes are 16 bits wide in if_msghdr; slots live in
+    // lazily allocated segments that are never moved or freed while
+    // readers may hold them
+    constexpr size_t SEGMENT_BITS = 8;
+    constexpr size_t SEGMENT_SIZE = size_t{1} << SEGMENT_BITS;
+    constexpr size_t SEGMENT_COUNT = 65536 / SEGMENT_SIZE;
+
+    struct Segment {
+      SeqSlot<InterfaceRates> slots[SEGMENT_SIZE];
+    };
+
+    // Counter ring for one interface, one array per counter
+    struct History {
+      std::vector<uint64_t> bytesIn;
+      std::vector<uint64_t> bytesOut;
+      std::vector<uint64_t> packetsIn;
+      std::vector<uint64_t> packetsOut;
+      std::vector<std::chrono::steady_clock::time_point> times;
+      size_t head = 0; // slot of the newest sample
+      size_t count = 0;
+      RateSet average;
+      uint64_t seen = 0; // generation of the last sample
+
+      explicit History(size_t window)
+          : bytesIn(window), bytesOut(window), packetsIn(window),
+            packetsOut(window), times(window) {}
+
+      size_t slot(size_t age) const {
+        return (head + times.size() - age) % times.size();
+      }
+
+      // Rate between the samples age + 1 and age steps back
+      RateSet rate(size_t age) const {
+        size_t newer = slot(age);
+        size_t older = slot(age + 1);
+        double seconds =
+            std::chrono::duration<double>(times[newer] - times[older])
+                .count();
+        RateSet r;
+        if (seconds <= 0) {
+          return r;
+        }
+        r.packetsIn = (packetsIn[newer] - packetsIn[older]) / seconds;
+        r.packetsOut = (packetsOut[newer] - packetsOut[older]) / seconds;
+        r.bitsIn = (bytesIn[newer] - bytesIn[older]) * 8.0 / seconds;
+        r.bitsOut = (bytesOut[newer] - bytesOut[older]) * 8.0 / seconds;
+        return r;
+      }
+
+      void push(const InterfaceStatistics &stats,
+                std::chrono::steady_clock::time_point now) {
+        // A counter going backwards means a reset; start a new window
+        if (count > 0 && (stats.bytesReceived < bytesIn[head] ||
+                          stats.bytesSent < bytesOut[head] ||
+                          stats.packetsReceived < packetsIn[head] ||
+                          stats.packetsSent < packetsOut[head])) {
+          count = 0;
+        }
+        head = count == 0 ? 0 : (head + 1) % times.size();
+        bytesIn[head] = stats.bytesReceived;
+        bytesOut[head] = stats.bytesSent;
+        packetsIn[head] = stats.packetsReceived;
+        packetsOut[head] = stats.packetsSent;
+        times[head] = now;
+        count = std::min(count + 1, times.size());
+      }
+    };
+
+    void fold(RateSet &lo, RateSet &hi, const RateSet &r) {
+      lo.packetsIn = std::min(lo.packetsIn, r.packetsIn);
+      lo.packetsOut = std::min(lo.packetsOut, r.packetsOut);
+      lo.bitsIn = std::min(lo.bitsIn, r.bitsIn);
+      lo.bitsOut = std::min(lo.bitsOut, r.bitsOut);
+      hi.packetsIn = std::max(hi.packetsIn, r.packetsIn);
+      hi.packetsOut = std::max(hi.packetsOut, r.packetsOut);
+      hi.bitsIn = std::max(hi.bitsIn, r.bitsIn);
+      hi.bitsOut = std::max(hi.bitsOut, r.bitsOut);
+    }
+
+    RateSet blend(const RateSet &average, const RateSet &r, double w) {
+      return {average.packetsIn + w * (r.packetsIn - average.packetsIn),
+              average.packetsOut + w * (r.packetsOut - average.packetsOut),
+              average.bitsIn + w * (r.bitsIn - average.bitsIn),
+              average.bitsOut + w * (r.bitsOut - average.bitsOut)};
+    }
+
+    // Published snapshot buffers; with three, the writer always has one
+    // that is neither current nor held by a reader of the previous sample
+    constexpr int SNAPSHOT_BUFFERS = 3;
+
+  } // namespace
+
+  struct SamplerSnapshot::Buffer {
+    std::atomic<uint32_t> readers{0};
+    uint64_t generation = 0;
+    std::chrono::steady_clock::time_point timestamp;
+    std::vector<InterfaceSample> samples;
+  };
+
+  class StatisticsSampler::Impl {
+  public:
+    SamplerOptions options;
+    StatisticsCollector collector;
+    std::array<std::atomic<Segment *>, SEGMENT_COUNT> segments{};
+    std::atomic<unsigned int> highestIndex{0};
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> running{false};
+    std::thread thread;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::string lastError;
+    mutable std::mutex errorMutex;
+
+    // Reader counts change under const access
+    mutable std::array<SamplerSnapshot::Buffer, SNAPSHOT_BUFFERS> buffers;
+    std::atomic<int> current{-1}; // published buffer, -1 before a sample
+
+    // Owned by the sampling thread
+    std::unordered_map<unsigned int, History> histories;
+
+    explicit Impl(const SamplerOptions &opts) : options(opts) {
+      options.window = std::max<size_t>(options.window, 2);
+      options.smoothing = std::clamp(options.smoothing, 0.0, 1.0);
+      if (options.smoothing == 0.0) {
+        options.smoothing = SamplerOptions{}.smoothing;
+      }
+      if (options.interval.count() <= 0) {
+        options.interval = SamplerOptions{}.interval;
+      }
+    }
+
+    ~Impl() {
+      stop();
+      for (auto &segment : segments) {
+        delete segment.load();
+      }
+    }
+
+    void setError(const std::string &message) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      lastError = message;
+    }
+
+    SeqSlot<InterfaceRates> *findSlot(unsigned int index) const {
+      if (index == 0 || index >= SEGMENT_COUNT * SEGMENT_SIZE) {
+        return nullptr;
+      }
+      Segment *segment =
+          segments[index >> SEGMENT_BITS].load(std::memory_order_acquire);
+      return segment ? &segment->slots[index & (SEGMENT_SIZE - 1)] : nullptr;
+    }
+
+    SeqSlot<InterfaceRates> *slotFor(unsigned int index) {
+      auto &entry = segments[index >> SEGMENT_BITS];
+      if (!entry.load(std::memory_order_relaxed)) {
+        entry.store(new Segment, std::memory_order_release);
+      }
+      return findSlot(index);
+    }
+
+    InterfaceRates publish(unsigned int index, std::string_view name,
+                           const History &history) {
+      InterfaceRates rates;
+      rates.index = index;
+      name.copy(rates.name, std::min(name.size(), sizeof(rates.name) - 1));
+      rates.samples = static_cast<uint32_t>(history.count);
+      rates.sampledAt = history.times[history.head];
+      if (history.count >= 2) {
+        rates.current = history.rate(0);
+        rates.average = history.average;
+        rates.minimum = rates.maximum = rates.current;
+        for (size_t age = 1; age + 1 < history.count; ++age) {
+          fold(rates.minimum, rates.maximum, history.rate(age));
+        }
+      }
+      slotFor(index)->store(rates);
+      return rates;
+    }
+
+    // Pick a buffer that is neither published nor held by a reader. A
+    // reader that registers on it afterwards sees that it is not current
+    // and backs off, so the writer can fill it freely
+    SamplerSnapshot::Buffer *writableBuffer() {
+      int published = current.load();
+      for (int i = 0; i < SNAPSHOT_BUFFERS; ++i) {
+        if (i != published && buffers[i].readers.load() == 0) {
+          return &buffers[i];
+        }
+      }
+      return nullptr;
+    }
+
+    SamplerSnapshot::Buffer *acquire() const {
+      for (;;) {
+        int index = current.load();
+        if (index < 0) {
+          return nullptr;
+        }
+        auto &buffer = buffers[index];
+        buffer.readers.fetch_add(1);
+        if (current.load() == index) {
+          return &buffer;
+        }
+        buffer.readers.fetch_sub(1);
+      }
+    }
+
+    bool sample() {
+      uint64_t tick = generation.load(std::memory_order_relaxed) + 1;
+      auto now = std::chrono::steady_clock::now();
+      unsigned int highest = highestIndex.load(std::memory_order_relaxed);
+      SamplerSnapshot::Buffer *target = writableBuffer();
+      if (target) {
+        target->samples.clear();
+      }
+
+      bool ok = collector.forEachStatistics(
+          [&](unsigned int index, std::string_view name,
+              const InterfaceStatistics &stats) {
+            if (index == 0 || index >= SEGMENT_COUNT * SEGMENT_SIZE) {
+              return true;
+            }
+            auto [it, inserted] =
+                histories.try_emplace(index, options.window);
+            History &history = it->second;
+            history.push(stats, now);
+            history.seen = tick;
+            if (history.count == 2) {
+              history.average = history.rate(0);
+            } else if (history.count > 2) {
+              history.average = blend(history.average, history.rate(0),
+                                      options.smoothing);
+            }
+            InterfaceRates rates = publish(index, name, history);
+            highest = std::max(highest, index);
+            if (target) {
+              InterfaceSample &sample = target->samples.emplace_back();
+              sample.rates = rates;
+              sample.bytesIn = stats.bytesReceived;
+              sample.bytesOut = stats.bytesSent;
+              sample.packetsIn = stats.packetsReceived;
+              sample.packetsOut = stats.packetsSent;
+              sample.errorsIn = stats.receiveErrors;
+              sample.errorsOut = stats.sendErrors;
+              sample.dropsIn = stats.receiveDropped;
+              sample.dropsOut = stats.sendDropped;
+              sample.multicastIn = stats.multicastReceived;
+              sample.multicastOut = stats.multicastSent;
+              sample.baudrate = stats.baudrate;
+              sample.linkState = stats.linkState;
+            }
+            return true;
+          });
+      if (!ok) {
+        setError("Failed to sample interface statistics");
+        return false;
+      }
+
+      // Clear slots of interfaces that went away
+      for (auto it = histories.begin(); it != histories.end();) {
+        if (it->second.seen != tick) {
+          slotFor(it->first)->store(InterfaceRates{});
+          it = histories.erase(it);
+        } else {
+          ++it;
+        }
+      }
+
+      highestIndex.store(highest, std::memory_order_release);
+      generation.store(tick, std::memory_order_release);
+      if (target) {
+        target->generation = tick;
+        target->timestamp = now;
+        current.store(static_cast<int>(target - buffers.data()));
+      }
+      return true;
+    }
+
+    void run() {
+      auto next = std::chrono::steady_clock::now();
+      std::unique_lock<std::mutex> lock(wakeMutex);
+      while (running.load()) {
+        next += options.interval;
+        if (wake.wait_until(lock, next, [this] { return !running.load(); })) {
+          break;
+        }
+        // Skip ticks missed by a slow sample rather than bursting
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+          next = now;
+        }
+        lock.unlock();
+        sample();
+        lock.lock();
+      }
+    }
+
+    bool start() {
+      if (running.load()) {
+        return true;
+      }
+      if (!sample()) {
+        return false;
+      }
+      running = true;
+      thread = std::thread([this] { run(); });
+      if (options.housekeeping) {
+        // Sampling walks every interface; doing it on a CPU that services
+        // receive interrupts evicts the packet path's cache lines
+        QueueAffinity::pin(thread.native_handle(),
+                           QueueAffinity::getHousekeepingCpus());
+      }
+      return true;
+    }
+
+    void stop() {
+      if (thread.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(wakeMutex);
+          running = false;
+        }
+        wake.notify_all();
+        thread.join();
+      }
+    }
+
+    bool getRates(unsigned int index, InterfaceRates &rates) const {
+      const SeqSlot<InterfaceRates> *slot = findSlot(index);
+      if (!slot) {
+        return false;
+      }
+      rates = slot->load();
+      return rates.index == index;
+    }
+  };
+
+  SamplerSnapshot::SamplerSnapshot(SamplerSnapshot &&other) noexcept
+      : buffer_(std::exchange(other.buffer_, nullptr)) {}
+
+  SamplerSnapshot &
+  SamplerSnapshot::operator=(SamplerSnapshot &&other) noexcept {
+    if (this != &other) {
+      if (buffer_) {
+        buffer_->readers.fetch_sub(1);
+      }
+      buffer_ = std::exchange(other.buffer_, nullptr);
+    }
+    return *this;
+  }
+
+  SamplerSnapshot::~SamplerSnapshot() {
+    if (buffer_) {
+      buffer_->readers.fetch_sub(1);
+    }
+  }
+
+  std::span<const InterfaceSample> SamplerSnapshot::getInterfaces() const {
+    if (!buffer_) {
+      return {};
+    }
+    return buffer_->samples;
+  }
+
+  uint64_t SamplerSnapshot::getGeneration() const {
+    return buffer_ ? buffer_->generation : 0;
+  }
+
+  std::chrono::steady_clock::time_point SamplerSnapshot::getTimestamp() const {
+    return buffer_ ? buffer_->timestamp
+                   : std::chrono::steady_clock::time_point{};
+  }
+
+  StatisticsSampler::StatisticsSampler(const SamplerOptions &options)
+      : pImpl(std::make_unique<Impl>(options)) {}
+
+  StatisticsSampler::~StatisticsSampler() = default;
+
+  bool StatisticsSampler::start() { return pImpl->start(); }
+
+  void StatisticsSampler::stop() { pImpl->stop(); }
+
+  bool StatisticsSampler::isRunning() const { return pImpl->running.load(); }
+
+  bool StatisticsSampler::getRates(unsigned int index,
+                                   InterfaceRates &rates) const {
+    return pImpl->getRates(index, rates);
+  }
+
+  bool StatisticsSampler::getRates(const std::string &name,
+                                   InterfaceRates &rates) const {
+    unsigned int index = if_nametoindex(name.c_str());
+    // The index may have been reused since the last sample
+    return index != 0 && pImpl->getRates(index, rates) && name == rates.name;
+  }
+
+  std::vector<InterfaceRates> StatisticsSampler::getAllRates() const {
+    std::vector<InterfaceRates> all;
+    unsigned int highest =
+        pImpl->highestIndex.load(std::memory_order_acquire);
+    InterfaceRates rates;
+    for (unsigned int index = 1; index <= highest; ++index) {
+      if (pImpl->getRates(index, rates)) {
+        all.push_back(rates);
+      }
+    }
+    return all;
+  }
+
+  SamplerSnapshot StatisticsSampler::getSnapshot() const {
+    return SamplerSnapshot(pImpl->acquire());
+  }
+
+  uint64_t StatisticsSampler::getGeneration() const {
+    return pImpl->generation.load(std::memory_order_acquire);
+  }
+
+  std::string StatisticsSampler::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->errorMutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
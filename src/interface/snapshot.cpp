@@ -0,0 +1,195 @@
+/**
+ * @file interface/snapshot.cpp
+ * @brief Single-pass interface snapshot implementation
+ * @details Parses a NET_RT_IFLISTL routing sysctl dump into interface
+ * records
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <interface/snapshot.hpp>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <system/sockaddr.hpp>
+#include <system/sysctl.hpp>
+#include <unordered_map>
+
+namespace libfreebsdnet::interface {
+
+  class InterfaceSnapshot::Impl {
+  public:
+    std::vector<std::shared_ptr<const InterfaceRecord>> records;
+    std::unordered_map<std::string, size_t> byName;
+    std::unordered_map<unsigned int, size_t> byIndex;
+    std::chrono::steady_clock::time_point timestamp;
+    std::string lastError;
+
+    bool load(unsigned int index) {
+      int mib[] = {CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLISTL,
+                   static_cast<int>(index)};
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!buffer.fetch(mib)) {
+        lastError = "Failed to dump interface list: " + buffer.getLastError();
+        return false;
+      }
+
+      records.clear();
+      byName.clear();
+      byIndex.clear();
+
+      std::shared_ptr<InterfaceRecord> current;
+      const char *end = buffer.data() + buffer.size();
+      for (const char *next = buffer.data(); next < end;) {
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(next);
+        if (rtm->rtm_msglen == 0) {
+          break;
+        }
+        if (rtm->rtm_version != RTM_VERSION) {
+          next += rtm->rtm_msglen;
+          continue;
+        }
+
+        const struct sockaddr *sa[RTAX_MAX];
+        if (rtm->rtm_type == RTM_IFINFO) {
+          auto *ifm = reinterpret_cast<const struct if_msghdrl *>(next);
+          flush(current);
+          current = std::make_shared<InterfaceRecord>();
+          current->index = ifm->ifm_index;
+          current->flags = ifm->ifm_flags;
+          std::memcpy(&current->data, next + ifm->ifm_data_off,
+                      std::min<size_t>(sizeof(current->data),
+                                       ifm->ifm_msglen - ifm->ifm_data_off));
+          current->type = current->data.ifi_type;
+
+          system::splitAddresses(next + ifm->ifm_len,
+                                 next + ifm->ifm_msglen, ifm->ifm_addrs, sa);
+          if (sa[RTAX_IFP] && sa[RTAX_IFP]->sa_family == AF_LINK) {
+            auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(
+                sa[RTAX_IFP]);
+            current->name.assign(sdl->sdl_data, sdl->sdl_nlen);
+            if (sdl->sdl_alen <= current->linkBytes.size()) {
+              current->linkLength = sdl->sdl_alen;
+              std::memcpy(current->linkBytes.data(), CLLADDR(sdl),
+                          sdl->sdl_alen);
+            }
+            if (sdl->sdl_alen == 6) {
+              const uint8_t *mac =
+                  reinterpret_cast<const uint8_t *>(CLLADDR(sdl));
+              char macStr[18];
+              std::snprintf(macStr, sizeof(macStr),
+                            "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1],
+                            mac[2], mac[3], mac[4], mac[5]);
+              current->linkAddress = macStr;
+            }
+          }
+        } else if (rtm->rtm_type == RTM_NEWADDR && current) {
+          auto *ifam = reinterpret_cast<const struct ifa_msghdrl *>(next);
+          system::splitAddresses(next + ifam->ifam_len,
+                                 next + ifam->ifam_msglen, ifam->ifam_addrs,
+                                 sa);
+          addAddress(*current, sa[RTAX_IFA], sa[RTAX_NETMASK]);
+        }
+
+        next += rtm->rtm_msglen;
+      }
+      flush(current);
+
+      timestamp = std::chrono::steady_clock::now();
+      return true;
+    }
+
+  private:
+    void flush(std::shared_ptr<InterfaceRecord> &record) {
+      if (!record) {
+        return;
+      }
+      size_t slot = records.size();
+      byName.emplace(record->name, slot);
+      byIndex.emplace(record->index, slot);
+      records.push_back(std::move(record));
+    }
+
+    static void addAddress(InterfaceRecord &record,
+                           const struct sockaddr *addr,
+                           const struct sockaddr *mask) {
+      if (!addr) {
+        return;
+      }
+      if (addr->sa_family == AF_INET) {
+        auto *sin = reinterpret_cast<const struct sockaddr_in *>(addr);
+        record.addresses.emplace_back(sin->sin_addr,
+                                      system::maskToPrefix(mask, AF_INET));
+      } else if (addr->sa_family == AF_INET6) {
+        auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(addr);
+        record.addresses.emplace_back(sin6->sin6_addr,
+                                      system::maskToPrefix(mask, AF_INET6));
+      }
+    }
+  };
+
+  InterfaceSnapshot::InterfaceSnapshot() : pImpl(std::make_unique<Impl>()) {}
+
+  InterfaceSnapshot::~InterfaceSnapshot() = default;
+
+  bool InterfaceSnapshot::refresh(unsigned int index) {
+    return pImpl->load(index);
+  }
+
+  std::shared_ptr<const InterfaceRecord>
+  InterfaceSnapshot::find(const std::string &name) const {
+    auto it = pImpl->byName.find(name);
+    return it != pImpl->byName.end() ? pImpl->records[it->second] : nullptr;
+  }
+
+  std::shared_ptr<const InterfaceRecord>
+  InterfaceSnapshot::find(unsigned int index) const {
+    auto it = pImpl->byIndex.find(index);
+    return it != pImpl->byIndex.end() ? pImpl->records[it->second] : nullptr;
+  }
+
+  const std::vector<std::shared_ptr<const InterfaceRecord>> &
+  InterfaceSnapshot::getRecords() const {
+    return pImpl->records;
+  }
+
+  size_t InterfaceSnapshot::size() const { return pImpl->records.size(); }
+
+  size_t InterfaceSnapshot::getMemoryUsage() const {
+    // Records plus their strings and address vectors; hash nodes are
+    // counted as one pointer-sized key and value each
+    size_t bytes = pImpl->records.capacity() *
+                   sizeof(std::shared_ptr<const InterfaceRecord>);
+    for (const auto &record : pImpl->records) {
+      bytes += sizeof(InterfaceRecord) + record->name.capacity() +
+               record->linkAddress.capacity() +
+               record->addresses.capacity() * sizeof(types::Address);
+    }
+    bytes += pImpl->byName.size() *
+             (sizeof(std::string) + sizeof(size_t) + 2 * sizeof(void *));
+    bytes += pImpl->byIndex.size() *
+             (sizeof(unsigned int) + sizeof(size_t) + 2 * sizeof(void *));
+    return bytes;
+  }
+
+  std::chrono::steady_clock::time_point
+  InterfaceSnapshot::getTimestamp() const {
+    return pImpl->timestamp;
+  }
+
+  std::string InterfaceSnapshot::getLastError() const {
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
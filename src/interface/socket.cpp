@@ -0,0 +1,91 @@
+/**
+ * @file interface/socket.cpp
+ * @brief Shared control socket implementation
+ * @details Per-thread control socket cache with global usage counters
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <interface/socket.hpp>
+#include <metrics/metrics.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    std::atomic<uint64_t> openCount{0};
+    std::atomic<uint64_t> requestCount{0};
+
+    struct SocketSet {
+      int inet = -1;
+      int inet6 = -1;
+      int local = -1;
+
+      ~SocketSet() { closeAll(); }
+
+      int *slot(int family) {
+        switch (family) {
+        case AF_INET:
+          return &inet;
+        case AF_INET6:
+          return &inet6;
+        case AF_LOCAL:
+          return &local;
+        default:
+          return nullptr;
+        }
+      }
+
+      void closeAll() {
+        for (int *fd : {&inet, &inet6, &local}) {
+          if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+          }
+        }
+      }
+    };
+
+    thread_local SocketSet sockets;
+
+  } // namespace
+
+  int ControlSocket::get(int family) {
+    requestCount.fetch_add(1, std::memory_order_relaxed);
+
+    int *fd = sockets.slot(family);
+    if (!fd) {
+      errno = EAFNOSUPPORT;
+      return -1;
+    }
+    if (*fd < 0) {
+      LIBFREEBSDNET_METRICS_SYSCALL(SOCKET);
+      *fd = socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+      if (*fd >= 0) {
+        openCount.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    return *fd;
+  }
+
+  void ControlSocket::release() { sockets.closeAll(); }
+
+  uint64_t ControlSocket::getOpenCount() {
+    return openCount.load(std::memory_order_relaxed);
+  }
+
+  uint64_t ControlSocket::getRequestCount() {
+    return requestCount.load(std::memory_order_relaxed);
+  }
+
+  void ControlSocket::resetCounters() {
+    openCount.store(0, std::memory_order_relaxed);
+    requestCount.store(0, std::memory_order_relaxed);
+  }
+
+} // namespace libfreebsdnet::interface
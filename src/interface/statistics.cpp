@@ -7,36 +7,158 @@
  * @year 2024
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
-#include <ifaddrs.h>
 #include <interface/statistics.hpp>
+#include <iterator>
+#include <mutex>
 #include <net/if.h>
+#include <net/if_dl.h>
 #include <net/if_mib.h>
+#include <net/if_pfsync.h>
+#include <net/route.h>
 #include <stdexcept>
+#include <string_view>
 #include <sys/socket.h>
 #include <sys/sysctl.h>
+#include <system/sysctl.hpp>
 #include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
 namespace libfreebsdnet::interface {
 
+  namespace {
+
+    void fillStatistics(const struct if_data &data,
+                        InterfaceStatistics &stats) {
+      stats.bytesReceived = data.ifi_ibytes;
+      stats.packetsReceived = data.ifi_ipackets;
+      stats.receiveErrors = data.ifi_ierrors;
+      stats.receiveDropped = data.ifi_iqdrops;
+      stats.multicastReceived = data.ifi_imcasts;
+      stats.unknownProtocol = data.ifi_noproto;
+
+      stats.bytesSent = data.ifi_obytes;
+      stats.packetsSent = data.ifi_opackets;
+      stats.sendErrors = data.ifi_oerrors;
+      stats.sendDropped = data.ifi_oqdrops;
+      stats.multicastSent = data.ifi_omcasts;
+
+      stats.collisions = data.ifi_collisions;
+
+      stats.baudrate = data.ifi_baudrate;
+      stats.linkState = data.ifi_link_state;
+      stats.lastChange = std::chrono::system_clock::time_point(
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+              std::chrono::seconds(data.ifi_lastchange.tv_sec) +
+              std::chrono::microseconds(data.ifi_lastchange.tv_usec)));
+    }
+
+    // Queue nodes directly below dev.<driver>.<unit>, or below its iflib
+    // or pf node: "queue0", "rxq0", "txq00", "rx_queue0", "rxstat0", ...
+    bool isQueueNode(std::string_view node) {
+      size_t digits = node.find_first_of("0123456789");
+      if (digits == 0 || digits == std::string_view::npos ||
+          node.find_first_not_of("0123456789", digits) !=
+              std::string_view::npos) {
+        return false;
+      }
+      std::string_view stem = node.substr(0, digits);
+      return stem.find('q') != std::string_view::npos ||
+             stem.ends_with("stat");
+    }
+
+    // Resolved queue counter leaves of one driver instance
+    struct QueueLayout {
+      std::string driver; // e.g. "ix0"
+      std::vector<std::string> queues;
+      struct Counter {
+        size_t queue;
+        std::string name;
+        system::SysctlLeaf leaf;
+      };
+      std::vector<Counter> counters;
+    };
+
+    std::string driverName(unsigned int index) {
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(index), IFDATA_DRIVERNAME};
+      char name[IFNAMSIZ * 2] = {0};
+      size_t len = sizeof(name) - 1;
+      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), name, &len, nullptr, 0) !=
+          0) {
+        return "";
+      }
+      return std::string(name, strnlen(name, len));
+    }
+
+    void buildLayout(const std::string &driver, QueueLayout &layout) {
+      layout = QueueLayout{};
+      layout.driver = driver;
+
+      // "ix0" lives under dev.ix.0
+      size_t unit = driver.find_last_not_of("0123456789");
+      if (unit == std::string::npos || unit + 1 == driver.size()) {
+        return;
+      }
+      std::string prefix = "dev." + driver.substr(0, unit + 1) + "." +
+                           driver.substr(unit + 1);
+      std::vector<system::SysctlLeaf> leaves;
+      if (!system::SysctlTree::list(prefix, leaves)) {
+        return;
+      }
+
+      for (auto &leaf : leaves) {
+        if (!leaf.isInteger() || leaf.name.size() <= prefix.size() + 1) {
+          continue;
+        }
+        std::string_view rest(leaf.name);
+        rest.remove_prefix(prefix.size() + 1);
+        if (rest.starts_with("iflib.")) {
+          rest.remove_prefix(6);
+        } else if (rest.starts_with("pf.")) {
+          rest.remove_prefix(3); // ixl and ice
+        }
+        size_t dot = rest.find('.');
+        if (dot == std::string_view::npos ||
+            !isQueueNode(rest.substr(0, dot))) {
+          continue;
+        }
+        std::string queue(rest.substr(0, dot));
+        auto it = std::find(layout.queues.begin(), layout.queues.end(), queue);
+        size_t slot = static_cast<size_t>(it - layout.queues.begin());
+        if (it == layout.queues.end()) {
+          layout.queues.push_back(queue);
+        }
+        layout.counters.push_back(
+            {slot, std::string(rest.substr(dot + 1)), std::move(leaf)});
+      }
+    }
+
+  } // namespace
+
   // InterfaceStatistics implementation
   InterfaceStatistics::InterfaceStatistics()
       : bytesReceived(0), packetsReceived(0), receiveErrors(0),
         receiveDropped(0), receiveFrameErrors(0), receiveOverruns(0),
-        bytesSent(0), packetsSent(0), sendErrors(0), sendDropped(0),
-        sendOverruns(0), collisions(0), carrierErrors(0),
-        lastUpdated(std::chrono::system_clock::now()) {}
+        multicastReceived(0), unknownProtocol(0), bytesSent(0),
+        packetsSent(0), sendErrors(0), sendDropped(0), sendOverruns(0),
+        multicastSent(0), collisions(0), carrierErrors(0), baudrate(0),
+        linkState(0), lastUpdated(std::chrono::system_clock::now()) {}
 
   // StatisticsCollector implementation
   class StatisticsCollector::Impl {
   public:
-    Impl() {
-      // Check if statistics collection is available
-      available_ = checkAvailability();
+    // The ifmib tree is a property of the kernel, so it is probed once per
+    // process, and only by the first call that needs it
+    static bool available() {
+      static const bool result = checkAvailability();
+      return result;
     }
 
-    bool checkAvailability() const {
+    static bool checkAvailability() {
       // Try to get system statistics to check availability
       size_t len = 0;
       int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_SYSTEM,
@@ -52,7 +174,7 @@ namespace libfreebsdnet::interface {
     InterfaceStatistics getStatistics(const std::string &interfaceName) const {
       InterfaceStatistics stats;
 
-      if (!available_) {
+      if (!available()) {
         throw std::runtime_error("Statistics collection not available");
       }
 
@@ -63,90 +185,98 @@ namespace libfreebsdnet::interface {
       }
 
       // Get interface statistics using sysctl
-      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, static_cast<int>(ifIndex),
-                   IFDATA_GENERAL};
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(ifIndex), IFDATA_GENERAL};
+
+      // The record has a fixed size, so read it straight into place
+      // without a size probe or heap buffer
+      struct ifmibdata ifmd;
+      size_t len = sizeof(ifmd);
+      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), &ifmd, &len, nullptr, 0) !=
+          0) {
+        throw std::runtime_error("Failed to get interface statistics: " +
+                                 std::string(strerror(errno)));
+      }
 
-      size_t len = 0;
-      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), nullptr, &len, nullptr,
-                 0) != 0) {
-        throw std::runtime_error("Failed to get interface statistics size");
-      }
-
-      if (len > 0) {
-        std::vector<uint8_t> buffer(len);
-        if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), buffer.data(), &len,
-                   nullptr, 0) == 0) {
-          // Parse the if_data structure with complete implementation
-          struct if_data *ifd =
-              reinterpret_cast<struct if_data *>(buffer.data());
-
-          // Extract all available statistics from if_data structure
-          stats.bytesReceived = ifd->ifi_ibytes;
-          stats.packetsReceived = ifd->ifi_ipackets;
-          stats.receiveErrors = ifd->ifi_ierrors;
-          stats.receiveDropped = ifd->ifi_iqdrops;
-          stats.receiveFrameErrors = ifd->ifi_ierrors;
-          stats.receiveOverruns = ifd->ifi_ierrors;
-
-          stats.bytesSent = ifd->ifi_obytes;
-          stats.packetsSent = ifd->ifi_opackets;
-          stats.sendErrors = ifd->ifi_oerrors;
-          stats.sendDropped = ifd->ifi_oqdrops;
-          stats.sendOverruns = ifd->ifi_oerrors;
-
-          stats.collisions = ifd->ifi_collisions;
-          stats.carrierErrors = ifd->ifi_ierrors;
-
-          // Additional statistics available in if_data
-          // Note: These would be added to InterfaceStatistics if needed
-          // ifd->ifi_iqdrops - input queue drops
-          // ifd->ifi_oqdrops - output queue drops
-          // ifd->ifi_imcasts - input multicast packets
-          // ifd->ifi_omcasts - output multicast packets
-          // ifd->ifi_ibytes - input bytes
-          // ifd->ifi_obytes - output bytes
-          // ifd->ifi_ipackets - input packets
-          // ifd->ifi_opackets - output packets
-
-          stats.lastUpdated = std::chrono::system_clock::now();
-        }
+      if (len >= sizeof(ifmd)) {
+        fillStatistics(ifmd.ifmd_data, stats);
+        fillQueues(ifIndex, stats);
+        stats.lastUpdated = std::chrono::system_clock::now();
       }
 
       return stats;
     }
 
-    std::unordered_map<std::string, InterfaceStatistics>
-    getAllStatistics() const {
-      std::unordered_map<std::string, InterfaceStatistics> allStats;
-
-      if (!available_) {
-        return allStats;
+    bool forEachStatistics(const StatisticsVisitor &visitor) const {
+      // One NET_RT_IFLIST dump carries the if_data of every interface, so
+      // a full sample costs a single sysctl regardless of interface count
+      int mib[] = {CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST, 0};
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!buffer.fetch(mib)) {
+        return false;
       }
 
-      // Get all interfaces
-      struct ifaddrs *ifaddrs_ptr;
-      if (getifaddrs(&ifaddrs_ptr) == -1) {
-        return allStats;
-      }
+      auto now = std::chrono::system_clock::now();
+      const char *end = buffer.data() + buffer.size();
+      for (const char *next = buffer.data(); next < end;) {
+        auto *ifm = reinterpret_cast<const struct if_msghdr *>(next);
+        if (ifm->ifm_msglen == 0) {
+          break;
+        }
+        next += ifm->ifm_msglen;
+        // Address messages follow each interface; only RTM_IFINFO has data
+        if (ifm->ifm_version != RTM_VERSION || ifm->ifm_type != RTM_IFINFO) {
+          continue;
+        }
 
-      for (struct ifaddrs *ifa = ifaddrs_ptr; ifa != nullptr;
-           ifa = ifa->ifa_next) {
-        if (ifa->ifa_name && ifa->ifa_addr) {
-          try {
-            allStats[ifa->ifa_name] = getStatistics(ifa->ifa_name);
-          } catch (const std::exception &) {
-            // Skip interfaces that can't provide statistics
-            continue;
+        // RTM_IFINFO carries only the link-level address, named after the
+        // interface
+        std::string_view name;
+        if (ifm->ifm_addrs & RTA_IFP) {
+          auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(ifm + 1);
+          if (sdl->sdl_family == AF_LINK) {
+            name = std::string_view(sdl->sdl_data, sdl->sdl_nlen);
           }
         }
+
+        InterfaceStatistics stats;
+        fillStatistics(ifm->ifm_data, stats);
+        fillQueues(ifm->ifm_index, stats);
+        stats.lastUpdated = now;
+        if (!visitor(ifm->ifm_index, name, stats)) {
+          break;
+        }
       }
+      return true;
+    }
+
+    std::unordered_map<unsigned int, InterfaceStatistics>
+    getStatisticsByIndex() const {
+      std::unordered_map<unsigned int, InterfaceStatistics> allStats;
+      forEachStatistics([&allStats](unsigned int index, std::string_view,
+                                    const InterfaceStatistics &stats) {
+        allStats.emplace(index, stats);
+        return true;
+      });
+      return allStats;
+    }
 
-      freeifaddrs(ifaddrs_ptr);
+    std::unordered_map<std::string, InterfaceStatistics>
+    getAllStatistics() const {
+      std::unordered_map<std::string, InterfaceStatistics> allStats;
+      forEachStatistics([&allStats](unsigned int, std::string_view name,
+                                    const InterfaceStatistics &stats) {
+        if (!name.empty()) {
+          allStats.emplace(std::string(name), stats);
+        }
+        return true;
+      });
       return allStats;
     }
 
     bool resetStatistics(const std::string &interfaceName) {
-      if (!available_) {
+      if (!available()) {
         return false;
       }
 
@@ -157,8 +287,8 @@ namespace libfreebsdnet::interface {
       }
 
       // Reset statistics using sysctl
-      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, static_cast<int>(ifIndex),
-                   IFDATA_GENERAL};
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(ifIndex), IFDATA_GENERAL};
 
       // Use sysctl to reset interface statistics
       // This requires appropriate privileges and may not be available on all
@@ -171,12 +301,148 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    bool isAvailable() const { return available_; }
+    bool getPfsyncStatistics(PfsyncStatistics &stats) const {
+      if (!resolvePfsync()) {
+        return false;
+      }
+      struct pfsyncstats raw;
+      size_t len = sizeof(raw);
+      if (sysctl(pfsyncMib_.data(), static_cast<u_int>(pfsyncMib_.size()),
+                 &raw, &len, nullptr, 0) != 0) {
+        return false;
+      }
+      stats.packetsIn = raw.pfsyncs_ipackets;
+      stats.packetsIn6 = raw.pfsyncs_ipackets6;
+      stats.badInterface = raw.pfsyncs_badif;
+      stats.badTtl = raw.pfsyncs_badttl;
+      stats.shortHeader = raw.pfsyncs_hdrops;
+      stats.badVersion = raw.pfsyncs_badver;
+      stats.badAction = raw.pfsyncs_badact;
+      stats.badLength = raw.pfsyncs_badlen;
+      stats.badAuth = raw.pfsyncs_badauth;
+      stats.stale = raw.pfsyncs_stale;
+      stats.badValue = raw.pfsyncs_badval;
+      stats.badState = raw.pfsyncs_badstate;
+      stats.packetsOut = raw.pfsyncs_opackets;
+      stats.packetsOut6 = raw.pfsyncs_opackets6;
+      stats.noMemory = raw.pfsyncs_onomem;
+      stats.outputErrors = raw.pfsyncs_oerrors;
+      stats.actionsIn.assign(std::begin(raw.pfsyncs_iacts),
+                             std::end(raw.pfsyncs_iacts));
+      stats.actionsOut.assign(std::begin(raw.pfsyncs_oacts),
+                              std::end(raw.pfsyncs_oacts));
+      stats.sampledAt = std::chrono::steady_clock::now();
+      return true;
+    }
+
+    bool resetPfsyncStatistics() {
+      if (!resolvePfsync()) {
+        return false;
+      }
+      // Writing a zeroed structure clears the per-CPU counters
+      struct pfsyncstats zero;
+      std::memset(&zero, 0, sizeof(zero));
+      return sysctl(pfsyncMib_.data(), static_cast<u_int>(pfsyncMib_.size()),
+                    nullptr, nullptr, &zero, sizeof(zero)) == 0;
+    }
+
+    bool isAvailable() const { return available(); }
+
+    std::atomic<bool> queueStatistics{false};
+
+    bool readQueues(unsigned int index,
+                    std::vector<QueueStatistics> &queues) const {
+      // The driver name is re-read so that a reused index is noticed
+      std::string driver = driverName(index);
+      if (driver.empty()) {
+        queues.clear();
+        return false;
+      }
+
+      std::lock_guard<std::mutex> lock(layoutMutex_);
+      QueueLayout &layout = layouts_[index];
+      if (layout.driver != driver) {
+        buildLayout(driver, layout);
+      }
+
+      queues.resize(layout.queues.size());
+      for (size_t i = 0; i < layout.queues.size(); ++i) {
+        queues[i].name = layout.queues[i];
+        queues[i].counters.clear();
+      }
+      for (const auto &counter : layout.counters) {
+        uint64_t value;
+        if (system::SysctlTree::readInteger(counter.leaf, value)) {
+          queues[counter.queue].counters.emplace_back(counter.name, value);
+        }
+      }
+      return true;
+    }
 
   private:
-    bool available_;
+    mutable std::mutex layoutMutex_;
+    mutable std::unordered_map<unsigned int, QueueLayout> layouts_;
+    mutable std::mutex pfsyncMutex_;
+    mutable std::vector<int> pfsyncMib_;
+
+    // Resolved on first use, since pfsync may be loaded after construction
+    bool resolvePfsync() const {
+      std::lock_guard<std::mutex> lock(pfsyncMutex_);
+      if (!pfsyncMib_.empty()) {
+        return true;
+      }
+      int mib[CTL_MAXNAME];
+      size_t length = CTL_MAXNAME;
+      if (sysctlnametomib("net.pfsync.stats", mib, &length) != 0) {
+        return false;
+      }
+      pfsyncMib_.assign(mib, mib + length);
+      return true;
+    }
+
+    void fillQueues(unsigned int index, InterfaceStatistics &stats) const {
+      if (queueStatistics.load(std::memory_order_relaxed)) {
+        readQueues(index, stats.queues);
+      }
+    }
   };
 
+  PfsyncRates getPfsyncRates(const PfsyncStatistics &previous,
+                             const PfsyncStatistics &current) {
+    PfsyncRates rates;
+    double seconds =
+        std::chrono::duration<double>(current.sampledAt - previous.sampledAt)
+            .count();
+    if (seconds <= 0) {
+      return rates;
+    }
+    // A counter that went backwards was reset; count from zero
+    auto rate = [seconds](uint64_t before, uint64_t after) {
+      return static_cast<double>(after >= before ? after - before : after) /
+             seconds;
+    };
+    rates.packetsIn = rate(previous.packetsIn + previous.packetsIn6,
+                           current.packetsIn + current.packetsIn6);
+    rates.packetsOut = rate(previous.packetsOut + previous.packetsOut6,
+                            current.packetsOut + current.packetsOut6);
+    rates.errorsIn =
+        rate(previous.getInputErrors(), current.getInputErrors());
+    rates.errorsOut = rate(previous.noMemory + previous.outputErrors,
+                           current.noMemory + current.outputErrors);
+    rates.stale = rate(previous.stale, current.stale);
+    for (size_t i = 0; i < current.actionsIn.size(); ++i) {
+      rates.actionsIn.push_back(rate(
+          i < previous.actionsIn.size() ? previous.actionsIn[i] : 0,
+          current.actionsIn[i]));
+    }
+    for (size_t i = 0; i < current.actionsOut.size(); ++i) {
+      rates.actionsOut.push_back(rate(
+          i < previous.actionsOut.size() ? previous.actionsOut[i] : 0,
+          current.actionsOut[i]));
+    }
+    return rates;
+  }
+
   StatisticsCollector::StatisticsCollector()
       : pImpl(std::make_unique<Impl>()) {}
 
@@ -192,10 +458,41 @@ namespace libfreebsdnet::interface {
     return pImpl->getAllStatistics();
   }
 
+  std::unordered_map<unsigned int, InterfaceStatistics>
+  StatisticsCollector::getStatisticsByIndex() const {
+    return pImpl->getStatisticsByIndex();
+  }
+
+  bool StatisticsCollector::forEachStatistics(
+      const StatisticsVisitor &visitor) const {
+    return pImpl->forEachStatistics(visitor);
+  }
+
+  bool StatisticsCollector::readQueues(
+      unsigned int index, std::vector<QueueStatistics> &queues) const {
+    return pImpl->readQueues(index, queues);
+  }
+
   bool StatisticsCollector::resetStatistics(const std::string &interfaceName) {
     return pImpl->resetStatistics(interfaceName);
   }
 
+  bool StatisticsCollector::getPfsyncStatistics(PfsyncStatistics &stats) const {
+    return pImpl->getPfsyncStatistics(stats);
+  }
+
+  bool StatisticsCollector::resetPfsyncStatistics() {
+    return pImpl->resetPfsyncStatistics();
+  }
+
+  void StatisticsCollector::setQueueStatistics(bool enabled) {
+    pImpl->queueStatistics = enabled;
+  }
+
+  bool StatisticsCollector::getQueueStatistics() const {
+    return pImpl->queueStatistics.load();
+  }
+
   bool StatisticsCollector::isAvailable() const { return pImpl->isAvailable(); }
 
 } // namespace libfreebsdnet::interface
@@ -26,7 +26,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class TapInterface::Impl {
+  class TapInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -44,15 +44,11 @@ namespace libfreebsdnet::interface {
 
   TapInterface::TapInterface(const std::string &name, unsigned int index,
                              int flags)
-      : TunnelInterface(name, index, flags),
+      : InterfaceBase(name, index, flags),
         pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   TapInterface::~TapInterface() = default;
 
-  InterfaceType TapInterface::getType() const {
-    return InterfaceType::TUNNEL; // TAP is a type of tunnel
-  }
-
   int TapInterface::getUnit() const { return pImpl->unit; }
 
   bool TapInterface::setUnit(int unit) {
@@ -104,78 +100,4 @@ namespace libfreebsdnet::interface {
         "TAP interfaces do not support tunnel FIB operations");
   }
 
-  // Group management methods (call base class)
-  std::vector<std::string> TapInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool TapInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool TapInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
-  // Base class method implementations (call base class)
-  int TapInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool TapInterface::setMedia(int media) { return Interface::setMedia(media); }
-
-  int TapInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int TapInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> TapInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t TapInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool TapInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t TapInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool TapInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool TapInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  bool TapInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool TapInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool TapInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> TapInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  std::string TapInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
-
-  bool TapInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
-  }
-
 } // namespace libfreebsdnet::interface
@@ -0,0 +1,524 @@
+/**
+ * @file interface/topology.cpp
+ * @brief Interface dependency graph implementation
+ * @details Each interface keeps what its own ioctls reported, with parents
+ * by name; edges are resolved from those readings to indices whenever one
+ * changes, which needs no kernel access
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <interface/bridge.hpp>
+#include <interface/carp.hpp>
+#include <interface/gif.hpp>
+#include <interface/snapshot.hpp>
+#include <interface/socket.hpp>
+#include <interface/topology.hpp>
+#include <interface/vlan.hpp>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <net/if_lagg.h>
+#include <net/if_types.h>
+#include <netlink/manager.hpp>
+#include <shared_mutex>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    struct Edge {
+      unsigned int parent = 0;
+      unsigned int child = 0; // 0 for CARP
+      DependencyKind kind = DependencyKind::VLAN;
+      int vhid = 0;
+
+      bool operator==(const Edge &) const = default;
+    };
+
+    // What one interface's own ioctls reported
+    struct Reading {
+      std::vector<std::pair<std::string, DependencyKind>> parents;
+      std::vector<int> vhids;
+      std::string local;      // tunnel outer source address
+      bool aggregate = false; // lagg or bridge
+    };
+
+    // SIOCGLAGG succeeds only on a lagg, which otherwise looks like any
+    // Ethernet interface
+    bool readLaggPorts(const std::string &name, Reading &reading) {
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return false;
+      }
+      std::array<struct lagg_reqport, LAGG_MAX_PORTS> buffer;
+      std::memset(buffer.data(), 0, sizeof(buffer));
+      struct lagg_reqall ra;
+      std::memset(&ra, 0, sizeof(ra));
+      std::strncpy(ra.ra_ifname, name.c_str(), IFNAMSIZ - 1);
+      ra.ra_port = buffer.data();
+      ra.ra_size = sizeof(buffer);
+      if (metrics::tracedIoctl(sock, SIOCGLAGG, &ra) < 0) {
+        return false;
+      }
+      size_t count = std::min<size_t>(ra.ra_ports, buffer.size());
+      for (size_t i = 0; i < count; ++i) {
+        reading.parents.emplace_back(buffer[i].rp_portname,
+                                     DependencyKind::LAGG);
+      }
+      return true;
+    }
+
+    Reading readRecord(const InterfaceRecord &record) {
+      Reading reading;
+      switch (record.type) {
+      case IFT_L2VLAN: {
+        VlanInterface vlan(record.name, record.index, record.flags);
+        std::string parent = vlan.getParentInterface();
+        if (!parent.empty()) {
+          reading.parents.emplace_back(std::move(parent),
+                                       DependencyKind::VLAN);
+        }
+        break;
+      }
+      case IFT_BRIDGE: {
+        BridgeInterface bridge(record.name, record.index, record.flags);
+        for (const auto &member : bridge.getMembers()) {
+          reading.parents.emplace_back(member.name, DependencyKind::BRIDGE);
+        }
+        reading.aggregate = true;
+        break;
+      }
+      case IFT_GIF:
+      case IFT_TUNNEL: {
+        // gre answers the same SIOCGIFPSRCADDR as gif
+        GifInterface tunnel(record.name, record.index, record.flags);
+        reading.local = tunnel.getLocalAddress();
+        break;
+      }
+      case IFT_ETHER:
+        reading.aggregate = readLaggPorts(record.name, reading);
+        break;
+      default:
+        break;
+      }
+      if ((record.flags & IFF_MULTICAST) && !(record.flags & IFF_LOOPBACK)) {
+        CarpInterface carrier(record.name, record.index, record.flags);
+        for (const auto &info : carrier.getCarpInfo()) {
+          reading.vhids.push_back(info.vhid);
+        }
+      }
+      return reading;
+    }
+
+  } // namespace
+
+  class TopologyGraph::Impl {
+  public:
+    struct Node {
+      std::string name;
+      int flags = 0;
+      Reading reading;
+      std::vector<Edge> owned; // resolved from reading
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<unsigned int, Node> nodes;
+    std::unordered_map<std::string, unsigned int> indices;
+    std::unordered_map<std::string, unsigned int> owners; // address -> index
+    std::unordered_map<unsigned int, std::vector<Edge>> children;
+    uint64_t generation = 0;
+    bool running = false;
+    std::string lastError;
+    netlink::NetlinkManager netlink;
+
+    // Caller holds the mutex exclusively
+    void setNode(const InterfaceRecord &record, Reading reading) {
+      Node &node = nodes[record.index];
+      if (!node.name.empty() && node.name != record.name) {
+        // A rename keeps every edge; only readings naming it change
+        indices.erase(node.name);
+        for (auto &[index, other] : nodes) {
+          for (auto &[parent, kind] : other.reading.parents) {
+            if (parent == node.name) {
+              parent = record.name;
+            }
+          }
+        }
+      }
+      node.name = record.name;
+      node.flags = record.flags;
+      node.reading = std::move(reading);
+      indices[record.name] = record.index;
+
+      std::erase_if(owners, [&](const auto &entry) {
+        return entry.second == record.index;
+      });
+      for (const auto &address : record.addresses) {
+        owners[address.getIp()] = record.index;
+      }
+    }
+
+    // Caller holds the mutex exclusively
+    void dropNode(unsigned int index) {
+      auto it = nodes.find(index);
+      if (it == nodes.end()) {
+        return;
+      }
+      indices.erase(it->second.name);
+      std::erase_if(owners, [index](const auto &entry) {
+        return entry.second == index;
+      });
+      nodes.erase(it);
+    }
+
+    // Resolves every reading against the current names and addresses.
+    // Caller holds the mutex exclusively.
+    bool relink() {
+      bool changed = false;
+      children.clear();
+      for (auto &[index, node] : nodes) {
+        std::vector<Edge> edges;
+        for (const auto &[name, kind] : node.reading.parents) {
+          auto parent = indices.find(name);
+          if (parent != indices.end() && parent->second != index) {
+            edges.push_back({parent->second, index, kind, 0});
+          }
+        }
+        if (!node.reading.local.empty()) {
+          auto owner = owners.find(node.reading.local);
+          if (owner != owners.end() && owner->second != index) {
+            edges.push_back({owner->second, index, DependencyKind::TUNNEL, 0});
+          }
+        }
+        for (int vhid : node.reading.vhids) {
+          edges.push_back({index, 0, DependencyKind::CARP, vhid});
+        }
+        if (edges != node.owned) {
+          node.owned = std::move(edges);
+          changed = true;
+        }
+        for (const auto &edge : node.owned) {
+          children[edge.parent].push_back(edge);
+        }
+      }
+      return changed;
+    }
+
+    // Caller holds the mutex at least shared
+    TopologyEdge toEdge(const Edge &edge) const {
+      TopologyEdge result;
+      result.parent = nodes.at(edge.parent).name;
+      if (edge.child != 0) {
+        result.child = nodes.at(edge.child).name;
+      }
+      result.kind = edge.kind;
+      result.vhid = edge.vhid;
+      return result;
+    }
+
+    void onEvents(const netlink::NetlinkEventBatch &batch) {
+      // The last event for an index decides whether it is still present
+      std::unordered_map<unsigned int, bool> present;
+      bool aggregates = false;
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (const auto &event : batch.links) {
+          unsigned int index = static_cast<unsigned int>(event.info.index);
+          bool alive = event.type != netlink::NetlinkMessageType::DELLINK;
+          present[index] = alive;
+          auto it = nodes.find(index);
+          int flags = static_cast<int>(event.info.flags);
+          if (alive && (it == nodes.end() || it->second.flags != flags)) {
+            aggregates = true;
+          }
+        }
+        if (aggregates) {
+          for (const auto &[index, node] : nodes) {
+            if (node.reading.aggregate) {
+              present.try_emplace(index, true);
+            }
+          }
+        }
+        // CARP VHIDs ride on addresses, so an address change on a known
+        // node can add or remove its CARP edges
+        for (const auto &event : batch.addresses) {
+          unsigned int index = static_cast<unsigned int>(event.index);
+          if (nodes.contains(index)) {
+            present.try_emplace(index, true);
+          }
+        }
+      }
+
+      // Kernel reads happen without the lock
+      std::vector<std::shared_ptr<const InterfaceRecord>> records;
+      std::vector<Reading> readings;
+      std::vector<unsigned int> departed;
+      for (const auto &[index, alive] : present) {
+        InterfaceSnapshot snapshot;
+        std::shared_ptr<const InterfaceRecord> record;
+        if (alive && snapshot.refresh(index)) {
+          record = snapshot.find(index);
+        }
+        if (!record) {
+          departed.push_back(index);
+          continue;
+        }
+        readings.push_back(readRecord(*record));
+        records.push_back(std::move(record));
+      }
+
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      for (unsigned int index : departed) {
+        dropNode(index);
+      }
+      for (size_t i = 0; i < records.size(); ++i) {
+        setNode(*records[i], std::move(readings[i]));
+      }
+      for (const auto &event : batch.addresses) {
+        std::string address = event.address.toString();
+        unsigned int index = static_cast<unsigned int>(event.index);
+        if (event.type == netlink::NetlinkMessageType::DELADDR) {
+          auto it = owners.find(address);
+          if (it != owners.end() && it->second == index) {
+            owners.erase(it);
+          }
+        } else if (nodes.contains(index)) {
+          owners[address] = index;
+        }
+      }
+      if (relink() || !departed.empty()) {
+        ++generation;
+      }
+    }
+  };
+
+  TopologyGraph::TopologyGraph() : pImpl(std::make_unique<Impl>()) {}
+
+  TopologyGraph::~TopologyGraph() { stop(); }
+
+  bool TopologyGraph::build(unsigned workers) {
+    LIBFREEBSDNET_METRICS_OPERATION("TopologyGraph::build");
+    InterfaceSnapshot snapshot;
+    if (!snapshot.refresh()) {
+      std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+      pImpl->lastError = snapshot.getLastError();
+      return false;
+    }
+    const auto &records = snapshot.getRecords();
+    if (workers == 0) {
+      workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    }
+
+    // Each worker has its own control socket, so the ioctls run in parallel
+    std::vector<Reading> readings(records.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for (size_t i; (i = next.fetch_add(1)) < records.size();) {
+        readings[i] = readRecord(*records[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    size_t count = std::min<size_t>(workers, records.size());
+    for (size_t slot = 1; slot < count; ++slot) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->nodes.clear();
+    pImpl->indices.clear();
+    pImpl->owners.clear();
+    for (size_t i = 0; i < records.size(); ++i) {
+      pImpl->setNode(*records[i], std::move(readings[i]));
+    }
+    pImpl->relink();
+    ++pImpl->generation;
+    return true;
+  }
+
+  bool TopologyGraph::refresh(const std::string &name) {
+    unsigned int index = if_nametoindex(name.c_str());
+    InterfaceSnapshot snapshot;
+    std::shared_ptr<const InterfaceRecord> record;
+    if (index != 0 && snapshot.refresh(index)) {
+      record = snapshot.find(index);
+    }
+    if (!record) {
+      std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+      pImpl->lastError = "Interface not found: " + name;
+      return false;
+    }
+    Reading reading = readRecord(*record);
+
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->setNode(*record, std::move(reading));
+    if (pImpl->relink()) {
+      ++pImpl->generation;
+    }
+    return true;
+  }
+
+  bool TopologyGraph::start() {
+    bool empty;
+    {
+      std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+      if (pImpl->running) {
+        return true;
+      }
+      empty = pImpl->nodes.empty();
+    }
+    if (empty && !build()) {
+      return false;
+    }
+
+    netlink::NetlinkMonitorOptions options;
+    options.groups = netlink::GROUP_LINK | netlink::GROUP_IPV4_ADDRESS |
+                     netlink::GROUP_IPV6_ADDRESS;
+    Impl *impl = pImpl.get();
+    if (!pImpl->netlink.startMonitoring(
+            [impl](const netlink::NetlinkEventBatch &batch) {
+              impl->onEvents(batch);
+            },
+            options)) {
+      std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+      pImpl->lastError = pImpl->netlink.getLastError();
+      return false;
+    }
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->running = true;
+    return true;
+  }
+
+  bool TopologyGraph::stop() {
+    {
+      std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+      if (!pImpl->running) {
+        return true;
+      }
+    }
+    // Joins the monitor thread, so no event is applied afterwards
+    bool result = pImpl->netlink.stopMonitoring();
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->running = false;
+    return result;
+  }
+
+  std::vector<TopologyEdge> TopologyGraph::getEdges() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    std::vector<TopologyEdge> edges;
+    for (const auto &[index, node] : pImpl->nodes) {
+      for (const auto &edge : node.owned) {
+        edges.push_back(pImpl->toEdge(edge));
+      }
+    }
+    std::sort(edges.begin(), edges.end(),
+              [](const TopologyEdge &a, const TopologyEdge &b) {
+                return std::tie(a.parent, a.child, a.vhid) <
+                       std::tie(b.parent, b.child, b.vhid);
+              });
+    return edges;
+  }
+
+  std::vector<TopologyEdge>
+  TopologyGraph::getParents(const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    std::vector<TopologyEdge> edges;
+    auto index = pImpl->indices.find(name);
+    if (index == pImpl->indices.end()) {
+      return edges;
+    }
+    for (const auto &edge : pImpl->nodes.at(index->second).owned) {
+      if (edge.child == index->second) {
+        edges.push_back(pImpl->toEdge(edge));
+      }
+    }
+    return edges;
+  }
+
+  std::vector<TopologyEdge>
+  TopologyGraph::getChildren(const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    std::vector<TopologyEdge> edges;
+    auto index = pImpl->indices.find(name);
+    if (index == pImpl->indices.end()) {
+      return edges;
+    }
+    auto it = pImpl->children.find(index->second);
+    if (it != pImpl->children.end()) {
+      for (const auto &edge : it->second) {
+        edges.push_back(pImpl->toEdge(edge));
+      }
+    }
+    return edges;
+  }
+
+  std::vector<TopologyEdge>
+  TopologyGraph::getImpact(const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    std::vector<TopologyEdge> edges;
+    auto root = pImpl->indices.find(name);
+    if (root == pImpl->indices.end()) {
+      return edges;
+    }
+    // Every edge leaves exactly one parent, so visiting each parent once
+    // reports each edge once
+    std::unordered_set<unsigned int> seen{root->second};
+    std::deque<unsigned int> queue{root->second};
+    while (!queue.empty()) {
+      unsigned int parent = queue.front();
+      queue.pop_front();
+      auto it = pImpl->children.find(parent);
+      if (it == pImpl->children.end()) {
+        continue;
+      }
+      for (const auto &edge : it->second) {
+        edges.push_back(pImpl->toEdge(edge));
+        if (edge.child != 0 && seen.insert(edge.child).second) {
+          queue.push_back(edge.child);
+        }
+      }
+    }
+    return edges;
+  }
+
+  std::vector<std::string>
+  TopologyGraph::getDependents(const std::string &name) const {
+    std::vector<std::string> names;
+    std::unordered_set<std::string> seen;
+    for (auto &edge : getImpact(name)) {
+      if (!edge.child.empty() && seen.insert(edge.child).second) {
+        names.push_back(std::move(edge.child));
+      }
+    }
+    return names;
+  }
+
+  uint64_t TopologyGraph::getGeneration() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->generation;
+  }
+
+  std::string TopologyGraph::getLastError() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::interface
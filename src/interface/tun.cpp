@@ -26,7 +26,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class TunInterface::Impl {
+  class TunInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -44,15 +44,11 @@ namespace libfreebsdnet::interface {
 
   TunInterface::TunInterface(const std::string &name, unsigned int index,
                              int flags)
-      : TunnelInterface(name, index, flags),
+      : InterfaceBase(name, index, flags),
         pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   TunInterface::~TunInterface() = default;
 
-  InterfaceType TunInterface::getType() const {
-    return InterfaceType::TUNNEL; // TUN is a type of tunnel
-  }
-
   int TunInterface::getUnit() const { return pImpl->unit; }
 
   bool TunInterface::setUnit(int unit) {
@@ -104,78 +100,4 @@ namespace libfreebsdnet::interface {
         "TUN interfaces do not support tunnel FIB operations");
   }
 
-  // Group management methods (call base class)
-  std::vector<std::string> TunInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool TunInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool TunInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
-  // Base class method implementations (call base class)
-  int TunInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool TunInterface::setMedia(int media) { return Interface::setMedia(media); }
-
-  int TunInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int TunInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> TunInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t TunInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool TunInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t TunInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool TunInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool TunInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  bool TunInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool TunInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool TunInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> TunInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  std::string TunInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
-
-  bool TunInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
-  }
-
 } // namespace libfreebsdnet::interface
@@ -0,0 +1,402 @@
+/**
+ * @file interface/tunio.cpp
+ * @brief TUN/TAP packet I/O engine implementation
+ * @details readv/writev batches over per-queue buffer pools and kqueue
+ * worker loops
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <interface/affinity.hpp>
+#include <interface/tunio.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if_tun.h>
+#include <poll.h>
+#include <sys/event.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Queue {
+      std::string device;
+      int fd = -1;
+      bool header = false; // TUNSIFHEAD word precedes every packet
+      Clock::time_point opened;
+
+      // Receive side, owned by whichever thread reads the queue
+      std::vector<uint8_t> pool;
+      std::vector<uint32_t> families;
+      std::vector<Packet> packets;
+
+      std::atomic<uint64_t> rxPackets{0};
+      std::atomic<uint64_t> rxBytes{0};
+      std::atomic<uint64_t> txPackets{0};
+      std::atomic<uint64_t> txBytes{0};
+      std::atomic<uint64_t> rxErrors{0};
+      std::atomic<uint64_t> txErrors{0};
+      std::atomic<uint64_t> batches{0};
+      std::atomic<uint64_t> batchNanos{0};
+      std::atomic<uint64_t> maxBatchNanos{0};
+
+      ~Queue() {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+    };
+
+    void addMax(std::atomic<uint64_t> &target, uint64_t value) {
+      uint64_t current = target.load(std::memory_order_relaxed);
+      while (value > current &&
+             !target.compare_exchange_weak(current, value,
+                                           std::memory_order_relaxed)) {
+      }
+    }
+
+  } // namespace
+
+  class TunIo::Impl {
+  public:
+    TunIoOptions options;
+    std::vector<std::unique_ptr<Queue>> queues;
+    PacketHandler handler;
+    std::vector<int> kqueues;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{false};
+    std::string lastError;
+
+    explicit Impl(const TunIoOptions &opts) : options(opts) {
+      options.batchSize = std::max<size_t>(options.batchSize, 1);
+      options.bufferSize = std::max<size_t>(options.bufferSize, 64);
+    }
+
+    ~Impl() { stop(); }
+
+    bool open(const std::string &device) {
+      if (running) {
+        lastError = "Cannot add queues while running";
+        return false;
+      }
+      std::string path = device.starts_with("/") ? device : "/dev/" + device;
+      std::string name = path.substr(path.rfind('/') + 1);
+
+      auto queue = std::make_unique<Queue>();
+      queue->device = name;
+      queue->fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+      if (queue->fd < 0) {
+        lastError = "Failed to open " + path + ": " + strerror(errno);
+        return false;
+      }
+      if (name.starts_with("tun") && options.addressFamily) {
+        int on = 1;
+        if (metrics::tracedIoctl(queue->fd, TUNSIFHEAD, &on) < 0) {
+          lastError = "Failed to set TUNSIFHEAD on " + name + ": " +
+                      strerror(errno);
+          return false;
+        }
+        queue->header = true;
+      }
+
+      queue->pool.resize(options.batchSize * options.bufferSize);
+      queue->families.resize(options.batchSize);
+      queue->packets.resize(options.batchSize);
+      queue->opened = Clock::now();
+      queues.push_back(std::move(queue));
+      return true;
+    }
+
+    // Drain up to batchSize packets into the pool, then hand them over
+    size_t process(size_t index, const PacketHandler &callback) {
+      Queue &queue = *queues[index];
+      auto started = Clock::now();
+      size_t count = 0;
+      uint64_t bytes = 0;
+      while (count < options.batchSize) {
+        uint8_t *slot = queue.pool.data() + count * options.bufferSize;
+        struct iovec iov[2] = {
+            {&queue.families[count], sizeof(uint32_t)},
+            {slot, options.bufferSize},
+        };
+        ssize_t n = queue.header ? readv(queue.fd, iov, 2)
+                                 : readv(queue.fd, iov + 1, 1);
+        if (n < 0) {
+          if (errno != EAGAIN && errno != EINTR) {
+            queue.rxErrors.fetch_add(1, std::memory_order_relaxed);
+          }
+          break;
+        }
+        size_t length = static_cast<size_t>(n);
+        int family = 0;
+        if (queue.header) {
+          if (length < sizeof(uint32_t)) {
+            queue.rxErrors.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          length -= sizeof(uint32_t);
+          family = static_cast<int>(ntohl(queue.families[count]));
+        }
+        queue.packets[count] = {{slot, length}, family};
+        bytes += length;
+        ++count;
+      }
+      if (count == 0) {
+        return 0;
+      }
+
+      if (callback) {
+        callback(index, std::span<const Packet>(queue.packets.data(), count));
+      }
+      auto nanos = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                               started)
+              .count());
+      queue.rxPackets.fetch_add(count, std::memory_order_relaxed);
+      queue.rxBytes.fetch_add(bytes, std::memory_order_relaxed);
+      queue.batches.fetch_add(1, std::memory_order_relaxed);
+      queue.batchNanos.fetch_add(nanos, std::memory_order_relaxed);
+      addMax(queue.maxBatchNanos, nanos);
+      return count;
+    }
+
+    bool start(PacketHandler callback, unsigned int workers) {
+      if (running) {
+        return true;
+      }
+      if (queues.empty()) {
+        lastError = "No queues opened";
+        return false;
+      }
+      if (workers == 0) {
+        workers = std::max(std::thread::hardware_concurrency(), 1u);
+      }
+      workers = static_cast<unsigned int>(
+          std::min<size_t>(workers, queues.size()));
+
+      // Queue q goes to worker q % workers; EVFILT_USER wakes it to stop
+      for (unsigned int w = 0; w < workers; ++w) {
+        int kq = kqueue();
+        if (kq < 0) {
+          lastError =
+              "Failed to create kqueue: " + std::string(strerror(errno));
+          closeKqueues();
+          return false;
+        }
+        kqueues.push_back(kq);
+
+        std::vector<struct kevent> changes;
+        struct kevent change;
+        EV_SET(&change, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+        changes.push_back(change);
+        for (size_t q = w; q < queues.size(); q += workers) {
+          EV_SET(&change, queues[q]->fd, EVFILT_READ, EV_ADD, 0, 0,
+                 reinterpret_cast<void *>(q));
+          changes.push_back(change);
+        }
+        if (kevent(kq, changes.data(), static_cast<int>(changes.size()),
+                   nullptr, 0, nullptr) < 0) {
+          lastError = "Failed to register queues: " +
+                      std::string(strerror(errno));
+          closeKqueues();
+          return false;
+        }
+      }
+
+      std::vector<int> cpus;
+      if (!options.affinity.empty()) {
+        cpus = QueueAffinity::plan(options.affinity, workers).getCpus();
+      }
+
+      handler = std::move(callback);
+      running = true;
+      for (size_t w = 0; w < kqueues.size(); ++w) {
+        int kq = kqueues[w];
+        threads.emplace_back([this, kq] { run(kq); });
+        // Best effort: an unpinned worker still runs
+        if (w < cpus.size() && cpus[w] >= 0) {
+          QueueAffinity::pin(threads.back().native_handle(),
+                             std::span<const int>(&cpus[w], 1));
+        }
+      }
+      return true;
+    }
+
+    void stop() {
+      if (!running.exchange(false)) {
+        return;
+      }
+      for (int kq : kqueues) {
+        struct kevent wake;
+        EV_SET(&wake, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+        kevent(kq, &wake, 1, nullptr, 0, nullptr);
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      threads.clear();
+      closeKqueues();
+    }
+
+    size_t send(size_t index, std::span<const std::span<const uint8_t>> data,
+                int family) {
+      if (index >= queues.size()) {
+        return 0;
+      }
+      Queue &queue = *queues[index];
+      uint32_t word = htonl(static_cast<uint32_t>(family));
+      size_t sent = 0;
+      uint64_t bytes = 0;
+      for (const auto &packet : data) {
+        struct iovec iov[2] = {
+            {&word, sizeof(word)},
+            {const_cast<uint8_t *>(packet.data()), packet.size()},
+        };
+        ssize_t n = queue.header ? writev(queue.fd, iov, 2)
+                                 : writev(queue.fd, iov + 1, 1);
+        if (n < 0) {
+          queue.txErrors.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        bytes += packet.size();
+        ++sent;
+      }
+      queue.txPackets.fetch_add(sent, std::memory_order_relaxed);
+      queue.txBytes.fetch_add(bytes, std::memory_order_relaxed);
+      return sent;
+    }
+
+    TunIoStats stats(const Queue &queue) const {
+      TunIoStats result;
+      result.rxPackets = queue.rxPackets.load(std::memory_order_relaxed);
+      result.rxBytes = queue.rxBytes.load(std::memory_order_relaxed);
+      result.txPackets = queue.txPackets.load(std::memory_order_relaxed);
+      result.txBytes = queue.txBytes.load(std::memory_order_relaxed);
+      result.rxErrors = queue.rxErrors.load(std::memory_order_relaxed);
+      result.txErrors = queue.txErrors.load(std::memory_order_relaxed);
+      result.batches = queue.batches.load(std::memory_order_relaxed);
+      result.batchTime = std::chrono::nanoseconds(
+          queue.batchNanos.load(std::memory_order_relaxed));
+      result.maxBatchTime = std::chrono::nanoseconds(
+          queue.maxBatchNanos.load(std::memory_order_relaxed));
+      result.elapsed = Clock::now() - queue.opened;
+      return result;
+    }
+
+  private:
+    void run(int kq) {
+      std::vector<struct kevent> events(queues.size() + 1);
+      while (running) {
+        int n = kevent(kq, nullptr, 0, events.data(),
+                       static_cast<int>(events.size()), nullptr);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          break;
+        }
+        for (int i = 0; i < n; ++i) {
+          if (events[i].filter == EVFILT_USER) {
+            return;
+          }
+          process(reinterpret_cast<size_t>(events[i].udata), handler);
+        }
+      }
+    }
+
+    void closeKqueues() {
+      for (int kq : kqueues) {
+        close(kq);
+      }
+      kqueues.clear();
+    }
+  };
+
+  TunIo::TunIo(const TunIoOptions &options)
+      : pImpl(std::make_unique<Impl>(options)) {}
+
+  TunIo::~TunIo() = default;
+
+  bool TunIo::open(const std::string &device) { return pImpl->open(device); }
+
+  size_t TunIo::getQueueCount() const { return pImpl->queues.size(); }
+
+  std::string TunIo::getDevice(size_t queue) const {
+    return queue < pImpl->queues.size() ? pImpl->queues[queue]->device : "";
+  }
+
+  bool TunIo::start(PacketHandler handler, unsigned int workers) {
+    return pImpl->start(std::move(handler), workers);
+  }
+
+  void TunIo::stop() { pImpl->stop(); }
+
+  bool TunIo::isRunning() const { return pImpl->running; }
+
+  size_t TunIo::receive(size_t queue, const PacketHandler &handler,
+                        std::chrono::milliseconds timeout) {
+    if (pImpl->running) {
+      pImpl->lastError = "Queues are owned by the workers while running";
+      return 0;
+    }
+    if (queue >= pImpl->queues.size()) {
+      pImpl->lastError = "No such queue";
+      return 0;
+    }
+    struct pollfd pfd = {pImpl->queues[queue]->fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (ready < 0) {
+      pImpl->lastError = "poll failed: " + std::string(strerror(errno));
+      return 0;
+    }
+    return ready > 0 ? pImpl->process(queue, handler) : 0;
+  }
+
+  size_t TunIo::send(size_t queue,
+                     std::span<const std::span<const uint8_t>> packets,
+                     int family) {
+    return pImpl->send(queue, packets, family);
+  }
+
+  TunIoStats TunIo::getStats(size_t queue) const {
+    if (queue >= pImpl->queues.size()) {
+      return {};
+    }
+    return pImpl->stats(*pImpl->queues[queue]);
+  }
+
+  TunIoStats TunIo::getStats() const {
+    TunIoStats total;
+    for (const auto &queue : pImpl->queues) {
+      TunIoStats stats = pImpl->stats(*queue);
+      total.rxPackets += stats.rxPackets;
+      total.rxBytes += stats.rxBytes;
+      total.txPackets += stats.txPackets;
+      total.txBytes += stats.txBytes;
+      total.rxErrors += stats.rxErrors;
+      total.txErrors += stats.txErrors;
+      total.batches += stats.batches;
+      total.batchTime += stats.batchTime;
+      total.maxBatchTime = std::max(total.maxBatchTime, stats.maxBatchTime);
+      total.elapsed = std::max(total.elapsed, stats.elapsed);
+    }
+    return total;
+  }
+
+  std::string TunIo::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
@@ -11,7 +11,9 @@
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
+#include <interface/socket.hpp>
 #include <interface/tunnel.hpp>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <net/if_gif.h>
 #include <net/if_mib.h>
@@ -29,73 +31,10 @@ namespace libfreebsdnet::interface {
 
   TunnelInterface::TunnelInterface(const std::string &name, unsigned int index,
                                    int flags)
-      : Interface(name, index, flags) {}
+      : InterfaceBase(name, index, flags) {}
 
   TunnelInterface::~TunnelInterface() = default;
 
-  // Base class method implementations (call base class)
-  int TunnelInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool TunnelInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int TunnelInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int TunnelInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> TunnelInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t TunnelInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool TunnelInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t TunnelInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool TunnelInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool TunnelInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  bool TunnelInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool TunnelInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool TunnelInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> TunnelInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  std::string TunnelInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
-
-  bool TunnelInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
-  }
-
   std::string TunnelInterface::getLocalEndpoint() const {
     // Default implementation - subclasses should override
     return "";
@@ -137,9 +76,9 @@ namespace libfreebsdnet::interface {
   int TunnelInterface::getTunnelFib() const {
     // Get tunnel FIB assignment using SIOCGTUNFIB
     // Try AF_INET first, fall back to AF_LOCAL if that fails
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0 && errno == EAFNOSUPPORT) {
-      sock = socket(AF_LOCAL, SOCK_DGRAM, 0);
+      sock = ControlSocket::get(AF_LOCAL);
     }
     if (sock < 0) {
       return -1;
@@ -150,20 +89,19 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
     int fib = -1;
-    if (ioctl(sock, SIOCGTUNFIB, &ifr) == 0) {
+    if (metrics::tracedIoctl(sock, SIOCGTUNFIB, &ifr) == 0) {
       fib = ifr.ifr_fib;
     }
 
-    close(sock);
     return fib;
   }
 
   bool TunnelInterface::setTunnelFib(int fib) {
     // Set tunnel FIB assignment using SIOCSTUNFIB
     // Try AF_INET first, fall back to AF_LOCAL if that fails
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0 && errno == EAFNOSUPPORT) {
-      sock = socket(AF_LOCAL, SOCK_DGRAM, 0);
+      sock = ControlSocket::get(AF_LOCAL);
     }
     if (sock < 0) {
       // Use base class error handling
@@ -175,18 +113,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
     ifr.ifr_fib = fib;
 
-    if (ioctl(sock, SIOCSTUNFIB, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSTUNFIB, &ifr) < 0) {
       // Use base class error handling
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool TunnelInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       // Use base class error handling
       return false;
@@ -196,13 +132,11 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, getName().c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       // Use base class error handling
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -0,0 +1,314 @@
+/**
+ * @file interface/tunnelbatch.cpp
+ * @brief Batched tunnel provisioning implementation
+ * @details Parallel create-and-configure of gif, gre and vxlan tunnels over
+ * per-worker control sockets
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <interface/socket.hpp>
+#include <interface/tunnelbatch.hpp>
+#include <metrics/probes.hpp>
+#include <net/if.h>
+#include <net/if_gre.h>
+#include <net/if_vxlan.h>
+#include <netinet/in.h>
+#include <netinet/in_var.h>
+#include <netinet6/in6_var.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <thread>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using libfreebsdnet::types::Address;
+
+    void setName(struct ifreq &ifr, const std::string &name) {
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    }
+
+    const char *clonerName(TunnelType type) {
+      switch (type) {
+      case TunnelType::GIF:
+        return "gif";
+      case TunnelType::GRE:
+        return "gre";
+      case TunnelType::VXLAN:
+        return "vxlan";
+      default:
+        return nullptr;
+      }
+    }
+
+    int validate(const TunnelSpec &spec) {
+      if (!clonerName(spec.type) || spec.name.size() >= IFNAMSIZ) {
+        return EINVAL;
+      }
+      if (spec.type == TunnelType::VXLAN) {
+        // A VXLAN tunnel needs a VNI and at least a remote or group
+        if (spec.key > VXLAN_VNI_MAX || !spec.remote.isValid()) {
+          return EINVAL;
+        }
+        return 0;
+      }
+      if (!spec.local.isValid() || !spec.remote.isValid() ||
+          spec.local.getFamily() != spec.remote.getFamily()) {
+        return EINVAL;
+      }
+      return 0;
+    }
+
+    void fillVxlanAddress(union vxlan_sockaddr &sa, const Address &address) {
+      if (address.isIPv4()) {
+        sa.in4 = address.getSockaddrIn();
+      } else {
+        sa.in6 = address.getSockaddrIn6();
+      }
+    }
+
+    int createOne(int sock, const TunnelSpec &spec, std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, spec.name.empty() ? clonerName(spec.type) : spec.name);
+
+      struct ifvxlanparam vxlp;
+      if (spec.type == TunnelType::VXLAN) {
+        std::memset(&vxlp, 0, sizeof(vxlp));
+        vxlp.vxlp_with = VXLAN_PARAM_WITH_VNI;
+        vxlp.vxlp_vni = spec.key;
+        if (spec.local.isValid()) {
+          vxlp.vxlp_with |= spec.local.isIPv4() ? VXLAN_PARAM_WITH_LOCAL_ADDR4
+                                                : VXLAN_PARAM_WITH_LOCAL_ADDR6;
+          fillVxlanAddress(vxlp.vxlp_local_sa, spec.local);
+        }
+        vxlp.vxlp_with |= spec.remote.isIPv4() ? VXLAN_PARAM_WITH_REMOTE_ADDR4
+                                               : VXLAN_PARAM_WITH_REMOTE_ADDR6;
+        fillVxlanAddress(vxlp.vxlp_remote_sa, spec.remote);
+        ifr.ifr_data = reinterpret_cast<caddr_t>(&vxlp);
+      }
+      if (metrics::tracedIoctl(sock,
+                               spec.type == TunnelType::VXLAN ? SIOCIFCREATE2
+                                                              : SIOCIFCREATE,
+                               &ifr) < 0) {
+        return errno;
+      }
+      name.assign(ifr.ifr_name, strnlen(ifr.ifr_name, IFNAMSIZ));
+      return 0;
+    }
+
+    int setEndpoints(int sock, const TunnelSpec &spec,
+                     const std::string &name) {
+      if (spec.local.isIPv4()) {
+        struct in_aliasreq req;
+        std::memset(&req, 0, sizeof(req));
+        std::strncpy(req.ifra_name, name.c_str(), IFNAMSIZ - 1);
+        req.ifra_addr = spec.local.getSockaddrIn();
+        req.ifra_broadaddr = spec.remote.getSockaddrIn(); // ifra_dstaddr
+        return metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &req) < 0 ? errno : 0;
+      }
+      struct in6_aliasreq req;
+      std::memset(&req, 0, sizeof(req));
+      std::strncpy(req.ifra_name, name.c_str(), IFNAMSIZ - 1);
+      req.ifra_addr = spec.local.getSockaddrIn6();
+      req.ifra_dstaddr = spec.remote.getSockaddrIn6();
+      int sock6 = ControlSocket::get(AF_INET6);
+      return metrics::tracedIoctl(sock6 >= 0 ? sock6 : sock,
+                                  SIOCSIFPHYADDR_IN6, &req) < 0
+                 ? errno
+                 : 0;
+    }
+
+    int setGreKey(int sock, const std::string &name, uint32_t key) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_data = reinterpret_cast<caddr_t>(&key);
+      return metrics::tracedIoctl(sock, GRESKEY, &ifr) < 0 ? errno : 0;
+    }
+
+    int setTunnelFib(int sock, const std::string &name, int fib) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_fib = fib;
+      return metrics::tracedIoctl(sock, SIOCSTUNFIB, &ifr) < 0 ? errno : 0;
+    }
+
+    int setMtu(int sock, const std::string &name, int mtu) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_mtu = mtu;
+      return metrics::tracedIoctl(sock, SIOCSIFMTU, &ifr) < 0 ? errno : 0;
+    }
+
+    int bringUp(int sock, const std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
+        return errno;
+      }
+      ifr.ifr_flags |= IFF_UP;
+      return metrics::tracedIoctl(sock, SIOCSIFFLAGS, &ifr) < 0 ? errno : 0;
+    }
+
+    int destroyOne(int sock, const std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      return metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0 ? errno : 0;
+    }
+
+    // The whole pipeline for one tunnel; stops at the first failing step
+    int provision(int sock, const TunnelSpec &spec, std::string &name) {
+      int error = validate(spec);
+      if (error == 0) {
+        error = createOne(sock, spec, name);
+      }
+      if (error == 0 && spec.type != TunnelType::VXLAN) {
+        error = setEndpoints(sock, spec, name);
+      }
+      if (error == 0 && spec.type == TunnelType::GRE && spec.key != 0) {
+        error = setGreKey(sock, name, spec.key);
+      }
+      if (error == 0 && spec.fib >= 0) {
+        error = setTunnelFib(sock, name, spec.fib);
+      }
+      if (error == 0 && spec.mtu > 0) {
+        error = setMtu(sock, name, spec.mtu);
+      }
+      if (error == 0 && spec.up) {
+        error = bringUp(sock, name);
+      }
+      return error;
+    }
+
+    // Run job(socket, i) for i in [0, count) on up to `workers` threads,
+    // each with its own cached control socket
+    template <typename Job>
+    void parallel(size_t count, unsigned int workers, Job job) {
+      if (workers == 0) {
+        workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+      }
+      std::atomic<size_t> next{0};
+      auto worker = [&]() {
+        int sock = ControlSocket::get(AF_INET);
+        for (size_t i; (i = next.fetch_add(1)) < count;) {
+          job(sock, i);
+        }
+      };
+
+      std::vector<std::thread> threads;
+      size_t threadCount = std::min<size_t>(workers, count);
+      for (size_t slot = 1; slot < threadCount; ++slot) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+    }
+
+  } // namespace
+
+  class TunnelBatch::Impl {
+  public:
+    TunnelBatchTimings timings;
+    std::string lastError;
+  };
+
+  TunnelBatch::TunnelBatch() : pImpl(std::make_unique<Impl>()) {}
+
+  TunnelBatch::~TunnelBatch() = default;
+
+  std::vector<TunnelResult>
+  TunnelBatch::create(std::span<const TunnelSpec> tunnels, bool rollback,
+                      unsigned int workers) {
+    pImpl->timings = TunnelBatchTimings{};
+    pImpl->lastError.clear();
+    std::vector<TunnelResult> results(tunnels.size());
+
+    std::atomic<bool> failed{false};
+    auto start = Clock::now();
+    parallel(tunnels.size(), workers, [&](int sock, size_t i) {
+      TunnelResult &result = results[i];
+      if (sock < 0) {
+        result.error = EBADF;
+      } else if (rollback && failed.load(std::memory_order_relaxed)) {
+        result.error = ECANCELED; // no point starting, it will be undone
+        return;
+      } else {
+        result.error = provision(sock, tunnels[i], result.name);
+      }
+      if (result.error != 0) {
+        failed = true;
+      }
+    });
+    pImpl->timings.create = Clock::now() - start;
+
+    if (!failed) {
+      return results;
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (results[i].error != 0 && results[i].error != ECANCELED) {
+        pImpl->lastError = "Failed to create tunnel " +
+                           (tunnels[i].name.empty() ? results[i].name
+                                                    : tunnels[i].name) +
+                           ": " + std::string(strerror(results[i].error));
+        break;
+      }
+    }
+    if (rollback) {
+      start = Clock::now();
+      parallel(results.size(), workers, [&](int sock, size_t i) {
+        TunnelResult &result = results[i];
+        if (!result.name.empty() && sock >= 0) {
+          destroyOne(sock, result.name);
+        }
+        result.name.clear();
+        if (result.error == 0) {
+          result.error = ECANCELED;
+        }
+      });
+      pImpl->timings.rollback = Clock::now() - start;
+    }
+    return results;
+  }
+
+  std::vector<TunnelResult>
+  TunnelBatch::destroy(std::span<const std::string> names,
+                       unsigned int workers) {
+    pImpl->timings = TunnelBatchTimings{};
+    pImpl->lastError.clear();
+    std::vector<TunnelResult> results(names.size());
+
+    auto start = Clock::now();
+    parallel(names.size(), workers, [&](int sock, size_t i) {
+      results[i].name = names[i];
+      results[i].error = sock < 0 ? EBADF : destroyOne(sock, names[i]);
+    });
+    pImpl->timings.destroy = Clock::now() - start;
+
+    for (const auto &result : results) {
+      if (!result.succeeded()) {
+        pImpl->lastError = "Failed to destroy " + result.name + ": " +
+                           std::string(strerror(result.error));
+        break;
+      }
+    }
+    return results;
+  }
+
+  const TunnelBatchTimings &TunnelBatch::getTimings() const {
+    return pImpl->timings;
+  }
+
+  std::string TunnelBatch::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
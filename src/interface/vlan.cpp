@@ -12,8 +12,10 @@
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
+#include <interface/socket.hpp>
 #include <interface/vlan.hpp>
-#include <jail.h>
+#include <interface/vnetmanager.hpp>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -28,7 +30,7 @@
 
 namespace libfreebsdnet::interface {
 
-  class VlanInterface::Impl {
+  class VlanInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -41,38 +43,13 @@ namespace libfreebsdnet::interface {
 
   VlanInterface::VlanInterface(const std::string &name, unsigned int index,
                                int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   VlanInterface::~VlanInterface() = default;
 
-  std::string VlanInterface::getName() const { return Interface::getName(); }
-
-  unsigned int VlanInterface::getIndex() const { return Interface::getIndex(); }
-
-  InterfaceType VlanInterface::getType() const { return InterfaceType::VLAN; }
-
-  std::vector<Flag> VlanInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-
-  bool VlanInterface::setFlags(int flags) { return Interface::setFlags(flags); }
-
-  bool VlanInterface::bringUp() { return Interface::bringUp(); }
-
-  bool VlanInterface::bringDown() { return Interface::bringDown(); }
-
-  bool VlanInterface::isUp() const { return Interface::isUp(); }
-
-  int VlanInterface::getMtu() const { return Interface::getMtu(); }
-
-  bool VlanInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-
-  std::string VlanInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-
   int VlanInterface::getVlanId() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -85,12 +62,10 @@ namespace libfreebsdnet::interface {
     std::memset(&vlr, 0, sizeof(vlr));
     ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
 
-    if (ioctl(sock, SIOCGETVLAN, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGETVLAN, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return vlr.vlr_tag;
   }
 
@@ -100,7 +75,7 @@ namespace libfreebsdnet::interface {
       return false;
     }
 
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -115,19 +90,17 @@ namespace libfreebsdnet::interface {
     vlr.vlr_tag = vlanId;
     ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
 
-    if (ioctl(sock, SIOCSETVLAN, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSETVLAN, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set VLAN ID: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::string VlanInterface::getParentInterface() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "";
     }
@@ -140,17 +113,15 @@ namespace libfreebsdnet::interface {
     std::memset(&vlr, 0, sizeof(vlr));
     ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
 
-    if (ioctl(sock, SIOCGETVLAN, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGETVLAN, &ifr) < 0) {
       return "";
     }
 
-    close(sock);
     return std::string(vlr.vlr_parent);
   }
 
   bool VlanInterface::setParentInterface(const std::string &parentInterface) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -165,14 +136,12 @@ namespace libfreebsdnet::interface {
     std::strncpy(vlr.vlr_parent, parentInterface.c_str(), IFNAMSIZ - 1);
     ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
 
-    if (ioctl(sock, SIOCSETVLAN, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSETVLAN, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set parent interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -180,60 +149,8 @@ namespace libfreebsdnet::interface {
     return getVlanId() > 0 && !getParentInterface().empty();
   }
 
-  int VlanInterface::getFib() const { return Interface::getFib(); }
-
-  bool VlanInterface::setFib(int fib) { return Interface::setFib(fib); }
-
-  int VlanInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool VlanInterface::setMedia(int media) { return Interface::setMedia(media); }
-
-  int VlanInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int VlanInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> VlanInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t VlanInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool VlanInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t VlanInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool VlanInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool VlanInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
-
-  std::vector<std::string> VlanInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool VlanInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool VlanInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
   int VlanInterface::getVnet() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -242,33 +159,19 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifr.ifr_jid;
   }
 
   std::string VlanInterface::getVnetJailName() const {
-    int vnetId = getVnet();
-    if (vnetId < 0) {
-      return "";
-    }
-
-    char *jailName = jail_getname(vnetId);
-    if (jailName != nullptr) {
-      std::string result(jailName);
-      free(jailName);
-      return result;
-    }
-
-    return "";
+    return VnetManager::getJailName(getVnet());
   }
 
   bool VlanInterface::setVnet(int vnetId) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -279,18 +182,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_jid = vnetId;
 
-    if (ioctl(sock, SIOCSIFVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0) {
       pImpl->lastError = "Failed to set VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool VlanInterface::reclaimFromVnet() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -300,19 +201,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSIFRVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFRVNET, &ifr) < 0) {
       pImpl->lastError =
           "Failed to reclaim from VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool VlanInterface::setPhysicalAddress(const std::string &address) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -328,23 +227,20 @@ namespace libfreebsdnet::interface {
     sin->sin_family = AF_INET;
     if (inet_pton(AF_INET, address.c_str(), &sin->sin_addr) != 1) {
       pImpl->lastError = "Invalid IP address format";
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFPHYADDR, &ifra) < 0) {
       pImpl->lastError =
           "Failed to set physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool VlanInterface::deletePhysicalAddress() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -354,19 +250,17 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCDIFPHYADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to delete physical address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool VlanInterface::createClone(const std::string &cloneName) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -376,54 +270,15 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, cloneName.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
       pImpl->lastError =
           "Failed to create clone: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  std::vector<std::string> VlanInterface::getCloners() const {
-    std::vector<std::string> cloners;
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-      return cloners;
-    }
-
-    struct if_clonereq ifcr;
-    std::memset(&ifcr, 0, sizeof(ifcr));
-
-    // First get the total number of cloners
-    if (ioctl(sock, SIOCIFGCLONERS, &ifcr) < 0) {
-      close(sock);
-      return cloners;
-    }
-
-    if (ifcr.ifcr_total > 0) {
-      // Allocate buffer for cloner names
-      std::vector<char> buffer(ifcr.ifcr_total * IFNAMSIZ);
-      ifcr.ifcr_buffer = buffer.data();
-      ifcr.ifcr_count = ifcr.ifcr_total;
-
-      // Get the cloner names
-      if (ioctl(sock, SIOCIFGCLONERS, &ifcr) == 0) {
-        for (int i = 0; i < ifcr.ifcr_count; i++) {
-          std::string cloner(buffer.data() + (i * IFNAMSIZ));
-          if (!cloner.empty()) {
-            cloners.push_back(cloner);
-          }
-        }
-      }
-    }
-
-    close(sock);
-    return cloners;
-  }
-
   std::string VlanInterface::getMacAddress() const {
     struct ifaddrs *ifaddrs, *ifa;
     std::string macAddress = "";
@@ -456,7 +311,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool VlanInterface::setMacAddress(const std::string &macAddress) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -472,7 +327,6 @@ namespace libfreebsdnet::interface {
                     "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &mac[0],
                     &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
       pImpl->lastError = "Invalid MAC address format";
-      close(sock);
       return false;
     }
 
@@ -481,19 +335,17 @@ namespace libfreebsdnet::interface {
     ifr.ifr_addr.sa_family = AF_LINK;
     ifr.ifr_addr.sa_len = 6;
 
-    if (ioctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFLLADDR, &ifr) < 0) {
       pImpl->lastError =
           "Failed to set MAC address: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool VlanInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -504,14 +356,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
@@ -0,0 +1,231 @@
+/**
+ * @file interface/vlanbatch.cpp
+ * @brief Batched VLAN creation implementation
+ * @details Phased SIOCIFCREATE2, SIOCSIFMTU, SIOCSIFFIB and SIOCSIFFLAGS
+ * sweeps over the shared control socket
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <interface/socket.hpp>
+#include <interface/vlanbatch.hpp>
+#include <metrics/probes.hpp>
+#include <net/if.h>
+#include <net/if_vlan_var.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    void setName(struct ifreq &ifr, const std::string &name) {
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    }
+
+    int validate(const VlanSpec &spec) {
+      if (spec.tag < 1 || spec.tag > 4094 || spec.parent.empty() ||
+          spec.parent.size() >= IFNAMSIZ || spec.name.size() >= IFNAMSIZ) {
+        return EINVAL;
+      }
+      return 0;
+    }
+
+    int createOne(int sock, const VlanSpec &spec, std::string &name) {
+      struct vlanreq vlr;
+      std::memset(&vlr, 0, sizeof(vlr));
+      std::strncpy(vlr.vlr_parent, spec.parent.c_str(), IFNAMSIZ - 1);
+      vlr.vlr_tag = spec.tag;
+      vlr.vlr_proto = spec.proto;
+
+      struct ifreq ifr;
+      setName(ifr, spec.name.empty() ? "vlan" : spec.name);
+      ifr.ifr_data = reinterpret_cast<caddr_t>(&vlr);
+      if (metrics::tracedIoctl(sock, SIOCIFCREATE2, &ifr) < 0) {
+        return errno;
+      }
+      // The kernel writes back the unit it picked
+      name.assign(ifr.ifr_name, strnlen(ifr.ifr_name, IFNAMSIZ));
+      return 0;
+    }
+
+    int setMtu(int sock, const std::string &name, int mtu) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_mtu = mtu;
+      return metrics::tracedIoctl(sock, SIOCSIFMTU, &ifr) < 0 ? errno : 0;
+    }
+
+    int setFib(int sock, const std::string &name, int fib) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      ifr.ifr_fib = fib;
+      return metrics::tracedIoctl(sock, SIOCSIFFIB, &ifr) < 0 ? errno : 0;
+    }
+
+    int bringUp(int sock, const std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
+        return errno;
+      }
+      ifr.ifr_flags |= IFF_UP;
+      return metrics::tracedIoctl(sock, SIOCSIFFLAGS, &ifr) < 0 ? errno : 0;
+    }
+
+    int destroyOne(int sock, const std::string &name) {
+      struct ifreq ifr;
+      setName(ifr, name);
+      return metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0 ? errno : 0;
+    }
+
+  } // namespace
+
+  class VlanBatch::Impl {
+  public:
+    VlanBatchTimings timings;
+    std::string lastError;
+
+    // Run one configuration phase over the VLANs created so far
+    template <typename Step>
+    bool sweep(std::span<const VlanSpec> vlans,
+               std::vector<VlanResult> &results, std::chrono::nanoseconds &t,
+               Step step) {
+      auto start = Clock::now();
+      bool ok = true;
+      for (size_t i = 0; i < vlans.size(); ++i) {
+        VlanResult &result = results[i];
+        if (result.error == 0 && !result.name.empty()) {
+          result.error = step(vlans[i], result.name);
+          ok = ok && result.error == 0;
+        }
+      }
+      t = Clock::now() - start;
+      return ok;
+    }
+  };
+
+  VlanBatch::VlanBatch() : pImpl(std::make_unique<Impl>()) {}
+
+  VlanBatch::~VlanBatch() = default;
+
+  std::vector<VlanResult> VlanBatch::create(std::span<const VlanSpec> vlans,
+                                            bool rollback) {
+    pImpl->timings = VlanBatchTimings{};
+    pImpl->lastError.clear();
+    std::vector<VlanResult> results(vlans.size());
+
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      for (auto &result : results) {
+        result.error = errno ? errno : EBADF;
+      }
+      return results;
+    }
+
+    bool ok = true;
+    auto start = Clock::now();
+    for (size_t i = 0; i < vlans.size(); ++i) {
+      int error = validate(vlans[i]);
+      if (error == 0) {
+        error = createOne(sock, vlans[i], results[i].name);
+      }
+      results[i].error = error;
+      if (error != 0) {
+        ok = false;
+        if (rollback) {
+          break;
+        }
+      }
+    }
+    pImpl->timings.create = Clock::now() - start;
+
+    auto mtu = [sock](const VlanSpec &spec, const std::string &name) {
+      return spec.mtu > 0 ? setMtu(sock, name, spec.mtu) : 0;
+    };
+    auto fib = [sock](const VlanSpec &spec, const std::string &name) {
+      return spec.fib >= 0 ? setFib(sock, name, spec.fib) : 0;
+    };
+    auto up = [sock](const VlanSpec &spec, const std::string &name) {
+      return spec.up ? bringUp(sock, name) : 0;
+    };
+
+    // Without rollback every phase runs for whatever was created
+    if (ok || !rollback) {
+      ok = pImpl->sweep(vlans, results, pImpl->timings.mtu, mtu) && ok;
+    }
+    if (ok || !rollback) {
+      ok = pImpl->sweep(vlans, results, pImpl->timings.fib, fib) && ok;
+    }
+    if (ok || !rollback) {
+      ok = pImpl->sweep(vlans, results, pImpl->timings.up, up) && ok;
+    }
+
+    for (size_t i = 0; i < results.size() && !ok; ++i) {
+      if (results[i].error != 0) {
+        pImpl->lastError = "Failed to create VLAN " +
+                           std::to_string(vlans[i].tag) + " on " +
+                           vlans[i].parent + ": " +
+                           std::string(strerror(results[i].error));
+        break;
+      }
+    }
+    if (!ok && rollback) {
+      start = Clock::now();
+      for (auto &result : results) {
+        if (!result.name.empty()) {
+          destroyOne(sock, result.name);
+          result.name.clear();
+        }
+        if (result.error == 0) {
+          result.error = ECANCELED;
+        }
+      }
+      pImpl->timings.rollback = Clock::now() - start;
+    }
+    return results;
+  }
+
+  std::vector<VlanResult>
+  VlanBatch::destroy(std::span<const std::string> names) {
+    pImpl->timings = VlanBatchTimings{};
+    pImpl->lastError.clear();
+    std::vector<VlanResult> results(names.size());
+
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      for (auto &result : results) {
+        result.error = errno ? errno : EBADF;
+      }
+      return results;
+    }
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < names.size(); ++i) {
+      results[i].name = names[i];
+      results[i].error = destroyOne(sock, names[i]);
+      if (results[i].error != 0) {
+        pImpl->lastError = "Failed to destroy " + names[i] + ": " +
+                           std::string(strerror(results[i].error));
+      }
+    }
+    pImpl->timings.destroy = Clock::now() - start;
+    return results;
+  }
+
+  const VlanBatchTimings &VlanBatch::getTimings() const {
+    return pImpl->timings;
+  }
+
+  std::string VlanBatch::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
@@ -0,0 +1,260 @@
+/**
+ * @file interface/vnetmanager.cpp
+ * @brief VNET jail manager implementation
+ * @details Jail table from a jail_get(2) "lastjid" walk and SIOCSIFVNET /
+ * SIOCSIFRVNET batches over the cached control socket
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <interface/socket.hpp>
+#include <interface/vnetmanager.hpp>
+#include <map>
+#include <metrics/probes.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <shared_mutex>
+#include <sys/ioctl.h>
+#include <sys/jail.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <sys/sockio.h>
+#include <sys/uio.h>
+
+namespace libfreebsdnet::interface {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Jails come and go without notification; trust the table this long
+    constexpr auto MAX_AGE = std::chrono::seconds(5);
+
+    // A jail that is still missing after a rebuild is gone; do not rebuild
+    // for it more often than this
+    constexpr auto MISS_REFRESH_INTERVAL = std::chrono::seconds(1);
+
+    std::shared_mutex tableMutex;
+    std::map<int, std::string> jails;
+    Clock::time_point lastRefresh;
+    std::atomic<bool> stale{true};
+    std::atomic<uint64_t> refreshCount{0};
+
+    struct iovec param(const char *name) {
+      return {const_cast<char *>(name), std::strlen(name) + 1};
+    }
+
+    bool expired() {
+      if (stale.load(std::memory_order_acquire)) {
+        return true;
+      }
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      return Clock::now() - lastRefresh >= MAX_AGE;
+    }
+
+    bool mayRetry() {
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      return Clock::now() - lastRefresh >= MISS_REFRESH_INTERVAL;
+    }
+
+    bool findName(int jid, std::string &name) {
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      auto it = jails.find(jid);
+      if (it == jails.end()) {
+        return false;
+      }
+      name = it->second;
+      return true;
+    }
+
+    int findId(const std::string &name) {
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      for (const auto &[jid, jailName] : jails) {
+        if (jailName == name) {
+          return jid;
+        }
+      }
+      return -1;
+    }
+
+    int changeVnet(int sock, unsigned long request, int jid,
+                   const std::string &name) {
+      if (name.empty() || name.size() >= IFNAMSIZ) {
+        return EINVAL;
+      }
+      struct ifreq ifr;
+      std::memset(&ifr, 0, sizeof(ifr));
+      std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+      ifr.ifr_jid = jid;
+      return metrics::tracedIoctl(sock, request, &ifr) < 0 ? errno : 0;
+    }
+
+  } // namespace
+
+  class VnetManager::Impl {
+  public:
+    std::string lastError;
+
+    std::vector<VnetMoveResult> apply(unsigned long request, int jid,
+                                      std::span<const std::string> names,
+                                      const char *what) {
+      lastError.clear();
+      std::vector<VnetMoveResult> results(names.size());
+      int sock = ControlSocket::get(AF_INET);
+      bool jailGone = false;
+      for (size_t i = 0; i < names.size(); ++i) {
+        results[i].name = names[i];
+        results[i].error = sock < 0 ? EBADF
+                                    : changeVnet(sock, request, jid, names[i]);
+        if (results[i].error == 0) {
+          continue;
+        }
+        jailGone |= results[i].error == ENOENT || results[i].error == ESRCH;
+        if (lastError.empty()) {
+          lastError = "Failed to " + std::string(what) + " " + names[i] +
+                      ": " + strerror(results[i].error);
+        }
+      }
+      if (jailGone) {
+        VnetManager::invalidate();
+      }
+      return results;
+    }
+
+    std::vector<VnetMoveResult> unknown(const std::string &jail,
+                                        std::span<const std::string> names) {
+      lastError = "Unknown jail: " + jail;
+      std::vector<VnetMoveResult> results(names.size());
+      for (size_t i = 0; i < names.size(); ++i) {
+        results[i].name = names[i];
+        results[i].error = ESRCH;
+      }
+      return results;
+    }
+  };
+
+  VnetManager::VnetManager() : pImpl(std::make_unique<Impl>()) {}
+
+  VnetManager::~VnetManager() = default;
+
+  std::string VnetManager::getJailName(int jid) {
+    if (jid <= 0) {
+      return "";
+    }
+    if (expired()) {
+      refresh();
+    }
+    std::string name;
+    if (!findName(jid, name) && mayRetry() && refresh()) {
+      findName(jid, name);
+    }
+    return name;
+  }
+
+  int VnetManager::getJailId(const std::string &name) {
+    int jid = 0;
+    const char *end = name.data() + name.size();
+    auto [ptr, ec] = std::from_chars(name.data(), end, jid);
+    if (!name.empty() && ec == std::errc() && ptr == end) {
+      return jid > 0 ? jid : -1;
+    }
+    if (expired()) {
+      refresh();
+    }
+    jid = findId(name);
+    if (jid < 0 && mayRetry() && refresh()) {
+      jid = findId(name);
+    }
+    return jid;
+  }
+
+  std::vector<JailEntry> VnetManager::getJails() {
+    if (expired()) {
+      refresh();
+    }
+    std::vector<JailEntry> result;
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    result.reserve(jails.size());
+    for (const auto &[jid, name] : jails) {
+      result.push_back({jid, name});
+    }
+    return result;
+  }
+
+  bool VnetManager::refresh() {
+    std::map<int, std::string> table;
+    int lastJid = 0;
+    char name[MAXHOSTNAMELEN];
+    struct iovec iov[4] = {param("lastjid"),
+                           {&lastJid, sizeof(lastJid)},
+                           param("name"),
+                           {name, sizeof(name)}};
+    for (;;) {
+      name[0] = '\0';
+      int jid = jail_get(iov, 4, 0);
+      if (jid < 0) {
+        if (errno == ENOENT) {
+          break; // past the last jail
+        }
+        return false;
+      }
+      table.emplace(jid, std::string(name, strnlen(name, sizeof(name))));
+      lastJid = jid;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    jails.swap(table);
+    lastRefresh = Clock::now();
+    stale.store(false, std::memory_order_release);
+    refreshCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void VnetManager::invalidate() {
+    stale.store(true, std::memory_order_release);
+  }
+
+  uint64_t VnetManager::getRefreshCount() {
+    return refreshCount.load(std::memory_order_relaxed);
+  }
+
+  std::vector<VnetMoveResult>
+  VnetManager::moveToJail(int jid, std::span<const std::string> interfaces) {
+    return pImpl->apply(SIOCSIFVNET, jid, interfaces, "move");
+  }
+
+  std::vector<VnetMoveResult>
+  VnetManager::moveToJail(const std::string &jail,
+                          std::span<const std::string> interfaces) {
+    int jid = getJailId(jail);
+    if (jid < 0) {
+      return pImpl->unknown(jail, interfaces);
+    }
+    return moveToJail(jid, interfaces);
+  }
+
+  std::vector<VnetMoveResult>
+  VnetManager::reclaimFromJail(int jid,
+                               std::span<const std::string> interfaces) {
+    return pImpl->apply(SIOCSIFRVNET, jid, interfaces, "reclaim");
+  }
+
+  std::vector<VnetMoveResult>
+  VnetManager::reclaimFromJail(const std::string &jail,
+                               std::span<const std::string> interfaces) {
+    int jid = getJailId(jail);
+    if (jid < 0) {
+      return pImpl->unknown(jail, interfaces);
+    }
+    return reclaimFromJail(jid, interfaces);
+  }
+
+  std::string VnetManager::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::interface
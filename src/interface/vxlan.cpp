@@ -7,25 +7,89 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <charconv>
 #include <cstring>
 #include <errno.h>
 #include <ifaddrs.h>
+#include <interface/socket.hpp>
 #include <interface/vxlan.hpp>
 #include <jail.h>
+#include <metrics/probes.hpp>
 #include <net/if.h>
 #include <net/if_mib.h>
 #include <net/if_private.h>
+#include <net/if_vxlan.h>
 #include <netinet/in.h>
+#include <string_view>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/sockio.h>
 #include <sys/sysctl.h>
+#include <system/sysctl.hpp>
 #include <unistd.h>
 
 namespace libfreebsdnet::interface {
 
-  class VxlanInterface::Impl {
+  namespace {
+
+    // VXLAN settings and the forwarding table go through SIOCSDRVSPEC
+    int driverCommand(int sock, const std::string &name, unsigned long cmd,
+                      struct ifvxlancmd &data) {
+      struct ifdrv ifd;
+      std::memset(&ifd, 0, sizeof(ifd));
+      std::strncpy(ifd.ifd_name, name.c_str(), IFNAMSIZ - 1);
+      ifd.ifd_cmd = cmd;
+      ifd.ifd_len = sizeof(data);
+      ifd.ifd_data = &data;
+      return metrics::tracedIoctl(sock, SIOCSDRVSPEC, &ifd) < 0 ? errno : 0;
+    }
+
+    // Driver name and unit, such as "vxlan0"; it survives a rename
+    std::string driverName(unsigned int index) {
+      int mib[] = {CTL_NET, PF_LINK, NETLINK_GENERIC, IFMIB_IFDATA,
+                   static_cast<int>(index), IFDATA_DRIVERNAME};
+      char name[IFNAMSIZ * 2] = {0};
+      size_t len = sizeof(name) - 1;
+      if (sysctl(mib, sizeof(mib) / sizeof(mib[0]), name, &len, nullptr, 0) !=
+          0) {
+        return "";
+      }
+      return std::string(name, strnlen(name, len));
+    }
+
+    // One dump line: "<D|S> <flags> <mac> <address> <expire>"
+    bool parseFtLine(std::string_view line, VxlanFtEntry &entry) {
+      std::string_view fields[5];
+      size_t count = 0;
+      size_t pos = 0;
+      while (count < 5) {
+        pos = line.find_first_not_of(' ', pos);
+        if (pos == std::string_view::npos) {
+          break;
+        }
+        size_t end = std::min(line.find(' ', pos), line.size());
+        fields[count++] = line.substr(pos, end - pos);
+        pos = end;
+      }
+      if (count < 5 || (fields[0] != "D" && fields[0] != "S")) {
+        return false;
+      }
+      entry = VxlanFtEntry{};
+      entry.dynamic = fields[0] == "D";
+      if (!entry.mac.fromString(std::string(fields[2])) ||
+          !libfreebsdnet::types::Address::parse(fields[3], entry.remote)) {
+        return false;
+      }
+      auto [end, error] = std::from_chars(
+          fields[4].data(), fields[4].data() + fields[4].size(), entry.expire);
+      return error == std::errc();
+    }
+
+  } // namespace
+
+  class VxlanInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
@@ -44,15 +108,11 @@ namespace libfreebsdnet::interface {
 
   VxlanInterface::VxlanInterface(const std::string &name, unsigned int index,
                                  int flags)
-      : TunnelInterface(name, index, flags),
+      : InterfaceBase(name, index, flags),
         pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
   VxlanInterface::~VxlanInterface() = default;
 
-  InterfaceType VxlanInterface::getType() const {
-    return InterfaceType::TUNNEL; // VXLAN is a type of tunnel
-  }
-
   int VxlanInterface::getVni() const { return pImpl->vni; }
 
   bool VxlanInterface::setVni(int vni) {
@@ -108,80 +168,140 @@ namespace libfreebsdnet::interface {
     return true; // Learning setting would require specific VXLAN ioctls
   }
 
-  // Group management methods (call base class)
-  std::vector<std::string> VxlanInterface::getGroups() const {
-    return Interface::getGroups();
-  }
-
-  bool VxlanInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
-
-  bool VxlanInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
-
-  // Base class method implementations (call base class)
-  int VxlanInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool VxlanInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int VxlanInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
-
-  int VxlanInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> VxlanInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t VxlanInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
-
-  bool VxlanInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
-
-  uint32_t VxlanInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
-
-  bool VxlanInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
-
-  bool VxlanInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
+  size_t
+  VxlanInterface::addForwardingEntries(std::span<const VxlanFtEntry> entries,
+                                       std::vector<int> *errors) {
+    if (errors) {
+      errors->assign(entries.size(), 0);
+    }
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      return 0;
+    }
 
-  bool VxlanInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
+    size_t added = 0;
+    struct ifvxlancmd cmd;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const VxlanFtEntry &entry = entries[i];
+      std::memset(&cmd, 0, sizeof(cmd));
+      auto mac = entry.mac.getBytes();
+      std::memcpy(cmd.vxlcmd_mac, mac.data(), mac.size());
+      int error = 0;
+      if (entry.remote.isIPv4()) {
+        cmd.vxlcmd_sa.in4 = entry.remote.getSockaddrIn();
+        cmd.vxlcmd_sa.in4.sin_port = htons(entry.port);
+      } else if (entry.remote.isIPv6()) {
+        cmd.vxlcmd_sa.in6 = entry.remote.getSockaddrIn6();
+        cmd.vxlcmd_sa.in6.sin6_port = htons(entry.port);
+      } else {
+        error = EINVAL;
+      }
+      if (error == 0) {
+        error = driverCommand(sock, pImpl->name, VXLAN_CMD_FTABLE_ENTRY_ADD,
+                              cmd);
+      }
+      if (error == 0) {
+        ++added;
+      } else {
+        if (errors) {
+          (*errors)[i] = error;
+        }
+        pImpl->lastError = "Failed to add " + entry.mac.toString() + ": " +
+                           strerror(error);
+      }
+    }
+    return added;
   }
 
-  bool VxlanInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
+  size_t VxlanInterface::removeForwardingEntries(
+      std::span<const libfreebsdnet::ethernet::MacAddress> macs,
+      std::vector<int> *errors) {
+    if (errors) {
+      errors->assign(macs.size(), 0);
+    }
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      return 0;
+    }
 
-  bool VxlanInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
+    size_t removed = 0;
+    struct ifvxlancmd cmd;
+    for (size_t i = 0; i < macs.size(); ++i) {
+      std::memset(&cmd, 0, sizeof(cmd));
+      auto mac = macs[i].getBytes();
+      std::memcpy(cmd.vxlcmd_mac, mac.data(), mac.size());
+      int error =
+          driverCommand(sock, pImpl->name, VXLAN_CMD_FTABLE_ENTRY_REM, cmd);
+      if (error == 0) {
+        ++removed;
+      } else {
+        if (errors) {
+          (*errors)[i] = error;
+        }
+        pImpl->lastError = "Failed to remove " + macs[i].toString() + ": " +
+                           strerror(error);
+      }
+    }
+    return removed;
   }
 
-  std::vector<std::string> VxlanInterface::getCloners() const {
-    return Interface::getCloners();
+  bool VxlanInterface::flushForwardingTable(bool all) {
+    int sock = ControlSocket::get(AF_INET);
+    if (sock < 0) {
+      pImpl->lastError = "Failed to create socket";
+      return false;
+    }
+    struct ifvxlancmd cmd;
+    std::memset(&cmd, 0, sizeof(cmd));
+    cmd.vxlcmd_flags = all ? VXLAN_CMD_FLAG_FLUSH_ALL : 0;
+    int error = driverCommand(sock, pImpl->name, VXLAN_CMD_FLUSH, cmd);
+    if (error != 0) {
+      pImpl->lastError =
+          "Failed to flush forwarding table: " + std::string(strerror(error));
+      return false;
+    }
+    return true;
   }
 
-  std::string VxlanInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
+  bool
+  VxlanInterface::getForwardingTable(std::vector<VxlanFtEntry> &entries) const {
+    entries.clear();
+    // The sysctl node is named by driver unit, which a renamed interface
+    // no longer shows in its name
+    std::string driver = driverName(getIndex());
+    size_t digits = driver.find_last_not_of("0123456789");
+    if (digits == std::string::npos || digits + 1 == driver.size()) {
+      pImpl->lastError = "Cannot derive unit from driver name of " +
+                         pImpl->name;
+      return false;
+    }
+    std::string node =
+        "net.link.vxlan." + driver.substr(digits + 1) + ".ftable.dump";
+    int mib[CTL_MAXNAME];
+    size_t length = CTL_MAXNAME;
+    if (sysctlnametomib(node.c_str(), mib, &length) != 0) {
+      pImpl->lastError = "Failed to resolve " + node + ": " + strerror(errno);
+      return false;
+    }
+    auto lease = system::SysctlBuffer::acquire();
+    auto &buffer = *lease;
+    if (!buffer.fetch(std::span<const int>(mib, length))) {
+      pImpl->lastError = buffer.getLastError();
+      return false;
+    }
 
-  bool VxlanInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
+    std::string_view text(buffer.data(), strnlen(buffer.data(), buffer.size()));
+    while (!text.empty()) {
+      size_t end = std::min(text.find('\n'), text.size());
+      VxlanFtEntry entry;
+      if (parseFtLine(text.substr(0, end), entry)) {
+        entries.push_back(entry);
+      }
+      text.remove_prefix(std::min(end + 1, text.size()));
+    }
+    return true;
   }
 
   // VNET interface methods
@@ -7,12 +7,16 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <ifaddrs.h>
+#include <interface/socket.hpp>
+#include <interface/vnetmanager.hpp>
 #include <interface/wireless.hpp>
-#include <jail.h>
+#include <metrics/probes.hpp>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -32,108 +36,161 @@
 
 namespace libfreebsdnet::interface {
 
-  class WirelessInterface::Impl {
+  class WirelessInterface::Impl : public ArenaAllocated {
   public:
     std::string name;
     unsigned int index;
     int flags;
     std::string lastError;
 
+    // Scan and station tables, kept so repeated sampling reuses them
+    mutable std::vector<uint8_t> buffer;
+
     Impl(const std::string &name, unsigned int index, int flags)
         : name(name), index(index), flags(flags) {}
-  };
-
-  WirelessInterface::WirelessInterface(const std::string &name,
-                                       unsigned int index, int flags)
-      : pImpl(std::make_unique<Impl>(name, index, flags)) {}
-
-  WirelessInterface::~WirelessInterface() = default;
-
-  InterfaceType WirelessInterface::getType() const {
-    return InterfaceType::WIRELESS;
-  }
-
-  bool WirelessInterface::isValid() const { return !pImpl->name.empty(); }
-
-  // Base class method implementations
-  std::string WirelessInterface::getName() const {
-    return Interface::getName();
-  }
-  unsigned int WirelessInterface::getIndex() const {
-    return Interface::getIndex();
-  }
-  std::vector<Flag> WirelessInterface::getFlags() const {
-    return Interface::getFlags();
-  }
-  bool WirelessInterface::setFlags(int flags) {
-    return Interface::setFlags(flags);
-  }
-  std::string WirelessInterface::getLastError() const {
-    return Interface::getLastError();
-  }
-
-  bool WirelessInterface::bringUp() { return Interface::bringUp(); }
-  bool WirelessInterface::bringDown() { return Interface::bringDown(); }
-  bool WirelessInterface::isUp() const { return Interface::isUp(); }
-
-  int WirelessInterface::getMtu() const { return Interface::getMtu(); }
-  bool WirelessInterface::setMtu(int mtu) { return Interface::setMtu(mtu); }
-
-  int WirelessInterface::getFib() const { return Interface::getFib(); }
-  bool WirelessInterface::setFib(int fib) { return Interface::setFib(fib); }
-
-  int WirelessInterface::getMedia() const { return Interface::getMedia(); }
-
-  bool WirelessInterface::setMedia(int media) {
-    return Interface::setMedia(media);
-  }
-
-  int WirelessInterface::getMediaStatus() const {
-    return Interface::getMediaStatus();
-  }
 
-  int WirelessInterface::getActiveMedia() const {
-    return Interface::getActiveMedia();
-  }
-
-  std::vector<int> WirelessInterface::getSupportedMedia() const {
-    return Interface::getSupportedMedia();
-  }
-
-  uint32_t WirelessInterface::getCapabilities() const {
-    return Interface::getCapabilities();
-  }
+    // Issue one SIOCG80211 into buffer, whose first prefixLength bytes are
+    // input; on success length is the number of bytes returned after that
+    // prefix, as the kernel's i_len does not count it
+    int query(int type, size_t prefixLength, size_t &length) const {
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return EBADF;
+      }
+      if (buffer.size() < INITIAL_TABLE_SIZE) {
+        buffer.resize(INITIAL_TABLE_SIZE);
+      }
+      for (;;) {
+        struct ieee80211req req;
+        std::memset(&req, 0, sizeof(req));
+        std::strncpy(req.i_name, name.c_str(), IFNAMSIZ - 1);
+        req.i_type = type;
+        req.i_data = buffer.data();
+        req.i_len = static_cast<uint16_t>(
+            std::min<size_t>(buffer.size(), UINT16_MAX));
+        if (metrics::tracedIoctl(sock, SIOCG80211, &req) < 0) {
+          return errno;
+        }
+        length = req.i_len;
+        // The kernel copies only whole records that fit; grow the buffer
+        // and ask again while the reply may have been cut short
+        if (buffer.size() - std::min(buffer.size(), prefixLength + length) >=
+                MAX_RECORD_SIZE ||
+            buffer.size() >= UINT16_MAX) {
+          return 0;
+        }
+        std::vector<uint8_t> prefix(buffer.begin(),
+                                    buffer.begin() + prefixLength);
+        buffer.resize(std::min<size_t>(buffer.size() * 2, UINT16_MAX));
+        std::copy(prefix.begin(), prefix.end(), buffer.begin());
+      }
+    }
 
-  bool WirelessInterface::setCapabilities(uint32_t capabilities) {
-    return Interface::setCapabilities(capabilities);
-  }
+    // Decode station records for macaddr (all ones for every station)
+    bool stations(const uint8_t *macaddr, std::vector<WirelessStation> &out,
+                  int &error) const {
+      out.clear();
+      constexpr size_t header = offsetof(struct ieee80211req_sta_req, info);
+      if (buffer.size() < INITIAL_TABLE_SIZE) {
+        buffer.resize(INITIAL_TABLE_SIZE);
+      }
+      std::memset(buffer.data(), 0, header);
+      std::memcpy(buffer.data(), macaddr, IEEE80211_ADDR_LEN);
+      size_t length = 0;
+      error = query(IEEE80211_IOC_STA_INFO, header, length);
+      if (error != 0) {
+        return false;
+      }
+      size_t offset = header;
+      size_t end = std::min(buffer.size(), header + length);
+      while (end >= offset + sizeof(struct ieee80211req_sta_info)) {
+        const auto *si = reinterpret_cast<const struct ieee80211req_sta_info *>(
+            buffer.data() + offset);
+        if (si->isi_len < sizeof(*si) || si->isi_len > end - offset) {
+          break;
+        }
+        WirelessStation &station = out.emplace_back();
+        std::memcpy(station.mac.data(), si->isi_macaddr, IEEE80211_ADDR_LEN);
+        station.frequency = si->isi_freq;
+        station.associationId = si->isi_associd;
+        station.rssi = si->isi_rssi;
+        station.noise = si->isi_noise;
+        station.txRate = si->isi_txmbps;
+        station.inactive = si->isi_inact;
+        station.state = si->isi_state;
+        offset += si->isi_len;
+      }
+      return true;
+    }
 
-  uint32_t WirelessInterface::getEnabledCapabilities() const {
-    return Interface::getEnabledCapabilities();
-  }
+    int stationStats(WirelessStation &station) const {
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return EBADF;
+      }
+      struct ieee80211req_sta_stats stats;
+      std::memset(&stats, 0, sizeof(stats));
+      std::memcpy(stats.is_u.macaddr, station.mac.data(), IEEE80211_ADDR_LEN);
+      struct ieee80211req req;
+      std::memset(&req, 0, sizeof(req));
+      std::strncpy(req.i_name, name.c_str(), IFNAMSIZ - 1);
+      req.i_type = IEEE80211_IOC_STA_STATS;
+      req.i_data = &stats;
+      req.i_len = sizeof(stats);
+      if (metrics::tracedIoctl(sock, SIOCG80211, &req) < 0) {
+        return errno;
+      }
+      const struct ieee80211_nodestats &ns = stats.is_stats;
+      station.rxPackets = ns.ns_rx_data;
+      station.txPackets = ns.ns_tx_data;
+      station.rxBytes = ns.ns_rx_bytes;
+      station.txBytes = ns.ns_tx_bytes;
+      station.rxDropped = ns.ns_rx_drop;
+      return 0;
+    }
 
-  bool WirelessInterface::enableCapabilities(uint32_t capabilities) {
-    return Interface::enableCapabilities(capabilities);
-  }
+    // The BSS node as seen in station mode
+    bool bss(WirelessStation &station) const {
+      int sock = ControlSocket::get(AF_INET);
+      if (sock < 0) {
+        return false;
+      }
+      uint8_t bssid[IEEE80211_ADDR_LEN] = {};
+      struct ieee80211req req;
+      std::memset(&req, 0, sizeof(req));
+      std::strncpy(req.i_name, name.c_str(), IFNAMSIZ - 1);
+      req.i_type = IEEE80211_IOC_BSSID;
+      req.i_data = bssid;
+      req.i_len = sizeof(bssid);
+      if (metrics::tracedIoctl(sock, SIOCG80211, &req) < 0) {
+        return false;
+      }
+      std::vector<WirelessStation> found;
+      int error = 0;
+      if (!stations(bssid, found, error) || found.empty()) {
+        return false;
+      }
+      station = found.front();
+      return true;
+    }
 
-  bool WirelessInterface::disableCapabilities(uint32_t capabilities) {
-    return Interface::disableCapabilities(capabilities);
-  }
+  private:
+    static constexpr size_t INITIAL_TABLE_SIZE = 24 * 1024;
+    // A record with its IEs; less free space than this may mean truncation
+    static constexpr size_t MAX_RECORD_SIZE = 1024;
+  };
 
-  std::vector<std::string> WirelessInterface::getGroups() const {
-    return Interface::getGroups();
-  }
+  WirelessInterface::WirelessInterface(const std::string &name,
+                                       unsigned int index, int flags)
+      : InterfaceBase(name, index, flags),
+        pImpl(std::make_unique<Impl>(name, index, flags)) {}
 
-  bool WirelessInterface::addToGroup(const std::string &groupName) {
-    return Interface::addToGroup(groupName);
-  }
+  WirelessInterface::~WirelessInterface() = default;
 
-  bool WirelessInterface::removeFromGroup(const std::string &groupName) {
-    return Interface::removeFromGroup(groupName);
-  }
+  bool WirelessInterface::isValid() const { return !pImpl->name.empty(); }
 
   int WirelessInterface::getVnet() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -142,33 +199,19 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFFLAGS, &ifr) < 0) {
       return -1;
     }
 
-    close(sock);
     return ifr.ifr_jid;
   }
 
   std::string WirelessInterface::getVnetJailName() const {
-    int vnetId = getVnet();
-    if (vnetId < 0) {
-      return "";
-    }
-
-    char *jailName = jail_getname(vnetId);
-    if (jailName != nullptr) {
-      std::string result(jailName);
-      free(jailName);
-      return result;
-    }
-
-    return "";
+    return VnetManager::getJailName(getVnet());
   }
 
   bool WirelessInterface::setVnet(int vnetId) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -179,18 +222,16 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_jid = vnetId;
 
-    if (ioctl(sock, SIOCSIFVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFVNET, &ifr) < 0) {
       pImpl->lastError = "Failed to set VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   bool WirelessInterface::reclaimFromVnet() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -200,44 +241,18 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCSIFRVNET, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFRVNET, &ifr) < 0) {
       pImpl->lastError =
           "Failed to reclaim from VNET: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
-  bool WirelessInterface::setPhysicalAddress(const std::string &address) {
-    return Interface::setPhysicalAddress(address);
-  }
-
-  bool WirelessInterface::deletePhysicalAddress() {
-    return Interface::deletePhysicalAddress();
-  }
-
-  bool WirelessInterface::createClone(const std::string &cloneName) {
-    return Interface::createClone(cloneName);
-  }
-
-  std::vector<std::string> WirelessInterface::getCloners() const {
-    return Interface::getCloners();
-  }
-
-  std::string WirelessInterface::getMacAddress() const {
-    return Interface::getMacAddress();
-  }
-
-  bool WirelessInterface::setMacAddress(const std::string &macAddress) {
-    return Interface::setMacAddress(macAddress);
-  }
-
   // IEEE 802.11-specific methods
   int WirelessInterface::getChannel() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return -1;
     }
@@ -250,17 +265,15 @@ namespace libfreebsdnet::interface {
     req.i_data = &channel;
     req.i_len = sizeof(channel);
 
-    if (ioctl(sock, SIOCG80211, &req) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCG80211, &req) < 0) {
       return -1;
     }
 
-    close(sock);
     return channel;
   }
 
   bool WirelessInterface::setChannel(int channel) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -273,19 +286,17 @@ namespace libfreebsdnet::interface {
     req.i_data = &channel;
     req.i_len = sizeof(channel);
 
-    if (ioctl(sock, SIOCS80211, &req) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCS80211, &req) < 0) {
       pImpl->lastError =
           "Failed to set channel: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::string WirelessInterface::getSsid() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "";
     }
@@ -298,17 +309,15 @@ namespace libfreebsdnet::interface {
     char ssid_data[IEEE80211_NWID_LEN];
     req.i_data = ssid_data;
 
-    if (ioctl(sock, SIOCG80211, &req) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCG80211, &req) < 0) {
       return "";
     }
 
-    close(sock);
     return std::string(ssid_data, req.i_len);
   }
 
   bool WirelessInterface::setSsid(const std::string &ssid) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -322,18 +331,16 @@ namespace libfreebsdnet::interface {
         std::min(ssid.length(), static_cast<size_t>(IEEE80211_NWID_LEN - 1));
     req.i_data = const_cast<char *>(ssid.c_str());
 
-    if (ioctl(sock, SIOCS80211, &req) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCS80211, &req) < 0) {
       pImpl->lastError = "Failed to set SSID: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   std::string WirelessInterface::getMode() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       return "unknown";
     }
@@ -342,13 +349,10 @@ namespace libfreebsdnet::interface {
     std::memset(&ifmr, 0, sizeof(ifmr));
     std::strncpy(ifmr.ifm_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       return "unknown";
     }
 
-    close(sock);
-
     // Check media flags like ifconfig does
     if (ifmr.ifm_current & IFM_IEEE80211_ADHOC) {
       if (ifmr.ifm_current & IFM_FLAG0) {
@@ -368,7 +372,7 @@ namespace libfreebsdnet::interface {
   }
 
   bool WirelessInterface::setMode(const std::string &mode) {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError = "Failed to create socket";
       return false;
@@ -379,10 +383,9 @@ namespace libfreebsdnet::interface {
     std::strncpy(ifmr.ifm_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
     // Get current media
-    if (ioctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCGIFMEDIA, &ifmr) < 0) {
       pImpl->lastError =
           "Failed to get current media: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
@@ -401,30 +404,25 @@ namespace libfreebsdnet::interface {
       ifmr.ifm_current = IFM_IEEE80211 | IFM_IEEE80211_ADHOC | IFM_FLAG0;
     } else {
       pImpl->lastError = "Invalid wireless mode: " + mode;
-      close(sock);
       return false;
     }
 
-    if (ioctl(sock, SIOCSIFMEDIA, &ifmr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCSIFMEDIA, &ifmr) < 0) {
       pImpl->lastError = "Failed to set mode: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
   int WirelessInterface::getSignalStrength() const {
-    // This would require more complex IEEE 802.11 ioctls
-    // For now, return a placeholder
-    return -1;
+    WirelessStation station;
+    return pImpl->bss(station) ? station.getSignal() : -1;
   }
 
   int WirelessInterface::getNoiseLevel() const {
-    // This would require more complex IEEE 802.11 ioctls
-    // For now, return a placeholder
-    return -1;
+    WirelessStation station;
+    return pImpl->bss(station) ? station.noise : -1;
   }
 
   std::vector<int> WirelessInterface::getSupportedRates() const {
@@ -435,9 +433,8 @@ namespace libfreebsdnet::interface {
   }
 
   int WirelessInterface::getCurrentRate() const {
-    // This would require more complex IEEE 802.11 ioctls
-    // For now, return -1
-    return -1;
+    WirelessStation station;
+    return pImpl->bss(station) ? station.txRate / 2 : -1;
   }
 
   bool WirelessInterface::isEncryptionEnabled() const {
@@ -448,13 +445,84 @@ namespace libfreebsdnet::interface {
 
   std::vector<std::string> WirelessInterface::getAvailableNetworks() const {
     std::vector<std::string> networks;
-    // This would require scanning functionality
-    // For now, return empty vector
+    std::vector<WirelessScanEntry> entries;
+    if (!getScanResults(entries)) {
+      return networks;
+    }
+    for (const auto &entry : entries) {
+      std::string ssid(entry.getSsid());
+      if (!ssid.empty() &&
+          std::find(networks.begin(), networks.end(), ssid) == networks.end()) {
+        networks.push_back(std::move(ssid));
+      }
+    }
     return networks;
   }
 
+  bool WirelessInterface::getScanResults(
+      std::vector<WirelessScanEntry> &entries) const {
+    entries.clear();
+    size_t length = 0;
+    int error = pImpl->query(IEEE80211_IOC_SCAN_RESULTS, 0, length);
+    if (error != 0) {
+      pImpl->lastError =
+          "Failed to get scan results: " + std::string(strerror(error));
+      return false;
+    }
+
+    const uint8_t *data = pImpl->buffer.data();
+    size_t offset = 0;
+    while (length - offset >= sizeof(struct ieee80211req_scan_result)) {
+      const auto *sr =
+          reinterpret_cast<const struct ieee80211req_scan_result *>(data +
+                                                                    offset);
+      if (sr->isr_len < sizeof(*sr) || sr->isr_len > length - offset ||
+          sr->isr_ie_off + sr->isr_ssid_len > sr->isr_len) {
+        break;
+      }
+      WirelessScanEntry &entry = entries.emplace_back();
+      std::memcpy(entry.bssid.data(), sr->isr_bssid, IEEE80211_ADDR_LEN);
+      // The SSID sits at the IE offset, ahead of any mesh ID and the IEs
+      entry.ssidLength = std::min<uint8_t>(sr->isr_ssid_len, 32);
+      std::memcpy(entry.ssid.data(), data + offset + sr->isr_ie_off,
+                  entry.ssidLength);
+      entry.frequency = sr->isr_freq;
+      entry.rssi = sr->isr_rssi;
+      entry.noise = sr->isr_noise;
+      entry.beaconInterval = sr->isr_intval;
+      entry.capabilities = sr->isr_capinfo;
+      size_t rates = std::min<size_t>(sr->isr_nrates, sizeof(sr->isr_rates));
+      for (size_t i = 0; i < rates; ++i) {
+        entry.maxRate = std::max<uint8_t>(
+            entry.maxRate, sr->isr_rates[i] & IEEE80211_RATE_VAL);
+      }
+      offset += sr->isr_len;
+    }
+    return true;
+  }
+
+  bool WirelessInterface::getStations(std::vector<WirelessStation> &stations,
+                                      bool stats) const {
+    static constexpr uint8_t all[IEEE80211_ADDR_LEN] = {0xff, 0xff, 0xff,
+                                                         0xff, 0xff, 0xff};
+    int error = 0;
+    if (!pImpl->stations(all, stations, error)) {
+      pImpl->lastError =
+          "Failed to get stations: " + std::string(strerror(error));
+      return false;
+    }
+    if (!stats) {
+      return true;
+    }
+    for (auto &station : stations) {
+      // A station may leave between the two calls; keep it without counters
+      pImpl->stationStats(station);
+    }
+    return true;
+  }
+
   bool WirelessInterface::destroy() {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = ControlSocket::get(AF_INET);
     if (sock < 0) {
       pImpl->lastError =
           "Failed to create socket: " + std::string(strerror(errno));
@@ -465,14 +533,12 @@ namespace libfreebsdnet::interface {
     std::memset(&ifr, 0, sizeof(ifr));
     std::strncpy(ifr.ifr_name, pImpl->name.c_str(), IFNAMSIZ - 1);
 
-    if (ioctl(sock, SIOCIFDESTROY, &ifr) < 0) {
+    if (metrics::tracedIoctl(sock, SIOCIFDESTROY, &ifr) < 0) {
       pImpl->lastError =
           "Failed to destroy interface: " + std::string(strerror(errno));
-      close(sock);
       return false;
     }
 
-    close(sock);
     return true;
   }
 
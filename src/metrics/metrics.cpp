@@ -0,0 +1,219 @@
+/**
+ * @file metrics/metrics.cpp
+ * @brief Library call instrumentation implementation
+ * @details Each thread owns a slab of lazily allocated operation slots it
+ * alone writes; readers sum all slabs. Slabs of exited threads are handed
+ * to new threads so counts are never lost and memory does not grow with
+ * thread churn.
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <metrics/metrics.hpp>
+#include <mutex>
+
+namespace libfreebsdnet::metrics {
+
+  namespace {
+
+    using Counter = std::atomic<uint64_t>;
+
+    struct Slot {
+      std::array<Counter, SYSCALL_KINDS> syscalls{};
+      Counter calls{0};
+      Counter total{0};
+      Counter max{0};
+      std::array<Counter, BUCKET_COUNT> buckets{};
+    };
+
+    struct Slab {
+      std::array<std::atomic<Slot *>, MAX_OPERATIONS> slots{};
+      std::atomic<bool> inUse{true};
+
+      ~Slab() {
+        for (auto &slot : slots) {
+          delete slot.load();
+        }
+      }
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Slab>> slabs;
+    std::array<std::string, MAX_OPERATIONS> names = {"(unattributed)"};
+    size_t operationCount = 1;
+
+    // Only the owning thread writes a slab, so a plain load and store is
+    // enough and cheaper than an atomic read-modify-write
+    void bump(Counter &counter, uint64_t amount = 1) {
+      counter.store(counter.load(std::memory_order_relaxed) + amount,
+                    std::memory_order_relaxed);
+    }
+
+    struct Local {
+      Slab *slab = nullptr;
+      uint16_t current = 0;
+
+      ~Local() {
+        if (slab) {
+          slab->inUse.store(false, std::memory_order_release);
+        }
+      }
+
+      Slot &slot(uint16_t operation) {
+        if (!slab) {
+          std::lock_guard<std::mutex> lock(registryMutex);
+          for (auto &candidate : slabs) {
+            bool idle = false;
+            if (candidate->inUse.compare_exchange_strong(idle, true)) {
+              slab = candidate.get();
+              break;
+            }
+          }
+          if (!slab) {
+            slabs.push_back(std::make_unique<Slab>());
+            slab = slabs.back().get();
+          }
+        }
+        Slot *entry = slab->slots[operation].load(std::memory_order_acquire);
+        if (!entry) {
+          entry = new Slot();
+          slab->slots[operation].store(entry, std::memory_order_release);
+        }
+        return *entry;
+      }
+    };
+
+    thread_local Local local;
+
+  } // namespace
+
+  uint64_t OperationMetrics::getPercentileNanoseconds(double percentile) const {
+    uint64_t count = 0;
+    for (uint64_t bucket : buckets) {
+      count += bucket;
+    }
+    if (count == 0) {
+      return 0;
+    }
+    double clamped = std::clamp(percentile, 0.0, 100.0);
+    uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) +
+                                 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        uint64_t upper = i + 1 < BUCKET_COUNT ? bucketLowerBound(i + 1) - 1
+                                              : maxNanoseconds;
+        return std::min(upper, maxNanoseconds);
+      }
+    }
+    return maxNanoseconds;
+  }
+
+  bool isEnabled() {
+#ifdef LIBFREEBSDNET_METRICS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  uint16_t registerOperation(const char *name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (size_t i = 1; i < operationCount; ++i) {
+      if (names[i] == name) {
+        return static_cast<uint16_t>(i);
+      }
+    }
+    if (operationCount == MAX_OPERATIONS) {
+      return 0;
+    }
+    names[operationCount] = name;
+    return static_cast<uint16_t>(operationCount++);
+  }
+
+  void countSyscall(Syscall kind) {
+    bump(local.slot(local.current).syscalls[static_cast<size_t>(kind)]);
+  }
+
+  std::vector<OperationMetrics> snapshot() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<OperationMetrics> result;
+    for (size_t op = 0; op < operationCount; ++op) {
+      OperationMetrics metrics;
+      metrics.buckets.assign(BUCKET_COUNT, 0);
+      uint64_t syscalls = 0;
+      for (const auto &slab : slabs) {
+        const Slot *slot = slab->slots[op].load(std::memory_order_acquire);
+        if (!slot) {
+          continue;
+        }
+        metrics.calls += slot->calls.load(std::memory_order_relaxed);
+        metrics.totalNanoseconds += slot->total.load(std::memory_order_relaxed);
+        metrics.maxNanoseconds = std::max(
+            metrics.maxNanoseconds, slot->max.load(std::memory_order_relaxed));
+        for (size_t k = 0; k < SYSCALL_KINDS; ++k) {
+          uint64_t n = slot->syscalls[k].load(std::memory_order_relaxed);
+          metrics.syscalls[k] += n;
+          syscalls += n;
+        }
+        for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+          metrics.buckets[b] +=
+              slot->buckets[b].load(std::memory_order_relaxed);
+        }
+      }
+      if (metrics.calls > 0 || syscalls > 0) {
+        metrics.name = names[op];
+        result.push_back(std::move(metrics));
+      }
+    }
+    return result;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &slab : slabs) {
+      for (auto &entry : slab->slots) {
+        Slot *slot = entry.load(std::memory_order_acquire);
+        if (!slot) {
+          continue;
+        }
+        for (auto &counter : slot->syscalls) {
+          counter.store(0, std::memory_order_relaxed);
+        }
+        slot->calls.store(0, std::memory_order_relaxed);
+        slot->total.store(0, std::memory_order_relaxed);
+        slot->max.store(0, std::memory_order_relaxed);
+        for (auto &counter : slot->buckets) {
+          counter.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  Scope::Scope(uint16_t operation)
+      : operation(operation), previous(local.current),
+        start(std::chrono::steady_clock::now()) {
+    local.current = operation;
+  }
+
+  Scope::~Scope() {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    Slot &slot = local.slot(operation);
+    bump(slot.calls);
+    bump(slot.total, ns);
+    if (ns > slot.max.load(std::memory_order_relaxed)) {
+      slot.max.store(ns, std::memory_order_relaxed);
+    }
+    bump(slot.buckets[bucketIndex(ns)]);
+    local.current = previous;
+  }
+
+} // namespace libfreebsdnet::metrics
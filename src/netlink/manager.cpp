@@ -1,7 +1,9 @@
 /**
  * @file netlink/manager.cpp
  * @brief Netlink manager implementation
- * @details Implementation of netlink interface management functionality
+ * @details Implementation of netlink interface management functionality;
+ * asynchronous requests use their own non-blocking snl socket so they never
+ * interleave with the blocking ones
  *
  * @author paigeadelethompson
  * @year 2024
@@ -9,17 +11,24 @@
 
 #include <arpa/inet.h>
 #include <atomic>
+#include <cstdlib>
 #include <cstring>
+#include <cstdio>
 #include <errno.h>
-#include <ifaddrs.h>
+#include <fcntl.h>
+#include <interface/socket.hpp>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
 #include <net/if.h>
-#include <net/if_dl.h>
 #include <netinet/in.h>
 #include <netlink/manager.hpp>
 #include <netlink/netlink.h>
 #include <netlink/netlink_route.h>
 #include <netlink/netlink_snl.h>
 #include <netlink/netlink_snl_route.h>
+#include <poll.h>
+#include <sys/event.h>
 #include <sys/ioctl.h>
 #include <sys/linker.h>
 #include <sys/module.h>
@@ -27,31 +36,82 @@
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace libfreebsdnet::netlink {
 
   class NetlinkManager::Impl {
   public:
+    // Written by the monitor thread as well as callers
+    mutable std::mutex errorMutex;
     std::string lastError;
     std::atomic<bool> monitoring{false};
     std::thread monitorThread;
     NetlinkCallback callback;
     int netlinkSocket{-1};
 
-    Impl() {
+    // Request/response state; snl keeps its receive buffer between requests
+    struct snl_state ss{};
+    bool snlReady{false};
+    std::mutex requestMutex;
+
+    // Monitor state, owned by the monitor thread while it runs
+    struct snl_state monitorState{};
+    bool monitorReady{false};
+    NetlinkBatchCallback batchCallback;
+    NetlinkMonitorOptions options;
+
+    // Monitor driven by a caller's kqueue instead of monitorThread
+    int monitorQueue{-1};
+    bool timerArmed{false};
+    NetlinkEventBatch pendingBatch;
+
+    // Asynchronous requests, answered through a caller's kqueue
+    struct PendingLinks {
+      NetlinkLinksCallback callback;
+      std::vector<NetlinkInterfaceInfo> links;
+      bool dump;
+    };
+    struct snl_state asyncState{};
+    bool asyncReady{false};
+    int asyncQueue{-1};
+    std::unordered_map<uint32_t, PendingLinks> pendingLinks;
+
+    // Module check and sockets are deferred to the first request, so a
+    // manager that is never used costs neither a kldload nor a socket
+    std::once_flag initOnce;
+
+    void setError(const std::string &message) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      lastError = message;
+    }
+
+    bool ready() {
+      std::call_once(initOnce, [this] { initialize(); });
+      return netlinkSocket >= 0;
+    }
+
+    void initialize() {
       // Check if netlink module is loaded
       if (modfind("netlink") == -1 && errno == ENOENT) {
         if (kldload("netlink") == -1) {
-          lastError = "Netlink module not available";
+          setError("Netlink module not available");
           return;
         }
       }
 
       // Create netlink socket
+      LIBFREEBSDNET_METRICS_SYSCALL(SOCKET);
       netlinkSocket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
       if (netlinkSocket < 0) {
-        lastError =
-            "Failed to create netlink socket: " + std::string(strerror(errno));
+        setError("Failed to create netlink socket: " +
+                 std::string(strerror(errno)));
+        return;
+      }
+
+      snlReady = snl_init(&ss, NETLINK_ROUTE);
+      if (!snlReady) {
+        setError("Failed to initialize netlink request state");
       }
     }
 
@@ -63,141 +123,480 @@ namespace libfreebsdnet::netlink {
       if (netlinkSocket >= 0) {
         close(netlinkSocket);
       }
+      if (snlReady) {
+        snl_free(&ss);
+      }
+      if (asyncReady) {
+        snl_free(&asyncState);
+      }
+      disarmTimer();
+      closeMonitor();
     }
-  };
 
-  NetlinkManager::NetlinkManager() : pImpl(std::make_unique<Impl>()) {}
+    static void toAddress(const struct sockaddr *sa, NetlinkAddress &out) {
+      out.family = 0;
+      if (sa == nullptr) {
+        return;
+      }
+      if (sa->sa_family == AF_INET) {
+        auto *sin = reinterpret_cast<const struct sockaddr_in *>(sa);
+        out.family = AF_INET;
+        std::memcpy(out.bytes.data(), &sin->sin_addr, sizeof(sin->sin_addr));
+      } else if (sa->sa_family == AF_INET6) {
+        auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(sa);
+        out.family = AF_INET6;
+        std::memcpy(out.bytes.data(), &sin6->sin6_addr,
+                    sizeof(sin6->sin6_addr));
+      }
+    }
 
-  NetlinkManager::~NetlinkManager() = default;
+    bool openMonitor() {
+      if (!snl_init(&monitorState, NETLINK_ROUTE)) {
+        setError("Failed to initialize netlink monitor socket");
+        return false;
+      }
+      monitorReady = true;
+
+      const std::pair<uint32_t, int> groups[] = {
+          {GROUP_LINK, RTNLGRP_LINK},
+          {GROUP_IPV4_ADDRESS, RTNLGRP_IPV4_IFADDR},
+          {GROUP_IPV6_ADDRESS, RTNLGRP_IPV6_IFADDR},
+          {GROUP_IPV4_ROUTE, RTNLGRP_IPV4_ROUTE},
+          {GROUP_IPV6_ROUTE, RTNLGRP_IPV6_ROUTE}};
+      for (const auto &[bit, group] : groups) {
+        if ((options.groups & bit) == 0) {
+          continue;
+        }
+        if (setsockopt(monitorState.fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP,
+                       &group, sizeof(group)) < 0) {
+          setError("Failed to join netlink group " + std::to_string(group) +
+                   ": " + std::string(strerror(errno)));
+          closeMonitor();
+          return false;
+        }
+      }
 
-  bool NetlinkManager::isAvailable() const { return pImpl->netlinkSocket >= 0; }
+      // Reads drain until EAGAIN so a full batch never blocks the thread
+      int fl = fcntl(monitorState.fd, F_GETFL);
+      fcntl(monitorState.fd, F_SETFL, fl | O_NONBLOCK);
+      return true;
+    }
 
-  std::vector<NetlinkInterfaceInfo> NetlinkManager::getInterfaces() const {
-    std::vector<NetlinkInterfaceInfo> interfaces;
+    void closeMonitor() {
+      if (monitorReady) {
+        snl_free(&monitorState);
+        monitorReady = false;
+      }
+    }
 
-    if (!isAvailable()) {
-      return interfaces;
+    void decode(struct nlmsghdr *hdr, NetlinkEventBatch &batch) {
+      auto type = static_cast<NetlinkMessageType>(hdr->nlmsg_type);
+      switch (type) {
+      case NetlinkMessageType::NEWLINK:
+      case NetlinkMessageType::DELLINK: {
+        struct snl_parsed_link link = {};
+        if (snl_parse_nlmsg(&monitorState, hdr, &snl_rtm_link_parser, &link)) {
+          batch.links.push_back({type, toInfo(link)});
+        }
+        break;
+      }
+      case NetlinkMessageType::NEWADDR:
+      case NetlinkMessageType::DELADDR: {
+        struct snl_parsed_addr addr = {};
+        if (snl_parse_nlmsg(&monitorState, hdr, &snl_rtm_addr_parser, &addr)) {
+          NetlinkAddressEvent &event = batch.addresses.emplace_back();
+          event.type = type;
+          event.index = static_cast<int>(addr.ifa_index);
+          event.prefixLength = addr.ifa_prefixlen;
+          toAddress(addr.ifa_local ? addr.ifa_local : addr.ifa_address,
+                    event.address);
+        }
+        break;
+      }
+      case NetlinkMessageType::NEWROUTE:
+      case NetlinkMessageType::DELROUTE: {
+        struct snl_parsed_route route = {};
+        if (snl_parse_nlmsg(&monitorState, hdr, &snl_rtm_route_parser,
+                            &route)) {
+          NetlinkRouteEvent &event = batch.routes.emplace_back();
+          event.type = type;
+          event.table = route.rta_table;
+          event.index = static_cast<int>(route.rta_oif);
+          event.prefixLength = route.rtm_dst_len;
+          toAddress(route.rta_dst, event.destination);
+          const struct sockaddr *gw = route.rta_gw;
+          if (gw == nullptr && route.rta_multipath.num_nhops > 0) {
+            const struct rta_mpath_nh *nh = route.rta_multipath.nhops[0];
+            gw = nh->gw;
+            event.index = static_cast<int>(nh->ifindex);
+          }
+          toAddress(gw, event.gateway);
+        }
+        break;
+      }
+      default:
+        break;
+      }
     }
 
-    // For now, fall back to getifaddrs since netlink is complex
-    // This provides compatibility without full netlink implementation
-    struct ifaddrs *ifaddrs, *ifa;
+    void monitorLoop() {
+      using clock = std::chrono::steady_clock;
+      NetlinkEventBatch batch;
+      batch.routes.reserve(options.maxBatchSize);
+      clock::time_point deadline{};
+      bool backlog = false;
+
+      while (monitoring.load()) {
+        if (!backlog) {
+          struct timespec ts = {0, 100 * 1000 * 1000};
+          if (!batch.empty()) {
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - clock::now());
+            long ns = left.count() > 0 ? static_cast<long>(left.count()) : 0;
+            ts = {ns / 1000000000L, ns % 1000000000L};
+          }
+          struct pollfd pfd = {monitorState.fd, POLLIN, 0};
+          if (ppoll(&pfd, 1, &ts, nullptr) < 0 && errno != EINTR) {
+            setError("Netlink monitor poll failed: " +
+                     std::string(strerror(errno)));
+            break;
+          }
+        }
+
+        // Drain what is readable, stopping early once the batch is full;
+        // snl may still hold buffered messages, which the next pass reads
+        // without polling
+        backlog = false;
+        struct nlmsghdr *hdr;
+        while ((hdr = snl_read_message(&monitorState)) != nullptr) {
+          if (batch.empty()) {
+            deadline = clock::now() + options.maxLatency;
+          }
+          decode(hdr, batch);
+          if (batch.size() >= options.maxBatchSize) {
+            backlog = true;
+            break;
+          }
+        }
+        snl_clear_lb(&monitorState);
+
+        if (!batch.empty() && (batch.size() >= options.maxBatchSize ||
+                               clock::now() >= deadline)) {
+          batchCallback(batch);
+          batch.clear();
+        }
+      }
 
-    if (getifaddrs(&ifaddrs) != 0) {
-      return interfaces;
+      if (!batch.empty()) {
+        batchCallback(batch);
+      }
     }
 
-    for (ifa = ifaddrs; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_name && ifa->ifa_addr) {
-        NetlinkInterfaceInfo info;
-        info.name = std::string(ifa->ifa_name);
-        info.index = if_nametoindex(ifa->ifa_name);
-        info.flags = ifa->ifa_flags;
-        info.change = 0; // Not available via getifaddrs
+    // Hand the pending batch over; a callback that stops the monitor or
+    // re-enters finds an empty batch
+    void deliver() {
+      NetlinkEventBatch batch;
+      std::swap(batch, pendingBatch);
+      batchCallback(batch);
+      batch.clear();
+      if (pendingBatch.empty()) {
+        std::swap(batch, pendingBatch);
+      }
+    }
 
-        // Get interface type
-        int sock = socket(AF_INET, SOCK_DGRAM, 0);
-        if (sock >= 0) {
-          struct ifreq ifr;
-          std::memset(&ifr, 0, sizeof(ifr));
-          std::strncpy(ifr.ifr_name, ifa->ifa_name, IFNAMSIZ - 1);
+    void armTimer() {
+      if (timerArmed) {
+        return;
+      }
+      struct kevent change;
+      EV_SET(&change, monitorState.fd, EVFILT_TIMER, EV_ADD | EV_ONESHOT,
+             NOTE_USECONDS, options.maxLatency.count(), this);
+      if (kevent(monitorQueue, &change, 1, nullptr, 0, nullptr) == 0) {
+        timerArmed = true;
+      } else {
+        deliver();
+      }
+    }
 
-          if (ioctl(sock, SIOCGIFMTU, &ifr) == 0) {
-            info.mtu = ifr.ifr_mtu;
-          } else {
-            info.mtu = 1500; // Default
-          }
+    // Timers outlive the descriptor their ident names, so remove them
+    void disarmTimer() {
+      if (timerArmed) {
+        struct kevent change;
+        EV_SET(&change, monitorState.fd, EVFILT_TIMER, EV_DELETE, 0, 0,
+               nullptr);
+        kevent(monitorQueue, &change, 1, nullptr, 0, nullptr);
+        timerArmed = false;
+      }
+    }
 
-          close(sock);
-        } else {
-          info.mtu = 1500; // Default
+    void drainMonitor() {
+      struct nlmsghdr *hdr;
+      while (monitorReady &&
+             (hdr = snl_read_message(&monitorState)) != nullptr) {
+        decode(hdr, pendingBatch);
+        if (pendingBatch.size() >= options.maxBatchSize) {
+          deliver();
         }
+      }
+      if (!monitorReady) {
+        return;
+      }
+      snl_clear_lb(&monitorState);
+      if (!pendingBatch.empty()) {
+        armTimer();
+      }
+    }
 
-        // Get hardware address
-        if (ifa->ifa_addr->sa_family == AF_LINK) {
-          struct sockaddr_dl *sdl =
-              reinterpret_cast<struct sockaddr_dl *>(ifa->ifa_addr);
-          if (sdl->sdl_alen > 0) {
-            char macStr[18];
-            unsigned char *addr =
-                reinterpret_cast<unsigned char *>(LLADDR(sdl));
-            std::snprintf(macStr, sizeof(macStr),
-                          "%02x:%02x:%02x:%02x:%02x:%02x", addr[0], addr[1],
-                          addr[2], addr[3], addr[4], addr[5]);
-            info.hardwareAddress = std::string(macStr);
-          }
+    static std::string operstateToString(uint8_t operstate) {
+      switch (operstate) {
+      case IF_OPER_UP:
+        return "UP";
+      case IF_OPER_DOWN:
+        return "DOWN";
+      case IF_OPER_LOWERLAYERDOWN:
+        return "LOWERLAYERDOWN";
+      case IF_OPER_DORMANT:
+        return "DORMANT";
+      case IF_OPER_TESTING:
+        return "TESTING";
+      case IF_OPER_NOTPRESENT:
+        return "NOTPRESENT";
+      default:
+        return "UNKNOWN";
+      }
+    }
+
+    static NetlinkInterfaceInfo toInfo(const struct snl_parsed_link &link) {
+      NetlinkInterfaceInfo info{};
+      info.name = link.ifla_ifname ? link.ifla_ifname : "";
+      info.index = static_cast<int>(link.ifi_index);
+      info.type = link.ifi_type;
+      info.flags = link.ifi_flags;
+      info.change = link.ifi_change;
+      info.mtu = static_cast<int>(link.ifla_mtu);
+      info.operstate = operstateToString(link.ifla_operstate);
+
+      if (link.ifla_address) {
+        const uint8_t *addr =
+            static_cast<const uint8_t *>(NLA_DATA(link.ifla_address));
+        size_t len = NLA_DATA_LEN(link.ifla_address);
+        char octet[4];
+        for (size_t i = 0; i < len; ++i) {
+          std::snprintf(octet, sizeof(octet), i ? ":%02x" : "%02x", addr[i]);
+          info.hardwareAddress += octet;
         }
+      }
+      return info;
+    }
 
-        // Determine interface type
-        if (ifa->ifa_flags & IFF_LOOPBACK) {
-          info.type = IFT_LOOP;
-        } else if (ifa->ifa_flags & IFF_POINTOPOINT) {
-          info.type = IFT_PPP;
-        } else {
-          info.type = IFT_ETHER;
+    static struct nlmsghdr *buildLinkRequest(struct snl_writer &nw,
+                                             bool dump, int index,
+                                             const char *name) {
+      struct nlmsghdr *hdr = snl_create_msg_request(&nw, RTM_GETLINK);
+      if (hdr == nullptr) {
+        return nullptr;
+      }
+      if (dump) {
+        hdr->nlmsg_flags |= NLM_F_DUMP;
+      }
+      struct ifinfomsg *ifi = snl_reserve_msg_object(&nw, struct ifinfomsg);
+      if (ifi != nullptr) {
+        ifi->ifi_index = index;
+      }
+      if (name != nullptr) {
+        snl_add_msg_attr_string(&nw, IFLA_IFNAME, name);
+      }
+      return snl_finalize_msg(&nw);
+    }
+
+    /**
+     * @brief Issue RTM_GETLINK and collect the replies
+     * @param dump true for a full NLM_F_DUMP, false for a targeted lookup
+     * @param index Interface index to match (0 for none)
+     * @param name Interface name to match (nullptr for none)
+     * @return Parsed link records
+     */
+    std::vector<NetlinkInterfaceInfo> requestLinks(bool dump, int index,
+                                                   const char *name) {
+      std::vector<NetlinkInterfaceInfo> links;
+      std::lock_guard<std::mutex> lock(requestMutex);
+
+      if (!snlReady) {
+        setError("Netlink request state not initialized");
+        return links;
+      }
+
+      struct snl_writer nw;
+      snl_init_writer(&ss, &nw);
+      struct nlmsghdr *hdr = buildLinkRequest(nw, dump, index, name);
+      if (hdr == nullptr || !snl_send_message(&ss, hdr)) {
+        setError("Failed to send RTM_GETLINK request: " +
+                 std::string(strerror(errno)));
+        snl_clear_lb(&ss);
+        return links;
+      }
+      uint32_t seq = hdr->nlmsg_seq;
+
+      if (dump) {
+        struct snl_errmsg_data e = {};
+        while ((hdr = snl_read_reply_multi(&ss, seq, &e)) != nullptr) {
+          struct snl_parsed_link link = {};
+          if (snl_parse_nlmsg(&ss, hdr, &snl_rtm_link_parser, &link)) {
+            links.push_back(toInfo(link));
+          }
         }
+        if (e.error != 0) {
+          setError("RTM_GETLINK dump failed: " +
+                   std::string(strerror(e.error)));
+        }
+      } else {
+        // A targeted request is answered by exactly one message: the link or
+        // an error
+        hdr = snl_read_reply(&ss, seq);
+        if (hdr != nullptr && hdr->nlmsg_type != NLMSG_ERROR) {
+          struct snl_parsed_link link = {};
+          if (snl_parse_nlmsg(&ss, hdr, &snl_rtm_link_parser, &link)) {
+            links.push_back(toInfo(link));
+          }
+        } else if (hdr != nullptr) {
+          struct snl_errmsg_data e = {};
+          snl_parse_errmsg(&ss, hdr, &e);
+          setError("RTM_GETLINK failed: " + std::string(strerror(e.error)));
+        }
+      }
+
+      // Parsed strings live in the snl arena; release it for the next request
+      snl_clear_lb(&ss);
+      return links;
+    }
+
+    bool submitLinks(bool dump, const char *name,
+                     NetlinkLinksCallback callback) {
+      if (asyncQueue < 0) {
+        setError("Netlink manager is not attached to a kqueue");
+        return false;
+      }
+      struct snl_writer nw;
+      snl_init_writer(&asyncState, &nw);
+      struct nlmsghdr *hdr = buildLinkRequest(nw, dump, 0, name);
+      bool sent = hdr != nullptr && snl_send_message(&asyncState, hdr);
+      if (!sent) {
+        setError("Failed to send RTM_GETLINK request: " +
+                 std::string(strerror(errno)));
+      } else {
+        pendingLinks.emplace(hdr->nlmsg_seq,
+                             PendingLinks{std::move(callback), {}, dump});
+      }
+      snl_clear_lb(&asyncState);
+      return sent;
+    }
+
+    void finishLinks(uint32_t seq, int error) {
+      auto it = pendingLinks.find(seq);
+      if (it == pendingLinks.end()) {
+        return;
+      }
+      PendingLinks request = std::move(it->second);
+      pendingLinks.erase(it);
+      if (request.callback) {
+        request.callback(error, request.links);
+      }
+    }
 
-        // Determine operational state
-        if (ifa->ifa_flags & IFF_UP) {
-          info.operstate = "UP";
+    void collectLinks() {
+      struct nlmsghdr *hdr;
+      while ((hdr = snl_read_message(&asyncState)) != nullptr) {
+        auto it = pendingLinks.find(hdr->nlmsg_seq);
+        if (it == pendingLinks.end()) {
+          continue;
+        }
+        if (hdr->nlmsg_type == NLMSG_ERROR) {
+          struct snl_errmsg_data e = {};
+          snl_parse_errmsg(&asyncState, hdr, &e);
+          finishLinks(hdr->nlmsg_seq, std::abs(e.error));
+        } else if (hdr->nlmsg_type == NLMSG_DONE) {
+          int error = 0;
+          if (hdr->nlmsg_len >= NLMSG_LENGTH(sizeof(error))) {
+            std::memcpy(&error, NLMSG_DATA(hdr), sizeof(error));
+          }
+          finishLinks(hdr->nlmsg_seq, std::abs(error));
         } else {
-          info.operstate = "DOWN";
+          struct snl_parsed_link link = {};
+          if (snl_parse_nlmsg(&asyncState, hdr, &snl_rtm_link_parser,
+                              &link)) {
+            it->second.links.push_back(toInfo(link));
+          }
+          if (!it->second.dump) {
+            finishLinks(hdr->nlmsg_seq, 0);
+          }
+        }
+      }
+      int error = errno;
+      snl_clear_lb(&asyncState);
+      if (error != 0 && error != EAGAIN && error != EWOULDBLOCK &&
+          !pendingLinks.empty()) {
+        // Replies were dropped; nothing outstanding will complete
+        setError("Netlink replies lost: " + std::string(strerror(error)));
+        auto requests = std::move(pendingLinks);
+        pendingLinks.clear();
+        for (auto &[seq, request] : requests) {
+          if (request.callback) {
+            request.callback(error, request.links);
+          }
         }
-
-        interfaces.push_back(info);
       }
     }
+  };
 
-    freeifaddrs(ifaddrs);
-    return interfaces;
-  }
+  NetlinkManager::NetlinkManager() : pImpl(std::make_unique<Impl>()) {}
 
-  NetlinkInterfaceInfo
-  NetlinkManager::getInterface(const std::string &name) const {
-    NetlinkInterfaceInfo info;
+  NetlinkManager::~NetlinkManager() = default;
 
+  bool NetlinkManager::isAvailable() const { return pImpl->ready(); }
+
+  std::vector<NetlinkInterfaceInfo> NetlinkManager::getInterfaces() const {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::getInterfaces");
     if (!isAvailable()) {
-      return info;
+      return {};
     }
 
-    auto interfaces = getInterfaces();
-    for (const auto &iface : interfaces) {
-      if (iface.name == name) {
-        return iface;
-      }
+    return pImpl->requestLinks(true, 0, nullptr);
+  }
+
+  NetlinkInterfaceInfo
+  NetlinkManager::getInterface(const std::string &name) const {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::getInterface");
+    if (!isAvailable() || name.empty()) {
+      return NetlinkInterfaceInfo{};
     }
 
-    return info;
+    auto links = pImpl->requestLinks(false, 0, name.c_str());
+    return links.empty() ? NetlinkInterfaceInfo{} : links.front();
   }
 
   NetlinkInterfaceInfo NetlinkManager::getInterface(int index) const {
-    NetlinkInterfaceInfo info;
-
-    if (!isAvailable()) {
-      return info;
-    }
-
-    auto interfaces = getInterfaces();
-    for (const auto &iface : interfaces) {
-      if (iface.index == index) {
-        return iface;
-      }
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::getInterface(index)");
+    if (!isAvailable() || index <= 0) {
+      return NetlinkInterfaceInfo{};
     }
 
-    return info;
+    auto links = pImpl->requestLinks(false, index, nullptr);
+    return links.empty() ? NetlinkInterfaceInfo{} : links.front();
   }
 
   bool NetlinkManager::setInterfaceFlags(const std::string &name,
                                          uint32_t flags) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::setInterfaceFlags");
     if (!isAvailable()) {
-      pImpl->lastError = "Netlink not available";
+      pImpl->setError("Netlink not available");
       return false;
     }
 
     // For now, fall back to ioctl since netlink is complex
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = interface::ControlSocket::get(AF_INET);
     if (sock < 0) {
-      pImpl->lastError = "Failed to create socket";
+      pImpl->setError("Failed to create socket: " +
+                      std::string(strerror(errno)));
       return false;
     }
 
@@ -206,27 +605,26 @@ namespace libfreebsdnet::netlink {
     std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_flags = flags;
 
-    if (ioctl(sock, SIOCSIFFLAGS, &ifr) < 0) {
-      pImpl->lastError =
-          "Failed to set interface flags: " + std::string(strerror(errno));
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFFLAGS, &ifr) < 0) {
+      pImpl->setError("Failed to set interface flags: " +
+                      std::string(strerror(errno)));
       return false;
     }
-
-    close(sock);
     return true;
   }
 
   bool NetlinkManager::setInterfaceMtu(const std::string &name, int mtu) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::setInterfaceMtu");
     if (!isAvailable()) {
-      pImpl->lastError = "Netlink not available";
+      pImpl->setError("Netlink not available");
       return false;
     }
 
     // For now, fall back to ioctl since netlink is complex
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int sock = interface::ControlSocket::get(AF_INET);
     if (sock < 0) {
-      pImpl->lastError = "Failed to create socket";
+      pImpl->setError("Failed to create socket: " +
+                      std::string(strerror(errno)));
       return false;
     }
 
@@ -235,39 +633,130 @@ namespace libfreebsdnet::netlink {
     std::strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_mtu = mtu;
 
-    if (ioctl(sock, SIOCSIFMTU, &ifr) < 0) {
-      pImpl->lastError =
-          "Failed to set interface MTU: " + std::string(strerror(errno));
-      close(sock);
+    if (metrics::tracedIoctl(sock, SIOCSIFMTU, &ifr) < 0) {
+      pImpl->setError("Failed to set interface MTU: " +
+                      std::string(strerror(errno)));
       return false;
     }
-
-    close(sock);
     return true;
   }
 
+  std::string NetlinkAddress::toString() const {
+    char buf[INET6_ADDRSTRLEN];
+    if (family == 0 ||
+        inet_ntop(family, bytes.data(), buf, sizeof(buf)) == nullptr) {
+      return "";
+    }
+    return buf;
+  }
+
   bool NetlinkManager::startMonitoring(const NetlinkCallback &callback) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::startMonitoring");
+    // Checked here because the adapter below is never empty, and the
+    // callback must not be replaced under a running monitor thread
     if (!isAvailable()) {
-      pImpl->lastError = "Netlink not available";
+      pImpl->setError("Netlink not available");
+      return false;
+    }
+    if (pImpl->monitoring.load()) {
+      pImpl->setError("Already monitoring");
+      return false;
+    }
+    if (!callback) {
+      pImpl->setError("No monitor callback supplied");
+      return false;
+    }
+    pImpl->callback = callback;
+
+    NetlinkMonitorOptions options;
+    options.groups = GROUP_LINK;
+    return startMonitoring(
+        [this](const NetlinkEventBatch &batch) {
+          for (const auto &event : batch.links) {
+            pImpl->callback(event.info);
+          }
+        },
+        options);
+  }
+
+  bool NetlinkManager::startMonitoring(const NetlinkBatchCallback &callback,
+                                       const NetlinkMonitorOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::startMonitoring(batch)");
+    if (!isAvailable()) {
+      pImpl->setError("Netlink not available");
       return false;
     }
 
     if (pImpl->monitoring.load()) {
-      pImpl->lastError = "Already monitoring";
+      pImpl->setError("Already monitoring");
+      return false;
+    }
+
+    if (!callback) {
+      pImpl->setError("No monitor callback supplied");
+      return false;
+    }
+
+    pImpl->batchCallback = callback;
+    pImpl->options = options;
+    if (pImpl->options.maxBatchSize == 0) {
+      pImpl->options.maxBatchSize = 1;
+    }
+    if (!pImpl->openMonitor()) {
       return false;
     }
 
-    pImpl->callback = callback;
     pImpl->monitoring.store(true);
+    pImpl->monitorThread = std::thread([impl = pImpl.get()] {
+      impl->monitorLoop();
+    });
+    return true;
+  }
+
+  bool NetlinkManager::startMonitoring(int kq,
+                                       const NetlinkBatchCallback &callback,
+                                       const NetlinkMonitorOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::startMonitoring(kqueue)");
+    if (!isAvailable()) {
+      pImpl->setError("Netlink not available");
+      return false;
+    }
 
-    // For now, monitoring is not implemented
-    // This would require complex netlink message parsing
-    pImpl->lastError =
-        "Netlink monitoring not implemented - requires complex message parsing";
-    return false;
+    if (pImpl->monitoring.load()) {
+      pImpl->setError("Already monitoring");
+      return false;
+    }
+
+    if (!callback) {
+      pImpl->setError("No monitor callback supplied");
+      return false;
+    }
+
+    pImpl->batchCallback = callback;
+    pImpl->options = options;
+    if (pImpl->options.maxBatchSize == 0) {
+      pImpl->options.maxBatchSize = 1;
+    }
+    if (!pImpl->openMonitor()) {
+      return false;
+    }
+
+    struct kevent change;
+    EV_SET(&change, pImpl->monitorState.fd, EVFILT_READ, EV_ADD, 0, 0,
+           pImpl.get());
+    if (kevent(kq, &change, 1, nullptr, 0, nullptr) < 0) {
+      pImpl->setError("Failed to register monitor with kqueue: " +
+                      std::string(strerror(errno)));
+      pImpl->closeMonitor();
+      return false;
+    }
+    pImpl->monitorQueue = kq;
+    pImpl->monitoring.store(true);
+    return true;
   }
 
   bool NetlinkManager::stopMonitoring() {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::stopMonitoring");
     if (!pImpl->monitoring.load()) {
       return true;
     }
@@ -277,10 +766,92 @@ namespace libfreebsdnet::netlink {
     if (pImpl->monitorThread.joinable()) {
       pImpl->monitorThread.join();
     }
+    if (pImpl->monitorQueue >= 0) {
+      pImpl->disarmTimer();
+      if (!pImpl->pendingBatch.empty()) {
+        pImpl->deliver();
+      }
+      pImpl->monitorQueue = -1;
+    }
+    pImpl->closeMonitor();
 
     return true;
   }
 
-  std::string NetlinkManager::getLastError() const { return pImpl->lastError; }
+  bool NetlinkManager::attach(int kq) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::attach");
+    if (!isAvailable()) {
+      pImpl->setError("Netlink not available");
+      return false;
+    }
+    if (!pImpl->asyncReady) {
+      if (!snl_init(&pImpl->asyncState, NETLINK_ROUTE)) {
+        pImpl->setError("Failed to initialize netlink request socket");
+        return false;
+      }
+      pImpl->asyncReady = true;
+      int fl = fcntl(pImpl->asyncState.fd, F_GETFL);
+      fcntl(pImpl->asyncState.fd, F_SETFL, fl | O_NONBLOCK);
+    }
+
+    struct kevent change;
+    EV_SET(&change, pImpl->asyncState.fd, EVFILT_READ, EV_ADD, 0, 0,
+           pImpl.get());
+    if (kevent(kq, &change, 1, nullptr, 0, nullptr) < 0) {
+      pImpl->setError("Failed to register with kqueue: " +
+                      std::string(strerror(errno)));
+      return false;
+    }
+    pImpl->asyncQueue = kq;
+    return true;
+  }
+
+  bool NetlinkManager::requestInterfaces(NetlinkLinksCallback callback) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::requestInterfaces");
+    return pImpl->submitLinks(true, nullptr, std::move(callback));
+  }
+
+  bool NetlinkManager::requestInterface(const std::string &name,
+                                        NetlinkLinksCallback callback) {
+    LIBFREEBSDNET_METRICS_OPERATION("NetlinkManager::requestInterface");
+    if (name.empty()) {
+      pImpl->setError("No interface name supplied");
+      return false;
+    }
+    return pImpl->submitLinks(false, name.c_str(), std::move(callback));
+  }
+
+  bool NetlinkManager::handleEvent(const struct kevent &event) {
+    if (event.udata != pImpl.get()) {
+      return false;
+    }
+    if (pImpl->asyncReady && event.filter == EVFILT_READ &&
+        event.ident == static_cast<uintptr_t>(pImpl->asyncState.fd)) {
+      pImpl->collectLinks();
+      return true;
+    }
+    if (pImpl->monitorQueue < 0 || !pImpl->monitorReady ||
+        event.ident != static_cast<uintptr_t>(pImpl->monitorState.fd)) {
+      return false;
+    }
+    if (event.filter == EVFILT_READ) {
+      pImpl->drainMonitor();
+    } else if (event.filter == EVFILT_TIMER) {
+      pImpl->timerArmed = false;
+      if (!pImpl->pendingBatch.empty()) {
+        pImpl->deliver();
+      }
+    }
+    return true;
+  }
+
+  size_t NetlinkManager::getPendingRequests() const {
+    return pImpl->pendingLinks.size();
+  }
+
+  std::string NetlinkManager::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->errorMutex);
+    return pImpl->lastError;
+  }
 
 } // namespace libfreebsdnet::netlink
@@ -0,0 +1,606 @@
+/**
+ * @file routing/batch.cpp
+ * @brief Batched route installation implementation
+ * @details Writes windows of netlink route requests with one send each and
+ * matches acknowledgements by sequence number; the asynchronous batch does
+ * the same from a caller's kqueue
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netlink/netlink.h>
+#include <netlink/netlink_route.h>
+#include <netlink/netlink_snl.h>
+#include <netlink/netlink_snl_route.h>
+#include <routing/batch.hpp>
+#include <routing/entry.hpp>
+#include <routing/neighbor.hpp>
+#include <sys/event.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unordered_map>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    union SockAddr {
+      struct sockaddr sa;
+      struct sockaddr_in sin;
+      struct sockaddr_in6 sin6;
+    };
+
+    // Parse "addr" or "addr%ifname" into a sockaddr of the given family
+    bool toSockaddr(const std::string &text, int family, SockAddr &out) {
+      std::memset(&out, 0, sizeof(out));
+      std::string ip = text;
+      std::string zone;
+      size_t percent = text.find('%');
+      if (percent != std::string::npos) {
+        ip = text.substr(0, percent);
+        zone = text.substr(percent + 1);
+      }
+      if (family == AF_INET) {
+        out.sin.sin_len = sizeof(out.sin);
+        out.sin.sin_family = AF_INET;
+        return zone.empty() &&
+               inet_pton(AF_INET, ip.c_str(), &out.sin.sin_addr) == 1;
+      }
+      out.sin6.sin6_len = sizeof(out.sin6);
+      out.sin6.sin6_family = AF_INET6;
+      if (inet_pton(AF_INET6, ip.c_str(), &out.sin6.sin6_addr) != 1) {
+        return false;
+      }
+      if (!zone.empty()) {
+        out.sin6.sin6_scope_id = if_nametoindex(zone.c_str());
+        return out.sin6.sin6_scope_id != 0;
+      }
+      return true;
+    }
+
+    // Clear host bits so the kernel sees a canonical network address
+    void maskAddress(SockAddr &addr, int prefixLength) {
+      uint8_t *bytes;
+      int size;
+      if (addr.sa.sa_family == AF_INET) {
+        bytes = reinterpret_cast<uint8_t *>(&addr.sin.sin_addr);
+        size = 4;
+      } else {
+        bytes = addr.sin6.sin6_addr.s6_addr;
+        size = 16;
+      }
+      for (int i = 0; i < size; ++i) {
+        int keep = std::clamp(prefixLength - i * 8, 0, 8);
+        bytes[i] &= static_cast<uint8_t>(0xff00 >> keep);
+      }
+    }
+
+    uint8_t routeType(uint32_t flags) {
+      if (flags & static_cast<uint32_t>(RouteFlag::BLACKHOLE)) {
+        return RTN_BLACKHOLE;
+      }
+      if (flags & static_cast<uint32_t>(RouteFlag::REJECT)) {
+        return RTN_PROHIBIT;
+      }
+      return RTN_UNICAST;
+    }
+
+    // Append one request to the writer; returns an errno value and leaves
+    // the writer untouched if the route is invalid. createFlags are the
+    // NLM_F_CREATE/EXCL/REPLACE bits for new routes.
+    int encode(struct snl_writer &nw, int type, const RouteSpec &spec,
+               uint32_t &seq, uint16_t createFlags) {
+      if (!spec.destination.isValid()) {
+        return EINVAL;
+      }
+      int family = spec.destination.isIPv4() ? AF_INET : AF_INET6;
+      int prefixLength = spec.destination.getPrefixLength();
+
+      SockAddr dst;
+      std::memset(&dst, 0, sizeof(dst));
+      if (family == AF_INET) {
+        dst.sin = spec.destination.getSockaddrIn();
+      } else {
+        dst.sin6 = spec.destination.getSockaddrIn6();
+      }
+      maskAddress(dst, prefixLength);
+
+      SockAddr gw;
+      bool hasGateway = !spec.gateway.empty();
+      if (hasGateway && !toSockaddr(spec.gateway, family, gw)) {
+        return EINVAL;
+      }
+
+      unsigned int ifindex = 0;
+      if (!spec.interface.empty()) {
+        ifindex = if_nametoindex(spec.interface.c_str());
+        if (ifindex == 0) {
+          return ENXIO;
+        }
+      }
+      if (spec.fib < 0) {
+        return EINVAL;
+      }
+
+      struct nlmsghdr *hdr = snl_create_msg_request(&nw, type);
+      if (!hdr) {
+        return ENOMEM;
+      }
+      hdr->nlmsg_flags |= NLM_F_ACK | createFlags;
+
+      struct rtmsg *rtm = snl_reserve_msg_object(&nw, struct rtmsg);
+      if (!rtm) {
+        return ENOMEM;
+      }
+      rtm->rtm_family = family;
+      rtm->rtm_dst_len = prefixLength;
+      rtm->rtm_table = RT_TABLE_UNSPEC;
+      rtm->rtm_protocol = RTPROT_STATIC;
+      rtm->rtm_scope = RT_SCOPE_UNIVERSE;
+      rtm->rtm_type = routeType(spec.flags);
+
+      snl_add_msg_attr_ip(&nw, NL_RTA_DST, &dst.sa);
+      if (hasGateway) {
+        snl_add_msg_attr_ip(&nw, NL_RTA_GATEWAY, &gw.sa);
+      }
+      if (ifindex != 0) {
+        snl_add_msg_attr_u32(&nw, NL_RTA_OIF, ifindex);
+      }
+      snl_add_msg_attr_u32(&nw, NL_RTA_TABLE, static_cast<uint32_t>(spec.fib));
+
+      // Later messages may move the writer buffer; keep only the sequence
+      hdr = snl_finalize_msg(&nw);
+      if (!hdr) {
+        return ENOMEM;
+      }
+      seq = hdr->nlmsg_seq;
+      return 0;
+    }
+
+    // Append one neighbor request, as encode() does for routes
+    int encode(struct snl_writer &nw, int type, const NeighborSpec &spec,
+               uint32_t &seq, uint16_t createFlags) {
+      if (!spec.address.isValid() || spec.interface.empty()) {
+        return EINVAL;
+      }
+      int family = spec.address.isIPv4() ? AF_INET : AF_INET6;
+      if (spec.address.getPrefixLength() != (family == AF_INET ? 32 : 128)) {
+        return EINVAL;
+      }
+      if (type == RTM_NEWNEIGH && !spec.mac.isValid()) {
+        return EINVAL;
+      }
+      unsigned int ifindex = if_nametoindex(spec.interface.c_str());
+      if (ifindex == 0) {
+        return ENXIO;
+      }
+
+      SockAddr dst;
+      std::memset(&dst, 0, sizeof(dst));
+      if (family == AF_INET) {
+        dst.sin = spec.address.getSockaddrIn();
+      } else {
+        dst.sin6 = spec.address.getSockaddrIn6();
+      }
+
+      struct nlmsghdr *hdr = snl_create_msg_request(&nw, type);
+      if (!hdr) {
+        return ENOMEM;
+      }
+      hdr->nlmsg_flags |= NLM_F_ACK | createFlags;
+
+      struct ndmsg *ndm = snl_reserve_msg_object(&nw, struct ndmsg);
+      if (!ndm) {
+        return ENOMEM;
+      }
+      ndm->ndm_family = family;
+      ndm->ndm_ifindex = ifindex;
+      ndm->ndm_state = NUD_PERMANENT;
+
+      snl_add_msg_attr_ip(&nw, NDA_DST, &dst.sa);
+      if (type == RTM_NEWNEIGH) {
+        auto bytes = spec.mac.getBytes();
+        snl_add_msg_attr(&nw, NDA_LLADDR, bytes.size(), bytes.data());
+      }
+
+      hdr = snl_finalize_msg(&nw);
+      if (!hdr) {
+        return ENOMEM;
+      }
+      seq = hdr->nlmsg_seq;
+      return 0;
+    }
+
+  } // namespace
+
+  class RouteBatch::Impl {
+  public:
+    struct snl_state ss{};
+    bool ready = false;
+    std::string lastError;
+
+    ~Impl() {
+      if (ready) {
+        snl_free(&ss);
+      }
+    }
+
+    bool open(const RouteBatchOptions &options) {
+      if (!ready) {
+        if (!snl_init(&ss, NETLINK_ROUTE)) {
+          lastError =
+              "Failed to open netlink socket: " + std::string(strerror(errno));
+          return false;
+        }
+        ready = true;
+        // Each ack echoes the request header; make room for a full window
+        int rcvbuf = 1024 * 1024;
+        setsockopt(ss.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+      }
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    options.timeout)
+                    .count();
+      struct timeval tv = {static_cast<time_t>(us / 1000000),
+                           static_cast<suseconds_t>(us % 1000000)};
+      setsockopt(ss.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      return true;
+    }
+
+    void collect(std::unordered_map<uint32_t, size_t> &pending,
+                 std::vector<RouteResult> &results) {
+      while (!pending.empty()) {
+        struct nlmsghdr *hdr = snl_read_message(&ss);
+        if (!hdr) {
+          int error = errno == EAGAIN || errno == 0 ? ETIMEDOUT : errno;
+          lastError = "Route batch acknowledgement failed: " +
+                      std::string(strerror(error));
+          for (const auto &[seq, slot] : pending) {
+            results[slot].error = error;
+          }
+          pending.clear();
+          return;
+        }
+        auto it = pending.find(hdr->nlmsg_seq);
+        if (it == pending.end() || hdr->nlmsg_type != NLMSG_ERROR) {
+          continue;
+        }
+        struct snl_errmsg_data e = {};
+        results[it->second].error =
+            snl_parse_errmsg(&ss, hdr, &e) ? std::abs(e.error) : EPROTO;
+        pending.erase(it);
+      }
+    }
+
+    template <typename Spec>
+    std::vector<RouteResult> run(int type, uint16_t createFlags,
+                                 std::span<const Spec> routes,
+                                 const RouteBatchOptions &options) {
+      std::vector<RouteResult> results(routes.size());
+      if (!open(options)) {
+        for (auto &result : results) {
+          result.error = ENOTCONN;
+        }
+        return results;
+      }
+
+      size_t window = std::max<size_t>(options.window, 1);
+      std::unordered_map<uint32_t, size_t> pending;
+      pending.reserve(window);
+
+      for (size_t first = 0; first < routes.size(); first += window) {
+        size_t last = std::min(routes.size(), first + window);
+        struct snl_writer nw;
+        snl_init_writer(&ss, &nw);
+
+        for (size_t i = first; i < last; ++i) {
+          uint32_t seq = 0;
+          results[i].error = encode(nw, type, routes[i], seq, createFlags);
+          if (results[i].error == 0) {
+            pending.emplace(seq, i);
+          }
+        }
+
+        if (nw.error) {
+          lastError = "Failed to build route batch";
+          for (const auto &[seq, slot] : pending) {
+            results[slot].error = ENOMEM;
+          }
+          pending.clear();
+        } else if (!pending.empty() &&
+                   !snl_send(&ss, nw.base, static_cast<int>(nw.offset))) {
+          int error = errno;
+          lastError = "Failed to send route batch: " +
+                      std::string(strerror(error));
+          for (const auto &[seq, slot] : pending) {
+            results[slot].error = error;
+          }
+          pending.clear();
+        } else {
+          collect(pending, results);
+        }
+        snl_clear_lb(&ss);
+      }
+      return results;
+    }
+  };
+
+  RouteBatch::RouteBatch() : pImpl(std::make_unique<Impl>()) {}
+
+  RouteBatch::~RouteBatch() = default;
+
+  std::vector<RouteResult> RouteBatch::add(std::span<const RouteSpec> routes,
+                                           const RouteBatchOptions &options) {
+    return pImpl->run(RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, routes,
+                      options);
+  }
+
+  std::vector<RouteResult>
+  RouteBatch::remove(std::span<const RouteSpec> routes,
+                     const RouteBatchOptions &options) {
+    return pImpl->run(RTM_DELROUTE, 0, routes, options);
+  }
+
+  std::vector<RouteResult>
+  RouteBatch::change(std::span<const RouteSpec> routes,
+                     const RouteBatchOptions &options) {
+    return pImpl->run(RTM_NEWROUTE, NLM_F_REPLACE, routes, options);
+  }
+
+  std::vector<RouteResult>
+  RouteBatch::addNeighbors(std::span<const NeighborSpec> neighbors,
+                           const RouteBatchOptions &options) {
+    return pImpl->run(RTM_NEWNEIGH, NLM_F_CREATE | NLM_F_REPLACE, neighbors,
+                      options);
+  }
+
+  std::vector<RouteResult>
+  RouteBatch::removeNeighbors(std::span<const NeighborSpec> neighbors,
+                              const RouteBatchOptions &options) {
+    return pImpl->run(RTM_DELNEIGH, 0, neighbors, options);
+  }
+
+  std::string RouteBatch::getLastError() const { return pImpl->lastError; }
+
+  class AsyncRouteBatch::Impl {
+  public:
+    // Queued requests are written in sends of at most this many bytes, and
+    // written right away once this many are queued
+    static constexpr size_t MAX_SEND = 64 * 1024;
+
+    struct snl_state ss{};
+    bool ready = false;
+    int kq = -1;
+    bool writeArmed = false;
+    std::vector<char> outbound; // encoded requests not yet sent
+    size_t written = 0;         // bytes of outbound already sent
+    std::unordered_map<uint32_t, RouteCompletion> pending;
+    std::string lastError;
+
+    ~Impl() {
+      if (ready) {
+        snl_free(&ss);
+      }
+    }
+
+    bool attach(int queue) {
+      if (!ready) {
+        if (!snl_init(&ss, NETLINK_ROUTE)) {
+          lastError =
+              "Failed to open netlink socket: " + std::string(strerror(errno));
+          return false;
+        }
+        ready = true;
+        int rcvbuf = 1024 * 1024;
+        setsockopt(ss.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        int fl = fcntl(ss.fd, F_GETFL);
+        fcntl(ss.fd, F_SETFL, fl | O_NONBLOCK);
+      }
+      struct kevent change;
+      EV_SET(&change, ss.fd, EVFILT_READ, EV_ADD, 0, 0, this);
+      if (kevent(queue, &change, 1, nullptr, 0, nullptr) < 0) {
+        lastError = "Failed to register with kqueue: " +
+                    std::string(strerror(errno));
+        return false;
+      }
+      kq = queue;
+      writeArmed = false;
+      if (written < outbound.size()) {
+        arm();
+      }
+      return true;
+    }
+
+    // Ask for one write event, which flushes everything queued until then
+    void arm() {
+      if (writeArmed) {
+        return;
+      }
+      struct kevent change;
+      EV_SET(&change, ss.fd, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, this);
+      if (kevent(kq, &change, 1, nullptr, 0, nullptr) == 0) {
+        writeArmed = true;
+      } else {
+        flush();
+      }
+    }
+
+    void complete(uint32_t seq, int error) {
+      auto it = pending.find(seq);
+      if (it == pending.end()) {
+        return;
+      }
+      RouteCompletion completion = std::move(it->second);
+      pending.erase(it);
+      if (completion) {
+        completion(RouteResult{error});
+      }
+    }
+
+    void completeAll(int error) {
+      auto completions = std::move(pending);
+      pending.clear();
+      outbound.clear();
+      written = 0;
+      for (auto &[seq, completion] : completions) {
+        if (completion) {
+          completion(RouteResult{error});
+        }
+      }
+    }
+
+    bool submit(int type, const RouteSpec &route, RouteCompletion completion) {
+      if (kq < 0) {
+        lastError = "Route batch is not attached to a kqueue";
+        return false;
+      }
+      struct snl_writer nw;
+      snl_init_writer(&ss, &nw);
+      uint32_t seq = 0;
+      int error = encode(nw, type, route, seq,
+                         type == RTM_NEWROUTE ? NLM_F_CREATE | NLM_F_EXCL : 0);
+      if (error == 0 && nw.error) {
+        error = ENOMEM;
+      }
+      if (error == 0) {
+        outbound.insert(outbound.end(), nw.base, nw.base + nw.offset);
+      }
+      snl_clear_lb(&ss);
+      if (error != 0) {
+        lastError = "Invalid route request: " + std::string(strerror(error));
+        return false;
+      }
+      pending.emplace(seq, std::move(completion));
+      if (outbound.size() - written >= MAX_SEND) {
+        flush();
+      } else {
+        arm();
+      }
+      return true;
+    }
+
+    void flush() {
+      while (written < outbound.size()) {
+        // Cut on message boundaries; netlink takes whole datagrams
+        size_t chunk = 0;
+        while (written + chunk < outbound.size()) {
+          struct nlmsghdr hdr;
+          std::memcpy(&hdr, outbound.data() + written + chunk, sizeof(hdr));
+          size_t length = NLMSG_ALIGN(hdr.nlmsg_len);
+          if (chunk > 0 && chunk + length > MAX_SEND) {
+            break;
+          }
+          chunk += length;
+        }
+        chunk = std::min(chunk, outbound.size() - written);
+        if (send(ss.fd, outbound.data() + written, chunk, 0) < 0) {
+          if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            arm();
+            return;
+          }
+          int error = errno;
+          lastError = "Failed to send route requests: " +
+                      std::string(strerror(error));
+          failUnsent(error);
+          return;
+        }
+        written += chunk;
+      }
+      outbound.clear();
+      written = 0;
+    }
+
+    void failUnsent(int error) {
+      std::vector<uint32_t> seqs;
+      for (size_t offset = written; offset < outbound.size();) {
+        struct nlmsghdr hdr;
+        std::memcpy(&hdr, outbound.data() + offset, sizeof(hdr));
+        seqs.push_back(hdr.nlmsg_seq);
+        offset += std::max<size_t>(NLMSG_ALIGN(hdr.nlmsg_len), sizeof(hdr));
+      }
+      outbound.clear();
+      written = 0;
+      for (uint32_t seq : seqs) {
+        complete(seq, error);
+      }
+    }
+
+    void collect() {
+      struct nlmsghdr *hdr;
+      while ((hdr = snl_read_message(&ss)) != nullptr) {
+        if (hdr->nlmsg_type != NLMSG_ERROR) {
+          continue;
+        }
+        struct snl_errmsg_data e = {};
+        int error = snl_parse_errmsg(&ss, hdr, &e) ? std::abs(e.error) : EPROTO;
+        complete(hdr->nlmsg_seq, error);
+      }
+      int error = errno;
+      snl_clear_lb(&ss);
+      if (error != 0 && error != EAGAIN && error != EWOULDBLOCK &&
+          !pending.empty()) {
+        // Acknowledgements were dropped, so nothing outstanding can be
+        // matched any more
+        lastError = "Route acknowledgements lost: " +
+                    std::string(strerror(error));
+        completeAll(error);
+      }
+    }
+  };
+
+  AsyncRouteBatch::AsyncRouteBatch() : pImpl(std::make_unique<Impl>()) {}
+
+  AsyncRouteBatch::~AsyncRouteBatch() = default;
+
+  bool AsyncRouteBatch::attach(int kq) { return pImpl->attach(kq); }
+
+  int AsyncRouteBatch::getFd() const {
+    return pImpl->ready ? pImpl->ss.fd : -1;
+  }
+
+  bool AsyncRouteBatch::add(const RouteSpec &route,
+                            RouteCompletion completion) {
+    return pImpl->submit(RTM_NEWROUTE, route, std::move(completion));
+  }
+
+  bool AsyncRouteBatch::remove(const RouteSpec &route,
+                               RouteCompletion completion) {
+    return pImpl->submit(RTM_DELROUTE, route, std::move(completion));
+  }
+
+  bool AsyncRouteBatch::handleEvent(const struct kevent &event) {
+    if (event.udata != pImpl.get() || !pImpl->ready ||
+        event.ident != static_cast<uintptr_t>(pImpl->ss.fd)) {
+      return false;
+    }
+    if (event.flags & EV_ERROR) {
+      int error = static_cast<int>(event.data);
+      pImpl->lastError =
+          "Route batch kqueue event failed: " + std::string(strerror(error));
+      pImpl->completeAll(error);
+    } else if (event.filter == EVFILT_WRITE) {
+      pImpl->writeArmed = false;
+      pImpl->flush();
+    } else if (event.filter == EVFILT_READ) {
+      pImpl->collect();
+    }
+    return true;
+  }
+
+  size_t AsyncRouteBatch::getPending() const { return pImpl->pending.size(); }
+
+  void AsyncRouteBatch::cancel() { pImpl->completeAll(ECANCELED); }
+
+  std::string AsyncRouteBatch::getLastError() const {
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::routing
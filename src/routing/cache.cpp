@@ -0,0 +1,513 @@
+/**
+ * @file routing/cache.cpp
+ * @brief Routing table cache implementation
+ * @details Keeps per-FIB copies of the routing tables current from routing
+ * socket messages
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <net/route.h>
+#include <poll.h>
+#include <routing/cache.hpp>
+#include <routing/names.hpp>
+#include <routing/table.hpp>
+#include <shared_mutex>
+#include <sys/socket.h>
+#include <system/budget.hpp>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    // Routes keyed by destination; entries under one key differ by netmask
+    // or, for multipath routes, by gateway
+    using RouteMap =
+        std::unordered_map<std::string, std::vector<RoutingEntryInfo>>;
+
+    // Heap held by the formatted strings of one route, on average
+    constexpr size_t ROUTE_STRING_BYTES = 64;
+
+    bool sameRoute(const RoutingEntryInfo &a, const RoutingEntryInfo &b,
+                   bool matchGateway) {
+      return a.netmask == b.netmask &&
+             (!matchGateway || a.gateway == b.gateway);
+    }
+
+  } // namespace
+
+  class RoutingTableCache::Impl {
+  public:
+    struct Fib {
+      int number = 0;
+      int fd = -1;
+      RouteMap routes;
+      size_t count = 0;
+    };
+
+    RoutingTable table;
+    std::vector<Fib> fibs;
+    mutable std::shared_mutex mutex;
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> running{false};
+    std::thread thread;
+    int wakeFds[2] = {-1, -1};
+    // refresh() while running is done by the update thread, so a dump can
+    // never be swapped in over updates the thread applied after it
+    std::mutex refreshMutex;
+    std::condition_variable refreshDone;
+    uint64_t refreshRequested = 0;
+    uint64_t refreshCompleted = 0;
+    bool refreshResult = true;
+    mutable std::mutex errorMutex;
+    std::string lastError;
+    // The routes are the cache itself, so they are counted but never evicted
+    system::CacheAccount account{"routing.cache",
+                                 system::CachePriority::REQUIRED};
+
+    explicit Impl(const std::vector<int> &numbers) {
+      for (int number : numbers) {
+        auto it = std::find_if(fibs.begin(), fibs.end(), [&](const Fib &f) {
+          return f.number == number;
+        });
+        if (number >= 0 && it == fibs.end()) {
+          fibs.push_back(Fib{number, -1, {}, 0});
+        }
+      }
+    }
+
+    ~Impl() {
+      stop();
+      closeSockets();
+    }
+
+    void setError(const std::string &message) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      lastError = message;
+    }
+
+    bool openSockets() {
+      // Subscribe before dumping so that changes racing the dump are queued
+      // and replayed rather than lost
+      for (auto &fib : fibs) {
+        if (fib.fd >= 0) {
+          continue;
+        }
+        fib.fd = socket(PF_ROUTE, SOCK_RAW | SOCK_CLOEXEC, 0);
+        if (fib.fd < 0) {
+          setError("Failed to create routing socket: " +
+                   std::string(strerror(errno)));
+          return false;
+        }
+        if (setsockopt(fib.fd, SOL_SOCKET, SO_SETFIB, &fib.number,
+                       sizeof(fib.number)) < 0) {
+          setError("Failed to bind routing socket to FIB " +
+                   std::to_string(fib.number) + ": " +
+                   std::string(strerror(errno)));
+          return false;
+        }
+
+        // Only route changes and interface arrivals/departures (which
+        // rename indexes) are of interest; a larger receive buffer makes
+        // overflow (and the resulting full resync) less likely under churn
+        unsigned int filter =
+            ROUTE_FILTER(RTM_ADD) | ROUTE_FILTER(RTM_DELETE) |
+            ROUTE_FILTER(RTM_CHANGE) | ROUTE_FILTER(RTM_IFANNOUNCE);
+        setsockopt(fib.fd, PF_ROUTE, RO_MSGFILTER, &filter, sizeof(filter));
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fib.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        fcntl(fib.fd, F_SETFL, fcntl(fib.fd, F_GETFL) | O_NONBLOCK);
+      }
+      return true;
+    }
+
+    void closeSockets() {
+      for (auto &fib : fibs) {
+        if (fib.fd >= 0) {
+          close(fib.fd);
+          fib.fd = -1;
+        }
+      }
+    }
+
+    bool load(Fib &fib) {
+      RouteMap routes;
+      size_t count = 0;
+      auto now = std::chrono::system_clock::now();
+      for (const auto &entry : table.getEntries(fib.number)) {
+        RoutingEntryInfo info = entry->getInfo();
+        info.lastUpdated = now;
+        routes[info.destination].push_back(std::move(info));
+        ++count;
+      }
+
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      fib.routes.swap(routes);
+      fib.count = count;
+      generation.fetch_add(1, std::memory_order_release);
+      return true;
+    }
+
+    // Reported once per load or drained batch, never per message
+    void updateUsage() {
+      size_t bytes = 0;
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        for (const auto &fib : fibs) {
+          bytes += fib.count * (sizeof(RoutingEntryInfo) + ROUTE_STRING_BYTES);
+          bytes += fib.routes.size() *
+                   (sizeof(RouteMap::value_type) + 2 * sizeof(void *));
+        }
+      }
+      account.setUsage(bytes);
+    }
+
+    bool loadAll() {
+      for (auto &fib : fibs) {
+        if (!load(fib)) {
+          return false;
+        }
+      }
+      updateUsage();
+      return true;
+    }
+
+    void apply(Fib &fib, const struct rt_msghdr *rtm) {
+      // if_announcemsghdr shares the rt_msghdr length/version/type prefix
+      if (rtm->rtm_type == RTM_IFANNOUNCE) {
+        InterfaceNameCache::invalidate();
+        return;
+      }
+      if (rtm->rtm_version != RTM_VERSION || rtm->rtm_errno != 0 ||
+          (rtm->rtm_flags & RTF_LLDATA)) {
+        return;
+      }
+      if (rtm->rtm_type != RTM_ADD && rtm->rtm_type != RTM_DELETE &&
+          rtm->rtm_type != RTM_CHANGE) {
+        return;
+      }
+      auto entry = table.parseMessage(rtm);
+      if (!entry) {
+        return;
+      }
+      RoutingEntryInfo info = entry->getInfo();
+      info.lastUpdated = std::chrono::system_clock::now();
+
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      auto &paths = fib.routes[info.destination];
+      // Multipath routes share destination and netmask, so an add only
+      // replaces an existing path through the same gateway
+      bool matchGateway = rtm->rtm_type != RTM_CHANGE;
+      auto it = std::find_if(paths.begin(), paths.end(),
+                             [&](const RoutingEntryInfo &existing) {
+                               return sameRoute(existing, info, matchGateway);
+                             });
+
+      if (rtm->rtm_type == RTM_DELETE) {
+        if (it == paths.end() && !paths.empty()) {
+          // Deletes need not carry the gateway; fall back to netmask only
+          it = std::find_if(paths.begin(), paths.end(),
+                            [&](const RoutingEntryInfo &existing) {
+                              return sameRoute(existing, info, false);
+                            });
+        }
+        if (it == paths.end()) {
+          if (paths.empty()) {
+            fib.routes.erase(info.destination);
+          }
+          return;
+        }
+        paths.erase(it);
+        --fib.count;
+        if (paths.empty()) {
+          fib.routes.erase(info.destination);
+        }
+      } else if (it != paths.end()) {
+        *it = std::move(info);
+      } else {
+        paths.push_back(std::move(info));
+        ++fib.count;
+      }
+      generation.fetch_add(1, std::memory_order_release);
+    }
+
+    // Returns false if the socket overflowed and the FIB must be resynced
+    bool drain(Fib &fib) {
+      // Large enough for any single routing message
+      alignas(struct rt_msghdr) char buffer[8192];
+      for (;;) {
+        ssize_t len = read(fib.fd, buffer, sizeof(buffer));
+        if (len < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return errno != ENOBUFS;
+        }
+        if (len == 0) {
+          return true;
+        }
+        if (static_cast<size_t>(len) < sizeof(struct rt_msghdr)) {
+          continue;
+        }
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(buffer);
+        if (rtm->rtm_msglen <= len) {
+          apply(fib, rtm);
+        }
+      }
+    }
+
+    // Dump, then replay what queued on the sockets meanwhile; called
+    // before the thread starts or on it
+    bool resync() {
+      if (!loadAll()) {
+        return false;
+      }
+      for (auto &fib : fibs) {
+        if (!drain(fib)) {
+          load(fib);
+        }
+      }
+      updateUsage();
+      return true;
+    }
+
+    void finishRefresh(uint64_t ticket, bool result) {
+      {
+        std::lock_guard<std::mutex> lock(refreshMutex);
+        refreshCompleted = ticket;
+        refreshResult = result;
+      }
+      refreshDone.notify_all();
+    }
+
+    bool refresh() {
+      std::unique_lock<std::mutex> lock(refreshMutex);
+      if (!running.load()) {
+        lock.unlock();
+        return loadAll();
+      }
+      uint64_t ticket = ++refreshRequested;
+      char byte = 0;
+      if (write(wakeFds[1], &byte, 1) != 1) {
+        setError("Failed to wake routing cache thread: " +
+                 std::string(strerror(errno)));
+        return false;
+      }
+      refreshDone.wait(lock, [&] {
+        return refreshCompleted >= ticket || !running.load();
+      });
+      return refreshCompleted >= ticket && refreshResult;
+    }
+
+    void run() {
+      std::vector<struct pollfd> pfds;
+      pfds.push_back({wakeFds[0], POLLIN, 0});
+      for (const auto &fib : fibs) {
+        pfds.push_back({fib.fd, POLLIN, 0});
+      }
+
+      while (running.load()) {
+        if (poll(pfds.data(), pfds.size(), -1) < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          setError("Routing cache poll failed: " +
+                   std::string(strerror(errno)));
+          break;
+        }
+        if (pfds[0].revents) {
+          char bytes[64];
+          ssize_t drained = read(wakeFds[0], bytes, sizeof(bytes));
+          (void)drained;
+          if (!running.load()) {
+            break;
+          }
+          uint64_t ticket;
+          {
+            std::lock_guard<std::mutex> lock(refreshMutex);
+            ticket = refreshRequested;
+          }
+          finishRefresh(ticket, resync());
+          continue;
+        }
+        for (size_t i = 0; i < fibs.size(); ++i) {
+          if (pfds[i + 1].revents && !drain(fibs[i])) {
+            load(fibs[i]);
+          }
+        }
+        updateUsage();
+      }
+      {
+        std::lock_guard<std::mutex> lock(refreshMutex);
+        running = false;
+      }
+      refreshDone.notify_all();
+    }
+
+    bool start() {
+      if (running.load()) {
+        return true;
+      }
+      if (fibs.empty()) {
+        setError("No FIBs to cache");
+        return false;
+      }
+      if (!openSockets()) {
+        closeSockets();
+        return false;
+      }
+      if (pipe2(wakeFds, O_CLOEXEC) < 0) {
+        setError("Failed to create wakeup pipe: " +
+                 std::string(strerror(errno)));
+        closeSockets();
+        return false;
+      }
+      if (!resync()) {
+        stop();
+        return false;
+      }
+
+      running = true;
+      thread = std::thread([this] { run(); });
+      return true;
+    }
+
+    void stop() {
+      if (thread.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(refreshMutex);
+          running = false;
+        }
+        refreshDone.notify_all();
+        char byte = 0;
+        ssize_t written = write(wakeFds[1], &byte, 1);
+        (void)written;
+        thread.join();
+      }
+      for (int &fd : wakeFds) {
+        if (fd >= 0) {
+          close(fd);
+          fd = -1;
+        }
+      }
+      closeSockets();
+    }
+
+    const Fib *findFib(int number) const {
+      for (const auto &fib : fibs) {
+        if (fib.number == number) {
+          return &fib;
+        }
+      }
+      return nullptr;
+    }
+  };
+
+  RoutingTableCache::RoutingTableCache(const std::vector<int> &fibs)
+      : pImpl(std::make_unique<Impl>(fibs)) {}
+
+  RoutingTableCache::~RoutingTableCache() = default;
+
+  bool RoutingTableCache::start() { return pImpl->start(); }
+
+  void RoutingTableCache::stop() { pImpl->stop(); }
+
+  bool RoutingTableCache::isRunning() const { return pImpl->running.load(); }
+
+  bool RoutingTableCache::refresh() { return pImpl->refresh(); }
+
+  uint64_t RoutingTableCache::getGeneration() const {
+    return pImpl->generation.load(std::memory_order_acquire);
+  }
+
+  std::vector<std::unique_ptr<RoutingEntry>>
+  RoutingTableCache::getEntries(int fib) const {
+    std::vector<std::unique_ptr<RoutingEntry>> entries;
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    const auto *state = pImpl->findFib(fib);
+    if (!state) {
+      return entries;
+    }
+    entries.reserve(state->count);
+    for (const auto &[destination, paths] : state->routes) {
+      for (const auto &info : paths) {
+        entries.push_back(std::make_unique<RoutingEntry>(info));
+      }
+    }
+    return entries;
+  }
+
+  std::vector<std::unique_ptr<RoutingEntry>>
+  RoutingTableCache::getEntries(const std::string &destination,
+                                int fib) const {
+    std::vector<std::unique_ptr<RoutingEntry>> entries;
+    std::string address = destination;
+    std::string prefix;
+    size_t slash = destination.find('/');
+    if (slash != std::string::npos) {
+      address = destination.substr(0, slash);
+      prefix = destination.substr(slash + 1);
+    }
+
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    const auto *state = pImpl->findFib(fib);
+    if (!state) {
+      return entries;
+    }
+    auto it = state->routes.find(address);
+    if (it == state->routes.end()) {
+      return entries;
+    }
+    for (const auto &info : it->second) {
+      if (prefix.empty() || info.netmask == prefix) {
+        entries.push_back(std::make_unique<RoutingEntry>(info));
+      }
+    }
+    return entries;
+  }
+
+  std::unique_ptr<RoutingEntry>
+  RoutingTableCache::getDefaultGateway(int fib) const {
+    auto entries = getEntries("0.0.0.0/0", fib);
+    if (entries.empty()) {
+      entries = getEntries("0.0.0.0", fib);
+    }
+    return entries.empty() ? nullptr : std::move(entries.front());
+  }
+
+  size_t RoutingTableCache::size(int fib) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    size_t total = 0;
+    for (const auto &state : pImpl->fibs) {
+      if (fib < 0 || state.number == fib) {
+        total += state.count;
+      }
+    }
+    return total;
+  }
+
+  std::vector<int> RoutingTableCache::getFibs() const {
+    std::vector<int> numbers;
+    for (const auto &state : pImpl->fibs) {
+      numbers.push_back(state.number);
+    }
+    return numbers;
+  }
+
+  std::string RoutingTableCache::getLastError() const {
+    std::lock_guard<std::mutex> lock(pImpl->errorMutex);
+    return pImpl->lastError;
+  }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,113 @@
+/**
+ * @file routing/diff.cpp
+ * @brief Routing snapshot delta engine implementation
+ * @details Sort-and-merge comparison of route record vectors
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <routing/diff.hpp>
+#include <tuple>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    auto key(const RouteRecord &r) {
+      return std::tie(r.fib, r.family, r.destination, r.prefixLength);
+    }
+
+    // Secondary order so multipath routes pair up deterministically
+    auto path(const RouteRecord &r) {
+      return std::tie(r.gatewayFamily, r.gateway, r.gatewayIndex);
+    }
+
+    bool less(const RouteRecord &a, const RouteRecord &b) {
+      if (key(a) != key(b)) {
+        return key(a) < key(b);
+      }
+      return path(a) < path(b);
+    }
+
+    bool sameAttributes(const RouteRecord &a, const RouteRecord &b) {
+      return path(a) == path(b) && a.gatewayLength == b.gatewayLength &&
+             a.index == b.index && a.scope == b.scope && a.flags == b.flags &&
+             a.metric == b.metric && a.mtu == b.mtu;
+    }
+
+    using Iterator = std::vector<RouteRecord>::const_iterator;
+
+    // Compare the paths of one destination: identical gateways pair first,
+    // then leftover paths pair as gateway changes, and any remainder is an
+    // added or removed path
+    void diffGroup(Iterator old, Iterator oldEnd, Iterator cur,
+                   Iterator curEnd, RouteDiff &diff) {
+      if (oldEnd - old == 1 && curEnd - cur == 1) {
+        if (!sameAttributes(*old, *cur)) {
+          diff.changed.push_back({*old, *cur});
+        }
+        return;
+      }
+
+      std::vector<RouteRecord> gone;
+      std::vector<RouteRecord> fresh;
+      while (old != oldEnd && cur != curEnd) {
+        if (path(*old) < path(*cur)) {
+          gone.push_back(*old++);
+        } else if (path(*cur) < path(*old)) {
+          fresh.push_back(*cur++);
+        } else {
+          if (!sameAttributes(*old, *cur)) {
+            diff.changed.push_back({*old, *cur});
+          }
+          ++old;
+          ++cur;
+        }
+      }
+      gone.insert(gone.end(), old, oldEnd);
+      fresh.insert(fresh.end(), cur, curEnd);
+
+      size_t paired = std::min(gone.size(), fresh.size());
+      for (size_t i = 0; i < paired; ++i) {
+        diff.changed.push_back({gone[i], fresh[i]});
+      }
+      diff.removed.insert(diff.removed.end(), gone.begin() + paired,
+                          gone.end());
+      diff.added.insert(diff.added.end(), fresh.begin() + paired, fresh.end());
+    }
+
+  } // namespace
+
+  RouteDiff RouteDiff::compare(std::vector<RouteRecord> before,
+                               std::vector<RouteRecord> after) {
+    std::sort(before.begin(), before.end(), less);
+    std::sort(after.begin(), after.end(), less);
+
+    RouteDiff diff;
+    auto old = before.begin();
+    auto cur = after.begin();
+    while (old != before.end() && cur != after.end()) {
+      if (key(*old) < key(*cur)) {
+        diff.removed.push_back(*old++);
+      } else if (key(*cur) < key(*old)) {
+        diff.added.push_back(*cur++);
+      } else {
+        auto oldEnd = std::find_if(old, before.end(), [&](const auto &r) {
+          return key(r) != key(*old);
+        });
+        auto curEnd = std::find_if(cur, after.end(), [&](const auto &r) {
+          return key(r) != key(*cur);
+        });
+        diffGroup(old, oldEnd, cur, curEnd, diff);
+        old = oldEnd;
+        cur = curEnd;
+      }
+    }
+    diff.removed.insert(diff.removed.end(), old, before.end());
+    diff.added.insert(diff.added.end(), cur, after.end());
+    return diff;
+  }
+
+} // namespace libfreebsdnet::routing
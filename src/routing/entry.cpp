@@ -35,17 +35,34 @@ namespace libfreebsdnet::routing {
 
     explicit Impl(const RoutingEntryInfo &info) : info_(info) {}
 
-    std::string getDestination() const { return info_.destination; }
+    explicit Impl(const RouteRecord &record)
+        : info_(), record_(record), hasRecord_(true), formatted_(0) {
+      info_.flags = static_cast<uint16_t>(record.flags);
+      info_.metric = record.metric;
+      info_.mtu = record.mtu;
+    }
 
-    std::string getGateway() const { return info_.gateway; }
+    std::string getDestination() const {
+      format(DESTINATION);
+      return info_.destination;
+    }
 
-    std::string getInterface() const { return info_.interface; }
+    std::string getGateway() const {
+      format(GATEWAY);
+      return info_.gateway;
+    }
+
+    std::string getInterface() const {
+      format(INTERFACE);
+      return info_.interface;
+    }
 
     uint16_t getFlags() const { return info_.flags; }
 
     std::vector<RouteFlag> getFlagList() const {
       std::vector<RouteFlag> flags;
-      uint32_t raw_flags = info_.flags; // Use uint32_t to handle all flags
+      // Use uint32_t to handle all flags
+      uint32_t raw_flags = hasRecord_ ? record_.flags : info_.flags;
       
       if (raw_flags & RTF_UP) flags.push_back(RouteFlag::UP);
       if (raw_flags & RTF_GATEWAY) flags.push_back(RouteFlag::GATEWAY);
@@ -71,27 +88,73 @@ namespace libfreebsdnet::routing {
 
     uint32_t getMtu() const { return info_.mtu; }
 
-    std::string getNetmask() const { return info_.netmask; }
+    std::string getNetmask() const {
+      format(NETMASK);
+      return info_.netmask;
+    }
 
     bool isActive() const { return (info_.flags & RTF_UP) != 0; }
 
     bool isDefault() const {
+      format(DESTINATION);
       return info_.destination == "0.0.0.0/0" || info_.destination == "::/0";
     }
 
     bool isHost() const {
       // Check if destination is a host route (no CIDR notation)
+      format(DESTINATION);
       return info_.destination.find('/') == std::string::npos;
     }
 
     bool isNetwork() const { return !isHost(); }
 
-    RoutingEntryInfo getInfo() const { return info_; }
+    RoutingEntryInfo getInfo() const {
+      format(DESTINATION | GATEWAY | INTERFACE | NETMASK);
+      return info_;
+    }
+
+    void updateInfo(const RoutingEntryInfo &info) {
+      info_ = info;
+      hasRecord_ = false;
+    }
 
-    void updateInfo(const RoutingEntryInfo &info) { info_ = info; }
+    const RouteRecord *getRecord() const {
+      return hasRecord_ ? &record_ : nullptr;
+    }
 
   private:
-    RoutingEntryInfo info_;
+    enum Field : uint8_t {
+      DESTINATION = 0x1,
+      GATEWAY = 0x2,
+      INTERFACE = 0x4,
+      NETMASK = 0x8
+    };
+
+    mutable RoutingEntryInfo info_;
+    RouteRecord record_{};
+    bool hasRecord_ = false;
+    mutable uint8_t formatted_ = 0;
+
+    // Fill string fields from the record the first time they are read
+    void format(uint8_t fields) const {
+      if (!hasRecord_ || (formatted_ & fields) == fields) {
+        return;
+      }
+      uint8_t missing = fields & ~formatted_;
+      if (missing & DESTINATION) {
+        info_.destination = record_.formatDestination();
+      }
+      if (missing & GATEWAY) {
+        info_.gateway = record_.formatGateway();
+      }
+      if (missing & INTERFACE) {
+        info_.interface = record_.formatInterface();
+      }
+      if (missing & NETMASK) {
+        info_.netmask = record_.formatNetmask();
+      }
+      formatted_ |= missing;
+    }
   };
 
   RoutingEntry::RoutingEntry() : pImpl(std::make_unique<Impl>()) {}
@@ -99,6 +162,9 @@ namespace libfreebsdnet::routing {
   RoutingEntry::RoutingEntry(const RoutingEntryInfo &info)
       : pImpl(std::make_unique<Impl>(info)) {}
 
+  RoutingEntry::RoutingEntry(const RouteRecord &record)
+      : pImpl(std::make_unique<Impl>(record)) {}
+
   RoutingEntry::~RoutingEntry() = default;
 
   std::string RoutingEntry::getDestination() const {
@@ -137,4 +203,8 @@ namespace libfreebsdnet::routing {
     pImpl->updateInfo(info);
   }
 
+  const RouteRecord *RoutingEntry::getRecord() const {
+    return pImpl->getRecord();
+  }
+
 } // namespace libfreebsdnet::routing
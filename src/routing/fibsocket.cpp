@@ -0,0 +1,280 @@
+/**
+ * @file routing/fibsocket.cpp
+ * @brief FIB-bound probe socket pool implementation
+ * @details Idle socket stacks per FIB and protocol, shared by the pool and
+ * its leases
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <netinet/in.h>
+#include <routing/fibsocket.hpp>
+#include <routing/lpm.hpp>
+#include <routing/record.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    constexpr size_t PROTOCOL_COUNT = 4;
+
+    uint64_t key(int fib, ProbeProtocol protocol) {
+      return static_cast<uint64_t>(static_cast<uint32_t>(fib)) *
+                 PROTOCOL_COUNT +
+             static_cast<uint64_t>(protocol);
+    }
+
+    int keyFib(uint64_t k) { return static_cast<int>(k / PROTOCOL_COUNT); }
+
+    // An idle raw socket still receives a copy of every ICMP packet, and
+    // an idle bound UDP socket keeps late replies; discard them so a new
+    // lease only reads its own traffic
+    void discardPending(int fd) {
+      char scratch[2048];
+      while (recv(fd, scratch, sizeof(scratch), MSG_DONTWAIT) >= 0) {
+      }
+    }
+
+  } // namespace
+
+  class FibSocket::Pool {
+  public:
+    mutable std::mutex mutex;
+    std::vector<int> fibs;
+    FibSocketPoolOptions options;
+    std::unordered_map<uint64_t, std::vector<int>> idle;
+    bool closed = false; // the owning pool is gone
+    std::atomic<uint64_t> opened{0};
+    std::atomic<uint64_t> reused{0};
+
+    Pool(const std::vector<int> &fibs, const FibSocketPoolOptions &options)
+        : fibs(fibs), options(options) {}
+
+    ~Pool() { drain(); }
+
+    int open(int fib, ProbeProtocol protocol) {
+      int family = AF_INET;
+      int type = SOCK_DGRAM;
+      int proto = 0;
+      switch (protocol) {
+      case ProbeProtocol::UDP:
+        break;
+      case ProbeProtocol::ICMP:
+        type = SOCK_RAW;
+        proto = IPPROTO_ICMP;
+        break;
+      case ProbeProtocol::UDP6:
+        family = AF_INET6;
+        break;
+      case ProbeProtocol::ICMP6:
+        family = AF_INET6;
+        type = SOCK_RAW;
+        proto = IPPROTO_ICMPV6;
+        break;
+      }
+      type |= SOCK_CLOEXEC;
+      if (options.nonBlocking) {
+        type |= SOCK_NONBLOCK;
+      }
+
+      int fd = socket(family, type, proto);
+      if (fd < 0) {
+        return -1;
+      }
+      if (setsockopt(fd, SOL_SOCKET, SO_SETFIB, &fib, sizeof(fib)) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+      }
+      opened.fetch_add(1, std::memory_order_relaxed);
+      return fd;
+    }
+
+    void give(int fd, int fib, ProbeProtocol protocol) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!closed) {
+          auto &stack = idle[key(fib, protocol)];
+          if (stack.size() < options.maxIdlePerFib) {
+            stack.push_back(fd);
+            return;
+          }
+        }
+      }
+      close(fd);
+    }
+
+    void drain() {
+      std::unordered_map<uint64_t, std::vector<int>> taken;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        taken.swap(idle);
+      }
+      for (auto &[k, stack] : taken) {
+        for (int fd : stack) {
+          close(fd);
+        }
+      }
+    }
+  };
+
+  FibSocket::FibSocket(FibSocket &&other) noexcept
+      : pool(std::move(other.pool)), fd(other.fd), fib(other.fib),
+        protocol(other.protocol) {
+    other.fd = -1;
+  }
+
+  FibSocket &FibSocket::operator=(FibSocket &&other) noexcept {
+    if (this != &other) {
+      reset();
+      pool = std::move(other.pool);
+      fd = other.fd;
+      fib = other.fib;
+      protocol = other.protocol;
+      other.fd = -1;
+    }
+    return *this;
+  }
+
+  FibSocket::~FibSocket() { reset(); }
+
+  void FibSocket::reset() {
+    if (fd >= 0) {
+      if (pool) {
+        pool->give(fd, fib, protocol);
+      } else {
+        close(fd);
+      }
+    }
+    fd = -1;
+    pool.reset();
+  }
+
+  void FibSocket::discard() {
+    if (fd >= 0) {
+      close(fd);
+    }
+    fd = -1;
+    pool.reset();
+  }
+
+  FibSocketPool::FibSocketPool(const std::vector<int> &fibs,
+                               const FibSocketPoolOptions &options)
+      : pImpl(std::make_shared<FibSocket::Pool>(fibs, options)) {}
+
+  FibSocketPool::~FibSocketPool() {
+    {
+      std::lock_guard<std::mutex> lock(pImpl->mutex);
+      pImpl->closed = true;
+    }
+    pImpl->drain();
+  }
+
+  bool FibSocketPool::warm(const std::vector<ProbeProtocol> &protocols) {
+    bool ok = true;
+    for (int fib : pImpl->fibs) {
+      size_t fibOpened = 0;
+      for (ProbeProtocol protocol : protocols) {
+        std::vector<int> fds;
+        fds.reserve(pImpl->options.warmPerFib);
+        for (size_t i = 0; i < pImpl->options.warmPerFib; ++i) {
+          int fd = pImpl->open(fib, protocol);
+          if (fd < 0) {
+            break; // e.g. raw ICMP without privilege
+          }
+          fds.push_back(fd);
+        }
+        fibOpened += fds.size();
+        for (int fd : fds) {
+          pImpl->give(fd, fib, protocol);
+        }
+      }
+      if (fibOpened == 0) {
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  types::NetResult<FibSocket> FibSocketPool::acquire(int fib,
+                                                     ProbeProtocol protocol) {
+    if (fib < 0) {
+      return std::unexpected(types::NetError{
+          types::NetErrorCode::INVALID_ARGUMENT, EINVAL, 0,
+          "FibSocketPool::acquire"});
+    }
+    {
+      std::unique_lock<std::mutex> lock(pImpl->mutex);
+      auto it = pImpl->idle.find(key(fib, protocol));
+      if (it != pImpl->idle.end() && !it->second.empty()) {
+        int fd = it->second.back();
+        it->second.pop_back();
+        pImpl->reused.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+        discardPending(fd);
+        return FibSocket(pImpl, fd, fib, protocol);
+      }
+    }
+    int fd = pImpl->open(fib, protocol);
+    if (fd < 0) {
+      return std::unexpected(
+          types::NetError::fromErrno("FibSocketPool::acquire"));
+    }
+    return FibSocket(pImpl, fd, fib, protocol);
+  }
+
+  std::vector<ProbeRoute>
+  FibSocketPool::resolve(const LpmIndex &index,
+                         const std::vector<types::Address> &targets, int fib) {
+    auto records = index.lookup(targets, fib);
+    std::vector<ProbeRoute> routes(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
+      ProbeRoute &route = routes[i];
+      route.target = targets[i];
+      route.fib = fib;
+      route.protocol =
+          targets[i].getFamily() == types::Address::Family::IPv6
+              ? ProbeProtocol::UDP6
+              : ProbeProtocol::UDP;
+      const RouteRecord *record = records[i];
+      if (!record) {
+        continue;
+      }
+      route.destination = record->formatDestination();
+      route.gateway = record->formatGateway();
+      route.interface = record->formatInterface();
+      route.interfaceIndex = record->index;
+    }
+    return routes;
+  }
+
+  size_t FibSocketPool::getIdleCount(int fib) const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    size_t count = 0;
+    for (const auto &[k, stack] : pImpl->idle) {
+      if (fib < 0 || keyFib(k) == fib) {
+        count += stack.size();
+      }
+    }
+    return count;
+  }
+
+  uint64_t FibSocketPool::getOpenCount() const {
+    return pImpl->opened.load(std::memory_order_relaxed);
+  }
+
+  uint64_t FibSocketPool::getReuseCount() const {
+    return pImpl->reused.load(std::memory_order_relaxed);
+  }
+
+  void FibSocketPool::drain() { pImpl->drain(); }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,484 @@
+/**
+ * @file routing/lpm.cpp
+ * @brief Longest-prefix-match route lookup implementation
+ * @details DIR-16-8-8 table for IPv4 and path-compressed trie for IPv6
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <net/if.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <routing/lpm.hpp>
+#include <routing/table.hpp>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <tuple>
+#include <unordered_map>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    using Key = std::array<uint8_t, 16>;
+
+    // Table slots hold 0 (no route), a route number + 1, or a chunk number
+    // tagged with the high bit
+    constexpr uint32_t CHUNK_FLAG = 0x80000000u;
+    constexpr size_t CHUNK_SIZE = 256;
+
+    struct Prefix {
+      int family = AF_UNSPEC;
+      Key key{};
+      int length = 0;
+    };
+
+    int bitAt(const Key &key, int bit) {
+      return (key[bit / 8] >> (7 - bit % 8)) & 1;
+    }
+
+    // Number of leading bits a and b share, up to limit
+    int commonBits(const Key &a, const Key &b, int limit) {
+      int bits = 0;
+      for (int i = 0; bits < limit; ++i) {
+        uint8_t diff = a[i] ^ b[i];
+        if (diff == 0) {
+          bits += 8;
+          continue;
+        }
+        while ((diff & 0x80) == 0) {
+          ++bits;
+          diff <<= 1;
+        }
+        break;
+      }
+      return std::min(bits, limit);
+    }
+
+    void maskKey(Key &key, int length) {
+      for (int i = 0; i < 16; ++i) {
+        int keep = std::clamp(length - i * 8, 0, 8);
+        key[i] &= static_cast<uint8_t>(0xff00 >> keep);
+      }
+    }
+
+    bool parseAddress(const std::string &text, int &family, Key &key) {
+      // Strip an IPv6 scope zone ("fe80::1%em0")
+      std::string ip = text.substr(0, text.find('%'));
+      key.fill(0);
+      if (inet_pton(AF_INET, ip.c_str(), key.data()) == 1) {
+        family = AF_INET;
+        return true;
+      }
+      if (inet_pton(AF_INET6, ip.c_str(), key.data()) == 1) {
+        family = AF_INET6;
+        return true;
+      }
+      return false;
+    }
+
+    bool parsePrefix(const RoutingEntryInfo &info, Prefix &prefix) {
+      std::string destination = info.destination;
+      std::string length = info.netmask;
+      size_t slash = destination.find('/');
+      if (slash != std::string::npos) {
+        length = destination.substr(slash + 1);
+        destination.resize(slash);
+      }
+      if (!parseAddress(destination, prefix.family, prefix.key)) {
+        return false;
+      }
+
+      int maxLength = prefix.family == AF_INET ? 32 : 128;
+      prefix.length = maxLength;
+      if (!length.empty() && !(info.flags & RTF_HOST)) {
+        try {
+          prefix.length = std::stoi(length);
+        } catch (const std::exception &) {
+          return false;
+        }
+      }
+      if (prefix.length < 0 || prefix.length > maxLength) {
+        return false;
+      }
+      maskKey(prefix.key, prefix.length);
+      return true;
+    }
+
+    bool recordPrefix(const RouteRecord &record, Prefix &prefix) {
+      int maxLength = record.family == AF_INET    ? 32
+                      : record.family == AF_INET6 ? 128
+                                                  : -1;
+      if (record.prefixLength > maxLength) {
+        return false;
+      }
+      prefix.family = record.family;
+      prefix.key = record.destination;
+      prefix.length = record.prefixLength;
+      maskKey(prefix.key, prefix.length);
+      return true;
+    }
+
+    // Entries built from strings, such as RoutingTableCache's, carry no
+    // record; rebuild the fields a lookup result is formatted from
+    bool infoRecord(const RoutingEntryInfo &info, int fib,
+                    std::unordered_map<std::string, unsigned int> &indexes,
+                    RouteRecord &record) {
+      Prefix prefix;
+      if (!parsePrefix(info, prefix)) {
+        return false;
+      }
+      record = RouteRecord{};
+      record.destination = prefix.key;
+      record.family = static_cast<uint8_t>(prefix.family);
+      record.prefixLength = static_cast<uint8_t>(prefix.length);
+      record.flags = info.flags;
+      record.fib = static_cast<uint32_t>(fib);
+      record.metric = info.metric;
+      record.mtu = info.mtu;
+      auto [it, inserted] = indexes.emplace(info.interface, 0);
+      if (inserted) {
+        it->second = if_nametoindex(info.interface.c_str());
+      }
+      record.index = static_cast<uint16_t>(it->second);
+      int family = AF_UNSPEC;
+      if (parseAddress(info.gateway, family, record.gateway)) {
+        record.gatewayFamily = static_cast<uint8_t>(family);
+      } else {
+        record.gateway.fill(0);
+        record.gatewayFamily = AF_LINK;
+        record.gatewayIndex = record.index;
+      }
+      return true;
+    }
+
+    /**
+     * @brief DIR-16-8-8 IPv4 table
+     * @details A 64K-entry first level indexed by the top 16 bits, with
+     * 256-entry chunks for the third and fourth octets allocated only where
+     * prefixes longer than /16 and /24 exist. Lookups take at most three
+     * dependent loads.
+     */
+    class Inet4Table {
+    public:
+      Inet4Table() : level16(65536, 0) {}
+
+      // Prefixes must be inserted in ascending length order so that longer
+      // prefixes overwrite the expansion of shorter ones and no range being
+      // filled has been split into chunks yet
+      void insert(uint32_t address, int length, uint32_t value) {
+        if (length <= 16) {
+          uint32_t first = address >> 16;
+          uint32_t count = 1u << (16 - length);
+          fill(level16.data() + first, count, value);
+          return;
+        }
+        uint32_t *slot = &level16[address >> 16];
+        uint32_t *chunk = descend(*slot);
+        if (length <= 24) {
+          uint32_t first = (address >> 8) & 0xff;
+          fill(chunk + first, 1u << (24 - length), value);
+          return;
+        }
+        slot = chunk + ((address >> 8) & 0xff);
+        chunk = descend(*slot);
+        fill(chunk + (address & 0xff), 1u << (32 - length), value);
+      }
+
+      uint32_t lookup(uint32_t address) const {
+        uint32_t slot = level16[address >> 16];
+        if (slot & CHUNK_FLAG) {
+          slot = chunks[(slot & ~CHUNK_FLAG) * CHUNK_SIZE +
+                        ((address >> 8) & 0xff)];
+          if (slot & CHUNK_FLAG) {
+            slot = chunks[(slot & ~CHUNK_FLAG) * CHUNK_SIZE + (address & 0xff)];
+          }
+        }
+        return slot;
+      }
+
+    private:
+      std::vector<uint32_t> level16;
+      std::vector<uint32_t> chunks;
+
+      static void fill(uint32_t *slots, uint32_t count, uint32_t value) {
+        std::fill(slots, slots + count, value);
+      }
+
+      // Return the chunk behind a slot, expanding a route slot into a chunk
+      // pre-filled with that route
+      uint32_t *descend(uint32_t &slot) {
+        if (!(slot & CHUNK_FLAG)) {
+          uint32_t inherited = slot;
+          uint32_t number = static_cast<uint32_t>(chunks.size() / CHUNK_SIZE);
+          // The resize may move the vector that slot points into
+          uint32_t *owner = &slot;
+          bool inChunks = owner >= chunks.data() &&
+                          owner < chunks.data() + chunks.size();
+          size_t offset = inChunks ? owner - chunks.data() : 0;
+          chunks.resize(chunks.size() + CHUNK_SIZE, inherited);
+          if (inChunks) {
+            owner = chunks.data() + offset;
+          }
+          *owner = number | CHUNK_FLAG;
+          return chunks.data() + number * CHUNK_SIZE;
+        }
+        return chunks.data() + (slot & ~CHUNK_FLAG) * CHUNK_SIZE;
+      }
+    };
+
+    /**
+     * @brief Path-compressed binary trie for IPv6
+     * @details Nodes exist only at prefixes and at branch points, so a full
+     * table needs at most two nodes per route and a lookup visits at most
+     * one node per distinct prefix length on the path
+     */
+    class Inet6Trie {
+    public:
+      void insert(const Key &key, int length, uint32_t value) {
+        int parent = -1;
+        int side = 0;
+        int current = root;
+        while (current >= 0) {
+          Node &node = nodes[current];
+          int shared = commonBits(node.key, key, std::min(node.length, length));
+          if (shared < node.length) {
+            // The new prefix diverges inside this node's path; split it
+            int branch;
+            if (shared == length) {
+              branch = addNode(key, length, value);
+            } else {
+              branch = addNode(key, shared, 0);
+              int leaf = addNode(key, length, value);
+              nodes[branch].child[bitAt(key, shared)] = leaf;
+            }
+            nodes[branch].child[bitAt(nodes[current].key, shared)] = current;
+            link(parent, side, branch);
+            return;
+          }
+          if (node.length == length) {
+            node.value = value;
+            return;
+          }
+          parent = current;
+          side = bitAt(key, node.length);
+          current = node.child[side];
+        }
+        link(parent, side, addNode(key, length, value));
+      }
+
+      uint32_t lookup(const Key &key) const {
+        uint32_t best = 0;
+        int current = root;
+        while (current >= 0) {
+          const Node &node = nodes[current];
+          if (commonBits(node.key, key, node.length) < node.length) {
+            break;
+          }
+          if (node.value != 0) {
+            best = node.value;
+          }
+          if (node.length == 128) {
+            break;
+          }
+          current = node.child[bitAt(key, node.length)];
+        }
+        return best;
+      }
+
+    private:
+      struct Node {
+        Key key;
+        int length;
+        uint32_t value;
+        int child[2];
+      };
+
+      std::vector<Node> nodes;
+      int root = -1;
+
+      int addNode(const Key &key, int length, uint32_t value) {
+        Node node{key, length, value, {-1, -1}};
+        maskKey(node.key, length);
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+      }
+
+      void link(int parent, int side, int child) {
+        if (parent < 0) {
+          root = child;
+        } else {
+          nodes[parent].child[side] = child;
+        }
+      }
+    };
+
+    uint32_t toInet4(const Key &key) {
+      return (uint32_t(key[0]) << 24) | (uint32_t(key[1]) << 16) |
+             (uint32_t(key[2]) << 8) | uint32_t(key[3]);
+    }
+
+  } // namespace
+
+  class LpmIndex::Impl {
+  public:
+    struct Fib {
+      std::vector<RouteRecord> routes;
+      Inet4Table inet4;
+      Inet6Trie inet6;
+    };
+
+    std::map<int, Fib> fibs;
+    std::string lastError;
+
+    void build(int number, std::span<const RouteRecord> records) {
+      Fib fib;
+      fib.routes.assign(records.begin(), records.end());
+      index(number, std::move(fib));
+    }
+
+    void build(int number,
+               const std::vector<std::unique_ptr<RoutingEntry>> &entries) {
+      Fib fib;
+      fib.routes.reserve(entries.size());
+      std::unordered_map<std::string, unsigned int> indexes;
+      for (const auto &entry : entries) {
+        if (!entry) {
+          continue;
+        }
+        if (const RouteRecord *record = entry->getRecord()) {
+          fib.routes.push_back(*record);
+          continue;
+        }
+        RouteRecord record;
+        if (infoRecord(entry->getInfo(), number, indexes, record)) {
+          fib.routes.push_back(record);
+        }
+      }
+      index(number, std::move(fib));
+    }
+
+    void index(int number, Fib fib) {
+      std::vector<std::pair<Prefix, uint32_t>> prefixes;
+      prefixes.reserve(fib.routes.size());
+      for (size_t i = 0; i < fib.routes.size(); ++i) {
+        Prefix prefix;
+        if (recordPrefix(fib.routes[i], prefix)) {
+          prefixes.emplace_back(prefix, static_cast<uint32_t>(i + 1));
+        }
+      }
+
+      // The IPv4 table relies on shorter prefixes being expanded first;
+      // sorting also makes multipath duplicates adjacent so the first path
+      // wins in both tables
+      std::stable_sort(prefixes.begin(), prefixes.end(),
+                       [](const auto &a, const auto &b) {
+                         return std::tie(a.first.length, a.first.family,
+                                         a.first.key) <
+                                std::tie(b.first.length, b.first.family,
+                                         b.first.key);
+                       });
+      const Prefix *previous = nullptr;
+      for (const auto &[prefix, value] : prefixes) {
+        if (previous && previous->length == prefix.length &&
+            previous->family == prefix.family && previous->key == prefix.key) {
+          continue;
+        }
+        previous = &prefix;
+        if (prefix.family == AF_INET) {
+          fib.inet4.insert(toInet4(prefix.key), prefix.length, value);
+        } else {
+          fib.inet6.insert(prefix.key, prefix.length, value);
+        }
+      }
+
+      fibs[number] = std::move(fib);
+    }
+
+    const RouteRecord *lookup(const types::Address &address,
+                              int number) const {
+      auto it = fibs.find(number);
+      if (it == fibs.end()) {
+        return nullptr;
+      }
+      if (!address.isIPv4() && !address.isIPv6()) {
+        return nullptr;
+      }
+      int family = address.isIPv4() ? AF_INET : AF_INET6;
+      Key key{};
+      auto bytes = address.getBytes();
+      std::copy(bytes.begin(), bytes.end(), key.begin());
+      const Fib &fib = it->second;
+      uint32_t value = family == AF_INET ? fib.inet4.lookup(toInet4(key))
+                                         : fib.inet6.lookup(key);
+      return value ? &fib.routes[value - 1] : nullptr;
+    }
+  };
+
+  LpmIndex::LpmIndex() : pImpl(std::make_unique<Impl>()) {}
+
+  LpmIndex::~LpmIndex() = default;
+
+  bool LpmIndex::build(int fib) {
+    RoutingTable table;
+    std::vector<RouteRecord> records;
+    bool complete = table.forEachRoute(
+        fib, AF_UNSPEC, [&records](const RouteRecord &record) {
+          records.push_back(record);
+          return true;
+        });
+    if (!complete) {
+      // Keep the previous index rather than one built from a partial dump
+      pImpl->lastError = table.getLastError();
+      return false;
+    }
+    pImpl->build(fib, records);
+    return true;
+  }
+
+  void LpmIndex::build(int fib, std::span<const RouteRecord> records) {
+    pImpl->build(fib, records);
+  }
+
+  void LpmIndex::build(
+      int fib, const std::vector<std::unique_ptr<RoutingEntry>> &entries) {
+    pImpl->build(fib, entries);
+  }
+
+  const RouteRecord *LpmIndex::lookup(const types::Address &address,
+                                      int fib) const {
+    return pImpl->lookup(address, fib);
+  }
+
+  std::vector<const RouteRecord *>
+  LpmIndex::lookup(std::span<const types::Address> addresses, int fib) const {
+    std::vector<const RouteRecord *> results;
+    results.reserve(addresses.size());
+    for (const auto &address : addresses) {
+      results.push_back(pImpl->lookup(address, fib));
+    }
+    return results;
+  }
+
+  size_t LpmIndex::size(int fib) const {
+    size_t total = 0;
+    for (const auto &[number, state] : pImpl->fibs) {
+      if (fib < 0 || number == fib) {
+        total += state.routes.size();
+      }
+    }
+    return total;
+  }
+
+  void LpmIndex::clear() { pImpl->fibs.clear(); }
+
+  std::string LpmIndex::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::routing
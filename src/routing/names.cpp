@@ -0,0 +1,100 @@
+/**
+ * @file routing/names.cpp
+ * @brief Interface name cache implementation
+ * @details Builds a flat ifindex to name table from if_nameindex()
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <net/if.h>
+#include <routing/names.hpp>
+#include <shared_mutex>
+#include <vector>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    // An index that is still missing after a rebuild belongs to a departed
+    // interface; do not rebuild for it more often than this
+    constexpr auto MISS_REFRESH_INTERVAL = std::chrono::seconds(1);
+
+    std::shared_mutex tableMutex;
+    std::vector<std::string> names;
+    std::chrono::steady_clock::time_point lastRefresh;
+    std::atomic<bool> stale{true};
+    std::atomic<uint64_t> refreshCount{0};
+
+    bool find(unsigned int index, std::string &name) {
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      if (index < names.size() && !names[index].empty()) {
+        name = names[index];
+        return true;
+      }
+      return false;
+    }
+
+  } // namespace
+
+  std::string InterfaceNameCache::getName(unsigned int index) {
+    if (index == 0) {
+      return "";
+    }
+    if (stale.load(std::memory_order_acquire)) {
+      refresh();
+    }
+
+    std::string name;
+    if (find(index, name)) {
+      return name;
+    }
+
+    // Possibly an interface created since the last rebuild
+    bool retry;
+    {
+      std::shared_lock<std::shared_mutex> lock(tableMutex);
+      retry = std::chrono::steady_clock::now() - lastRefresh >=
+              MISS_REFRESH_INTERVAL;
+    }
+    if (retry && refresh()) {
+      find(index, name);
+    }
+    return name;
+  }
+
+  bool InterfaceNameCache::refresh() {
+    struct if_nameindex *list = if_nameindex();
+    if (!list) {
+      return false;
+    }
+
+    std::vector<std::string> table;
+    for (struct if_nameindex *it = list; it->if_index != 0; ++it) {
+      if (it->if_index >= table.size()) {
+        table.resize(it->if_index + 1);
+      }
+      table[it->if_index] = it->if_name;
+    }
+    if_freenameindex(list);
+
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    names.swap(table);
+    lastRefresh = std::chrono::steady_clock::now();
+    stale.store(false, std::memory_order_release);
+    refreshCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void InterfaceNameCache::invalidate() {
+    stale.store(true, std::memory_order_release);
+  }
+
+  uint64_t InterfaceNameCache::getRefreshCount() {
+    return refreshCount.load(std::memory_order_relaxed);
+  }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,293 @@
+/**
+ * @file routing/neighbor.cpp
+ * @brief ARP and NDP neighbor table implementation
+ * @details Decodes NET_RT_FLAGS/RTF_LLINFO dumps in place and hands static
+ * entry changes to a pooled RouteBatch
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <metrics/metrics.hpp>
+#include <mutex>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <netinet6/nd6.h>
+#include <routing/names.hpp>
+#include <routing/neighbor.hpp>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <system/error.hpp>
+#include <system/sockaddr.hpp>
+#include <system/sysctl.hpp>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    NeighborState ndState(int state) {
+      switch (state) {
+      case ND6_LLINFO_INCOMPLETE:
+        return NeighborState::INCOMPLETE;
+      case ND6_LLINFO_REACHABLE:
+        return NeighborState::REACHABLE;
+      case ND6_LLINFO_STALE:
+        return NeighborState::STALE;
+      case ND6_LLINFO_DELAY:
+        return NeighborState::DELAY;
+      case ND6_LLINFO_PROBE:
+        return NeighborState::PROBE;
+      default:
+        return NeighborState::UNKNOWN;
+      }
+    }
+
+  } // namespace
+
+  bool NeighborRecord::fromMessage(const struct rt_msghdr *rtm,
+                                   NeighborRecord &record) {
+    record = NeighborRecord{};
+    if (!rtm || rtm->rtm_version != RTM_VERSION) {
+      return false;
+    }
+    record.flags = static_cast<uint32_t>(rtm->rtm_flags);
+    record.expire = static_cast<uint32_t>(rtm->rtm_rmx.rmx_expire);
+    record.index = rtm->rtm_index;
+
+    const struct sockaddr *addrs[RTAX_MAX];
+    system::splitAddresses(reinterpret_cast<const char *>(rtm + 1),
+                           reinterpret_cast<const char *>(rtm) +
+                               rtm->rtm_msglen,
+                           rtm->rtm_addrs, addrs);
+
+    for (int i = 0; i < RTAX_MAX; ++i) {
+      const struct sockaddr *sa = addrs[i];
+      if (!sa) {
+        continue;
+      }
+
+      if (i == RTAX_DST) {
+        if (sa->sa_family == AF_INET) {
+          auto *sin = reinterpret_cast<const struct sockaddr_in *>(sa);
+          std::memcpy(record.address.data(), &sin->sin_addr, 4);
+        } else if (sa->sa_family == AF_INET6) {
+          auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(sa);
+          std::memcpy(record.address.data(), &sin6->sin6_addr, 16);
+          record.scope = static_cast<uint16_t>(sin6->sin6_scope_id);
+        } else {
+          return false;
+        }
+        record.family = sa->sa_family;
+      } else if (i == RTAX_GATEWAY && sa->sa_family == AF_LINK) {
+        auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(sa);
+        if (sdl->sdl_index != 0) {
+          record.index = sdl->sdl_index;
+        }
+        if (sdl->sdl_alen == ethernet::MacAddress::ADDRESS_SIZE) {
+          record.mac.setBytes(reinterpret_cast<const uint8_t *>(CLLADDR(sdl)));
+        }
+      }
+    }
+
+    if (record.family == AF_UNSPEC) {
+      return false;
+    }
+    if (record.isStatic()) {
+      record.state = NeighborState::PERMANENT;
+    } else if (record.family == AF_INET6) {
+      record.state = ndState(rtm->rtm_rmx.rmx_state);
+    } else {
+      record.state = record.mac.isValid() ? NeighborState::REACHABLE
+                                          : NeighborState::INCOMPLETE;
+    }
+    return true;
+  }
+
+  bool NeighborRecord::isStatic() const {
+    return (flags & RTF_STATIC) != 0 || expire == 0;
+  }
+
+  std::string NeighborRecord::formatAddress() const {
+    char text[INET6_ADDRSTRLEN] = {0};
+    if (family != AF_INET && family != AF_INET6) {
+      return "";
+    }
+    inet_ntop(family, address.data(), text, sizeof(text));
+    std::string result = text;
+    if (family == AF_INET6 && scope > 0 && result.rfind("fe80::", 0) == 0) {
+      std::string name = InterfaceNameCache::getName(scope);
+      if (!name.empty()) {
+        result += "%" + name;
+      }
+    }
+    return result;
+  }
+
+  std::string NeighborRecord::formatInterface() const {
+    std::string name = InterfaceNameCache::getName(index);
+    return name.empty() ? "unknown" : name;
+  }
+
+  std::string NeighborRecord::formatState() const {
+    switch (state) {
+    case NeighborState::INCOMPLETE:
+      return "I";
+    case NeighborState::REACHABLE:
+      return "R";
+    case NeighborState::STALE:
+      return "S";
+    case NeighborState::DELAY:
+      return "D";
+    case NeighborState::PROBE:
+      return "P";
+    case NeighborState::PERMANENT:
+      return "N";
+    default:
+      return "?";
+    }
+  }
+
+  class NeighborTable::Impl {
+  public:
+    bool forEachNeighbor(int family, const NeighborVisitor &visitor) const {
+      InterfaceNameCache::invalidate();
+      static constexpr int families[] = {AF_INET, AF_INET6};
+      for (int af : families) {
+        if (family != AF_UNSPEC && family != af) {
+          continue;
+        }
+        if (!walk(af, visitor)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool getRecords(std::vector<NeighborRecord> &records, int family) const {
+      records.clear();
+      return forEachNeighbor(family, [&records](const NeighborRecord &record) {
+        records.push_back(record);
+        return true;
+      });
+    }
+
+    std::vector<RouteResult> runBatch(bool add,
+                                      std::span<const NeighborSpec> neighbors,
+                                      const RouteBatchOptions &options) {
+      std::unique_ptr<RouteBatch> batch = acquireBatch();
+      auto results = add ? batch->addNeighbors(neighbors, options)
+                         : batch->removeNeighbors(neighbors, options);
+      size_t failed = std::count_if(
+          results.begin(), results.end(),
+          [](const RouteResult &result) { return !result.succeeded(); });
+      if (failed > 0) {
+        lastError_ = std::to_string(failed) + " of " +
+                     std::to_string(results.size()) + " neighbors failed";
+        std::string detail = batch->getLastError();
+        if (!detail.empty()) {
+          lastError_ += ": " + detail;
+        }
+      }
+      releaseBatch(std::move(batch));
+      return results;
+    }
+
+    std::string getLastError() const { return lastError_.get(); }
+
+  private:
+    mutable system::ThreadError lastError_;
+    std::mutex batchMutex_;
+    std::vector<std::unique_ptr<RouteBatch>> idleBatches_;
+
+    std::unique_ptr<RouteBatch> acquireBatch() {
+      std::lock_guard<std::mutex> lock(batchMutex_);
+      if (idleBatches_.empty()) {
+        return std::make_unique<RouteBatch>();
+      }
+      std::unique_ptr<RouteBatch> batch = std::move(idleBatches_.back());
+      idleBatches_.pop_back();
+      return batch;
+    }
+
+    void releaseBatch(std::unique_ptr<RouteBatch> batch) {
+      std::lock_guard<std::mutex> lock(batchMutex_);
+      idleBatches_.push_back(std::move(batch));
+    }
+
+    // Dump one family's link-layer entries into the thread's sysctl buffer
+    // and decode them in place
+    bool walk(int af, const NeighborVisitor &visitor) const {
+      int mib[] = {CTL_NET, PF_ROUTE, 0, af, NET_RT_FLAGS, RTF_LLINFO};
+
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!buffer.fetch(mib)) {
+        lastError_ = "Failed to dump neighbor table: " + buffer.getLastError();
+        return false;
+      }
+
+      const char *ptr = buffer.data();
+      const char *end = ptr + buffer.size();
+      while (ptr < end) {
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(ptr);
+        if (rtm->rtm_msglen == 0) {
+          break;
+        }
+        NeighborRecord record;
+        if (NeighborRecord::fromMessage(rtm, record) && !visitor(record)) {
+          return false;
+        }
+        ptr += rtm->rtm_msglen;
+      }
+      return true;
+    }
+  };
+
+  NeighborTable::NeighborTable() : pImpl(std::make_unique<Impl>()) {}
+
+  NeighborTable::~NeighborTable() = default;
+
+  bool NeighborTable::forEachNeighbor(int family,
+                                      const NeighborVisitor &visitor) const {
+    LIBFREEBSDNET_METRICS_OPERATION("NeighborTable::forEachNeighbor");
+    return pImpl->forEachNeighbor(family, visitor);
+  }
+
+  std::vector<NeighborRecord> NeighborTable::getRecords(int family) const {
+    LIBFREEBSDNET_METRICS_OPERATION("NeighborTable::getRecords");
+    std::vector<NeighborRecord> records;
+    pImpl->getRecords(records, family);
+    return records;
+  }
+
+  bool NeighborTable::getRecords(std::vector<NeighborRecord> &records,
+                                 int family) const {
+    LIBFREEBSDNET_METRICS_OPERATION("NeighborTable::getRecords");
+    return pImpl->getRecords(records, family);
+  }
+
+  std::vector<RouteResult>
+  NeighborTable::add(std::span<const NeighborSpec> neighbors,
+                     const RouteBatchOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("NeighborTable::add");
+    return pImpl->runBatch(true, neighbors, options);
+  }
+
+  std::vector<RouteResult>
+  NeighborTable::remove(std::span<const NeighborSpec> neighbors,
+                        const RouteBatchOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("NeighborTable::remove");
+    return pImpl->runBatch(false, neighbors, options);
+  }
+
+  std::string NeighborTable::getLastError() const {
+    return pImpl->getLastError();
+  }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,324 @@
+/**
+ * @file routing/nexthop.cpp
+ * @brief Kernel nexthop and nexthop group table implementation
+ * @details Decodes NET_RT_NHOP and NET_RT_NHGRP dumps into flat sorted
+ * vectors
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <net/route/nhop.h>
+#include <netinet/in.h>
+#include <routing/nexthop.hpp>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <system/sysctl.hpp>
+#include <unordered_map>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    // FNV-1a over a sorted member list; groups are matched by member set
+    uint64_t hashMembers(int family, std::span<const NexthopMember> group) {
+      uint64_t hash = 0xcbf29ce484222325ull ^ static_cast<uint64_t>(family);
+      for (const NexthopMember &member : group) {
+        hash ^= member.id;
+        hash *= 0x100000001b3ull;
+        hash ^= member.weight;
+        hash *= 0x100000001b3ull;
+      }
+      return hash;
+    }
+
+    bool byFamilyAndId(uint8_t af, uint32_t a, uint8_t bf, uint32_t b) {
+      return af != bf ? af < bf : a < b;
+    }
+
+  } // namespace
+
+  std::string NexthopRecord::formatGateway() const {
+    char text[INET6_ADDRSTRLEN] = {0};
+    switch (gatewayFamily) {
+    case AF_INET:
+    case AF_INET6:
+      inet_ntop(gatewayFamily, gateway.data(), text, sizeof(text));
+      return text;
+    case AF_LINK: {
+      if (gatewayLength == 0) {
+        return "link#" + std::to_string(index);
+      }
+      std::string result;
+      char octet[4];
+      for (uint8_t i = 0; i < gatewayLength; ++i) {
+        std::snprintf(octet, sizeof(octet), i ? ":%02x" : "%02x", gateway[i]);
+        result += octet;
+      }
+      return result;
+    }
+    default:
+      return "";
+    }
+  }
+
+  class NexthopTable::Impl {
+  public:
+    int fib = 0;
+    std::vector<NexthopRecord> nexthops;
+    std::vector<NexthopGroup> groups;
+    std::vector<NexthopMember> members;
+    std::unordered_multimap<uint64_t, uint32_t> groupsByMembers;
+    std::string lastError;
+
+    bool refresh(int target) {
+      fib = target;
+      nexthops.clear();
+      groups.clear();
+      members.clear();
+      groupsByMembers.clear();
+
+      for (int af : {AF_INET, AF_INET6}) {
+        if (!dumpNexthops(af) || !dumpGroups(af)) {
+          return false;
+        }
+      }
+
+      // The kernel dumps in index order; sort anyway so lookups can rely
+      // on it
+      std::sort(nexthops.begin(), nexthops.end(),
+                [](const NexthopRecord &a, const NexthopRecord &b) {
+                  return byFamilyAndId(a.family, a.id, b.family, b.id);
+                });
+      std::sort(groups.begin(), groups.end(),
+                [](const NexthopGroup &a, const NexthopGroup &b) {
+                  return byFamilyAndId(a.family, a.id, b.family, b.id);
+                });
+      groupsByMembers.reserve(groups.size());
+      for (uint32_t i = 0; i < groups.size(); ++i) {
+        const NexthopGroup &group = groups[i];
+        auto grouped = std::span(members).subspan(group.first, group.count);
+        groupsByMembers.emplace(hashMembers(group.family, grouped), i);
+      }
+      return true;
+    }
+
+    // A route's paths are only its group if the weights match too; the
+    // same nexthops at another ratio are a different group
+    const NexthopGroup *findGroup(int family,
+                                  std::span<const NexthopMember> wanted) const {
+      auto [it, end] = groupsByMembers.equal_range(hashMembers(family, wanted));
+      for (; it != end; ++it) {
+        const NexthopGroup &group = groups[it->second];
+        if (group.family != family || group.count != wanted.size()) {
+          continue;
+        }
+        bool same = true;
+        for (uint32_t m = 0; m < group.count && same; ++m) {
+          const NexthopMember &member = members[group.first + m];
+          same = member.id == wanted[m].id && member.weight == wanted[m].weight;
+        }
+        if (same) {
+          return &group;
+        }
+      }
+      return nullptr;
+    }
+
+  private:
+    bool dump(int af, int what, system::SysctlBuffer &buffer) {
+      int mib[] = {CTL_NET, PF_ROUTE, 0, af, what, 0, fib};
+      if (!buffer.fetch(mib)) {
+        lastError = "Failed to dump nexthops: " + buffer.getLastError();
+        return false;
+      }
+      return true;
+    }
+
+    bool dumpNexthops(int af) {
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!dump(af, NET_RT_NHOP, buffer)) {
+        return false;
+      }
+
+      const char *ptr = buffer.data();
+      const char *end = ptr + buffer.size();
+      while (ptr < end) {
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(ptr);
+        if (rtm->rtm_msglen == 0) {
+          break;
+        }
+        const char *msgEnd = ptr + rtm->rtm_msglen;
+        ptr = msgEnd;
+        if (rtm->rtm_version != RTM_VERSION) {
+          continue;
+        }
+
+        auto *nh = reinterpret_cast<const struct nhop_external *>(rtm + 1);
+        auto *na = reinterpret_cast<const struct nhop_addrs *>(
+            reinterpret_cast<const char *>(nh) + nh->nh_len);
+        if (reinterpret_cast<const char *>(na + 1) > msgEnd) {
+          continue;
+        }
+
+        NexthopRecord record{};
+        record.id = nh->nh_idx;
+        record.fib = nh->nh_fib;
+        record.index = static_cast<uint16_t>(nh->ifindex);
+        record.mtu = nh->nh_mtu;
+        record.flags = nh->nh_flags;
+        record.type = nh->nh_type;
+        record.family = static_cast<uint8_t>(af);
+
+        if (na->gw_sa_off != 0) {
+          auto *sa = reinterpret_cast<const struct sockaddr *>(
+              reinterpret_cast<const char *>(na) + na->gw_sa_off);
+          if (reinterpret_cast<const char *>(sa) + sa->sa_len <= msgEnd) {
+            decodeGateway(sa, record);
+          }
+        }
+        nexthops.push_back(record);
+      }
+      return true;
+    }
+
+    bool dumpGroups(int af) {
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!dump(af, NET_RT_NHGRP, buffer)) {
+        return false;
+      }
+
+      const char *ptr = buffer.data();
+      const char *end = ptr + buffer.size();
+      while (ptr < end) {
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(ptr);
+        if (rtm->rtm_msglen == 0) {
+          break;
+        }
+        const char *msgEnd = ptr + rtm->rtm_msglen;
+        ptr = msgEnd;
+        if (rtm->rtm_version != RTM_VERSION) {
+          continue;
+        }
+
+        // Group header, then the control-plane container of unique
+        // weighted nexthops
+        auto *ext = reinterpret_cast<const struct nhgrp_external *>(rtm + 1);
+        auto *cont = reinterpret_cast<const struct nhgrp_container *>(ext + 1);
+        auto *nhops =
+            reinterpret_cast<const struct nhgrp_nhop_external *>(cont + 1);
+        if (reinterpret_cast<const char *>(nhops) > msgEnd ||
+            reinterpret_cast<const char *>(nhops + cont->nhgc_count) >
+                msgEnd) {
+          continue;
+        }
+
+        NexthopGroup group{};
+        group.id = ext->nhg_idx;
+        group.first = static_cast<uint32_t>(members.size());
+        group.count = cont->nhgc_count;
+        group.family = static_cast<uint8_t>(af);
+        for (uint32_t i = 0; i < cont->nhgc_count; ++i) {
+          members.push_back({nhops[i].nh_idx, nhops[i].nh_weight});
+        }
+        std::sort(members.begin() + group.first, members.end(),
+                  [](const NexthopMember &a, const NexthopMember &b) {
+                    return a.id < b.id;
+                  });
+        groups.push_back(group);
+      }
+      return true;
+    }
+
+    static void decodeGateway(const struct sockaddr *sa,
+                              NexthopRecord &record) {
+      if (sa->sa_family == AF_INET) {
+        auto *sin = reinterpret_cast<const struct sockaddr_in *>(sa);
+        std::memcpy(record.gateway.data(), &sin->sin_addr, 4);
+      } else if (sa->sa_family == AF_INET6) {
+        auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(sa);
+        std::memcpy(record.gateway.data(), &sin6->sin6_addr, 16);
+      } else if (sa->sa_family == AF_LINK) {
+        auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(sa);
+        record.gatewayLength = std::min<uint8_t>(sdl->sdl_alen, 16);
+        std::memcpy(record.gateway.data(), CLLADDR(sdl), record.gatewayLength);
+      } else {
+        return;
+      }
+      record.gatewayFamily = sa->sa_family;
+    }
+  };
+
+  NexthopTable::NexthopTable() : pImpl(std::make_unique<Impl>()) {}
+
+  NexthopTable::~NexthopTable() = default;
+
+  NexthopTable::NexthopTable(NexthopTable &&) noexcept = default;
+
+  NexthopTable &NexthopTable::operator=(NexthopTable &&) noexcept = default;
+
+  bool NexthopTable::refresh(int fib) { return pImpl->refresh(fib); }
+
+  int NexthopTable::getFib() const { return pImpl->fib; }
+
+  const NexthopRecord *NexthopTable::find(int family, uint32_t id) const {
+    const auto &nexthops = pImpl->nexthops;
+    auto it = std::lower_bound(
+        nexthops.begin(), nexthops.end(), std::make_pair(family, id),
+        [](const NexthopRecord &record, const std::pair<int, uint32_t> &key) {
+          return byFamilyAndId(record.family, record.id,
+                               static_cast<uint8_t>(key.first), key.second);
+        });
+    if (it == nexthops.end() || it->family != family || it->id != id) {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  const NexthopGroup *NexthopTable::findGroup(int family, uint32_t id) const {
+    const auto &groups = pImpl->groups;
+    auto it = std::lower_bound(
+        groups.begin(), groups.end(), std::make_pair(family, id),
+        [](const NexthopGroup &group, const std::pair<int, uint32_t> &key) {
+          return byFamilyAndId(group.family, group.id,
+                               static_cast<uint8_t>(key.first), key.second);
+        });
+    if (it == groups.end() || it->family != family || it->id != id) {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  const NexthopGroup *
+  NexthopTable::findGroup(int family,
+                          std::span<const NexthopMember> members) const {
+    return pImpl->findGroup(family, members);
+  }
+
+  std::span<const NexthopMember>
+  NexthopTable::getMembers(const NexthopGroup &group) const {
+    return std::span<const NexthopMember>(pImpl->members)
+        .subspan(group.first, group.count);
+  }
+
+  std::span<const NexthopRecord> NexthopTable::getNexthops() const {
+    return pImpl->nexthops;
+  }
+
+  std::span<const NexthopGroup> NexthopTable::getGroups() const {
+    return pImpl->groups;
+  }
+
+  std::string NexthopTable::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,201 @@
+/**
+ * @file routing/record.cpp
+ * @brief Compact binary route record implementation
+ * @details Decodes rt_msghdr sockaddrs into RouteRecord and formats fields
+ * on demand
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <routing/names.hpp>
+#include <routing/record.hpp>
+#include <sys/socket.h>
+#include <system/sockaddr.hpp>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    std::string interfaceName(unsigned int index) {
+      return InterfaceNameCache::getName(index);
+    }
+
+    std::string formatAddress(uint8_t family,
+                              const std::array<uint8_t, 16> &bytes) {
+      char text[INET6_ADDRSTRLEN] = {0};
+      if (family == AF_INET || family == AF_INET6) {
+        inet_ntop(family, bytes.data(), text, sizeof(text));
+      }
+      return text;
+    }
+
+  } // namespace
+
+  bool RouteRecord::fromMessage(const struct rt_msghdr *rtm, uint32_t fib,
+                                RouteRecord &record) {
+    record = RouteRecord{};
+    if (!rtm || rtm->rtm_version != RTM_VERSION) {
+      return false;
+    }
+    record.flags = static_cast<uint32_t>(rtm->rtm_flags);
+    record.fib = fib;
+    record.metric = static_cast<uint32_t>(rtm->rtm_rmx.rmx_weight);
+    record.mtu = static_cast<uint32_t>(rtm->rtm_rmx.rmx_mtu);
+    record.nexthop = static_cast<uint32_t>(rtm->rtm_rmx.rmx_nhidx);
+    record.index = rtm->rtm_index;
+
+    const struct sockaddr *addrs[RTAX_MAX];
+    system::splitAddresses(reinterpret_cast<const char *>(rtm + 1),
+                           reinterpret_cast<const char *>(rtm) +
+                               rtm->rtm_msglen,
+                           rtm->rtm_addrs, addrs);
+    const struct sockaddr *mask = nullptr;
+
+    for (int i = 0; i < RTAX_MAX; ++i) {
+      const struct sockaddr *sa = addrs[i];
+      if (!sa) {
+        continue;
+      }
+
+      switch (i) {
+      case RTAX_DST:
+        if (sa->sa_family == AF_INET) {
+          auto *sin = reinterpret_cast<const struct sockaddr_in *>(sa);
+          std::memcpy(record.destination.data(), &sin->sin_addr, 4);
+        } else if (sa->sa_family == AF_INET6) {
+          auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(sa);
+          std::memcpy(record.destination.data(), &sin6->sin6_addr, 16);
+          record.scope = static_cast<uint16_t>(sin6->sin6_scope_id);
+        } else {
+          return false;
+        }
+        record.family = sa->sa_family;
+        break;
+      case RTAX_GATEWAY:
+        if (sa->sa_family == AF_INET) {
+          auto *sin = reinterpret_cast<const struct sockaddr_in *>(sa);
+          std::memcpy(record.gateway.data(), &sin->sin_addr, 4);
+        } else if (sa->sa_family == AF_INET6) {
+          auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(sa);
+          std::memcpy(record.gateway.data(), &sin6->sin6_addr, 16);
+          record.gatewayIndex = static_cast<uint16_t>(sin6->sin6_scope_id);
+        } else if (sa->sa_family == AF_LINK) {
+          auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(sa);
+          record.gatewayIndex = sdl->sdl_index;
+          record.gatewayLength = std::min<uint8_t>(sdl->sdl_alen, 16);
+          std::memcpy(record.gateway.data(), CLLADDR(sdl),
+                      record.gatewayLength);
+        } else {
+          break;
+        }
+        record.gatewayFamily = sa->sa_family;
+        break;
+      case RTAX_NETMASK:
+        mask = sa;
+        break;
+      case RTAX_IFP:
+        if (sa->sa_family == AF_LINK) {
+          auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(sa);
+          if (sdl->sdl_index != 0) {
+            record.index = sdl->sdl_index;
+          }
+        }
+        break;
+      default:
+        break;
+      }
+    }
+
+    if (record.family == AF_UNSPEC) {
+      return false;
+    }
+    if (!mask) {
+      record.prefixLength = record.family == AF_INET ? 32 : 128;
+    } else {
+      record.prefixLength = system::maskToPrefix(mask, record.family);
+    }
+    return true;
+  }
+
+  std::string RouteRecord::formatDestination() const {
+    std::string text = formatAddress(family, destination);
+    // Scope only link-local destinations, as netstat does
+    if (family == AF_INET6 && scope > 0 && text.rfind("fe80::", 0) == 0) {
+      std::string name = interfaceName(scope);
+      if (!name.empty()) {
+        text += "%" + name;
+      }
+    }
+    return text;
+  }
+
+  std::string RouteRecord::formatGateway() const {
+    switch (gatewayFamily) {
+    case AF_INET:
+      return formatAddress(AF_INET, gateway);
+    case AF_INET6: {
+      std::string text = formatAddress(AF_INET6, gateway);
+      if (gatewayIndex > 0) {
+        std::string name = interfaceName(gatewayIndex);
+        if (!name.empty()) {
+          text += "%" + name;
+        }
+      }
+      return text;
+    }
+    case AF_LINK: {
+      if (gatewayLength > 0) {
+        std::string text;
+        char octet[4];
+        for (uint8_t i = 0; i < gatewayLength; ++i) {
+          std::snprintf(octet, sizeof(octet), i ? ":%02x" : "%02x",
+                        gateway[i]);
+          text += octet;
+        }
+        return text;
+      }
+      std::string name = interfaceName(gatewayIndex);
+      if (!name.empty()) {
+        return name + " (#" + std::to_string(gatewayIndex) + ")";
+      }
+      return "link#" + std::to_string(gatewayIndex);
+    }
+    default:
+      break;
+    }
+
+    // Directly connected IPv6 routes carry no gateway; show the interface
+    if (family == AF_INET6 && index > 0) {
+      std::string name = interfaceName(index);
+      return (name.empty() ? "if" : name) + " (#" + std::to_string(index) +
+             ")";
+    }
+    return "";
+  }
+
+  std::string RouteRecord::formatInterface() const {
+    std::string name = interfaceName(index);
+    if (name.empty()) {
+      name = interfaceName(scope);
+    }
+    return name.empty() ? "unknown" : name;
+  }
+
+  std::string RouteRecord::formatNetmask() const {
+    if (flags & RTF_HOST) {
+      return "";
+    }
+    return std::to_string(prefixLength);
+  }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,516 @@
+/**
+ * @file routing/snapshot.cpp
+ * @brief Memory-mapped route snapshot implementation
+ * @details Lays sorted record arrays out at aligned offsets behind a fixed
+ * header and queries them in place through mmap(2)
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <net/if_dl.h>
+#include <netinet/in.h>
+#include <routing/snapshot.hpp>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    constexpr std::array<char, 8> MAGIC = {'F', 'B', 'N', 'E',
+                                           'T', 'R', 'T', '\0'};
+    constexpr size_t ALIGNMENT = 64;
+
+    struct Section {
+      uint64_t offset;
+      uint64_t count;
+    };
+
+    struct FileHeader {
+      std::array<char, 8> magic;
+      uint32_t version;
+      uint32_t headerSize;
+      int64_t timestamp;
+      uint32_t routeSize;
+      uint32_t interfaceSize;
+      uint32_t neighborSize;
+      uint32_t indexSize;
+      Section routes;
+      Section interfaces;
+      Section neighbors;
+      Section index;
+    };
+
+    // Routes of one FIB and family; lengths has bit n set when a route
+    // with prefix length n is present
+    struct IndexEntry {
+      uint32_t fib;
+      uint32_t family;
+      uint64_t first;
+      uint64_t count;
+      std::array<uint64_t, 3> lengths;
+    };
+
+    bool routeLess(const RouteRecord &a, const RouteRecord &b) {
+      if (a.fib != b.fib) {
+        return a.fib < b.fib;
+      }
+      if (a.family != b.family) {
+        return a.family < b.family;
+      }
+      if (a.destination != b.destination) {
+        return a.destination < b.destination;
+      }
+      return a.prefixLength < b.prefixLength;
+    }
+
+    bool neighborLess(const NeighborRecord &a, const NeighborRecord &b) {
+      if (a.family != b.family) {
+        return a.family < b.family;
+      }
+      return a.address < b.address;
+    }
+
+    // Position of (destination, prefix length) within one FIB/family range
+    struct RouteKey {
+      std::array<uint8_t, 16> destination;
+      uint8_t prefixLength;
+    };
+
+    bool keyLess(const RouteRecord &record, const RouteKey &key) {
+      if (record.destination != key.destination) {
+        return record.destination < key.destination;
+      }
+      return record.prefixLength < key.prefixLength;
+    }
+
+    bool keyGreater(const RouteKey &key, const RouteRecord &record) {
+      if (key.destination != record.destination) {
+        return key.destination < record.destination;
+      }
+      return key.prefixLength < record.prefixLength;
+    }
+
+    size_t alignUp(size_t offset) {
+      return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    int toFamily(const types::Address &address) {
+      if (!address.isValid()) {
+        return AF_UNSPEC;
+      }
+      return address.isIPv4() ? AF_INET : AF_INET6;
+    }
+
+    std::array<uint8_t, 16> toBytes(const types::Address &address) {
+      std::array<uint8_t, 16> bytes{};
+      auto source = address.getBytes();
+      std::copy(source.begin(), source.end(), bytes.begin());
+      return bytes;
+    }
+
+    // Clear (or, with fill, set) every bit after the first length bits
+    std::array<uint8_t, 16> applyMask(std::array<uint8_t, 16> bytes,
+                                      int length, bool fill, int bits) {
+      for (int i = 0; i < bits / 8; ++i) {
+        int keep = std::clamp(length - i * 8, 0, 8);
+        uint8_t mask = static_cast<uint8_t>(0xff00 >> keep);
+        bytes[i] = fill ? (bytes[i] | static_cast<uint8_t>(~mask))
+                        : (bytes[i] & mask);
+      }
+      return bytes;
+    }
+
+    bool writeAll(int fd, const char *data, size_t size) {
+      while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+      }
+      return true;
+    }
+
+  } // namespace
+
+  class RouteSnapshot::Impl {
+  public:
+    void *base = MAP_FAILED;
+    size_t length = 0;
+    const FileHeader *header = nullptr;
+    std::span<const RouteRecord> routes;
+    std::span<const SnapshotInterface> interfaces;
+    std::span<const NeighborRecord> neighbors;
+    std::span<const IndexEntry> index;
+    std::string lastError;
+
+    ~Impl() { close(); }
+
+    void close() {
+      if (base != MAP_FAILED) {
+        munmap(base, length);
+      }
+      base = MAP_FAILED;
+      length = 0;
+      header = nullptr;
+      routes = {};
+      interfaces = {};
+      neighbors = {};
+      index = {};
+    }
+
+    bool open(const std::string &path) {
+      close();
+      int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        lastError = "Failed to open " + path + ": " + strerror(errno);
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 ||
+          static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        lastError = "Not a route snapshot: " + path;
+        return false;
+      }
+      length = static_cast<size_t>(st.st_size);
+      base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (base == MAP_FAILED) {
+        lastError = "Failed to map " + path + ": " + strerror(errno);
+        length = 0;
+        return false;
+      }
+
+      header = static_cast<const FileHeader *>(base);
+      if (header->magic != MAGIC || header->version != VERSION ||
+          header->headerSize != sizeof(FileHeader) ||
+          header->routeSize != sizeof(RouteRecord) ||
+          header->interfaceSize != sizeof(SnapshotInterface) ||
+          header->neighborSize != sizeof(NeighborRecord) ||
+          header->indexSize != sizeof(IndexEntry)) {
+        lastError = "Unsupported route snapshot format: " + path;
+        close();
+        return false;
+      }
+      if (!section(header->routes, routes) ||
+          !section(header->interfaces, interfaces) ||
+          !section(header->neighbors, neighbors) ||
+          !section(header->index, index)) {
+        lastError = "Truncated route snapshot: " + path;
+        close();
+        return false;
+      }
+      for (const IndexEntry &entry : index) {
+        if (entry.first > routes.size() ||
+            entry.count > routes.size() - entry.first) {
+          lastError = "Corrupt route snapshot index: " + path;
+          close();
+          return false;
+        }
+      }
+      return true;
+    }
+
+    const IndexEntry *findIndex(uint32_t fib, int family) const {
+      for (const IndexEntry &entry : index) {
+        if (entry.fib == fib && entry.family == static_cast<uint32_t>(family)) {
+          return &entry;
+        }
+      }
+      return nullptr;
+    }
+
+    std::span<const RouteRecord> select(uint32_t fib, int family) const {
+      const IndexEntry *entry = findIndex(fib, family);
+      if (!entry) {
+        return {};
+      }
+      return routes.subspan(entry->first, entry->count);
+    }
+
+  private:
+    template <typename T>
+    bool section(const Section &where, std::span<const T> &out) {
+      if (where.offset % alignof(T) != 0 || where.offset > length ||
+          where.count > (length - where.offset) / sizeof(T)) {
+        return false;
+      }
+      out = std::span<const T>(reinterpret_cast<const T *>(
+                                   static_cast<const char *>(base) +
+                                   where.offset),
+                               where.count);
+      return true;
+    }
+  };
+
+  RouteSnapshot::RouteSnapshot() : pImpl(std::make_unique<Impl>()) {}
+
+  RouteSnapshot::~RouteSnapshot() = default;
+
+  bool RouteSnapshot::write(const std::string &path,
+                            std::span<const RouteRecord> routes,
+                            std::span<const SnapshotInterface> interfaces,
+                            std::span<const NeighborRecord> neighbors,
+                            std::string &error) {
+    std::vector<RouteRecord> sortedRoutes(routes.begin(), routes.end());
+    std::sort(sortedRoutes.begin(), sortedRoutes.end(), routeLess);
+    std::vector<SnapshotInterface> sortedInterfaces(interfaces.begin(),
+                                                    interfaces.end());
+    std::sort(sortedInterfaces.begin(), sortedInterfaces.end(),
+              [](const SnapshotInterface &a, const SnapshotInterface &b) {
+                return a.index < b.index;
+              });
+    std::vector<NeighborRecord> sortedNeighbors(neighbors.begin(),
+                                                neighbors.end());
+    std::sort(sortedNeighbors.begin(), sortedNeighbors.end(), neighborLess);
+
+    std::vector<IndexEntry> index;
+    for (size_t i = 0; i < sortedRoutes.size(); ++i) {
+      const RouteRecord &route = sortedRoutes[i];
+      if (index.empty() || index.back().fib != route.fib ||
+          index.back().family != route.family) {
+        index.push_back({route.fib, route.family, i, 0, {}});
+      }
+      IndexEntry &entry = index.back();
+      ++entry.count;
+      entry.lengths[route.prefixLength / 64] |= 1ull
+                                                << (route.prefixLength % 64);
+    }
+
+    FileHeader header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.headerSize = sizeof(FileHeader);
+    header.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+    header.routeSize = sizeof(RouteRecord);
+    header.interfaceSize = sizeof(SnapshotInterface);
+    header.neighborSize = sizeof(NeighborRecord);
+    header.indexSize = sizeof(IndexEntry);
+
+    size_t offset = alignUp(sizeof(FileHeader));
+    auto place = [&offset](Section &where, size_t count, size_t size) {
+      where.offset = offset;
+      where.count = count;
+      offset = alignUp(offset + count * size);
+    };
+    place(header.routes, sortedRoutes.size(), sizeof(RouteRecord));
+    place(header.interfaces, sortedInterfaces.size(),
+          sizeof(SnapshotInterface));
+    place(header.neighbors, sortedNeighbors.size(), sizeof(NeighborRecord));
+    place(header.index, index.size(), sizeof(IndexEntry));
+
+    std::vector<char> image(offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    auto copy = [&image](const Section &where, const void *data,
+                         size_t bytes) {
+      if (bytes > 0) {
+        std::memcpy(image.data() + where.offset, data, bytes);
+      }
+    };
+    copy(header.routes, sortedRoutes.data(),
+         sortedRoutes.size() * sizeof(RouteRecord));
+    copy(header.interfaces, sortedInterfaces.data(),
+         sortedInterfaces.size() * sizeof(SnapshotInterface));
+    copy(header.neighbors, sortedNeighbors.data(),
+         sortedNeighbors.size() * sizeof(NeighborRecord));
+    copy(header.index, index.data(), index.size() * sizeof(IndexEntry));
+
+    std::string temporary = path + ".tmp." + std::to_string(getpid());
+    int fd = ::open(temporary.c_str(),
+                    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      error = "Failed to create " + temporary + ": " + strerror(errno);
+      return false;
+    }
+    bool ok = writeAll(fd, image.data(), image.size()) && fsync(fd) == 0;
+    int savedErrno = errno;
+    ::close(fd);
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+      if (ok) {
+        savedErrno = errno;
+      }
+      unlink(temporary.c_str());
+      error = "Failed to write " + path + ": " + strerror(savedErrno);
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<SnapshotInterface> RouteSnapshot::captureInterfaces() {
+    std::vector<SnapshotInterface> result;
+    struct ifaddrs *ifaddrs;
+    if (getifaddrs(&ifaddrs) != 0) {
+      return result;
+    }
+    for (struct ifaddrs *ifa = ifaddrs; ifa != nullptr; ifa = ifa->ifa_next) {
+      if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_LINK) {
+        continue;
+      }
+      auto *sdl = reinterpret_cast<const struct sockaddr_dl *>(ifa->ifa_addr);
+      SnapshotInterface record{};
+      std::strncpy(record.name.data(), ifa->ifa_name, record.name.size() - 1);
+      record.flags = ifa->ifa_flags;
+      record.index = sdl->sdl_index;
+      record.linkLength =
+          std::min<uint8_t>(sdl->sdl_alen, static_cast<uint8_t>(8));
+      std::memcpy(record.link.data(), CLLADDR(sdl), record.linkLength);
+      if (ifa->ifa_data) {
+        auto *data = static_cast<const struct if_data *>(ifa->ifa_data);
+        record.mtu = data->ifi_mtu;
+        record.type = data->ifi_type;
+      }
+      result.push_back(record);
+    }
+    freeifaddrs(ifaddrs);
+    std::sort(result.begin(), result.end(),
+              [](const SnapshotInterface &a, const SnapshotInterface &b) {
+                return a.index < b.index;
+              });
+    return result;
+  }
+
+  bool RouteSnapshot::open(const std::string &path) {
+    return pImpl->open(path);
+  }
+
+  void RouteSnapshot::close() { pImpl->close(); }
+
+  bool RouteSnapshot::isOpen() const { return pImpl->header != nullptr; }
+
+  int64_t RouteSnapshot::getTimestamp() const {
+    return pImpl->header ? pImpl->header->timestamp : 0;
+  }
+
+  std::span<const RouteRecord> RouteSnapshot::getRoutes() const {
+    return pImpl->routes;
+  }
+
+  std::span<const RouteRecord> RouteSnapshot::getRoutes(uint32_t fib) const {
+    // Index entries follow route order, so a FIB's families are adjacent
+    size_t first = 0;
+    size_t count = 0;
+    for (const IndexEntry &entry : pImpl->index) {
+      if (entry.fib != fib) {
+        continue;
+      }
+      if (count == 0) {
+        first = entry.first;
+      }
+      count = entry.first + entry.count - first;
+    }
+    return pImpl->routes.subspan(first, count);
+  }
+
+  std::span<const RouteRecord> RouteSnapshot::getRoutes(uint32_t fib,
+                                                        int family) const {
+    return pImpl->select(fib, family);
+  }
+
+  std::span<const SnapshotInterface> RouteSnapshot::getInterfaces() const {
+    return pImpl->interfaces;
+  }
+
+  std::span<const NeighborRecord> RouteSnapshot::getNeighbors() const {
+    return pImpl->neighbors;
+  }
+
+  const RouteRecord *RouteSnapshot::lookup(const types::Address &address,
+                                           uint32_t fib) const {
+    int family = toFamily(address);
+    const IndexEntry *entry = pImpl->findIndex(fib, family);
+    if (!entry) {
+      return nullptr;
+    }
+    auto routes = pImpl->routes.subspan(entry->first, entry->count);
+    int bits = family == AF_INET ? 32 : 128;
+    std::array<uint8_t, 16> bytes = toBytes(address);
+
+    for (int length = bits; length >= 0; --length) {
+      if ((entry->lengths[length / 64] & (1ull << (length % 64))) == 0) {
+        continue;
+      }
+      RouteKey key{applyMask(bytes, length, false, bits),
+                   static_cast<uint8_t>(length)};
+      auto it = std::lower_bound(routes.begin(), routes.end(), key, keyLess);
+      if (it != routes.end() && it->destination == key.destination &&
+          it->prefixLength == key.prefixLength) {
+        return &*it;
+      }
+    }
+    return nullptr;
+  }
+
+  std::span<const RouteRecord>
+  RouteSnapshot::range(const types::Address &prefix, uint32_t fib) const {
+    int family = toFamily(prefix);
+    auto routes = pImpl->select(fib, family);
+    if (routes.empty()) {
+      return {};
+    }
+    int bits = family == AF_INET ? 32 : 128;
+    int length = prefix.getPrefixLength();
+    std::array<uint8_t, 16> bytes = toBytes(prefix);
+
+    // A route inside the prefix has its destination between the network
+    // and broadcast addresses and a prefix length no shorter; the only
+    // shorter routes in that span share the network address and sort first
+    RouteKey low{applyMask(bytes, length, false, bits),
+                 static_cast<uint8_t>(length)};
+    RouteKey high{applyMask(bytes, length, true, bits), 0xff};
+    auto first = std::lower_bound(routes.begin(), routes.end(), low, keyLess);
+    auto last = std::upper_bound(first, routes.end(), high, keyGreater);
+    return routes.subspan(static_cast<size_t>(first - routes.begin()),
+                          static_cast<size_t>(last - first));
+  }
+
+  const SnapshotInterface *
+  RouteSnapshot::findInterface(unsigned int index) const {
+    auto interfaces = pImpl->interfaces;
+    auto it = std::lower_bound(
+        interfaces.begin(), interfaces.end(), index,
+        [](const SnapshotInterface &record, unsigned int key) {
+          return record.index < key;
+        });
+    if (it == interfaces.end() || it->index != index) {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  const NeighborRecord *
+  RouteSnapshot::findNeighbor(const types::Address &address) const {
+    NeighborRecord key{};
+    key.family = static_cast<uint8_t>(toFamily(address));
+    key.address = toBytes(address);
+    auto neighbors = pImpl->neighbors;
+    auto it =
+        std::lower_bound(neighbors.begin(), neighbors.end(), key, neighborLess);
+    if (it == neighbors.end() || it->family != key.family ||
+        it->address != key.address) {
+      return nullptr;
+    }
+    return &*it;
+  }
+
+  std::string RouteSnapshot::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::routing
@@ -0,0 +1,88 @@
+/**
+ * @file routing/stats.cpp
+ * @brief Routing table composition counters implementation
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <bit>
+#include <routing/stats.hpp>
+#include <sys/socket.h>
+
+namespace libfreebsdnet::routing {
+
+  namespace {
+
+    void bump(std::vector<uint64_t> &counts, size_t index, uint64_t by = 1) {
+      if (index >= counts.size()) {
+        counts.resize(index + 1, 0);
+      }
+      counts[index] += by;
+    }
+
+    void accumulate(std::vector<uint64_t> &into,
+                    const std::vector<uint64_t> &from) {
+      if (from.size() > into.size()) {
+        into.resize(from.size(), 0);
+      }
+      for (size_t i = 0; i < from.size(); ++i) {
+        into[i] += from[i];
+      }
+    }
+
+  } // namespace
+
+  void RouteStats::add(const RouteRecord &record) {
+    ++total;
+    if (record.family == AF_INET) {
+      ++inet;
+      ++inetPrefixLengths[std::min<size_t>(record.prefixLength, 32)];
+    } else {
+      ++inet6;
+      ++inet6PrefixLengths[std::min<size_t>(record.prefixLength, 128)];
+    }
+    for (uint32_t bits = record.flags; bits != 0; bits &= bits - 1) {
+      ++flags[std::countr_zero(bits)];
+    }
+    bump(byInterface, record.index);
+    bump(byFib, record.fib);
+  }
+
+  void RouteStats::merge(const RouteStats &other) {
+    total += other.total;
+    inet += other.inet;
+    inet6 += other.inet6;
+    for (size_t i = 0; i < inetPrefixLengths.size(); ++i) {
+      inetPrefixLengths[i] += other.inetPrefixLengths[i];
+    }
+    for (size_t i = 0; i < inet6PrefixLengths.size(); ++i) {
+      inet6PrefixLengths[i] += other.inet6PrefixLengths[i];
+    }
+    for (size_t i = 0; i < flags.size(); ++i) {
+      flags[i] += other.flags[i];
+    }
+    accumulate(byInterface, other.byInterface);
+    accumulate(byFib, other.byFib);
+  }
+
+  uint64_t RouteStats::countFlag(uint32_t flag) const {
+    if (!std::has_single_bit(flag)) {
+      return 0;
+    }
+    return flags[std::countr_zero(flag)];
+  }
+
+  void RouteStats::clear() {
+    total = 0;
+    inet = 0;
+    inet6 = 0;
+    inetPrefixLengths.fill(0);
+    inet6PrefixLengths.fill(0);
+    flags.fill(0);
+    std::fill(byInterface.begin(), byInterface.end(), 0);
+    std::fill(byFib.begin(), byFib.end(), 0);
+  }
+
+} // namespace libfreebsdnet::routing
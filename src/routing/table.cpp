@@ -7,127 +7,321 @@
  * @year 2024
  */
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <errno.h>
-#include <ifaddrs.h>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <mutex>
 #include <net/if.h>
 #include <net/if_dl.h>
 #include <net/route.h>
 #include <net/route/route_ctl.h>
 #include <netinet/in.h>
 #include <routing/entry.hpp>
+#include <routing/names.hpp>
+#include <routing/neighbor.hpp>
+#include <routing/snapshot.hpp>
 #include <routing/table.hpp>
-#include <stdexcept>
 #include <sys/socket.h>
 #include <sys/sysctl.h>
 #include <sys/types.h>
+#include <system/error.hpp>
+#include <system/sysctl.hpp>
+#include <thread>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace libfreebsdnet::routing {
 
   class RoutingTable::Impl {
   public:
-    Impl() : socket_fd(-1), lastError_("") {
-      socket_fd = socket(AF_ROUTE, SOCK_RAW, 0);
-      if (socket_fd < 0) {
-        lastError_ =
-            "Failed to create routing socket: " + std::string(strerror(errno));
-        throw std::runtime_error(lastError_);
-      }
-    }
-
     ~Impl() {
       if (socket_fd >= 0) {
         close(socket_fd);
       }
     }
 
-    /**
-     * @brief Get interface name by index using getifaddrs
-     * @param index Interface index
-     * @return Interface name or empty string if not found
-     */
-    std::string getInterfaceName(int index) const {
-      struct ifaddrs *ifap, *ifa;
-      
-      if (getifaddrs(&ifap) != 0) {
-        return "";
-      }
-
-      for (ifa = ifap; ifa != nullptr; ifa = ifa->ifa_next) {
-        if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_LINK) {
-          struct sockaddr_dl *sdl = (struct sockaddr_dl *)ifa->ifa_addr;
-          if (sdl->sdl_index == index) {
-            std::string name = ifa->ifa_name;
-            freeifaddrs(ifap);
-            return name;
-          }
-        }
-      }
-
-      freeifaddrs(ifap);
-      return "";
-    }
-
     std::vector<std::unique_ptr<RoutingEntry>> getEntries() const {
       return getEntries(0); // Default FIB
     }
 
     std::vector<std::unique_ptr<RoutingEntry>> getEntries(int fib) const {
       std::vector<std::unique_ptr<RoutingEntry>> entries;
+      auto records = getRecords(fib);
+      entries.reserve(records.size());
+      for (const auto &record : records) {
+        entries.push_back(std::make_unique<RoutingEntry>(record));
+      }
+      return entries;
+    }
+
+    std::vector<RouteRecord> getRecords(int fib) const {
+      std::vector<RouteRecord> records;
+      forEachRoute(fib, AF_UNSPEC, [&records](const RouteRecord &record) {
+        records.push_back(record);
+        return true;
+      });
+      return records;
+    }
+
+    bool forEachRoute(int fib, int family, const RouteVisitor &visitor) const {
+      // Interface names are resolved when records are formatted; rebuild
+      // the shared index table once for this dump rather than per route
+      InterfaceNameCache::invalidate();
 
       // Get both IPv4 and IPv6 routes (like FreeBSD netstat does)
       std::vector<int> address_families = {AF_INET, AF_INET6};
+      if (family != AF_UNSPEC) {
+        address_families = {family};
+      }
 
       for (int af : address_families) {
-        // Use sysctl to get routing table for specific FIB and address family
-        size_t len = 0;
-        int mib[] = {CTL_NET, PF_ROUTE, 0, af, NET_RT_DUMP, 0, fib};
+        Walk status = walk(fib, af, visitor);
+        if (status == Walk::STOPPED) {
+          return false;
+        }
+        if (status == Walk::FAILED && !skipFailure(fib, af, errno)) {
+          return false;
+        }
+      }
+      return true;
+    }
 
-        // Get the size first (like FreeBSD netstat does)
-        if (sysctl(mib, 7, nullptr, &len, nullptr, 0) < 0) {
-          // Continue with other address families if one fails
-          continue;
+    bool forEachRoute(int fib, int family, const RouteFilter &filter,
+                      const RouteVisitor &visitor) const {
+      if (filter.prefix.isValid()) {
+        int prefixFamily = filter.prefix.isIPv4() ? AF_INET : AF_INET6;
+        if (family != AF_UNSPEC && family != prefixFamily) {
+          return true;
         }
+        family = prefixFamily;
+      }
+      InterfaceNameCache::invalidate();
 
-        if (len == 0) {
-          continue;
+      std::vector<int> address_families = {AF_INET, AF_INET6};
+      if (family != AF_UNSPEC) {
+        address_families = {family};
+      }
+
+      size_t matched = 0;
+      bool limited = false;
+      auto filtered = [&](const RouteRecord &record) {
+        if (!filter.matches(record)) {
+          return true;
         }
+        if (!visitor(record)) {
+          return false;
+        }
+        if (filter.limit != 0 && ++matched >= filter.limit) {
+          limited = true;
+          return false;
+        }
+        return true;
+      };
+      for (int af : address_families) {
+        Walk status = walk(fib, af, filtered, &filter);
+        if (status == Walk::STOPPED) {
+          return limited;
+        }
+        if (status == Walk::FAILED && !skipFailure(fib, af, errno)) {
+          return false;
+        }
+      }
+      return true;
+    }
 
-        // Allocate buffer
-        std::vector<char> buffer(len);
+    bool dumpAllFibs(std::vector<std::vector<RouteRecord>> &tables,
+                     unsigned int workers) const {
+      int fibs = getFibCount();
+      if (fibs <= 0) {
+        lastError_ = "Failed to read net.fibs: " + std::string(strerror(errno));
+        return false;
+      }
+      InterfaceNameCache::invalidate();
 
-        // Get the routing table (like FreeBSD netstat does)
-        if (sysctl(mib, 7, buffer.data(), &len, nullptr, 0) < 0) {
-          // Continue with other address families if one fails
-          continue;
+      // One job per FIB and address family
+      static constexpr int families[] = {AF_INET, AF_INET6};
+      size_t jobs = static_cast<size_t>(fibs) * 2;
+      if (workers == 0) {
+        workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+      }
+      workers = std::min<size_t>(workers, jobs);
+
+      // Per-job record vectors persist across passes, and each worker reads
+      // into its thread's sysctl buffer, so repeated dumps settle into zero
+      // reallocation
+      std::lock_guard<std::mutex> lock(dumpMutex_);
+      jobRecords_.resize(jobs);
+
+      std::vector<int> errors(jobs, 0);
+      std::atomic<size_t> next{0};
+      auto worker = [&]() {
+        for (size_t job; (job = next.fetch_add(1)) < jobs;) {
+          auto &records = jobRecords_[job];
+          records.clear();
+          if (walk(static_cast<int>(job / 2), families[job % 2],
+                   [&records](const RouteRecord &record) {
+                     records.push_back(record);
+                     return true;
+                   }) == Walk::FAILED) {
+            errors[job] = errno;
+          }
         }
+      };
 
-        // Parse the routing messages
-        char *ptr = buffer.data();
-        char *end = ptr + len;
+      std::vector<std::thread> threads;
+      for (size_t slot = 1; slot < workers; ++slot) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      if (!checkJobs(errors)) {
+        return false;
+      }
 
-        while (ptr < end) {
-          struct rt_msghdr *rtm = reinterpret_cast<struct rt_msghdr *>(ptr);
+      tables.resize(fibs);
+      for (int fib = 0; fib < fibs; ++fib) {
+        const auto &inet = jobRecords_[fib * 2];
+        const auto &inet6 = jobRecords_[fib * 2 + 1];
+        auto &table = tables[fib];
+        table.clear();
+        table.reserve(inet.size() + inet6.size());
+        table.insert(table.end(), inet.begin(), inet.end());
+        table.insert(table.end(), inet6.begin(), inet6.end());
+      }
+      return true;
+    }
 
-          if (rtm->rtm_version != RTM_VERSION) {
-            ptr += rtm->rtm_msglen;
-            continue;
-          }
+    bool getAllStats(RouteStats &stats, unsigned int workers) const {
+      int fibs = getFibCount();
+      if (fibs <= 0) {
+        lastError_ = "Failed to read net.fibs: " + std::string(strerror(errno));
+        return false;
+      }
 
-          // Create routing entry
-          auto entry = parseRoutingMessage(rtm);
-          if (entry) {
-            entries.push_back(std::move(entry));
+      static constexpr int families[] = {AF_INET, AF_INET6};
+      size_t jobs = static_cast<size_t>(fibs) * 2;
+      if (workers == 0) {
+        workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+      }
+      workers = std::min<size_t>(workers, jobs);
+
+      // Counting needs no interface names, so the name cache is left alone
+      std::vector<RouteStats> partial(jobs);
+      std::vector<int> errors(jobs, 0);
+      std::atomic<size_t> next{0};
+      auto worker = [&]() {
+        for (size_t job; (job = next.fetch_add(1)) < jobs;) {
+          auto &counts = partial[job];
+          if (walk(static_cast<int>(job / 2), families[job % 2],
+                   [&counts](const RouteRecord &record) {
+                     counts.add(record);
+                     return true;
+                   }) == Walk::FAILED) {
+            errors[job] = errno;
           }
-
-          ptr += rtm->rtm_msglen;
         }
+      };
+
+      std::vector<std::thread> threads;
+      for (size_t slot = 1; slot < workers; ++slot) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      if (!checkJobs(errors)) {
+        return false;
       }
 
-      return entries;
+      stats.clear();
+      stats.byFib.resize(std::max<size_t>(stats.byFib.size(), fibs), 0);
+      for (const auto &counts : partial) {
+        stats.merge(counts);
+      }
+      return true;
+    }
+
+    bool getNexthopRoutes(int fib, std::vector<NexthopRoute> &routes,
+                          NexthopTable &nexthops) const {
+      routes.clear();
+      if (!nexthops.refresh(fib)) {
+        lastError_ = nexthops.getLastError();
+        return false;
+      }
+
+      // The dump lists each path of a multipath route as its own message,
+      // one after another; gather a prefix's paths and emit on key change
+      std::vector<RouteRecord> paths;
+      std::vector<NexthopMember> members;
+      auto flush = [&]() {
+        if (paths.empty()) {
+          return;
+        }
+        const RouteRecord &first = paths.front();
+        NexthopRoute route{};
+        route.destination = first.destination;
+        route.flags = first.flags;
+        route.scope = first.scope;
+        route.family = first.family;
+        route.prefixLength = first.prefixLength;
+
+        const NexthopGroup *group = nullptr;
+        if (paths.size() > 1) {
+          // rtsock reports each path's group weight in rmx_weight
+          members.clear();
+          for (const auto &path : paths) {
+            members.push_back({path.nexthop, path.metric});
+          }
+          std::sort(members.begin(), members.end(),
+                    [](const NexthopMember &a, const NexthopMember &b) {
+                      return a.id < b.id;
+                    });
+          group = nexthops.findGroup(first.family, members);
+        }
+        if (group) {
+          route.nexthop = group->id;
+          route.multipath = true;
+          routes.push_back(route);
+        } else {
+          for (const auto &path : paths) {
+            route.nexthop = path.nexthop;
+            route.flags = path.flags;
+            routes.push_back(route);
+          }
+        }
+        paths.clear();
+      };
+
+      for (int af : {AF_INET, AF_INET6}) {
+        Walk status = walk(fib, af, [&](const RouteRecord &record) {
+          if (!paths.empty()) {
+            const RouteRecord &last = paths.back();
+            if (last.family != record.family ||
+                last.prefixLength != record.prefixLength ||
+                last.destination != record.destination ||
+                last.scope != record.scope) {
+              flush();
+            }
+          }
+          paths.push_back(record);
+          return true;
+        });
+        if (status == Walk::FAILED && !skipFailure(fib, af, errno)) {
+          routes.clear();
+          return false;
+        }
+        flush();
+      }
+      return true;
     }
 
     std::vector<std::unique_ptr<RoutingEntry>>
@@ -208,7 +402,7 @@ namespace libfreebsdnet::routing {
       msg.rtm.rtm_msglen = sizeof(msg);
 
       // Send routing message
-      if (write(socket_fd, &msg, sizeof(msg)) < 0) {
+      if (writeMessage(msg.rtm) < 0) {
         lastError_ =
             "Failed to add routing entry: " + std::string(strerror(errno));
         return false;
@@ -255,7 +449,7 @@ namespace libfreebsdnet::routing {
       msg.rtm.rtm_msglen = sizeof(msg);
 
       // Send routing message
-      if (write(socket_fd, &msg, sizeof(msg)) < 0) {
+      if (writeMessage(msg.rtm) < 0) {
         lastError_ =
             "Failed to delete routing entry: " + std::string(strerror(errno));
         return false;
@@ -280,7 +474,7 @@ namespace libfreebsdnet::routing {
       msg.rtm.rtm_seq = 1;
       msg.rtm.rtm_msglen = sizeof(msg);
 
-      if (write(socket_fd, &msg, sizeof(msg)) < 0) {
+      if (writeMessage(msg.rtm) < 0) {
         lastError_ =
             "Failed to flush routing table: " + std::string(strerror(errno));
         return false;
@@ -302,15 +496,45 @@ namespace libfreebsdnet::routing {
       return nullptr;
     }
 
-    bool isAccessible() const { return socket_fd >= 0; }
+    bool save(const std::string &path) const {
+      std::vector<std::vector<RouteRecord>> tables;
+      if (!dumpAllFibs(tables, 0)) {
+        return false;
+      }
+      std::vector<RouteRecord> routes;
+      size_t total = 0;
+      for (const auto &table : tables) {
+        total += table.size();
+      }
+      routes.reserve(total);
+      for (const auto &table : tables) {
+        routes.insert(routes.end(), table.begin(), table.end());
+      }
+
+      // A host without neighbors, or a failed dump, still archives routes
+      std::vector<NeighborRecord> neighbors;
+      NeighborTable().getRecords(neighbors);
 
-    std::string getLastError() const { return lastError_; }
+      std::string error;
+      if (!RouteSnapshot::write(path, routes,
+                                RouteSnapshot::captureInterfaces(), neighbors,
+                                error)) {
+        lastError_ = error;
+        return false;
+      }
+      return true;
+    }
+
+    bool isAccessible() const { return socketFd() >= 0; }
+
+    std::string getLastError() const { return lastError_.get(); }
 
     int getFibCount() const {
       // Get number of FIBs using sysctl (like FreeBSD netstat/route)
       int numfibs = -1;
       size_t len = sizeof(numfibs);
 
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
       if (sysctlbyname("net.fibs", &numfibs, &len, nullptr, 0) == -1) {
         return -1;
       }
@@ -323,6 +547,7 @@ namespace libfreebsdnet::routing {
       int defaultfib = -1;
       size_t len = sizeof(defaultfib);
 
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
       if (sysctlbyname("net.my_fibnum", &defaultfib, &len, nullptr, 0) == -1) {
         return -1;
       }
@@ -330,257 +555,324 @@ namespace libfreebsdnet::routing {
       return defaultfib;
     }
 
-  private:
-    int socket_fd;
-    mutable std::string lastError_;
-
-    std::string getNetmaskFromRoutingMessage(struct rt_msghdr *rtm) const {
-      char *ptr = reinterpret_cast<char *>(rtm + 1);
-      struct sockaddr *addr[RTAX_MAX] = {nullptr};
-
-      // First pass: collect all addresses
-      for (int i = 0; i < RTAX_MAX; i++) {
-        if (rtm->rtm_addrs & (1 << i)) {
-          addr[i] = reinterpret_cast<struct sockaddr *>(ptr);
-          ptr = reinterpret_cast<char *>(ptr) + SA_SIZE(addr[i]);
+    enum class BatchOp { ADD, REMOVE, CHANGE };
+
+    std::vector<RouteResult> runBatch(BatchOp op,
+                                      std::span<const RouteSpec> routes,
+                                      const RouteBatchOptions &options) {
+      std::unique_ptr<RouteBatch> batch = acquireBatch();
+      std::vector<RouteResult> results;
+      switch (op) {
+      case BatchOp::ADD:
+        results = batch->add(routes, options);
+        break;
+      case BatchOp::REMOVE:
+        results = batch->remove(routes, options);
+        break;
+      case BatchOp::CHANGE:
+        results = batch->change(routes, options);
+        break;
+      }
+      size_t failed = std::count_if(
+          results.begin(), results.end(),
+          [](const RouteResult &result) { return !result.succeeded(); });
+      if (failed > 0) {
+        lastError_ = std::to_string(failed) + " of " +
+                     std::to_string(results.size()) + " routes failed";
+        std::string detail = batch->getLastError();
+        if (!detail.empty()) {
+          lastError_ += ": " + detail;
         }
       }
+      releaseBatch(std::move(batch));
+      return results;
+    }
 
-      // Check if we have a netmask
-      if (addr[RTAX_NETMASK] != nullptr) {
-        struct sockaddr *mask_sa = addr[RTAX_NETMASK];
-        if (mask_sa->sa_family == AF_INET) {
-          struct sockaddr_in *sin = reinterpret_cast<struct sockaddr_in *>(mask_sa);
-          uint32_t mask = ntohl(sin->sin_addr.s_addr);
-          int prefix_length = 0;
-          if (mask == 0) {
-            prefix_length = 0; // Default route
-          } else {
-            while (mask & 0x80000000) {
-              prefix_length++;
-              mask <<= 1;
+    RouteApplyResult apply(std::span<const RouteRecord> desired, int fib,
+                           const RouteApplyOptions &options) {
+      auto managed = [&options](const RouteRecord &record) {
+        return (record.flags & options.ignoreFlags) == 0 &&
+               (options.includeInterfaceRoutes ||
+                record.gatewayFamily != AF_LINK);
+      };
+
+      // Diffing against a partial dump would re-add every missing route
+      // and delete nothing, so a failed dump sends nothing at all
+      RouteApplyResult result;
+      std::vector<RouteRecord> live;
+      if (!forEachRoute(fib, AF_UNSPEC, [&](const RouteRecord &record) {
+            if (managed(record)) {
+              live.push_back(record);
             }
-          }
-          return std::to_string(prefix_length);
-        } else if (mask_sa->sa_family == AF_INET6) {
-          struct sockaddr_in6 *sin6 = reinterpret_cast<struct sockaddr_in6 *>(mask_sa);
-          // Calculate prefix length for IPv6 like netname6 does
-          int prefix_length = 0;
-          for (int j = 0; j < 16; j++) {
-            uint8_t byte = sin6->sin6_addr.s6_addr[j];
-            if (byte == 0xff) {
-              prefix_length += 8;
-            } else if (byte != 0) {
-              while (byte & 0x80) {
-                prefix_length++;
-                byte <<= 1;
-              }
-              break;
-            }
-          }
-          return std::to_string(prefix_length);
-        }
+            return true;
+          })) {
+        result.aborted = true;
+        return result;
       }
-      return "";
-    }
-
-    std::unique_ptr<RoutingEntry>
-    parseRoutingMessage(struct rt_msghdr *rtm) const {
-      // Complete routing message parser handling all address types
-
-      char dst_str[INET6_ADDRSTRLEN] = {0};
-      char gw_str[INET6_ADDRSTRLEN] = {0};
-      char mask_str[INET6_ADDRSTRLEN] = {0};
-      char mac_str[18] = {0}; // MAC address string buffer
-      std::string interface = "unknown";
-      std::string gateway_display = "";
-      std::string netmask_display = "";
-      int link_index = -1;
-      int scope_id = -1;
-      int prefix_length = -1;
-
-      // Parse addresses from the message
-      char *ptr = reinterpret_cast<char *>(rtm + 1);
-
-      for (int i = 0; i < RTAX_MAX; i++) {
-        if (rtm->rtm_addrs & (1 << i)) {
-          struct sockaddr *sa = reinterpret_cast<struct sockaddr *>(ptr);
-
-          switch (i) {
-          case RTAX_DST:
-            if (sa->sa_family == AF_INET) {
-              struct sockaddr_in *sin =
-                  reinterpret_cast<struct sockaddr_in *>(sa);
-              inet_ntop(AF_INET, &sin->sin_addr, dst_str, INET_ADDRSTRLEN);
-            } else if (sa->sa_family == AF_INET6) {
-              struct sockaddr_in6 *sin6 =
-                  reinterpret_cast<struct sockaddr_in6 *>(sa);
-              inet_ntop(AF_INET6, &sin6->sin6_addr, dst_str, INET6_ADDRSTRLEN);
-              scope_id = sin6->sin6_scope_id;
-            }
-            break;
-          case RTAX_GATEWAY:
-            if (sa->sa_family == AF_INET) {
-              struct sockaddr_in *sin =
-                  reinterpret_cast<struct sockaddr_in *>(sa);
-              inet_ntop(AF_INET, &sin->sin_addr, gw_str, INET_ADDRSTRLEN);
-              gateway_display = std::string(gw_str);
-            } else if (sa->sa_family == AF_INET6) {
-              struct sockaddr_in6 *sin6 =
-                  reinterpret_cast<struct sockaddr_in6 *>(sa);
-              inet_ntop(AF_INET6, &sin6->sin6_addr, gw_str, INET6_ADDRSTRLEN);
-              gateway_display = std::string(gw_str);
-              if (sin6->sin6_scope_id > 0) {
-                // Add scope interface for IPv6 link-local addresses
-                std::string scope_name = getInterfaceName(sin6->sin6_scope_id);
-                if (!scope_name.empty()) {
-                  gateway_display += "%" + scope_name;
-                }
-              }
-            } else if (sa->sa_family == AF_LINK) {
-              // Gateway is a link-level address
-              struct sockaddr_dl *sdl =
-                  reinterpret_cast<struct sockaddr_dl *>(sa);
-              link_index = sdl->sdl_index;
-              if (sdl->sdl_alen > 0) {
-                // Convert MAC address to string
-                unsigned char *mac = reinterpret_cast<unsigned char *>(
-                    sdl->sdl_data + sdl->sdl_nlen);
-                snprintf(mac_str, sizeof(mac_str),
-                         "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1],
-                         mac[2], mac[3], mac[4], mac[5]);
-                gateway_display = std::string(mac_str);
-              } else {
-                // Get interface name for link index and display as "ifname
-                // (#index)"
-                std::string iface_name = getInterfaceName(link_index);
-                if (!iface_name.empty()) {
-                  gateway_display = iface_name + " (#" +
-                                   std::to_string(link_index) + ")";
-                } else {
-                  gateway_display = "link#" + std::to_string(link_index);
-                }
-              }
-            }
-            break;
-          case RTAX_NETMASK:
-            if (sa->sa_family == AF_INET) {
-              struct sockaddr_in *sin =
-                  reinterpret_cast<struct sockaddr_in *>(sa);
-              inet_ntop(AF_INET, &sin->sin_addr, mask_str, INET_ADDRSTRLEN);
-              // Calculate prefix length for IPv4
-              uint32_t mask = ntohl(sin->sin_addr.s_addr);
-              if (mask == 0) {
-                prefix_length = 0; // Default route
-              } else {
-                prefix_length = 0;
-                while (mask & 0x80000000) {
-                  prefix_length++;
-                  mask <<= 1;
-                }
-              }
-              netmask_display = std::to_string(prefix_length);
-            } else if (sa->sa_family == AF_INET6) {
-              struct sockaddr_in6 *sin6 =
-                  reinterpret_cast<struct sockaddr_in6 *>(sa);
-              inet_ntop(AF_INET6, &sin6->sin6_addr, mask_str, INET6_ADDRSTRLEN);
-              // Calculate prefix length for IPv6
-              prefix_length = 0;
-              for (int j = 0; j < 16; j++) {
-                uint8_t byte = sin6->sin6_addr.s6_addr[j];
-                if (byte == 0xff) {
-                  prefix_length += 8;
-                } else if (byte != 0) {
-                  while (byte & 0x80) {
-                    prefix_length++;
-                    byte <<= 1;
-                  }
-                  break;
-                }
-              }
-              netmask_display = std::to_string(prefix_length);
-            }
-            break;
-          case RTAX_IFP:
-            if (sa->sa_family == AF_LINK) {
-              struct sockaddr_dl *sdl =
-                  reinterpret_cast<struct sockaddr_dl *>(sa);
-              if (sdl->sdl_nlen > 0) {
-                interface = std::string(sdl->sdl_data, sdl->sdl_nlen);
-              } else {
-                // If no interface name in sockaddr_dl, try to get it from index
-                std::string iface_name = getInterfaceName(sdl->sdl_index);
-                if (!iface_name.empty()) {
-                  interface = iface_name;
-                }
-              }
-              link_index = sdl->sdl_index;
-            }
-            break;
-          case RTAX_BRD:
-            // Broadcast address - could be used for additional info
-            break;
-          case RTAX_GENMASK:
-            // Generic mask - could be used for additional info
-            break;
-          }
 
-          ptr += sa->sa_len;
+      // Indexes from another boot or host are bound by interface name
+      std::unordered_map<unsigned int, unsigned int> remap;
+      for (const SnapshotInterface &interface : options.interfaces) {
+        remap[interface.index] = if_nametoindex(interface.name.data());
+      }
+      auto resolve = [&remap, &options](uint16_t &index) {
+        if (index == 0 || options.interfaces.empty()) {
+          return true;
+        }
+        auto it = remap.find(index);
+        if (it == remap.end() || it->second == 0) {
+          return false;
+        }
+        index = static_cast<uint16_t>(it->second);
+        return true;
+      };
+
+      std::vector<RouteRecord> wanted;
+      wanted.reserve(desired.size());
+      for (const RouteRecord &record : desired) {
+        if (!managed(record)) {
+          continue;
+        }
+        RouteRecord copy = record;
+        if (!resolve(copy.index) || !resolve(copy.gatewayIndex) ||
+            !resolve(copy.scope)) {
+          ++result.failed;
+          continue;
         }
+        copy.fib = static_cast<uint32_t>(fib);
+        wanted.push_back(copy);
+      }
+      if (result.failed > 0) {
+        lastError_ = std::to_string(result.failed) +
+                     " desired routes name an interface that does not exist";
       }
 
-      // Handle IPv6 scope interface for destination
-      std::string destination_display = std::string(dst_str);
-      if (scope_id > 0 && std::string(dst_str).find("fe80::") == 0) {
-        // Add scope interface for IPv6 link-local destination addresses
-        std::string scope_name = getInterfaceName(scope_id);
-        if (!scope_name.empty()) {
-          destination_display += "%" + scope_name;
+      // Only compare what toSpec() can send, or a route differing in
+      // metric, MTU or other flags would be re-sent on every apply
+      for (auto *records : {&live, &wanted}) {
+        for (RouteRecord &record : *records) {
+          record.flags &= SETTABLE_FLAGS;
+          record.metric = 0;
+          record.mtu = 0;
         }
       }
+      size_t total = wanted.size();
+      RouteDiff diff = RouteDiff::compare(std::move(live), std::move(wanted));
+
+      result.added = diff.added.size();
+      result.changed = diff.changed.size();
+      result.removed = diff.removed.size();
+      result.unchanged = total - result.added - result.changed;
+      if (options.dryRun) {
+        return result;
+      }
 
-      // Get interface from rtm_index like netstat does
-      if (interface == "unknown" && rtm->rtm_index > 0) {
-        std::string iface_name = getInterfaceName(rtm->rtm_index);
-        if (!iface_name.empty()) {
-          interface = iface_name;
+      // Covering routes go in before their more-specifics and come out
+      // after them, so a destination always has some route
+      std::stable_sort(diff.added.begin(), diff.added.end(),
+                       [](const RouteRecord &a, const RouteRecord &b) {
+                         return a.prefixLength < b.prefixLength;
+                       });
+      std::stable_sort(diff.removed.begin(), diff.removed.end(),
+                       [](const RouteRecord &a, const RouteRecord &b) {
+                         return a.prefixLength > b.prefixLength;
+                       });
+
+      std::vector<RouteSpec> specs;
+      auto send = [&](BatchOp op) {
+        if (specs.empty()) {
+          return;
+        }
+        for (const auto &outcome : runBatch(op, specs, options.batch)) {
+          if (!outcome.succeeded()) {
+            ++result.failed;
+          }
         }
+        specs.clear();
+      };
+
+      specs.reserve(diff.added.size());
+      for (const auto &record : diff.added) {
+        specs.push_back(toSpec(record, fib));
+      }
+      send(BatchOp::ADD);
+      for (const auto &change : diff.changed) {
+        specs.push_back(toSpec(change.after, fib));
       }
+      send(BatchOp::CHANGE);
+      for (const auto &record : diff.removed) {
+        specs.push_back(toSpec(record, fib));
+      }
+      send(BatchOp::REMOVE);
+      return result;
+    }
 
-      // For IPv6 routes, try to get interface from scope_id if interface is
-      // still unknown
-      if (interface == "unknown" && scope_id > 0) {
-        std::string iface_name = getInterfaceName(scope_id);
-        if (!iface_name.empty()) {
-          interface = iface_name;
-        }
+  private:
+    // Writes on one routing socket are atomic, so it is shared by all
+    // threads; batches keep netlink parse state and are pooled instead.
+    // Dumps go through sysctl, so the socket is only opened by the first
+    // write and a read-only table never creates one.
+    mutable std::once_flag socketOnce_;
+    mutable int socket_fd = -1;
+    mutable int socketErrno_ = 0;
+    mutable system::ThreadError lastError_;
+    std::mutex batchMutex_;
+    std::vector<std::unique_ptr<RouteBatch>> idleBatches_;
+    mutable std::mutex dumpMutex_;
+    mutable std::vector<std::vector<RouteRecord>> jobRecords_;
+
+    std::unique_ptr<RouteBatch> acquireBatch() {
+      std::lock_guard<std::mutex> lock(batchMutex_);
+      if (idleBatches_.empty()) {
+        return std::make_unique<RouteBatch>();
       }
+      std::unique_ptr<RouteBatch> batch = std::move(idleBatches_.back());
+      idleBatches_.pop_back();
+      return batch;
+    }
+
+    void releaseBatch(std::unique_ptr<RouteBatch> batch) {
+      std::lock_guard<std::mutex> lock(batchMutex_);
+      idleBatches_.push_back(std::move(batch));
+    }
 
-      // Handle netmask if not present in routing message
-      if (netmask_display.empty()) {
-        netmask_display = getNetmaskFromRoutingMessage(rtm);
+    static constexpr uint32_t SETTABLE_FLAGS =
+        static_cast<uint32_t>(RouteFlag::BLACKHOLE) |
+        static_cast<uint32_t>(RouteFlag::REJECT);
+
+    static RouteSpec toSpec(const RouteRecord &record, int fib) {
+      RouteSpec spec;
+      spec.destination = types::Address(record.family == AF_INET
+                                            ? types::Address::Family::IPv4
+                                            : types::Address::Family::IPv6,
+                                        record.destination,
+                                        record.prefixLength);
+      if (record.gatewayFamily == AF_INET ||
+          record.gatewayFamily == AF_INET6) {
+        spec.gateway = record.formatGateway();
       }
+      unsigned int index =
+          record.gatewayFamily == AF_LINK && record.gatewayIndex != 0
+              ? record.gatewayIndex
+              : record.index;
+      spec.interface = InterfaceNameCache::getName(index);
+      spec.flags = record.flags & SETTABLE_FLAGS;
+      spec.fib = fib;
+      return spec;
+    }
 
-      // For IPv6 routes, set gateway to interface name (#N) where N is the interface index
-      if (gateway_display.empty() && std::string(dst_str).find(':') != std::string::npos && rtm->rtm_index > 0) {
-        std::string iface_name = getInterfaceName(rtm->rtm_index);
-        if (!iface_name.empty()) {
-          gateway_display = iface_name + " (#" + std::to_string(rtm->rtm_index) + ")";
-        } else {
-          gateway_display = "if (#" + std::to_string(rtm->rtm_index) + ")";
+    int socketFd() const {
+      std::call_once(socketOnce_, [this] {
+        LIBFREEBSDNET_METRICS_SYSCALL(SOCKET);
+        socket_fd = socket(AF_ROUTE, SOCK_RAW, 0);
+        socketErrno_ = socket_fd < 0 ? errno : 0;
+      });
+      return socket_fd;
+    }
+
+    // Send one message, rtm_msglen bytes starting at its header, with the
+    // route-write probes around it
+    ssize_t writeMessage(const struct rt_msghdr &rtm) {
+      int fd = socketFd();
+      if (fd < 0) {
+        errno = socketErrno_;
+        return -1;
+      }
+      bool traced = LIBFREEBSDNET_PROBE_ENABLED(ROUTE_WRITE_ENTRY) ||
+                    LIBFREEBSDNET_PROBE_ENABLED(ROUTE_WRITE_RETURN);
+      if (!traced) {
+        return write(fd, &rtm, rtm.rtm_msglen);
+      }
+      LIBFREEBSDNET_PROBE(ROUTE_WRITE_ENTRY, rtm.rtm_type, rtm.rtm_seq,
+                          rtm.rtm_msglen);
+      auto start = std::chrono::steady_clock::now();
+      ssize_t result = write(fd, &rtm, rtm.rtm_msglen);
+      int error = result < 0 ? errno : 0;
+      LIBFREEBSDNET_PROBE(ROUTE_WRITE_RETURN, rtm.rtm_type, rtm.rtm_seq, error,
+                          metrics::elapsedNanoseconds(start));
+      if (result < 0) {
+        errno = error;
+      }
+      return result;
+    }
+
+    // Dump one FIB/family pair into the thread's sysctl buffer and decode
+    // it in place
+    // Outcome of dumping one FIB and address family
+    enum class Walk { COMPLETE, STOPPED, FAILED };
+
+    /**
+     * @brief Decide whether a failed dump leaves the rest of the walk valid
+     * @details A kernel built without the family, or a FIB with no table
+     * for it, reports EAFNOSUPPORT or ENOENT; the family is skipped. Any
+     * other failure sets the last error
+     * @return true to continue with the next family
+     */
+    bool skipFailure(int fib, int af, int error) const {
+      if (error == EAFNOSUPPORT || error == ENOENT) {
+        return true;
+      }
+      lastError_ = "Failed to dump " +
+                   std::string(af == AF_INET6 ? "IPv6" : "IPv4") +
+                   " routes of FIB " + std::to_string(fib) + ": " +
+                   std::string(strerror(error));
+      errno = error;
+      return false;
+    }
+
+    // Report the first job of a parallel dump that failed for good
+    bool checkJobs(const std::vector<int> &errors) const {
+      static constexpr int families[] = {AF_INET, AF_INET6};
+      for (size_t job = 0; job < errors.size(); ++job) {
+        if (errors[job] != 0 &&
+            !skipFailure(static_cast<int>(job / 2), families[job % 2],
+                         errors[job])) {
+          return false;
         }
       }
+      return true;
+    }
 
-      // Create routing entry info structure
-      RoutingEntryInfo info;
-      info.destination = destination_display;
-      info.gateway =
-          gateway_display.empty() ? std::string(gw_str) : gateway_display;
-      info.interface = interface;
-      info.netmask = netmask_display;
-      info.flags = rtm->rtm_flags;
+    // On FAILED errno holds the sysctl error
+    static Walk walk(int fib, int af, const RouteVisitor &visitor,
+                     const RouteFilter *filter = nullptr) {
+      int mib[] = {CTL_NET, PF_ROUTE, 0, af, NET_RT_DUMP, 0, fib};
 
-      return std::make_unique<RoutingEntry>(info);
+      auto lease = system::SysctlBuffer::acquire();
+      auto &buffer = *lease;
+      if (!buffer.fetch(mib)) {
+        return Walk::FAILED;
+      }
+
+      // Decode each message in place into a stack record
+      const char *ptr = buffer.data();
+      const char *end = ptr + buffer.size();
+
+      while (ptr < end) {
+        auto *rtm = reinterpret_cast<const struct rt_msghdr *>(ptr);
+        if (rtm->rtm_msglen == 0) {
+          break;
+        }
+
+        // Reject on the header before decoding any sockaddrs
+        if (filter &&
+            ((filter->index != 0 && rtm->rtm_index != filter->index) ||
+             (static_cast<uint32_t>(rtm->rtm_flags) & filter->flags) !=
+                 filter->flags ||
+             (static_cast<uint32_t>(rtm->rtm_flags) & filter->excludeFlags) !=
+                 0)) {
+          ptr += rtm->rtm_msglen;
+          continue;
+        }
+
+        RouteRecord record;
+        if (RouteRecord::fromMessage(rtm, fib, record) && !visitor(record)) {
+          return Walk::STOPPED;
+        }
+
+        ptr += rtm->rtm_msglen;
+      }
+      return Walk::COMPLETE;
     }
   };
 
@@ -589,26 +881,94 @@ namespace libfreebsdnet::routing {
   RoutingTable::~RoutingTable() = default;
 
   std::vector<std::unique_ptr<RoutingEntry>> RoutingTable::getEntries() const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getEntries");
     return pImpl->getEntries();
   }
 
   std::vector<std::unique_ptr<RoutingEntry>>
   RoutingTable::getEntries(int fib) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getEntries(fib)");
     return pImpl->getEntries(fib);
   }
 
+  std::vector<RouteRecord> RoutingTable::getRecords(int fib) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getRecords");
+    return pImpl->getRecords(fib);
+  }
+
+  bool RoutingTable::forEachRoute(int fib, int family,
+                                  const RouteVisitor &visitor) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::forEachRoute");
+    return pImpl->forEachRoute(fib, family, visitor);
+  }
+
+  bool RoutingTable::forEachRoute(int fib, int family,
+                                  const RouteFilter &filter,
+                                  const RouteVisitor &visitor) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::forEachRoute(filter)");
+    return pImpl->forEachRoute(fib, family, filter, visitor);
+  }
+
+  bool RouteFilter::matches(const RouteRecord &record) const {
+    if ((index != 0 && record.index != index) ||
+        (record.flags & flags) != flags || (record.flags & excludeFlags) != 0) {
+      return false;
+    }
+    if (!prefix.isValid()) {
+      return true;
+    }
+    types::Address destination(record.family == AF_INET
+                                   ? types::Address::Family::IPv4
+                                   : types::Address::Family::IPv6,
+                               record.destination, record.prefixLength);
+    return record.prefixLength >= prefix.getPrefixLength() &&
+           prefix.contains(destination);
+  }
+
+  bool RoutingTable::dumpAllFibs(std::vector<std::vector<RouteRecord>> &tables,
+                                 unsigned int workers) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::dumpAllFibs");
+    return pImpl->dumpAllFibs(tables, workers);
+  }
+
+  bool RoutingTable::getStats(int fib, RouteStats &stats,
+                              const RouteFilter &filter) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getStats");
+    stats.clear();
+    return pImpl->forEachRoute(fib, AF_UNSPEC, filter,
+                               [&stats](const RouteRecord &record) {
+                                 stats.add(record);
+                                 return true;
+                               });
+  }
+
+  bool RoutingTable::getAllStats(RouteStats &stats,
+                                 unsigned int workers) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getAllStats");
+    return pImpl->getAllStats(stats, workers);
+  }
+
+  bool RoutingTable::getNexthopRoutes(int fib,
+                                      std::vector<NexthopRoute> &routes,
+                                      NexthopTable &nexthops) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getNexthopRoutes");
+    return pImpl->getNexthopRoutes(fib, routes, nexthops);
+  }
+
   int RoutingTable::getFibCount() const { return pImpl->getFibCount(); }
 
   int RoutingTable::getDefaultFib() const { return pImpl->getDefaultFib(); }
 
   std::vector<std::unique_ptr<RoutingEntry>>
   RoutingTable::getEntries(const std::string &destination) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getEntries(destination)");
     return pImpl->getEntries(destination);
   }
 
   bool RoutingTable::addEntry(const std::string &destination,
                               const std::string &gateway,
                               const std::string &interface, uint16_t flags) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::addEntry");
     return pImpl->addEntry(destination, gateway, interface, flags);
   }
 
@@ -616,20 +976,68 @@ namespace libfreebsdnet::routing {
                               const std::string &gateway,
                               const std::string &interface, uint16_t flags,
                               int fib) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::addEntry(fib)");
     return pImpl->addEntry(destination, gateway, interface, flags, fib);
   }
 
+  std::vector<RouteResult>
+  RoutingTable::addEntries(std::span<const RouteSpec> routes,
+                           const RouteBatchOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::addEntries");
+    return pImpl->runBatch(Impl::BatchOp::ADD, routes, options);
+  }
+
+  std::vector<RouteResult>
+  RoutingTable::deleteEntries(std::span<const RouteSpec> routes,
+                              const RouteBatchOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::deleteEntries");
+    return pImpl->runBatch(Impl::BatchOp::REMOVE, routes, options);
+  }
+
+  RouteApplyResult RoutingTable::apply(std::span<const RouteRecord> desired,
+                                       int fib,
+                                       const RouteApplyOptions &options) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::apply");
+    return pImpl->apply(desired, fib, options);
+  }
+
   bool RoutingTable::deleteEntry(const std::string &destination,
                                  const std::string &gateway) {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::deleteEntry");
     return pImpl->deleteEntry(destination, gateway);
   }
 
   bool RoutingTable::flush() { return pImpl->flush(); }
 
   std::unique_ptr<RoutingEntry> RoutingTable::getDefaultGateway() const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::getDefaultGateway");
     return pImpl->getDefaultGateway();
   }
 
+  std::unique_ptr<RoutingEntry>
+  RoutingTable::parseMessage(const struct rt_msghdr *rtm) const {
+    RouteRecord record;
+    if (!RouteRecord::fromMessage(rtm, 0, record)) {
+      return nullptr;
+    }
+    return std::make_unique<RoutingEntry>(record);
+  }
+
+  bool RoutingTable::save(const std::string &path) const {
+    LIBFREEBSDNET_METRICS_OPERATION("RoutingTable::save");
+    return pImpl->save(path);
+  }
+
+  std::unique_ptr<RouteSnapshot> RoutingTable::open(const std::string &path,
+                                                    std::string &error) {
+    auto snapshot = std::make_unique<RouteSnapshot>();
+    if (!snapshot->open(path)) {
+      error = snapshot->getLastError();
+      return nullptr;
+    }
+    return snapshot;
+  }
+
   bool RoutingTable::isAccessible() const { return pImpl->isAccessible(); }
 
   std::string RoutingTable::getLastError() const {
@@ -0,0 +1,166 @@
+/**
+ * @file system/budget.cpp
+ * @brief Shared memory budget implementation
+ * @details Registered accounts keep their size in atomics so reporting a
+ * size is lock-free; the registry lock is only taken to evict or report
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <system/budget.hpp>
+
+namespace libfreebsdnet::system {
+
+  struct CacheAccountState {
+    std::string name;
+    CachePriority priority;
+    CacheAccount::EvictFunction evict;
+    std::atomic<size_t> bytes{0};
+    std::atomic<int64_t> touched{0}; // steady_clock ticks
+    uint64_t evictions = 0;          // guarded by the registry mutex
+    size_t evictedBytes = 0;         // guarded by the registry mutex
+
+    CacheAccountState(const std::string &name, CachePriority priority,
+                      CacheAccount::EvictFunction evict)
+        : name(name), priority(priority), evict(std::move(evict)) {}
+  };
+
+  namespace {
+
+    struct Registry {
+      std::mutex mutex;
+      std::vector<CacheAccountState *> entries;
+      std::atomic<size_t> limit{0};
+      std::atomic<size_t> total{0};
+    };
+
+    Registry &registry() {
+      static Registry instance;
+      return instance;
+    }
+
+    // Saturating, since a cache may report a smaller size while its
+    // eviction is being accounted
+    size_t subtract(std::atomic<size_t> &value, size_t amount) {
+      size_t current = value.load();
+      size_t taken;
+      do {
+        taken = std::min(current, amount);
+      } while (!value.compare_exchange_weak(current, current - taken));
+      return taken;
+    }
+
+    int64_t now() {
+      return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+  } // namespace
+
+  void CacheBudget::setLimit(size_t bytes) {
+    registry().limit.store(bytes);
+    enforce();
+  }
+
+  size_t CacheBudget::getLimit() { return registry().limit.load(); }
+
+  MemoryReport CacheBudget::memoryUsage() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MemoryReport report;
+    report.limit = r.limit.load();
+    report.caches.reserve(r.entries.size());
+    for (const auto *e : r.entries) {
+      size_t bytes = e->bytes.load(std::memory_order_relaxed);
+      report.total += bytes;
+      report.caches.push_back(
+          {e->name, e->priority, bytes, e->evictions, e->evictedBytes});
+    }
+    return report;
+  }
+
+  size_t CacheBudget::enforce() {
+    Registry &r = registry();
+    size_t limit = r.limit.load();
+    if (limit == 0 || r.total.load() <= limit) {
+      return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<CacheAccountState *> order;
+    for (auto *e : r.entries) {
+      if (e->priority != CachePriority::REQUIRED && e->evict) {
+        order.push_back(e);
+      }
+    }
+    std::sort(order.begin(), order.end(), [](const auto *a, const auto *b) {
+      if (a->priority != b->priority) {
+        return a->priority < b->priority;
+      }
+      return a->touched.load() < b->touched.load();
+    });
+
+    size_t freed = 0;
+    for (auto *e : order) {
+      size_t total = r.total.load();
+      if (total <= limit) {
+        break;
+      }
+      size_t held = e->bytes.load();
+      if (held == 0) {
+        continue;
+      }
+      size_t got = std::min(e->evict(total - limit), held);
+      if (got == 0) {
+        continue;
+      }
+      got = subtract(e->bytes, got);
+      subtract(r.total, got);
+      ++e->evictions;
+      e->evictedBytes += got;
+      freed += got;
+    }
+    return freed;
+  }
+
+  CacheAccount::CacheAccount(const std::string &name, CachePriority priority,
+                             EvictFunction evict)
+      : state(std::make_unique<CacheAccountState>(name, priority,
+                                                  std::move(evict))) {
+    state->touched.store(now());
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.entries.push_back(state.get());
+  }
+
+  CacheAccount::~CacheAccount() {
+    // Waits out an eviction that may be running this account's callback
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.entries.erase(
+        std::find(r.entries.begin(), r.entries.end(), state.get()));
+    subtract(r.total, state->bytes.load());
+  }
+
+  void CacheAccount::setUsage(size_t bytes) {
+    Registry &r = registry();
+    size_t previous = state->bytes.exchange(bytes);
+    if (bytes >= previous) {
+      r.total.fetch_add(bytes - previous);
+      CacheBudget::enforce();
+    } else {
+      subtract(r.total, previous - bytes);
+    }
+  }
+
+  size_t CacheAccount::getUsage() const { return state->bytes.load(); }
+
+  void CacheAccount::touch() {
+    state->touched.store(now(), std::memory_order_relaxed);
+  }
+
+} // namespace libfreebsdnet::system
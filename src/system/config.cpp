@@ -7,127 +7,142 @@
  * @year 2024
  */
 
-#include <cstring>
-#include <sstream>
-#include <sys/sysctl.h>
-#include <sys/types.h>
+#include <array>
+#include <metrics/metrics.hpp>
+#include <mutex>
+#include <shared_mutex>
 #include <system/config.hpp>
+#include <system/tunable.hpp>
 
 namespace libfreebsdnet::system {
 
+  namespace {
+
+    enum Key : size_t {
+      FIBS,
+      ADD_ADDR_ALLFIBS,
+      IP_FORWARDING,
+      IP6_FORWARDING,
+      ROUTE_MULTIPATH,
+      ROUTE_HASH_OUTBOUND,
+      ROUTE_IPV6_NEXTHOP,
+      ROUTE_INET_ALGO,
+      ROUTE_INET6_ALGO,
+      NETISR_MAXQLEN,
+      FIB_MAX_SYNC_DELAY,
+      KEY_COUNT
+    };
+
+    struct KeyInfo {
+      const char *name;
+      bool text;
+      int64_t defaultValue; // when missing; strings default to "unknown"
+    };
+
+    constexpr std::array<KeyInfo, KEY_COUNT> KEYS = {{
+        {"net.fibs", false, 1},
+        {"net.add_addr_allfibs", false, 0},
+        {"net.inet.ip.forwarding", false, 0},
+        {"net.inet6.ip6.forwarding", false, 0},
+        {"net.route.multipath", false, 0},
+        {"net.route.hash_outbound", false, 0},
+        {"net.route.ipv6_nexthop", false, 0},
+        {"net.route.algo.inet.algo", true, 0},
+        {"net.route.algo.inet6.algo", true, 0},
+        {"net.route.netisr_maxqlen", false, 256},
+        {"net.route.algo.fib_max_sync_delay_ms", false, 1000},
+    }};
+
+  } // namespace
+
   class SystemConfig::Impl {
   public:
+    using Clock = std::chrono::steady_clock;
+
+    // Guards every member below; getters share it, refreshes own it
+    std::shared_mutex mutex;
+    SysctlBatch batch; // slot i holds KEYS[i]
+    std::chrono::milliseconds maxAge{1000};
+    Clock::time_point refreshedAt{};
+    bool fresh = false;
+    uint64_t generation = 0;
     std::string lastError;
 
-    Impl() : lastError("") {}
-
-    template <typename T>
-    T getSysctlValue(const char *name, T defaultValue) const {
-      size_t size = sizeof(T);
-      T value = defaultValue;
-
-      int mib[CTL_MAXNAME];
-      size_t miblen = CTL_MAXNAME;
-
-      if (sysctlnametomib(name, mib, &miblen) < 0) {
-        return defaultValue;
-      }
-
-      if (sysctl(mib, miblen, &value, &size, nullptr, 0) < 0) {
-        return defaultValue;
+    Impl() {
+      for (const KeyInfo &key : KEYS) {
+        batch.add(key.name);
       }
-
-      return value;
     }
 
-    std::string getSysctlString(const char *name,
-                                const std::string &defaultValue = "") const {
-      size_t size = 0;
-
-      int mib[CTL_MAXNAME];
-      size_t miblen = CTL_MAXNAME;
-
-      if (sysctlnametomib(name, mib, &miblen) < 0) {
-        return defaultValue;
-      }
-
-      // Get required buffer size
-      if (sysctl(mib, miblen, nullptr, &size, nullptr, 0) < 0) {
-        return defaultValue;
-      }
+    bool refresh() {
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      return refreshLocked();
+    }
 
-      if (size == 0) {
-        return defaultValue;
+    // Caller holds the mutex exclusively
+    bool refreshLocked() {
+      size_t changed = 0;
+      bool ok = batch.read(&changed);
+      if (!ok) {
+        lastError = batch.getLastError();
       }
-
-      std::string result(size - 1, '\0'); // -1 to exclude null terminator
-
-      if (sysctl(mib, miblen, &result[0], &size, nullptr, 0) < 0) {
-        return defaultValue;
+      // The first pass always starts a generation
+      if (changed > 0 || generation == 0) {
+        ++generation;
       }
-
-      return result;
-    }
-
-    int getFibs() const { return getSysctlValue("net.fibs", 1); }
-
-    bool getAddAddrAllFibs() const {
-      return getSysctlValue("net.add_addr_allfibs", 0) != 0;
-    }
-
-    bool getIpForwarding() const {
-      return getSysctlValue("net.inet.ip.forwarding", 0) != 0;
+      refreshedAt = Clock::now();
+      fresh = true;
+      return ok;
     }
 
-    bool getIp6Forwarding() const {
-      return getSysctlValue("net.inet6.ip6.forwarding", 0) != 0;
+    bool isFresh() const {
+      return fresh && Clock::now() - refreshedAt < maxAge;
     }
 
-    bool getRouteMultipath() const {
-      return getSysctlValue("net.route.multipath", 0) != 0;
-    }
-
-    bool getRouteHashOutbound() const {
-      return getSysctlValue("net.route.hash_outbound", 0) != 0;
-    }
-
-    bool getRouteIpv6Nexthop() const {
-      return getSysctlValue("net.route.ipv6_nexthop", 0) != 0;
+    // Shared lock on a batch no older than maxAge; a stale batch is
+    // re-read by the first thread to take the exclusive lock
+    std::shared_lock<std::shared_mutex> readLock() {
+      std::shared_lock<std::shared_mutex> shared(mutex);
+      if (isFresh()) {
+        return shared;
+      }
+      shared.unlock();
+      {
+        std::unique_lock<std::shared_mutex> unique(mutex);
+        if (!isFresh()) {
+          refreshLocked();
+        }
+      }
+      shared.lock();
+      return shared;
     }
 
-    std::string getRouteInetAlgo() const {
-      return getSysctlString("net.route.algo.inet.algo", "unknown");
+    // Caller holds the mutex
+    int64_t integerLocked(Key key) const {
+      if (!batch.isInteger(key)) {
+        return KEYS[key].defaultValue;
+      }
+      return static_cast<int64_t>(batch.getInteger(key));
     }
 
-    std::string getRouteInet6Algo() const {
-      return getSysctlString("net.route.algo.inet6.algo", "unknown");
+    // Caller holds the mutex
+    std::string stringLocked(Key key) const {
+      if (!batch.isValid(key) || batch.isInteger(key)) {
+        return "unknown";
+      }
+      return batch.getString(key);
     }
 
-    int getNetisrMaxqlen() const {
-      return getSysctlValue("net.route.netisr_maxqlen", 256);
+    int64_t getInteger(Key key) {
+      auto lock = readLock();
+      return integerLocked(key);
     }
 
-    int getFibMaxSyncDelay() const {
-      return getSysctlValue("net.route.algo.fib_max_sync_delay_ms", 1000);
-    }
+    bool getBool(Key key) { return getInteger(key) != 0; }
 
-    std::map<std::string, std::string> getAllConfig() const {
-      std::map<std::string, std::string> config;
-
-      config["net.fibs"] = std::to_string(getFibs());
-      config["net.add_addr_allfibs"] = getAddAddrAllFibs() ? "1" : "0";
-      config["net.inet.ip.forwarding"] = getIpForwarding() ? "1" : "0";
-      config["net.inet6.ip6.forwarding"] = getIp6Forwarding() ? "1" : "0";
-      config["net.route.multipath"] = getRouteMultipath() ? "1" : "0";
-      config["net.route.hash_outbound"] = getRouteHashOutbound() ? "1" : "0";
-      config["net.route.ipv6_nexthop"] = getRouteIpv6Nexthop() ? "1" : "0";
-      config["net.route.algo.inet.algo"] = getRouteInetAlgo();
-      config["net.route.algo.inet6.algo"] = getRouteInet6Algo();
-      config["net.route.netisr_maxqlen"] = std::to_string(getNetisrMaxqlen());
-      config["net.route.algo.fib_max_sync_delay_ms"] =
-          std::to_string(getFibMaxSyncDelay());
-
-      return config;
+    std::string getString(Key key) {
+      auto lock = readLock();
+      return stringLocked(key);
     }
   };
 
@@ -135,52 +150,100 @@ namespace libfreebsdnet::system {
 
   SystemConfig::~SystemConfig() = default;
 
-  int SystemConfig::getFibs() const { return pImpl->getFibs(); }
+  int SystemConfig::getFibs() const {
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getFibs");
+    return static_cast<int>(pImpl->getInteger(FIBS));
+  }
 
   bool SystemConfig::getAddAddrAllFibs() const {
-    return pImpl->getAddAddrAllFibs();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getAddAddrAllFibs");
+    return pImpl->getBool(ADD_ADDR_ALLFIBS);
   }
 
   bool SystemConfig::getIpForwarding() const {
-    return pImpl->getIpForwarding();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getIpForwarding");
+    return pImpl->getBool(IP_FORWARDING);
   }
 
   bool SystemConfig::getIp6Forwarding() const {
-    return pImpl->getIp6Forwarding();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getIp6Forwarding");
+    return pImpl->getBool(IP6_FORWARDING);
   }
 
   bool SystemConfig::getRouteMultipath() const {
-    return pImpl->getRouteMultipath();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getRouteMultipath");
+    return pImpl->getBool(ROUTE_MULTIPATH);
   }
 
   bool SystemConfig::getRouteHashOutbound() const {
-    return pImpl->getRouteHashOutbound();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getRouteHashOutbound");
+    return pImpl->getBool(ROUTE_HASH_OUTBOUND);
   }
 
   bool SystemConfig::getRouteIpv6Nexthop() const {
-    return pImpl->getRouteIpv6Nexthop();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getRouteIpv6Nexthop");
+    return pImpl->getBool(ROUTE_IPV6_NEXTHOP);
   }
 
   std::string SystemConfig::getRouteInetAlgo() const {
-    return pImpl->getRouteInetAlgo();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getRouteInetAlgo");
+    return pImpl->getString(ROUTE_INET_ALGO);
   }
 
   std::string SystemConfig::getRouteInet6Algo() const {
-    return pImpl->getRouteInet6Algo();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getRouteInet6Algo");
+    return pImpl->getString(ROUTE_INET6_ALGO);
   }
 
   int SystemConfig::getNetisrMaxqlen() const {
-    return pImpl->getNetisrMaxqlen();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getNetisrMaxqlen");
+    return static_cast<int>(pImpl->getInteger(NETISR_MAXQLEN));
   }
 
   int SystemConfig::getFibMaxSyncDelay() const {
-    return pImpl->getFibMaxSyncDelay();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getFibMaxSyncDelay");
+    return static_cast<int>(pImpl->getInteger(FIB_MAX_SYNC_DELAY));
   }
 
   std::map<std::string, std::string> SystemConfig::getAllConfig() const {
-    return pImpl->getAllConfig();
+    LIBFREEBSDNET_METRICS_OPERATION("SystemConfig::getAllConfig");
+    std::map<std::string, std::string> config;
+    // One lock for every key, so the map comes from a single refresh
+    auto lock = pImpl->readLock();
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+      auto key = static_cast<Key>(i);
+      config[KEYS[i].name] =
+          KEYS[i].text ? pImpl->stringLocked(key)
+                       : std::to_string(pImpl->integerLocked(key));
+    }
+    return config;
   }
 
-  std::string SystemConfig::getLastError() const { return pImpl->lastError; }
+  bool SystemConfig::refresh() { return pImpl->refresh(); }
+
+  void SystemConfig::invalidate() {
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->fresh = false;
+  }
+
+  void SystemConfig::setMaxAge(std::chrono::milliseconds maxAge) {
+    std::unique_lock<std::shared_mutex> lock(pImpl->mutex);
+    pImpl->maxAge = maxAge;
+  }
+
+  std::chrono::milliseconds SystemConfig::getMaxAge() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->maxAge;
+  }
+
+  uint64_t SystemConfig::getGeneration() const {
+    auto lock = pImpl->readLock();
+    return pImpl->generation;
+  }
+
+  std::string SystemConfig::getLastError() const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->mutex);
+    return pImpl->lastError;
+  }
 
 } // namespace libfreebsdnet::system
@@ -0,0 +1,79 @@
+/**
+ * @file system/error.cpp
+ * @brief Per-thread last error message implementation
+ * @details Thread-local message table keyed by object ID. The table is
+ * reached through a trivially destructible pointer so objects destroyed
+ * after their thread's thread-locals, e.g. statics on the main thread, can
+ * still tell it is gone.
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <atomic>
+#include <system/error.hpp>
+#include <unordered_map>
+
+namespace libfreebsdnet::system {
+
+  namespace {
+
+    std::atomic<uint64_t> nextId{1};
+
+    using Table = std::unordered_map<uint64_t, std::string>;
+
+    thread_local Table *table = nullptr;
+    thread_local bool finished = false;
+
+    struct Owner {
+      ~Owner() {
+        delete table;
+        table = nullptr;
+        finished = true;
+      }
+    };
+
+    thread_local Owner owner;
+
+    Table *messages() {
+      if (!table && !finished) {
+        static_cast<void>(&owner); // registers the destructor
+        table = new Table();
+      }
+      return table;
+    }
+
+  } // namespace
+
+  ThreadError::ThreadError()
+      : id(nextId.fetch_add(1, std::memory_order_relaxed)) {}
+
+  ThreadError::~ThreadError() {
+    if (table) {
+      table->erase(id);
+    }
+  }
+
+  ThreadError &ThreadError::operator=(std::string message) {
+    if (Table *local = messages()) {
+      (*local)[id] = std::move(message);
+    }
+    return *this;
+  }
+
+  ThreadError &ThreadError::operator+=(const std::string &suffix) {
+    if (Table *local = messages()) {
+      (*local)[id] += suffix;
+    }
+    return *this;
+  }
+
+  std::string ThreadError::get() const {
+    if (!table) {
+      return {};
+    }
+    auto it = table->find(id);
+    return it != table->end() ? it->second : std::string();
+  }
+
+} // namespace libfreebsdnet::system
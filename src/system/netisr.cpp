@@ -0,0 +1,233 @@
+/**
+ * @file system/netisr.cpp
+ * @brief Netisr dispatch configuration and per-queue statistics
+ * implementation
+ * @details Decodes the sysctl_netisr_* tables exported under net.isr
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <net/netisr.h>
+#include <sys/types.h>
+#include <system/netisr.hpp>
+#include <system/sysctl.hpp>
+#include <system/tunable.hpp>
+#include <utility>
+
+namespace libfreebsdnet::system {
+
+  namespace {
+
+    // Copy out a table of kernel structs that each start with their
+    // version word
+    template <typename Record>
+    bool decodeTable(const SysctlBuffer &buffer, u_int version,
+                     std::vector<Record> &records) {
+      size_t count = buffer.size() / sizeof(Record);
+      records.resize(count);
+      std::memcpy(records.data(), buffer.data(), count * sizeof(Record));
+      for (const Record &record : records) {
+        u_int recordVersion;
+        std::memcpy(&recordVersion, &record, sizeof(recordVersion));
+        if (recordVersion != version) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    double perSecond(uint64_t now, uint64_t before, double seconds) {
+      // Counters only go backwards if netisr state was torn down
+      return now >= before ? static_cast<double>(now - before) / seconds : 0;
+    }
+
+  } // namespace
+
+  class NetisrStats::Impl {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    SysctlLeaf protoLeaf;
+    SysctlLeaf workstreamLeaf;
+    SysctlLeaf workLeaf;
+    bool resolved = false;
+    SysctlBuffer buffer;
+
+    std::vector<NetisrProtocol> protocols;
+    std::vector<NetisrQueue> queues;
+    std::vector<NetisrQueue> previous;
+    Clock::time_point sampledAt{};
+    Clock::time_point previousAt{};
+    std::string lastError;
+
+    bool resolve() {
+      if (!resolved) {
+        resolved = SysctlTree::resolve("net.isr.proto", protoLeaf) &&
+                   SysctlTree::resolve("net.isr.workstream", workstreamLeaf) &&
+                   SysctlTree::resolve("net.isr.work", workLeaf);
+        if (!resolved) {
+          lastError = "net.isr statistics are not available";
+        }
+      }
+      return resolved;
+    }
+
+    bool fetch(const SysctlLeaf &leaf) {
+      if (!buffer.fetch(leaf.mib)) {
+        lastError = "Failed to read " + leaf.name + ": " +
+                    buffer.getLastError();
+        return false;
+      }
+      return true;
+    }
+  };
+
+  NetisrStats::NetisrStats() : pImpl(std::make_unique<Impl>()) {}
+
+  NetisrStats::~NetisrStats() = default;
+
+  bool NetisrStats::getConfig(NetisrConfig &config) {
+    using Dispatch = Sysctl<"net.isr.dispatch", std::string>;
+    if (!Dispatch::read(config.dispatch)) {
+      return false;
+    }
+    config.maxThreads = Sysctl<"net.isr.maxthreads", int>::get();
+    config.numThreads = Sysctl<"net.isr.numthreads", int>::get();
+    config.bindThreads = Sysctl<"net.isr.bindthreads", bool>::get();
+    config.maxQueueLimit = Sysctl<"net.isr.maxqlimit", int>::get();
+    config.defaultQueueLimit = Sysctl<"net.isr.defaultqlimit", int>::get();
+    return true;
+  }
+
+  bool NetisrStats::sample() {
+    if (!pImpl->resolve()) {
+      return false;
+    }
+
+    std::vector<struct sysctl_netisr_proto> snp;
+    std::vector<struct sysctl_netisr_workstream> snws;
+    std::vector<struct sysctl_netisr_work> snw;
+    if (!pImpl->fetch(pImpl->protoLeaf) ||
+        !decodeTable(pImpl->buffer, sysctl_netisr_proto_VERSION, snp) ||
+        !pImpl->fetch(pImpl->workstreamLeaf) ||
+        !decodeTable(pImpl->buffer, sysctl_netisr_workstream_VERSION, snws) ||
+        !pImpl->fetch(pImpl->workLeaf) ||
+        !decodeTable(pImpl->buffer, sysctl_netisr_work_VERSION, snw)) {
+      if (pImpl->buffer.getError() == 0) {
+        pImpl->lastError = "Unsupported net.isr structure version";
+      }
+      return false;
+    }
+
+    std::vector<NetisrProtocol> protocols;
+    protocols.reserve(snp.size());
+    for (const auto &entry : snp) {
+      NetisrProtocol protocol;
+      protocol.name.assign(entry.snp_name,
+                           strnlen(entry.snp_name, NETISR_NAMEMAXLEN));
+      protocol.proto = entry.snp_proto;
+      protocol.queueLimit = entry.snp_qlimit;
+      protocol.policy = entry.snp_policy;
+      protocol.dispatch = entry.snp_dispatch;
+      protocol.flags = entry.snp_flags;
+      protocols.push_back(std::move(protocol));
+    }
+
+    std::vector<NetisrQueue> queues;
+    queues.reserve(snw.size());
+    for (const auto &entry : snw) {
+      NetisrQueue queue;
+      queue.workstream = entry.snw_wsid;
+      queue.proto = entry.snw_proto;
+      for (const auto &stream : snws) {
+        if (stream.snws_wsid == entry.snw_wsid) {
+          queue.cpu = stream.snws_cpu;
+          break;
+        }
+      }
+      for (const auto &protocol : protocols) {
+        if (protocol.proto == entry.snw_proto) {
+          queue.protocol = protocol.name;
+          break;
+        }
+      }
+      queue.length = entry.snw_len;
+      queue.watermark = entry.snw_watermark;
+      queue.dispatched = entry.snw_dispatched;
+      queue.hybridDispatched = entry.snw_hybrid_dispatched;
+      queue.drops = entry.snw_qdrops;
+      queue.queued = entry.snw_queued;
+      queue.handled = entry.snw_handled;
+      queues.push_back(std::move(queue));
+    }
+
+    std::sort(queues.begin(), queues.end(),
+              [](const NetisrQueue &a, const NetisrQueue &b) {
+                return std::pair(a.workstream, a.proto) <
+                       std::pair(b.workstream, b.proto);
+              });
+    pImpl->previous = std::move(pImpl->queues);
+    pImpl->previousAt = pImpl->sampledAt;
+    pImpl->protocols = std::move(protocols);
+    pImpl->queues = std::move(queues);
+    pImpl->sampledAt = Impl::Clock::now();
+    return true;
+  }
+
+  const std::vector<NetisrProtocol> &NetisrStats::getProtocols() const {
+    return pImpl->protocols;
+  }
+
+  const std::vector<NetisrQueue> &NetisrStats::getQueues() const {
+    return pImpl->queues;
+  }
+
+  std::vector<NetisrQueueRates> NetisrStats::getRates() const {
+    std::vector<NetisrQueueRates> rates;
+    if (pImpl->previous.empty()) {
+      return rates;
+    }
+    double seconds =
+        std::chrono::duration<double>(pImpl->sampledAt - pImpl->previousAt)
+            .count();
+    if (seconds <= 0) {
+      return rates;
+    }
+
+    // Both samples are sorted by (workstream, proto), so merge them
+    auto before = pImpl->previous.begin();
+    for (const auto &queue : pImpl->queues) {
+      while (before != pImpl->previous.end() &&
+             std::pair(before->workstream, before->proto) <
+                 std::pair(queue.workstream, queue.proto)) {
+        ++before;
+      }
+      NetisrQueueRates entry;
+      entry.queue = queue;
+      if (before != pImpl->previous.end() &&
+          before->workstream == queue.workstream &&
+          before->proto == queue.proto) {
+        entry.dispatchedPerSecond =
+            perSecond(queue.dispatched + queue.hybridDispatched,
+                      before->dispatched + before->hybridDispatched, seconds);
+        entry.queuedPerSecond =
+            perSecond(queue.queued, before->queued, seconds);
+        entry.handledPerSecond =
+            perSecond(queue.handled, before->handled, seconds);
+        entry.dropsPerSecond = perSecond(queue.drops, before->drops, seconds);
+        entry.backlogPerSecond =
+            (static_cast<double>(queue.length) - before->length) / seconds;
+        double offered = entry.queuedPerSecond + entry.dropsPerSecond;
+        entry.dropRatio = offered > 0 ? entry.dropsPerSecond / offered : 0;
+      }
+      rates.push_back(std::move(entry));
+    }
+    return rates;
+  }
+
+  std::string NetisrStats::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::system
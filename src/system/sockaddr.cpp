@@ -0,0 +1,60 @@
+/**
+ * @file system/sockaddr.cpp
+ * @brief Routing message sockaddr helpers implementation
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <system/sockaddr.hpp>
+
+namespace libfreebsdnet::system {
+
+  void splitAddresses(const char *cp, const char *end, int addrs,
+                      const struct sockaddr *sa[RTAX_MAX]) {
+    for (int i = 0; i < RTAX_MAX; ++i) {
+      sa[i] = nullptr;
+      if ((addrs & (1 << i)) == 0 || cp >= end) {
+        continue;
+      }
+      sa[i] = reinterpret_cast<const struct sockaddr *>(cp);
+      cp += SA_SIZE(sa[i]);
+    }
+  }
+
+  int maskToPrefix(const struct sockaddr *mask, int family) {
+    size_t offset;
+    size_t maxBytes;
+    if (family == AF_INET) {
+      offset = offsetof(struct sockaddr_in, sin_addr);
+      maxBytes = sizeof(struct in_addr);
+    } else if (family == AF_INET6) {
+      offset = offsetof(struct sockaddr_in6, sin6_addr);
+      maxBytes = sizeof(struct in6_addr);
+    } else {
+      return 0;
+    }
+    if (!mask || mask->sa_len <= offset) {
+      return 0;
+    }
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(mask) + offset;
+    size_t len = std::min<size_t>(mask->sa_len - offset, maxBytes);
+    int prefix = 0;
+    for (size_t i = 0; i < len; ++i) {
+      uint8_t b = bytes[i];
+      while (b & 0x80) {
+        ++prefix;
+        b <<= 1;
+      }
+      if (bytes[i] != 0xff) {
+        break;
+      }
+    }
+    return prefix;
+  }
+
+} // namespace libfreebsdnet::system
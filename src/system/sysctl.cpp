@@ -0,0 +1,381 @@
+/**
+ * @file system/sysctl.cpp
+ * @brief Reusable sysctl dump buffer and subtree walker implementation
+ * @details Implements probe-free sysctl reads into a grow-only, page-aligned
+ * buffer and leaf enumeration through the sysctl meta-MIB
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <metrics/metrics.hpp>
+#include <metrics/probes.hpp>
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#include <system/sysctl.hpp>
+#include <unistd.h>
+#include <utility>
+
+namespace libfreebsdnet::system {
+
+  namespace {
+
+    // The format reply of the sysctl meta-MIB starts with the kind word
+    bool queryKind(const int *mib, size_t length, unsigned int &kind) {
+      int query[CTL_MAXNAME + 2] = {CTL_SYSCTL, CTL_SYSCTL_OIDFMT};
+      std::memcpy(query + 2, mib, length * sizeof(int));
+      char format[sizeof(u_int) + 64];
+      size_t len = sizeof(format);
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+      if (sysctl(query, static_cast<u_int>(length + 2), format, &len, nullptr,
+                 0) < 0 ||
+          len < sizeof(u_int)) {
+        return false;
+      }
+      u_int value;
+      std::memcpy(&value, format, sizeof(value));
+      kind = value;
+      return true;
+    }
+
+  } // namespace
+
+  class SysctlBuffer::Impl {
+  public:
+    struct Free {
+      void operator()(char *p) const { std::free(p); }
+    };
+
+    std::unique_ptr<char, Free> buffer;
+    size_t capacity = 0;
+    size_t length = 0;
+    size_t lastLength = 0; // size of the last successful, non-empty read
+    int error = 0;
+    std::string lastError;
+    bool leased = false; // thread's buffer only
+
+    static size_t pageSize() {
+      static const size_t page = [] {
+        long size = sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t>(size) : size_t{4096};
+      }();
+      return page;
+    }
+
+    // Room for the table to grow between reads without another round trip
+    static size_t headroom(size_t len) {
+      return std::max(len / 8, pageSize());
+    }
+
+    bool reserve(size_t len) {
+      if (len <= capacity) {
+        return true;
+      }
+      size_t page = pageSize();
+      size_t size = (len + page - 1) / page * page;
+      // Contents are always overwritten by the next read, so nothing is
+      // copied across
+      char *p = static_cast<char *>(std::aligned_alloc(page, size));
+      if (!p) {
+        return false;
+      }
+      buffer.reset(p);
+      capacity = size;
+      return true;
+    }
+
+    bool fail(const char *what) {
+      error = errno;
+      lastError = std::string(what) + ": " + std::string(strerror(error));
+      length = 0;
+      return false;
+    }
+
+    bool fetch(std::span<const int> mib) {
+      error = 0;
+      length = 0;
+      auto count = static_cast<u_int>(mib.size());
+
+      // Skip the probe while the last result plus headroom still fits
+      if (lastLength > 0 && capacity >= lastLength + headroom(lastLength)) {
+        size_t len = capacity;
+        LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+        if (sysctl(mib.data(), count, buffer.get(), &len, nullptr, 0) == 0) {
+          length = len;
+          lastLength = len;
+          return true;
+        }
+        if (errno != ENOMEM) {
+          return fail("sysctl read failed");
+        }
+      }
+
+      // The data can grow between the size probe and the read; retry on
+      // ENOMEM with the new size
+      for (int attempt = 0; attempt < 4; ++attempt) {
+        size_t len = 0;
+        LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+        if (sysctl(mib.data(), count, nullptr, &len, nullptr, 0) < 0) {
+          return fail("sysctl size probe failed");
+        }
+        if (len == 0) {
+          return true;
+        }
+        if (!reserve(len + headroom(len))) {
+          errno = ENOMEM;
+          return fail("sysctl buffer allocation failed");
+        }
+        len = capacity;
+        LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+        if (sysctl(mib.data(), count, buffer.get(), &len, nullptr, 0) == 0) {
+          length = len;
+          lastLength = len;
+          return true;
+        }
+        if (errno != ENOMEM) {
+          return fail("sysctl read failed");
+        }
+      }
+      errno = ENOMEM;
+      return fail("sysctl data kept growing");
+    }
+  };
+
+  SysctlBuffer::SysctlBuffer() : pImpl(std::make_unique<Impl>()) {}
+
+  SysctlBuffer::~SysctlBuffer() = default;
+
+  SysctlBuffer &SysctlBuffer::local() {
+    thread_local SysctlBuffer buffer;
+    return buffer;
+  }
+
+  SysctlBuffer::Lease::Lease(SysctlBuffer *buffer,
+                             std::unique_ptr<SysctlBuffer> owned)
+      : buffer(buffer), owned(std::move(owned)) {}
+
+  SysctlBuffer::Lease::Lease(Lease &&other) noexcept
+      : buffer(std::exchange(other.buffer, nullptr)),
+        owned(std::move(other.owned)) {}
+
+  SysctlBuffer::Lease::~Lease() {
+    if (buffer && !owned) {
+      buffer->pImpl->leased = false;
+    }
+  }
+
+  SysctlBuffer::Lease SysctlBuffer::acquire() {
+    SysctlBuffer &buffer = local();
+    if (buffer.pImpl->leased) {
+      auto owned = std::make_unique<SysctlBuffer>();
+      SysctlBuffer *fresh = owned.get();
+      return Lease(fresh, std::move(owned));
+    }
+    buffer.pImpl->leased = true;
+    return Lease(&buffer, nullptr);
+  }
+
+  bool SysctlBuffer::fetch(std::span<const int> mib) {
+    if (!LIBFREEBSDNET_PROBE_ENABLED(SYSCTL_ENTRY) &&
+        !LIBFREEBSDNET_PROBE_ENABLED(SYSCTL_RETURN)) {
+      return pImpl->fetch(mib);
+    }
+    int *name = const_cast<int *>(mib.data());
+    auto count = static_cast<unsigned int>(mib.size());
+    LIBFREEBSDNET_PROBE(SYSCTL_ENTRY, name, count);
+    auto start = std::chrono::steady_clock::now();
+    bool result = pImpl->fetch(mib);
+    LIBFREEBSDNET_PROBE(SYSCTL_RETURN, name, count, pImpl->error,
+                        static_cast<uint64_t>(pImpl->length),
+                        metrics::elapsedNanoseconds(start));
+    return result;
+  }
+
+  const char *SysctlBuffer::data() const { return pImpl->buffer.get(); }
+
+  size_t SysctlBuffer::size() const { return pImpl->length; }
+
+  size_t SysctlBuffer::capacity() const { return pImpl->capacity; }
+
+  int SysctlBuffer::getError() const { return pImpl->error; }
+
+  std::string SysctlBuffer::getLastError() const { return pImpl->lastError; }
+
+  bool SysctlLeaf::isInteger() const {
+    switch (kind & CTLTYPE) {
+    case CTLTYPE_INT:
+    case CTLTYPE_UINT:
+    case CTLTYPE_LONG:
+    case CTLTYPE_ULONG:
+    case CTLTYPE_S8:
+    case CTLTYPE_S16:
+    case CTLTYPE_S32:
+    case CTLTYPE_S64:
+    case CTLTYPE_U8:
+    case CTLTYPE_U16:
+    case CTLTYPE_U32:
+    case CTLTYPE_U64:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  bool SysctlLeaf::isString() const {
+    return (kind & CTLTYPE) == CTLTYPE_STRING;
+  }
+
+  bool SysctlTree::list(const std::string &prefix,
+                        std::vector<SysctlLeaf> &leaves) {
+    leaves.clear();
+    int root[CTL_MAXNAME];
+    size_t rootLength = CTL_MAXNAME;
+    if (sysctlnametomib(prefix.c_str(), root, &rootLength) < 0) {
+      return false;
+    }
+
+    // {CTL_SYSCTL, op} followed by an OID queries the sysctl meta-MIB
+    int query[CTL_MAXNAME + 2] = {CTL_SYSCTL, CTL_SYSCTL_NEXT};
+    std::memcpy(query + 2, root, rootLength * sizeof(int));
+    size_t queryLength = rootLength;
+
+    for (;;) {
+      int next[CTL_MAXNAME];
+      size_t len = sizeof(next);
+      query[1] = CTL_SYSCTL_NEXT;
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+      if (sysctl(query, static_cast<u_int>(queryLength + 2), next, &len,
+                 nullptr, 0) < 0) {
+        break; // ENOENT past the last OID
+      }
+      size_t nextLength = len / sizeof(int);
+      if (nextLength < rootLength ||
+          !std::equal(root, root + rootLength, next)) {
+        break;
+      }
+      std::memcpy(query + 2, next, nextLength * sizeof(int));
+      queryLength = nextLength;
+
+      SysctlLeaf leaf;
+      leaf.mib.assign(next, next + nextLength);
+
+      char name[1024];
+      len = sizeof(name);
+      query[1] = CTL_SYSCTL_NAME;
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+      if (sysctl(query, static_cast<u_int>(queryLength + 2), name, &len,
+                 nullptr, 0) < 0 ||
+          len == 0) {
+        continue;
+      }
+      leaf.name.assign(name, strnlen(name, len));
+
+      if (!queryKind(next, nextLength, leaf.kind)) {
+        continue;
+      }
+      leaves.push_back(std::move(leaf));
+    }
+    return true;
+  }
+
+  bool SysctlTree::resolve(const std::string &name, SysctlLeaf &leaf) {
+    int mib[CTL_MAXNAME];
+    size_t length = CTL_MAXNAME;
+    unsigned int kind = 0;
+    if (sysctlnametomib(name.c_str(), mib, &length) < 0 ||
+        !queryKind(mib, length, kind)) {
+      return false;
+    }
+    leaf.name = name;
+    leaf.mib.assign(mib, mib + length);
+    leaf.kind = kind;
+    return true;
+  }
+
+  bool SysctlTree::readInteger(const SysctlLeaf &leaf, uint64_t &value) {
+    if (!leaf.isInteger()) {
+      return false;
+    }
+    uint64_t raw = 0;
+    size_t len = sizeof(raw);
+    LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+    if (sysctl(leaf.mib.data(), static_cast<u_int>(leaf.mib.size()), &raw,
+               &len, nullptr, 0) < 0) {
+      return false;
+    }
+
+    // Reinterpret by width, sign-extending signed kinds
+    unsigned int type = leaf.kind & CTLTYPE;
+    bool isSigned = type == CTLTYPE_INT || type == CTLTYPE_LONG ||
+                    type == CTLTYPE_S8 || type == CTLTYPE_S16 ||
+                    type == CTLTYPE_S32 || type == CTLTYPE_S64;
+    switch (len) {
+    case 1: {
+      uint8_t v;
+      std::memcpy(&v, &raw, 1);
+      value = isSigned ? static_cast<uint64_t>(static_cast<int8_t>(v)) : v;
+      return true;
+    }
+    case 2: {
+      uint16_t v;
+      std::memcpy(&v, &raw, 2);
+      value = isSigned ? static_cast<uint64_t>(static_cast<int16_t>(v)) : v;
+      return true;
+    }
+    case 4: {
+      uint32_t v;
+      std::memcpy(&v, &raw, 4);
+      value = isSigned ? static_cast<uint64_t>(static_cast<int32_t>(v)) : v;
+      return true;
+    }
+    case 8:
+      value = raw;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  bool SysctlTree::readString(const SysctlLeaf &leaf, std::string &value) {
+    if (!leaf.isString()) {
+      return false;
+    }
+    auto count = static_cast<u_int>(leaf.mib.size());
+    char buffer[256];
+    size_t len = sizeof(buffer);
+    LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+    if (sysctl(leaf.mib.data(), count, buffer, &len, nullptr, 0) == 0) {
+      value.assign(buffer, strnlen(buffer, len));
+      return true;
+    }
+    if (errno != ENOMEM) {
+      return false;
+    }
+
+    // Longer than the stack buffer; the value can still grow in between
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      len = 0;
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+      if (sysctl(leaf.mib.data(), count, nullptr, &len, nullptr, 0) < 0) {
+        return false;
+      }
+      value.resize(len);
+      LIBFREEBSDNET_METRICS_SYSCALL(SYSCTL);
+      if (sysctl(leaf.mib.data(), count, value.data(), &len, nullptr, 0) ==
+          0) {
+        value.resize(strnlen(value.data(), len));
+        return true;
+      }
+      if (errno != ENOMEM) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+} // namespace libfreebsdnet::system
@@ -0,0 +1,118 @@
+/**
+ * @file system/tunable.cpp
+ * @brief Sysctl batch reader implementation
+ * @details Slot table of resolved leaves with typed value storage
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <system/tunable.hpp>
+#include <vector>
+
+namespace libfreebsdnet::system {
+
+  class SysctlBatch::Impl {
+  public:
+    struct Slot {
+      SysctlLeaf leaf;
+      bool valid = false;
+      uint64_t integer = 0;
+      std::string text;
+    };
+
+    std::vector<Slot> slots;
+    std::string scratch;
+    std::string lastError;
+  };
+
+  SysctlBatch::SysctlBatch() : pImpl(std::make_unique<Impl>()) {}
+
+  SysctlBatch::~SysctlBatch() = default;
+
+  SysctlBatch::SysctlBatch(SysctlBatch &&) noexcept = default;
+
+  SysctlBatch &SysctlBatch::operator=(SysctlBatch &&) noexcept = default;
+
+  size_t SysctlBatch::add(const std::string &name) {
+    Impl::Slot slot;
+    if (SysctlTree::resolve(name, slot.leaf)) {
+      slot.valid = slot.leaf.isInteger() || slot.leaf.isString();
+      if (!slot.valid) {
+        pImpl->lastError = "Unsupported sysctl type: " + name;
+      }
+    } else {
+      slot.leaf.name = name;
+      pImpl->lastError = "Failed to resolve " + name + ": " + strerror(errno);
+    }
+    pImpl->slots.push_back(std::move(slot));
+    return pImpl->slots.size() - 1;
+  }
+
+  bool SysctlBatch::read(size_t *changed) {
+    bool ok = true;
+    size_t differing = 0;
+    for (auto &slot : pImpl->slots) {
+      if (!slot.valid) {
+        continue;
+      }
+      if (slot.leaf.isInteger()) {
+        uint64_t value = 0;
+        if (!SysctlTree::readInteger(slot.leaf, value)) {
+          ok = false;
+          pImpl->lastError = "Failed to read " + slot.leaf.name + ": " +
+                             strerror(errno);
+          continue;
+        }
+        differing += value != slot.integer;
+        slot.integer = value;
+      } else {
+        // Read into a reused scratch string so unchanged values don't
+        // allocate
+        if (!SysctlTree::readString(slot.leaf, pImpl->scratch)) {
+          ok = false;
+          pImpl->lastError = "Failed to read " + slot.leaf.name + ": " +
+                             strerror(errno);
+          continue;
+        }
+        if (pImpl->scratch != slot.text) {
+          ++differing;
+          slot.text = pImpl->scratch;
+        }
+      }
+    }
+    if (changed) {
+      *changed = differing;
+    }
+    return ok;
+  }
+
+  size_t SysctlBatch::size() const { return pImpl->slots.size(); }
+
+  bool SysctlBatch::isValid(size_t slot) const {
+    return slot < pImpl->slots.size() && pImpl->slots[slot].valid;
+  }
+
+  bool SysctlBatch::isInteger(size_t slot) const {
+    return isValid(slot) && pImpl->slots[slot].leaf.isInteger();
+  }
+
+  const std::string &SysctlBatch::getName(size_t slot) const {
+    static const std::string empty;
+    return slot < pImpl->slots.size() ? pImpl->slots[slot].leaf.name : empty;
+  }
+
+  uint64_t SysctlBatch::getInteger(size_t slot) const {
+    return slot < pImpl->slots.size() ? pImpl->slots[slot].integer : 0;
+  }
+
+  const std::string &SysctlBatch::getString(size_t slot) const {
+    static const std::string empty;
+    return slot < pImpl->slots.size() ? pImpl->slots[slot].text : empty;
+  }
+
+  std::string SysctlBatch::getLastError() const { return pImpl->lastError; }
+
+} // namespace libfreebsdnet::system
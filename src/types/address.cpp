@@ -13,59 +13,192 @@
 
 namespace libfreebsdnet::types {
 
-  Address::Address(const std::string &addressString)
-      : prefixLen_(0), family_(Family::UNKNOWN), valid_(false) {
+  namespace {
+
+    // Write a dotted quad without going through inet_ntop
+    size_t formatIPv4(const uint8_t *bytes, char *out) {
+      char *p = out;
+      for (int i = 0; i < 4; ++i) {
+        unsigned int octet = bytes[i];
+        if (octet >= 100) {
+          *p++ = static_cast<char>('0' + octet / 100);
+        }
+        if (octet >= 10) {
+          *p++ = static_cast<char>('0' + octet / 10 % 10);
+        }
+        *p++ = static_cast<char>('0' + octet % 10);
+        if (i < 3) {
+          *p++ = '.';
+        }
+      }
+      *p = '\0';
+      return p - out;
+    }
+
+    // Strict dotted quad: 1-3 digits per octet, no leading zeros
+    bool parseIPv4(std::string_view text, uint8_t *out) {
+      size_t pos = 0;
+      for (int octet = 0; octet < 4; ++octet) {
+        if (octet > 0) {
+          if (pos >= text.size() || text[pos] != '.') {
+            return false;
+          }
+          ++pos;
+        }
+        size_t start = pos;
+        unsigned int value = 0;
+        while (pos < text.size() && pos - start < 3 &&
+               static_cast<unsigned char>(text[pos] - '0') < 10) {
+          value = value * 10 + (text[pos] - '0');
+          ++pos;
+        }
+        size_t digits = pos - start;
+        if (digits == 0 || value > 255 ||
+            (digits > 1 && text[start] == '0')) {
+          return false;
+        }
+        out[octet] = static_cast<uint8_t>(value);
+      }
+      return pos == text.size();
+    }
+
+    bool parseIPv6(std::string_view text, uint8_t *out) {
+      char buf[INET6_ADDRSTRLEN];
+      if (text.size() >= sizeof(buf)) {
+        return false;
+      }
+      std::memcpy(buf, text.data(), text.size());
+      buf[text.size()] = '\0';
+      return inet_pton(AF_INET6, buf, out) == 1;
+    }
+
+    // Decimal prefix length of up to three digits
+    bool parsePrefix(std::string_view text, int &prefixLen) {
+      if (text.empty() || text.size() > 3) {
+        return false;
+      }
+      prefixLen = 0;
+      for (char c : text) {
+        if (static_cast<unsigned char>(c - '0') >= 10) {
+          return false;
+        }
+        prefixLen = prefixLen * 10 + (c - '0');
+      }
+      return true;
+    }
+
+  } // namespace
+
+  Address::Address(const std::string &addressString) {
     parseString(addressString);
   }
 
-  Address::Address(const std::string &ip, int prefixLen)
-      : ip_(ip), prefixLen_(prefixLen), family_(Family::UNKNOWN),
-        valid_(false) {
-    family_ = determineFamily(ip);
-    valid_ = (family_ != Family::UNKNOWN && prefixLen_ >= 0 &&
-              ((family_ == Family::IPv4 && prefixLen_ <= 32) ||
-               (family_ == Family::IPv6 && prefixLen_ <= 128)));
+  Address::Address(const std::string &ip, int prefixLen) {
+    assign(ip, prefixLen);
   }
 
-  std::string Address::getIp() const { return ip_; }
+  Address::Address(const struct in_addr &addr, int prefixLen)
+      : family_(Family::IPv4) {
+    std::memcpy(bytes_.data(), &addr, sizeof(addr));
+    valid_ = prefixLen >= 0 && prefixLen <= 32;
+    prefixLen_ = valid_ ? static_cast<uint8_t>(prefixLen) : 0;
+  }
 
-  int Address::getPrefixLength() const { return prefixLen_; }
+  Address::Address(const struct in6_addr &addr, int prefixLen)
+      : family_(Family::IPv6) {
+    std::memcpy(bytes_.data(), &addr, sizeof(addr));
+    valid_ = prefixLen >= 0 && prefixLen <= 128;
+    prefixLen_ = valid_ ? static_cast<uint8_t>(prefixLen) : 0;
+  }
 
-  Address::Family Address::getFamily() const { return family_; }
+  std::string Address::getIp() const {
+    char buf[INET6_ADDRSTRLEN];
+    size_t len = formatIp(buf);
+    return std::string(buf, len);
+  }
 
   std::string Address::getNetmask() const {
     if (!valid_)
       return "";
-    return prefixToNetmask(prefixLen_, family_);
+    if (family_ == Family::IPv6) {
+      // IPv6 netmasks are conventionally given as prefix lengths
+      return std::to_string(prefixLen_);
+    }
+    return getNetmaskAddress().getIp();
   }
 
   std::string Address::getBroadcast() const {
-    if (!valid_)
+    if (!valid_ || family_ != Family::IPv4)
       return "";
-    return calculateBroadcast(ip_, prefixLen_, family_);
+    return getBroadcastAddress().getIp();
   }
 
   std::string Address::getCidr() const {
-    if (!valid_)
-      return "";
-    return ip_ + "/" + std::to_string(prefixLen_);
+    char buf[MAX_CIDR_LENGTH];
+    size_t len = formatCidr(buf);
+    return std::string(buf, len);
   }
 
-  bool Address::isValid() const { return valid_; }
+  size_t Address::formatIp(std::span<char> buffer) const {
+    if (family_ == Family::IPv4) {
+      if (buffer.size() < INET_ADDRSTRLEN) {
+        return 0;
+      }
+      return formatIPv4(bytes_.data(), buffer.data());
+    }
+    if (family_ == Family::IPv6) {
+      if (!inet_ntop(AF_INET6, bytes_.data(), buffer.data(),
+                     static_cast<socklen_t>(buffer.size()))) {
+        return 0;
+      }
+      return std::strlen(buffer.data());
+    }
+    return 0;
+  }
 
-  bool Address::isIPv4() const { return family_ == Family::IPv4; }
+  size_t Address::formatCidr(std::span<char> buffer) const {
+    if (!valid_ || buffer.size() < MAX_CIDR_LENGTH) {
+      return 0;
+    }
+    size_t len = formatIp(buffer);
+    if (len == 0) {
+      return 0;
+    }
+    char *p = buffer.data() + len;
+    *p++ = '/';
+    if (prefixLen_ >= 100) {
+      *p++ = static_cast<char>('0' + prefixLen_ / 100);
+    }
+    if (prefixLen_ >= 10) {
+      *p++ = static_cast<char>('0' + prefixLen_ / 10 % 10);
+    }
+    *p++ = static_cast<char>('0' + prefixLen_ % 10);
+    *p = '\0';
+    return p - buffer.data();
+  }
 
-  bool Address::isIPv6() const { return family_ == Family::IPv6; }
+  size_t Address::hash() const {
+    // FNV-1a over the significant bytes
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](uint8_t byte) {
+      h ^= byte;
+      h *= 1099511628211ull;
+    };
+    mix(static_cast<uint8_t>(family_));
+    for (uint8_t byte : getBytes()) {
+      mix(byte);
+    }
+    mix(prefixLen_);
+    mix(valid_);
+    return static_cast<size_t>(h);
+  }
 
   struct sockaddr_in Address::getSockaddrIn() const {
     struct sockaddr_in addr = {};
     if (isIPv4()) {
       addr.sin_family = AF_INET;
       addr.sin_len = sizeof(addr);
-      if (inet_pton(AF_INET, ip_.c_str(), &addr.sin_addr) != 1) {
-        // Set to 0.0.0.0 if conversion fails
-        addr.sin_addr.s_addr = 0;
-      }
+      std::memcpy(&addr.sin_addr, bytes_.data(), sizeof(addr.sin_addr));
     }
     return addr;
   }
@@ -75,10 +208,7 @@ namespace libfreebsdnet::types {
     if (isIPv6()) {
       addr.sin6_family = AF_INET6;
       addr.sin6_len = sizeof(addr);
-      if (inet_pton(AF_INET6, ip_.c_str(), &addr.sin6_addr) != 1) {
-        // Set to :: if conversion fails
-        std::memset(&addr.sin6_addr, 0, sizeof(addr.sin6_addr));
-      }
+      std::memcpy(&addr.sin6_addr, bytes_.data(), sizeof(addr.sin6_addr));
     }
     return addr;
   }
@@ -87,6 +217,74 @@ namespace libfreebsdnet::types {
     return Address(addressString);
   }
 
+  bool Address::parse(std::string_view text, Address &out) {
+    out = Address();
+    size_t slash = text.find('/');
+    int prefixLen;
+    if (slash == std::string_view::npos ||
+        !parsePrefix(text.substr(slash + 1), prefixLen)) {
+      return false;
+    }
+    std::string_view ip = text.substr(0, slash);
+    int maxLen;
+    if (ip.find(':') == std::string_view::npos) {
+      if (!parseIPv4(ip, out.bytes_.data())) {
+        return false;
+      }
+      out.family_ = Family::IPv4;
+      maxLen = 32;
+    } else {
+      if (!parseIPv6(ip, out.bytes_.data())) {
+        return false;
+      }
+      out.family_ = Family::IPv6;
+      maxLen = 128;
+    }
+    if (prefixLen > maxLen) {
+      return false;
+    }
+    out.prefixLen_ = static_cast<uint8_t>(prefixLen);
+    out.valid_ = true;
+    return true;
+  }
+
+  bool Address::validate(std::string_view text) {
+    size_t slash = text.find('/');
+    int prefixLen;
+    if (slash == std::string_view::npos ||
+        !parsePrefix(text.substr(slash + 1), prefixLen)) {
+      return false;
+    }
+    std::string_view ip = text.substr(0, slash);
+    uint8_t bytes[16];
+    if (ip.find(':') == std::string_view::npos) {
+      return prefixLen <= 32 && parseIPv4(ip, bytes);
+    }
+    return prefixLen <= 128 && parseIPv6(ip, bytes);
+  }
+
+  size_t Address::parseAddresses(std::span<const std::string_view> texts,
+                                 std::span<Address> out) {
+    size_t count = std::min(texts.size(), out.size());
+    size_t valid = 0;
+    for (size_t i = 0; i < count; ++i) {
+      valid += parse(texts[i], out[i]);
+    }
+    return valid;
+  }
+
+  size_t Address::formatAddresses(std::span<const Address> addresses,
+                                  std::span<char> out) {
+    size_t count = std::min(addresses.size(), out.size() / MAX_CIDR_LENGTH);
+    for (size_t i = 0; i < count; ++i) {
+      std::span<char> slot = out.subspan(i * MAX_CIDR_LENGTH, MAX_CIDR_LENGTH);
+      if (addresses[i].formatCidr(slot) == 0) {
+        slot[0] = '\0';
+      }
+    }
+    return count;
+  }
+
   bool Address::parseAddress(const std::string &addressString, std::string &ip,
                              int &prefixLen) {
     size_t slashPos = addressString.find('/');
@@ -110,15 +308,7 @@ namespace libfreebsdnet::types {
     if (family == Family::IPv4) {
       if (prefixLen < 0 || prefixLen > 32)
         return "";
-
-      uint32_t netmask = 0xFFFFFFFF << (32 - prefixLen);
-      struct in_addr addr;
-      addr.s_addr = htonl(netmask);
-
-      char buf[INET_ADDRSTRLEN];
-      if (inet_ntop(AF_INET, &addr, buf, INET_ADDRSTRLEN)) {
-        return std::string(buf);
-      }
+      return Address(in_addr{}, prefixLen).getNetmask();
     } else if (family == Family::IPv6) {
       if (prefixLen < 0 || prefixLen > 128)
         return "";
@@ -133,70 +323,49 @@ namespace libfreebsdnet::types {
 
   std::string Address::calculateBroadcast(const std::string &ip, int prefixLen,
                                           Family family) {
-    if (family == Family::IPv4) {
-      struct in_addr addr;
-      if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
-        return "";
-      }
-
-      uint32_t netmask = 0xFFFFFFFF << (32 - prefixLen);
-      uint32_t broadcast = addr.s_addr | ~netmask;
-
-      struct in_addr broadcast_addr;
-      broadcast_addr.s_addr = broadcast;
-
-      char buf[INET_ADDRSTRLEN];
-      if (inet_ntop(AF_INET, &broadcast_addr, buf, INET_ADDRSTRLEN)) {
-        return std::string(buf);
-      }
+    if (family != Family::IPv4) {
+      // IPv6 doesn't have broadcast addresses
+      return "";
     }
-    // IPv6 doesn't have broadcast addresses
-    return "";
+    Address address(ip, prefixLen);
+    return address.isIPv4() ? address.getBroadcast() : "";
   }
 
   void Address::parseString(const std::string &addressString) {
-    valid_ = false;
-
-    if (!parseAddress(addressString, ip_, prefixLen_)) {
+    if (parse(addressString, *this)) {
       return;
     }
-
-    family_ = determineFamily(ip_);
-
-    if (family_ == Family::UNKNOWN) {
+    // Keep the lenient handling of prefixes such as "+24" or "024"
+    std::string ip;
+    int prefixLen;
+    if (!parseAddress(addressString, ip, prefixLen)) {
       return;
     }
+    assign(ip, prefixLen);
+  }
 
-    // Validate prefix length
-    if (family_ == Family::IPv4 && (prefixLen_ < 0 || prefixLen_ > 32)) {
+  void Address::assign(const std::string &ip, int prefixLen) {
+    family_ = Family::UNKNOWN;
+    valid_ = false;
+    bytes_.fill(0);
+    prefixLen_ = 0;
+
+    if (inet_pton(AF_INET, ip.c_str(), bytes_.data()) == 1) {
+      family_ = Family::IPv4;
+    } else if (inet_pton(AF_INET6, ip.c_str(), bytes_.data()) == 1) {
+      family_ = Family::IPv6;
+    } else {
+      bytes_.fill(0);
       return;
     }
-    if (family_ == Family::IPv6 && (prefixLen_ < 0 || prefixLen_ > 128)) {
+
+    // Validate prefix length
+    int maxLen = family_ == Family::IPv4 ? 32 : 128;
+    if (prefixLen < 0 || prefixLen > maxLen) {
       return;
     }
-
+    prefixLen_ = static_cast<uint8_t>(prefixLen);
     valid_ = true;
   }
 
-  Address::Family Address::determineFamily(const std::string &ip) {
-    // Check for IPv4 (contains dots and no colons)
-    if (ip.find('.') != std::string::npos &&
-        ip.find(':') == std::string::npos) {
-      struct in_addr addr;
-      if (inet_pton(AF_INET, ip.c_str(), &addr) == 1) {
-        return Family::IPv4;
-      }
-    }
-
-    // Check for IPv6 (contains colons)
-    if (ip.find(':') != std::string::npos) {
-      struct in6_addr addr;
-      if (inet_pton(AF_INET6, ip.c_str(), &addr) == 1) {
-        return Family::IPv6;
-      }
-    }
-
-    return Family::UNKNOWN;
-  }
-
 } // namespace libfreebsdnet::types
@@ -0,0 +1,48 @@
+/**
+ * @file types/error.cpp
+ * @brief Structured error type implementation
+ * @details Message formatting for NetError
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <types/error.hpp>
+
+namespace libfreebsdnet::types {
+
+  std::string NetError::toString() const {
+    std::string message = operation ? operation : "";
+    if (!message.empty()) {
+      message += ": ";
+    }
+    switch (code) {
+    case NetErrorCode::SYSTEM:
+      if (request != 0) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "ioctl 0x%lx failed", request);
+        message += text;
+      } else {
+        message += "kernel call failed";
+      }
+      break;
+    case NetErrorCode::INVALID_ARGUMENT:
+      message += "invalid argument";
+      break;
+    case NetErrorCode::NOT_FOUND:
+      message += "not found";
+      break;
+    case NetErrorCode::NOT_SUPPORTED:
+      message += "not supported";
+      break;
+    }
+    if (error != 0) {
+      message += ": ";
+      message += std::strerror(error);
+    }
+    return message;
+  }
+
+} // namespace libfreebsdnet::types
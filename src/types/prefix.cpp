@@ -0,0 +1,92 @@
+/**
+ * @file types/prefix.cpp
+ * @brief Prefix set implementation
+ * @details Query wrappers and CIDR aggregation over the prefix trie
+ *
+ * @author paigeadelethompson
+ * @year 2024
+ */
+
+#include <algorithm>
+#include <array>
+#include <types/prefix.hpp>
+
+namespace libfreebsdnet::types {
+
+  namespace {
+
+    Address parentOf(const Address &prefix) {
+      std::array<uint8_t, 16> bytes{};
+      auto current = prefix.getBytes();
+      std::copy(current.begin(), current.end(), bytes.begin());
+      return Address(prefix.getFamily(), bytes, prefix.getPrefixLength() - 1)
+          .getNetworkAddress();
+    }
+
+    // True if a and b are the two halves of the same shorter prefix
+    bool siblings(const Address &a, const Address &b) {
+      if (a.getFamily() != b.getFamily() ||
+          a.getPrefixLength() != b.getPrefixLength() ||
+          a.getPrefixLength() == 0 || a == b) {
+        return false;
+      }
+      return parentOf(a) == parentOf(b);
+    }
+
+  } // namespace
+
+  PrefixSet PrefixSet::fromSorted(std::span<const Address> prefixes) {
+    PrefixSet set;
+    for (const Address &prefix : prefixes) {
+      set.insert(prefix);
+    }
+    return set;
+  }
+
+  std::optional<Address>
+  PrefixSet::longestMatch(const Address &address) const {
+    Address matched;
+    if (!map_.longestMatch(address, &matched)) {
+      return std::nullopt;
+    }
+    return matched;
+  }
+
+  std::vector<Address> PrefixSet::covering(const Address &address) const {
+    std::vector<Address> result;
+    for (const auto &[prefix, value] : map_.covering(address)) {
+      result.push_back(prefix);
+    }
+    return result;
+  }
+
+  std::vector<Address> PrefixSet::getPrefixes() const {
+    std::vector<Address> prefixes;
+    prefixes.reserve(map_.size());
+    map_.forEach([&](const Address &prefix, const std::monostate &) {
+      prefixes.push_back(prefix);
+      return true;
+    });
+    return prefixes;
+  }
+
+  PrefixSet PrefixSet::aggregate() const {
+    // Address order puts a covering prefix before everything it covers,
+    // so one pass with a stack of disjoint prefixes is enough
+    std::vector<Address> stack;
+    for (const Address &prefix : getPrefixes()) {
+      if (!stack.empty() && stack.back().contains(prefix)) {
+        continue;
+      }
+      stack.push_back(prefix);
+      while (stack.size() >= 2 &&
+             siblings(stack[stack.size() - 2], stack.back())) {
+        Address parent = parentOf(stack.back());
+        stack.pop_back();
+        stack.back() = parent;
+      }
+    }
+    return fromSorted(stack);
+  }
+
+} // namespace libfreebsdnet::types